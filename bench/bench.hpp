@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// A small benchmark harness in the style of Google Benchmark, so the benchmarks build without any dependencies
+namespace bench {
+/**
+ * @brief Runs the timed loop of a benchmark
+ *
+ * @b Example
+ * @code {.cpp}
+ * static void BM_angleError(bench::State& state) {
+ *     for (auto _ : state) bench::doNotOptimize(lemlib::angleError(1, 2));
+ * }
+ * BENCHMARK(BM_angleError);
+ * @endcode
+ */
+class State {
+    public:
+        explicit State(uint64_t iterations)
+            : iterations(iterations) {}
+
+        struct Iterator {
+                State* state;
+                uint64_t remaining;
+
+                bool operator!=(const Iterator&) {
+                    if (remaining != 0) return true;
+                    state->stop = std::chrono::steady_clock::now();
+                    return false;
+                }
+
+                void operator++() { remaining--; }
+
+                int operator*() const { return 0; }
+        };
+
+        /** only the loop is timed, so setup before it doesn't count */
+        Iterator begin() {
+            start = std::chrono::steady_clock::now();
+            return {this, iterations};
+        }
+
+        Iterator end() { return {this, 0}; }
+
+        /**
+         * @brief Get the time the loop took
+         *
+         * @return double the time, in seconds
+         */
+        double seconds() const { return std::chrono::duration<double>(stop - start).count(); }
+
+        const uint64_t iterations;
+    private:
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::time_point stop;
+};
+
+/**
+ * @brief Stop the compiler from optimizing away a value
+ */
+template <typename T> inline void doNotOptimize(const T& value) { asm volatile("" : : "r,m"(value) : "memory"); }
+
+using Function = void (*)(State&);
+
+/**
+ * @brief Add a benchmark to the list that is run. Used by BENCHMARK
+ */
+int add(const char* name, Function function);
+} // namespace bench
+
+#define BENCHMARK(function) static const int function##Registered = ::bench::add(#function, function)
@@ -0,0 +1,153 @@
+// Benchmarks of the code that runs every iteration of the control loops
+#include <cmath>
+#include <string>
+#include "bench.hpp"
+#include "lemlib/api.hpp"
+
+// defined in pursuit.cpp
+template <typename P> int findClosest(lemlib::Pose pose, const P& path, int lastClosest, float rescanDist);
+template <typename P>
+lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, const P& path, int closest,
+                            float lookaheadDist);
+
+/**
+ * @brief A text path along an S curve, in the format exported by path.jerryio.com
+ */
+static std::string textPath(int points) {
+    std::string text;
+    for (int i = 0; i < points; i++) {
+        const float y = i * 2.0f;
+        text += std::to_string(24 * std::sin(y / 48)) + ", " + std::to_string(y) + ", " + std::to_string(100) + "\n";
+    }
+    text += "endData\n";
+    return text;
+}
+
+/**
+ * @brief A sink that formats messages but doesn't send them anywhere
+ */
+class NullSink : public lemlib::BaseSink {
+    public:
+        NullSink() { setFormat("[LemLib] {level}: {message}"); }
+    private:
+        void sendMessage(const lemlib::Message& message) override { bench::doNotOptimize(message.message.size()); }
+};
+
+static void BM_odomUpdate(bench::State& state) {
+    lemlib::Odometry odom;
+    lemlib::SensorFrame frame {};
+    for ([[maybe_unused]] auto _ : state) {
+        frame.vertical1 += 0.05;
+        frame.horizontal1 += 0.01;
+        frame.imu += 0.001;
+        frame.time += 10000;
+        odom.update(frame);
+    }
+    bench::doNotOptimize(odom.getPose());
+}
+BENCHMARK(BM_odomUpdate);
+
+static void BM_pidUpdate(bench::State& state) {
+    lemlib::PID pid(10, 0.1, 30, 3, true);
+    float error = 24;
+    for ([[maybe_unused]] auto _ : state) {
+        bench::doNotOptimize(pid.update(error));
+        error = error * 0.999f + 0.001f;
+    }
+}
+BENCHMARK(BM_pidUpdate);
+
+static void BM_traceSample(bench::State& state) {
+    // the queue of a motion trace, popped right away so it never fills up and drops samples
+    lemlib::BoundedQueue<lemlib::MotionSample> queue(128);
+    lemlib::PID pid(10, 0.1, 30);
+    lemlib::MotionSample sample;
+    float error = 24;
+    for ([[maybe_unused]] auto _ : state) {
+        sample.lateralError = error;
+        sample.lateral = pid.getTerms();
+        sample.left = sample.limit(lemlib::TraceClamp::MAX_SPEED, error, std::fmin(error, 127));
+        queue.push(sample);
+        queue.pop(sample);
+        error = error * 0.999f + 0.001f;
+    }
+    bench::doNotOptimize(sample.left);
+}
+BENCHMARK(BM_traceSample);
+
+static void BM_angleError(bench::State& state) {
+    float target = 0;
+    for ([[maybe_unused]] auto _ : state) {
+        bench::doNotOptimize(lemlib::angleError(target, 1.5f));
+        target += 0.01f;
+    }
+}
+BENCHMARK(BM_angleError);
+
+static void BM_loadTextPath(bench::State& state) {
+    const std::string text = textPath(500);
+    const asset file {reinterpret_cast<uint8_t*>(const_cast<char*>(text.data())), text.size()};
+    for ([[maybe_unused]] auto _ : state) bench::doNotOptimize(lemlib::loadPath(file).size());
+}
+BENCHMARK(BM_loadTextPath);
+
+static void BM_findClosest(bench::State& state) {
+    const std::string text = textPath(500);
+    const lemlib::Path path =
+        lemlib::loadPath({reinterpret_cast<uint8_t*>(const_cast<char*>(text.data())), text.size()});
+    int closest = 0;
+    float y = 0;
+    for ([[maybe_unused]] auto _ : state) {
+        // drive along the path, slightly off to the side
+        const lemlib::Pose pose(24 * std::sin(y / 48) + 1, y);
+        closest = findClosest(pose, path, closest, 10);
+        bench::doNotOptimize(closest);
+        y = y > 990 ? 0 : y + 0.5f;
+        if (y == 0) closest = 0;
+    }
+}
+BENCHMARK(BM_findClosest);
+
+static void BM_lookaheadPoint(bench::State& state) {
+    const std::string text = textPath(500);
+    const lemlib::Path path =
+        lemlib::loadPath({reinterpret_cast<uint8_t*>(const_cast<char*>(text.data())), text.size()});
+    lemlib::Pose lookahead = path.at(0);
+    lookahead.theta = 0;
+    int closest = 0;
+    float y = 0;
+    for ([[maybe_unused]] auto _ : state) {
+        const lemlib::Pose pose(24 * std::sin(y / 48) + 1, y);
+        closest = findClosest(pose, path, closest, 10);
+        lookahead = lookaheadPoint(lookahead, pose, path, closest, 12);
+        bench::doNotOptimize(lookahead);
+        y = y > 970 ? 0 : y + 0.5f;
+        if (y == 0) {
+            closest = 0;
+            lookahead = path.at(0);
+            lookahead.theta = 0;
+        }
+    }
+}
+BENCHMARK(BM_lookaheadPoint);
+
+static void BM_logFiltered(bench::State& state) {
+    NullSink sink;
+    float value = 0;
+    for ([[maybe_unused]] auto _ : state) {
+        sink.debug("value: {}", value);
+        value += 1;
+    }
+}
+BENCHMARK(BM_logFiltered);
+
+static void BM_logFormatted(bench::State& state) {
+    NullSink sink;
+    sink.setLowestLevel(lemlib::Level::INFO);
+    float value = 0;
+    for ([[maybe_unused]] auto _ : state) {
+        sink.info("value: {}", value);
+        value += 1;
+    }
+}
+BENCHMARK(BM_logFormatted);
@@ -0,0 +1,217 @@
+// Floods the info and telemetry sinks from several tasks at once, and prints how long a log call takes, how long a
+// message takes to come out of the buffered stdout, how many messages were dropped, and how much the heap grew
+// usage: make -C bench flood [FILTER=name]
+//
+// std::cout is pointed at a stream that reads the messages back as the buffer writes them, so the delivery latency is
+// measured at the same point a message would reach the terminal. Every run of the sinks is repeated with deferred
+// formatting off and on, so the formatting on the calling task can be compared with a copy into the deferred queue
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lemlib/api.hpp"
+#include "lemlib/logger/stdout.hpp"
+
+// time a run waits for the messages it sent to come out, after they stop coming out, in milliseconds
+constexpr uint32_t DRAIN_TIME = 300;
+// the text every message starts with, so the messages are found among anything else written to stdout
+constexpr char MARKER[] = "flood ";
+
+/**
+ * @brief A way of logging messages from the producers
+ */
+struct Scenario {
+        const char* name;
+        /** number of tasks logging at once */
+        int producers;
+        /** messages each task logs */
+        int messages;
+        /** time between the messages of a task, in microseconds. 0 to log as fast as possible */
+        uint32_t period;
+};
+
+static const Scenario SCENARIOS[] = {
+    {"paced 1x20ms", 1, 25, 20000},
+    {"paced 4x20ms", 4, 25, 20000},
+    {"burst 4x1ms", 4, 500, 1000},
+    {"flood 4", 4, 20000, 0},
+};
+
+/**
+ * @brief A stream buffer that finds the messages written to it, and records how long each took to get there
+ *
+ * Only the task of the buffered stdout writes to std::cout, so the stream doesn't need to lock
+ */
+class DeliveryStream : public std::streambuf {
+    public:
+        /**
+         * @brief Start recording a run
+         *
+         * @param messages the most messages the run can deliver, so recording doesn't allocate
+         */
+        void reset(size_t messages) {
+            latencies.clear();
+            latencies.reserve(messages);
+            pending.clear();
+            pending.reserve(4096);
+            delivered = 0;
+        }
+
+        /** the time from each log call to its message coming out, in microseconds */
+        std::vector<uint32_t> latencies;
+        /** number of messages that came out */
+        std::atomic<size_t> delivered = 0;
+    protected:
+        int overflow(int c) override {
+            if (c == traits_type::eof()) return c;
+            const char character = c;
+            xsputn(&character, 1);
+            return c;
+        }
+
+        std::streamsize xsputn(const char* text, std::streamsize size) override {
+            pending.append(text, size);
+            const uint64_t now = pros::micros();
+            size_t start = 0;
+            while (true) {
+                const size_t marker = pending.find(MARKER, start);
+                if (marker == std::string::npos) {
+                    // the end is kept, in case the marker is split between writes
+                    start = std::max(start, pending.size() - std::min(pending.size(), std::strlen(MARKER) - 1));
+                    break;
+                }
+                const size_t end = pending.find(';', marker);
+                // the rest of the message hasn't been written yet
+                if (end == std::string::npos) {
+                    start = marker;
+                    break;
+                }
+                unsigned long long stamp = 0;
+                if (std::sscanf(pending.c_str() + marker + std::strlen(MARKER), "%*u %*u %llu", &stamp) == 1) {
+                    if (latencies.size() < latencies.capacity()) latencies.push_back(now - stamp);
+                    delivered++;
+                }
+                start = end + 1;
+            }
+            pending.erase(0, start);
+            return size;
+        }
+    private:
+        std::string pending;
+};
+
+/**
+ * @brief The result of a run
+ */
+struct Result {
+        size_t sent = 0;
+        size_t delivered = 0;
+        /** number of messages the ring of the buffered stdout dropped. The rest were dropped by the deferred queue */
+        uint32_t bufferDropped = 0;
+        /** time a log call took, in nanoseconds */
+        lemlib::TimingStats call;
+        /** time from a log call to its message coming out, in microseconds */
+        lemlib::TimingStats delivery;
+        /** bytes the heap grew by while the run logged, including the little the producer threads allocate */
+        long heapGrowth = 0;
+};
+
+static Result run(lemlib::BaseSink& sink, DeliveryStream& stream, const Scenario& scenario) {
+    Result result;
+    result.sent = size_t(scenario.producers) * scenario.messages;
+    std::vector<std::vector<uint32_t>> callTimes(scenario.producers);
+    for (std::vector<uint32_t>& times : callTimes) times.reserve(scenario.messages);
+    stream.reset(result.sent);
+    const uint32_t droppedBefore = lemlib::bufferedStdout().getStats().dropped;
+    const size_t heapBefore = lemlib::getHeapUsage().used;
+
+    // the producers are released at once, so they contend for the sink from the first message
+    std::atomic<bool> go = false;
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < scenario.producers; producer++) {
+        producers.emplace_back([&, producer] {
+            while (!go) std::this_thread::yield();
+            auto next = std::chrono::steady_clock::now();
+            for (int i = 0; i < scenario.messages; i++) {
+                const uint64_t stamp = pros::micros();
+                const auto start = std::chrono::steady_clock::now();
+                sink.info("flood {} {} {};", producer, i, stamp);
+                const auto end = std::chrono::steady_clock::now();
+                callTimes[producer].push_back(std::chrono::nanoseconds(end - start).count());
+                if (scenario.period == 0) continue;
+                next += std::chrono::microseconds(scenario.period);
+                std::this_thread::sleep_until(next);
+            }
+        });
+    }
+    go = true;
+    for (std::thread& thread : producers) thread.join();
+
+    // wait until the messages stop coming out
+    size_t delivered = 0;
+    uint32_t quiet = 0;
+    while (quiet < DRAIN_TIME || !lemlib::bufferedStdout().buffersEmpty()) {
+        pros::delay(10);
+        quiet = stream.delivered == delivered ? quiet + 10 : 0;
+        delivered = stream.delivered;
+    }
+    result.heapGrowth = long(lemlib::getHeapUsage().used) - long(heapBefore);
+    result.delivered = delivered;
+    result.bufferDropped = lemlib::bufferedStdout().getStats().dropped - droppedBefore;
+
+    std::vector<uint32_t> calls;
+    for (const std::vector<uint32_t>& times : callTimes) calls.insert(calls.end(), times.begin(), times.end());
+    result.call = lemlib::timingStats(calls.data(), calls.size());
+    result.delivery = lemlib::timingStats(stream.latencies.data(), stream.latencies.size());
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    // only the buffer writes to std::cout from here on, and the table goes to stdout through printf
+    DeliveryStream stream;
+    std::streambuf* const original = std::cout.rdbuf(&stream);
+
+    struct Sink {
+            const char* name;
+            lemlib::BaseSink* sink;
+    };
+
+    const Sink sinks[] = {{"info", lemlib::infoSink().get()}, {"telemetry", lemlib::telemetrySink().get()}};
+    std::printf("%-10s %-9s %-13s %7s %7s %7s %22s %22s %8s\n", "sink", "mode", "scenario", "sent", "drop %",
+                "ring", "call ns p50/p99/max", "delivery us p50/p99/max", "heap");
+    for (const Sink& sink : sinks) {
+        sink.sink->setLowestLevel(lemlib::Level::INFO);
+        for (const bool deferred : {false, true}) {
+            sink.sink->setDeferred(deferred);
+            const char* mode = deferred ? "deferred" : "immediate";
+            for (const Scenario& scenario : SCENARIOS) {
+                const std::string name = std::string(sink.name) + " " + mode + " " + scenario.name;
+                if (name.find(filter) == std::string::npos) continue;
+                const Result result = run(*sink.sink, stream, scenario);
+                const double dropped = 100.0 * (result.sent - std::min(result.delivered, result.sent)) / result.sent;
+                std::printf("%-10s %-9s %-13s %7zu %7.1f %7u %8u/%6u/%6u %8u/%6u/%6u %8ld\n", sink.name, mode,
+                            scenario.name, result.sent, dropped, result.bufferDropped, result.call.p50,
+                            result.call.p99, result.call.max, result.delivery.p50, result.delivery.p99,
+                            result.delivery.max, result.heapGrowth);
+                std::fflush(stdout);
+            }
+        }
+        // turned off again, so the next sink's runs only have its own deferred task
+        sink.sink->setDeferred(false);
+        sink.sink->setLowestLevel(lemlib::Level::FATAL);
+    }
+    std::cout.rdbuf(original);
+    // the tasks of the sinks still hold the stream, so the program exits without running destructors
+    std::fflush(stdout);
+    std::_Exit(0);
+}
@@ -0,0 +1,45 @@
+// Runs every benchmark, or the ones whose names contain the first argument
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "bench.hpp"
+
+// shortest time a benchmark runs for, so the timing is stable
+constexpr double MIN_SECONDS = 0.2;
+
+struct Benchmark {
+        const char* name;
+        bench::Function function;
+};
+
+static std::vector<Benchmark>& benchmarks() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+int bench::add(const char* name, Function function) {
+    benchmarks().push_back({name, function});
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    std::printf("%-40s %14s %14s\n", "benchmark", "ns/iteration", "iterations");
+    for (const Benchmark& benchmark : benchmarks()) {
+        if (std::strstr(benchmark.name, filter) == nullptr) continue;
+        // run more iterations until the benchmark takes long enough to time
+        uint64_t iterations = 1;
+        double seconds = 0;
+        while (true) {
+            bench::State state(iterations);
+            benchmark.function(state);
+            seconds = state.seconds();
+            if (seconds >= MIN_SECONDS || iterations >= (uint64_t(1) << 40)) break;
+            iterations *= seconds > 0 ? std::min(10.0, std::max(2.0, 1.4 * MIN_SECONDS / seconds)) : 10;
+        }
+        std::printf("%-40s %14.1f %14llu\n", benchmark.name, seconds * 1e9 / iterations,
+                    static_cast<unsigned long long>(iterations));
+    }
+    return 0;
+}
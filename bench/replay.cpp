@@ -0,0 +1,246 @@
+// Replays a corpus of recorded runs through every odometry mode, and prints how far each ended from the ground truth
+// and how long an update took. Every run is recorded with updates every 10 ms and every 20 ms
+// usage: make -C bench replay [FILTER=name]
+//
+// The runs are recorded from a model of a robot driving along known paths, so the pose it ended at is known exactly.
+// Its sensors have the errors of real ones: encoder ticks, wheels a little larger or smaller than their nominal
+// diameter, wheels slipping while the robot turns, and an inertial sensor with noise, bias, and a scale error. The
+// sensor readings are written as a sensor log, and replayed with Odometry::replay(), the same way a log from the SD
+// card is replayed
+//
+// Every run is also recorded with ideal sensors, which read exactly what the robot did. The only error left is from
+// integrating the motion in steps of the update period, which is what the integrators differ in
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "bench.hpp"
+#include "lemlib/api.hpp"
+
+// times between updates of the recorded odometry, in milliseconds
+constexpr uint32_t PERIODS[] = {10, 20};
+// time between steps of the model of the robot, in seconds
+constexpr double MODEL_STEP = 0.0005;
+// time the velocity of the robot takes to reach 63% of its command, in seconds
+constexpr double RESPONSE_TIME = 0.15;
+// distance the encoders of the tracking wheels measure per tick, a 2.75" wheel on a 360 tick encoder, in inches
+constexpr double TICK = M_PI * 2.75 / 360;
+// offsets of the tracking wheels from the tracking center, in inches
+constexpr float LEFT_OFFSET = -5;
+constexpr float RIGHT_OFFSET = 5;
+constexpr float HORIZONTAL_OFFSET = -3;
+// number of times each run is replayed, so the time of an update is stable. The fastest replay is reported
+constexpr int REPEATS = 20;
+
+/**
+ * @brief A part of a run, where the robot is commanded to drive at a constant velocity
+ */
+struct Segment {
+        /** how long the command lasts, in seconds */
+        double duration;
+        /** forward velocity, in inches per second */
+        double velocity;
+        /** angular velocity, in radians per second. Positive is clockwise, like the heading */
+        double angular;
+};
+
+/**
+ * @brief A run in the corpus
+ */
+struct Run {
+        const char* name;
+        std::vector<Segment> segments;
+};
+
+/**
+ * @brief A recorded run, and where the robot really ended
+ */
+struct Recording {
+        const char* name;
+        /** time between updates, in milliseconds */
+        uint32_t period;
+        /** whether the sensors read exactly what the robot did, so the only error is from integrating the updates */
+        bool ideal;
+        std::vector<uint8_t> log;
+        /** theta in radians */
+        lemlib::Pose truth = lemlib::Pose(0, 0, 0);
+};
+
+/**
+ * @brief A way of running the odometry
+ */
+struct Mode {
+        const char* name;
+        lemlib::OdomIntegrator integrator;
+        bool ekf;
+        bool particleFilter;
+};
+
+static const Run RUNS[] = {
+    {"straight", {{2, 40, 0}, {1, 0, 0}, {2, -40, 0}, {1, 0, 0}}},
+    {"turns", {{1, 0, 3}, {0.5, 0, 0}, {1, 0, -3}, {0.5, 0, 0}, {2, 0, 6}, {1, 0, 0}}},
+    {"square", {{1.2, 36, 0}, {0.8, 0, 2}, {1.2, 36, 0}, {0.8, 0, 2}, {1.2, 36, 0}, {0.8, 0, 2}, {1.2, 36, 0},
+                {0.8, 0, 2}, {0.5, 0, 0}}},
+    {"s-curve", {{3, 40, 1.2}, {3, 40, -1.2}, {1, 0, 0}}},
+    {"match", {{1.5, 50, 0}, {0.6, 0, -2.5}, {2, 30, 0.8}, {0.4, 0, 0}, {1, -45, 0}, {0.8, 20, 2.5}, {1.5, 60, -0.5},
+               {0.5, 0, 0}, {1.2, 0, 4}, {2, -30, -1}, {1.5, 45, 0}, {1, 10, -3}, {1, 0, 0}}},
+};
+
+static const Mode MODES[] = {
+    {"arc", lemlib::OdomIntegrator::ARC, false, false},
+    {"second order", lemlib::OdomIntegrator::SECOND_ORDER, false, false},
+    {"ekf", lemlib::OdomIntegrator::ARC, true, false},
+    {"particle", lemlib::OdomIntegrator::ARC, false, true},
+};
+
+/**
+ * @brief Drive the model of the robot through a run, and record what its sensors read
+ *
+ * The model steps much faster than the odometry updates, so the ground truth doesn't have the errors of integrating
+ * at the update period. Every run has its own seed, so the corpus is the same every time
+ */
+static Recording record(const Run& run, uint32_t seed, uint32_t period, bool ideal) {
+    std::mt19937 random(seed);
+    std::normal_distribution<double> normal(0, 1);
+    // scales every error of the sensors
+    const double error = ideal ? 0 : 1;
+    // each wheel is a little larger or smaller than its nominal diameter
+    const double leftScale = 1 + 0.004 * error * normal(random);
+    const double rightScale = 1 + 0.004 * error * normal(random);
+    const double horizontalScale = 1 + 0.004 * error * normal(random);
+    const double imuScale = 1 + 0.002 * error * normal(random);
+    // the inertial sensor drifts by about a degree a minute, in radians per second
+    const double imuBias = 0.0003 * error * normal(random);
+
+    Recording recording {run.name, period, ideal};
+    lemlib::SensorRecord start {lemlib::SensorRecordType::START};
+    start.period = period;
+    lemlib::SensorLog::append(start, recording.log);
+
+    double x = 0, y = 0, theta = 0;
+    double velocity = 0, angular = 0;
+    // the distances the wheels really rolled, and the rotation the inertial sensor measured
+    double left = 0, right = 0, horizontal = 0, imu = 0;
+    double time = 0;
+    double nextUpdate = period / 1000.0;
+    const double response = 1 - std::exp(-MODEL_STEP / RESPONSE_TIME);
+    for (const Segment& segment : run.segments) {
+        const double end = time + segment.duration;
+        while (time < end) {
+            velocity += (segment.velocity - velocity) * response;
+            angular += (segment.angular - angular) * response;
+            // the robot skids sideways a little while it turns, more the faster it goes
+            const double skid = -0.01 * velocity * angular;
+            const double heading = theta + angular * MODEL_STEP / 2;
+            x += (velocity * std::sin(heading) - skid * std::cos(heading)) * MODEL_STEP;
+            y += (velocity * std::cos(heading) + skid * std::sin(heading)) * MODEL_STEP;
+            theta += angular * MODEL_STEP;
+            // the wheels scrub while the robot turns, so they measure a little less than they roll
+            const double scrub = 1 - 0.002 * error * std::fabs(angular);
+            left += (velocity - LEFT_OFFSET * angular) * leftScale * scrub * MODEL_STEP;
+            right += (velocity - RIGHT_OFFSET * angular) * rightScale * scrub * MODEL_STEP;
+            horizontal += (skid - HORIZONTAL_OFFSET * angular) * horizontalScale * MODEL_STEP;
+            imu += (angular * imuScale + imuBias) * MODEL_STEP;
+            time += MODEL_STEP;
+            if (time < nextUpdate) continue;
+            // the tracking task wakes up a little early or late
+            nextUpdate += period / 1000.0 + 0.0002 * normal(random);
+            lemlib::SensorRecord frame {lemlib::SensorRecordType::FRAME};
+            frame.frame.vertical1 = ideal ? left : std::round(left / TICK) * TICK;
+            frame.frame.vertical2 = ideal ? right : std::round(right / TICK) * TICK;
+            frame.frame.horizontal1 = ideal ? horizontal : std::round(horizontal / TICK) * TICK;
+            frame.frame.imu = imu + 0.0005 * error * normal(random);
+            frame.frame.time = uint64_t(time * 1e6);
+            lemlib::SensorLog::append(frame, recording.log);
+            recording.truth = lemlib::Pose(x, y, theta);
+        }
+    }
+    return recording;
+}
+
+/**
+ * @brief The result of replaying a run in a mode
+ */
+struct Result {
+        size_t updates = 0;
+        /** fastest time of an update, in nanoseconds */
+        double updateTime = INFINITY;
+        /** distance from the ground truth, in inches */
+        float distance = 0;
+        /** heading error, in degrees */
+        float heading = 0;
+};
+
+static Result replay(const Recording& recording, const Mode& mode) {
+    pros::Imu imu(10);
+    lemlib::TrackingWheel leftWheel(static_cast<pros::ADIEncoder*>(nullptr), 2.75, LEFT_OFFSET);
+    lemlib::TrackingWheel rightWheel(static_cast<pros::ADIEncoder*>(nullptr), 2.75, RIGHT_OFFSET);
+    lemlib::TrackingWheel horizontalWheel(static_cast<pros::ADIEncoder*>(nullptr), 2.75, HORIZONTAL_OFFSET);
+    // the log has no distance sensor readings, so the particles are only moved and never weighed
+    lemlib::ParticleFilter filter({}, lemlib::FieldMap(), 256);
+    filter.setTimeBudget(0);
+    Result result;
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        lemlib::Odometry odom;
+        odom.setSensors(lemlib::OdomSensors(&leftWheel, &rightWheel, &horizontalWheel, nullptr, &imu));
+        odom.setIntegrator(mode.integrator);
+        if (mode.ekf) odom.setEKF(true);
+        if (mode.particleFilter) odom.setParticleFilter(&filter);
+        lemlib::SensorLogReader reader(recording.log);
+        const auto start = std::chrono::steady_clock::now();
+        result.updates = odom.replay(reader);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.updateTime = std::min(result.updateTime, seconds * 1e9 / std::max<size_t>(result.updates, 1));
+        const lemlib::Pose pose = odom.getPose(true);
+        bench::doNotOptimize(pose);
+        result.distance = pose.distance(recording.truth);
+        result.heading = std::fabs(lemlib::radToDeg(lemlib::angleError(pose.theta, recording.truth.theta)));
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+    std::vector<Recording> corpus;
+    for (bool ideal : {false, true}) {
+        for (uint32_t period : PERIODS) {
+            // the same seeds every time, so the recordings of a run only differ in how often and how well it is
+            // measured
+            uint32_t seed = 1;
+            for (const Run& run : RUNS) corpus.push_back(record(run, seed++, period, ideal));
+        }
+    }
+
+    std::printf("%-12s %-12s %-8s %6s %8s %14s %12s %12s\n", "run", "mode", "sensors", "period", "updates",
+                "ns/update", "error (in)", "error (deg)");
+    for (const Mode& mode : MODES) {
+        if (std::strstr(mode.name, filter) == nullptr) continue;
+        for (bool ideal : {false, true}) {
+            for (uint32_t period : PERIODS) {
+                const char* sensors = ideal ? "ideal" : "real";
+                Result total;
+                total.updateTime = 0;
+                size_t runs = 0;
+                for (const Recording& recording : corpus) {
+                    if (recording.period != period || recording.ideal != ideal) continue;
+                    const Result result = replay(recording, mode);
+                    std::printf("%-12s %-12s %-8s %6u %8zu %14.1f %12.4f %12.4f\n", recording.name, mode.name,
+                                sensors, period, result.updates, result.updateTime, result.distance, result.heading);
+                    total.updates += result.updates;
+                    total.updateTime += result.updateTime * result.updates;
+                    total.distance += result.distance;
+                    total.heading += result.heading;
+                    runs++;
+                }
+                // the time is weighted by the updates of each run, and the errors are the mean of the runs
+                std::printf("%-12s %-12s %-8s %6u %8zu %14.1f %12.4f %12.4f\n", "mean", mode.name, sensors, period,
+                            total.updates, total.updateTime / total.updates, total.distance / runs,
+                            total.heading / runs);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Host implementations of the parts of the PROS API that LemLib uses, so LemLib can be built and benchmarked on a
+// computer. Tasks are threads, mutexes are std::mutex, and the clock is the computer's. Devices do nothing. LVGL is
+// stubbed in sim/src/pros/display.cpp
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "pros/rtos.hpp"
+#include "pros/misc.hpp"
+#include "pros/motors.hpp"
+#include "pros/adi.hpp"
+#include "pros/imu.hpp"
+#include "pros/error.h"
+
+// the time the program started, which millis and micros count from
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+/**
+ * @brief The state of a task, which is a thread on the host
+ */
+struct HostTask {
+        uint32_t priority = TASK_PRIORITY_DEFAULT;
+        std::mutex mutex;
+        std::condition_variable wake;
+        uint32_t notifications = 0;
+        std::string name = "main";
+};
+
+// the task the calling thread is running. Threads that weren't made by pros::Task get one when they need it
+static thread_local HostTask* currentTask = nullptr;
+
+static HostTask* currentHostTask() {
+    if (currentTask == nullptr) currentTask = new HostTask();
+    return currentTask;
+}
+
+namespace pros {
+namespace c {
+uint32_t millis(void) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t micros(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(const uint32_t milliseconds) { std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds)); }
+
+task_t task_get_current() { return currentHostTask(); }
+
+uint32_t task_notify(task_t task) {
+    HostTask* state = static_cast<HostTask*>(task);
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->notifications++;
+    state->wake.notify_all();
+    return 1;
+}
+
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) { return 1; }
+
+// the text is accepted, but there is no screen to show it on
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) { return 1; }
+
+// the sticks are centered
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) { return 0; }
+} // namespace c
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name) {
+    HostTask* state = new HostTask();
+    state->priority = prio;
+    if (name != nullptr) state->name = name;
+    task = state;
+    std::thread([state, function, parameters] {
+        currentTask = state;
+        function(parameters);
+    }).detach();
+}
+
+Task::Task(task_t task)
+    : task(task) {}
+
+std::uint32_t Task::get_priority() { return static_cast<HostTask*>(task)->priority; }
+
+void Task::set_priority(std::uint32_t prio) { static_cast<HostTask*>(task)->priority = prio; }
+
+const char* Task::get_name() { return static_cast<HostTask*>(task)->name.c_str(); }
+
+void Task::remove() {
+    // threads can't be killed, so the thread is left to run. Only used when odometry is destroyed
+}
+
+std::uint32_t Task::notify() { return c::task_notify(task); }
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    HostTask* state = currentHostTask();
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->wake.wait_for(lock, std::chrono::milliseconds(timeout), [state] { return state->notifications > 0; });
+    const uint32_t value = state->notifications;
+    if (clear_on_exit) state->notifications = 0;
+    else if (value > 0) state->notifications--;
+    return value;
+}
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    *prev_time += delta;
+    std::this_thread::sleep_until(start + std::chrono::milliseconds(*prev_time));
+}
+
+Mutex::Mutex()
+    : mutex(std::make_shared<std::mutex>()) {}
+
+bool Mutex::take() {
+    static_cast<std::mutex*>(mutex.get())->lock();
+    return true;
+}
+
+bool Mutex::take(std::uint32_t timeout) {
+    if (timeout == 0) return static_cast<std::mutex*>(mutex.get())->try_lock();
+    return this->take();
+}
+
+bool Mutex::give() {
+    static_cast<std::mutex*>(mutex.get())->unlock();
+    return true;
+}
+
+namespace battery {
+int32_t get_voltage(void) { return 12000; }
+} // namespace battery
+
+namespace competition {
+std::uint8_t get_status(void) { return 0; }
+} // namespace competition
+
+namespace usd {
+std::int32_t is_installed(void) { return 0; }
+} // namespace usd
+
+// there are no motors, so motor groups only accept commands
+std::int32_t Motor_Group::move_voltage(const std::int32_t voltage) { return 1; }
+
+std::int32_t Motor_Group::brake(void) { return 1; }
+
+std::int32_t Motor_Group::set_brake_modes(motor_brake_mode_e_t mode) { return 1; }
+
+std::int32_t Motor_Group::set_encoder_units(const motor_encoder_units_e_t units) { return 1; }
+
+std::int32_t Motor_Group::tare_position(void) { return 1; }
+
+std::vector<motor_brake_mode_e_t> Motor_Group::get_brake_modes(void) { return {}; }
+
+std::vector<motor_gearset_e_t> Motor_Group::get_gearing(void) { return {}; }
+
+std::vector<std::int32_t> Motor_Group::get_current_draws(void) { return {}; }
+
+Motor& Motor_Group::operator[](int i) { std::abort(); }
+
+std::int32_t Motor_Group::size() { return 0; }
+
+// there is no inertial sensor, so every IMU reads as unplugged
+std::int32_t Imu::reset(bool blocking) const { return PROS_ERR; }
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const { return PROS_ERR; }
+
+double Imu::get_rotation() const { return PROS_ERR_F; }
+
+double Imu::get_heading() const { return PROS_ERR_F; }
+
+c::quaternion_s_t Imu::get_quaternion() const { return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F}; }
+
+c::euler_s_t Imu::get_euler() const { return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F}; }
+
+double Imu::get_pitch() const { return PROS_ERR_F; }
+
+double Imu::get_roll() const { return PROS_ERR_F; }
+
+double Imu::get_yaw() const { return PROS_ERR_F; }
+
+c::imu_gyro_s_t Imu::get_gyro_rate() const { return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F}; }
+
+std::int32_t Imu::tare_rotation() const { return PROS_ERR; }
+
+std::int32_t Imu::tare_heading() const { return PROS_ERR; }
+
+std::int32_t Imu::tare_pitch() const { return PROS_ERR; }
+
+std::int32_t Imu::tare_yaw() const { return PROS_ERR; }
+
+std::int32_t Imu::tare_roll() const { return PROS_ERR; }
+
+std::int32_t Imu::tare() const { return PROS_ERR; }
+
+std::int32_t Imu::tare_euler() const { return PROS_ERR; }
+
+std::int32_t Imu::set_heading(const double target) const { return PROS_ERR; }
+
+std::int32_t Imu::set_rotation(const double target) const { return PROS_ERR; }
+
+std::int32_t Imu::set_yaw(const double target) const { return PROS_ERR; }
+
+std::int32_t Imu::set_pitch(const double target) const { return PROS_ERR; }
+
+std::int32_t Imu::set_roll(const double target) const { return PROS_ERR; }
+
+std::int32_t Imu::set_euler(const c::euler_s_t target) const { return PROS_ERR; }
+
+c::imu_accel_s_t Imu::get_accel() const { return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F}; }
+
+c::imu_status_e_t Imu::get_status() const { return c::E_IMU_STATUS_ERROR; }
+
+bool Imu::is_calibrating() const { return false; }
+
+c::imu_orientation_e_t Imu::get_physical_orientation() const { return c::E_IMU_Z_UP; }
+
+std::int32_t ADIEncoder::get_value() const { return 0; }
+
+std::int32_t ADIEncoder::reset() const { return 1; }
+} // namespace pros
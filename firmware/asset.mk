@@ -1,10 +1,58 @@
 ASSET_FILES=$(wildcard static/*)
 ASSET_OBJ=$(addprefix $(BINDIR)/, $(addsuffix .o, $(ASSET_FILES)) )
 
-GETALLOBJ=$(sort $(call ASMOBJ,$1) $(call COBJ,$1) $(call CXXOBJ,$1)) $(ASSET_OBJ)
+# text paths (files in static/ with an endData line) are also compiled into the packed binary path format
+# this needs python. If it can't be found, only the text paths are embedded
+PYTHON?=python3
+ifneq ($(shell $(PYTHON) --version 2>/dev/null),)
+PATH_FILES=$(shell grep -l "^endData" $(filter %.txt,$(ASSET_FILES)) 2>/dev/null)
+endif
+# set PATH_COMPRESS:=1 to store paths in the compressed format, which is about 5 times smaller than a text path
+PATH_COMPRESS?=0
+PATH_FLAGS=$(if $(filter 1,$(PATH_COMPRESS)),--compress)
+PATH_BIN=$(addprefix $(BINDIR)/, $(addsuffix .lpb, $(PATH_FILES)))
+# every text path is also packed into one bundle, so a route can use many paths through a single asset
+ifneq ($(PATH_FILES),)
+PATH_BUNDLE=$(BINDIR)/static/paths.lpk
+endif
+PATH_OBJ=$(addsuffix .o, $(PATH_BIN) $(PATH_BUNDLE))
+
+# with USE_PACKAGE:=1 the assets are archived and linked into the cold package, so changing code doesn't upload the
+# paths again, and changing a path doesn't relink the code. Set ASSETS_IN_COLD:=0 to link them into the hot package
+ASSETS_IN_COLD?=1
+ifeq ($(USE_PACKAGE)$(ASSETS_IN_COLD)$(if $(strip $(ASSET_OBJ) $(PATH_OBJ)),1),111)
+ASSET_LIB=$(BINDIR)/assets.a
+LIBRARIES+=$(ASSET_LIB)
+GETALLOBJ=$(sort $(call ASMOBJ,$1) $(call COBJ,$1) $(call CXXOBJ,$1))
+else
+GETALLOBJ=$(sort $(call ASMOBJ,$1) $(call COBJ,$1) $(call CXXOBJ,$1)) $(ASSET_OBJ) $(PATH_OBJ)
+endif
 
 .SECONDEXPANSION:
 $(ASSET_OBJ): $$(patsubst bin/%,%,$$(basename $$@))
 	$(VV)mkdir -p $(BINDIR)/static
 	@echo "ASSET $@"
-	$(VV)$(OBJCOPY) -I binary -O elf32-littlearm -B arm $^ $@
\ No newline at end of file
+	$(VV)$(OBJCOPY) -I binary -O elf32-littlearm -B arm $^ $@
+
+$(PATH_BIN): $$(patsubst bin/%,%,$$(basename $$@)) $(FWDIR)/path2bin.py
+	$(VV)mkdir -p $(BINDIR)/static
+	@echo "PATH $@"
+	$(VV)$(PYTHON) $(FWDIR)/path2bin.py $(PATH_FLAGS) $< $@
+
+$(PATH_BUNDLE): $(PATH_FILES) $(FWDIR)/pathbundle.py $(FWDIR)/path2bin.py
+	$(VV)mkdir -p $(BINDIR)/static
+	@echo "BUNDLE $@"
+	$(VV)$(PYTHON) $(FWDIR)/pathbundle.py $(PATH_FLAGS) $@ $(PATH_FILES)
+
+# symbols are renamed from _binary_bin_static_* to _binary_static_* so PATH_ASSET can find them
+# the data is 4 byte aligned so the floats in the path can be read in place
+$(PATH_OBJ): $$(basename $$@)
+	@echo "ASSET $@"
+	$(VV)$(OBJCOPY) -I binary -O elf32-littlearm -B arm --set-section-alignment .data=4 \
+		$(foreach sym,start end size,--redefine-sym _binary_$(subst .,_,$(subst /,_,$<))_$(sym)=_binary_$(subst .,_,$(subst /,_,$(patsubst bin/%,%,$<)))_$(sym)) \
+		$< $@
+
+$(ASSET_LIB): $(ASSET_OBJ) $(PATH_OBJ)
+	$(VV)rm -f $@
+	@echo "ARCHIVE $@"
+	$(VV)$(AR) rcs $@ $^
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+# Puts LemLib binary telemetry on the clock of the computer, to measure latencies between the brain and the computer
+# usage: clocksync.py [--tokens logtokens.json] [--period seconds] <port>
+#
+# Opens the serial port of the brain, like /dev/ttyACM1, and sends a sync command to TuningConsole every period, one
+# second by default, stamped with the time of the computer. The brain answers each with a clock_sync record holding
+# when it received the command and when it answered, so each round trip gives the offset between the clocks and how
+# long the trip took, like NTP:
+#   offset = ((received - sent) + (answered - arrived)) / 2
+#   delay = (arrived - sent) - (answered - received)
+# The offset is wrong by at most half the delay, so the offset of the round trip with the least delay out of the last
+# few is used. It follows the drift of the clocks, and a trip that waited in a buffer doesn't throw it off.
+#
+# Once the first answer arrives, every record is printed like telemetry.py, with the time on the clock of the computer
+# in front, in milliseconds since the epoch. The sync records are printed with the offset and delay in microseconds,
+# to check the estimate
+import json
+import os
+import select
+import sys
+import time
+import tty
+
+import telemetry
+
+# round trips the offset is picked from
+WINDOW = 8
+
+
+def now():
+    return time.time_ns() // 1000
+
+
+class ClockSync:
+    def __init__(self):
+        self.samples = []
+        self.offset = None
+
+    def add(self, sent, received, answered, arrived):
+        offset = ((received - sent) + (answered - arrived)) / 2
+        delay = (arrived - sent) - (answered - received)
+        self.samples = (self.samples + [(delay, offset)])[-WINDOW:]
+        self.offset = min(self.samples)[1]
+        return offset, delay
+
+    def host_time(self, brain_millis):
+        # the clock of the brain minus the offset is the clock of the computer
+        return (brain_millis * 1000 - self.offset) / 1000
+
+
+def main():
+    args = sys.argv[1:]
+    tokens = {}
+    period = 1.0
+    while len(args) > 1 and args[0] in ("--tokens", "--period"):
+        if args[0] == "--tokens":
+            with open(args[1]) as file:
+                tokens = json.load(file)
+        else:
+            period = float(args[1])
+        args = args[2:]
+    if len(args) != 1:
+        sys.exit("usage: clocksync.py [--tokens logtokens.json] [--period seconds] <port>")
+    port = os.open(args[0], os.O_RDWR | os.O_NOCTTY)
+    tty.setraw(port)
+    sync = ClockSync()
+    # the time each request was sent, by its sequence number
+    sent = {}
+    sequence = 0
+    next_sync = 0
+    pending = b""
+    last = []
+    while True:
+        if time.monotonic() >= next_sync:
+            sequence += 1
+            sent[sequence] = now()
+            # requests that were never answered are forgotten
+            sent.pop(sequence - 2 * WINDOW, None)
+            os.write(port, f"sync {sequence} {sent[sequence]}\n".encode())
+            next_sync = time.monotonic() + period
+        ready, _, _ = select.select([port], [], [], max(next_sync - time.monotonic(), 0))
+        if not ready:
+            continue
+        arrived = now()
+        pending += os.read(port, 4096)
+        # every frame ends with a zero byte. Whatever is left is the start of the next frame
+        *frames, pending = pending.split(b"\0")
+        for frame in frames:
+            # text from the other sinks is in front of the frame, so try every suffix that could be a frame
+            for start in range(len(frame)):
+                record = telemetry.decode(frame[start:], tokens)
+                if record is None:
+                    continue
+                brain_time, name, fields = record
+                if name == "clock_sync":
+                    request, host_sent, received, answered = fields
+                    if sent.pop(request, None) != host_sent:
+                        break
+                    offset, delay = sync.add(host_sent, received, answered, arrived)
+                    fields = list(fields) + [offset, delay]
+                elif name in ("pose_keyframe", "pose_delta"):
+                    fields = telemetry.stream_pose(name, fields, last)
+                    name = "pose_stream"
+                    if fields is None:
+                        break
+                if sync.offset is not None:
+                    host_time = f"{sync.host_time(brain_time):.3f}"
+                    row = [host_time, str(brain_time), name] + [telemetry.format_field(field) for field in fields]
+                    print(",".join(row))
+                    sys.stdout.flush()
+                break
+
+
+if __name__ == "__main__":
+    main()
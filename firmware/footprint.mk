@@ -0,0 +1,15 @@
+.SECONDEXPANSION:
+
+# make footprint reports how much of the image and RAM LemLib adds, split into components
+# it links the monolith image again with a linker map, then footprint.py adds up the sections of each component
+# this needs python
+PYTHON?=python3
+FOOTPRINT_ELF=$(BINDIR)/footprint.elf
+FOOTPRINT_MAP=$(BINDIR)/footprint.map
+
+.PHONY: footprint
+# ELF_DEPS and LIBRARIES are set after this file is included, so they are expanded when the rule is used
+footprint: $$(ELF_DEPS) $$(LIBRARIES) $(FWDIR)/footprint.py
+	$(call _pros_ld_timestamp)
+	$(call test_output_2,Linking $(FOOTPRINT_ELF) with a map ,$(LD) $(LDFLAGS) $(ELF_DEPS) $(LDTIMEOBJ) $(call wlprefix,-T$(FWDIR)/v5.ld $(LNK_FLAGS) -Map=$(FOOTPRINT_MAP)) -o $(FOOTPRINT_ELF),$(OK_STRING))
+	$(VV)$(PYTHON) $(FWDIR)/footprint.py $(FOOTPRINT_MAP)
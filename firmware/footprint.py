@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+# Reports how much of the image and RAM each part of LemLib adds, from a GNU ld linker map
+# usage: footprint.py map
+#
+# Run by make footprint. The V5 runs programs from RAM, so the image is both what is uploaded and RAM it takes. Zeroed
+# RAM (.bss) isn't uploaded. LemLib is split into core, the fmt based logger, path assets, and one line per motion.
+# The logger and the motions are told apart by their source files, so outside the LemLib repository they are counted
+# as core, except for fmt, which is found by the names of its functions
+import os
+import re
+import sys
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+# archive members only keep the name of their file, so the sources are listed by name
+LOGGER_DIR = os.path.join(ROOT, "src", "lemlib", "logger")
+MOTION_DIR = os.path.join(ROOT, "src", "lemlib", "chassis", "motions")
+CODE_EXTENSIONS = ("", ".c", ".cpp", ".cc", ".c++", ".s", ".S")
+# output sections that aren't loaded onto the brain
+UNLOADED = (".debug", ".comment", ".ARM.attributes", ".stab", ".note")
+
+INPUT_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+WRAPPED_NAME = re.compile(r"^ (\S+)$")
+WRAPPED_REST = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+OUTPUT_SECTION = re.compile(r"^(\.\S+|COMMON)")
+ARCHIVE_MEMBER = re.compile(r"^(.*)\((.*)\)$")
+
+
+def source_names(directory):
+    if not os.path.isdir(directory):
+        return set()
+    return {os.path.splitext(name)[0] for name in os.listdir(directory)}
+
+
+LOGGER = source_names(LOGGER_DIR)
+MOTIONS = source_names(MOTION_DIR)
+
+
+def component(section, obj):
+    """The part of LemLib an input section belongs to, or None if it isn't part of LemLib"""
+    # fmt is header only, so its functions are compiled into whichever file uses them
+    if "3fmt" in section:
+        return "logger"
+    match = ARCHIVE_MEMBER.match(obj)
+    archive, name = (match.group(1), match.group(2)) if match else ("", obj)
+    in_lemlib = os.path.basename(archive) in ("LemLib.a", "libLemLib.a") or "/lemlib/" in obj.replace("\\", "/")
+    # objects are named after their file, like chassis.cpp.o
+    stem, extension = os.path.splitext(os.path.splitext(os.path.basename(name))[0])
+    # assets are made by objcopy from the files in static/, and archived in assets.a for the cold package
+    in_assets = os.path.basename(archive) == "assets.a" or "static" in obj.replace("\\", "/").split("/")
+    if in_assets or (in_lemlib and extension not in CODE_EXTENSIONS):
+        return "path assets"
+    if not in_lemlib:
+        return None
+    if stem in LOGGER:
+        return "logger"
+    if stem in MOTIONS:
+        return "motion " + stem
+    return "core"
+
+
+def parse(lines):
+    """Add up the image and zeroed RAM of each component"""
+    totals = {}
+    output = None
+    started = False
+    pending = None
+    for line in lines:
+        line = line.rstrip("\n")
+        if not started:
+            # the sections before this were discarded by --gc-sections
+            started = line.startswith("Linker script and memory map")
+            continue
+        match = OUTPUT_SECTION.match(line)
+        if match:
+            output = match.group(1)
+            pending = None
+            continue
+        if output is None or output.startswith(UNLOADED):
+            continue
+        if pending is not None:
+            rest = WRAPPED_REST.match(line)
+            entry = (pending, rest.group(2), rest.group(3)) if rest else None
+            pending = None
+        else:
+            match = INPUT_SECTION.match(line)
+            entry = (match.group(1), match.group(3), match.group(4)) if match else None
+            wrapped = WRAPPED_NAME.match(line)
+            if entry is None and wrapped and wrapped.group(1) != "*fill*":
+                pending = wrapped.group(1)
+                continue
+        if entry is None or entry[0] == "*fill*":
+            continue
+        section, size, obj = entry[0], int(entry[1], 16), entry[2]
+        if size == 0:
+            continue
+        name = component(section, obj) or "rest of the program"
+        image, zeroed = totals.get(name, (0, 0))
+        if output.startswith(".bss") or section.startswith((".bss", "COMMON")):
+            zeroed += size
+        else:
+            image += size
+        totals[name] = (image, zeroed)
+    return totals
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: footprint.py map")
+    with open(sys.argv[1]) as file:
+        totals = parse(file)
+    rest = totals.pop("rest of the program", (0, 0))
+    order = ["core", "logger", "path assets"] + sorted(name for name in totals if name.startswith("motion "))
+    print("{:<28}{:>12}{:>12}".format("component", "image", "zeroed RAM"))
+    lemlib = [0, 0]
+    for name in order:
+        if name not in totals:
+            continue
+        image, zeroed = totals[name]
+        lemlib[0] += image
+        lemlib[1] += zeroed
+        print("{:<28}{:>12}{:>12}".format(name, image, zeroed))
+    print("{:<28}{:>12}{:>12}".format("LemLib total", lemlib[0], lemlib[1]))
+    print("{:<28}{:>12}{:>12}".format("rest of the program", rest[0], rest[1]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,11 @@
+# make tokens writes the dictionary firmware/telemetry.py uses to turn tokenized log messages back into text
+# every string literal in the source is hashed, so it has to be made again when log messages change
+# this needs python
+PYTHON?=python3
+LOG_TOKENS=$(BINDIR)/logtokens.json
+
+.PHONY: tokens
+tokens: $(FWDIR)/logtokens.py
+	$(VV)mkdir -p $(BINDIR)
+	@echo "TOKENS $(LOG_TOKENS)"
+	$(VV)$(PYTHON) $(FWDIR)/logtokens.py $(LOG_TOKENS) $(SRCDIR) $(INCDIR)
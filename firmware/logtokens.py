@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Makes the dictionary that turns tokenized LemLib log messages back into text
+# usage: logtokens.py <output.json> <source file or directory>...
+#
+# Every string literal in the C and C++ files is hashed like lemlib::logToken, so format strings are found without
+# knowing which calls log. The dictionary is a JSON object from each token, as 8 hex digits, to the format string
+import json
+import os
+import re
+import sys
+
+EXTENSIONS = (".c", ".cc", ".cpp", ".c++", ".h", ".hpp")
+# a string literal without a prefix, a character literal, or a comment
+TOKEN = re.compile(r'"(?:[^"\\\n]|\\.)*"|\'(?:[^\'\\\n]|\\.)*\'|//[^\n]*|/\*.*?\*/', re.S)
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "0": "\0", "\\": "\\", '"': '"', "'": "'"}
+
+
+def log_token(text):
+    # 32 bit FNV-1a, the same as lemlib::logToken
+    value = 0x811C9DC5
+    for byte in text.encode():
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def unescape(text):
+    return re.sub(r"\\(.)", lambda match: ESCAPES.get(match.group(1), match.group(1)), text)
+
+
+def literals(source):
+    # comments and character literals are matched too, so quotes in them don't start strings
+    strings = []
+    joined = False
+    end = 0
+    for match in TOKEN.finditer(source):
+        gap = source[end : match.start()]
+        end = match.end()
+        text = match.group(0)
+        if text.startswith("/"):
+            joined = joined and not gap.strip()
+            continue
+        if text.startswith("'"):
+            joined = False
+            continue
+        text = unescape(text[1:-1])
+        # literals next to each other are one string
+        if joined and not gap.strip():
+            strings[-1] += text
+        else:
+            strings.append(text)
+        joined = True
+    return strings
+
+
+def sources(paths):
+    for path in paths:
+        if os.path.isfile(path):
+            yield path
+        for root, _, files in os.walk(path):
+            for name in sorted(files):
+                if name.endswith(EXTENSIONS):
+                    yield os.path.join(root, name)
+
+
+def main():
+    if len(sys.argv) < 3:
+        sys.exit("usage: logtokens.py <output.json> <source file or directory>...")
+    tokens = {}
+    for path in sources(sys.argv[2:]):
+        with open(path, encoding="utf-8", errors="replace") as file:
+            for text in literals(file.read()):
+                if text:
+                    tokens[f"{log_token(text):08x}"] = text
+    with open(sys.argv[1], "w") as file:
+        json.dump(tokens, file, indent=1, sort_keys=True)
+
+
+if __name__ == "__main__":
+    main()
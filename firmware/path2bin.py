@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+# Converts a LemLib text path into the packed binary path format
+# usage: path2bin.py [--compress] <input.txt> <output.lpb>
+#
+# The binary format is a 16 byte header followed by 3 float32 arrays (x, y, velocity).
+# With --compress, the compressed format is written instead: a 16 byte header, the first point as 2 int32, then
+# int16 x and y deltas in hundredths of an inch, then uint8 quantized velocities.
+# See include/lemlib/path/path.hpp for the layouts
+import struct
+import sys
+
+MAGIC = 0x42504C4C  # "LLPB"
+VERSION = 1
+COMPRESSED_MAGIC = 0x43504C4C  # "LLPC"
+COMPRESSED_VERSION = 1
+
+
+def read_points(path):
+    points = []
+    with open(path, "r") as file:
+        for line in file:
+            line = line.strip()
+            # the path ends at 'endData', the rest of the file is metadata for the path generator
+            if line == "endData":
+                break
+            values = line.split(", ")
+            if len(values) != 3:
+                sys.exit(f"{path}: failed to read path! Are you using the right format? Raw line: {line}")
+            points.append(tuple(float(value) for value in values))
+    return points
+
+
+def pack(points):
+    data = struct.pack("<IHHII", MAGIC, VERSION, 0, len(points), 0)
+    for axis in range(3):
+        data += struct.pack(f"<{len(points)}f", *(point[axis] for point in points))
+    return data
+
+
+def pack_compressed(points, name="path"):
+    # positions are rounded once, and deltas are taken between the rounded positions, so errors don't add up
+    xs = [round(point[0] * 100) for point in points]
+    ys = [round(point[1] * 100) for point in points]
+    first = (xs[0], ys[0]) if points else (0, 0)
+    dx = [x - prev for x, prev in zip(xs, [first[0]] + xs[:-1])]
+    dy = [y - prev for y, prev in zip(ys, [first[1]] + ys[:-1])]
+    if any(abs(delta) > 32767 for delta in dx + dy):
+        sys.exit(f"{name}: points are more than 327 inches apart, so the path can't be compressed")
+    # velocities are quantized to 255 steps of the fastest velocity. The last point stays exactly 0
+    fastest = max((abs(point[2]) for point in points), default=0)
+    scale = fastest / 255 if fastest > 0 else 1
+    velocities = [min(255, round(abs(point[2]) / scale)) for point in points]
+    data = struct.pack("<IHHIf", COMPRESSED_MAGIC, COMPRESSED_VERSION, 0, len(points), scale)
+    data += struct.pack("<ii", *first)
+    data += struct.pack(f"<{len(points)}h", *dx)
+    data += struct.pack(f"<{len(points)}h", *dy)
+    data += bytes(velocities)
+    return data
+
+
+def main():
+    compress = "--compress" in sys.argv[1:]
+    args = [arg for arg in sys.argv[1:] if arg != "--compress"]
+    if len(args) != 2:
+        sys.exit("usage: path2bin.py [--compress] <input.txt> <output.lpb>")
+    points = read_points(args[0])
+    with open(args[1], "wb") as file:
+        file.write(pack_compressed(points, args[0]) if compress else pack(points))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,69 @@
+#!/usr/bin/env python3
+# Packs many LemLib text paths into one path bundle
+# usage: pathbundle.py [--compress] <output.lpk> <input.txt>...
+#
+# Each path is named after its file, without the extension. With --compress, paths are stored in the compressed path
+# format instead of the packed binary path format. The bundle is a 16 byte header, then a hash table of
+# entries, then the paths in the packed binary path format. See include/lemlib/path/bundle.hpp for the layout
+import os
+import struct
+import sys
+
+from path2bin import pack, pack_compressed, read_points
+
+MAGIC = 0x4B504C4C  # "LLPK"
+VERSION = 1
+HEADER_SIZE = 16
+ENTRY_SIZE = 12
+
+
+def name_hash(name):
+    # 32 bit FNV-1a, the same as lemlib::pathNameHash
+    value = 0x811C9DC5
+    for byte in name.encode():
+        value = ((value ^ byte) * 0x01000193) & 0xFFFFFFFF
+    return value
+
+
+def main():
+    compress = "--compress" in sys.argv[1:]
+    args = [arg for arg in sys.argv[1:] if arg != "--compress"]
+    if len(args) < 1:
+        sys.exit("usage: pathbundle.py [--compress] <output.lpk> <input.txt>...")
+    paths = {}
+    for input_path in args[1:]:
+        name = os.path.splitext(os.path.basename(input_path))[0]
+        value = name_hash(name)
+        # 0 marks an empty slot, and names are only stored as hashes
+        if value == 0:
+            sys.exit(f"{input_path}: the name {name} can't be used in a path bundle, please rename it")
+        if value in paths:
+            sys.exit(f"{input_path}: the name {name} collides with {paths[value][0]}, please rename one of them")
+        points = read_points(input_path)
+        paths[value] = (name, pack_compressed(points, input_path) if compress else pack(points))
+
+    # the table is at least twice as big as the number of paths, so lookups rarely probe more than 1 slot
+    table_size = 1
+    while table_size < 2 * len(paths):
+        table_size *= 2
+    table = [(0, 0, 0)] * table_size
+    data = b""
+    offset = HEADER_SIZE + table_size * ENTRY_SIZE
+    for value, (name, path) in paths.items():
+        slot = value & (table_size - 1)
+        while table[slot][2] != 0:
+            slot = (slot + 1) & (table_size - 1)
+        table[slot] = (value, offset + len(data), len(path))
+        # binary paths are made of floats, which have to stay 4 byte aligned
+        data += path
+        data += b"\0" * (-len(data) % 4)
+
+    with open(args[0], "wb") as file:
+        file.write(struct.pack("<IHHII", MAGIC, VERSION, 0, len(paths), table_size))
+        for entry in table:
+            file.write(struct.pack("<III", *entry))
+        file.write(data)
+
+
+if __name__ == "__main__":
+    main()
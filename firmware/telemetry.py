@@ -0,0 +1,208 @@
+#!/usr/bin/env python3
+# Decodes LemLib binary telemetry into CSV
+# usage: telemetry.py [--tokens logtokens.json] [input]
+#
+# Reads the raw terminal output of the brain, or a motion trace from the SD card, from a file, or stdin if no file is
+# given, and prints one line per record: time in milliseconds, record type, then the fields. Text that isn't a
+# telemetry frame is skipped. See include/lemlib/logger/binaryTelemetry.hpp for the frame layout
+#
+# Tokenized log messages are turned back into text with the dictionary from logtokens.py, and printed like other
+# messages. Without it, or if the token isn't in it, they are printed as the level, the token, and the arguments
+import json
+import string
+import struct
+import sys
+
+RECORDS = {
+    1: ("pose", "<fff"),
+    2: ("velocity", "<ff"),
+    3: ("motor_output", "<ff"),
+    4: ("pid", "<Bffff"),
+    5: ("pose_keyframe", "<hhhhh"),
+    6: ("pose_delta", "<bbbbb"),
+    7: ("motion", "<BB14f"),
+    8: ("sensor_frame", "<fffff"),
+    11: ("path", "<fffff"),
+    12: ("motion_summary", "<BBHI6f"),
+    13: ("clock_sync", "<IQQQ"),
+}
+# records whose payload is a level, a sequence number, the time in microseconds, and text
+MESSAGE = 9
+# records whose payload is a level, the token of a format string, and its arguments
+TOKEN = 10
+# the target fields of a pose stream record when there is no target
+NO_TARGET = -32768
+
+
+def crc16(data):
+    # CRC-16/CCITT-FALSE, the same as the brain
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021 if crc & 0x8000 else crc << 1) & 0xFFFF
+    return crc
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data) + 1:
+            return None
+        out += data[i + 1 : i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def shortest(value):
+    # floats are sent as float32, so print the fewest digits that read back as the same float32
+    for digits in range(1, 10):
+        text = f"{value:.{digits}g}"
+        if struct.pack("<f", float(text)) == struct.pack("<f", value):
+            return float(text)
+    return value
+
+
+def token_args(payload):
+    # each argument is a struct type character and the value, or s, a uint8 length, and the text
+    args = []
+    i = 0
+    while i < len(payload):
+        kind = chr(payload[i])
+        if kind == "s":
+            if i + 2 > len(payload):
+                return None
+            length = payload[i + 1]
+            args.append(payload[i + 2 : i + 2 + length].decode("utf-8", "replace"))
+            i += 2 + length
+            continue
+        if kind not in "?ciIqQf" or i + 1 + struct.calcsize("<" + kind) > len(payload):
+            return None
+        (value,) = struct.unpack_from("<" + kind, payload, i + 1)
+        i += 1 + struct.calcsize("<" + kind)
+        args.append(value.decode("latin-1") if kind == "c" else shortest(value) if kind == "f" else value)
+    return args
+
+
+def format_message(text, args):
+    # fmt uses the same format specifications as Python. Automatic and numbered fields are both used in order
+    out = []
+    index = 0
+    for literal, field, spec, _ in string.Formatter().parse(text):
+        out.append(literal)
+        if field is None:
+            continue
+        if field:
+            value = args[int(field)]
+        else:
+            value = args[index]
+            index += 1
+        # fmt writes bools as words, and floats that are whole numbers without a decimal point
+        if isinstance(value, bool) and not spec:
+            value = "true" if value else "false"
+        elif isinstance(value, float) and not spec:
+            value = repr(value).removesuffix(".0")
+        try:
+            out.append(format(value, spec))
+        except (TypeError, ValueError):
+            out.append(str(value))
+    return "".join(out)
+
+
+def decode(frame, tokens):
+    data = cobs_decode(frame)
+    if data is None or len(data) < 7:
+        return None
+    body, (crc,) = data[:-2], struct.unpack("<H", data[-2:])
+    if crc16(body) != crc:
+        return None
+    kind, time = body[0], struct.unpack("<I", body[1:5])[0]
+    if kind == MESSAGE and len(body) >= 18:
+        sequence, micros = struct.unpack("<IQ", body[6:18])
+        return time, "message", (body[5], sequence, micros, body[18:].decode("utf-8", "replace"))
+    if kind == TOKEN and len(body) >= 10:
+        level, (token,) = body[5], struct.unpack("<I", body[6:10])
+        args = token_args(body[10:])
+        if args is None:
+            return None
+        text = tokens.get(f"{token:08x}")
+        if text is not None:
+            try:
+                return time, "message", (level, None, None, format_message(text, args))
+            except (IndexError, ValueError):
+                pass
+        return time, "token", [level, f"{token:08x}"] + args
+    if kind not in RECORDS:
+        return None
+    name, layout = RECORDS[kind]
+    payload = body[5:]
+    if len(payload) != struct.calcsize(layout):
+        return None
+    return time, name, struct.unpack(layout, payload)
+
+
+def stream_pose(name, fields, last):
+    # turns pose stream records back into poses. Deltas can't be decoded until the first keyframe
+    if name == "pose_keyframe":
+        last[:] = fields
+    elif last:
+        last[:] = [value + change for value, change in zip(last, fields)]
+        last[2] = (last[2] + 18000) % 36000 - 18000
+    else:
+        return None
+    target = [] if last[3] == NO_TARGET else [last[3] / 100, last[4] / 100]
+    return [last[0] / 100, last[1] / 100, last[2] / 100] + target
+
+
+def format_field(field):
+    # text is quoted, since it can have commas in it
+    if field is None:
+        return ""
+    if isinstance(field, str):
+        return '"' + field.replace('"', '""') + '"'
+    if isinstance(field, int):
+        return str(int(field))
+    return f"{field:g}"
+
+
+def main():
+    args = sys.argv[1:]
+    tokens = {}
+    if args[:1] == ["--tokens"] and len(args) >= 2:
+        with open(args[1]) as file:
+            tokens = json.load(file)
+        args = args[2:]
+    if len(args) > 1:
+        sys.exit("usage: telemetry.py [--tokens logtokens.json] [input]")
+    stream = open(args[0], "rb") if args else sys.stdin.buffer
+    pending = b""
+    last = []
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        pending += chunk
+        # every frame ends with a zero byte. Whatever is left is the start of the next frame
+        *frames, pending = pending.split(b"\0")
+        for frame in frames:
+            # text from the other sinks is in front of the frame, so try every suffix that could be a frame
+            for start in range(len(frame)):
+                record = decode(frame[start:], tokens)
+                if record is not None:
+                    time, name, fields = record
+                    if name in ("pose_keyframe", "pose_delta"):
+                        fields = stream_pose(name, fields, last)
+                        name = "pose_stream"
+                        if fields is None:
+                            break
+                    print(",".join([str(time), name] + [format_field(field) for field in fields]))
+                    sys.stdout.flush()
+                    break
+
+
+if __name__ == "__main__":
+    main()
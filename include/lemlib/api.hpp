@@ -1,10 +1,55 @@
 #pragma once
 
 #include "lemlib/pid.hpp"
+#include "lemlib/gainSchedule.hpp"
+#include "lemlib/feedforward.hpp"
+#include "lemlib/motionProfile.hpp"
+#include "lemlib/trajectory.hpp"
+#include "lemlib/leastSquares.hpp"
 #include "lemlib/pose.hpp"
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/fastmath.hpp"
+#include "lemlib/units.hpp"
+#include "lemlib/fixed.hpp"
+#include "lemlib/ringBuffer.hpp"
+#include "lemlib/staticVector.hpp"
+#include "lemlib/boundedQueue.hpp"
+#include "lemlib/loopProfiler.hpp"
+#include "lemlib/profiler.hpp"
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/taskConfig.hpp"
+#include "lemlib/mechanism.hpp"
+#include "lemlib/scheduler.hpp"
+#include "lemlib/staticMemory.hpp"
+#include "lemlib/routine.hpp"
+#include "lemlib/matchClock.hpp"
+#include "lemlib/configStore.hpp"
 #include "lemlib/util.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/chassis/particleFilter.hpp"
+#include "lemlib/chassis/relocalizer.hpp"
+#include "lemlib/chassis/ekf.hpp"
+#include "lemlib/chassis/imuGroup.hpp"
+#include "lemlib/chassis/holonomic.hpp"
+#include "lemlib/chassis/tuningConsole.hpp"
+#include "lemlib/chassis/fieldDisplay.hpp"
+#include "lemlib/chassis/sensorLog.hpp"
+#include "lemlib/chassis/motionTrace.hpp"
+#include "lemlib/chassis/motionLog.hpp"
+#include "lemlib/chassis/driverLatency.hpp"
+#include "lemlib/chassis/driverMacro.hpp"
+#include "lemlib/chassis/routineProgram.hpp"
+#include "lemlib/chassis/routineRegistry.hpp"
+#include "lemlib/chassis/flightRecorder.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/path/pathCache.hpp"
+#include "lemlib/path/pathView.hpp"
+#include "lemlib/path/generator.hpp"
+#include "lemlib/path/bundle.hpp"
+#include "lemlib/path/splinePath.hpp"
+#include "lemlib/path/gridPlanner.hpp"
+#include "lemlib/path/bakedPath.hpp"
 #include "lemlib/logger/logger.hpp"
 
 // using to shorten lemlib::AngularDirection to just AngularDirection
@@ -16,3 +16,22 @@ typedef struct __attribute__((__packed__)) _asset {
     extern uint8_t _binary_static_##x##_start[], _binary_static_##x##_size[];                                          \
     static asset x = {_binary_static_##x##_start, (size_t)_binary_static_##x##_size};                                  \
     }
+
+/**
+ * @brief Use the packed binary version of a text path in static/
+ *
+ * Text paths are compiled into the binary path format at build time by asset.mk. Binary paths can be followed
+ * without being parsed, so the robot starts moving sooner. With `PATH_COMPRESS:=1` in the Makefile, paths are
+ * compressed instead, which makes them about 5 times smaller than text paths
+ *
+ * @b Example
+ * @code {.cpp}
+ * // use the binary version of "myPath.txt"
+ * PATH_ASSET(myPath_txt); // we replace "." with "_" to make the asset name valid
+ * @endcode
+ */
+#define PATH_ASSET(x)                                                                                                  \
+    extern "C" {                                                                                                       \
+    extern uint8_t _binary_static_##x##_lpb_start[], _binary_static_##x##_lpb_size[];                                  \
+    static asset x = {_binary_static_##x##_lpb_start, (size_t)_binary_static_##x##_lpb_size};                          \
+    }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Helpers for the binary formats LemLib saves to the SD card, like driver macros, routine programs, and paths
+ */
+
+namespace lemlib {
+/**
+ * @brief Append a value to a buffer, little endian. The V5 is little endian, so the bytes are copied directly
+ *
+ * @param data the buffer
+ * @param value the value
+ */
+template <typename T> void put(std::vector<uint8_t>& data, T value) {
+    const size_t position = data.size();
+    data.resize(position + sizeof(value));
+    std::memcpy(data.data() + position, &value, sizeof(value));
+}
+
+/**
+ * @brief Read a value written by put, if there are enough bytes left
+ *
+ * @param data the buffer
+ * @param position where the value starts. Moved past the value if it was read
+ * @param value where the value is read to
+ * @return false there aren't enough bytes left
+ */
+template <typename T> bool get(const std::vector<uint8_t>& data, size_t& position, T& value) {
+    if (position + sizeof(value) > data.size()) return false;
+    std::memcpy(&value, data.data() + position, sizeof(value));
+    position += sizeof(value);
+    return true;
+}
+
+/**
+ * @brief Read a whole file
+ *
+ * @param path the path of the file
+ * @return std::vector<uint8_t> the contents of the file, or nothing if it couldn't be opened
+ */
+std::vector<uint8_t> readFile(const std::string& path);
+
+/**
+ * @brief Write a whole file, replacing it if it exists. An error is logged if it can't be written
+ *
+ * @param path the path of the file
+ * @param data the contents of the file
+ * @return false the file couldn't be written
+ */
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data);
+} // namespace lemlib
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lemlib {
+/**
+ * @brief A bounded, lock-free queue that any number of tasks can push to and pop from
+ *
+ * Each slot has a sequence number that tells producers and consumers whether it is free or full, so a task is never
+ * blocked by another task that was preempted halfway through an operation. The slots are allocated once, when the
+ * queue is constructed. Based on Dmitry Vyukov's bounded MPMC queue
+ *
+ * @tparam T the type of the elements. Elements are copied in and out of the queue
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::BoundedQueue<int> queue(8);
+ * queue.push(5);
+ * int value;
+ * if (queue.pop(value)) std::cout << value << std::endl;
+ * @endcode
+ */
+template <typename T> class BoundedQueue {
+    public:
+        /**
+         * @brief Construct a new Bounded Queue
+         *
+         * @param capacity the minimum number of elements the queue can hold. Rounded up to a power of 2
+         */
+        BoundedQueue(size_t capacity)
+            : slots(roundUp(capacity)),
+              mask(slots.size() - 1) {
+            for (size_t i = 0; i < slots.size(); i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        /**
+         * @brief Add an element to the back of the queue
+         *
+         * @param value the element
+         * @return true the element was added
+         * @return false the queue is full
+         */
+        bool push(const T& value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &slots[position & mask];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const intptr_t difference = intptr_t(sequence) - intptr_t(position);
+                // the slot is free, so try to claim it
+                if (difference == 0) {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if (difference < 0) {
+                    return false; // the slot hasn't been popped since the last lap, so the queue is full
+                } else {
+                    position = tail.load(std::memory_order_relaxed); // another task claimed the slot
+                }
+            }
+            slot->value = value;
+            // let consumers read the slot
+            slot->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Remove the element at the front of the queue
+         *
+         * @param value where the element is copied to
+         * @return true an element was removed
+         * @return false the queue is empty
+         */
+        bool pop(T& value) {
+            size_t position = head.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &slots[position & mask];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const intptr_t difference = intptr_t(sequence) - intptr_t(position + 1);
+                // the slot is full, so try to claim it
+                if (difference == 0) {
+                    if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if (difference < 0) {
+                    return false; // the slot hasn't been pushed to yet, so the queue is empty
+                } else {
+                    position = head.load(std::memory_order_relaxed); // another task claimed the slot
+                }
+            }
+            value = slot->value;
+            // let producers write to the slot on the next lap
+            slot->sequence.store(position + mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        /**
+         * @brief Get the number of elements in the queue
+         *
+         * @return size_t the number of elements. Only approximate if other tasks are using the queue
+         */
+        size_t size() const {
+            const size_t count = tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed);
+            return count > slots.size() ? 0 : count;
+        }
+
+        /**
+         * @brief Get the number of elements the queue can hold
+         *
+         * @return size_t the capacity
+         */
+        size_t capacity() const { return slots.size(); }
+    private:
+        struct Slot {
+                std::atomic<size_t> sequence;
+                T value;
+        };
+
+        /**
+         * @brief Round a capacity up to a power of 2, so positions can be wrapped with a mask
+         */
+        static size_t roundUp(size_t capacity) {
+            size_t result = 2;
+            while (result < capacity) result *= 2;
+            return result;
+        }
+
+        std::vector<Slot> slots;
+        const size_t mask;
+        std::atomic<size_t> head = 0;
+        std::atomic<size_t> tail = 0;
+};
+} // namespace lemlib
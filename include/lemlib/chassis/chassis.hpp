@@ -1,55 +1,51 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
 #include "pros/rtos.hpp"
 #include "pros/motors.hpp"
 #include "pros/imu.hpp"
+#include "pros/misc.hpp"
 #include "lemlib/asset.hpp"
+#include "lemlib/configStore.hpp"
+#include "lemlib/boundedQueue.hpp"
+#include "lemlib/chassis/motionHandle.hpp"
+#include "lemlib/chassis/motionTrace.hpp"
+#include "lemlib/chassis/motionLog.hpp"
+#include "lemlib/chassis/flightRecorder.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/chassis/particleFilter.hpp"
+#include "lemlib/chassis/powerManager.hpp"
+#include "lemlib/chassis/holonomic.hpp"
+#include "lemlib/chassis/thermalModel.hpp"
+#include "lemlib/chassis/driverLatency.hpp"
+#include "lemlib/chassis/driverMacro.hpp"
 #include "lemlib/pose.hpp"
 #include "lemlib/pid.hpp"
 #include "lemlib/exitcondition.hpp"
+#include "lemlib/fieldTransform.hpp"
 #include "lemlib/driveCurve.hpp"
+#include "lemlib/feedforward.hpp"
+#include "lemlib/loopProfiler.hpp"
+#include "lemlib/motionProfile.hpp"
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/trajectory.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/path/pathView.hpp"
+#include "lemlib/path/bundle.hpp"
+#include "lemlib/path/splinePath.hpp"
 
 namespace lemlib {
 
-/**
- * @brief class containing the sensors used for odometry
- */
-class OdomSensors {
-    public:
-        /**
-         * The sensors are stored in a class so that they can be easily passed to the chassis class
-         * The variables are pointers so that they can be set to nullptr if they are not used
-         * Otherwise the chassis class would have to have a constructor for each possible combination of sensors
-         *
-         * @param vertical1 pointer to the first vertical tracking wheel
-         * @param vertical2 pointer to the second vertical tracking wheel
-         * @param horizontal1 pointer to the first horizontal tracking wheel
-         * @param horizontal2 pointer to the second horizontal tracking wheel
-         * @param imu pointer to the IMU
-         *
-         * @b Example
-         * @code {.cpp}
-         * pros::Rotation vertical_rotation(1); // rotation sensor on port 1
-         * pros::Imu imu(2); // IMU on port 2
-         * // tracking wheel using a new 2.75" wheel, 0.5 inches to the right of the tracking center
-         * lemlib::TrackingWheel vertical1(&vertical_rotation, lemlib::Omniwheel::NEW_275, 0.5);
-         * lemlib::OdomSensors sensors(&vertical1, // vertical tracking wheel
-         *                     nullptr, // no second vertical tracking wheel, set to nullptr
-         *                     nullptr, // no horizontal tracking wheels, set to nullptr
-         *                     nullptr, // no second horizontal tracking wheel, set to nullptr
-         *                     &imu); // IMU
-         * @endcode
-         */
-        OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
-                    TrackingWheel* horizontal2, pros::Imu* imu);
-        TrackingWheel* vertical1;
-        TrackingWheel* vertical2;
-        TrackingWheel* horizontal1;
-        TrackingWheel* horizontal2;
-        pros::Imu* imu;
-};
-
 /**
  * @brief class containing constants for a chassis controller
  */
@@ -74,6 +70,15 @@ class ControllerSettings {
          * @param largeErrorTimeout the time the chassis controller will wait before exiting if error is within a
          * certain range determined by largeError
          * @param slew maximum acceleration
+         * @param gyroDerivative whether the derivative is calculated from the angular velocity measured by the
+         * inertial sensor instead of the change in error. Only used by the angular controller in turns and swings.
+         * false by default
+         * @param maxVelocity maximum velocity of the motion profile, in inches per second for the lateral controller
+         * and degrees per second for the angular controller. The profile is disabled if this or maxAcceleration is 0.
+         * 0 by default
+         * @param maxAcceleration maximum acceleration of the motion profile, per second squared. 0 by default
+         * @param maxJerk maximum jerk of the motion profile, per second cubed. The profile is trapezoidal if this is 0,
+         * and an S-curve otherwise. 0 by default
          *
          * @b Example
          * @code {.cpp}
@@ -89,7 +94,8 @@ class ControllerSettings {
          * @endcode
          */
         ControllerSettings(float kP, float kI, float kD, float windupRange, float smallError, float smallErrorTimeout,
-                           float largeError, float largeErrorTimeout, float slew)
+                           float largeError, float largeErrorTimeout, float slew, bool gyroDerivative = false,
+                           float maxVelocity = 0, float maxAcceleration = 0, float maxJerk = 0)
             : kP(kP),
               kI(kI),
               kD(kD),
@@ -98,7 +104,11 @@ class ControllerSettings {
               smallErrorTimeout(smallErrorTimeout),
               largeError(largeError),
               largeErrorTimeout(largeErrorTimeout),
-              slew(slew) {}
+              slew(slew),
+              gyroDerivative(gyroDerivative),
+              maxVelocity(maxVelocity),
+              maxAcceleration(maxAcceleration),
+              maxJerk(maxJerk) {}
 
         float kP;
         float kI;
@@ -109,6 +119,74 @@ class ControllerSettings {
         float largeError;
         float largeErrorTimeout;
         float slew;
+        bool gyroDerivative;
+        float maxVelocity;
+        float maxAcceleration;
+        float maxJerk;
+        /**
+         * gain schedule that replaces kP, kI, and kD, so short and long motions can use different gains. Set it
+         * before constructing the chassis. Disabled by default
+         */
+        std::optional<GainSchedule> gainSchedule = std::nullopt;
+        /** time constant of the derivative filter, in 10 ms updates. See PID::setDerivativeFilter. 0 by default */
+        float derivativeFilter = 0;
+        /**
+         * how the integral is kept from winding up while the output is more than the motors can do. See
+         * PID::setOutputLimit. Disabled by default
+         */
+        AntiWindup antiWindup = AntiWindup::NONE;
+        /**
+         * speed below which the small error exit can end a motion early, if the robot is in range and is predicted to
+         * stop in range. Inches per second for the lateral controller, degrees per second for the angular
+         * controller. 0 to always wait for smallErrorTimeout, which is the default
+         */
+        float exitVelocity = 0;
+};
+
+/**
+ * @brief Enum class DriveSide
+ *
+ * When using swing turns, the user needs to specify what side of the drivetrain should be locked
+ * we could just use an integer or boolean for this, but using an enum class improves readability
+ *
+ * This enum class only has 2 values, LEFT and RIGHT
+ */
+enum class DriveSide {
+    LEFT, /** lock the left side of the drivetrain */
+    RIGHT /** lock the right side of the drivetrain */
+};
+
+/**
+ * @brief The products of the geometry of a drivetrain that motions use every iteration
+ *
+ * Motions get them from Drivetrain::kinematics when they start, so the divisions and multiplications behind them run
+ * once per motion instead of every iteration. The drivetrain can change its geometry at runtime, so motions always use
+ * the kinematics of the drivetrain as it is, even if a constexpr DrivetrainKinematics with the same constants exists
+ */
+struct DrivetrainKinematics {
+        /**
+         * @brief Work out the kinematics of a drivetrain. Can be evaluated at compile time
+         *
+         * @param trackWidth the track width of the robot, in inches
+         * @param wheelDiameter the diameter of the wheels, in inches
+         * @param rpm the rpm of the wheels
+         * @param horizontalDrift the horizontal drift of the drivetrain
+         */
+        constexpr DrivetrainKinematics(float trackWidth, float wheelDiameter, float rpm, float horizontalDrift)
+            : halfTrack(trackWidth / 2),
+              topSpeed(float(rpm * M_PI * wheelDiameter / 60)),
+              speedPerPower(topSpeed / 127),
+              slipAcceleration(horizontalDrift * 9.8f) {}
+
+        /** half the track width, in inches. Each side moves along an arc of this radius in a turn in place */
+        float halfTrack;
+        /** speed of the wheels at full power, in inches per second */
+        float topSpeed;
+        /** speed of the wheels per unit of power, in inches per second */
+        float speedPerPower;
+        /** the horizontal drift times gravity. The fastest the robot goes around a turn of radius r without slipping
+         * is sqrt(slipAcceleration * r) */
+        float slipAcceleration;
 };
 
 /**
@@ -130,6 +208,10 @@ class Drivetrain {
          * @param rpm the rpm of the wheels
          * @param horizontalDrift higher values make the robot move faster but causes more overshoot on turns.
          * Recommended value of 2 if not using traction wheels, 8 if using traction wheels
+         * @param powerManager keeps the drivetrain within a current and voltage budget. nullptr by default, for no
+         * budget
+         * @param holonomic the wheels of an X-drive or a mecanum drive, so motions can strafe. nullptr by default, for
+         * a drivetrain that can't
          *
          * @b Example
          * @code {.cpp}
@@ -154,13 +236,53 @@ class Drivetrain {
          * @endcode
          */
         Drivetrain(pros::MotorGroup* leftMotors, pros::MotorGroup* rightMotors, float trackWidth, float wheelDiameter,
-                   float rpm, float horizontalDrift);
+                   float rpm, float horizontalDrift, PowerManager* powerManager = nullptr,
+                   HolonomicDrivetrain* holonomic = nullptr);
+        /**
+         * @brief Set the brake mode of both sides of the drivetrain
+         *
+         * The brake mode last set on each side is remembered, so a side is only sent a brake command when its mode
+         * changes. Set the brake mode of the motors through the drivetrain, so what it remembers stays right
+         *
+         * @param mode the brake mode
+         */
+        void setBrakeMode(pros::motor_brake_mode_e mode);
+        /**
+         * @brief Set the brake mode of 1 side of the drivetrain
+         *
+         * @param side the side of the drivetrain
+         * @param mode the brake mode
+         */
+        void setBrakeMode(DriveSide side, pros::motor_brake_mode_e mode);
+        /**
+         * @brief Get the brake mode of 1 side of the drivetrain
+         *
+         * The motors are only asked the first time, before any brake mode has been set through the drivetrain
+         *
+         * @param side the side of the drivetrain
+         * @return pros::motor_brake_mode_e the brake mode
+         */
+        pros::motor_brake_mode_e getBrakeMode(DriveSide side);
+        /**
+         * @brief Get the kinematics of the drivetrain, from its current geometry
+         *
+         * Motions get this once when they start, and use the products in it every iteration
+         *
+         * @return DrivetrainKinematics the kinematics
+         */
+        DrivetrainKinematics kinematics() const;
         pros::Motor_Group* leftMotors;
         pros::Motor_Group* rightMotors;
         float trackWidth;
         float wheelDiameter;
         float rpm;
         float horizontalDrift;
+        PowerManager* powerManager;
+        HolonomicDrivetrain* holonomic;
+    private:
+        /** the brake mode last set on each side, or E_MOTOR_BRAKE_INVALID if it isn't known yet */
+        pros::motor_brake_mode_e leftBrakeMode = pros::E_MOTOR_BRAKE_INVALID;
+        pros::motor_brake_mode_e rightBrakeMode = pros::E_MOTOR_BRAKE_INVALID;
 };
 
 /**
@@ -176,6 +298,26 @@ enum class AngularDirection {
     AUTO /** turn in the direction with the shortest distance to target */
 };
 
+/**
+ * @brief How urgent a motion is
+ *
+ * Motions run before queued motions with a lower priority, and a motion that is queued while a motion with a lower
+ * priority runs preempts it on the next tick. What happens to preempted motions is set by Chassis::setPreemptPolicy
+ */
+enum class MotionPriority : uint8_t {
+    NORMAL, /** motions of the autonomous routine */
+    ELEVATED, /** motions that should interrupt the routine, like lining up with a game element that was just seen */
+    URGENT /** motions that interrupt everything else, like a defensive reaction */
+};
+
+/**
+ * @brief What happens to the motions a motion with a higher priority preempts
+ */
+enum class PreemptPolicy : uint8_t {
+    SUSPEND, /** the running motion starts again from where the robot is once the preempting motions are done */
+    DROP /** the running motion is cancelled, and the queued motions with a lower priority are skipped */
+};
+
 /**
  * @brief Parameters for Chassis::turnToPoint
  *
@@ -197,6 +339,14 @@ struct TurnToPointParams {
         /** angle between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /**
+         * whether the turn follows a motion profile at the limits of the drivetrain, with feedforward, when the angular
+         * controller doesn't set its own maxVelocity and maxAcceleration. Set a feedforward model with setFeedforward
+         * first, or the PID has to push the robot along the profile on its own. False by default
+         */
+        bool timeOptimal = false;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
 };
 
 /**
@@ -218,19 +368,14 @@ struct TurnToHeadingParams {
         /** angle between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
-};
-
-/**
- * @brief Enum class DriveSide
- *
- * When using swing turns, the user needs to specify what side of the drivetrain should be locked
- * we could just use an integer or boolean for this, but using an enum class improves readability
- *
- * This enum class only has 2 values, LEFT and RIGHT
- */
-enum class DriveSide {
-    LEFT, /** lock the left side of the drivetrain */
-    RIGHT /** lock the right side of the drivetrain */
+        /**
+         * whether the turn follows a motion profile at the limits of the drivetrain, with feedforward, when the angular
+         * controller doesn't set its own maxVelocity and maxAcceleration. Set a feedforward model with setFeedforward
+         * first, or the PID has to push the robot along the profile on its own. False by default
+         */
+        bool timeOptimal = false;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
 };
 
 /**
@@ -254,6 +399,20 @@ struct SwingToPointParams {
         /** angle between the robot and target heading where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /**
+         * whether the swing follows a motion profile at the limits of the drivetrain, with feedforward, when the
+         * angular controller doesn't set its own maxVelocity and maxAcceleration. The profile limits the velocity and
+         * acceleration of the outer wheel, so it doesn't skid. Set a feedforward model with setFeedforward first.
+         * False by default
+         */
+        bool timeOptimal = false;
+        /**
+         * coefficient of friction between the wheels and the field, which limits how hard a time optimal swing can
+         * accelerate and how fast it can go around the arc. 1 by default
+         */
+        float traction = 1;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
 };
 
 /**
@@ -275,6 +434,20 @@ struct SwingToHeadingParams {
         /** angle between the robot and target heading where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /**
+         * whether the swing follows a motion profile at the limits of the drivetrain, with feedforward, when the
+         * angular controller doesn't set its own maxVelocity and maxAcceleration. The profile limits the velocity and
+         * acceleration of the outer wheel, so it doesn't skid. Set a feedforward model with setFeedforward first.
+         * False by default
+         */
+        bool timeOptimal = false;
+        /**
+         * coefficient of friction between the wheels and the field, which limits how hard a time optimal swing can
+         * accelerate and how fast it can go around the arc. 1 by default
+         */
+        float traction = 1;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
 };
 
 /**
@@ -301,6 +474,22 @@ struct MoveToPoseParams {
         /** distance between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /** whether the trig in the motion loop uses the faster float approximations in fastmath.hpp. False by
+         * default */
+        bool fastMath = false;
+        /** how far ahead the pose the motion acts on is predicted, in milliseconds, to make up for the time it takes
+         * the pose to be measured and the motors to respond. 0 by default */
+        float latencyCompensationMs = 0;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
+        /** when the robot should reach the target, in milliseconds from the start of the motion. The speed is lowered
+         * to the slowest one that the motion profile says still gets there in time. 0, the default, drives as fast
+         * as maxSpeed allows */
+        float deadlineMs = 0;
+        /** whether a holonomic drivetrain strafes straight to the target while it turns to the heading, instead of
+         * driving a boomerang curve. Only has an effect if the drivetrain is holonomic. lead, horizontalDrift, and
+         * forwards are ignored. False by default */
+        bool holonomic = false;
 };
 
 /**
@@ -322,6 +511,524 @@ struct MoveToPointParams {
         /** distance between the robot and target point where the movement will exit. Only has an effect if minSpeed is
          * non-zero.*/
         float earlyExitRange = 0;
+        /** whether the trig in the motion loop uses the faster float approximations in fastmath.hpp. False by
+         * default */
+        bool fastMath = false;
+        /** how far ahead the pose the motion acts on is predicted, in milliseconds, to make up for the time it takes
+         * the pose to be measured and the motors to respond. 0 by default */
+        float latencyCompensationMs = 0;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
+        /** when the robot should reach the target, in milliseconds from the start of the motion. The speed is lowered
+         * to the slowest one that the motion profile says still gets there in time. 0, the default, drives as fast
+         * as maxSpeed allows */
+        float deadlineMs = 0;
+};
+
+/**
+ * @brief Parameters for Chassis::follow
+ *
+ * The path slows down to 0 at its end, so without these the robot stops there. With them, the motion exits while the
+ * robot is still moving, so the next motion takes it at speed
+ */
+struct FollowParams {
+        /** the minimum speed the robot can travel at. If set to a non-zero value, the robot doesn't slow down below
+         * it at the end of the path, and reaching the end exits early instead of settling. Value between 0-127. 0 by
+         * default */
+        float minSpeed = 0;
+        /** distance left to the end of the path where the movement will exit, in inches. 0 by default */
+        float earlyExitRange = 0;
+        /** distance left to the end of the path where the robot stops following it, and settles on its end with the
+         * lateral controller, in the same motion. The motion then ends when the lateral exit conditions are met,
+         * like moveToPoint, instead of when the robot passes the last point. Ignored when minSpeed is set. 0, the
+         * default, follows the path to its end */
+        float finishDistance = 0;
+};
+
+/**
+ * @brief Optional parameters of Chassis::replayMacro
+ *
+ * The corrections are added to the power the sticks give, and grow with how far the robot is from where it was when
+ * the macro was recorded. Set the gains to 0 to replay the sticks as they were
+ */
+struct MacroParams {
+        /** power added per inch the robot is behind the recorded pose, or taken away per inch it is ahead. 4 by
+         * default */
+        float kLinear = 4;
+        /** power per inch the robot is to the side of the recorded pose, turning it back towards it. 2 by default */
+        float kLateral = 2;
+        /** power per degree the heading is off the recorded heading, turning it back. 1 by default */
+        float kAngular = 1;
+        /** most power the corrections can add to or take from a side. 40 by default */
+        float maxCorrection = 40;
+        /** how urgent the motion is. Motions with a higher priority preempt it. NORMAL by default */
+        MotionPriority priority = MotionPriority::NORMAL;
+};
+
+/**
+ * @brief A target in a motion chain, see Chassis::moveChain
+ */
+struct ChainTarget {
+        /** x location of the target, in inches */
+        float x;
+        /** y location of the target, in inches */
+        float y;
+        /** heading the robot should reach the target at, in degrees. NAN, the default, drives straight to the
+         * point with moveToPoint instead of moveToPose */
+        float theta = NAN;
+        /** whether the robot should move forwards or backwards to reach the target. True by default */
+        bool forwards = true;
+};
+
+/**
+ * @brief Parameters for Chassis::moveChain
+ *
+ * We use a struct to simplify customization. Chassis::moveChain has many
+ * parameters and specifying them all just to set one optional param harms
+ * readability. By passing a struct to the function, we can have named
+ * parameters, overcoming the c/c++ limitation
+ */
+struct ChainParams {
+        /** the maximum speed the robot can travel at. Value between 0-127. 127 by default */
+        float maxSpeed = 127;
+        /** how fast the robot can move around corners. 0 means use horizontalDrift set in the chassis class. 0 by
+         * default */
+        float horizontalDrift = 0;
+        /** carrot point multiplier of the targets with a heading. 0.6 by default */
+        float lead = 0.6;
+        /** distance from each target, except the last, where the robot starts driving to the next one. Larger values
+         * let the robot take corners faster. 6 inches by default */
+        float exitRange = 6;
+        /**
+         * distance before each target without a heading where the robot starts steering toward the next target, in
+         * inches. The aim moves smoothly from one target to the next, so the robot curves through the corner instead
+         * of turning sharply when the next segment starts. 0, the default, doesn't blend
+         */
+        float blendRadius = 0;
+};
+
+/**
+ * @brief Settings for an adaptive lookahead distance in Chassis::follow
+ *
+ * The lookahead grows with the speed of the robot, so it doesn't oscillate on straights, and shrinks around sharp
+ * turns, so it doesn't cut corners. The lookahead passed to follow is the most it can grow to
+ */
+struct AdaptiveLookahead {
+        /** the shortest lookahead, used when the robot is stopped, in inches */
+        float minLookahead;
+        /** how much the lookahead grows with the speed of the robot, in inches per inch per second */
+        float speedGain;
+        /** how much the lookahead shrinks with the sharpest curvature ahead of the robot. The lookahead is divided by
+         * 1 + curvatureGain * curvature, so a gain of 10 halves it on a 10 inch radius turn */
+        float curvatureGain;
+};
+
+/**
+ * @brief Settings for slip detection and traction control, set with Chassis::setTractionControl
+ *
+ * A side is slipping when the speed of its wheels, measured by the motor encoders, is further from its speed over the
+ * ground, measured by the tracking wheels, than slipSpeed plus slipRatio times the speed over the ground
+ */
+struct TractionSettings {
+        /** the smallest difference in speed that counts as slip, in inches per second. 6 by default */
+        float slipSpeed = 6;
+        /** the fraction of the speed over the ground added to slipSpeed, so noise at speed isn't slip. 0.15 by
+         * default */
+        float slipRatio = 0.15;
+        /**
+         * the most the power can grow per 10 ms while a side slips, from 0 to 127. Slowing down is never limited. 0
+         * to only detect slip. 3 by default
+         */
+        float ramp = 3;
+};
+
+/**
+ * @brief The slip of the drivetrain, measured by Chassis::getSlip
+ */
+struct SlipState {
+        /** the speed of the left wheels minus the speed of the left side over the ground, in inches per second */
+        float left = 0;
+        /** the speed of the right wheels minus the speed of the right side over the ground, in inches per second */
+        float right = 0;
+        /** whether either side is slipping */
+        bool slipping = false;
+};
+
+/**
+ * @brief Settings for the velocity loop of each drivetrain side, set with Chassis::setVelocityControl
+ *
+ * The gains turn the difference between the velocity a motion asks a side for and the velocity its motor encoders
+ * measure, in inches per second, into power from -127 to 127, which is added to the feedforward
+ */
+struct VelocityControlSettings {
+        /** proportional gain. 1 by default */
+        float kP = 1;
+        /** integral gain, which makes up for a battery that is running down. 0.05 by default */
+        float kI = 0.05;
+        /** derivative gain. 0 by default */
+        float kD = 0;
+        /** the most the loop can add to or take from the feedforward, from 0 to 127. 40 by default */
+        float maxCorrection = 40;
+};
+
+/**
+ * @brief Settings for battery voltage compensation, set with Chassis::setBatteryCompensation
+ */
+struct BatteryCompensationSettings {
+        /**
+         * the battery voltage the chassis was tuned at, in millivolts. Every command is scaled so the motors get the
+         * voltage they would have got from a battery at this voltage. 12000 by default
+         */
+        float nominal = 12000;
+        /** time between reads of the battery, in milliseconds. 100 by default */
+        uint32_t period = 100;
+};
+
+/**
+ * @brief Settings for stopping the drivetrain actively at the end of a motion, set with Chassis::setActiveStop
+ *
+ * Each side is driven against its velocity, with a power proportional to how fast its wheels turn, until it has
+ * nearly stopped, then braked
+ */
+struct ActiveStopSettings {
+        /** the power against the velocity for each inch per second the wheels turn, out of 127. 3 by default */
+        float kP = 3;
+        /** the most power the robot is stopped with, out of 127. Less power skids less. 80 by default */
+        float maxPower = 80;
+        /** how slow a side has to turn to be stopped, in inches per second. 2 by default */
+        float stopSpeed = 2;
+        /** the longest the robot is driven to a stop, in milliseconds. 150 by default */
+        uint32_t maxTime = 150;
+        /** whether the motors are braked once stopped, with their brake mode, instead of sent 0 volts. true by
+         * default */
+        bool brake = true;
+};
+
+/**
+ * @brief Settings for holding the robot where the last motion left it, set with Chassis::setPoseHold
+ *
+ * The robot is driven back towards the pose with a power proportional to how far it was pushed, and braked once it
+ * is within the tolerances
+ */
+struct PoseHoldSettings {
+        /** the power for each inch the robot was pushed, out of 127. 10 by default */
+        float kP = 10;
+        /** the turning power for each degree the robot was turned, out of 127. 2 by default */
+        float kTurn = 2;
+        /** the most power the robot is held with, out of 127. 60 by default */
+        float maxPower = 60;
+        /** how far the robot can be pushed before it is driven back, in inches. 0.5 by default */
+        float tolerance = 0.5;
+        /** how far the robot can be turned before it is turned back, in degrees. 1 by default */
+        float angleTolerance = 1;
+        /** time between corrections, in milliseconds. 20 by default */
+        uint32_t period = 20;
+};
+
+/**
+ * @brief Settings for ending motions when the robot stalls against something, set with Chassis::setStallDetection
+ *
+ * The robot is stalled while the drivetrain is commanded at least minPower, odometry measures the robot moving and
+ * turning slower than stallSpeed, and the drive motors either turn slower than stallSpeed or draw at least
+ * minCurrent, which catches wheels spinning in place against a wall
+ */
+struct StallSettings {
+        /** the least power a side has to be commanded to be pushing, out of 127. 40 by default */
+        float minPower = 40;
+        /** how slow the robot and the drive wheels move to be stalled, in inches per second. 2 by default */
+        float stallSpeed = 2;
+        /** the current the drive motors draw on average when pushing, in milliamps. 0 to not read the current.
+         * 1500 by default */
+        float minCurrent = 1500;
+        /** how long the robot has to be stalled for the motion to end, in milliseconds. 100 by default */
+        uint32_t time = 100;
+        /**
+         * the walls of the field, to correct odometry against when the robot stalls square against one. The position
+         * across the wall is set so the bumper touches it at the next update of odometry, if odometry is within
+         * maxCorrection of that. Only the position is corrected. std::nullopt to not correct odometry, which is the
+         * default
+         */
+        std::optional<FieldMap> walls = std::nullopt;
+        /** distance from the tracking center to the front and back bumpers, in inches. 7 by default */
+        float frontOffset = 7;
+        float backOffset = 7;
+        /** the most odometry is corrected by a wall, in inches. 6 by default */
+        float maxCorrection = 6;
+        /** the most the robot can be turned from square to a wall for it to correct odometry, in degrees. 10 by
+         * default */
+        float squareAngle = 10;
+};
+
+/**
+ * @brief Settings for detecting when the robot is hit, set with Chassis::setCollisionDetection
+ *
+ * The accelerometer of the inertial sensor is read by the tracking task every update. A hit is a jump in the
+ * acceleration of the robot across the field between 2 updates, which driving the robot can't cause
+ */
+struct CollisionSettings {
+        /** the jump in acceleration that is a collision, in g. 1.5 by default */
+        float threshold = 1.5;
+        /** how long after a collision the next one can be detected, so 1 hit isn't counted several times, in
+         * milliseconds. 300 by default */
+        uint32_t cooldown = 300;
+        /** whether the running motion ends with MotionEndReason::COLLIDED once it has run its collision callbacks.
+         * false by default */
+        bool abort = false;
+};
+
+/**
+ * @brief A collision detected by Chassis::setCollisionDetection
+ */
+struct Collision {
+        /** how many collisions have been detected. 0 if there haven't been any */
+        uint32_t count = 0;
+        /** when the collision was detected, in milliseconds */
+        uint32_t time = 0;
+        /** the jump in acceleration, in g */
+        float strength = 0;
+};
+
+/**
+ * @brief Settings for limiting the acceleration of the robot when it starts to tip, set with Chassis::setAntiTip
+ *
+ * The tilt is how far the pitch or the roll of the inertial sensor has moved from where it was when the motion
+ * started, plus how far it is turning towards tipping over the lead time. Up to tiltStart the robot accelerates with
+ * the full slew, and from there the slew falls to minScale of it at tiltLimit
+ */
+struct AntiTipSettings {
+        /** the slew of the lateral output while the robot is stable. 0 to use the slew of the lateral controller.
+         * 0 by default */
+        float slew = 0;
+        /** the tilt the slew starts falling at, in degrees. 3 by default */
+        float tiltStart = 3;
+        /** the tilt the slew is at its lowest at, in degrees. 10 by default */
+        float tiltLimit = 10;
+        /** the lowest fraction of the slew the robot accelerates with, from 0 to 1. 0.2 by default */
+        float minScale = 0.2;
+        /** how far ahead the tilt is predicted from how fast it is changing, in milliseconds. 100 by default */
+        float lead = 100;
+};
+
+/**
+ * @brief The control schemes the driver control task can drive with
+ *
+ * Chassis::holonomic isn't one of them: it reads 3 axes, and macros record 2. A holonomic drivetrain is driven by
+ * calling it in the opcontrol loop
+ */
+enum class DriveScheme {
+    TANK, /** Chassis::tank */
+    ARCADE, /** Chassis::arcade */
+    CURVATURE /** Chassis::curvature */
+};
+
+/**
+ * @brief Settings for the driver control task of Chassis::startDriverControl
+ */
+struct DriverControlSettings {
+        /** the control scheme. ARCADE by default */
+        DriveScheme scheme = DriveScheme::ARCADE;
+        /** the controller that is read. The master controller by default */
+        pros::controller_id_e_t controller = pros::E_CONTROLLER_MASTER;
+        /** the axis that drives forwards and backwards, or the left side in tank. The left y axis by default */
+        pros::controller_analog_e_t throttleAxis = pros::E_CONTROLLER_ANALOG_LEFT_Y;
+        /** the axis that turns in arcade and curvature. The right x axis by default */
+        pros::controller_analog_e_t turnAxis = pros::E_CONTROLLER_ANALOG_RIGHT_X;
+        /** the axis that drives the right side in tank. The right y axis by default */
+        pros::controller_analog_e_t rightAxis = pros::E_CONTROLLER_ANALOG_RIGHT_Y;
+        /** whether to disable the drive curves. false by default */
+        bool disableDriveCurve = false;
+        /** how much arcade favors turning over driving when the motors are saturated. 0.5 by default */
+        float desaturateBias = 0.5;
+        /** time between reads of the controller, in milliseconds. 5 by default, how often the motors take commands */
+        uint32_t period = 5;
+};
+
+/**
+ * @brief The state of the inertial sensor of a chassis
+ */
+enum class ImuState {
+    MISSING, /** the chassis has no inertial sensor, or hasn't been calibrated */
+    CALIBRATING, /** the inertial sensor is calibrating. Odometry runs without it */
+    READY, /** the inertial sensor is calibrated and used by odometry */
+    FAILED /** every calibration attempt failed. Odometry runs without it */
+};
+
+/**
+ * @brief The motions that can be run by the motion task
+ */
+enum class MotionType {
+    TURN_TO_POINT, /** Chassis::turnToPoint */
+    TURN_TO_HEADING, /** Chassis::turnToHeading */
+    SWING_TO_POINT, /** Chassis::swingToPoint */
+    SWING_TO_HEADING, /** Chassis::swingToHeading */
+    MOVE_TO_POSE, /** Chassis::moveToPose */
+    MOVE_TO_POINT, /** Chassis::moveToPoint */
+    FOLLOW, /** Chassis::follow */
+    TRAJECTORY, /** Chassis::followTrajectory */
+    MACRO /** Chassis::replayMacro */
+};
+
+/**
+ * @brief A controller that can be tuned by Chassis::autotune
+ */
+enum class AutotuneController { LATERAL, ANGULAR };
+
+/**
+ * @brief Gains proposed by Chassis::autotune
+ */
+struct AutotuneResult {
+        /** whether the robot oscillated for enough cycles to measure. The gains are 0 if it didn't */
+        bool success = false;
+        /** proposed proportional gain */
+        float kP = 0;
+        /** proposed integral gain */
+        float kI = 0;
+        /** proposed derivative gain */
+        float kD = 0;
+        /** measured ultimate gain, in power per inch or per degree */
+        float ultimateGain = 0;
+        /** measured ultimate period, in milliseconds */
+        float ultimatePeriod = 0;
+};
+
+/**
+ * @brief Odometry values measured by Chassis::calibrateOdometry
+ *
+ * Values that weren't measured, like the offsets of tracking wheels the robot doesn't have, are NAN
+ */
+struct OdomCalibrationResult {
+        /** whether the robot finished the test. Nothing is stored if it didn't */
+        bool success = false;
+        /** the scale of the inertial sensor, see Odometry::setImuScale */
+        float imuScale = NAN;
+        /** offsets of the tracking wheels, in inches */
+        float vertical1Offset = NAN;
+        float vertical2Offset = NAN;
+        float horizontal1Offset = NAN;
+        float horizontal2Offset = NAN;
+        /** diameters of the vertical tracking wheels, in inches */
+        float vertical1Diameter = NAN;
+        float vertical2Diameter = NAN;
+        /** the track width the drive wheels turn with, in inches. Usually a little wider than they are apart, since
+         * the wheels scrub */
+        float trackWidth = NAN;
+};
+
+/**
+ * @brief How long the motion task takes to react, measured by Chassis::measureMotionLatency
+ *
+ * Each timing is the time from the call to the first voltage the drivetrain motors are sent, in microseconds
+ */
+struct MotionLatency {
+        /** from queueing a motion while the chassis is idle, to the motion driving */
+        TimingStats start;
+        /** from queueing an URGENT motion while another motion runs, to the urgent motion driving */
+        TimingStats preempt;
+        /** from cancelling a running motion, to the drivetrain being stopped */
+        TimingStats stop;
+        /** number of times each was measured */
+        uint32_t samples = 0;
+};
+
+/**
+ * @brief The pose of a chassis, and the sensor readings it goes with, as Chassis::enableCheckpoints stores it
+ *
+ * The checksum covers every field before it, so a checkpoint that was cut off while it was written is rejected
+ */
+struct PoseCheckpoint {
+        /** magic number used to identify checkpoints. Always equal to CHECKPOINT_MAGIC */
+        uint32_t magic = 0;
+        /** version of the checkpoint format. Always equal to CHECKPOINT_VERSION */
+        uint32_t version = 0;
+        /** the pose from odometry, before the field transform, in inches and radians */
+        float x = 0;
+        float y = 0;
+        float theta = 0;
+        /** the rotation the inertial sensor read, in degrees. NAN if it wasn't calibrated */
+        float imuRotation = NAN;
+        /** the distances the drive motors read, in inches. They keep counting while the program isn't running */
+        float left = 0;
+        float right = 0;
+        /** CRC-32 of the fields before it */
+        uint32_t checksum = 0;
+};
+
+static_assert(sizeof(PoseCheckpoint) == 36, "PoseCheckpoint must be 36 bytes");
+
+/** magic number of checkpoints, "LLCK" in little endian */
+constexpr uint32_t CHECKPOINT_MAGIC = 0x4B434C4C;
+/** current version of the checkpoint format */
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+/**
+ * @brief The state of the motion task
+ *
+ * Only the motion task starts and ends motions. Other tasks can only cancel them
+ */
+enum class MotionState : uint8_t {
+    IDLE, /** no motion is running */
+    STARTING, /** a motion is being taken from the queue */
+    RUNNING, /** a motion is running */
+    CANCELLING /** the motion was cancelled, and will stop on its next iteration */
+};
+
+/**
+ * @brief A motion waiting to be run by the motion task
+ *
+ * Commands are copied into the motion queue, so everything the motion needs is stored by value. Fields the motion
+ * doesn't use are ignored
+ */
+struct MotionCommand {
+        /** the motion to run */
+        MotionType type;
+        /** the parameters of the motion. Empty when following a trajectory */
+        std::variant<std::monostate, TurnToPointParams, TurnToHeadingParams, SwingToPointParams, SwingToHeadingParams,
+                     MoveToPoseParams, MoveToPointParams, FollowParams, MacroParams>
+            params;
+        /** x location of the target, in inches */
+        float x = 0;
+        /** y location of the target, in inches */
+        float y = 0;
+        /** target heading, in degrees */
+        float theta = 0;
+        /** longest time the motion can run for, in milliseconds */
+        int timeout = 0;
+        /** the side of the drivetrain locked in a swing */
+        DriveSide lockedSide = DriveSide::LEFT;
+        /** the path to follow */
+        asset path = {nullptr, 0};
+        /** the path to follow, if it wasn't loaded from an asset. Owned by the user */
+        const Path* pathData = nullptr;
+        /** the path view to follow, if it has points. The view is copied, but the paths it views are owned by the
+         * user */
+        PathView view;
+        /** the spline path to follow. Owned by the user */
+        const SplinePath* spline = nullptr;
+        /** the lookahead distance when following a path, in inches */
+        float lookahead = 0;
+        /** whether the path is followed forwards */
+        bool forwards = true;
+        /** when the robot should reach the end of the path, in milliseconds from the start of the motion. 0 if it has
+         * no deadline */
+        int deadline = 0;
+        /** the trajectory to follow. Owned by the user */
+        const Trajectory* trajectory = nullptr;
+        /** the driver macro to replay. Owned by the user */
+        const DriverMacro* macro = nullptr;
+        /** x location of the target moveToPoint blends into near its own target, in inches. NAN if it doesn't blend */
+        float blendX = NAN;
+        /** y location of the target moveToPoint blends into, in inches */
+        float blendY = NAN;
+        /** distance before its target where moveToPoint starts blending into the next target, in inches */
+        float blendRadius = 0;
+        /** the field transform when the motion was queued. Path assets are loaded with it. Set by the chassis */
+        FieldTransform transform;
+        /** how urgent the motion is. Set by the chassis from the parameters. Path motions are always NORMAL */
+        MotionPriority priority = MotionPriority::NORMAL;
+        /** value of the cancel generation when the motion was queued. Set by the chassis */
+        uint32_t generation = 0;
+        /** the id of the motion. Set by the chassis */
+        uint32_t id = 0;
 };
 
 // default drive curve
@@ -330,7 +1037,7 @@ extern ExpoDriveCurve defaultDriveCurve;
 /**
  * @brief Chassis class
  */
-class Chassis {
+class Chassis : public MotionExecutor {
     public:
         /**
          * @brief Chassis constructor
@@ -370,30 +1077,116 @@ class Chassis {
          */
         void calibrate(bool calibrateIMU = true);
         /**
-         * @brief Set the pose of the chassis
+         * @brief Calibrate the chassis sensors, calibrating the IMU in the background
          *
-         * @param x new x value
-         * @param y new y value
-         * @param theta new theta value
-         * @param radians true if theta is in radians, false if not. False by default
+         * Unlike calibrate, this returns as soon as odometry is running, instead of waiting the 2 to 3 seconds each
+         * IMU calibration attempt takes. Until the IMU is calibrated, odometry tracks heading with the tracking wheels
+         * or drivetrain. Once it is, the IMU is switched in at the current heading, so the pose doesn't jump. If every
+         * attempt fails, odometry keeps running without it
+         *
+         * @param callback called with READY or FAILED once calibration ends. It runs on the calibration task, so it
+         * may block. nullptr by default
+         * @param arg the argument passed to the callback. nullptr by default
          *
          * @b Example
          * @code {.cpp}
-         * // set the pose of the chassis to x = 0, y = 0, theta = 0
-         * chassis.setPose(0, 0, 0);
-         * // set the pose of the chassis to x = 5.3, y = 12.2, theta = 3.14
-         * // this time with theta in radians
-         * chassis.setPose(5.3, 12.2, 3.14, true);
+         * void initialize() {
+         *     chassis.calibrateAsync();
+         *     // the screen starts while the IMU calibrates
+         *     pros::lcd::initialize();
+         * }
+         *
+         * void autonomous() {
+         *     // turns need the IMU, so wait for it
+         *     chassis.waitForImu();
+         *     chassis.turnToHeading(90, 1000);
+         * }
          * @endcode
          */
-        void setPose(float x, float y, float theta, bool radians = false);
+        void calibrateAsync(void (*callback)(ImuState state, void* arg) = nullptr, void* arg = nullptr);
         /**
-         * @brief Set the pose of the chassis
+         * @brief Get the state of the inertial sensor
          *
-         * @param pose the new pose
-         * @param radians whether pose theta is in radians (true) or not (false). false by default
+         * @return ImuState the state. MISSING until the chassis is calibrated
+         */
+        ImuState getImuState() const;
+        /**
+         * @brief Block the calling task until the inertial sensor has finished calibrating
          *
-         * @b Example
+         * Returns immediately if it isn't calibrating
+         *
+         * @param timeout the longest time to wait, in milliseconds. TIMEOUT_MAX by default
+         * @return ImuState the state when the wait ended. CALIBRATING if it timed out
+         */
+        ImuState waitForImu(uint32_t timeout = TIMEOUT_MAX);
+        /**
+         * @brief Store the pose on the SD card periodically, so warmStart can pick it up after the program restarts
+         *
+         * The checkpoint is written by a task at the lowest priority, so the card never holds up odometry or
+         * motions. It is only written when the robot has moved since the last one, so the card doesn't wear out while
+         * the robot sits still. Call it once the chassis is calibrated
+         *
+         * @param path the path of the file. "/usd/lemlib.ckpt" by default
+         * @param period time between checkpoints, in milliseconds. 250 by default
+         */
+        void enableCheckpoints(const std::string& path = "/usd/lemlib.ckpt", uint32_t period = 250);
+        /**
+         * @brief Calibrate the chassis, skipping the IMU calibration and restoring the pose if the robot hasn't moved
+         * since the last checkpoint
+         *
+         * The inertial sensor stays calibrated while the brain is on, even when the program crashes or restarts, and
+         * the drive motors keep counting. If the checkpoint is intact, the inertial sensor reads the same rotation,
+         * and the drive motors the same distances, the robot is where the checkpoint says it is, so odometry starts
+         * from there within a few milliseconds. Otherwise the chassis is calibrated as calibrate does
+         *
+         * @note a brain that was turned off and on again calibrates the inertial sensor as it starts, and the drive
+         * motors read 0. That only matches a checkpoint of a robot that hadn't moved, which is still where it was
+         *
+         * @param path the path of the checkpoint. "/usd/lemlib.ckpt" by default
+         * @return true the pose was restored, and the inertial sensor wasn't calibrated again
+         * @return false the chassis was calibrated from the start
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // back on the field in under a second after a crash in the middle of practice
+         *     if (!chassis.warmStart()) chassis.setPose(0, 0, 0);
+         *     chassis.enableCheckpoints();
+         * }
+         * @endcode
+         */
+        bool warmStart(const std::string& path = "/usd/lemlib.ckpt");
+        /**
+         * @brief Set the pose of the chassis
+         *
+         * The pose is in the coordinates of the route, so it goes through the field transform like the targets of
+         * motions
+         *
+         * @param x new x value
+         * @param y new y value
+         * @param theta new theta value
+         * @param radians true if theta is in radians, false if not. False by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // set the pose of the chassis to x = 0, y = 0, theta = 0
+         * chassis.setPose(0, 0, 0);
+         * // set the pose of the chassis to x = 5.3, y = 12.2, theta = 3.14
+         * // this time with theta in radians
+         * chassis.setPose(5.3, 12.2, 3.14, true);
+         * @endcode
+         */
+        void setPose(float x, float y, float theta, bool radians = false);
+        /**
+         * @brief Set the pose of the chassis
+         *
+         * The pose is in the coordinates of the route, so it goes through the field transform like the targets of
+         * motions
+         *
+         * @param pose the new pose
+         * @param radians whether pose theta is in radians (true) or not (false). false by default
+         *
+         * @b Example
          * @code {.cpp}
          * // set the pose of the chassis to x = 0, y = 0, theta = 0
          * lemlib::Pose poseA(0, 0, 0);
@@ -428,11 +1221,42 @@ class Chassis {
          * @endcode
          */
         Pose getPose(bool radians = false, bool standardPos = false);
+        /**
+         * @brief Get the pose of the chassis, predicted a short time ahead from its speed
+         *
+         * @param latency how far ahead to predict, in milliseconds. 0 or less returns the same pose as getPose
+         * @param radians whether theta should be in radians (true) or degrees (false). false by default
+         * @param standardPos whether theta should be in standard position, like getPose. false by default
+         * @return Pose the predicted pose
+         *
+         * @b Example
+         * @code {.cpp}
+         * // where the robot will be in 20 ms, if it keeps its speed
+         * lemlib::Pose pose = chassis.getPredictedPose(20);
+         * @endcode
+         */
+        Pose getPredictedPose(float latency, bool radians = false, bool standardPos = false);
+        /**
+         * @brief Get the odometry of the chassis
+         *
+         * Each chassis has its own odometry, so more than 1 chassis can be tracked at the same time
+         *
+         * @return Odometry& the odometry
+         *
+         * @b Example
+         * @code {.cpp}
+         * // get the speed of the chassis
+         * lemlib::Pose speed = chassis.getOdometry().getSpeed();
+         * @endcode
+         */
+        Odometry& getOdometry();
         /**
          * @brief Wait until the robot has traveled a certain distance along the path
          *
          * @note Units are in inches if current motion is moveToPoint, moveToPose or follow, degrees for everything else
          *
+         * The motion task notifies the waiting task as soon as the distance is reached, using a task notification
+         *
          * @param dist the distance the robot needs to travel before returning
          *
          * @b Example
@@ -483,6 +1307,257 @@ class Chassis {
          * @endcode
          */
         void setBrakeMode(pros::motor_brake_mode_e mode);
+        /**
+         * @brief Set the feedforward model of the drivetrain
+         *
+         * With a model, follow treats the velocities in the path as inches per second and turns them into voltages,
+         * and profiled motions add the voltage needed to follow the profile to the output of their PIDs
+         *
+         * @param feedforward the model. Disabled by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // kS, kV, and kA of the drivetrain
+         * chassis.setFeedforward(lemlib::Feedforward(0.8, 0.18, 0.02));
+         * @endcode
+         */
+        void setFeedforward(Feedforward feedforward);
+        /**
+         * @brief Get the feedforward model of the drivetrain
+         *
+         * @return Feedforward the model
+         */
+        Feedforward getFeedforward();
+        /**
+         * @brief Replace the tuning values of the chassis with the ones in a config store
+         *
+         * Values the store doesn't have keep the ones the chassis was constructed with. Odometry reads the offsets
+         * and the inertial sensor scale when the chassis is calibrated, so this has to be called before calibrate.
+         * The values are named:
+         * - lateral.kP, lateral.kI, lateral.kD, angular.kP, angular.kI, angular.kD: the PID gains
+         * - feedforward.kS, feedforward.kV, feedforward.kA: the feedforward model
+         * - vertical1.offset, vertical2.offset, horizontal1.offset, horizontal2.offset: the tracking wheel offsets,
+         *   in inches. Only used for tracking wheels the chassis was given
+         * - vertical1.diameter, vertical2.diameter, horizontal1.diameter, horizontal2.diameter: the tracking wheel
+         *   diameters, in inches. Only used for tracking wheels the chassis was given
+         * - drivetrain.trackWidth: the track width, in inches
+         * - imu.scale: the scale of the inertial sensor, see Odometry::setImuScale
+         *
+         * @param config the store, after it has been loaded
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::ConfigStore config("/usd/robot.cfg");
+         *
+         * void initialize() {
+         *     config.load();
+         *     chassis.loadConfig(config);
+         *     chassis.calibrate();
+         * }
+         * @endcode
+         */
+        void loadConfig(const ConfigStore& config);
+        /**
+         * @brief Store the tuning values of the chassis in a config store, and write it to the SD card
+         *
+         * The values are named as in loadConfig. Other values in the store are kept
+         *
+         * @param config the store
+         * @return true the store was written
+         * @return false there is no SD card, or the file couldn't be written
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     // measure the drivetrain, and keep the result for the next run
+         *     chassis.setFeedforward(chassis.characterize());
+         *     chassis.saveConfig(config);
+         * }
+         * @endcode
+         */
+        bool saveConfig(ConfigStore& config);
+        /**
+         * @brief Change a tuning value of the chassis while it is running
+         *
+         * The change is queued and applied by the motion task at the start of its next iteration, or when the next
+         * motion starts, so a motion never sees half of a change. The values are named:
+         * - lateral.kP, lateral.kI, lateral.kD, angular.kP, angular.kI, angular.kD: the PID gains
+         * - lateral.slew, angular.slew: the slew rates
+         * - lateral.smallError, lateral.smallErrorTimeout, lateral.largeError, lateral.largeErrorTimeout, and the same
+         *   for angular: the exit conditions
+         * - feedforward.kS, feedforward.kV, feedforward.kA: the feedforward model
+         *
+         * @param key the name of the value
+         * @param value the new value
+         * @return true the change was queued
+         * @return false the chassis has no value with that name, or too many changes are waiting
+         *
+         * @b Example
+         * @code {.cpp}
+         * // try a higher kD on the next turn
+         * chassis.setParameter("angular.kD", 12);
+         * chassis.turnToHeading(90, 1000);
+         * @endcode
+         */
+        bool setParameter(std::string_view key, float value);
+        /**
+         * @brief Get a tuning value of the chassis
+         *
+         * @param key the name of the value, as in setParameter
+         * @return std::optional<float> the value, without changes that haven't been applied yet. std::nullopt if the
+         * chassis has no value with that name
+         */
+        std::optional<float> getParameter(std::string_view key);
+        /**
+         * @brief Make follow change its lookahead distance with the speed of the robot and the curvature of the path
+         *
+         * @param settings the settings. std::nullopt, the default, uses the lookahead passed to follow the whole path
+         *
+         * @b Example
+         * @code {.cpp}
+         * // 6 inches when stopped, plus 0.15 inches for every inch per second, shrinking on tight turns
+         * chassis.setAdaptiveLookahead(lemlib::AdaptiveLookahead {6, 0.15, 10});
+         * // the lookahead can grow up to 15 inches
+         * chassis.follow(myPath_txt, 15, 4000);
+         * @endcode
+         */
+        void setAdaptiveLookahead(std::optional<AdaptiveLookahead> settings);
+        /**
+         * @brief Set how far ahead follow predicts the pose it acts on, to make up for the latency of the loop
+         *
+         * The pose from odometry is up to an update old when the motion reads it, and the motors take time to respond
+         * to a new command. Acting on the pose extrapolated from the speed of the robot by that latency lets follow
+         * use higher gains without oscillating. moveToPose and moveToPoint have the same option in their parameters
+         *
+         * @param ms the prediction, in milliseconds. 0, the default, acts on the latest pose
+         *
+         * @b Example
+         * @code {.cpp}
+         * // predict the pose 15 ms ahead, about 1 odometry update and the response of the motors
+         * chassis.setFollowLatencyCompensation(15);
+         * chassis.follow(myPath_txt, 15, 4000);
+         * @endcode
+         */
+        void setFollowLatencyCompensation(float ms);
+        /**
+         * @brief Measure the feedforward model of the drivetrain
+         *
+         * Runs 4 tests, each forwards then backwards so the robot ends up near where it started: a quasistatic test
+         * that ramps the voltage slowly, then a dynamic test that applies a voltage step. The velocity is measured by
+         * the vertical tracking wheels if there are any, and by the drivetrain motors otherwise. kS, kV, and kA are
+         * fit on the robot with a streaming least squares fit, and the result is set as the feedforward model of
+         * the chassis. This blocks until the tests are done, and cancels any running motion
+         *
+         * @param rampRate how fast the voltage ramps in the quasistatic test, in volts per second. 1 by default
+         * @param stepVoltage the voltage of the dynamic test, in volts. 6 by default
+         * @param duration how long each test runs, in milliseconds. Make sure the robot has room to drive for this
+         * long. 2000 by default
+         * @return Feedforward the measured model. The current model if the fit failed
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     // measure the drivetrain, and print the constants
+         *     lemlib::Feedforward feedforward = chassis.characterize();
+         *     std::cout << feedforward.kS << ", " << feedforward.kV << ", " << feedforward.kA << std::endl;
+         * }
+         * @endcode
+         */
+        Feedforward characterize(float rampRate = 1, float stepVoltage = 6, uint32_t duration = 2000);
+        /**
+         * @brief Propose PID gains with a relay feedback test
+         *
+         * The drivetrain is driven with a constant power that flips direction whenever the robot crosses where it
+         * started, which makes it oscillate around the start. The amplitude and period of the oscillation give the
+         * ultimate gain and period of the controller, and the gains are found from them with the Ziegler-Nichols
+         * rules. The gains are tuned for the 10 ms loop period the chassis scales to. The result is logged, and
+         * appended to autotune.txt on the SD card if there is one. This blocks until the test is done, and cancels
+         * any running motion
+         *
+         * @param controller the controller to tune
+         * @param relayPower the power of the relay, from 0 to 127. 40 by default
+         * @param cycles the number of oscillations to measure, after the first one. 4 by default
+         * @param timeout longest time the test can take, in milliseconds. 5000 by default
+         * @return AutotuneResult the proposed gains
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     // tune the angular controller
+         *     lemlib::AutotuneResult result = chassis.autotune(lemlib::AutotuneController::ANGULAR);
+         *     if (result.success) std::cout << result.kP << ", " << result.kI << ", " << result.kD << std::endl;
+         * }
+         * @endcode
+         */
+        AutotuneResult autotune(AutotuneController controller, float relayPower = 40, int cycles = 4,
+                                int timeout = 5000);
+        /**
+         * @brief Measure the tracking wheel offsets and diameters, the inertial sensor scale, and the track width
+         *
+         * Place the robot square to a wall, or another flat obstacle, directly ahead of it, and measure the gap
+         * between the front of the robot and the wall. The gap should be at least a foot, so the robot has room to
+         * turn. The robot:
+         * 1. drives forwards until it is pushed square against the wall. The vertical tracking wheels should have
+         *    measured the gap, which gives their diameters
+         * 2. backs up halfway, and spins on the spot for a number of turns. The distance each tracking wheel and
+         *    drive side rolls for each radian gives its offset, and the track width
+         * 3. turns back, and drives square against the wall again, so it has turned exactly a whole number of turns.
+         *    What the inertial sensor measured gives its scale
+         *
+         * The values that were measured are stored in the config store, with the names used by loadConfig, and the
+         * store is saved. Odometry uses them once the store is loaded before the chassis is calibrated, usually on
+         * the next run, so odometry doesn't jump in the middle of this one. This blocks until the test is done, and
+         * cancels any running motion. The drive motors aren't measured as tracking wheels, and the diameters of the
+         * horizontal tracking wheels can't be told apart from their offsets, so they are kept
+         *
+         * @param config the store the values are written to
+         * @param gap the gap between the front of the robot and the wall, in inches
+         * @param turns the number of turns the robot spins. More turns are more accurate. 5 by default
+         * @param power the power the robot drives and spins with, from 0 to 127. 40 by default
+         * @param timeout longest time each drive to the wall can take, in milliseconds. 5000 by default
+         * @return OdomCalibrationResult the measured values
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::ConfigStore config("/usd/robot.cfg");
+         *
+         * void initialize() {
+         *     config.load();
+         *     chassis.loadConfig(config);
+         *     chassis.calibrate();
+         * }
+         *
+         * void autonomous() {
+         *     // the robot faces a wall 24 inches away
+         *     const lemlib::OdomCalibrationResult result = chassis.calibrateOdometry(config, 24);
+         *     if (result.success) std::cout << "imu scale: " << result.imuScale << std::endl;
+         * }
+         * @endcode
+         */
+        OdomCalibrationResult calibrateOdometry(ConfigStore& config, float gap, int turns = 5, float power = 40,
+                                                int timeout = 5000);
+        /**
+         * @brief Measure how long motions take to start and stop on the brain
+         *
+         * The robot drives a short moveToPoint, which is preempted by an URGENT moveToPoint back to where it started,
+         * which is cancelled. Each time is from the call to the first voltage sent to the drivetrain motors, so it
+         * includes waking the motion task and waiting for the next odometry update. The motions alternate between
+         * forwards and backwards, so the robot stays near where it started. The result is logged. This blocks until
+         * the test is done, and cancels any running motion
+         *
+         * @param samples the number of times each is measured. 20 by default
+         * @param distance how far each motion drives, in inches. 6 by default
+         * @return MotionLatency the distributions of the latencies
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     const lemlib::MotionLatency latency = chassis.measureMotionLatency();
+         *     std::cout << "start p99: " << latency.start.p99 << " us" << std::endl;
+         * }
+         * @endcode
+         */
+        MotionLatency measureMotionLatency(int samples = 20, float distance = 6);
         /**
          * @brief Turn the chassis so it is facing the target point
          *
@@ -491,6 +1566,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -514,7 +1590,7 @@ class Chassis {
          * chassis.turnToPoint(7.5, 7.5, 2000, {.minSpeed = 60, .earlyExitRange = 5});
          * @endcode
          */
-        void turnToPoint(float x, float y, int timeout, TurnToPointParams params = {}, bool async = true);
+        MotionHandle turnToPoint(float x, float y, int timeout, TurnToPointParams params = {}, bool async = true);
         /**
          * @brief Turn the chassis so it is facing the target heading
          *
@@ -522,6 +1598,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -542,7 +1619,7 @@ class Chassis {
          * chassis.turnToHeading(45, 2000, {.minSpeed = 60, .earlyExitRange = 5});
          * @endcode
          */
-        void turnToHeading(float theta, int timeout, TurnToHeadingParams params = {}, bool async = true);
+        MotionHandle turnToHeading(float theta, int timeout, TurnToHeadingParams params = {}, bool async = true);
         /**
          * @brief Turn the chassis so it is facing the target heading, but only by moving one half of the drivetrain
          *
@@ -551,6 +1628,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -576,8 +1654,8 @@ class Chassis {
          * chassis.swingToHeading(45, DriveSide::LEFT, 2000, {.minSpeed = 60, .earlyExitRange = 5});
          * @endcode
          */
-        void swingToHeading(float theta, DriveSide lockedSide, int timeout, SwingToHeadingParams params = {},
-                            bool async = true);
+        MotionHandle swingToHeading(float theta, DriveSide lockedSide, int timeout, SwingToHeadingParams params = {},
+                                    bool async = true);
         /**
          * @brief Turn the chassis so it is facing the target point, but only by moving one half of the drivetrain
          *
@@ -587,6 +1665,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -617,12 +1696,13 @@ class Chassis {
          * chassis.swingToPoint(7.5, 7.5, DriveSide::RIGHT, 2000, {.minSpeed = 60, .earlyExitRange = 5});
          * @endcode
          */
-        void swingToPoint(float x, float y, DriveSide lockedSide, int timeout, SwingToPointParams params = {},
-                          bool async = true);
+        MotionHandle swingToPoint(float x, float y, DriveSide lockedSide, int timeout, SwingToPointParams params = {},
+                                  bool async = true);
         /**
          * @brief Move the chassis towards the target pose
          *
-         * Uses the boomerang controller
+         * Uses the boomerang controller. With params.holonomic and a holonomic drivetrain, the robot strafes in a
+         * straight line to the target instead, and the heading is controlled on its own
          *
          * @param x x location
          * @param y y location
@@ -630,6 +1710,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -647,12 +1728,15 @@ class Chassis {
          * // move the robot to x = 7.5, y = 7.5 and face heading 90 with a timeout of 4000ms
          * // with a minSpeed of 60, and exit the movement if the robot is within 5 inches of the target
          * chassis.moveToPose(7.5, 7.5, 90, 4000, {.minSpeed = 60, .earlyExitRange = 5});
+         * // strafe straight to x = 24, y = 0 on an X-drive, turning to face heading 90 on the way
+         * chassis.moveToPose(24, 0, 90, 4000, {.holonomic = true});
          * // move the robot to 0, 0, and facing heading 0 with a timeout of 4000ms
          * // this motion should not be as curved as the others, so we set lead to a smaller value (0.3)
          * chassis.moveToPose(0, 0, 0, 4000, {.lead = 0.3});
          * @endcode
          */
-        void moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params = {}, bool async = true);
+        MotionHandle moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params = {},
+                                bool async = true);
         /**
          * @brief Move the chassis towards a target point
          *
@@ -661,6 +1745,7 @@ class Chassis {
          * @param timeout longest time the robot can spend moving
          * @param params struct to simulate named parameters
          * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -680,16 +1765,52 @@ class Chassis {
          * chassis.moveToPoint(7.5, 7.5, 4000, {.minSpeed = 60, .earlyExitRange = 5});
          * @endcode
          */
-        void moveToPoint(float x, float y, int timeout, MoveToPointParams params = {}, bool async = true);
+        MotionHandle moveToPoint(float x, float y, int timeout, MoveToPointParams params = {}, bool async = true);
+        /**
+         * @brief Move the chassis through a list of targets without stopping between them
+         *
+         * The speed the robot passes each target at is planned from the angle it has to turn to reach the next
+         * target, the horizontal drift, and the maximum acceleration of the lateral controller (if it is set), so
+         * minSpeed and earlyExitRange don't have to be tuned by hand. The robot stops at the last target. Each
+         * target is queued as its own motion, so the segments run back-to-back
+         *
+         * With a blend radius, the robot starts aiming at the next target before it reaches the current one, and the
+         * drivetrain isn't stopped between the segments, so a route of points runs through each corner at speed
+         *
+         * @param targets the targets, in order
+         * @param timeout longest time each segment can take, in milliseconds
+         * @param params struct to simulate named parameters
+         * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion to the last target
+         *
+         * @b Example
+         * @code {.cpp}
+         * // drive through 2 points, then finish at (24, 48) facing 90 degrees
+         * chassis.moveChain({{0, 24}, {24, 36}, {24, 48, 90}}, 2000);
+         * // back through the same points, cutting the corners wider
+         * chassis.moveChain({{24, 36, NAN, false}, {0, 24, NAN, false}, {0, 0, 0, false}}, 2000, {.exitRange = 10});
+         * // through a route of points, curving through each corner
+         * chassis.moveChain({{0, 24}, {24, 48}, {48, 24}}, 2000, {.exitRange = 0, .blendRadius = 12});
+         * @endcode
+         */
+        MotionHandle moveChain(const std::vector<ChainTarget>& targets, int timeout, ChainParams params = {},
+                               bool async = true);
         /**
          * @brief Move the chassis along a path
          *
-         * @param path the path asset to follow
+         * @param path the path asset to follow. Either a text path loaded with ASSET, or a binary path loaded with
+         * PATH_ASSET. Binary paths don't need to be parsed, so the robot starts moving sooner. A path queued behind
+         * another motion is loaded by a low priority task while that motion runs, so it is ready when it starts
          * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
          * faster but will follow the path less accurately
          * @param timeout the maximum time the robot can spend moving
          * @param forwards whether the robot should follow the path going forwards. true by default
          * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
@@ -705,80 +1826,367 @@ class Chassis {
          *     // follow the path in "myPath.txt" with a lookahead of 10 inches and a timeout of 4000ms
          *     // but follow the path backwards
          *     chassis.follow(myPath_txt, 10, 4000, false);
+         *     // leave the path 6 inches before its end without slowing below 60, and flow into the next motion
+         *     chassis.follow(myPath_txt, 10, 4000, true, true, 0, {.minSpeed = 60, .earlyExitRange = 6});
+         *     chassis.moveToPose(48, 48, 90, 2000);
+         * }
+         * @endcode
+         * @code {.cpp}
+         * // load the binary version of "myPath.txt", which is generated at build time
+         * PATH_ASSET(myPath_txt);
+         *
+         * void autonomous() {
+         *     // follow the path the same way as a text path
+         *     chassis.follow(myPath_txt, 10, 4000);
          * }
          * @endcode
          */
-        void follow(const asset& path, float lookahead, int timeout, bool forwards = true, bool async = true);
+        MotionHandle follow(const asset& path, float lookahead, int timeout, bool forwards = true,
+                            bool async = true, int deadline = 0, FollowParams params = {});
         /**
-         * @brief Control the robot during the driver using the arcade drive control scheme. In this control scheme one
-         * joystick axis controls the forwards and backwards movement of the robot, while the other joystick axis
-
-         * controls  the robot's turning
-         * @param throttle speed to move forward or backward. Takes an input from -127 to 127.
-         * @param turn speed to turn. Takes an input from -127 to 127.
-         * @param disableDriveCurve whether to disable the drive curve or not. If disabled, uses a linear curve with no
-         * deadzone or minimum power
+         * @brief Move the chassis along a path that was built at runtime, like one made with generatePath
+         *
+         * @note the path must not be destroyed or changed until the motion ends
+         *
+         * @param path the path to follow
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
-         * // opcontrol function in your project. The function that runs during the driver control period
-         * void opcontrol() {
-         *     // controller
-         *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
-         *     // loop to continuously update motors
-         *     while (true) {
-         *         // get joystick positions
-         *         int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-         *         int rightY = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
-         *         // move the chassis with tank controls
-         *         chassis.tank(leftY, rightY);
-         *         // delay to save resources
-         *         pros::delay(25);
-         *     }
+         * lemlib::PathArena arena(1000);
+         *
+         * void autonomous() {
+         *     const lemlib::Path path = lemlib::generatePath(arena, {{0, 0, 0}, {24, 48, 90}});
+         *     chassis.follow(path, 10, 4000, true, false);
          * }
          * @endcode
          */
-        void tank(int left, int right, bool disableDriveCurve = false);
+        MotionHandle follow(const Path& path, float lookahead, int timeout, bool forwards = true, bool async = true,
+                            int deadline = 0, FollowParams params = {});
         /**
-         * @brief Control the robot during the driver using the arcade drive control scheme. In this control scheme one
-         * joystick axis controls the forwards and backwards movement of the robot, while the other joystick axis
-         * controls the robot's turning
+         * @brief Move the chassis along a view of one or more paths, like a path driven backwards or 2 paths chained
          *
-         * @param throttle speed to move forward or backward. Takes an input from -127 to 127.
-         * @param turn speed to turn. Takes an input from -127 to 127.
-         * @param disableDriveCurve whether to disable the drive curve or not. If disabled, uses a linear curve with no
-         * deadzone or minimum power
-         * @param desaturateBias how much to favor angular motion over lateral motion or vice versa when motors are
-         * saturated. A value of 0 fully prioritizes lateral motion, a value of 1 fully prioritizes angular motion
+         * The view is copied when the motion is queued, so it can be built in the call. No points are copied
+         *
+         * @note the paths the view is of must not be destroyed or changed until the motion ends
+         *
+         * @param path the view to follow
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
          *
          * @b Example
          * @code {.cpp}
-         * // opcontrol function in your project. The function that runs during the driver control period
-         * void opcontrol() {
-         *     // controller
-         *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
-         *     // loop to continuously update motors
-         *     while (true) {
-         *         // get joystick positions
-         *         int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
-         *         int rightX = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
-         *         // move the chassis with arcade controls
-         *         chassis.arcade(leftY, // throttle
-         *                        rightX, // steer
-         *                        false, // enable drive curves
-         *                        0.75 // slightly prioritize steering
-         *         );
-         *         // delay to save resources
-         *         pros::delay(25);
-         *     }
+         * ASSET(myPath_txt);
+         *
+         * void autonomous() {
+         *     const lemlib::PathView path(lemlib::pathCache().get(myPath_txt));
+         *     // out along the path, then back along it to where the robot started
+         *     chassis.follow(path, 10, 4000);
+         *     chassis.follow(path.reversed(), 10, 4000, false);
          * }
          * @endcode
          */
-        void arcade(int throttle, int turn, bool disableDriveCurve = false, float desaturateBias = 0.5);
+        MotionHandle follow(const PathView& path, float lookahead, int timeout, bool forwards = true,
+                            bool async = true, int deadline = 0, FollowParams params = {});
         /**
-         * @brief Control the robot during the driver using the curvature drive control scheme. This control scheme is
-         * very similar to arcade drive, except the second joystick axis controls the radius of the curve that the
-         * drivetrain makes, rather than the speed. This means that the driver can accelerate in a turn without changing
+         * @brief Move the chassis along a spline path
+         *
+         * The closest point and the lookahead point are found on the curve itself, instead of on a list of points
+         *
+         * @note the path must not be destroyed or changed until the motion ends
+         *
+         * @param path the path to follow
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress. The
+         * path index of a spline path is the spline the robot is closest to
+         *
+         * @b Example
+         * @code {.cpp}
+         * const lemlib::SplinePath path({{0, 0, 0}, {24, 48, 90}, {48, 48, 90}});
+         *
+         * void autonomous() {
+         *     chassis.follow(path, 10, 4000, true, false);
+         * }
+         * @endcode
+         */
+        MotionHandle follow(const SplinePath& path, float lookahead, int timeout, bool forwards = true,
+                            bool async = true, int deadline = 0, FollowParams params = {});
+        /**
+         * @brief Move the chassis along a path in a path bundle
+         *
+         * The path is found in constant time, and read in place from the bundle
+         *
+         * @param bundle the path bundle asset
+         * @param name the name of the path, which is the name of the file it was made from without the extension
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
+         *
+         * @b Example
+         * @code {.cpp}
+         * // every text path in static/ is packed into paths.lpk at build time
+         * ASSET(paths_lpk);
+         *
+         * void autonomous() {
+         *     chassis.follow(paths_lpk, "segment3", 10, 4000);
+         * }
+         * @endcode
+         */
+        MotionHandle follow(const asset& bundle, std::string_view name, float lookahead, int timeout,
+                            bool forwards = true, bool async = true, int deadline = 0, FollowParams params = {});
+        /**
+         * @brief Move the chassis along a path stored on the SD card
+         *
+         * The file is read the first time it is followed, unless prefetchPath has read it already. Reading a file
+         * takes a while, so prefetch the paths of a route in initialize. A file that can't be read is skipped
+         *
+         * @param file the name of the path file, like "/usd/paths/route1.lpb"
+         * @param lookahead the lookahead distance. Units in inches. Larger values will make the robot move
+         * faster but will follow the path less accurately
+         * @param timeout the maximum time the robot can spend moving
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @param deadline when the robot should reach the end of the path, in milliseconds from the start of the
+         * motion. The velocities of the path are scaled down to the slowest ones that still get there in time. 0, the
+         * default, follows the path at its own velocities
+         * @param params struct to simulate named parameters, for chaining the path into the next motion
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     chassis.follow("/usd/paths/route1.lpb", 10, 4000);
+         * }
+         * @endcode
+         */
+        MotionHandle follow(const std::string& file, float lookahead, int timeout, bool forwards = true,
+                            bool async = true, int deadline = 0, FollowParams params = {});
+        /**
+         * @brief Load a path ahead of time, so following it doesn't have to parse it
+         *
+         * Paths are cached by asset, so following the same path multiple times only loads it once.
+         * This should be called in initialize or competition_initialize. The path is loaded in the current field
+         * transform, so set that first
+         *
+         * @param path the path asset to load
+         * @return true the path was loaded successfully
+         * @return false the path is empty or couldn't be read
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(myPath_txt);
+         *
+         * void initialize() {
+         *     chassis.calibrate();
+         *     // load the path now, so the motion starts instantly during autonomous
+         *     chassis.preloadPath(myPath_txt);
+         * }
+         * @endcode
+         */
+        bool preloadPath(const asset& path);
+        /**
+         * @brief Read and load a path file on the SD card in the background, so following it doesn't have to
+         *
+         * The file is read by a low priority task, so this returns immediately. The path is loaded in the current
+         * field transform, so set that first
+         *
+         * @param file the name of the path file, like "/usd/paths/route1.lpb"
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     chassis.calibrate();
+         *     // read the route while the robot waits for autonomous
+         *     chassis.prefetchPath("/usd/paths/route1.lpb");
+         *     chassis.prefetchPath("/usd/paths/route2.lpb");
+         * }
+         * @endcode
+         */
+        void prefetchPath(const std::string& file);
+        /**
+         * @brief Plan the curve moveToPose would drive along ahead of time
+         *
+         * Planning the curve takes a while, so this should be called in initialize or competition_initialize. The
+         * trajectory is planned with the maxVelocity and maxAcceleration of the lateral controller, or the top speed
+         * of the drivetrain and the slew rate if they aren't set
+         *
+         * @param start the pose the robot will start at. Degrees, the same as getPose
+         * @param x x location of the target, in inches
+         * @param y y location of the target, in inches
+         * @param theta target heading, in degrees
+         * @param params the same parameters moveToPose takes. minSpeed and earlyExitRange are ignored
+         * @return Trajectory the planned trajectory
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Trajectory toGoal;
+         *
+         * void initialize() {
+         *     chassis.calibrate();
+         *     toGoal = chassis.planPose({0, 0, 0}, 24, 48, 90);
+         * }
+         *
+         * void autonomous() {
+         *     chassis.setPose(0, 0, 0);
+         *     chassis.followTrajectory(toGoal, 4000);
+         * }
+         * @endcode
+         */
+        Trajectory planPose(Pose start, float x, float y, float theta, MoveToPoseParams params = {});
+        /**
+         * @brief Follow a trajectory planned ahead of time
+         *
+         * The robot tracks where the trajectory says it should be at each point in time with a RAMSETE controller,
+         * which only has to look up the trajectory and correct the error every iteration
+         *
+         * @note the trajectory must not be destroyed or changed until the motion ends
+         *
+         * @param trajectory the trajectory to follow
+         * @param timeout longest time the robot can spend moving, in milliseconds
+         * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
+         */
+        MotionHandle followTrajectory(const Trajectory& trajectory, int timeout, bool async = true);
+        /**
+         * @brief Follow a path on a schedule, instead of with pure pursuit
+         *
+         * The path is loaded from the same formats as follow, and the points are given times on the first call, with
+         * the same limits as planPose. The velocities in the path file aren't used. Use this when the time the robot
+         * reaches each point matters more than following the path exactly
+         *
+         * @param path the path asset to follow
+         * @param timeout longest time the robot can spend moving, in milliseconds
+         * @param forwards whether the robot should follow the path going forwards. true by default
+         * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(myPath_txt);
+         *
+         * void initialize() {
+         *     chassis.calibrate();
+         *     // plan the timing now, so the motion starts instantly during autonomous
+         *     chassis.preloadTrajectory(myPath_txt);
+         * }
+         *
+         * void autonomous() { chassis.followTrajectory(myPath_txt, 4000); }
+         * @endcode
+         */
+        MotionHandle followTrajectory(const asset& path, int timeout, bool forwards = true, bool async = true);
+        /**
+         * @brief Plan the timing of a path ahead of time, so followTrajectory doesn't have to
+         *
+         * The path is planned in the current field transform, so set that first
+         *
+         * @param path the path asset to plan
+         * @param forwards whether the path will be followed forwards. true by default
+         * @return true the path was planned successfully
+         * @return false the path is empty or couldn't be read
+         */
+        bool preloadTrajectory(const asset& path, bool forwards = true);
+        /**
+         * @brief Control the robot during the driver using the arcade drive control scheme. In this control scheme one
+         * joystick axis controls the forwards and backwards movement of the robot, while the other joystick axis
+
+         * controls  the robot's turning
+         * @param throttle speed to move forward or backward. Takes an input from -127 to 127.
+         * @param turn speed to turn. Takes an input from -127 to 127.
+         * @param disableDriveCurve whether to disable the drive curve or not. If disabled, uses a linear curve with no
+         * deadzone or minimum power
+         *
+         * @b Example
+         * @code {.cpp}
+         * // opcontrol function in your project. The function that runs during the driver control period
+         * void opcontrol() {
+         *     // controller
+         *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
+         *     // loop to continuously update motors
+         *     while (true) {
+         *         // get joystick positions
+         *         int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+         *         int rightY = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_Y);
+         *         // move the chassis with tank controls
+         *         chassis.tank(leftY, rightY);
+         *         // delay to save resources
+         *         pros::delay(25);
+         *     }
+         * }
+         * @endcode
+         */
+        void tank(int left, int right, bool disableDriveCurve = false);
+        /**
+         * @brief Control the robot during the driver using the arcade drive control scheme. In this control scheme one
+         * joystick axis controls the forwards and backwards movement of the robot, while the other joystick axis
+         * controls the robot's turning
+         *
+         * @param throttle speed to move forward or backward. Takes an input from -127 to 127.
+         * @param turn speed to turn. Takes an input from -127 to 127.
+         * @param disableDriveCurve whether to disable the drive curve or not. If disabled, uses a linear curve with no
+         * deadzone or minimum power
+         * @param desaturateBias how much to favor angular motion over lateral motion or vice versa when motors are
+         * saturated. A value of 0 fully prioritizes lateral motion, a value of 1 fully prioritizes angular motion
+         *
+         * @b Example
+         * @code {.cpp}
+         * // opcontrol function in your project. The function that runs during the driver control period
+         * void opcontrol() {
+         *     // controller
+         *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
+         *     // loop to continuously update motors
+         *     while (true) {
+         *         // get joystick positions
+         *         int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+         *         int rightX = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+         *         // move the chassis with arcade controls
+         *         chassis.arcade(leftY, // throttle
+         *                        rightX, // steer
+         *                        false, // enable drive curves
+         *                        0.75 // slightly prioritize steering
+         *         );
+         *         // delay to save resources
+         *         pros::delay(25);
+         *     }
+         * }
+         * @endcode
+         */
+        void arcade(int throttle, int turn, bool disableDriveCurve = false, float desaturateBias = 0.5);
+        /**
+         * @brief Control the robot during the driver using the curvature drive control scheme. This control scheme is
+         * very similar to arcade drive, except the second joystick axis controls the radius of the curve that the
+         * drivetrain makes, rather than the speed. This means that the driver can accelerate in a turn without changing
          * the radius of that turn. This control scheme defaults to arcade when forward is zero.
          *
          * @param throttle speed to move forward or backward. Takes an input from -127 to 127.
@@ -806,10 +2214,379 @@ class Chassis {
          * @endcode
          */
         void curvature(int throttle, int turn, bool disableDriveCurve = false);
+        /**
+         * @brief Control a holonomic drivetrain during the driver. One joystick drives and strafes the robot, and the
+         * other turns it
+         *
+         * The drive curve is applied to each axis, then the wheels are desaturated together, so the robot keeps the
+         * direction the joysticks point in. Does nothing if the drivetrain isn't holonomic. The driver control task
+         * can't drive with it, so call it in the opcontrol loop, without startDriverControl
+         *
+         * @param forward speed to move forward or backward. Takes an input from -127 to 127.
+         * @param strafe speed to move right or left. Takes an input from -127 to 127.
+         * @param turn speed to turn. Takes an input from -127 to 127.
+         * @param disableDriveCurve whether to disable the drive curve or not. If disabled, uses a linear curve with no
+         * deadzone or minimum power
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
+         *     while (true) {
+         *         int leftY = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_Y);
+         *         int leftX = controller.get_analog(pros::E_CONTROLLER_ANALOG_LEFT_X);
+         *         int rightX = controller.get_analog(pros::E_CONTROLLER_ANALOG_RIGHT_X);
+         *         chassis.holonomic(leftY, leftX, rightX);
+         *         pros::delay(25);
+         *     }
+         * }
+         * @endcode
+         */
+        void holonomic(int forward, int strafe, int turn, bool disableDriveCurve = false);
+        /**
+         * @brief Detect wheel slip, and limit how fast the power grows while the wheels slip
+         *
+         * Wheels that slip push less than wheels that grip, so limiting the power until they grip again accelerates
+         * the robot faster, and keeps the motor encoders agreeing with the tracking wheels. Slip is measured each
+         * time power is sent to the drivetrain, by both motions and driver control
+         *
+         * @note slip can only be measured with a vertical tracking wheel, since the motor encoders can't measure
+         * their own slip
+         *
+         * @param settings the settings, or std::nullopt to stop detecting slip, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // let the power grow by at most 2 every 10 ms while slipping
+         * chassis.setTractionControl(lemlib::TractionSettings {.ramp = 2});
+         * @endcode
+         */
+        void setTractionControl(std::optional<TractionSettings> settings);
+        /**
+         * @brief Get the last measured slip of the drivetrain
+         *
+         * @return SlipState the slip. All 0 if traction control isn't enabled
+         *
+         * @b Example
+         * @code {.cpp}
+         * // detect slip without limiting the power
+         * chassis.setTractionControl(lemlib::TractionSettings {.ramp = 0});
+         * if (chassis.getSlip().slipping) controller.rumble(".");
+         * @endcode
+         */
+        SlipState getSlip();
+        /**
+         * @brief Close a velocity loop around each side of the drivetrain
+         *
+         * Feedforward alone sends the voltage the model says a velocity needs, so the real velocity drifts as the
+         * battery runs down and the load changes. With velocity control, follow, followTrajectory, and the profiled
+         * motions measure the velocity of each side with the motor encoders, and a PID adds the power that makes up
+         * the difference. The velocities are in inches per second, so follow only uses the loop with a feedforward
+         * model. The loop rests while a side is asked to stand still, so it doesn't fight a motion settling on its
+         * target
+         *
+         * @param settings the settings, or std::nullopt to only use the feedforward, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.setFeedforward(lemlib::Feedforward(0.8, 0.18, 0.02));
+         * chassis.setVelocityControl(lemlib::VelocityControlSettings {.kP = 1.5, .kI = 0.05});
+         * @endcode
+         */
+        void setVelocityControl(std::optional<VelocityControlSettings> settings);
+        /**
+         * @brief Scale every drivetrain command by the charge of the battery
+         *
+         * The motors turn a command into a fraction of the battery voltage, so the same command drives slower on a
+         * battery at 11.9 V than on one at 12.8 V, and gains and path timing tuned on a fresh battery drift through
+         * the day. With compensation, the battery is read every few updates, and the commands of every motion and
+         * of driver control are scaled to what they would be at the nominal voltage. A command can't be scaled past
+         * the most the motors take, so a battery below the nominal voltage still limits the top speed
+         *
+         * @param settings the settings, or std::nullopt to send commands as they are, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // the robot was tuned on a battery that read 12.4 V
+         * chassis.setBatteryCompensation(lemlib::BatteryCompensationSettings {.nominal = 12400});
+         * @endcode
+         */
+        void setBatteryCompensation(std::optional<BatteryCompensationSettings> settings);
+        /**
+         * @brief Drive the robot to a stop at the end of each motion, instead of leaving it to coast or brake
+         *
+         * Motions send the motors 0 volts when they end, so the robot rolls to a halt on whatever brake mode the
+         * motors have, and chained motions spend time drifting. With an active stop, a motion that settles, times
+         * out, or meets an exit condition drives each side against the velocity its motors measure until it has
+         * stopped, which is over in a few iterations, then brakes it. Motions that exit early for motion chaining, or
+         * are cancelled, still stop right away, so the next motion takes the robot while it is moving
+         *
+         * @param settings the settings, or std::nullopt to send 0 volts, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.setBrakeMode(pros::E_MOTOR_BRAKE_HOLD);
+         * chassis.setActiveStop(lemlib::ActiveStopSettings {.maxPower = 60});
+         * @endcode
+         */
+        void setActiveStop(std::optional<ActiveStopSettings> settings);
+        /**
+         * @brief Hold the robot where the last motion left it until the next motion starts, so defenders can't push
+         * it off its pose while the routine waits on a mechanism
+         *
+         * When the motion queue runs out, the motion task keeps the pose odometry measured at the end of the last
+         * motion, and corrects the robot back to it every period, sleeping in between. A differential drivetrain can
+         * only be driven back along its heading and turned back, so a robot pushed sideways is held on the line it
+         * was pushed to. A holonomic drivetrain is strafed back as well. setPose moves the hold to the new pose,
+         * and the hold ends when the driver drives the robot, or the period of the match changes
+         *
+         * @param settings the settings, or std::nullopt to leave the robot as the last motion stopped it, which is the
+         * default
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.setPoseHold(lemlib::PoseHoldSettings {.maxPower = 80});
+         * chassis.moveToPoint(24, 24, 2000);
+         * // the robot stays at (24, 24) while the lift raises
+         * lift.moveToPosition(90, 1500);
+         * @endcode
+         */
+        void setPoseHold(std::optional<PoseHoldSettings> settings);
+        /**
+         * @brief End motions when the robot stalls against a wall or a goal, instead of pushing until they time out
+         *
+         * Every iteration of every motion checks whether the robot is pushing without moving. A motion that has
+         * been stalled for the time in the settings ends with MotionEndReason::STALLED, so the next motion starts
+         * right away. With the walls in the settings, a stall square against a field wall also resets the position
+         * of odometry across that wall
+         *
+         * @param settings the settings, or std::nullopt to not detect stalls, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // drive into the wall behind the robot, and set y from it
+         * chassis.setStallDetection(lemlib::StallSettings {.walls = lemlib::FieldMap(), .backOffset = 6.5});
+         * chassis.moveToPoint(0, -80, 3000, {.forwards = false});
+         * @endcode
+         */
+        void setStallDetection(std::optional<StallSettings> settings);
+        /**
+         * @brief Let the robot accelerate hard while it is stable, and limit its acceleration as soon as it starts to
+         * tip, from the pitch and roll of the inertial sensor
+         *
+         * A robot with a raised lift tips if it accelerates too hard, so the slew of the lateral controller is
+         * usually tuned for the worst case. With anti-tip, moveToPoint, moveToPose, and follow accelerate with the
+         * slew in the settings, which can be much higher, and the slew falls as the robot tilts. The inertial sensor
+         * is read every iteration of the motion loops. followTrajectory plans its acceleration before it starts, so it
+         * isn't limited
+         *
+         * @note the lateral output is only limited while the slew in use isn't 0
+         *
+         * @param settings the settings, or std::nullopt to always use the slew of the lateral controller, which is
+         * the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // the lateral controller has a slew of 5, which is safe with the lift up. Accelerate 3 times as fast
+         * // while the robot is level
+         * chassis.setAntiTip(lemlib::AntiTipSettings {.slew = 15});
+         * @endcode
+         */
+        void setAntiTip(std::optional<AntiTipSettings> settings);
+        /**
+         * @brief Detect when the robot is hit, from spikes in the acceleration measured by the inertial sensor
+         *
+         * The tracking task checks the accelerometer every update, so a hit is flagged within 1 odometry update.
+         * The running motion runs its collision callbacks, added with MotionHandle::onCollision(), on its next
+         * iteration, and ends with MotionEndReason::COLLIDED if the settings abort motions. The jump in acceleration
+         * is also published as a sensor of the odometry, with Odometry::getSensor()
+         *
+         * @param settings the settings, or std::nullopt to not detect collisions, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // stop following the path when the robot is hit, then find where the robot is
+         * chassis.setCollisionDetection(lemlib::CollisionSettings {.abort = true});
+         * lemlib::MotionHandle motion = chassis.follow(path_txt, 15, 4000);
+         * motion.wait();
+         * if (motion.endReason() == lemlib::MotionEndReason::COLLIDED) relocalize();
+         * @endcode
+         */
+        void setCollisionDetection(std::optional<CollisionSettings> settings);
+        /**
+         * @brief Get the last collision detected by setCollisionDetection()
+         *
+         * @return Collision the collision. Its count is 0 if no collision has been detected
+         */
+        Collision getLastCollision() const;
+        /**
+         * @brief Estimate the temperature of the drive motors, and lower the limits of the motions before the
+         * firmware limits the current of a hot motor
+         *
+         * The motion profiles of moveToPoint and the turns and swings plan with lower velocity and acceleration
+         * limits, followTrajectory plays its trajectory slower, and follow scales down the velocities of its path,
+         * so performance drops gradually through a long skills run instead of all at once. Each motion takes the
+         * scale when it starts. The motors are read each time power is sent to the drivetrain
+         *
+         * @note call this before starting motions or driver control
+         *
+         * @param settings the settings, or std::nullopt to not estimate the temperature, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // start slowing down 5 °C earlier than the default
+         * chassis.setThermalModel(lemlib::ThermalSettings {.deratingStart = 40});
+         * @endcode
+         */
+        void setThermalModel(std::optional<ThermalSettings> settings);
+        /**
+         * @brief Get the last estimate of the temperature of the drive motors
+         *
+         * @return ThermalReading the estimate. The default reading if the thermal model isn't enabled
+         */
+        ThermalReading getThermalReading();
+        /**
+         * @brief Drive the chassis from a controller in a task of its own, instead of in the opcontrol loop
+         *
+         * The task reads the controller every few milliseconds and runs tank, arcade, or curvature, so the latency
+         * from the sticks to the motors doesn't depend on how fast the rest of opcontrol runs. The drive curves and
+         * the voltage output are the same as calling those functions, and only changes are sent to the motors.
+         * While a motion is running, the task leaves the drivetrain to it, so motions can be used as macros. Calling
+         * this again while the task runs changes its settings
+         *
+         * @param settings the settings of the task
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // drive with curvature controls, reading the controller every 5 ms
+         *     chassis.startDriverControl({.scheme = lemlib::DriveScheme::CURVATURE});
+         *     while (true) {
+         *         // the rest of the robot
+         *         pros::delay(20);
+         *     }
+         * }
+         * @endcode
+         */
+        void startDriverControl(DriverControlSettings settings = {});
+        /**
+         * @brief Stop the driver control task
+         *
+         * The drivetrain stops within one period of the task, unless a motion is running
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.startDriverControl();
+         * pros::delay(10000);
+         * // stop driving from the controller
+         * chassis.stopDriverControl();
+         * @endcode
+         */
+        void stopDriverControl();
+        /**
+         * @brief Whether the driver control task is driving the chassis
+         *
+         * @return true startDriverControl was called, and stopDriverControl hasn't been since
+         * @return false the chassis isn't driven from a controller
+         */
+        bool driverControlRunning() const;
+        /**
+         * @brief Time how long the driver's input takes to reach the drive motors, and the wheels
+         *
+         * Each call of tank, arcade, and curvature is timed from the controller read to the motor command. The
+         * driver control task reads the controller itself, so its time is exact. Called from opcontrol, the read is
+         * taken to be when the function is called. When a side is pushed from rest, the time until its wheel turns is
+         * timed too, from the velocity the drive motors measure
+         *
+         * @note call this before starting driver control
+         *
+         * @param settings the settings, or std::nullopt to not time driver control, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.setDriverLatencyTracking(lemlib::DriverLatencySettings {});
+         * chassis.startDriverControl({.period = 5});
+         * @endcode
+         */
+        void setDriverLatencyTracking(std::optional<DriverLatencySettings> settings);
+        /**
+         * @brief Get the latency of driver control timed since setDriverLatencyTracking
+         *
+         * @return DriverLatencyStats the latency. All 0 if the latency isn't tracked
+         *
+         * @b Example
+         * @code {.cpp}
+         * const lemlib::DriverLatencyStats latency = chassis.getDriverLatency();
+         * std::cout << "stick to wheel p50: " << latency.total.p50 << " us" << std::endl;
+         * @endcode
+         */
+        DriverLatencyStats getDriverLatency();
+        /**
+         * @brief Record the sticks the driver control task reads, and the pose, into a driver macro
+         *
+         * The macro is cleared, then recorded while driver control runs, until stopMacroRecording is called. The
+         * macro is paused while a motion has the drivetrain, or driver control is stopped. It keeps the drive scheme
+         * and curves driver control had when recording started
+         *
+         * @note the macro must not be read or saved until recording stops
+         *
+         * @param macro where the macro is recorded. Owned by the user
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::DriverMacro macro;
+         * void opcontrol() {
+         *     chassis.startDriverControl();
+         *     while (true) {
+         *         // A starts a recording, and B saves it
+         *         if (controller.get_digital_new_press(DIGITAL_A)) chassis.startMacroRecording(macro);
+         *         if (controller.get_digital_new_press(DIGITAL_B)) {
+         *             chassis.stopMacroRecording();
+         *             macro.save("/usd/skills.lmc");
+         *         }
+         *         pros::delay(20);
+         *     }
+         * }
+         * @endcode
+         */
+        void startMacroRecording(DriverMacro& macro);
+        /**
+         * @brief Stop recording the driver macro started by startMacroRecording
+         *
+         * The macro isn't written to after this returns
+         */
+        void stopMacroRecording();
+        /**
+         * @brief Drive a recorded driver macro again
+         *
+         * The sticks are fed back through the drive scheme and drive curves they were recorded with, on the schedule
+         * they were recorded on. Every iteration, the power is corrected by how far the robot is from where it was at
+         * the same time in the recording, so small differences in how the robot drives don't add up over the route.
+         * The motion ends when the macro does. The macro is replayed in the current field transform, so a mirrored
+         * route turns the other way
+         *
+         * @param macro the macro. Owned by the user, and must not be changed while it is replayed
+         * @param params struct to simulate named parameters
+         * @param async whether the function should be run asynchronously. true by default
+         * @return MotionHandle a handle to the motion, which can be used to wait for it or check its progress
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::DriverMacro skills;
+         * void autonomous() {
+         *     if (!skills.load("/usd/skills.lmc")) return;
+         *     chassis.setPose(skills.getStart());
+         *     chassis.replayMacro(skills, {.kLinear = 6}, false);
+         * }
+         * @endcode
+         */
+        MotionHandle replayMacro(const DriverMacro& macro, MacroParams params = {}, bool async = true);
         /**
          * @brief Cancels the currently running motion.
          * If there is a queued motion, then that queued motion will run.
          *
+         * The motion is interrupted immediately, and this returns once it has stopped the drivetrain
+         *
          * @b Example
          * @code {.cpp}
          * // move the robot to x = 20, y = 20 with a timeout of 4000ms
@@ -837,41 +2614,256 @@ class Chassis {
          * chassis.moveToPoint(10, 10, 4000);
          * @endcode
          */
-        void cancelMotion();
+        void cancelMotion();
+        /**
+         * @brief Cancels all motions, even those that are queued.
+         * After this, the chassis will not be in motion.
+         *
+         * @b Example
+         * @code {.cpp}
+         * // move the robot to x = 20, y = 20 with a timeout of 4000ms
+         * chassis.moveToPoint(20, 20, 4000);
+         * // wait 500 milliseconds
+         * pros::delay(500);
+         * // cancel all motions. The robot will stop immediately
+         * chassis.cancelAllMotions();
+         * @endcode
+         * @b Example (advanced)
+         * @code {.cpp}
+         * // this example shows how the cancelMotion function behaves when a motion is queued
+         * // this is an advanced example since we will be using tasks here
+         * // move the robot to x = 20, y = 20 with a timeout of 4000ms
+         * chassis.moveToPoint(20, 20, 4000);
+         * // start a lambda task that will be used to cancel all motions after 500ms
+         * pros::Task task([] {
+         *     // wait 500 milliseconds
+         *     pros::delay(500);
+         *     // cancels both motions
+         *     chassis.cancelAllMotions();
+         * });
+         * // queue a motion to x = 10, y = 10 with a timeout of 4000ms
+         * // this will never run because cancelAllMotions will be called while this motion is in the queue
+         * chassis.moveToPoint(10, 10, 4000);
+         * @endcode
+         */
+        void cancelAllMotions();
+        /**
+         * @brief Set a time every motion has to be done by, like the end of the autonomous period less the time the
+         * last scoring action takes
+         *
+         * A motion that would start after the deadline is skipped, and ends as CANCELLED. A motion that starts before
+         * it has its timeout cut, so it times out at the deadline if it hasn't finished by then. The code after the
+         * motions, like the final scoring action, always gets the time that was left for it
+         *
+         * @param deadline the time, from pros::millis, in milliseconds. 0 clears the deadline
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     // the autonomous period is 15 seconds, and scoring the last ring takes 1.5
+         *     chassis.setMotionDeadline(pros::millis() + 13500);
+         *     chassis.moveToPoint(0, 48, 4000);
+         *     chassis.follow(toGoal_txt, 10, 6000);
+         *     chassis.turnToHeading(90, 1000, {}, false);
+         *     scoreRing();
+         *     chassis.setMotionDeadline(0);
+         * }
+         * @endcode
+         */
+        void setMotionDeadline(uint32_t deadline);
+        /**
+         * @brief Get the time every motion has to be done by
+         *
+         * @return uint32_t the time, from pros::millis, in milliseconds. 0 if there is no deadline
+         */
+        uint32_t getMotionDeadline() const;
+        /**
+         * @brief Set how many motions can be queued
+         *
+         * Queueing a motion when the queue is full waits for a motion to finish. This must be called before
+         * calibrate, since the queue is allocated when the motion task starts
+         *
+         * @param depth the number of motions that can be queued. Rounded up to a power of 2. 16 by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // allow 32 motions to be queued
+         *     chassis.setMotionQueueDepth(32);
+         *     chassis.calibrate();
+         * }
+         * @endcode
+         */
+        void setMotionQueueDepth(size_t depth);
+        /**
+         * @brief Set what happens to the motions a motion with a higher priority preempts
+         *
+         * A motion with a higher priority stops the running motion on its next tick. With SUSPEND, the preempted
+         * motion starts again with its full timeout once the motions with a higher priority are done, and the rest of
+         * the queue runs after it. With SUSPEND, callbacks of the preempted motion that already ran don't run again.
+         * With DROP, it ends as CANCELLED, and the motions with a lower priority queued before the preempting motion
+         * are skipped
+         *
+         * @param policy the policy. SUSPEND by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     // the routine is abandoned if the robot has to defend
+         *     chassis.setPreemptPolicy(lemlib::PreemptPolicy::DROP);
+         *     chassis.moveToPoint(0, 48, 4000, {}, true);
+         *     chassis.moveToPoint(24, 48, 4000, {}, true);
+         * }
+         *
+         * // called from another task when an opponent is detected
+         * void defend() {
+         *     // stops the routine within one tick, without cancelAllMotions
+         *     chassis.turnToHeading(90, 1000, {.priority = lemlib::MotionPriority::URGENT});
+         * }
+         * @endcode
+         */
+        void setPreemptPolicy(PreemptPolicy policy);
+        /**
+         * @brief Set the transform from the coordinates routes are written in to the field
+         *
+         * The transform is applied once, when a motion is queued: to its target, to its turn direction and locked
+         * side if the transform mirrors the route, and to path assets, which are transformed once and cached. Motions
+         * run in field coordinates, so a mirrored route costs nothing extra each tick, and one path asset serves
+         * both sides of the field. setPose is transformed too, so the starting pose of the route stays the same.
+         * getPose is always in field coordinates. Paths, spline paths, and trajectories the user owns are followed
+         * as they are, use Path::transformed to make a copy once
+         *
+         * @param transform the transform. None by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(sweep_txt);
+         *
+         * void autonomous() {
+         *     // the route is written for the red side. The blue side is the red side mirrored across the y axis
+         *     if (blueAlliance) chassis.setFieldTransform(lemlib::FieldTransform(true, false));
+         *     chassis.setPose(-48, -60, 0);
+         *     chassis.follow(sweep_txt, 10, 4000);
+         *     chassis.turnToHeading(90, 1000);
+         * }
+         * @endcode
+         */
+        void setFieldTransform(FieldTransform transform);
+        /**
+         * @brief Get the transform from the coordinates routes are written in to the field
+         *
+         * @return FieldTransform the transform
+         */
+        FieldTransform getFieldTransform() const;
+        /**
+         * @brief Set the size of the stack of the motion task
+         *
+         * Every motion runs on 1 task that is made when the chassis is calibrated and runs until the program ends, so
+         * queueing a motion never makes a task or allocates a stack. A motion that runs deep callbacks, or a user
+         * function that uses a lot of stack in a motion callback, may need a bigger stack. The stack is allocated when
+         * the motion task starts, so this must be called before calibrate. getTaskHealth reports how much of the stack
+         * is used
+         *
+         * @param words the size of the stack, in 4 byte words. The motion stack of getTaskConfig() by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // double the stack of the motion task
+         *     chassis.setMotionStackSize(TASK_STACK_DEPTH_DEFAULT * 2);
+         *     chassis.calibrate();
+         * }
+         * @endcode
+         */
+        void setMotionStackSize(uint16_t words);
+        /**
+         * @brief Set the time between iterations of the motion loops
+         *
+         * The odometry update period is set to match, so each iteration runs right after a fresh pose. Gains and
+         * slew rates are tuned for 10 ms iterations, and are scaled by the measured time between iterations, so
+         * motions behave the same at any period
+         *
+         * @param period the time between iterations, in milliseconds. 10 by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     chassis.calibrate();
+         *     // run motions and odometry every 5 ms
+         *     chassis.setControlPeriod(5);
+         * }
+         * @endcode
+         */
+        void setControlPeriod(uint32_t period);
+        /**
+         * @brief Get the time between iterations of the motion loops
+         *
+         * @return uint32_t the period, in milliseconds
+         */
+        uint32_t getControlPeriod();
+        /**
+         * @brief Get the timing of the motion loops of a type of motion
+         *
+         * Every iteration of a motion loop records how long it ran and how late it woke up
+         *
+         * @param type the type of motion
+         * @return LoopProfiler& the profiler of the motion loops
+         *
+         * @b Example
+         * @code {.cpp}
+         * chassis.moveToPose(24, 24, 90, 2000, {}, false);
+         * // send the timing of moveToPose to the telemetry sink
+         * chassis.getLoopProfiler(lemlib::MotionType::MOVE_TO_POSE).report("moveToPose");
+         * @endcode
+         */
+        LoopProfiler& getLoopProfiler(MotionType type);
         /**
-         * @brief Cancels all motions, even those that are queued.
-         * After this, the chassis will not be in motion.
+         * @brief Record the internals of every iteration of every motion
+         *
+         * @param trace the trace the samples are sent to, or nullptr to stop recording. nullptr by default
          *
          * @b Example
          * @code {.cpp}
-         * // move the robot to x = 20, y = 20 with a timeout of 4000ms
-         * chassis.moveToPoint(20, 20, 4000);
-         * // wait 500 milliseconds
-         * pros::delay(500);
-         * // cancel all motions. The robot will stop immediately
-         * chassis.cancelAllMotions();
+         * lemlib::MotionTrace trace(lemlib::TraceOutput::TELEMETRY);
+         * void autonomous() {
+         *     chassis.setMotionTrace(&trace);
+         *     chassis.moveToPoint(0, 48, 4000);
+         * }
          * @endcode
-         * @b Example (advanced)
+         */
+        void setMotionTrace(MotionTrace* trace);
+        /**
+         * @brief Append a summary of every motion to a log when it ends
+         *
+         * @param log the log the summaries are sent to, or nullptr to stop logging. nullptr by default
+         *
+         * @b Example
          * @code {.cpp}
-         * // this example shows how the cancelMotion function behaves when a motion is queued
-         * // this is an advanced example since we will be using tasks here
-         * // move the robot to x = 20, y = 20 with a timeout of 4000ms
-         * chassis.moveToPoint(20, 20, 4000);
-         * // start a lambda task that will be used to cancel all motions after 500ms
-         * pros::Task task([] {
-         *     // wait 500 milliseconds
-         *     pros::delay(500);
-         *     // cancels both motions
-         *     chassis.cancelAllMotions();
-         * });
-         * // queue a motion to x = 10, y = 10 with a timeout of 4000ms
-         * // this will never run because cancelAllMotions will be called while this motion is in the queue
-         * chassis.moveToPoint(10, 10, 4000);
+         * lemlib::MotionLog motionLog;
+         * void initialize() {
+         *     chassis.calibrate();
+         *     chassis.setMotionLog(&motionLog);
+         * }
          * @endcode
          */
-        void cancelAllMotions();
+        void setMotionLog(MotionLog* log);
+        /**
+         * @brief Keep the last few seconds of odometry and motions in a flight recorder
+         *
+         * @param recorder the flight recorder, or nullptr to stop recording. nullptr by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::FlightRecorder recorder;
+         * void initialize() {
+         *     chassis.calibrate();
+         *     chassis.setFlightRecorder(&recorder);
+         * }
+         * @endcode
+         */
+        void setFlightRecorder(FlightRecorder* recorder);
         /**
-         * @return whether a motion is currently running
+         * @return whether a motion is currently running or queued
          *
          * @b Example
          * @code {.cpp}
@@ -913,23 +2905,731 @@ class Chassis {
         PID angularPID;
     protected:
         /**
-         * @brief Indicates that this motion is queued and blocks current task until this motion reaches front of queue
+         * @brief Start the motion that was just taken from the queue
+         *
+         * @return true the motion is running
+         * @return false the motion was cancelled before it started
+         */
+        bool requestMotionStart();
+        /**
+         * @brief Mark the running motion as finished
+         *
+         * @param reason why the motion ended. CANCELLED is used instead if the motion was cancelled
+         */
+        void endMotion(MotionEndReason reason);
+        /**
+         * @brief Work out why a motion ended
+         *
+         * @param settled whether the exit conditions of the motion were met
+         * @param timedOut whether the motion ran out of time
+         * @return MotionEndReason CANCELLED if the motion was cancelled, STALLED if the robot stalled, COLLIDED if it
+         * was hit and aborted, CONDITION_MET if an exit condition became true, EARLY_EXIT if it wasn't settled and
+         * didn't time out
+         */
+        MotionEndReason exitReason(bool settled, bool timedOut) const;
+        /**
+         * @brief Get a handle to the running motion
+         *
+         * @return MotionHandle the handle
+         */
+        MotionHandle currentMotion();
+        /**
+         * @brief Get the record of a motion
+         *
+         * @param id the id of the motion
+         * @return MotionRecord* the record, or nullptr if it was reused by a newer motion
+         */
+        MotionRecord* getMotionRecord(uint32_t id) override;
+        /**
+         * @brief Set why a motion ended, and run its completion callbacks
+         *
+         * Does nothing if the reason was already set
+         *
+         * @param id the id of the motion
+         * @param reason why the motion ended
+         */
+        void finishMotion(uint32_t id, MotionEndReason reason);
+        /**
+         * @brief Report the progress of the running motion
+         *
+         * Called by motion loops every iteration, after distTraveled is updated. Runs the callbacks whose trigger was
+         * reached, and wakes tasks waiting for the distance
+         *
+         * @param pathIndex the index of the closest point on the path. -1 if the motion doesn't follow a path
+         */
+        void reportProgress(int pathIndex = -1);
+        /**
+         * @brief Run a callback that was reached, unless it already ran
+         *
+         * Deferred callbacks are posted to the callback task instead of running on the calling task
+         *
+         * @param callback the callback
+         */
+        void fireCallback(MotionCallback& callback);
+        /**
+         * @brief Block the calling task until a motion ends or travels a distance
+         *
+         * @param id the id of the motion
+         * @param dist the distance. INFINITY to wait until the motion ends
+         */
+        void waitForMotion(uint32_t id, float dist) override;
+        /**
+         * @brief Whether the running motion should keep running
+         *
+         * @return true the motion is running
+         * @return false the motion was cancelled, or isn't running
+         */
+        bool motionRunning() const;
+        /**
+         * @brief Whether a motion with a higher priority than the running motion is waiting to run
+         *
+         * @return true the running motion should stop so the waiting motion can run
+         * @return false no motion with a higher priority is queued
+         */
+        bool motionPreempted() const;
+        /**
+         * @brief Take the next motion to run, from the highest priority that has one
+         *
+         * Suspended motions run before the queued motions of their priority
+         *
+         * @param command where the motion is copied to
+         * @return true a motion was taken
+         * @return false there are no motions to run
+         */
+        bool nextMotion(MotionCommand& command);
+        /**
+         * @brief Whether the calling task is the motion task
+         *
+         * @return true the calling task is the motion task
+         * @return false the calling task is any other task
+         */
+        bool onMotionTask();
+        /**
+         * @brief Wait until odometry publishes a new pose, so each step of a motion runs right after a fresh pose
+         *
+         * If odometry doesn't update at the control period, the loop runs on its own schedule instead. Measures the
+         * time since the last iteration and sets the time step of the PIDs, so derivatives and slew rates are scaled
+         * by the real period. Returns early if the motion is cancelled
+         */
+        void waitForTick();
+        /**
+         * @brief Send the sample of this iteration to the motion trace and the flight recorder, if there are any
+         *
+         * Called by motion loops every iteration, after the power is sent. The time and type of the sample are filled
+         * in
+         *
+         * @param sample the sample
+         */
+        void trace(MotionSample& sample);
+        /**
+         * @brief Send power to both sides of the drivetrain
+         *
+         * Power is sent as a voltage, so it keeps the full resolution of the motors. Sides whose voltage is the same
+         * as the last command aren't sent again, which frees bandwidth on the device bus for sensors. If the
+         * drivetrain has a power manager, both sides are scaled down together to stay within its budget
+         *
+         * @param left power of the left side, from -127 to 127
+         * @param right power of the right side, from -127 to 127
+         */
+        void setDrivePower(float left, float right);
+        /**
+         * @brief Send power to one side of the drivetrain
+         *
+         * @param side the side
+         * @param power the power, from -127 to 127
+         */
+        void setDrivePower(DriveSide side, float power);
+        /**
+         * @brief Send power to the wheels of the holonomic drivetrain
+         *
+         * The wheels are desaturated together to maxPower, and to the budget of the power manager if the drivetrain
+         * has one. The voltage is compensated for the battery like the sides of a differential drivetrain. The last
+         * commands of the sides are forgotten, so the next command to a side is always sent
+         *
+         * @param forward the forwards power, from -127 to 127
+         * @param strafe the power to the right, from -127 to 127
+         * @param turn the turning power, clockwise positive, from -127 to 127
+         * @param maxPower the most power any wheel is given
+         * @return WheelPowers the power sent to each wheel
+         */
+        WheelPowers setHolonomicPower(float forward, float strafe, float turn, float maxPower = 127);
+        /**
+         * @brief Brake one side of the drivetrain, using its brake mode
+         *
+         * @param side the side
+         */
+        void brakeDriveSide(DriveSide side);
+        /**
+         * @brief Stop the drivetrain at the end of a motion, with the active stop if it is enabled
+         *
+         * @param reason why the motion is ending. Only motions that settled or timed out are stopped actively
+         */
+        void stopDrivetrain(MotionEndReason reason);
+        /**
+         * @brief Hold the robot at the pose the last motion left it at, until the motion task is notified. Called by
+         * the motion task while the motion queue is empty
+         *
+         * @return true the motion task was notified, so the queue should be checked
+         * @return false the robot isn't held, so the motion task should sleep until it is notified
+         */
+        bool holdPose();
+        /**
+         * @brief Check whether the robot has stalled, and end the motion if it has been stalled long enough. Called
+         * every iteration of the motion loops
+         */
+        void checkStall();
+        /**
+         * @brief Correct odometry against the wall the robot stalled against, if it is square to one
+         *
+         * @param direction 1 if the robot pushed forwards, -1 if backwards
+         */
+        void resetAgainstWall(const StallSettings& settings, float direction);
+        /**
+         * @brief Measure the jump in acceleration of the robot, and record a collision if it is large enough. Read by
+         * the tracking task every update
+         *
+         * @return float the jump in acceleration, in g
+         */
+        float readCollision();
+        /**
+         * @brief Run the collision callbacks of the running motion if the robot was hit since it started, and abort
+         * the motion if the settings say to. Called every iteration of the motion loops
+         */
+        void checkCollision();
+        /**
+         * @brief Read the tilt of the robot, and update the fraction of the slew it accelerates with. Called every
+         * iteration of the motion loops
+         */
+        void updateTipScale();
+        /**
+         * @brief Get the slew motions limit their lateral output with, which anti-tip lowers while the robot tips
+         *
+         * @param settings the lateral controller settings of the motion
+         * @return float the slew
+         */
+        float lateralSlew(const ControllerSettings& settings) const;
+        /**
+         * @brief Forget the last drivetrain commands, so the next ones are always sent
+         *
+         * Called when a motion starts, in case something else commanded the motors since the last motion
+         */
+        void resetDriveOutput();
+        /**
+         * @brief Send a command to one side of the drivetrain, unless it is the same as the last one
+         *
+         * Stopping and braking are sent even when they repeat the last command, so a stop is never lost to motor
+         * commands the chassis didn't send
+         *
+         * @param side the side
+         * @param command the voltage in millivolts, or BRAKE_COMMAND
+         */
+        void sendDriveCommand(DriveSide side, int32_t command);
+        /**
+         * @brief Start timing the iterations of a motion
+         */
+        void resetTick();
+        /**
+         * @brief Start the task that runs motions, if it isn't running already
+         */
+        void startMotionTask();
+        /**
+         * @brief Find a tuning value of the chassis
+         *
+         * @param key the hash of the name of the value, from configKeyHash
+         * @return float* the value, or nullptr if the chassis has no value with that name
+         */
+        float* findParameter(uint32_t key);
+        /**
+         * @brief Apply the changes queued by setParameter. Only called by the motion task, between iterations
+         */
+        void applyParameters();
+        /**
+         * @brief Substitute missing tracking wheels, reset the sensors, and start odometry and the motion task
+         *
+         * @param imu the inertial sensor odometry starts with. nullptr if it isn't calibrated yet
+         */
+        void startTracking(pros::Imu* imu);
+        /**
+         * @brief Queue a motion to be run by the motion task
+         *
+         * This doesn't wait for the motion to start, and only waits if the queue is full
+         *
+         * @param command the motion to run. It is copied, so it doesn't need to outlive the call
+         * @return MotionHandle a handle to the queued motion
+         */
+        MotionHandle queueMotion(MotionCommand command);
+        /**
+         * @brief Move the target of a motion from the coordinates of the route to the field
+         *
+         * @param command the motion. Its transform is set to the field transform
+         */
+        void applyFieldTransform(MotionCommand& command) const;
+        /**
+         * @brief Run a motion on the calling task
+         *
+         * @param command the motion to run
+         */
+        void runMotion(const MotionCommand& command);
+        /**
+         * @brief Send the summary of a motion that just ended to the motion log
+         *
+         * @param command the motion
+         */
+        void summarizeMotion(const MotionCommand& command);
+        /**
+         * @brief Update the angular PID for a turn or swing
+         *
+         * If enabled in the angular settings, the derivative comes from the gyro instead of the change in error
+         *
+         * @param error the heading error, in degrees
+         * @return float the output of the angular PID
+         */
+        float updateAngularPID(float error);
+        /**
+         * @brief Get the angular settings a turn or swing follows its motion profile with
+         *
+         * If the angular controller doesn't set maxVelocity and maxAcceleration, and the motion asks for it, they are
+         * found from the drivetrain. The fastest wheel moves along an arc around the center of rotation, so the motion
+         * is limited by the top speed of the wheels, and by the acceleration the feedforward model allows, or the slew
+         * rate. Some power is left for the PID to correct with. With traction, the wheel is also kept from skidding:
+         * the acceleration along the arc and the acceleration toward its center are kept within the friction of the
+         * wheel together
+         *
+         * @param maxSpeed the maximum speed of the motion, from 0 to 127
+         * @param timeOptimal whether to find the limits from the drivetrain
+         * @param radius the radius of the arc of the fastest wheel, in inches. Half the track width in a turn, and the
+         * track width in a swing
+         * @param traction the coefficient of friction between the wheels and the field. 0 to not limit by traction
+         * @return ControllerSettings the angular settings, with the limits of the profile in degrees
+         */
+        ControllerSettings turnProfileSettings(float maxSpeed, bool timeOptimal, float radius, float traction = 0);
+        /**
+         * @brief Find the error to the setpoint of a motion profile
+         *
+         * The profile is planned on the first call, from the error at the start of the motion, so the controller
+         * tracks a planned position instead of jumping straight to the target
+         *
+         * @param profile the profile of the motion. Planned on the first call
+         * @param settings the settings with the limits of the profile. If they aren't set, the error is returned as is
+         * @param error the error to the target
+         * @param time the time since the motion started, in milliseconds
+         * @param setpoint set to the state of the profile at the time. At rest if there is no profile
+         * @return float the error to the setpoint
+         */
+        float trackProfile(std::optional<MotionProfile>& profile, const ControllerSettings& settings, float error,
+                           uint32_t time, ProfileState& setpoint);
+        /**
+         * @brief Find the power a drivetrain side needs for a velocity, using the feedforward model
+         *
+         * @param velocity the velocity of the side, in inches per second
+         * @param acceleration the acceleration of the side, in inches per second squared
+         * @return float the power, from -127 to 127. 0 if the model is disabled
+         */
+        float feedforwardPower(float velocity, float acceleration);
+        /**
+         * @brief Find the power a drivetrain side needs for a velocity, using the feedforward model and the velocity
+         * loop
+         *
+         * Each side's loop keeps state between calls, so this should be called once per iteration for each side that
+         * is driven
+         *
+         * @param side the side
+         * @param velocity the velocity of the side, in inches per second
+         * @param acceleration the acceleration of the side, in inches per second squared
+         * @return float the power, from -127 to 127. The feedforward power if velocity control is disabled
+         */
+        float velocityPower(DriveSide side, float velocity, float acceleration);
+        /**
+         * @brief Follow a list of points on the motion task. The body of follow for paths and path views
+         *
+         * @tparam P a Path or a PathView
+         */
+        template <typename P>
+        MotionHandle followPoints(const P& path, float lookahead, int timeout, bool forwards, int deadline,
+                                  const FollowParams& params);
+        /**
+         * @brief Settle on the end of a path with the lateral controller, once follow is close to it
+         *
+         * The robot carries on at the speed it was following the path at, and slows down no harder than the max
+         * acceleration of the lateral controller allows, if it has one
+         *
+         * @param target the end of the path
+         * @param timeout the time the motion has left, in milliseconds
+         * @param compState the competition state when the motion started
+         * @param pathIndex the path index progress callbacks see
+         * @return true the robot settled on the end of the path
+         */
+        bool finishPath(Pose target, int timeout, int compState, int pathIndex);
+        /**
+         * @brief Replay a driver macro on the motion task
+         *
+         * @param transform the field transform the macro was queued in
+         */
+        MotionHandle runMacro(const DriverMacro& macro, MacroParams params, const FieldTransform& transform);
+        /**
+         * @brief Get the limits trajectories are planned with
+         *
+         * @param maxSpeed the maximum speed, from 0 to 127
+         * @return TrajectoryConstraints the maxVelocity and maxAcceleration of the lateral controller, or the top
+         * speed of the drivetrain and the slew rate if they aren't set
+         */
+        TrajectoryConstraints trajectoryConstraints(float maxSpeed = 127);
+        /**
+         * @brief Find the fraction of the speed limits of a lateral motion that drives a distance in a certain time
+         *
+         * The motion is modeled as a trapezoidal profile with the limits trajectories are planned with, which starts
+         * at the speed of the robot
+         *
+         * @param distance the distance the robot drives, in inches
+         * @param speed the speed of the robot, in inches per second
+         * @param deadline the time it has, in milliseconds. 0 or less if there is no deadline or no time left
+         * @param maxSpeed the speed limit of the motion, from 0 to 127
+         * @return float the fraction, from 0 to 1. 1 if there is no time left, or the robot can't make it in time
+         */
+        float deadlineScale(float distance, float speed, float deadline, float maxSpeed);
+        /**
+         * @brief The holonomic mode of moveToPose, run once the motion has started
+         *
+         * The translation and heading have a controller each. The lateral controller drives the distance to the
+         * target along the line to it, in whichever direction that is relative to the robot, and the angular
+         * controller turns the robot to the heading at the same time
+         *
+         * @param target the target, in standard form
+         * @param timeout longest time the robot can spend moving
+         * @param params the parameters of the motion
+         * @return MotionHandle a handle to the motion
+         */
+        MotionHandle moveToPoseHolonomic(Pose target, int timeout, MoveToPoseParams params);
+        /**
+         * @brief Get the measured length of the last iteration of the motion loop
+         *
+         * @return float the length, in seconds
+         */
+        float tickDuration() const;
+        /**
+         * @brief Update a small error exit condition, predicting where the robot will stop
+         *
+         * The robot is assumed to decelerate evenly to a stop, at the maximum acceleration of the motion profile if
+         * it is set. Without early exits enabled in the settings, this is the same as updating the exit condition
+         *
+         * @param exit the exit condition
+         * @param settings the settings of the controller the exit condition belongs to
+         * @param error the error
+         * @param speed how fast the robot is reducing the error, in units per second
+         */
+        void updateSmallExit(ExitCondition& exit, const ControllerSettings& settings, float error, float speed);
+        /**
+         * @brief Wake the tasks waiting in waitUntil whose distance has been reached
+         *
+         * @param ended whether a motion just ended, which wakes every waiting task
+         */
+        void notifyWaiters(bool ended = false);
+        /**
+         * @brief Block the calling task until a condition is true
+         *
+         * The task is woken by notifyWaiters, so the condition is checked as soon as it could have changed
+         *
+         * @param done returns whether to stop waiting
+         * @param dist the distance traveled that wakes the task. INFINITY to only wake when a motion ends
          */
-        void requestMotionStart();
+        template <typename F> void waitFor(F done, float dist);
+
+        /** state of the motion task */
+        std::atomic<MotionState> motionState = MotionState::IDLE;
+        /** incremented by cancelAllMotions, so motions queued before it was called are skipped */
+        std::atomic<uint32_t> cancelGeneration = 0;
+        /** number of motions that have been queued */
+        std::atomic<uint32_t> motionsQueued = 0;
+        /** number of motions that have finished or were skipped. The running motion is number motionsFinished + 1 */
+        std::atomic<uint32_t> motionsFinished = 0;
         /**
-         * @brief Dequeues this motion and permits queued task to run
+         * @brief A task blocked in waitUntil
          */
-        void endMotion();
+        struct MotionWaiter {
+                /** the waiting task. nullptr if the slot is free */
+                std::atomic<pros::task_t> task = nullptr;
+                /** the distance the task is waiting for */
+                std::atomic<float> distance = 0;
+        };
+        /** tasks waiting for motions. More tasks than this can wait, but they poll instead of being notified */
+        std::array<MotionWaiter, 4> waiters;
+        /** id of the motion the motion task is running, or last ran */
+        std::atomic<uint32_t> runningMotion = 0;
+        /** the motion measureMotionLatency times the drive commands of. 0 if none is timed */
+        std::atomic<uint32_t> latencyMotion = 0;
+        /** low 32 bits of the time the timed motion first drove, and first stopped, in microseconds. 0 until it does */
+        std::atomic<uint32_t> latencyDrive = 0;
+        std::atomic<uint32_t> latencyStop = 0;
+        /** records of recent motions, indexed by id modulo the number of records */
+        MotionRecord* motionRecords = nullptr;
+        /** number of motion records. Twice the queue depth, so a record is never reused while its motion is queued */
+        size_t motionRecordCount = 0;
 
-        bool motionRunning = false;
-        bool motionQueued = false;
+        friend class MotionHandle;
+        /** number of motions that can be queued */
+        size_t motionQueueDepth = 16;
+        // 0 until set by setMotionStackSize, or the motion task starts with the stack of the task config
+        uint16_t motionStackSize = 0;
+        /** number of motions of each priority above NORMAL that can be queued */
+        static constexpr size_t PRIORITY_QUEUE_DEPTH = 4;
+        /** motions waiting to be run by the motion task, indexed by priority */
+        std::array<BoundedQueue<MotionCommand>*, 3> motionQueues {};
+        /**
+         * number of motions of each priority that are queued. Counted after the push and before the pop, so it can be
+         * -1 for a moment
+         */
+        std::array<std::atomic<int16_t>, 3> motionsWaiting {};
+        /** priority of the running motion */
+        std::atomic<MotionPriority> runningPriority = MotionPriority::NORMAL;
+        /** the transform from the coordinates of routes to the field */
+        FieldTransform fieldTransform;
+        /** what happens to preempted motions */
+        std::atomic<PreemptPolicy> preemptPolicy = PreemptPolicy::SUSPEND;
+        /** motions preempted under the SUSPEND policy. The last one has the highest priority. Motion task only */
+        std::array<MotionCommand, 4> suspendedMotions;
+        /** number of suspended motions. Motion task only */
+        size_t suspendedCount = 0;
+        /** whether the motion that just ended was suspended, so it isn't finished. Motion task only */
+        bool motionSuspended = false;
+        /** motions up to this id with a priority lower than dropPriority were dropped by a preempting motion */
+        std::atomic<uint32_t> dropBefore = 0;
+        /** priority of the motion that dropped the motions up to dropBefore */
+        std::atomic<MotionPriority> dropPriority = MotionPriority::NORMAL;
+        /** the time every motion has to be done by, from pros::millis. 0 if there is no deadline */
+        std::atomic<uint32_t> motionDeadline = 0;
+        /** task that runs motions */
+        pros::Task* motionTask = nullptr;
+        /** path motions whose paths haven't been loaded yet */
+        BoundedQueue<MotionCommand>* prepareQueue = nullptr;
+        /** low priority task that loads the paths of queued motions while the current motion runs */
+        pros::Task* prepareTask = nullptr;
+        /**
+         * @brief A callback posted to the callback task
+         */
+        struct DeferredCallback {
+                /** the function to call */
+                void (*callback)(void*) = nullptr;
+                /** the argument passed to the function */
+                void* arg = nullptr;
+        };
+        /** number of deferred callbacks that can wait for the callback task */
+        static constexpr size_t CALLBACK_QUEUE_DEPTH = 16;
+        /** deferred callbacks waiting to be run by the callback task */
+        BoundedQueue<DeferredCallback>* callbackQueue = nullptr;
+        /** task that runs deferred callbacks, so they can block without stalling the motion */
+        pros::Task* callbackTask = nullptr;
+        /** health of the motion, prepare and callback tasks */
+        TaskMonitor motionMonitor {"motion"};
+        TaskMonitor prepareMonitor {"motion prepare"};
+        TaskMonitor callbackMonitor {"motion callbacks"};
+        /**
+         * @brief Read the controller and drive the chassis, until driver control is stopped. Runs on the driver task
+         */
+        void runDriverControl();
+        /** task that drives the chassis from a controller, started by startDriverControl */
+        pros::Task* driverTask = nullptr;
+        /** whether the driver task is driving the chassis */
+        std::atomic<bool> driverEnabled = false;
+        /** settings of the driver task. Guarded by driverMutex */
+        DriverControlSettings driverSettings;
+        pros::Mutex driverMutex;
+        /** health of the driver task */
+        TaskMonitor driverMonitor {"driver control"};
+        /** the macro the driver task records into. nullptr if it isn't recording */
+        std::atomic<DriverMacro*> macroRecording = nullptr;
 
         float distTraveled = 0;
 
+        /** time between iterations of the motion loops, in milliseconds */
+        uint32_t controlPeriod = 10;
+        /** time the last iteration of the motion loop started, in microseconds */
+        uint64_t lastTick = 0;
+        /**
+         * time the current iteration of the motion loop started, in microseconds. Every timer and exit condition in
+         * an iteration is checked against it, so they agree on the time and don't each read the clock
+         */
+        uint64_t tickTime = 0;
+        /** timing of the motion loops, one for each type of motion */
+        std::array<LoopProfiler, size_t(MotionType::MACRO) + 1> loopProfilers;
+        /** the type of motion the motion task is running, which the timing of the loop is recorded for */
+        MotionType profiledMotion = MotionType::FOLLOW;
+        /** where the motion loops send their samples. nullptr if they aren't recorded */
+        std::atomic<MotionTrace*> motionTrace = nullptr;
+        /** keeps the samples of the motion loops in memory. nullptr if there isn't one */
+        std::atomic<FlightRecorder*> flightRecorder = nullptr;
+        /** where the summaries of motions are sent when they end. nullptr if they aren't logged */
+        std::atomic<MotionLog*> motionLog = nullptr;
+        /** the fastest the robot has driven during the running motion, in inches per second. Only measured if logged */
+        float maxMotionSpeed = 0;
+        /** the end of the path the running motion follows, for its summary. Set by the path motions */
+        Pose pathEnd = Pose(NAN, NAN);
+        /** the target the running moveToPoint blends into, and how far before its target it starts. Set by runMotion */
+        float blendX = NAN;
+        float blendY = NAN;
+        float blendRadius = 0;
+        /** whether a blended moveToPoint left the drivetrain running for the next motion. Motion task only */
+        bool blendHandedOff = false;
+        /** time the last iteration of the motion loop was due, in milliseconds. Used when not phase-locked */
+        uint32_t tickDeadline = 0;
+        /** the sequence number of the odometry state when the current iteration of the motion loop started */
+        uint32_t tickSequence = 0;
+        /** the sequence number of the last odometry state streamed to telemetry, so the same pose isn't sent twice */
+        uint32_t telemetrySequence = 0;
+        /**
+         * length of the last iteration of the motion loop, relative to the TUNED_PERIOD the gains are tuned at. Slew
+         * rates are multiplied by it
+         */
+        float tickScale = 1;
+
+        /** the last command wasn't sent, or is unknown */
+        static constexpr int32_t NO_COMMAND = INT32_MAX;
+        /** the last command braked the motors */
+        static constexpr int32_t BRAKE_COMMAND = INT32_MIN;
+        /** last command sent to the left side of the drivetrain, in millivolts */
+        std::atomic<int32_t> leftCommand = NO_COMMAND;
+        /** last command sent to the right side of the drivetrain, in millivolts */
+        std::atomic<int32_t> rightCommand = NO_COMMAND;
+
+        /**
+         * @brief Measure the slip of the drivetrain, and limit the growth of the power if it is slipping
+         *
+         * @param left the power of the left side, limited in place
+         * @param right the power of the right side, limited in place
+         */
+        void controlTraction(float& left, float& right);
+        /**
+         * @brief Make the tracking wheels that measure the speed of the drive motors, if they haven't been made
+         */
+        void makeDriveWheels();
+        std::optional<TractionSettings> traction = std::nullopt;
+        /** the drive motors, used as vertical tracking wheels when the chassis has none, or when 1 fails */
+        std::optional<TrackingWheel> leftVertical = std::nullopt;
+        std::optional<TrackingWheel> rightVertical = std::nullopt;
+        /** the drive motors, which measure the speed of the wheels for slip detection */
+        std::optional<TrackingWheel> leftDriveWheel = std::nullopt;
+        std::optional<TrackingWheel> rightDriveWheel = std::nullopt;
+        SlipState slip;
+        std::optional<VelocityControlSettings> velocityControl = std::nullopt;
+        /**
+         * @brief Get how much the commands are scaled by to make up for the battery voltage
+         *
+         * The battery is read again if the period has passed since it was last read
+         *
+         * @return float the scale. 1 if compensation is disabled
+         */
+        float batteryScale();
+        std::optional<BatteryCompensationSettings> batteryCompensation = std::nullopt;
+        std::optional<ActiveStopSettings> activeStop = std::nullopt;
+        std::optional<PoseHoldSettings> poseHold = std::nullopt;
+        /** the pose the robot is held at between motions, in standard radians */
+        Pose holdTarget = Pose(0, 0, 0);
+        /** whether the robot is held between motions. Cleared when the driver drives the robot */
+        std::atomic<bool> holdArmed = false;
+        /** set by setPose, so the hold moves to the new pose */
+        std::atomic<bool> holdMoved = false;
+        /** the start of the period of the match the hold was started in */
+        uint32_t holdPeriodStart = 0;
+        std::optional<StallSettings> stallDetection = std::nullopt;
+        /** when the robot started pushing without moving, in milliseconds. 0 while it isn't stalled */
+        uint32_t stallStart = 0;
+        /** whether the running motion has stalled, so the motion loop exits */
+        std::atomic<bool> motionStalled = false;
+        std::optional<CollisionSettings> collisionDetection = std::nullopt;
+        /** the id of the odometry sensor that detects collisions. -1 until collision detection is first set */
+        int collisionSensor = -1;
+        /** the threshold and cooldown used by the tracking task, since it can't read the settings safely. A
+         * threshold of 0 doesn't detect collisions */
+        std::atomic<float> collisionThreshold = 0;
+        std::atomic<uint32_t> collisionCooldown = 0;
+        /** number of collisions detected. Written after the time and strength, so they are read after it */
+        std::atomic<uint32_t> collisionCount = 0;
+        std::atomic<uint32_t> collisionTime = 0;
+        std::atomic<float> collisionStrength = 0;
+        /** the acceleration at the last update of the tracking task, in g */
+        float prevAccelX = NAN;
+        float prevAccelY = NAN;
+        /** the number of collisions when the running motion started or last ran its collision callbacks */
+        uint32_t motionCollisions = 0;
+        /** whether the running motion was hit and aborted, so the motion loop exits */
+        std::atomic<bool> motionCollided = false;
+        /** whether an exit condition of the running motion became true, so the motion loop exits */
+        std::atomic<bool> motionConditionMet = false;
+        std::optional<AntiTipSettings> antiTip = std::nullopt;
+        /** the fraction of the slew anti-tip allows */
+        float tipScale = 1;
+        /** the pitch and roll of the inertial sensor when the motion started, in degrees */
+        float basePitch = 0;
+        float baseRoll = 0;
+        /**
+         * @brief Get the fraction of their limits motions plan with, so hot motors aren't current limited
+         *
+         * @return float the fraction. 1 if the thermal model isn't enabled
+         */
+        float thermalScale();
+        std::optional<ThermalModel> thermalModel = std::nullopt;
+        std::optional<DriverLatency> driverLatency = std::nullopt;
+        /** when the driver task read the controller, in microseconds. 0 when tank, arcade, and curvature aren't
+         * called by the driver task */
+        std::atomic<uint64_t> driverReadTime = 0;
+        /**
+         * @brief Send the power of a driver function to the drivetrain, and time it if the latency is tracked
+         *
+         * @param readTime when the controller was read, in microseconds
+         */
+        void setDriverPower(uint64_t readTime, float left, float right);
+        /**
+         * @brief Get the power of each side for the sticks of a drive scheme, like tank, arcade, and curvature
+         *
+         * @param throttle the throttle, or the left side in tank
+         * @param turn the turn, or the right side in tank
+         * @return std::pair<float, float> the power of the left and right sides
+         */
+        std::pair<float, float> drivePower(DriveScheme scheme, int throttle, int turn, bool disableDriveCurve,
+                                           float desaturateBias);
+        /**
+         * @brief Get when the controller was read for the driver function being called, in microseconds
+         */
+        uint64_t driverInputTime() const;
+        std::atomic<float> compensationScale = 1;
+        /** the time the battery was last read, in milliseconds */
+        std::atomic<uint32_t> lastBatteryRead = 0;
+        /** the velocity loop of each side */
+        PID leftVelocityPID {0, 0, 0};
+        PID rightVelocityPID {0, 0, 0};
+        /** the last power sent to each side, which traction control limits the growth from */
+        float lastLeftPower = 0;
+        float lastRightPower = 0;
+        /** the time power was last sent, in microseconds */
+        uint64_t lastPowerTime = 0;
+
+        Feedforward feedforward;
+        std::optional<AdaptiveLookahead> adaptiveLookahead = std::nullopt;
+        /** how far ahead follow predicts the pose, in milliseconds */
+        float followLatency = 0;
+
+        /**
+         * @brief A change to a tuning value, waiting to be applied by the motion task
+         */
+        struct ParameterUpdate {
+                /** hash of the name of the value */
+                uint32_t key = 0;
+                float value = 0;
+        };
+        /** changes queued by setParameter */
+        BoundedQueue<ParameterUpdate> parameterQueue {16};
+
+        /** state of the inertial sensor. sensors.imu is only used once it is READY */
+        std::atomic<ImuState> imuState = ImuState::MISSING;
+        /** task that calibrates the inertial sensor, started by calibrateAsync. Replaced by each calibration */
+        std::optional<pros::Task> imuTask;
+        /** task that stores the pose, started by enableCheckpoints */
+        pros::Task* checkpointTask = nullptr;
+
         ControllerSettings lateralSettings;
         ControllerSettings angularSettings;
         Drivetrain drivetrain;
         OdomSensors sensors;
+        Odometry odom;
         DriveCurve* throttleCurve;
         DriveCurve* steerCurve;
 
@@ -937,7 +3637,5 @@ class Chassis {
         ExitCondition lateralSmallExit;
         ExitCondition angularLargeExit;
         ExitCondition angularSmallExit;
-    private:
-        pros::Mutex mutex;
 };
 } // namespace lemlib
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include "pros/rtos.hpp"
+#include "lemlib/loopProfiler.hpp"
+#include "lemlib/ringBuffer.hpp"
+#include "lemlib/chassis/trackingWheel.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings for measuring the latency of driver control, set with Chassis::setDriverLatencyTracking
+ */
+struct DriverLatencySettings {
+        /** the most power a side can have for the robot to count as at rest, out of 127. 5 by default */
+        float restPower = 5;
+        /** the least power a side has to be pushed to from rest for its response to be timed, out of 127. 40 by
+         * default */
+        float stepPower = 40;
+        /** how fast a wheel has to turn in the commanded direction to have responded, in inches per second. 3 by
+         * default */
+        float responseSpeed = 3;
+        /** the longest a wheel can take to respond before the step is forgotten, in milliseconds. 500 by default */
+        uint32_t timeout = 500;
+};
+
+/**
+ * @brief The latency from the sticks to the wheels, measured by a DriverLatency
+ *
+ * Times are in microseconds. The response is only checked when the driver functions run, so it is rounded up to
+ * the period of the driver loop
+ */
+struct DriverLatencyStats {
+        /** from reading the controller to sending the motor command, on every call */
+        TimingStats command;
+        /** from the motor command of a step to the wheel turning */
+        TimingStats response;
+        /** from reading the controller for a step to the wheel turning */
+        TimingStats total;
+        /** number of steps timed */
+        uint32_t steps = 0;
+};
+
+/**
+ * @brief Times how long the driver's input takes to reach the drive motors, and how long the motors take to turn the
+ * wheels
+ *
+ * Every call of tank, arcade, or curvature is timed from the controller read to the motor command. When a side is
+ * pushed from rest, the time until its wheel turns in the pushed direction is timed as well, so the whole latency
+ * from the stick to the wheel is known, and faster driver loops and drive curves can be compared by what the driver
+ * feels. The last SAMPLES of each time are kept, without allocating
+ */
+class DriverLatency {
+    public:
+        /** number of samples of each time that are kept */
+        static constexpr size_t SAMPLES = 64;
+
+        /**
+         * @brief Construct a new Driver Latency
+         *
+         * @param left the wheel of the left side of the drivetrain, from its motors. Must outlive this
+         * @param right the wheel of the right side of the drivetrain, from its motors. Must outlive this
+         * @param settings the settings
+         */
+        DriverLatency(TrackingWheel* left, TrackingWheel* right, DriverLatencySettings settings = {});
+        /**
+         * @brief Record a motor command sent by a driver function, and check whether a timed step has responded
+         *
+         * @param readTime when the controller was read, in microseconds
+         * @param left the power of the left side, out of 127
+         * @param right the power of the right side, out of 127
+         */
+        void record(uint64_t readTime, float left, float right);
+        /**
+         * @brief Get the latencies timed so far
+         *
+         * @return DriverLatencyStats the latencies
+         */
+        DriverLatencyStats getStats();
+    private:
+        /**
+         * @brief A step being timed on one side
+         */
+        struct Step {
+                /** true while waiting for the wheel to respond */
+                bool pending = false;
+                /** the direction the side was pushed, 1 or -1 */
+                float direction = 0;
+                /** when the controller was read and when the command was sent, in microseconds */
+                uint64_t readTime = 0;
+                uint64_t commandTime = 0;
+        };
+
+        /**
+         * @brief Start timing a step if the side was pushed from rest, or time its response if the wheel turned
+         */
+        void updateStep(Step& step, TrackingWheel* wheel, float power, float lastPower, uint64_t readTime,
+                        uint64_t now);
+
+        TrackingWheel* left;
+        TrackingWheel* right;
+        DriverLatencySettings settings;
+        Step leftStep;
+        Step rightStep;
+        float lastLeft = 0;
+        float lastRight = 0;
+        RingBuffer<uint32_t, SAMPLES> command;
+        RingBuffer<uint32_t, SAMPLES> response;
+        RingBuffer<uint32_t, SAMPLES> total;
+        uint32_t steps = 0;
+        /** held while a command is recorded, so the stats aren't read halfway through */
+        pros::Mutex mutex;
+};
+} // namespace lemlib
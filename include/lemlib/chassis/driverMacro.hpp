@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+enum class DriveScheme;
+
+/**
+ * @brief The sticks of a driver macro at one sample
+ */
+struct MacroSample {
+        /** the throttle, or the left side in tank, from -127 to 127 */
+        int8_t throttle = 0;
+        /** the turn, or the right side in tank, from -127 to 127 */
+        int8_t turn = 0;
+};
+
+/**
+ * @brief A pose of a driver macro
+ */
+struct MacroPose {
+        /** when the robot was at the pose, in milliseconds from the start of the macro */
+        uint32_t time = 0;
+        /** the pose, with theta in degrees */
+        Pose pose = Pose(0, 0, 0);
+};
+
+/**
+ * @brief A recording of the controller sticks, and where the robot was, while a driver drove
+ *
+ * The chassis records the sticks its driver control task reads every period of the macro, and the pose every
+ * posePeriod, with Chassis::startMacroRecording. Chassis::replayMacro feeds the sticks back through the same drive
+ * scheme and drive curves, and corrects the power by how far the robot is from where it was when the macro was
+ * recorded, so a driver can teach the robot a route.
+ *
+ * A macro is kept in memory as a stream of bytes, and can be saved to the SD card and loaded again. It starts with
+ * an 11 byte header: "LMC" and the version, the drive scheme, whether the drive curves were disabled, the desaturate
+ * bias in hundredths, and the period and pose period as uint16 milliseconds. Then each record is a tag byte:
+ * - 0x00 to 0x7F: the sticks didn't change, for the tag plus 1 samples
+ * - 0x80 to 0xBF: one sample, where each stick changed by -4 to 3. The throttle is bits 3 to 5, the turn bits 0 to 2
+ * - 0xC0: one sample, followed by the throttle and turn as int8
+ * - 0xC1: a pose, followed by x and y as int16 quarter inches and theta as an int16 half degree from -180 to 180
+ * - 0xC2: a pose, followed by the change in x, y, and theta since the last pose as int8, in the same units
+ *
+ * A pose is where the robot was at the time of the sample after it. The changes are between the rounded poses, so
+ * rounding errors don't add up. Sticks that are held take a byte every 127 samples, and sticks that move smoothly a
+ * byte a sample, so at the default 20 ms period and 200 ms pose period a minute of driving takes about 1 to 4 KB.
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::DriverMacro macro;
+ * void opcontrol() {
+ *     chassis.startDriverControl();
+ *     // teach the route in the first 60 seconds of driver control, then save it
+ *     chassis.startMacroRecording(macro);
+ *     pros::delay(60000);
+ *     chassis.stopMacroRecording();
+ *     macro.save("/usd/skills.lmc");
+ * }
+ * void autonomous() {
+ *     lemlib::DriverMacro skills;
+ *     if (skills.load("/usd/skills.lmc")) chassis.replayMacro(skills, {}, false);
+ * }
+ * @endcode
+ */
+class DriverMacro {
+    public:
+        /**
+         * @brief Construct a new, empty Driver Macro
+         *
+         * @param period time between samples of the sticks, in milliseconds. 20 by default
+         * @param posePeriod time between poses, in milliseconds. Rounded to a whole number of samples. 200 by default
+         */
+        DriverMacro(uint32_t period = 20, uint32_t posePeriod = 200);
+        /**
+         * @brief Clear the macro, and start recording with a drive scheme. Called by the chassis
+         *
+         * @param scheme the drive scheme the sticks drive with
+         * @param disableDriveCurve whether the drive curves are disabled
+         * @param desaturateBias how much arcade favors turning when the motors are saturated
+         */
+        void begin(DriveScheme scheme, bool disableDriveCurve, float desaturateBias);
+        /**
+         * @brief Record the sticks and the pose, if the next sample is due. Called by the chassis
+         *
+         * Samples are taken on a fixed schedule from the first call. A call that comes late records the samples it
+         * missed with the same sticks, so the macro keeps time with the recording. After more than 100 ms without a
+         * call, like while a motion has the drivetrain, the macro carries on from where it paused instead
+         *
+         * @param throttle the throttle, or the left side in tank
+         * @param turn the turn, or the right side in tank
+         * @param pose the pose of the robot, with theta in degrees
+         * @param time the time of the reading, in milliseconds
+         */
+        void record(int throttle, int turn, Pose pose, uint32_t time);
+        /**
+         * @brief Decode the macro
+         *
+         * @param samples where the samples are written, one per period
+         * @param poses where the poses are written, in order of time
+         * @return true the macro was decoded
+         * @return false the macro is empty or corrupt
+         */
+        bool decode(std::vector<MacroSample>& samples, std::vector<MacroPose>& poses) const;
+        /**
+         * @brief Write the macro to a file
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/
+         * @return true the file was written
+         * @return false the file couldn't be written
+         */
+        bool save(const std::string& path) const;
+        /**
+         * @brief Read a macro from a file, replacing this one
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/
+         * @return true the macro was read
+         * @return false the file couldn't be read, or isn't a macro. The macro is left as it was
+         */
+        bool load(const std::string& path);
+        /**
+         * @brief Get where the robot was when the macro started, so the pose can be set to it before replaying
+         *
+         * @return Pose the pose, with theta in degrees. (0, 0, 0) if the macro is empty
+         */
+        Pose getStart() const;
+        /**
+         * @brief Get the encoded macro, including the header
+         *
+         * @return const std::vector<uint8_t>& the bytes. Empty if nothing was recorded
+         */
+        const std::vector<uint8_t>& getData() const;
+        /**
+         * @brief Get time between samples
+         *
+         * @return uint32_t the period, in milliseconds
+         */
+        uint32_t getPeriod() const;
+        /**
+         * @brief Get the length of the macro
+         *
+         * @return uint32_t the time the samples take, in milliseconds
+         */
+        uint32_t getDuration() const;
+        /**
+         * @brief Get the drive scheme the macro was recorded with
+         *
+         * @return DriveScheme the scheme
+         */
+        DriveScheme getScheme() const;
+        /**
+         * @brief Get whether the drive curves were disabled while the macro was recorded
+         *
+         * @return true the sticks drive the motors directly
+         * @return false the sticks go through the drive curves
+         */
+        bool driveCurveDisabled() const;
+        /**
+         * @brief Get how much arcade favored turning while the macro was recorded
+         *
+         * @return float the desaturate bias
+         */
+        float getDesaturateBias() const;
+    private:
+        /**
+         * @brief Add a sample of the sticks
+         */
+        void addSample(int throttle, int turn);
+        /**
+         * @brief Add a pose, which is where the robot was at the next sample
+         */
+        void addPose(Pose pose);
+
+        uint32_t period;
+        uint32_t poseInterval;
+        std::vector<uint8_t> data;
+        /** samples recorded, and the time of the first one */
+        uint32_t samples = 0;
+        uint32_t startTime = 0;
+        /** the time of the last call of record */
+        uint32_t lastTime = 0;
+        /** the sticks of the last sample */
+        int8_t lastThrottle = 0;
+        int8_t lastTurn = 0;
+        /** where the last record is, if it is a repeat that can count more samples. SIZE_MAX if it isn't */
+        size_t repeatPosition = SIZE_MAX;
+        /** the last pose, rounded to quarter inches and half degrees. Only valid if hasPose is set */
+        bool hasPose = false;
+        int32_t lastX = 0;
+        int32_t lastY = 0;
+        int32_t lastTheta = 0;
+};
+} // namespace lemlib
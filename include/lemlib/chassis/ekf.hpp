@@ -0,0 +1,88 @@
+#pragma once
+
+#include "lemlib/matrix.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief Noise settings for the extended Kalman filter
+ *
+ * Each heading source integrates its own heading, and the variance is how much that heading is trusted. Lower
+ * variances are trusted more
+ */
+struct EKFSettings {
+        /** variance of the heading from the horizontal tracking wheels, in radians squared */
+        float horizontalVariance = 0.0004;
+        /** variance of the heading from the vertical tracking wheels, in radians squared */
+        float verticalVariance = 0.0004;
+        /** variance of the heading from the motor encoders, when they substitute the vertical tracking wheels */
+        float driveVariance = 0.01;
+        /** variance of the heading from the inertial sensor, in radians squared */
+        float imuVariance = 0.0001;
+        /** variance added to x and y per inch traveled, in inches squared */
+        float translationNoise = 0.0025;
+        /** variance added to the heading per radian turned, in radians squared */
+        float rotationNoise = 0.0004;
+};
+
+/**
+ * @brief Extended Kalman filter over the pose of the robot
+ *
+ * The state is the pose of the robot. It is predicted by the odometry motion model, then corrected by the heading
+ * from every other heading source, and by the position from a GPS sensor if there is one, so no source is thrown
+ * away. All matrices have a fixed size, so nothing is allocated.
+ */
+class ExtendedKalmanFilter {
+    public:
+        /**
+         * @brief Construct a new Extended Kalman Filter
+         *
+         * @param settings the noise settings
+         */
+        ExtendedKalmanFilter(EKFSettings settings = EKFSettings());
+        /**
+         * @brief Reset the state of the filter
+         *
+         * @param pose the pose of the robot, theta in radians
+         */
+        void reset(Pose pose);
+        /**
+         * @brief Predict the pose of the robot using the odometry motion model
+         *
+         * @param prevPose the pose before the motion, theta in radians
+         * @param pose the pose after the motion, theta in radians
+         */
+        void predict(Pose prevPose, Pose pose);
+        /**
+         * @brief Correct the pose using a heading measurement
+         *
+         * @param heading the measured heading, in radians
+         * @param variance the variance of the measurement, in radians squared
+         */
+        void correctHeading(float heading, float variance);
+        /**
+         * @brief Correct the pose using a position measurement, like a reading of a GPS sensor
+         *
+         * @param x the measured x position, in inches
+         * @param y the measured y position, in inches
+         * @param variance the variance of the measurement on each axis, in inches squared
+         */
+        void correctPosition(float x, float y, float variance);
+        /**
+         * @brief Get the estimated pose of the robot
+         *
+         * @return Pose the estimated pose, theta in radians
+         */
+        Pose getPose();
+        /**
+         * @brief Get the noise settings
+         *
+         * @return EKFSettings the noise settings
+         */
+        EKFSettings getSettings();
+    private:
+        EKFSettings settings;
+        Pose pose = Pose(0, 0, 0);
+        Matrix<3, 3> covariance;
+};
+} // namespace lemlib
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "display/lvgl.h"
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/taskMonitor.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings of a FieldDisplay
+ */
+struct FieldDisplaySettings {
+        /** time between updates of the robot, in milliseconds */
+        uint32_t period = 100;
+        /** position of the top left corner of the field on the screen, in pixels */
+        int16_t x = 0;
+        int16_t y = 0;
+        /** width and height of the field on the screen, in pixels */
+        int16_t size = 240;
+        /** width and height of the field, in inches. The field is centered on the origin */
+        float fieldSize = 144;
+        /** width of a field tile, in inches. A line is drawn between tiles */
+        float tileSize = 24;
+        /** radius of the robot marker, in pixels. It points the way the robot faces */
+        int16_t markerRadius = 6;
+        /** colors, as 0xRRGGBB */
+        uint32_t fieldColor = 0x404040;
+        uint32_t lineColor = 0x808080;
+        uint32_t pathColor = 0x00C000;
+        uint32_t robotColor = 0xFFFFFF;
+};
+
+/**
+ * @brief Draws the field, a path, and the pose of the robot on the brain screen
+ *
+ * The field and the path are drawn once into a cached background. Each update, only the pixels around the old and
+ * the new robot marker are copied from the background and drawn again, and only that rectangle is redrawn by LVGL.
+ * Nothing is drawn if the marker hasn't moved a pixel. Updates run on a task of their own at the lowest priority, a
+ * few times a second, so the display never takes time from the control loops. PROS doesn't lock LVGL, so once the
+ * display has started, LVGL is only called from its own task: the updates only draw into the canvas buffer, and a
+ * task created with lv_task_create hands the changed rectangle to LVGL.
+ *
+ * The canvas takes 2 * size * size pixels of memory, about 460 KB at the default size
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::FieldDisplay display(chassis);
+ *
+ * void initialize() {
+ *     chassis.calibrate();
+ *     // the right half of the screen
+ *     display.start({.x = 240});
+ * }
+ *
+ * void autonomous() {
+ *     display.drawPath(lemlib::pathCache().get(myPath_txt));
+ *     chassis.follow(myPath_txt, 15, 5000);
+ * }
+ * @endcode
+ */
+class FieldDisplay {
+    public:
+        /**
+         * @brief Construct a new Field Display. Nothing is drawn until start is called
+         *
+         * @param chassis the chassis whose pose is drawn. Must outlive the display
+         */
+        FieldDisplay(Chassis& chassis);
+        FieldDisplay(const FieldDisplay&) = delete;
+        FieldDisplay& operator=(const FieldDisplay&) = delete;
+        /**
+         * @brief Stop updating the display, and delete the canvas
+         *
+         * The canvas is deleted by the LVGL task, so this waits for it to run
+         */
+        ~FieldDisplay();
+        /**
+         * @brief Create the canvas on the active screen, and start updating it, if the display hasn't started already
+         *
+         * @param settings the settings. Defaults are used if not given
+         */
+        void start(FieldDisplaySettings settings = FieldDisplaySettings());
+        /**
+         * @brief Draw a path on the field, in place of the last one
+         *
+         * The path is drawn into the background once, so it can be destroyed afterwards. Does nothing if the display
+         * hasn't started
+         *
+         * @param path the path. Its theta values are ignored
+         */
+        void drawPath(const Path& path);
+        /**
+         * @brief Remove the path from the field
+         */
+        void clearPath();
+        /**
+         * @brief Draw the robot at its current pose now, instead of waiting for the next update
+         */
+        void update();
+    private:
+        /**
+         * @brief A rectangle of pixels on the canvas, inclusive
+         */
+        struct Rect {
+                int16_t x1 = 0;
+                int16_t y1 = 0;
+                int16_t x2 = -1;
+                int16_t y2 = -1;
+        };
+
+        /**
+         * @brief Draw the tiles of the field into the background
+         */
+        void drawField();
+        /**
+         * @brief Copy the whole background to the canvas, draw the robot on it, and redraw the whole canvas
+         */
+        void redrawAll();
+        /**
+         * @brief Draw a line into a buffer, clipped to the canvas
+         */
+        void drawLine(std::vector<lv_color_t>& buffer, int x1, int y1, int x2, int y2, lv_color_t color);
+        /**
+         * @brief Draw the robot marker onto the canvas
+         *
+         * @param pose the pose of the robot, with theta in degrees
+         * @return Rect the pixels the marker covers
+         */
+        Rect drawMarker(Pose pose);
+        /**
+         * @brief Find the pixels of the center and the tip of the robot marker
+         */
+        void markerAt(Pose pose, int& x, int& y, int& tipX, int& tipY) const;
+        /**
+         * @brief Have LVGL redraw part of the canvas the next time flush runs
+         */
+        void invalidate(Rect rect);
+        /**
+         * @brief Have LVGL redraw the part of the canvas that changed. Runs on the LVGL task
+         *
+         * @param display the display
+         */
+        static void flush(void* display);
+        /**
+         * @brief Convert a position on the field to a pixel on the canvas
+         */
+        void toPixel(float x, float y, int& px, int& py) const;
+
+        Chassis& chassis;
+        FieldDisplaySettings settings;
+        /** the field and the path, without the robot */
+        std::vector<lv_color_t> background;
+        /** what is on the screen. LVGL draws the canvas from this */
+        std::vector<lv_color_t> pixels;
+        lv_obj_t* canvas = nullptr;
+        /** the pixels the marker was last drawn on */
+        Rect marker;
+        /** the center and the tip of the last marker, to skip updates that wouldn't change anything */
+        int lastX = INT32_MIN;
+        int lastY = INT32_MIN;
+        int lastTipX = INT32_MIN;
+        int lastTipY = INT32_MIN;
+        /** the pixels that changed since LVGL was last told to redraw them */
+        Rect pending;
+        /** protects the buffers and the pending rectangle from drawPath, update, and flush running at the same time */
+        pros::Mutex mutex;
+        TaskMonitor monitor {"field display"};
+        pros::Task* task = nullptr;
+        /** runs flush on the LVGL task */
+        lv_task_t* flushTask = nullptr;
+        /** set by the destructor, so flush deletes the canvas and itself */
+        std::atomic<bool> stopping = false;
+        /** set by flush once it has deleted the canvas and itself */
+        std::atomic<bool> stopped = false;
+};
+} // namespace lemlib
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pros/rtos.hpp"
+#include "lemlib/pose.hpp"
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/chassis/motionTrace.hpp"
+#include "lemlib/logger/baseSink.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+
+namespace lemlib {
+struct SensorFrame;
+
+/**
+ * @brief Keeps the last few seconds of odometry, motions, and log messages in memory, and writes them to the SD card
+ * when something goes wrong
+ *
+ * Every record is framed like binary telemetry and copied into a ring of bytes, overwriting the oldest records. A
+ * record only reserves its bytes with an atomic add and copies them, so recording never waits and can be done from
+ * any task. Nothing is written to the card until the recorder is dumped, which happens when dump() is called, when
+ * the competition state changes, or when the program terminates after dumpOnTerminate() is called.
+ *
+ * Each dump is a file named name_000.lfr, name_001.lfr, and so on, holding the records from oldest to newest.
+ * firmware/telemetry.py decodes it like the terminal output. The oldest record in the file may have been partly
+ * overwritten, and is skipped by its CRC. Records are dropped while a dump is being written, so the dump isn't
+ * changed under it.
+ *
+ * With the chassis, odometry, and motions recording every 10 ms, a second takes about 12 KB, so the default 64 KB
+ * holds about 5 seconds.
+ *
+ * @note the recorder is meant to live for the rest of the program, like the sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::FlightRecorder recorder;
+ * void initialize() {
+ *     chassis.calibrate();
+ *     chassis.setFlightRecorder(&recorder);
+ *     lemlib::infoSink()->setTap(&recorder);
+ *     recorder.dumpOnTerminate();
+ * }
+ * void opcontrol() {
+ *     while (true) {
+ *         // save what just happened
+ *         if (controller.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_X)) recorder.dump();
+ *         pros::delay(10);
+ *     }
+ * }
+ * @endcode
+ */
+class FlightRecorder : public BaseSink {
+    public:
+        /**
+         * @brief Construct a new Flight Recorder
+         *
+         * @param capacity the size of the ring, in bytes. Rounded up to a power of 2
+         * @param name the start of the file names. Files are named name_000.lfr, name_001.lfr, and so on, starting
+         * after the files already on the card
+         */
+        FlightRecorder(size_t capacity = 1 << 16, const std::string& name = "blackbox");
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+        /**
+         * @brief Record the sensor readings of an odometry update
+         *
+         * @param frame the readings
+         */
+        void recordFrame(const SensorFrame& frame);
+        /**
+         * @brief Record the pose of the robot
+         *
+         * @param pose the pose, with theta in degrees
+         * @param time the time of the pose, in milliseconds
+         */
+        void recordPose(Pose pose, uint32_t time);
+        /**
+         * @brief Record an iteration of a motion
+         *
+         * @param sample the sample
+         */
+        void recordMotion(const MotionSample& sample);
+        /**
+         * @brief Record a record of any type
+         *
+         * @param type the type of the record
+         * @param payload the fields of the record, little endian
+         * @param size the size of the payload, in bytes. At most BinaryTelemetry::MAX_PAYLOAD
+         * @param time the time of the record, in milliseconds
+         */
+        void record(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time);
+        /**
+         * @brief Write the recorder to the SD card on the recorder's task, so the caller doesn't wait for the card
+         */
+        void dump();
+        /**
+         * @brief Write the recorder to the SD card now, on the calling task
+         *
+         * Takes none of the locks of the recorder or the logger, and only records are dropped while it writes, so it
+         * can be called from a fault handler. The C library still allocates the file and its buffer, and the file
+         * system takes its own locks, so it can hang if the fault broke the heap or happened inside the file system.
+         * It waits for the card
+         *
+         * @return true the dump was written
+         * @return false the file couldn't be opened, or another dump is being written
+         */
+        bool dumpNow();
+        /**
+         * @brief Choose whether the recorder is dumped when the competition state changes. It is by default
+         *
+         * @param enabled whether the recorder is dumped
+         */
+        void setDumpOnCompetitionChange(bool enabled);
+        /**
+         * @brief Dump this recorder if the program terminates, from an uncaught exception or std::terminate
+         *
+         * PROS doesn't let programs hook its data abort handler, so call dumpNow() from any other fault handler
+         */
+        void dumpOnTerminate();
+    private:
+        /**
+         * @brief Record a log message
+         *
+         * @param message
+         */
+        void sendMessage(const Message& message) override;
+        /**
+         * @brief Dump when asked, and when the competition state changes
+         */
+        void taskLoop();
+
+        uint8_t* ring;
+        /** the size of the ring minus 1. The size is a power of 2 */
+        size_t mask;
+        /** bytes ever recorded. The next record starts at head modulo the size of the ring */
+        std::atomic<uint32_t> head = 0;
+        /** whether a dump is being written */
+        std::atomic<bool> dumping = false;
+        std::atomic<bool> dumpOnCompetitionChange = true;
+        std::string name;
+        int fileIndex = 0;
+        TaskMonitor monitor {"flight recorder"};
+        pros::Task task;
+};
+} // namespace lemlib
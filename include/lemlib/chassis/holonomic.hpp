@@ -0,0 +1,73 @@
+#pragma once
+
+#include "pros/motors.hpp"
+
+namespace lemlib {
+/**
+ * @brief The power of each wheel of a holonomic drivetrain, from -127 to 127
+ */
+struct WheelPowers {
+        float frontLeft = 0;
+        float frontRight = 0;
+        float backLeft = 0;
+        float backRight = 0;
+};
+
+/**
+ * @brief A holonomic drivetrain, like an X-drive or a mecanum drive, which can strafe as well as drive and turn
+ *
+ * The wheels are driven in 4 groups, one at each corner. Motors are reversed in their groups so positive power pushes
+ * every wheel forwards. Then forwards power drives all 4 wheels forwards, strafing right drives the front left and
+ * back right wheels forwards and the others backwards, and turning clockwise drives the left wheels forwards and the
+ * right wheels backwards, the same way for X-drives and mecanum drives
+ *
+ * The chassis still drives the left and right motor groups of the Drivetrain for the motions that don't strafe, so
+ * they should hold the same motors as the front and back groups of their side
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Motor frontLeft(1), frontRight(-2), backLeft(3), backRight(-4);
+ * pros::MotorGroup frontLeftMotors({frontLeft}), frontRightMotors({frontRight}), backLeftMotors({backLeft}),
+ *     backRightMotors({backRight});
+ * pros::MotorGroup leftMotors({frontLeft, backLeft}), rightMotors({frontRight, backRight});
+ * lemlib::HolonomicDrivetrain xdrive(&frontLeftMotors, &frontRightMotors, &backLeftMotors, &backRightMotors);
+ * lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 400, 2, nullptr, &xdrive);
+ * @endcode
+ */
+class HolonomicDrivetrain {
+    public:
+        /**
+         * @brief Construct a new Holonomic Drivetrain
+         *
+         * @param frontLeft the motors of the front left wheel
+         * @param frontRight the motors of the front right wheel
+         * @param backLeft the motors of the back left wheel
+         * @param backRight the motors of the back right wheel
+         */
+        HolonomicDrivetrain(pros::MotorGroup* frontLeft, pros::MotorGroup* frontRight, pros::MotorGroup* backLeft,
+                            pros::MotorGroup* backRight);
+        /**
+         * @brief Work out the power of each wheel that moves the robot with a velocity
+         *
+         * If a wheel would need more than maxPower, every wheel is scaled down by the same amount in the same pass, so
+         * the robot still moves in the same direction and turns at the same rate relative to how fast it moves
+         *
+         * @param forward the forwards power, from -127 to 127
+         * @param strafe the power to the right, from -127 to 127
+         * @param turn the turning power, clockwise positive, from -127 to 127
+         * @param maxPower the most power any wheel is given. 127 by default
+         * @return WheelPowers the power of each wheel
+         */
+        static WheelPowers inverseKinematics(float forward, float strafe, float turn, float maxPower = 127);
+        /**
+         * @brief Send the power of each wheel to its motors, as a voltage
+         *
+         * @param powers the power of each wheel, from -127 to 127
+         */
+        void move(const WheelPowers& powers);
+        pros::MotorGroup* frontLeft;
+        pros::MotorGroup* frontRight;
+        pros::MotorGroup* backLeft;
+        pros::MotorGroup* backRight;
+};
+} // namespace lemlib
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "pros/imu.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/staticVector.hpp"
+
+namespace lemlib {
+/**
+ * @brief Several inertial sensors that calibrate at the same time and are read as 1
+ *
+ * An ImuGroup is a pros::Imu, so it is passed to OdomSensors like a single IMU, and Chassis::calibrate calibrates
+ * every IMU in it at once instead of one after another. Each read, the change in rotation of each IMU is measured,
+ * and the changes are averaged by weight. A change that disagrees with the others by more than maxDisagreement is
+ * rejected, so a glitch in 1 IMU doesn't move the heading. An IMU that can't be read, because it failed to calibrate
+ * or was unplugged, is left out until it can be read again, and the rest carry on without a jump in the heading
+ *
+ * Rotation, heading, and gyro rate are fused. The other readings, like pitch and acceleration, come from the first
+ * IMU that can be read
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Imu imu1(10);
+ * pros::Imu imu2(11);
+ * lemlib::ImuGroup imus({&imu1, &imu2});
+ * lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imus);
+ * @endcode
+ */
+class ImuGroup : public pros::Imu {
+    public:
+        /**
+         * @brief Construct a new IMU Group
+         *
+         * @param imus the IMUs. Must outlive the group. Only the first MAX_IMUS are used
+         * @param weights how much each IMU counts in the average, in the same order as imus. Equal by default. A
+         * quieter IMU should get more weight, like 1 divided by the variance of its noise
+         * @param maxDisagreement the most the change in rotation of an IMU can differ from the others in 1 read before
+         * it is rejected, in degrees. 1 by default
+         */
+        ImuGroup(std::vector<pros::Imu*> imus, std::vector<float> weights = {}, float maxDisagreement = 1);
+        ImuGroup(const ImuGroup&) = delete;
+        ImuGroup& operator=(const ImuGroup&) = delete;
+        /**
+         * @brief Calibrate every IMU at the same time
+         *
+         * @param blocking whether to wait until all of them have finished calibrating
+         * @return 1 if at least 1 IMU started calibrating, PROS_ERR otherwise
+         */
+        std::int32_t reset(bool blocking = false) const override;
+        std::int32_t set_data_rate(std::uint32_t rate) const override;
+        /**
+         * @brief Get the fused rotation, in degrees
+         *
+         * @return double the rotation, or PROS_ERR_F if no IMU could be read
+         */
+        double get_rotation() const override;
+        /**
+         * @brief Get the fused heading, from 0 to 360 degrees
+         *
+         * @return double the heading, or PROS_ERR_F if no IMU could be read
+         */
+        double get_heading() const override;
+        /**
+         * @brief Get the weighted average of the gyro rates of the IMUs that can be read
+         *
+         * @return pros::c::imu_gyro_s_t the rates, in degrees per second, or PROS_ERR_F on every axis if no IMU could
+         * be read
+         */
+        pros::c::imu_gyro_s_t get_gyro_rate() const override;
+        std::int32_t tare_rotation() const override;
+        std::int32_t tare_heading() const override;
+        std::int32_t set_rotation(const double target) const override;
+        std::int32_t set_heading(const double target) const override;
+        /**
+         * @brief Get the status of the group
+         *
+         * @return pros::c::imu_status_e_t CALIBRATING if any IMU is calibrating, ERROR if none can be read, READY
+         * otherwise
+         */
+        pros::c::imu_status_e_t get_status() const override;
+        bool is_calibrating() const override;
+        double get_pitch() const override;
+        double get_roll() const override;
+        double get_yaw() const override;
+        pros::c::euler_s_t get_euler() const override;
+        pros::c::quaternion_s_t get_quaternion() const override;
+        pros::c::imu_accel_s_t get_accel() const override;
+        /**
+         * @brief Get the number of IMUs the last rotation read was fused from
+         *
+         * @return size_t the number of IMUs that could be read and agreed with the others
+         */
+        size_t getActiveCount() const;
+        /** the most IMUs a group can hold. The readings are kept inline, so reading the group doesn't allocate */
+        static constexpr size_t MAX_IMUS = 8;
+    private:
+        /**
+         * @brief An IMU in the group, and the state used to measure its change in rotation
+         */
+        struct Member {
+                pros::Imu* imu;
+                float weight;
+                /** the rotation of the last read, NAN if it couldn't be read */
+                double lastReading;
+                /** whether the change in rotation of the last read was used */
+                bool active;
+                /** whether the IMU could be read last time. A warning is logged when it stops */
+                bool readable;
+        };
+
+        /**
+         * @brief Get the first IMU that can be read, or the first IMU if none can
+         *
+         * @note mutex must be held by the caller
+         */
+        pros::Imu* primary() const;
+        /**
+         * @brief Forget the last reading of each IMU, so the next read measures changes from there, and the failure of
+         * each is logged again
+         *
+         * @note mutex must be held by the caller
+         */
+        void rebase() const;
+
+        mutable StaticVector<Member, MAX_IMUS> members;
+        float maxDisagreement;
+        /** the fused rotation, in degrees */
+        mutable double rotation = 0;
+        /** added to the rotation to get the heading, in degrees */
+        mutable double headingOffset = 0;
+        /** the fused change in rotation of the last read, which a new change is expected to be close to */
+        mutable double lastDelta = 0;
+        mutable pros::Mutex mutex;
+};
+} // namespace lemlib
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace lemlib {
+class MotionHandle;
+
+/**
+ * @brief Why a motion ended
+ */
+enum class MotionEndReason : uint8_t {
+    NOT_DONE, /** the motion is queued or running */
+    SETTLED, /** the exit conditions of the motion were met */
+    TIMEOUT, /** the motion ran out of time */
+    CANCELLED, /** the motion was cancelled, or was skipped by cancelAllMotions */
+    EARLY_EXIT, /** the motion exited early for motion chaining, or the competition state changed */
+    UNKNOWN, /** the motion ended so long ago that its record was reused */
+    STALLED, /** the robot was pushing against something it couldn't move, like a wall */
+    COLLIDED, /** the robot was hit, and collision detection is set to abort motions */
+    CONDITION_MET /** an exit condition added with MotionHandle::exitWhen() became true */
+};
+
+/**
+ * @brief What makes a motion callback run
+ */
+enum class MotionTrigger : uint8_t {
+    PROGRESS, /** the motion has traveled a distance */
+    PATH_INDEX, /** the robot has reached a point on the path. Only follow reaches path points */
+    TIME, /** the motion has run for a time */
+    END, /** the motion has ended */
+    COLLISION, /** the robot was hit while the motion was running. Only chassis motions detect collisions */
+    CONDITION /** an exit condition is true. The motion ends instead of running a callback */
+};
+
+/**
+ * @brief A callback that runs when a motion reaches a trigger
+ */
+struct MotionCallback {
+        /** the slot is free */
+        static constexpr uint8_t EMPTY = 0;
+        /** the callback is being registered */
+        static constexpr uint8_t WRITING = 1;
+        /** the callback is waiting for its threshold */
+        static constexpr uint8_t READY = 2;
+        /** the callback has run */
+        static constexpr uint8_t FIRED = 3;
+
+        /** the state of the slot */
+        std::atomic<uint8_t> state = EMPTY;
+        /** what makes the callback run */
+        MotionTrigger trigger = MotionTrigger::END;
+        /** whether the callback runs on the callback task instead of the motion task */
+        bool deferred = false;
+        /** the distance, path index, or time in milliseconds at which the callback runs */
+        float threshold = 0;
+        /** the function to call */
+        void (*callback)(void*) = nullptr;
+        /** the exit condition of a CONDITION trigger */
+        bool (*condition)(void*) = nullptr;
+        /** the argument passed to the function */
+        void* arg = nullptr;
+};
+
+/**
+ * @brief The progress and result of a motion, shared between the motion task and handles to the motion
+ */
+struct MotionRecord {
+        /** the id of the motion using this record */
+        std::atomic<uint32_t> id = 0;
+        /** distance traveled by the motion. Inches or degrees, depending on the motion */
+        std::atomic<float> progress = 0;
+        /** time the motion started, in milliseconds. 0 if it hasn't started */
+        std::atomic<uint32_t> startTime = 0;
+        /** why the motion ended */
+        std::atomic<MotionEndReason> reason = MotionEndReason::NOT_DONE;
+        /** callbacks registered on the motion. Storage is fixed, so registering never allocates */
+        std::array<MotionCallback, 4> callbacks;
+};
+
+/**
+ * @brief Check the exit conditions of a motion. Called by the motion loop every iteration
+ *
+ * @param record the record of the motion
+ * @return true an exit condition is true, so the motion ends
+ */
+bool exitConditionMet(MotionRecord& record);
+
+/**
+ * @brief Something that runs motions and keeps their records, like a chassis or a mechanism
+ */
+class MotionExecutor {
+    protected:
+        ~MotionExecutor() = default;
+        /**
+         * @brief Get the record of a motion
+         *
+         * @param id the id of the motion
+         * @return MotionRecord* the record, or nullptr if it was reused by a newer motion
+         */
+        virtual MotionRecord* getMotionRecord(uint32_t id) = 0;
+        /**
+         * @brief Block the calling task until a motion ends or travels a distance
+         *
+         * @param id the id of the motion
+         * @param dist the distance. INFINITY to wait until the motion ends
+         */
+        virtual void waitForMotion(uint32_t id, float dist) = 0;
+
+        friend class MotionHandle;
+};
+
+/**
+ * @brief A lightweight handle to a queued or running motion
+ *
+ * Every motion returns a handle. Handles are 2 words and can be copied freely. Each motion has its own record, so
+ * a handle keeps working after the next motion starts
+ *
+ * @b Example
+ * @code {.cpp}
+ * // start a motion, and run the intake when it has traveled 20 inches
+ * lemlib::MotionHandle motion = chassis.moveToPoint(0, 48, 4000);
+ * motion.onProgress(20, [](void*) { intake.move(127); });
+ * // wait for the motion to end, and check why it ended
+ * motion.wait();
+ * if (motion.endReason() == lemlib::MotionEndReason::TIMEOUT) std::cout << "timed out" << std::endl;
+ * @endcode
+ */
+class MotionHandle {
+    public:
+        /**
+         * @brief Construct a new Motion Handle
+         *
+         * @param executor the chassis or mechanism running the motion. A handle without one is always done
+         * @param id the id of the motion
+         */
+        MotionHandle(MotionExecutor* executor = nullptr, uint32_t id = 0);
+        /**
+         * @brief Get how far the motion has traveled
+         *
+         * @return float the distance, in inches for moveToPoint, moveToPose, and follow, degrees for everything else.
+         * 0 if the motion hasn't started. NAN if the record of the motion was reused
+         */
+        float progress() const;
+        /**
+         * @brief Whether the motion has ended
+         *
+         * @return true the motion has ended, or was cancelled before it started
+         * @return false the motion is queued or running
+         */
+        bool isDone() const;
+        /**
+         * @brief Why the motion ended
+         *
+         * @return MotionEndReason the reason. NOT_DONE if the motion hasn't ended
+         */
+        MotionEndReason endReason() const;
+        /**
+         * @brief Block the calling task until the motion ends
+         */
+        void wait() const;
+        /**
+         * @brief Block the calling task until the motion has traveled a distance, or has ended
+         *
+         * @param progress the distance, in inches for moveToPoint, moveToPose, and follow, degrees for everything else
+         */
+        void waitUntil(float progress) const;
+        /**
+         * @brief Run a callback when the motion has traveled a distance
+         *
+         * The motion loop checks the trigger every iteration, so the callback runs on the same tick the distance is
+         * reached. Callbacks run on the motion task, so they must be short and must not block, unless deferred
+         *
+         * @param threshold the distance, in inches for moveToPoint, moveToPose, and follow, degrees for everything
+         * else
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task, so it can block. false by default
+         * @return true the callback was registered
+         * @return false the motion has ended, or every callback slot is taken
+         */
+        bool onProgress(float threshold, void (*callback)(void*), void* arg = nullptr, bool deferred = false) const;
+        /**
+         * @brief Run a callback when the robot reaches a point on the path. Only used by follow
+         *
+         * @param index the index of the point on the path
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task, so it can block. false by default
+         * @return true the callback was registered
+         * @return false the motion has ended, or every callback slot is taken
+         *
+         * @b Example
+         * @code {.cpp}
+         * // start the intake at the 30th point of the path
+         * chassis.follow(path_txt, 15, 4000).onPathIndex(30, [](void*) { intake.move(127); });
+         * @endcode
+         */
+        bool onPathIndex(size_t index, void (*callback)(void*), void* arg = nullptr, bool deferred = false) const;
+        /**
+         * @brief Run a callback when the motion has run for a time
+         *
+         * @param time the time since the motion started, in milliseconds
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task, so it can block. false by default
+         * @return true the callback was registered
+         * @return false the motion has ended, or every callback slot is taken
+         */
+        bool onTime(uint32_t time, void (*callback)(void*), void* arg = nullptr, bool deferred = false) const;
+        /**
+         * @brief Run a callback when the motion ends
+         *
+         * If the motion ends while the callback is being registered, the callback runs on the calling task before
+         * this returns
+         *
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task, so it can block. false by default
+         * @return true the callback was registered, or has already run
+         * @return false the motion had ended, or every callback slot is taken
+         */
+        bool onDone(void (*callback)(void*), void* arg = nullptr, bool deferred = false) const;
+        /**
+         * @brief Run a callback when the robot is hit while the motion is running
+         *
+         * Collisions are only detected once Chassis::setCollisionDetection() is called. The callback runs on the
+         * first iteration of the motion after the hit, so it can cancel the motion, queue a new route, or relocalize
+         * the robot before it has driven much further off the path
+         *
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task, so it can block. false by default
+         * @return true the callback was registered
+         * @return false the motion has ended, or every callback slot is taken
+         *
+         * @b Example
+         * @code {.cpp}
+         * // give up on the path when the robot is hit, and drive to a safe spot
+         * chassis.follow(path_txt, 15, 4000).onCollision([](void*) {
+         *     chassis.moveToPoint(0, 0, 2000, {.priority = lemlib::MotionPriority::URGENT});
+         * }, nullptr, true);
+         * @endcode
+         */
+        bool onCollision(void (*callback)(void*), void* arg = nullptr, bool deferred = false) const;
+        /**
+         * @brief End the motion as soon as a condition becomes true
+         *
+         * The motion loop checks the condition every iteration, right after it wakes for the next reading of the
+         * sensors, so the motion ends on the same iteration the condition becomes true, and the robot stops there.
+         * The motion ends with MotionEndReason::CONDITION_MET. The condition runs on the motion task, so it must be
+         * short and must not block. It takes a callback slot
+         *
+         * @param condition returns true when the motion should end
+         * @param arg the argument passed to the condition
+         * @return true the condition was added
+         * @return false the motion has ended, or every callback slot is taken
+         *
+         * @b Example
+         * @code {.cpp}
+         * // drive forwards until the distance sensor is 4 inches from the goal
+         * chassis.moveToPoint(0, 48, 4000).exitWhen([](void*) { return distanceSensor.get() < 4 * 25.4; });
+         * @endcode
+         */
+        bool exitWhen(bool (*condition)(void*), void* arg = nullptr) const;
+        /**
+         * @brief Get the id of the motion
+         *
+         * @return uint32_t the id. Motions are numbered in the order they are queued, starting at 1
+         */
+        uint32_t getId() const;
+    private:
+        /**
+         * @brief Get the record of the motion
+         *
+         * @return MotionRecord* the record, or nullptr if it was reused
+         */
+        MotionRecord* record() const;
+        /**
+         * @brief Register a callback on the motion
+         *
+         * @param trigger what makes the callback run
+         * @param threshold the distance, path index, or time at which the callback runs
+         * @param callback the function to call
+         * @param arg the argument passed to the function
+         * @param deferred whether the callback runs on the callback task
+         * @param condition the exit condition, for a CONDITION trigger. nullptr by default
+         * @return true the callback was registered
+         * @return false the motion has ended, or every callback slot is taken
+         */
+        bool addCallback(MotionTrigger trigger, float threshold, void (*callback)(void*), void* arg, bool deferred,
+                         bool (*condition)(void*) = nullptr) const;
+
+        MotionExecutor* executor;
+        uint32_t id;
+};
+} // namespace lemlib
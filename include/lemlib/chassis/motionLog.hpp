@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pros/rtos.hpp"
+#include "lemlib/boundedQueue.hpp"
+#include "lemlib/chassis/motionHandle.hpp"
+
+namespace lemlib {
+enum class MotionType;
+
+/**
+ * @brief How a motion went, recorded once when it ends
+ *
+ * Fields a motion doesn't have are NAN. Turns have no lateral error, and paths have no target heading
+ */
+struct MotionSummary {
+        /** size of a packed summary, in bytes */
+        static constexpr size_t PACKED_SIZE = 2 + 2 + 4 + 6 * 4;
+
+        /** the time the motion started, in milliseconds */
+        uint32_t startTime = 0;
+        /** how long the motion ran, in milliseconds */
+        uint32_t duration = 0;
+        /** the type of the motion */
+        MotionType type {};
+        /** why the motion ended */
+        MotionEndReason reason = MotionEndReason::NOT_DONE;
+        /** the tag of the log, like the version of the code or the tuning */
+        uint16_t tag = 0;
+        /** the target of the motion, in inches and degrees. The end of the path when following one */
+        float targetX = NAN;
+        float targetY = NAN;
+        float targetTheta = NAN;
+        /** how far the robot ended from the target, in inches */
+        float lateralError = NAN;
+        /** how far the heading of the robot ended from the target heading, in degrees */
+        float angularError = NAN;
+        /** the fastest the robot drove forwards or backwards during the motion, in inches per second */
+        float maxSpeed = 0;
+
+        /**
+         * @brief Write the summary in the layout of a TelemetryType::MOTION_SUMMARY record, little endian
+         *
+         * @param out where the summary is written. Must hold PACKED_SIZE bytes
+         */
+        void pack(uint8_t* out) const;
+};
+
+/**
+ * @brief Appends a summary of every motion to a file on the SD card, so how motions settle can be compared over
+ * weeks of practice
+ *
+ * Each summary is a TelemetryType::MOTION_SUMMARY frame, with the time the motion started. The payload is the
+ * MotionType and the MotionEndReason as uint8, the tag as uint16, and the duration in milliseconds as uint32, then
+ * the x, y, and heading of the target, the lateral and angular errors, and the max speed, as float32. Summaries are
+ * appended to the same file every run, and firmware/telemetry.py decodes it like the terminal output. Runs can be
+ * told apart by the start time going back to 0, and code or tuning changes by the tag.
+ *
+ * Ending a motion only pushes its summary to a lock-free queue. A low priority task opens the file, appends the
+ * summaries, and closes it again, so nothing is lost if the robot is turned off.
+ *
+ * @note the log is meant to live for the rest of the program, like the sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // tagged with the version of the tuning, so the summaries before and after a change can be compared
+ * lemlib::MotionLog motionLog("/usd/motions.lms", 12);
+ * void initialize() {
+ *     chassis.calibrate();
+ *     chassis.setMotionLog(&motionLog);
+ * }
+ * @endcode
+ */
+class MotionLog {
+    public:
+        /**
+         * @brief Construct a new Motion Log
+         *
+         * @param path the file the summaries are appended to
+         * @param tag stored in every summary, like the version of the code or the tuning
+         * @param capacity the number of summaries that can wait to be written
+         */
+        MotionLog(const std::string& path = "/usd/motions.lms", uint16_t tag = 0, size_t capacity = 16);
+        MotionLog(const MotionLog&) = delete;
+        MotionLog& operator=(const MotionLog&) = delete;
+        /**
+         * @brief Queue a summary to be written, with the tag of the log. Never waits
+         *
+         * @param summary the summary
+         */
+        void record(MotionSummary summary);
+        /**
+         * @brief Set the tag stored in the summaries recorded from now on
+         *
+         * @param tag the tag
+         */
+        void setTag(uint16_t tag);
+        /**
+         * @brief Get the number of summaries dropped because the queue was full, or the file couldn't be written
+         *
+         * @return uint32_t the number of summaries
+         */
+        uint32_t getDropped() const;
+    private:
+        /**
+         * @brief Append the summaries in the queue to the file
+         */
+        void taskLoop();
+
+        std::string path;
+        std::atomic<uint16_t> tag;
+        BoundedQueue<MotionSummary> queue;
+        std::atomic<uint32_t> dropped = 0;
+        pros::Task task;
+};
+} // namespace lemlib
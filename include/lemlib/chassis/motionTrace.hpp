@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "pros/rtos.hpp"
+#include "lemlib/boundedQueue.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/logger/sdWriter.hpp"
+
+namespace lemlib {
+enum class MotionType;
+
+/**
+ * @brief A limit that changed the output of a motion. Each is a bit of MotionSample::clamps
+ */
+enum class TraceClamp : uint8_t {
+    MAX_SPEED = 1, /** an output was limited to the max speed of the motion */
+    SLEW = 2, /** an output was limited by the slew rate */
+    SLIP = 4, /** the lateral output was limited so the robot doesn't slip sideways */
+    OVERTURN = 8, /** the lateral output was reduced so the angular output fits in the max speed */
+    DIRECTION = 16, /** the lateral output was stopped from driving the wrong way */
+    MIN_SPEED = 32, /** an output was raised to the min speed of the motion */
+    RATIO = 64 /** the power of both sides was scaled down to fit in the max speed */
+};
+
+/**
+ * @brief The internals of one iteration of a motion
+ *
+ * Fields a motion doesn't have are left at their defaults
+ */
+struct MotionSample {
+        /** size of a packed sample, in bytes */
+        static constexpr size_t PACKED_SIZE = 2 + 14 * 4;
+
+        /** the time of the iteration, in milliseconds */
+        uint32_t time = 0;
+        /** the motion that ran the iteration */
+        MotionType type {};
+        /** the TraceClamp bits of the limits that changed the output */
+        uint8_t clamps = 0;
+        /** error of the lateral controller, in inches */
+        float lateralError = 0;
+        /** error of the angular controller, in degrees */
+        float angularError = 0;
+        /** terms of the lateral PID */
+        PID::Terms lateral;
+        /** terms of the angular PID */
+        PID::Terms angular;
+        /** the point the motion is driving to: the carrot point, the lookahead point, or the target */
+        float targetX = NAN;
+        float targetY = NAN;
+        /** curvature of the arc to the target, in 1 / inches */
+        float curvature = 0;
+        /** the fastest the robot can drive around the arc without slipping. INFINITY if there is no limit */
+        float slipLimit = INFINITY;
+        /** power sent to each side of the drivetrain */
+        float left = 0;
+        float right = 0;
+
+        /**
+         * @brief Record a limit, if it changed a value
+         *
+         * @param clamp the limit
+         * @param before the value before the limit
+         * @param after the value after the limit
+         * @return float the value after the limit
+         */
+        float limit(TraceClamp clamp, float before, float after) {
+            if (before != after) clamps |= uint8_t(clamp);
+            return after;
+        }
+
+        /**
+         * @brief Write the sample as the payload of a TelemetryType::MOTION record, leaving out the time
+         *
+         * @param out where the sample is written. Must hold PACKED_SIZE bytes
+         */
+        void pack(uint8_t* out) const;
+};
+
+/**
+ * @brief Where a motion trace sends its samples
+ */
+enum class TraceOutput {
+    TELEMETRY, /** binary telemetry frames through bufferedStdout */
+    SD /** the same frames, in files on the SD card */
+};
+
+/**
+ * @brief Records the internals of every iteration of every motion, for finding out why a motion went wrong
+ *
+ * While the trace is set on the chassis, each iteration of a motion fills a MotionSample and pushes it to a lock-free
+ * queue, which takes tens of nanoseconds and never waits. A low priority task drains the queue to binary telemetry
+ * or the SD card. If the queue is full, samples are dropped and counted by getDropped().
+ *
+ * Each sample is a TelemetryType::MOTION frame, with the time of the iteration. The payload is the MotionType and
+ * the clamps as uint8, then the lateral and angular errors, the P, I, and D terms of the lateral PID, the same of
+ * the angular PID, the x and y of the target, the curvature, the slip limit, and the left and right power, as
+ * float32. Files on the SD card are named name_000.lmt, name_001.lmt, and so on, and hold nothing but frames, so
+ * firmware/telemetry.py decodes them like the terminal output
+ *
+ * @note the trace is meant to live for the rest of the program, like the sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::MotionTrace trace(lemlib::TraceOutput::SD);
+ * void autonomous() {
+ *     chassis.setMotionTrace(&trace);
+ *     chassis.moveToPose(24, 24, 90, 4000);
+ * }
+ * @endcode
+ */
+class MotionTrace {
+    public:
+        /**
+         * @brief Construct a new Motion Trace
+         *
+         * @param output where the samples are sent
+         * @param capacity the number of samples that can wait to be sent. 128 holds over a second of samples
+         * @param name the start of the file names, if the samples are sent to the SD card
+         */
+        MotionTrace(TraceOutput output, size_t capacity = 128, const std::string& name = "motion");
+        MotionTrace(const MotionTrace&) = delete;
+        MotionTrace& operator=(const MotionTrace&) = delete;
+        /**
+         * @brief Queue a sample to be sent. Never waits
+         *
+         * @param sample the sample
+         */
+        void record(const MotionSample& sample);
+        /**
+         * @brief Get the number of samples dropped because the queue was full, or the SD card fell behind
+         *
+         * @return uint32_t the number of samples
+         */
+        uint32_t getDropped() const;
+    private:
+        /**
+         * @brief Send the samples in the queue
+         */
+        void taskLoop();
+
+        TraceOutput output;
+        BoundedQueue<MotionSample> queue;
+        std::atomic<uint32_t> dropped = 0;
+        /** only created if the samples are sent to the SD card */
+        SdWriter* writer = nullptr;
+        TaskMonitor monitor {"motion trace"};
+        pros::Task task;
+};
+} // namespace lemlib
@@ -1,60 +1,1159 @@
 #pragma once
 
-#include "lemlib/chassis/chassis.hpp"
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include "pros/gps.hpp"
+#include "pros/imu.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/chassis/ekf.hpp"
+#include "lemlib/loopProfiler.hpp"
 #include "lemlib/pose.hpp"
+#include "lemlib/ringBuffer.hpp"
+#include "lemlib/taskMonitor.hpp"
 
 namespace lemlib {
+class Drivetrain;
+class ParticleFilter;
+class SensorLog;
+class FlightRecorder;
+class Scheduler;
+class SensorLogReader;
+
 /**
- * @brief Set the sensors to be used for odometry
+ * @brief class containing the sensors used for odometry
+ */
+class OdomSensors {
+    public:
+        /**
+         * The sensors are stored in a class so that they can be easily passed to the chassis class
+         * The variables are pointers so that they can be set to nullptr if they are not used
+         * Otherwise the chassis class would have to have a constructor for each possible combination of sensors
+         *
+         * @param vertical1 pointer to the first vertical tracking wheel
+         * @param vertical2 pointer to the second vertical tracking wheel
+         * @param horizontal1 pointer to the first horizontal tracking wheel
+         * @param horizontal2 pointer to the second horizontal tracking wheel
+         * @param imu pointer to the IMU. An ImuGroup fuses more than 1
+         * @param gps pointer to a GPS sensor, which bounds the drift of the position. nullptr by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * pros::Rotation vertical_rotation(1); // rotation sensor on port 1
+         * pros::Imu imu(2); // IMU on port 2
+         * // tracking wheel using a new 2.75" wheel, 0.5 inches to the right of the tracking center
+         * lemlib::TrackingWheel vertical1(&vertical_rotation, lemlib::Omniwheel::NEW_275, 0.5);
+         * lemlib::OdomSensors sensors(&vertical1, // vertical tracking wheel
+         *                     nullptr, // no second vertical tracking wheel, set to nullptr
+         *                     nullptr, // no horizontal tracking wheels, set to nullptr
+         *                     nullptr, // no second horizontal tracking wheel, set to nullptr
+         *                     &imu); // IMU
+         * @endcode
+         */
+        OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
+                    TrackingWheel* horizontal2, pros::Imu* imu, pros::Gps* gps = nullptr);
+        TrackingWheel* vertical1;
+        TrackingWheel* vertical2;
+        TrackingWheel* horizontal1;
+        TrackingWheel* horizontal2;
+        pros::Imu* imu;
+        pros::Gps* gps;
+};
+
+/**
+ * @brief Timing statistics of the odometry tracking loop
+ */
+struct OdomTiming {
+        /** target time between updates, in milliseconds */
+        uint32_t period;
+        /** number of updates since the program started */
+        uint32_t updates;
+        /** measured time between the last 2 updates, in microseconds */
+        uint32_t lastDt;
+        /** largest difference between the measured time between updates and the period, in microseconds */
+        uint32_t maxJitter;
+        /** number of updates that took so long the next update started late */
+        uint32_t overruns;
+        /** number of updates the watchdog caught starting long after the previous one */
+        uint32_t stalls = 0;
+        /** longest time between updates the watchdog caught, in microseconds */
+        uint32_t longestStall = 0;
+};
+
+/**
+ * @brief Settings of the odometry watchdog
  *
- * @param sensors the sensors to be used
- * @param drivetrain drivetrain to be used
+ * An update that starts long after the previous one, because the tracking task was held off by a higher priority
+ * task, a mutex, or a slow sensor read, would integrate the whole gap along a single heading. The watchdog catches
+ * these stalls, integrates the gap in steps of about one period as if the robot moved evenly through it, counts
+ * them, and warns through the logger
  */
-void setSensors(lemlib::OdomSensors sensors, lemlib::Drivetrain drivetrain);
+struct OdomWatchdogSettings {
+        /** whether the watchdog is running */
+        bool enabled = true;
+        /** how many update periods the time between updates has to exceed to be a stall */
+        float stallPeriods = 3;
+        /** the most steps a stall is integrated in */
+        uint32_t maxSteps = 20;
+};
+
 /**
- * @brief Get the pose of the robot
+ * @brief Settings of the idle rate of odometry
  *
- * @param radians true for theta in radians, false for degrees. False by default
- * @return Pose
+ * While the robot is disabled and sitting still, nothing needs a fresh pose every period, so odometry drops to a low
+ * rate to leave the CPU and the smart port bus to other work, like preparing paths. It goes back to the full rate as
+ * soon as a motion is queued, the robot is enabled, or the robot moves
  */
-Pose getPose(bool radians = false);
+struct OdomIdleSettings {
+        /** whether odometry can go idle */
+        bool enabled = true;
+        /** time between updates while idle, in milliseconds */
+        uint32_t period = 50;
+        /** how long the robot has to sit still before odometry goes idle, in milliseconds */
+        uint32_t delay = 500;
+        /** the robot is still while it drives slower than this, in inches per second */
+        float maxSpeed = 0.5;
+        /** and turns slower than this, in radians per second */
+        float maxTurnRate = 0.05;
+        /** whether odometry only goes idle while the robot is disabled. If false, it also goes idle while enabled */
+        bool onlyWhenDisabled = true;
+};
+
 /**
- * @brief Set the Pose of the robot
+ * @brief A consistent snapshot of the odometry state
  *
- * @param pose the new pose
- * @param radians true if theta is in radians, false if in degrees. False by default
+ * All of the fields were written by the same odometry update
  */
-void setPose(Pose pose, bool radians = false);
+struct OdomState {
+        /** pose of the robot, theta in radians */
+        Pose pose;
+        /** global speed of the robot, theta in radians per second */
+        Pose speed;
+        /** local speed of the robot, theta in radians per second */
+        Pose localSpeed;
+        /** time of the update, in microseconds since the program started */
+        uint64_t time;
+        /** number of times the pose has jumped, when it was set or a correction moved it at once. A motion that sees
+         * this change knows the pose moved without the robot moving */
+        uint32_t jumps = 0;
+        /** number of times the state has been published, by an update or by setting the pose. It only goes up, so a
+         * consumer that remembers it can tell whether the state changed since it last read it */
+        uint32_t sequence = 0;
+};
+
 /**
- * @brief Get the speed of the robot
+ * @brief The readings of every odometry sensor, sampled once at the start of an update
  *
- * @param radians true for theta in radians, false for degrees. False by default
- * @return lemlib::Pose
+ * Sensors that aren't configured read 0
  */
-Pose getSpeed(bool radians = false);
+struct SensorFrame {
+        /** distance traveled by the first vertical tracking wheel, in inches */
+        float vertical1;
+        /** distance traveled by the second vertical tracking wheel, in inches */
+        float vertical2;
+        /** distance traveled by the first horizontal tracking wheel, in inches */
+        float horizontal1;
+        /** distance traveled by the second horizontal tracking wheel, in inches */
+        float horizontal2;
+        /** rotation of the inertial sensor, in radians */
+        float imu;
+        /**
+         * time the sensors were sampled, in microseconds since the program started. Every reading is aligned to
+         * this time before it is integrated
+         */
+        uint64_t time;
+        /** velocity of the first vertical tracking wheel, in inches per second. NAN if it isn't measured */
+        float vertical1Velocity = NAN;
+        /** velocity of the second vertical tracking wheel, in inches per second. NAN if it isn't measured */
+        float vertical2Velocity = NAN;
+        /** velocity of the first horizontal tracking wheel, in inches per second. NAN if it isn't measured */
+        float horizontal1Velocity = NAN;
+        /** velocity of the second horizontal tracking wheel, in inches per second. NAN if it isn't measured */
+        float horizontal2Velocity = NAN;
+        /** angular velocity measured by the inertial sensor, in radians per second. NAN if it isn't measured */
+        float imuVelocity = NAN;
+        /** time the first vertical tracking wheel was read, in microseconds. 0 if it was read at time */
+        uint64_t vertical1Time = 0;
+        /** time the second vertical tracking wheel was read, in microseconds. 0 if it was read at time */
+        uint64_t vertical2Time = 0;
+        /** time the first horizontal tracking wheel was read, in microseconds. 0 if it was read at time */
+        uint64_t horizontal1Time = 0;
+        /** time the second horizontal tracking wheel was read, in microseconds. 0 if it was read at time */
+        uint64_t horizontal2Time = 0;
+        /** time the inertial sensor was read, in microseconds. 0 if it was read at time */
+        uint64_t imuTime = 0;
+};
+
+/** the most sensors that can be added to an odometry with Odometry::addSensor() */
+constexpr size_t MAX_SHARED_SENSORS = 8;
+
+/**
+ * @brief A reading of a sensor sampled by the tracking task
+ */
+struct SensorReading {
+        /** the reading */
+        float value = 0;
+        /** time of the reading, in microseconds since the program started. 0 if it hasn't been read yet */
+        uint64_t time = 0;
+};
+
+/**
+ * @brief A pose of the robot, and when it was measured
+ */
+struct PoseSample {
+        /** pose of the robot, theta in radians */
+        Pose pose = Pose(0, 0, 0);
+        /** time of the update, in microseconds since the program started */
+        uint64_t time = 0;
+};
+
+/**
+ * @brief How the change in pose is calculated from the change in sensor readings
+ */
+enum class OdomIntegrator {
+    /**
+     * the robot is assumed to move along an arc. If the heading doesn't change, it is assumed to move in a straight
+     * line instead, to prevent dividing by 0
+     */
+    ARC,
+    /**
+     * the speeds and turn rate of the robot are assumed to change at a constant rate through the update, the rate they
+     * changed at since the last update. An arc is exact when they don't change, so this is more accurate while the
+     * robot speeds up, slows down, or starts and stops turning, which matters more the longer the update period is
+     */
+    SECOND_ORDER
+};
+
+/**
+ * @brief How the speed of the robot is calculated
+ */
+enum class OdomVelocitySource {
+    /** the change in pose is divided by the time between updates, then smoothed */
+    DIFFERENTIATED,
+    /**
+     * the velocities measured by the rotation sensors, motors, and inertial sensor are blended with the
+     * differentiated speed. Sensors that don't measure velocity, like ADI encoders, use the differentiated speed
+     */
+    HARDWARE
+};
+
 /**
- * @brief Get the local speed of the robot
+ * @brief How readings of the GPS sensor are merged into the pose
  *
- * @param radians true for theta in radians, false for degrees. False by default
- * @return lemlib::Pose
+ * The GPS reports the position of the tracking center, so its offset has to be set on the sensor, and the pose has
+ * to be in the coordinates of the GPS: the origin at the center of the field, and theta 0 facing the +y wall
  */
-Pose getLocalSpeed(bool radians = false);
+struct GpsSettings {
+        /**
+         * how far the position moves toward each new GPS reading, from 0 to 1. Lower is smoother but bounds drift more
+         * slowly. Not used with the extended Kalman filter, which weighs each reading by its error
+         */
+        float gain = 0.05;
+        /** readings the GPS reports a larger error than this for are ignored, in inches */
+        float maxError = 2;
+        /**
+         * readings further than this from the pose are ignored, in inches. Odometry drifts slowly, so a reading this
+         * far away is much more likely to be the GPS seeing the field strip wrong
+         */
+        float maxInnovation = 8;
+        /** the smallest error a reading is trusted with, in inches. The GPS reports 0 when it is very sure */
+        float minError = 0.25;
+};
+
 /**
- * @brief Estimate the pose of the robot after a certain amount of time
+ * @brief How the heading measured by tracking wheels is anchored to the inertial sensor
  *
- * @param time time in seconds
- * @param radians False for degrees, true for radians. False by default
- * @return lemlib::Pose
+ * Tracking wheels measure heading from the difference of 2 wheels, so every slip adds to an error that is never
+ * taken back out. The inertial sensor drifts much more slowly. When the heading comes from tracking wheels, it is
+ * pulled toward the heading of the inertial sensor a little every update, so it keeps the smoothness of the wheels
+ * in the short term, and the stability of the inertial sensor over a long run
  */
-Pose estimatePose(float time, bool radians = false);
+struct HeadingAnchorSettings {
+        /** whether the heading is anchored. Only has an effect with an inertial sensor, without the EKF. False by
+         * default */
+        bool enabled = false;
+        /** the part of the difference between the headings that is corrected each second. 0.2 by default */
+        float rate = 0.2;
+        /** the fastest the heading is corrected, in degrees per second. 2 by default */
+        float maxCorrection = 2;
+        /**
+         * differences larger than this, in degrees, mean a sensor failed instead of drifting. The heading isn't
+         * corrected, and the inertial sensor is anchored to the heading again. 10 by default
+         */
+        float maxDisagreement = 10;
+};
+
 /**
- * @brief Update the pose of the robot
+ * @brief How the odometry sensors are checked every update
  *
+ * A tracking wheel fails if it can't be read, or if its reading jumps further than the robot can move in 1 update.
+ * A vertical tracking wheel also fails if it doesn't move while the drive motors say it should have. The inertial
+ * sensor fails if it can't be read, or if its rotation jumps faster than the robot can turn
  */
-void update();
+struct OdomHealthSettings {
+        /** whether the sensors are checked at all */
+        bool enabled = true;
+        /** the fastest a tracking wheel can move, in inches per second */
+        float maxWheelSpeed = 150;
+        /** the fastest the robot can turn, in radians per second */
+        float maxTurnRate = 40;
+        /**
+         * how far the drive motors have to say a vertical tracking wheel moved while its reading doesn't change before
+         * it fails, in inches
+         */
+        float staleDistance = 3;
+};
+
+/**
+ * @brief Which odometry sensors have failed since the program started
+ */
+struct OdomFaults {
+        bool vertical1 = false;
+        bool vertical2 = false;
+        bool horizontal1 = false;
+        bool horizontal2 = false;
+        bool imu = false;
+};
+
+/** minimum time between odometry updates, in milliseconds. Smart sensors can't report data any faster */
+constexpr uint32_t MIN_UPDATE_PERIOD = 5;
+
+/** number of poses kept in the pose history. 128 poses is 1.28 seconds at the default update period */
+constexpr size_t POSE_HISTORY_SIZE = 128;
+/** the poses from the most recent odometry updates, oldest first */
+using PoseHistory = RingBuffer<PoseSample, POSE_HISTORY_SIZE>;
+
 /**
- * @brief Initialize the odometry system
+ * @brief Tracks the pose of a robot using its odometry sensors
+ *
+ * Each chassis owns its own odometry, with its own state and tracking task, so more than 1 chassis can be tracked at
+ * the same time. The tracking task publishes the odometry state after every update, and other tasks can read it
+ * without ever blocking the tracking task.
  *
+ * @note odometry can't be copied or moved, since its tracking task references it
  */
+class Odometry {
+    public:
+        /**
+         * @brief Construct a new Odometry
+         *
+         * The odometry doesn't do anything until setSensors() and init() are called
+         */
+        Odometry();
+        Odometry(const Odometry&) = delete;
+        Odometry& operator=(const Odometry&) = delete;
+        /**
+         * @brief Destroy the Odometry, stopping its tracking task
+         */
+        ~Odometry();
+        /**
+         * @brief Set the sensors to be used for odometry
+         *
+         * @param sensors the sensors to be used
+         */
+        void setSensors(OdomSensors sensors);
+        /**
+         * @brief Start using an inertial sensor that was calibrated after odometry started
+         *
+         * The tracking task switches the sensor in before its next update. The heading continues from the current
+         * pose, so it doesn't jump to the heading of the sensor
+         *
+         * @param imu the calibrated inertial sensor
+         */
+        void addImu(pros::Imu* imu);
+        /**
+         * @brief Correct the pose using a particle filter every update
+         *
+         * The particle filter is updated after the tracking wheels and inertial sensor are integrated, and its
+         * estimate replaces the pose. Setting the pose resets the particles around the new pose
+         *
+         * @param filter the particle filter, or nullptr to stop using it. It must outlive the odometry
+         */
+        void setParticleFilter(ParticleFilter* filter);
+        /**
+         * @brief Enable or disable the extended Kalman filter
+         *
+         * By default, only 1 heading source is used: horizontal tracking wheels, then vertical tracking wheels, then
+         * the inertial sensor, then the drivetrain. With the extended Kalman filter enabled, the pose is still
+         * integrated using that source, then every other available source corrects it
+         *
+         * @param enabled whether the extended Kalman filter is used
+         * @param settings noise settings of the filter
+         *
+         * @b Example
+         * @code {.cpp}
+         * // blend the vertical tracking wheels and the inertial sensor
+         * chassis.getOdometry().setEKF(true);
+         * @endcode
+         */
+        void setEKF(bool enabled, EKFSettings settings = EKFSettings());
+        /**
+         * @brief Set how readings of the GPS sensor are merged into the pose
+         *
+         * Each new reading of the GPS sensor given to setSensors moves the position toward it, so odometry keeps
+         * tracking between readings and the GPS bounds how far it drifts. With the extended Kalman filter enabled,
+         * the reading corrects the filter instead. Only the position is corrected, since the inertial sensor measures
+         * heading much better than the GPS does
+         *
+         * @param settings the settings
+         *
+         * @b Example
+         * @code {.cpp}
+         * pros::Gps gps(8, 0, 0, 0, -0.1, 0); // GPS sensor 10 centimeters behind the tracking center
+         * lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu, &gps);
+         * // follow the GPS more closely
+         * chassis.getOdometry().setGpsSettings({.gain = 0.1});
+         * @endcode
+         */
+        void setGpsSettings(GpsSettings settings);
+        /**
+         * @brief Set how the heading measured by tracking wheels is anchored to the inertial sensor
+         *
+         * The inertial sensor is anchored to the heading when this is called, and when the pose is set
+         *
+         * @param settings the settings
+         *
+         * @b Example
+         * @code {.cpp}
+         * // heading comes from 2 horizontal tracking wheels, with the inertial sensor keeping it from drifting
+         * lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal1, &horizontal2, &imu);
+         * chassis.getOdometry().setHeadingAnchor({.enabled = true});
+         * @endcode
+         */
+        void setHeadingAnchor(HeadingAnchorSettings settings);
+        /**
+         * @brief Set the tracking wheels that replace a vertical tracking wheel that fails
+         *
+         * Chassis::calibrate sets these to the drive motors. A failed vertical tracking wheel is replaced by the
+         * fallback on the same side of the tracking center, a failed horizontal tracking wheel is dropped, and a failed
+         * inertial sensor is dropped, so heading comes from the next heading source. The pose continues from where it
+         * was, and each failure is logged as a warning
+         *
+         * @param left the tracking wheel left of the tracking center, or nullptr. It must outlive the odometry
+         * @param right the tracking wheel right of the tracking center, or nullptr. It must outlive the odometry
+         */
+        void setFallbackWheels(TrackingWheel* left, TrackingWheel* right);
+        /**
+         * @brief Set how the odometry sensors are checked every update
+         *
+         * @param settings the settings
+         *
+         * @b Example
+         * @code {.cpp}
+         * // this robot is slow, so a smaller jump is enough to fail a tracking wheel
+         * chassis.getOdometry().setHealthSettings({.maxWheelSpeed = 80});
+         * @endcode
+         */
+        void setHealthSettings(OdomHealthSettings settings);
+        /**
+         * @brief Get which odometry sensors have failed
+         *
+         * @return OdomFaults the sensors that failed since the program started
+         *
+         * @b Example
+         * @code {.cpp}
+         * if (chassis.getOdometry().getFaults().horizontal1) pros::lcd::print(0, "horizontal tracking wheel failed");
+         * @endcode
+         */
+        OdomFaults getFaults();
+        /**
+         * @brief Set how the odometry watchdog catches stalled updates
+         *
+         * @param settings the settings
+         *
+         * @b Example
+         * @code {.cpp}
+         * // only catch updates held off for over 50 ms at the default period
+         * chassis.getOdometry().setWatchdogSettings({.stallPeriods = 5});
+         * @endcode
+         */
+        void setWatchdogSettings(OdomWatchdogSettings settings);
+        /**
+         * @brief Set when odometry drops to its idle rate
+         *
+         * @param settings the settings
+         *
+         * @b Example
+         * @code {.cpp}
+         * // also go idle while the robot waits, enabled, in the middle of a skills run
+         * chassis.getOdometry().setIdleSettings({.onlyWhenDisabled = false});
+         * @endcode
+         */
+        void setIdleSettings(OdomIdleSettings settings);
+        /**
+         * @brief Go back to the full rate right away, if odometry is idle
+         *
+         * The chassis calls this when a motion is queued. When odometry runs on a scheduler, the full rate starts after
+         * the next idle update
+         */
+        void wake();
+        /**
+         * @brief Check whether odometry is running at its idle rate
+         *
+         * @return true odometry is idle
+         */
+        bool isIdle() const;
+        /**
+         * @brief Set how the change in pose is calculated
+         *
+         * The error of integrating the motion in steps is small next to the errors of real sensors. In the replay
+         * benchmark with sensors that read exactly what the robot did, the second order integrator removes the few
+         * thousandths of an inch the arc is off by with 20 ms updates. It takes 3 sines and 3 cosines per update,
+         * where the arc takes 1 sine
+         *
+         * @param integrator the integrator. OdomIntegrator::ARC by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // follow changes in speed and turn rate within each update, while updating every 20 ms
+         * chassis.getOdometry().setIntegrator(lemlib::OdomIntegrator::SECOND_ORDER);
+         * chassis.getOdometry().setUpdatePeriod(20);
+         * @endcode
+         */
+        void setIntegrator(OdomIntegrator integrator);
+        /**
+         * @brief Set how the speed of the robot is calculated
+         *
+         * Measured velocities don't lag, so estimatePose() and the motions get more up to date speeds
+         *
+         * @param source the velocity source. OdomVelocitySource::DIFFERENTIATED by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // use the velocities measured by the sensors
+         * chassis.getOdometry().setVelocitySource(lemlib::OdomVelocitySource::HARDWARE);
+         * @endcode
+         */
+        void setVelocitySource(OdomVelocitySource source);
+        /**
+         * @brief Correct the scale of the inertial sensor, which usually measures a little less than a full turn
+         *
+         * Changing the scale while odometry is running makes the heading jump, so set it before calibrating
+         *
+         * @param scale the readings of the inertial sensor are multiplied by this. 1 by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * // the inertial sensor reads 3590 degrees after 10 turns
+         * chassis.getOdometry().setImuScale(3600.0 / 3590);
+         * @endcode
+         */
+        void setImuScale(float scale);
+        /**
+         * @brief Get the scale of the inertial sensor
+         *
+         * @return float the scale set by setImuScale
+         */
+        float getImuScale() const;
+        /**
+         * @brief Get a consistent snapshot of the odometry state
+         *
+         * This never blocks the tracking task. If the state is being written while it is read, it is read again
+         *
+         * @return OdomState the pose, speed, local speed, and time of the last update
+         *
+         * @b Example
+         * @code {.cpp}
+         * // get the pose and speed from the same update
+         * lemlib::OdomState state = odom.getState();
+         * float speed = state.speed.distance(lemlib::Pose(0, 0));
+         * @endcode
+         */
+        OdomState getState();
+        /**
+         * @brief Get the pose of the robot
+         *
+         * @param radians true for theta in radians, false for degrees. False by default
+         * @return Pose
+         */
+        Pose getPose(bool radians = false);
+        /**
+         * @brief Get the pose of the robot at a time in the past
+         *
+         * The pose is interpolated between the 2 closest poses in the pose history. This takes O(log n) time, so it
+         * can be called every iteration of a motion
+         *
+         * @param time the time, in milliseconds since the program started. Clamped to the times in the history
+         * @param radians true for theta in radians, false for degrees. False by default
+         * @return Pose the pose of the robot at that time
+         *
+         * @b Example
+         * @code {.cpp}
+         * // get where the robot was 50 ms ago, when the camera captured the last frame
+         * lemlib::Pose pose = odom.getPoseAt(pros::millis() - 50);
+         * @endcode
+         */
+        Pose getPoseAt(uint32_t time, bool radians = false);
+        /**
+         * @brief Get the odometry sensor readings of the last update
+         *
+         * Code that needs the odometry sensors should read them here instead of from the devices, so each device is
+         * only read once per update. Like getState(), this never blocks the tracking task
+         *
+         * @return SensorFrame the readings as they were sampled, before they were aligned to a common time. The
+         * tracking wheels are in inches and the inertial sensor is in radians, clockwise positive
+         *
+         * @b Example
+         * @code {.cpp}
+         * // the heading of the inertial sensor, without reading it again
+         * float heading = lemlib::radToDeg(chassis.getOdometry().getSensorFrame().imu);
+         * @endcode
+         */
+        SensorFrame getSensorFrame();
+        /**
+         * @brief Add a sensor to be read by the tracking task every update
+         *
+         * The reading is published with the odometry state, so any number of tasks can share 1 read of the device per
+         * update. The sensor is read in the tracking loop, so it must return quickly and can't allocate memory
+         *
+         * @param read reads the sensor
+         * @return int the id of the sensor, or -1 if MAX_SHARED_SENSORS sensors were already added
+         *
+         * @b Example
+         * @code {.cpp}
+         * pros::Rotation liftSensor(8);
+         * int lift = chassis.getOdometry().addSensor([] { return liftSensor.get_position() / 100.0f; });
+         * // in any task
+         * float liftAngle = chassis.getOdometry().getSensor(lift).value;
+         * @endcode
+         */
+        int addSensor(std::function<float()> read);
+        /**
+         * @brief Get the last reading of a sensor added with addSensor()
+         *
+         * @param sensor the id of the sensor
+         * @return SensorReading the reading. Empty if there is no such sensor, or it hasn't been read yet
+         */
+        SensorReading getSensor(int sensor);
+        /**
+         * @brief Get the poses from the most recent odometry updates
+         *
+         * @return PoseHistory copy of the pose history, oldest first
+         *
+         * @b Example
+         * @code {.cpp}
+         * // print the pose history
+         * const lemlib::PoseHistory history = odom.getHistory();
+         * for (size_t i = 0; i < history.size(); i++) std::cout << history[i].pose << std::endl;
+         * @endcode
+         */
+        PoseHistory getHistory();
+        /**
+         * @brief Set the Pose of the robot
+         *
+         * @param pose the new pose
+         * @param radians true if theta is in radians, false if in degrees. False by default
+         */
+        void setPose(Pose pose, bool radians = false);
+        /**
+         * @brief Move the position of the robot by a correction, spread over several updates
+         *
+         * Unlike setPose, the pose doesn't jump, so a motion that is running follows the correction smoothly. The
+         * correction is applied after the speed is calculated, so it doesn't show up in the speed. A new correction
+         * replaces the part of the last one that hasn't been applied yet, and setPose cancels it
+         *
+         * @param x the correction of the x position, in inches
+         * @param y the correction of the y position, in inches
+         * @param blendTime how long the correction is spread over, in milliseconds. 200 by default. 0 applies it at
+         * the next update
+         */
+        void correctPosition(float x, float y, uint32_t blendTime = 200);
+        /**
+         * @brief Get the speed of the robot
+         *
+         * @param radians true for theta in radians, false for degrees. False by default
+         * @return lemlib::Pose
+         */
+        Pose getSpeed(bool radians = false);
+        /**
+         * @brief Get the local speed of the robot
+         *
+         * @param radians true for theta in radians, false for degrees. False by default
+         * @return lemlib::Pose
+         */
+        Pose getLocalSpeed(bool radians = false);
+        /**
+         * @brief Estimate the pose of the robot after a certain amount of time
+         *
+         * @param time time in seconds
+         * @param radians False for degrees, true for radians. False by default
+         * @return lemlib::Pose
+         */
+        Pose estimatePose(float time, bool radians = false);
+        /**
+         * @brief Set the target time between odometry updates
+         *
+         * The data rate of the rotation sensors and inertial sensor used for odometry is set to match, so every
+         * update sees new sensor data. Faster updates reduce how far behind the real robot the pose is
+         *
+         * @param period time between updates, in milliseconds. 10 by default, and can't be lower than
+         * MIN_UPDATE_PERIOD
+         *
+         * @b Example
+         * @code {.cpp}
+         * // update odometry every 5 ms
+         * odom.setUpdatePeriod(5);
+         * @endcode
+         */
+        void setUpdatePeriod(uint32_t period);
+        /**
+         * @brief Get the timing statistics of the tracking loop
+         *
+         * @return OdomTiming the timing statistics
+         *
+         * @b Example
+         * @code {.cpp}
+         * // check if the tracking loop is falling behind
+         * if (odom.getTiming().overruns > 0) std::cout << "odometry is running late!" << std::endl;
+         * // check if the tracking task was held off
+         * if (odom.getTiming().stalls > 0) std::cout << "odometry stalled!" << std::endl;
+         * @endcode
+         */
+        OdomTiming getTiming();
+        /**
+         * @brief Get the timing of the updates run by the tracking task
+         *
+         * @return LoopProfiler& how long each update took, and how late it started
+         */
+        LoopProfiler& getProfiler();
+        /**
+         * @brief Get how long reading the inertial sensor takes, and how fresh the data it reads is
+         *
+         * The reads of the tracking wheels are recorded by the tracking wheels, see TrackingWheel::getReadStats
+         *
+         * @return ReadStats the statistics of the heading reads of the tracking task
+         */
+        ReadStats getImuReadStats();
+        /**
+         * @brief Send the read statistics of each sensor to the telemetry sink, one line each, from the sensor that
+         * takes the most time to read to the one that takes the least
+         *
+         * Each line is "sensor,name,reads,average,max,unchanged,updateInterval,budget", where budget is the
+         * percentage of the update period the average read takes
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::telemetrySink()->setLowestLevel(lemlib::Level::INFO);
+         * chassis.moveToPose(24, 24, 90, 4000);
+         * chassis.waitUntilDone();
+         * chassis.getOdometry().reportSensorReads();
+         * @endcode
+         */
+        void reportSensorReads();
+        /**
+         * @brief Forget the reads recorded for each sensor
+         */
+        void resetSensorReads();
+        /**
+         * @brief Wait until the next time the pose is published
+         *
+         * The waiting task is woken by a task notification as soon as the tracking task publishes, so a controller
+         * that waits before each step always reads a fresh pose
+         *
+         * @param timeout the longest time to wait, in milliseconds
+         * @return true a new pose was published
+         * @return false the timeout expired, or the task was notified by something else
+         *
+         * @b Example
+         * @code {.cpp}
+         * while (true) {
+         *     chassis.getOdometry().waitForUpdate(20);
+         *     // this pose was published just now
+         *     lemlib::Pose pose = chassis.getPose();
+         * }
+         * @endcode
+         */
+        bool waitForUpdate(uint32_t timeout);
+        /**
+         * @brief Get the number of times the state has been published
+         *
+         * The same as the sequence of getState(), without copying the state
+         *
+         * @return uint32_t the sequence number of the latest state
+         */
+        uint32_t getSequence() const;
+        /**
+         * @brief Wait until a state newer than the one a consumer last read is published
+         *
+         * Returns immediately if it already has been, so a state published while the consumer was busy isn't missed,
+         * the way it would be by waitForUpdate
+         *
+         * @param sequence the sequence number of the state the consumer last read
+         * @param timeout the longest time to wait, in milliseconds
+         * @return true a newer state has been published
+         * @return false the timeout expired, or the task was notified by something else
+         *
+         * @b Example
+         * @code {.cpp}
+         * uint32_t seen = 0;
+         * while (true) {
+         *     if (!chassis.getOdometry().waitForUpdateAfter(seen, 20)) continue;
+         *     const lemlib::OdomState state = chassis.getOdometry().getState();
+         *     seen = state.sequence;
+         *     // only runs when there is a new pose
+         *     draw(state.pose);
+         * }
+         * @endcode
+         */
+        bool waitForUpdateAfter(uint32_t sequence, uint32_t timeout);
+        /**
+         * @brief Read every odometry sensor once
+         *
+         * @return SensorFrame the sensor readings
+         */
+        SensorFrame sampleSensors();
+        /**
+         * @brief Update the pose of the robot
+         *
+         * The sensors are sampled once with sampleSensors(), then the pose is updated from the samples.
+         * The speed of the robot is calculated using the measured time since the last update
+         */
+        void update();
+        /**
+         * @brief Update the pose of the robot from sensor readings that were already taken
+         *
+         * This can be used to replay recorded sensor readings
+         *
+         * @param frame the sensor readings
+         *
+         * @b Example
+         * @code {.cpp}
+         * // record the sensors and update the pose from the recording
+         * const lemlib::SensorFrame frame = odom.sampleSensors();
+         * odom.update(frame);
+         * @endcode
+         */
+        void update(const SensorFrame& frame);
+        /**
+         * @brief Record the sensor readings of every update, and every time the pose is set
+         *
+         * The current state of the odometry is recorded first, so the replay starts from the same state. The filters
+         * can't be recorded, so set the log before the first update when the extended Kalman filter or particle
+         * filter is used. GPS readings aren't recorded, so a replay doesn't have their corrections
+         *
+         * @param log the sensor log, or nullptr to stop recording. It must outlive the odometry
+         */
+        void setSensorLog(SensorLog* log);
+        /**
+         * @brief Record the sensor readings and the pose of every update in a flight recorder
+         *
+         * @param recorder the flight recorder, or nullptr to stop recording. It must outlive the odometry
+         */
+        void setFlightRecorder(FlightRecorder* recorder);
+        /**
+         * @brief Update the pose from the records of a sensor log
+         *
+         * The odometry must have the same sensors and settings as the odometry that recorded the log, and its
+         * tracking task must not be running. The pose comes out the same as the recorded run. The speeds are
+         * differentiated from a different starting speed, so they only match after a few updates. Logs that were
+         * split into more than 1 file are replayed by replaying each file in order
+         *
+         * @param reader the sensor log
+         * @param onUpdate called after each update, with the new state. nullptr by default
+         * @return size_t the number of updates replayed
+         *
+         * @b Example
+         * @code {.cpp}
+         * // check how much the second order integrator would have changed a match
+         * lemlib::Odometry odom;
+         * odom.setSensors(sensors);
+         * odom.setIntegrator(lemlib::OdomIntegrator::SECOND_ORDER);
+         * lemlib::SensorLogReader reader("/usd/match_000.lsl");
+         * odom.replay(reader, [](const lemlib::OdomState& state) { std::cout << state.pose << std::endl; });
+         * @endcode
+         */
+        size_t replay(SensorLogReader& reader, std::function<void(const OdomState&)> onUpdate = nullptr);
+        /**
+         * @brief Start the tracking task, if it isn't already running
+         *
+         * The first odometry to be started is used by the lemlib::getPose family of functions
+         */
+        void init();
+        /**
+         * @brief Run the updates as a job on a scheduler, instead of on a task of their own
+         *
+         * Must be called before init(), since the tracking task can't be moved once it is running. If the scheduler
+         * is full, the odometry starts its own task as usual
+         *
+         * @param scheduler the scheduler. Must outlive the odometry
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Scheduler scheduler;
+         * void initialize() {
+         *     chassis.getOdometry().setScheduler(&scheduler);
+         *     chassis.calibrate();
+         * }
+         * @endcode
+         */
+        void setScheduler(Scheduler* scheduler);
+    private:
+        /**
+         * @brief How odometry is calculated for the configured sensors
+         *
+         * The sensors don't change after setSensors is called, so the heading source and tracking wheels are chosen
+         * once there instead of every update
+         */
+        struct Strategy {
+                /**
+                 * calculates the change in local pose from the change in tracking wheel readings and heading, and the
+                 * change in the motion of the tracking center since the last update
+                 */
+                Pose (*integrate)(float deltaX, float deltaY, float deltaHeading, Pose change, float horizontalOffset,
+                                  float verticalOffset);
+                /** calculates the change in heading from the change in sensor readings */
+                float (*headingChange)(const SensorFrame& delta, float scale);
+                /** passed to headingChange. 1 divided by the distance between the tracking wheels used for heading */
+                float headingScale;
+                /** the reading of the vertical tracking wheel used for position */
+                float SensorFrame::*vertical;
+                /** the reading of the horizontal tracking wheel used for position */
+                float SensorFrame::*horizontal;
+                /** offset of the vertical tracking wheel used for position */
+                float verticalOffset;
+                /** offset of the horizontal tracking wheel used for position */
+                float horizontalOffset;
+                /** 1 divided by the distance between the horizontal tracking wheels. 0 if there aren't 2 */
+                float horizontalScale;
+                /** 1 divided by the distance between the vertical tracking wheels */
+                float verticalScale;
+                /** the velocity of the vertical tracking wheel used for position */
+                float SensorFrame::*verticalVelocity = &SensorFrame::vertical1Velocity;
+                /** the velocity of the horizontal tracking wheel used for position */
+                float SensorFrame::*horizontalVelocity = &SensorFrame::horizontal1Velocity;
+        };
+
+        /**
+         * @brief Choose how odometry is calculated for the configured sensors
+         */
+        void chooseStrategy();
+        /**
+         * @brief Correct the pose with the extended Kalman filter, using every heading source
+         *
+         * @param prevPose the pose before this update
+         * @param delta the change in sensor readings this update
+         */
+        void fuseHeadings(Pose prevPose, const SensorFrame& delta);
+        /**
+         * @brief Reset the extended Kalman filter and the heading of each heading source to the current pose
+         */
+        void resetEKF();
+        /**
+         * @brief Check the sensor readings of this update, and replace every sensor that failed
+         *
+         * The readings of a sensor that failed are replaced with the readings of its replacement, and so is the
+         * previous frame, so the pose doesn't jump. A tracking wheel that was stuck has the motion it missed added
+         * back
+         *
+         * @param frame the sensor readings this update, fixed in place
+         */
+        void checkSensors(SensorFrame& frame);
+        /**
+         * @brief Read the GPS sensor, and keep the reading if it is new
+         */
+        void sampleGps();
+        /**
+         * @brief Merge the last GPS reading into the pose, unless it is gated out
+         *
+         * @note writeMutex must be held by the caller
+         */
+        void fuseGps();
+        /**
+         * @brief Pull the heading toward the heading of the inertial sensor
+         *
+         * @note writeMutex must be held by the caller
+         *
+         * @param imuChange the change in rotation of the inertial sensor this update, in radians
+         * @param dt the time since the last update, in seconds
+         */
+        void anchorHeading(float imuChange, float dt);
+        /**
+         * @brief Blend the velocities measured by the sensors into the speed of the robot
+         *
+         * @param frame the sensor readings this update
+         * @param deltaHeading the change in heading this update
+         */
+        void fuseVelocities(const SensorFrame& frame, float deltaHeading);
+        /**
+         * @brief Extrapolate every reading in a frame to the time of the frame
+         *
+         * The sensors are read one after another, so each reading has a different age. Without this, the skew
+         * between them shows up as an error in the pose when the robot moves fast
+         *
+         * @param frame the sensor readings, each tagged with the time it was read
+         * @return SensorFrame the readings at the time of the frame
+         */
+        SensorFrame alignFrame(const SensorFrame& frame);
+        /**
+         * @brief Set the data rate of the odometry sensors to match the update period
+         */
+        void setSensorDataRates();
+        /**
+         * @brief Run an update and record its timing, on the tracking task or the scheduler
+         *
+         * @param due when the update was due, in milliseconds
+         */
+        void tick(uint32_t due);
+        /**
+         * @brief Go idle or back to the full rate, from the speed of the robot and the competition state
+         */
+        void updateIdle();
+        /**
+         * @brief Get the time between updates at the current rate
+         *
+         * @return uint32_t the time, in milliseconds
+         */
+        uint32_t currentPeriod() const;
+        /**
+         * @brief Switch in the inertial sensor added by addImu, if there is one
+         */
+        void switchInImu();
+        /**
+         * @brief Publish the odometry state so it can be read by other tasks
+         *
+         * @note writeMutex must be held by the caller
+         *
+         * @param time the time of the update, in microseconds
+         */
+        void publishState(uint64_t time);
+        /**
+         * @brief Read the published odometry state without blocking the writer
+         *
+         * @param read function that reads the published state or history. It may be called more than once
+         * @return the value returned by read, from a read that didn't overlap a write
+         */
+        template <typename F> auto readState(F read);
+
+        // state used by the tracking task every update, kept together
+        Pose pose = Pose(0, 0, 0);
+        // the pose is accumulated in double precision, and rounded to float for the rest of the library
+        double accumulatedX = 0;
+        double accumulatedY = 0;
+        double accumulatedTheta = 0;
+        Pose speed = Pose(0, 0, 0);
+        Pose localSpeed = Pose(0, 0, 0);
+        SensorFrame prevFrame {0, 0, 0, 0, 0, 0};
+        uint64_t prevUpdateTime = 0;
+        // the motion of the tracking center in the last update, and how long it took in microseconds. 0 when it isn't
+        // known, so the next update has no change in motion
+        Pose prevTwist = Pose(0, 0, 0);
+        uint32_t prevTwistTime = 0;
+        Strategy strategy; // set by the constructor and setSensors
+        OdomTiming timing {10, 0, 0, 0, 0};
+        LoopProfiler profiler;
+        ReadMonitor imuReads;
+        TaskMonitor taskMonitor {"odometry"};
+        OdomSensors sensors = OdomSensors(nullptr, nullptr, nullptr, nullptr, nullptr, nullptr);
+
+        // snapshot of the state that is read by other tasks
+        // writers increment the sequence number before and after writing, so readers can detect if it was torn
+        std::atomic<uint32_t> sequence = 0;
+        OdomState published {Pose(0, 0, 0), Pose(0, 0, 0), Pose(0, 0, 0), 0};
+        // the sensor readings of the last update, and the copy published with the state
+        SensorFrame lastFrame {0, 0, 0, 0, 0, 0};
+        SensorFrame publishedFrame {0, 0, 0, 0, 0, 0};
+        // the sensors added with addSensor. A sensor is filled in before the count is raised, so the tracking task
+        // never sees a partial one
+        std::array<std::function<float()>, MAX_SHARED_SENSORS> sharedSensors;
+        std::atomic<size_t> sharedSensorCount = 0;
+        std::array<SensorReading, MAX_SHARED_SENSORS> sharedReadings {};
+        std::array<SensorReading, MAX_SHARED_SENSORS> publishedReadings {};
+        PoseHistory history;
+        pros::Mutex writeMutex; // only held by writers, never by readers
+        // tasks waiting for the next update. More tasks than this can wait, but they poll instead
+        std::array<std::atomic<pros::task_t>, 4> updateWaiters {};
+
+        ParticleFilter* filter = nullptr;
+        // the part of the position correction that hasn't been applied yet, and the updates left to apply it over
+        float correctionX = 0;
+        float correctionY = 0;
+        uint32_t correctionUpdates = 0;
+        // the number of times the pose has jumped, published with the state
+        uint32_t poseJumps = 0;
+        GpsSettings gpsSettings;
+        // the last reading of the GPS sensor, in inches. gpsFresh is set until it has been merged into the pose
+        float gpsX = 0;
+        float gpsY = 0;
+        float gpsError = 0;
+        bool gpsFresh = false;
+        OdomHealthSettings healthSettings;
+        OdomWatchdogSettings watchdogSettings;
+        // stalls already warned about by the tracking task
+        uint32_t reportedStalls = 0;
+        OdomIdleSettings idleSettings;
+        std::atomic<bool> idle = false;
+        std::atomic<bool> wakeRequested = false;
+        // the last time the robot moved, or couldn't go idle, in milliseconds
+        uint32_t activeTime = 0;
+        OdomFaults faults;
+        TrackingWheel* leftFallback = nullptr;
+        TrackingWheel* rightFallback = nullptr;
+        // how far each vertical tracking wheel should have moved since its reading last changed, in inches, signed
+        float staleMotion[2] = {0, 0};
+        // the readings of the fallback wheels last update
+        float prevLeftFallback = 0;
+        float prevRightFallback = 0;
+        OdomVelocitySource velocitySource = OdomVelocitySource::DIFFERENTIATED;
+        float imuScale = 1;
+        bool ekfEnabled = false;
+        ExtendedKalmanFilter ekf;
+        // heading integrated by each heading source. Only used by the extended Kalman filter, and the inertial sensor
+        // heading by the heading anchor
+        float horizontalHeading = 0;
+        float verticalHeading = 0;
+        float imuHeading = 0;
+        HeadingAnchorSettings anchorSettings;
+        SensorLog* sensorLog = nullptr;
+        std::atomic<FlightRecorder*> flightRecorder = nullptr;
+        // inertial sensor waiting to be switched in by the tracking task
+        std::atomic<pros::Imu*> pendingImu = nullptr;
+        pros::Task* task = nullptr;
+        // runs the updates instead of the task, if set before init
+        Scheduler* scheduler = nullptr;
+        int schedulerJob = -1;
+};
+
+/**
+ * @brief Set the sensors to be used for odometry
+ *
+ * @note the lemlib::getPose family of functions uses the odometry of the first chassis that was calibrated. Prefer
+ * the methods of Chassis or Odometry when more than 1 chassis is used
+ *
+ * @param sensors the sensors to be used
+ * @param drivetrain drivetrain to be used
+ */
+void setSensors(lemlib::OdomSensors sensors, lemlib::Drivetrain drivetrain);
+/** @brief Odometry::getState() of the default odometry */
+OdomState getState();
+/** @brief Odometry::getPose() of the default odometry */
+Pose getPose(bool radians = false);
+/** @brief Odometry::getPoseAt() of the default odometry */
+Pose getPoseAt(uint32_t time, bool radians = false);
+/** @brief Odometry::getHistory() of the default odometry */
+PoseHistory getHistory();
+/** @brief Odometry::setPose() of the default odometry */
+void setPose(Pose pose, bool radians = false);
+/** @brief Odometry::getSpeed() of the default odometry */
+Pose getSpeed(bool radians = false);
+/** @brief Odometry::getLocalSpeed() of the default odometry */
+Pose getLocalSpeed(bool radians = false);
+/** @brief Odometry::estimatePose() of the default odometry */
+Pose estimatePose(float time, bool radians = false);
+/** @brief Odometry::setUpdatePeriod() of the default odometry */
+void setUpdatePeriod(uint32_t period);
+/** @brief Odometry::getTiming() of the default odometry */
+OdomTiming getOdomTiming();
+/** @brief Odometry::getSequence() of the default odometry */
+uint32_t getOdomSequence();
+/** @brief Odometry::sampleSensors() of the default odometry */
+SensorFrame sampleSensors();
+/** @brief Odometry::update() of the default odometry */
+void update();
+/** @brief Odometry::update(const SensorFrame&) of the default odometry */
+void update(const SensorFrame& frame);
+/** @brief Odometry::init() of the default odometry */
 void init();
 } // namespace lemlib
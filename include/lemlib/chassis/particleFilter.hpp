@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pros/distance.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief A distance sensor used to localize the robot against the field walls
+ */
+struct DistanceSensor {
+        /** the distance sensor */
+        pros::Distance* sensor;
+        /**
+         * position of the sensor relative to the tracking center, in inches. Positive x is to the right of the robot
+         * and positive y is in front of the robot. Theta is the direction the sensor faces, in radians, clockwise
+         * from the front of the robot
+         */
+        Pose offset;
+        /** standard deviation of the distance sensor readings, in inches */
+        float stdDev = 1;
+};
+
+/**
+ * @brief The walls of the field, which the distance sensors measure the distance to
+ *
+ * The walls are axis aligned. By default they are the walls of a 144" V5 field centered on the origin
+ */
+struct FieldMap {
+        /** x position of the left wall, in inches */
+        float minX = -72;
+        /** x position of the right wall, in inches */
+        float maxX = 72;
+        /** y position of the bottom wall, in inches */
+        float minY = -72;
+        /** y position of the top wall, in inches */
+        float maxY = 72;
+};
+
+/**
+ * @brief Monte Carlo localization using odometry and distance sensors
+ *
+ * Each particle is a guess of the pose of the robot. Every update, the particles are moved by the change in the
+ * odometry pose, weighted by how well the distance sensor readings match the distance from the particle to the
+ * field walls, and resampled when too few particles have a significant weight.
+ *
+ * All particles are allocated when the filter is constructed, and nothing is allocated after. Particles are stored
+ * as separate arrays, so the weight of 4 particles can be calculated at a time with NEON. An update takes time
+ * proportional to the number of particles times the number of distance sensors. If an update takes longer than the
+ * time budget, the number of particles is reduced.
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Distance leftDistance(3);
+ * // distance sensor 6 inches left of the tracking center, facing left
+ * lemlib::ParticleFilter filter({{&leftDistance, lemlib::Pose(-6, 0, -M_PI_2)}}, lemlib::FieldMap(), 256);
+ * chassis.getOdometry().setParticleFilter(&filter);
+ * @endcode
+ */
+class ParticleFilter {
+    public:
+        /**
+         * @brief Construct a new Particle Filter
+         *
+         * @param sensors the distance sensors used to weight the particles
+         * @param map the walls of the field
+         * @param particles the maximum number of particles. 256 by default
+         */
+        ParticleFilter(std::vector<DistanceSensor> sensors, FieldMap map, size_t particles = 256);
+        /**
+         * @brief Spread the particles around a pose
+         *
+         * @param pose the pose, theta in radians
+         * @param spread standard deviation of the position of the particles, in inches
+         */
+        void reset(Pose pose, float spread);
+        /**
+         * @brief Update the particles
+         *
+         * @param prevPose the odometry pose at the last update, theta in radians
+         * @param pose the odometry pose now, theta in radians
+         * @return Pose the estimated pose of the robot, theta in radians
+         */
+        Pose update(Pose prevPose, Pose pose);
+        /**
+         * @brief Get the estimated pose of the robot from the last update
+         *
+         * @return Pose the estimated pose, theta in radians
+         */
+        Pose getEstimate();
+        /**
+         * @brief Set the number of particles
+         *
+         * @param particles number of particles. Clamped to the maximum set when the filter was constructed
+         */
+        void setParticleCount(size_t particles);
+        /**
+         * @brief Get the number of particles
+         *
+         * @return size_t number of particles
+         */
+        size_t getParticleCount();
+        /**
+         * @brief Set the maximum time an update should take
+         *
+         * If an update takes longer, the number of particles is reduced by a quarter, to a minimum of 16
+         *
+         * @param budget time, in microseconds. 0 to disable. 2000 by default
+         */
+        void setTimeBudget(uint32_t budget);
+        /**
+         * @brief Get the time the last update took
+         *
+         * @return uint32_t time, in microseconds
+         */
+        uint32_t getUpdateTime();
+        /**
+         * @brief Get the longest time an update took
+         *
+         * @return uint32_t time, in microseconds
+         */
+        uint32_t getMaxUpdateTime();
+    private:
+        /**
+         * @brief Get a uniformly distributed random number
+         *
+         * @return float random number between 0 and 1
+         */
+        float uniform();
+        /**
+         * @brief Get an approximately normally distributed random number
+         *
+         * @return float random number with a mean of 0 and a standard deviation of 1
+         */
+        float gaussian();
+        /**
+         * @brief Add the log likelihood of a distance sensor reading to the weight of each particle
+         *
+         * @param sensor the distance sensor
+         * @param reading the distance the sensor read, in inches
+         */
+        void weigh(const DistanceSensor& sensor, float reading);
+        /**
+         * @brief Resample the particles if too few of them have a significant weight, and update the estimate
+         */
+        void resample();
+
+        std::vector<DistanceSensor> sensors;
+        FieldMap map;
+        size_t capacity;
+        size_t count;
+        uint32_t timeBudget = 2000;
+        uint32_t updateTime = 0;
+        uint32_t maxUpdateTime = 0;
+        uint32_t seed = 0x12345678;
+        Pose estimate = Pose(0, 0, 0);
+
+        // particles, stored as separate arrays
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> theta;
+        std::vector<float> logWeight;
+        // sine and cosine of the heading of each particle, calculated once per update
+        std::vector<float> sinTheta;
+        std::vector<float> cosTheta;
+        // resampling writes here, then the arrays are swapped
+        std::vector<float> nextX;
+        std::vector<float> nextY;
+        std::vector<float> nextTheta;
+};
+} // namespace lemlib
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+
+namespace lemlib {
+/**
+ * @brief The current and voltage the drivetrain is kept within by a PowerManager
+ */
+struct PowerBudget {
+        /**
+         * the total current the drivetrain and the other loads may draw, in milliamps. 20000 by default, 8 motors at
+         * their 2.5 A limit
+         */
+        float current = 20000;
+        /**
+         * the most voltage the drivetrain is given, in millivolts. Lowering it to what the battery holds under load
+         * late in a match keeps the acceleration the same for the whole match. 12000 by default
+         */
+        float voltage = 12000;
+        /** the smallest fraction of full power the drivetrain is scaled to, from 0 to 1. 0.3 by default */
+        float minScale = 0.3;
+        /** time between reads of the battery and the motor currents, in milliseconds. 50 by default */
+        uint32_t period = 50;
+};
+
+/**
+ * @brief The last reading of a PowerManager
+ */
+struct PowerReading {
+        /** the battery voltage, in millivolts */
+        float battery = 0;
+        /** the current drawn by the drivetrain, in milliamps */
+        float driveCurrent = 0;
+        /** the current drawn by the other loads, in milliamps */
+        float loadCurrent = 0;
+        /** the fraction of full power the drivetrain is scaled to */
+        float scale = 1;
+};
+
+/**
+ * @brief Keeps the drivetrain within a current and voltage budget, so the battery doesn't sag and the motors aren't
+ * current limited
+ *
+ * When the drivetrain and the other loads, like an intake, draw more than the budget, the power of the drivetrain is
+ * scaled down until they don't. Both sides are scaled by the same amount, so the robot still follows the same arc,
+ * just slower. The power is also kept within the battery voltage, so a sagging battery slows the robot down evenly
+ * instead of clipping the faster side. The battery and the currents are read every few updates, since they change
+ * slowly
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::MotorGroup intake({8, -9});
+ * // keep the whole robot under 16 A, and the drivetrain under 11 V
+ * lemlib::PowerManager power({.current = 16000, .voltage = 11000});
+ * power.addLoad(&intake);
+ * lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 10, lemlib::Omniwheel::NEW_4, 360, 2, &power);
+ * @endcode
+ */
+class PowerManager {
+    public:
+        /**
+         * @brief Construct a new Power Manager
+         *
+         * @param budget the current and voltage the drivetrain is kept within
+         */
+        PowerManager(PowerBudget budget = {});
+        /**
+         * @brief Add motors that draw from the same budget as the drivetrain, but aren't scaled
+         *
+         * @param motors the motors. Must outlive the power manager
+         */
+        void addLoad(pros::MotorGroup* motors);
+        /**
+         * @brief Get the fraction of full power the drivetrain can use
+         *
+         * The battery and the currents are read again if the period has passed since they were last read
+         *
+         * @param left the left side of the drivetrain
+         * @param right the right side of the drivetrain
+         * @return float the fraction, from minScale to 1
+         */
+        float getScale(pros::MotorGroup* left, pros::MotorGroup* right);
+        /**
+         * @brief Get the last reading of the battery and the currents
+         *
+         * @return PowerReading the reading
+         */
+        PowerReading getReading();
+    private:
+        /**
+         * @brief Read the battery and the currents, and calculate the scale
+         */
+        void update(pros::MotorGroup* left, pros::MotorGroup* right);
+
+        PowerBudget budget;
+        std::vector<pros::MotorGroup*> loads;
+        /** the fraction of full power the current budget allows */
+        float currentScale = 1;
+        PowerReading reading;
+        /** time of the last reading, in milliseconds */
+        uint32_t lastUpdate = 0;
+        /** whether there has been a reading yet */
+        bool updated = false;
+        /** held while the readings are updated, so 2 tasks driving the chassis don't both update them */
+        pros::Mutex mutex;
+};
+} // namespace lemlib
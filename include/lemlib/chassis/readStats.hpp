@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief How long reading a device takes, and how fresh its data is
+ */
+struct ReadStats {
+        /** number of reads */
+        uint32_t reads = 0;
+        /** average time a read took, in microseconds */
+        float average = 0;
+        /** longest time a read took, in microseconds */
+        uint32_t max = 0;
+        /** number of reads that returned the same value as the read before, because the device hadn't sent new data */
+        uint32_t unchanged = 0;
+        /**
+         * average time between reads that returned new data, in milliseconds, or 0 if it hasn't been measured. The
+         * data is up to this old when it is read
+         */
+        float updateInterval = 0;
+};
+
+/**
+ * @brief Records the duration and the freshness of the reads of a device
+ *
+ * The freshness is measured from when the value that is read changes, so it is only measured while the robot moves.
+ * Gaps between changes longer than MAX_UPDATE_GAP are the robot standing still, and are ignored
+ *
+ * @note the statistics aren't atomic, so they can be slightly off if they are read while the device is being read
+ */
+class ReadMonitor {
+    public:
+        /**
+         * @brief Record a read of the device
+         *
+         * @param start when the read started, in microseconds
+         * @param end when the read finished, in microseconds
+         * @param value the value that was read
+         */
+        void record(uint64_t start, uint64_t end, float value);
+        /**
+         * @brief Get the statistics of the recorded reads
+         *
+         * @return ReadStats the statistics
+         */
+        ReadStats getStats() const;
+        /**
+         * @brief Forget every recorded read
+         */
+        void reset();
+    private:
+        /** longest gap between changes that is counted as an update of the device, in microseconds */
+        static constexpr uint64_t MAX_UPDATE_GAP = 100000;
+
+        uint32_t reads = 0;
+        /** time spent reading, in microseconds */
+        uint64_t total = 0;
+        uint32_t max = 0;
+        uint32_t unchanged = 0;
+        float lastValue = 0;
+        /** time of the last read that returned new data, in microseconds. 0 if there hasn't been one */
+        uint64_t lastChange = 0;
+        /** time between the counted changes, in microseconds */
+        uint64_t intervalTotal = 0;
+        uint32_t intervals = 0;
+};
+} // namespace lemlib
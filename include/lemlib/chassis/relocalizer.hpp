@@ -0,0 +1,97 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/chassis/particleFilter.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings of a WallRelocalizer
+ */
+struct RelocalizerSettings {
+        /** time from when a distance sensor measures until the reading is read, in milliseconds */
+        uint32_t latency = 30;
+        /** how long each correction is spread over, in milliseconds */
+        uint32_t blendTime = 200;
+        /**
+         * corrections larger than this are rejected, in inches. They are much more likely to be a robot or a game
+         * element in front of the sensor than drift
+         */
+        float maxCorrection = 6;
+        /** the most a sensor can face away from straight at a wall, in radians. Slanted readings are less accurate */
+        float maxIncidence = 0.35;
+        /** readings where the other wall is closer than this past the wall that was hit are ambiguous, in inches */
+        float cornerMargin = 3;
+};
+
+/**
+ * @brief Corrects the drift of odometry with distance sensors that face the field walls
+ *
+ * Each update, every distance sensor is read once. A reading is compared with where the wall it faces should be,
+ * seen from the pose the robot was at when the sensor measured, from the pose history. A sensor facing a wall
+ * across the x axis corrects x, and a sensor facing a wall across the y axis corrects y. The corrections of the
+ * sensors are averaged by how precise each sensor is, and applied with Odometry::correctPosition, so the robot can
+ * keep moving while its position is corrected.
+ *
+ * Readings that are too far, not confident, slanted, near a corner, or that disagree with odometry by too much are
+ * ignored. Heading isn't corrected
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Distance leftDistance(3);
+ * // distance sensor 6 inches left of the tracking center, facing left
+ * lemlib::WallRelocalizer relocalizer(chassis.getOdometry(), {{&leftDistance, lemlib::Pose(-6, 0, -M_PI_2)}});
+ *
+ * void autonomous() {
+ *     chassis.moveToPoint(-60, 0, 3000);
+ *     // drive along the left wall, fixing x on the way
+ *     chassis.moveToPoint(-60, 48, 3000, {}, true);
+ *     while (chassis.isInMotion()) {
+ *         relocalizer.update();
+ *         pros::delay(50);
+ *     }
+ * }
+ * @endcode
+ */
+class WallRelocalizer {
+    public:
+        /**
+         * @brief Construct a new Wall Relocalizer
+         *
+         * @param odom the odometry to correct. Must outlive the relocalizer
+         * @param sensors the distance sensors
+         * @param map the walls of the field. A 144" field centered on the origin by default
+         * @param settings the settings. Defaults are used if not given
+         */
+        WallRelocalizer(Odometry& odom, std::vector<DistanceSensor> sensors, FieldMap map = FieldMap(),
+                        RelocalizerSettings settings = RelocalizerSettings());
+        /**
+         * @brief Read the distance sensors, and correct the position if any of them can be used
+         *
+         * Readings are not taken while the last correction is still being applied, since the pose history doesn't
+         * have all of it yet
+         *
+         * @return int the number of sensors the correction was measured with. 0 if the position wasn't corrected
+         */
+        int update();
+    private:
+        /**
+         * @brief Measure the correction one sensor reading implies
+         *
+         * @param sensor the distance sensor
+         * @param reading the reading, in inches
+         * @param pose the pose when the reading was measured, with theta in radians
+         * @param correctsX set to whether the correction is of x, otherwise it is of y
+         * @return float the correction, or NAN if the reading can't be used
+         */
+        float measure(const DistanceSensor& sensor, float reading, Pose pose, bool& correctsX) const;
+
+        Odometry& odom;
+        std::vector<DistanceSensor> sensors;
+        FieldMap map;
+        RelocalizerSettings settings;
+        /** when the last correction is fully in the pose history, in milliseconds */
+        uint32_t settledTime = 0;
+};
+} // namespace lemlib
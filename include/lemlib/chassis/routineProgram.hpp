@@ -0,0 +1,258 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/routine.hpp"
+
+namespace lemlib {
+/**
+ * @brief An autonomous routine stored as a compact list of steps, so it can be changed by swapping a file on the SD
+ * card instead of building and uploading the program again
+ *
+ * A program is built with the same calls as the motions of the chassis and the steps of a Routine, on the robot or
+ * in a program on the computer, and saved to a file. On the robot, the file is loaded and prepared for a chassis:
+ * each step is decoded once into a step of a Routine, and every path it follows is read from the SD card and parsed,
+ * so running the routine only calls the motions with their decoded parameters. Steps that run code of the program,
+ * like starting an intake, name an action or condition the program registers with setAction and setCondition.
+ *
+ * The file starts with "LMR" and the format version. Then each step is an opcode byte and a flags byte, followed by
+ * its numbers as float32, then the hash of a name as a uint32 for actions and conditions, or a uint8 length and the
+ * characters of the file name for follow. The flags are the wait flag in bit 0, backwards in bit 1, the direction of
+ * a turn in bits 2 and 3, and time optimal turns in bit 4. A motion step takes 22 to 38 bytes, plus the file name
+ * for follow. Only the parameters most routines change are stored; the rest of each params struct is left at its
+ * default
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // on the computer, or in a program that writes the routine once
+ * lemlib::RoutineProgram program;
+ * program.setPose(0, 0, 0)
+ *     .moveToPose(24, 48, 90, 4000, {.lead = 0.4, .minSpeed = 60, .earlyExitRange = 4}, false)
+ *     .waitUntilProgress(-1, 20)
+ *     .action("intake on")
+ *     .waitUntilDone()
+ *     .follow("/usd/paths/goal.lpb", 10, 4000);
+ * program.save("/usd/auton.lmr");
+ *
+ * // on the robot
+ * void autonomous() {
+ *     lemlib::RoutineProgram program;
+ *     program.setAction("intake on", [] { intake.move(127); });
+ *     lemlib::Routine routine;
+ *     if (program.load("/usd/auton.lmr") && program.prepare(chassis, routine)) routine.run();
+ * }
+ * @endcode
+ */
+class RoutineProgram {
+    public:
+        /**
+         * @brief Construct a new, empty Routine Program
+         */
+        RoutineProgram();
+        /**
+         * @brief Add a step that moves to a point, see Chassis::moveToPoint
+         *
+         * Stores forwards, maxSpeed, minSpeed, and earlyExitRange of the params
+         *
+         * @param x x location of the target, in inches
+         * @param y y location of the target, in inches
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param params the parameters of the motion
+         * @param wait whether the routine waits for the motion to end before the next step. True by default
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& moveToPoint(float x, float y, int timeout, MoveToPointParams params = {}, bool wait = true);
+        /**
+         * @brief Add a step that moves to a pose, see Chassis::moveToPose
+         *
+         * Stores forwards, horizontalDrift, lead, maxSpeed, minSpeed, and earlyExitRange of the params
+         *
+         * @param x x location of the target, in inches
+         * @param y y location of the target, in inches
+         * @param theta heading of the target, in degrees
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param params the parameters of the motion
+         * @param wait whether the routine waits for the motion to end before the next step. True by default
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params = {},
+                                   bool wait = true);
+        /**
+         * @brief Add a step that turns to face a point, see Chassis::turnToPoint
+         *
+         * Stores forwards, direction, maxSpeed, minSpeed, earlyExitRange, and timeOptimal of the params
+         *
+         * @param x x location of the point, in inches
+         * @param y y location of the point, in inches
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param params the parameters of the motion
+         * @param wait whether the routine waits for the motion to end before the next step. True by default
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& turnToPoint(float x, float y, int timeout, TurnToPointParams params = {}, bool wait = true);
+        /**
+         * @brief Add a step that turns to a heading, see Chassis::turnToHeading
+         *
+         * Stores direction, maxSpeed, minSpeed, earlyExitRange, and timeOptimal of the params
+         *
+         * @param theta the heading, in degrees
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param params the parameters of the motion
+         * @param wait whether the routine waits for the motion to end before the next step. True by default
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& turnToHeading(float theta, int timeout, TurnToHeadingParams params = {}, bool wait = true);
+        /**
+         * @brief Add a step that follows a path file, see Chassis::follow
+         *
+         * The file is read and parsed when the program is prepared, not when the step runs
+         *
+         * @param file the name of the path file, like "/usd/paths/route1.lpb". At most 255 characters
+         * @param lookahead the lookahead distance, in inches
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param forwards whether the robot follows the path going forwards. True by default
+         * @param params the parameters of the motion
+         * @param wait whether the routine waits for the motion to end before the next step. True by default
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& follow(const std::string& file, float lookahead, int timeout, bool forwards = true,
+                               FollowParams params = {}, bool wait = true);
+        /**
+         * @brief Add a step that sets the pose of the chassis, see Chassis::setPose
+         *
+         * @param x x position, in inches
+         * @param y y position, in inches
+         * @param theta heading, in degrees
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& setPose(float x, float y, float theta);
+        /**
+         * @brief Add a step that calls an action, see Routine::then
+         *
+         * @param name the name the action is registered with by setAction
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& action(std::string_view name);
+        /**
+         * @brief Add a step that waits until a motion of the program ends, see Routine::waitUntilDone
+         *
+         * @param motion the index of the motion, counting the motions of the program from 0. -1 for the last motion
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& waitUntilDone(int motion = -1);
+        /**
+         * @brief Add a step that waits until a motion of the program has traveled a distance, or has ended, see
+         * Routine::waitUntilProgress
+         *
+         * @param motion the index of the motion, counting the motions of the program from 0. -1 for the last motion
+         * @param progress the distance, in inches for moveToPoint, moveToPose, and follow, degrees for turns
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& waitUntilProgress(int motion, float progress);
+        /**
+         * @brief Add a step that waits for a time
+         *
+         * @param time how long to wait, in milliseconds
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& delay(uint32_t time);
+        /**
+         * @brief Add a step that waits until a condition is true, see Routine::waitFor
+         *
+         * @param name the name the condition is registered with by setCondition
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& waitFor(std::string_view name);
+        /**
+         * @brief Add a step that ends the routine if there isn't enough time left in the match, see
+         * Routine::requireTime
+         *
+         * @param time the time the rest of the routine needs, in milliseconds
+         * @return RoutineProgram& this program, so steps can be chained
+         */
+        RoutineProgram& requireTime(uint32_t time);
+        /**
+         * @brief Register the code an action step runs
+         *
+         * @param name the name of the action
+         * @param action the function to call. It must not block
+         */
+        void setAction(std::string_view name, std::function<void()> action);
+        /**
+         * @brief Register the condition a waitFor step waits for
+         *
+         * @param name the name of the condition
+         * @param condition returns whether to stop waiting. It must not block
+         */
+        void setCondition(std::string_view name, std::function<bool()> condition);
+        /**
+         * @brief Turn the program into the steps of a routine, and load the paths it follows
+         *
+         * Nothing is added to the routine if the program can't be prepared
+         *
+         * @param chassis the chassis the motions run on. Paths are loaded with its field transform, so set it first
+         * @param routine the routine the steps are added to. It should be empty
+         * @return true the routine is ready to run
+         * @return false the program is corrupt, names an action or condition that isn't registered, or follows a
+         * path that couldn't be loaded
+         */
+        bool prepare(Chassis& chassis, Routine& routine) const;
+        /**
+         * @brief Write the program to a file
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/
+         * @return true the file was written
+         * @return false the file couldn't be written
+         */
+        bool save(const std::string& path) const;
+        /**
+         * @brief Read a program from a file, replacing the steps of this one. The registered actions and conditions
+         * are kept
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/
+         * @return true the program was read
+         * @return false the file couldn't be read, or isn't a program. The program is left as it was
+         */
+        bool load(const std::string& path);
+        /**
+         * @brief Get the encoded program, including the header
+         *
+         * @return const std::vector<uint8_t>& the bytes
+         */
+        const std::vector<uint8_t>& getData() const;
+    private:
+        /**
+         * @brief A decoded step. Only the members used by its opcode are set
+         */
+        struct Step {
+                uint8_t opcode = 0;
+                uint8_t flags = 0;
+                float args[9] = {};
+                /** the hash of the name of an action or condition */
+                uint32_t key = 0;
+                /** the name of a path file */
+                std::string file;
+        };
+
+        /**
+         * @brief Add the opcode, flags, and numbers of a step
+         */
+        void add(uint8_t opcode, uint8_t flags, std::initializer_list<float> args);
+        /**
+         * @brief Decode the steps of a program
+         *
+         * @return true the steps were decoded
+         * @return false the program is corrupt
+         */
+        static bool decode(const std::vector<uint8_t>& data, std::vector<Step>& steps);
+
+        std::vector<uint8_t> data;
+        std::unordered_map<uint32_t, std::function<void()>> actions;
+        std::unordered_map<uint32_t, std::function<bool()>> conditions;
+};
+} // namespace lemlib
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "pros/rtos.hpp"
+#include "lemlib/asset.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/routineProgram.hpp"
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/routine.hpp"
+
+namespace lemlib {
+/**
+ * @brief The paths an autonomous routine follows, so they can be loaded before it runs
+ */
+struct RoutinePaths {
+        /** path assets followed with Chassis::follow */
+        std::vector<asset> paths;
+        /** path files on the SD card followed with Chassis::follow, like "/usd/paths/route1.lpb" */
+        std::vector<std::string> files;
+        /** path assets followed forwards with Chassis::followTrajectory */
+        std::vector<asset> trajectories;
+        /** path assets followed backwards with Chassis::followTrajectory */
+        std::vector<asset> reversedTrajectories;
+};
+
+/**
+ * @brief The autonomous routines a robot can run, and which one is selected
+ *
+ * An autonomous selector usually only records which routine was picked, so every path the routine follows is read
+ * and parsed when autonomous starts, and the first motion waits for it. Routines in a registry list their paths, and
+ * selecting one prepares it on a background task right away: its field transform is set on the chassis, and its
+ * paths are loaded into the path cache and its trajectories planned, the same as Chassis::preloadPath and
+ * Chassis::preloadTrajectory. A routine program from the SD card is loaded and prepared into a Routine. Picking a
+ * routine on the brain screen in competition_initialize leaves the time until autonomous to prepare it, and run
+ * starts its first motion immediately.
+ *
+ * Selecting another routine prepares that one instead. Paths stay in the cache once they are loaded, so switching
+ * back doesn't load them again. The task runs below the motion task, like the one that prefetches path files
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * ASSET(rush_txt);
+ * lemlib::RoutineProgram skills;
+ * lemlib::RoutineRegistry autons(chassis);
+ *
+ * void initialize() {
+ *     chassis.calibrate();
+ *     autons.add("red rush", [] { chassis.follow(rush_txt, 10, 4000, true, false); }, {.paths = {rush_txt}});
+ *     // the blue side is the red side mirrored across the y axis
+ *     autons.add("blue rush", [] { chassis.follow(rush_txt, 10, 4000, true, false); }, {.paths = {rush_txt}},
+ *                lemlib::FieldTransform(true, false));
+ *     autons.addProgram("skills", skills, "/usd/skills.lmr");
+ * }
+ *
+ * void competition_initialize() {
+ *     // cycle through the routines with a button, preparing each as it is picked
+ *     pros::Controller controller(pros::E_CONTROLLER_MASTER);
+ *     size_t choice = 0;
+ *     autons.select(choice);
+ *     while (true) {
+ *         if (controller.get_digital_new_press(pros::E_CONTROLLER_DIGITAL_A)) {
+ *             choice = (choice + 1) % autons.size();
+ *             autons.select(choice);
+ *             controller.set_text(0, 0, autons.getName(choice));
+ *         }
+ *         pros::delay(20);
+ *     }
+ * }
+ *
+ * void autonomous() { autons.run(); }
+ * @endcode
+ */
+class RoutineRegistry {
+    public:
+        /**
+         * @brief Construct a new, empty Routine Registry
+         *
+         * @param chassis the chassis the routines drive
+         */
+        RoutineRegistry(Chassis& chassis);
+        RoutineRegistry(const RoutineRegistry&) = delete;
+        RoutineRegistry& operator=(const RoutineRegistry&) = delete;
+        /**
+         * @brief Add a routine written in C++
+         *
+         * @note add every routine before the first one is selected
+         *
+         * @param name the name the routine is selected and shown with
+         * @param routine runs the routine. It is called by run
+         * @param paths the paths the routine follows, loaded when it is selected
+         * @param transform the field transform the routine runs with. None by default
+         * @return RoutineRegistry& this registry, so routines can be chained
+         */
+        RoutineRegistry& add(std::string name, std::function<void()> routine, RoutinePaths paths = {},
+                             FieldTransform transform = FieldTransform());
+        /**
+         * @brief Add a routine program stored on the SD card
+         *
+         * The file is read and prepared when the routine is selected, so it can be swapped on the card until then
+         *
+         * @note add every routine before the first one is selected
+         *
+         * @param name the name the routine is selected and shown with
+         * @param program the program the file is loaded into, with the actions and conditions of the routine
+         * registered. It must outlive the registry
+         * @param file the name of the program file, like "/usd/skills.lmr"
+         * @param transform the field transform the routine runs with. None by default
+         * @return RoutineRegistry& this registry, so routines can be chained
+         */
+        RoutineRegistry& addProgram(std::string name, RoutineProgram& program, std::string file,
+                                    FieldTransform transform = FieldTransform());
+        /**
+         * @brief Select a routine, and start preparing it. Returns immediately
+         *
+         * @param index the index of the routine, in the order they were added
+         * @return true the routine was selected
+         * @return false there is no routine with that index. The selection is left as it was
+         */
+        bool select(size_t index);
+        /**
+         * @brief Select a routine by name, and start preparing it. Returns immediately
+         *
+         * @param name the name of the routine
+         * @return true the routine was selected
+         * @return false there is no routine with that name. The selection is left as it was
+         */
+        bool select(std::string_view name);
+        /**
+         * @brief Get the index of the selected routine
+         *
+         * @return std::optional<size_t> the index, or std::nullopt if no routine has been selected
+         */
+        std::optional<size_t> getSelected() const;
+        /**
+         * @brief Whether the selected routine has been prepared
+         *
+         * @return true the selected routine is ready to run, though preparing it may have failed
+         * @return false no routine is selected, or it is still being prepared
+         */
+        bool isReady() const;
+        /**
+         * @brief Run the selected routine. Blocks until it finishes
+         *
+         * If it is still being prepared, it waits for that first. A routine whose paths couldn't all be loaded still
+         * runs, since it may only need some of them
+         *
+         * @return true the routine ran
+         * @return false no routine is selected, or it is a program that couldn't be prepared
+         */
+        bool run();
+        /**
+         * @brief Get the number of routines
+         *
+         * @return size_t the number of routines
+         */
+        size_t size() const;
+        /**
+         * @brief Get the name of a routine
+         *
+         * @param index the index of the routine
+         * @return std::string the name. Empty if there is no routine with that index
+         */
+        std::string getName(size_t index) const;
+    private:
+        struct Entry {
+                std::string name;
+                std::function<void()> routine;
+                RoutinePaths paths;
+                FieldTransform transform;
+                /** the program and its file, for routine programs */
+                RoutineProgram* program = nullptr;
+                std::string file;
+                /** the routine the program was prepared into. Only set once it is prepared */
+                std::unique_ptr<Routine> prepared;
+        };
+
+        /**
+         * @brief Load the paths of a routine, or load and prepare its program
+         *
+         * @return true everything was loaded
+         * @return false something couldn't be loaded
+         */
+        bool prepare(Entry& entry);
+
+        Chassis& chassis;
+        std::vector<Entry> entries;
+        /** guards the selection and the prepared routines */
+        mutable pros::Mutex mutex;
+        std::optional<size_t> selected;
+        /** the routine that was prepared last, or std::nullopt if none was */
+        std::optional<size_t> ready;
+        pros::Task* task = nullptr;
+};
+} // namespace lemlib
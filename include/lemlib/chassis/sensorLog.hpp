@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lemlib/chassis/odom.hpp"
+#include "lemlib/logger/sdWriter.hpp"
+
+namespace lemlib {
+/**
+ * @brief The type of a record in a sensor log
+ */
+enum class SensorRecordType : uint8_t {
+    START = 1, /** the state of the odometry when recording started */
+    FRAME = 2, /** the sensor readings of an update, before they were aligned */
+    POSE = 3 /** the pose was set */
+};
+
+/**
+ * @brief A record in a sensor log
+ */
+struct SensorRecord {
+        SensorRecordType type;
+        /** FRAME: the sensor readings. START: the readings of the previous update */
+        SensorFrame frame {0, 0, 0, 0, 0, 0};
+        /** START: the accumulated pose, theta in radians. POSE: the new pose, theta in radians */
+        double x = 0;
+        double y = 0;
+        double theta = 0;
+        /** START: the time of the previous update, in microseconds. 0 if there wasn't one */
+        uint64_t prevUpdateTime = 0;
+        /** START: the update period, in milliseconds */
+        uint32_t period = 0;
+};
+
+/**
+ * @brief Records the raw sensor readings of odometry to the SD card, so they can be replayed later
+ *
+ * Every update, the odometry writes its sensor frame before it is aligned or integrated, and setting the pose writes
+ * the new pose. Replaying the log with Odometry::replay() runs the same integration on the same inputs, so the pose
+ * comes out the same, bit for bit, on the same platform. The brain and a computer round sin and cos differently, so
+ * replays on a computer can differ in the last bits.
+ *
+ * A frame takes about 50 bytes, and 70 when the measured velocities are recorded too, so a 2 minute match at the
+ * default update period takes about 600 KB. The log is written through an SdWriter, so recording never waits for
+ * the card. If the card falls behind, records are dropped and counted by getDropped(), and the replay of that log
+ * won't match.
+ *
+ * Files are named name_000.lsl, name_001.lsl, and so on. Each file starts with a 4 byte header, "LSL" and the
+ * version. Each record is its SensorRecordType, then its fields, little endian:
+ * - FRAME: the time as a uint64, then a uint16 mask of the fields that follow. Bits 0 to 4 are the readings of
+ *   vertical1, vertical2, horizontal1, horizontal2, and imu as float32, which are left out if they are exactly 0.
+ *   Bits 5 to 9 are their velocities as float32, left out if they are NAN. Bits 10 to 14 are the times they were
+ *   read, as int32 microseconds before the time of the frame, left out if they are 0
+ * - START: the accumulated x, y, and theta as float64, the time of the previous update as a uint64, and the update
+ *   period as a uint32, followed by the previous frame, encoded like a FRAME
+ * - POSE: x, y, and theta as float32
+ *
+ * @note the sensor log is meant to live for the rest of the program, like the sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // record every update of the chassis
+ * lemlib::SensorLog sensorLog("match");
+ * void initialize() {
+ *     chassis.getOdometry().setSensorLog(&sensorLog);
+ *     chassis.calibrate();
+ * }
+ * @endcode
+ */
+class SensorLog {
+    public:
+        /**
+         * @brief Construct a new Sensor Log
+         *
+         * @param name the start of the file names. Files are named name_000.lsl, name_001.lsl, and so on, starting
+         * after the files already on the card
+         * @param maxFileSize the size a file can grow to before a new one is started, in bytes
+         */
+        SensorLog(const std::string& name = "odom", size_t maxFileSize = 1 << 20);
+        /**
+         * @brief Write a record to the log
+         *
+         * @param record the record
+         */
+        void record(const SensorRecord& record);
+        /**
+         * @brief Get the number of records dropped because the card fell behind
+         *
+         * @return uint32_t the number of records
+         */
+        uint32_t getDropped() const;
+        /**
+         * @brief Append a record to a sensor log in memory, which can be read with SensorLogReader
+         *
+         * Used to build logs on a computer, like the runs the benchmarks replay. An empty log gets the header first
+         *
+         * @param record the record
+         * @param log the contents of the log
+         */
+        static void append(const SensorRecord& record, std::vector<uint8_t>& log);
+    private:
+        SdWriter writer;
+};
+
+/**
+ * @brief Reads the records of a sensor log
+ *
+ * The whole file is read into memory when the reader is constructed, so reading records doesn't touch the card
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::SensorLogReader reader("/usd/match_000.lsl");
+ * lemlib::SensorRecord record;
+ * while (reader.next(record)) {
+ *     if (record.type == lemlib::SensorRecordType::FRAME) std::cout << record.frame.vertical1 << std::endl;
+ * }
+ * @endcode
+ */
+class SensorLogReader {
+    public:
+        /**
+         * @brief Construct a new Sensor Log Reader from a file
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/
+         */
+        SensorLogReader(const std::string& path);
+        /**
+         * @brief Construct a new Sensor Log Reader from the contents of a file
+         *
+         * @param data the contents of the file, including the header
+         */
+        SensorLogReader(std::vector<uint8_t> data);
+        /**
+         * @brief Check whether the log can be read
+         *
+         * @return true the log has a header this version understands
+         * @return false the file couldn't be read, or isn't a sensor log
+         */
+        bool isValid() const;
+        /**
+         * @brief Read the next record
+         *
+         * A file that was cut off while it was written ends at the last complete record
+         *
+         * @param record where the record is written
+         * @return true a record was read
+         * @return false there are no more records, or the next one is corrupt
+         */
+        bool next(SensorRecord& record);
+    private:
+        std::vector<uint8_t> data;
+        size_t position = 0;
+        bool valid = false;
+};
+} // namespace lemlib
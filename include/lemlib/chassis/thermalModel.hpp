@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pros/motors.hpp"
+#include "pros/rtos.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings for the thermal model of the drive motors, set with Chassis::setThermalModel
+ *
+ * The defaults are for a V5 motor, which the firmware starts limiting the current of at 55 °C
+ */
+struct ThermalSettings {
+        /** how fast a motor heats up for each amp squared of current, in °C per second. 0.08 by default */
+        float heating = 0.08;
+        /** how long a motor takes to cool most of the way to the ambient temperature, in seconds. 300 by default */
+        float coolingTime = 300;
+        /** the predicted temperature the limits of the motions start falling at, in °C. 45 by default */
+        float deratingStart = 45;
+        /** the predicted temperature the limits reach minScale at, in °C. 55 by default */
+        float deratingEnd = 55;
+        /** the smallest fraction of the limits the motions are given, from 0 to 1. 0.5 by default */
+        float minScale = 0.5;
+        /** how far ahead the temperature is predicted, in seconds. 10 by default */
+        float lookahead = 10;
+        /** time between reads of the motor currents, in milliseconds. 100 by default */
+        uint32_t period = 100;
+        /** time between reads of the motor temperatures, in milliseconds. 1000 by default */
+        uint32_t temperaturePeriod = 1000;
+};
+
+/**
+ * @brief The last estimate of a ThermalModel
+ */
+struct ThermalReading {
+        /** the estimated temperature of the hottest motor, in °C */
+        float hottest = 0;
+        /** the temperature the hottest motor is predicted to reach, in °C */
+        float predicted = 0;
+        /** the fraction of their limits the motions are given */
+        float scale = 1;
+};
+
+/**
+ * @brief Estimates the temperature of each drive motor, and lowers the limits of the motions before the firmware
+ * limits the current of a hot motor
+ *
+ * The firmware halves the current of a motor that reaches 55 °C, so the acceleration of the robot halves all at once.
+ * The model integrates the heat of the current each motor draws, and the heat it loses to the air, and keeps the
+ * estimate within a step of the coarse temperature the motor reports. The temperature is predicted a few seconds
+ * ahead, and as the hottest motor is predicted to get close to the limit, the velocity and acceleration the motions
+ * plan with fall gradually, so the motors draw less and the robot never hits the cliff
+ */
+class ThermalModel {
+    public:
+        /**
+         * @brief Construct a new Thermal Model
+         *
+         * @param left the left side of the drivetrain. Must outlive the model
+         * @param right the right side of the drivetrain. Must outlive the model
+         * @param settings the settings
+         */
+        ThermalModel(pros::MotorGroup* left, pros::MotorGroup* right, ThermalSettings settings = {});
+        /**
+         * @brief Get the fraction of their limits the motions are given
+         *
+         * The currents and temperatures are read again if their periods have passed since they were last read
+         *
+         * @return float the fraction, from minScale to 1
+         */
+        float getScale();
+        /**
+         * @brief Get the last estimate
+         *
+         * @return ThermalReading the estimate
+         */
+        ThermalReading getReading();
+    private:
+        /**
+         * @brief The estimate of one motor
+         */
+        struct MotorState {
+                /** the estimated temperature, in °C */
+                float temperature = 0;
+                /** the heating of the recent current, in °C per second */
+                float heatRate = 0;
+        };
+
+        /**
+         * @brief Get a drive motor, counting the left motors first
+         */
+        pros::Motor& getMotor(size_t index);
+        /**
+         * @brief Read the currents, and the temperatures if their period has passed, and update the estimates
+         */
+        void update(uint32_t now);
+
+        pros::MotorGroup* left;
+        pros::MotorGroup* right;
+        ThermalSettings settings;
+        std::vector<MotorState> motors;
+        /** the temperature the motors cool towards, in °C. The first reading of the coolest motor */
+        float ambient = 25;
+        ThermalReading reading;
+        /** time of the last update and temperature read, in milliseconds */
+        uint32_t lastUpdate = 0;
+        uint32_t lastTemperatureRead = 0;
+        /** whether there has been a reading yet */
+        bool updated = false;
+        /** held while the estimates are updated, so 2 tasks driving the chassis don't both update them */
+        pros::Mutex mutex;
+};
+} // namespace lemlib
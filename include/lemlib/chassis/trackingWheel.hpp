@@ -1,8 +1,11 @@
 #pragma once
 
+#include <vector>
 #include "pros/motors.hpp"
 #include "pros/adi.hpp"
 #include "pros/rotation.hpp"
+#include "lemlib/staticVector.hpp"
+#include "lemlib/chassis/readStats.hpp"
 
 namespace lemlib {
 
@@ -134,6 +137,14 @@ class TrackingWheel {
          * @endcode
          */
         void reset();
+        /**
+         * @brief Set how often the encoder of the tracking wheel sends new data
+         *
+         * This only affects rotation sensors. ADI encoders and motors always update at a fixed rate
+         *
+         * @param rate time between updates, in milliseconds. The minimum is 5
+         */
+        void setDataRate(uint32_t rate);
         /**
          * @brief Get the distance traveled by the tracking wheel
          *
@@ -150,6 +161,21 @@ class TrackingWheel {
          * }
          */
         float getDistanceTraveled();
+        /**
+         * @brief Get the velocity of the tracking wheel, as measured by its encoder
+         *
+         * Rotation sensors and motors measure velocity themselves, so it doesn't lag like a velocity calculated from
+         * the change in distance
+         *
+         * @return float velocity in inches per second. NAN for ADI encoders, which don't measure velocity
+         *
+         * @b Example
+         * @code {.cpp}
+         * // print the velocity of the tracking wheel to the terminal
+         * std::cout << "velocity: " << exampleTrackingWheel.getVelocity() << std::endl;
+         * @endcode
+         */
+        float getVelocity();
         /**
          * @brief Get the offset of the tracking wheel from the center of rotation
          *
@@ -166,6 +192,29 @@ class TrackingWheel {
          * @endcode
          */
         float getOffset();
+        /**
+         * @brief Set the offset of the tracking wheel from the center of rotation
+         *
+         * Odometry reads the offset when the chassis is calibrated, so it has to be set before then
+         *
+         * @param offset offset in inches
+         */
+        void setOffset(float offset);
+        /**
+         * @brief Get the diameter of the wheel
+         *
+         * @return float diameter in inches
+         */
+        float getDiameter();
+        /**
+         * @brief Set the diameter of the wheel, like one measured by Chassis::calibrateOdometry
+         *
+         * The distance traveled is worked out from the diameter, so changing it while odometry is running makes the
+         * distance jump. Set it before the chassis is calibrated
+         *
+         * @param diameter diameter in inches
+         */
+        void setDiameter(float diameter);
         /**
          * @brief Get the type of tracking wheel
          *
@@ -183,7 +232,36 @@ class TrackingWheel {
          * @endcode
          */
         int getType();
+        /**
+         * @brief Get how long getDistanceTraveled takes to read the encoder, and how fresh the data it reads is
+         *
+         * @return ReadStats the statistics of the reads since the tracking wheel was created, or since
+         * resetReadStats was called
+         *
+         * @b Example
+         * @code {.cpp}
+         * const lemlib::ReadStats stats = exampleTrackingWheel.getReadStats();
+         * std::cout << "average read: " << stats.average << " us, data up to " << stats.updateInterval << " ms old"
+         *           << std::endl;
+         * @endcode
+         */
+        ReadStats getReadStats();
+        /**
+         * @brief Forget the reads recorded by getReadStats
+         */
+        void resetReadStats();
     private:
+        /**
+         * @brief Calculate the distance traveled per rotation of each motor from its gearset
+         */
+        void cacheMotorRatios();
+        /**
+         * @brief Read the distance traveled from the encoder
+         *
+         * @return float distance traveled in inches
+         */
+        float readDistance();
+
         float diameter;
         float distance;
         float rpm;
@@ -191,5 +269,8 @@ class TrackingWheel {
         pros::Rotation* rotation = nullptr;
         pros::Motor_Group* motors = nullptr;
         float gearRatio = 1;
+        /** a motor group can't hold more motors than the brain has ports */
+        StaticVector<float, 21> motorRatios;
+        ReadMonitor readMonitor;
 };
 } // namespace lemlib
\ No newline at end of file
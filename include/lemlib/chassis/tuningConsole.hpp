@@ -0,0 +1,88 @@
+#pragma once
+
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/configStore.hpp"
+
+namespace lemlib {
+/**
+ * @brief Reads tuning commands from the terminal, and applies them to a running chassis
+ *
+ * The commands are read from stdin on a task of their own, at the lowest priority, so waiting for input never blocks
+ * anything else. Each command is a line, and is answered with a line on stdout:
+ * - `set <name> <value>`: change a tuning value, with Chassis::setParameter. It is applied between iterations of
+ *   the motion loop, so it takes effect on the running motion
+ * - `get <name>`: print a tuning value
+ * - `save`: store the tuning values in the config store, with Chassis::saveConfig
+ * - `telemetry <on|off>`: turn binary telemetry on or off
+ * - `telemetry <channel> <on|off> [period]`: turn a channel of binary telemetry on or off, with
+ *   BinaryTelemetry::setChannel. The channels are odom, motion, motors, pid, and path, and the period is in
+ *   milliseconds
+ * - `sync <sequence> <host time>`: answer a clock sync request from the host with a CLOCK_SYNC record, with
+ *   BinaryTelemetry::sendClockSync. The host time is in microseconds. It is answered with the record only, since
+ *   firmware/clocksync.py sends one every second
+ *
+ * The names are the ones Chassis::setParameter takes, like lateral.kP or angular.smallError
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::ConfigStore config("/usd/robot.cfg");
+ * lemlib::TuningConsole console(chassis, &config);
+ *
+ * void initialize() {
+ *     chassis.calibrate();
+ *     console.start();
+ * }
+ * // then in the terminal, while a motion is running:
+ * // set angular.kD 12
+ * // save
+ * // telemetry pid on 50
+ * @endcode
+ */
+class TuningConsole {
+    public:
+        /**
+         * @brief Construct a new Tuning Console. Nothing is read until start is called
+         *
+         * @param chassis the chassis the commands change. Must outlive the console
+         * @param config where save stores the tuning values. nullptr if they can't be saved, which is the default
+         */
+        TuningConsole(Chassis& chassis, ConfigStore* config = nullptr);
+        TuningConsole(const TuningConsole&) = delete;
+        TuningConsole& operator=(const TuningConsole&) = delete;
+        /**
+         * @brief Start reading commands, if the console isn't reading already
+         */
+        void start();
+        /**
+         * @brief Run a command, and print its answer
+         *
+         * @param line the command, like "set lateral.kP 12"
+         * @return true the command was run
+         * @return false the command wasn't understood, or failed
+         */
+        bool run(const char* line);
+    private:
+        /**
+         * @brief Read and run commands until the program ends. Runs on the console task
+         */
+        void readCommands();
+        /**
+         * @brief Run a telemetry command, and print its answer
+         *
+         * @return true the command was run
+         */
+        bool setTelemetry(const char* line);
+        /**
+         * @brief Run a sync command, and answer it with a clock sync record
+         *
+         * @param receiveTime the time the command was received, in microseconds
+         * @return true the command was run
+         */
+        bool sync(const char* line, uint64_t receiveTime);
+
+        Chassis& chassis;
+        ConfigStore* config;
+        pros::Task* task = nullptr;
+};
+} // namespace lemlib
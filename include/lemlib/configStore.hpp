@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "lemlib/path/bundle.hpp"
+
+namespace lemlib {
+/**
+ * @brief Header of a config file
+ *
+ * The header is followed by `count` ConfigEntry, sorted by key. The checksum covers the entries, so a file that was
+ * cut off or corrupted while it was written is rejected instead of loading half of it
+ */
+struct ConfigHeader {
+        /** magic number used to identify config files. Always equal to CONFIG_MAGIC */
+        uint32_t magic;
+        /** version of the config format. Always equal to CONFIG_VERSION */
+        uint16_t version;
+        /** number of entries in the file */
+        uint16_t count;
+        /** CRC-32 of the entries */
+        uint32_t checksum;
+};
+
+/**
+ * @brief A value in a config file
+ */
+struct ConfigEntry {
+        /** hash of the name of the value, from configKeyHash */
+        uint32_t key;
+        /** the value */
+        float value;
+};
+
+static_assert(sizeof(ConfigHeader) == 12, "ConfigHeader must be 12 bytes");
+static_assert(sizeof(ConfigEntry) == 8, "ConfigEntry must be 8 bytes");
+
+/** magic number of config files, "LLCF" in little endian */
+constexpr uint32_t CONFIG_MAGIC = 0x46434C4C;
+/** current version of the config format */
+constexpr uint16_t CONFIG_VERSION = 1;
+
+/**
+ * @brief Calculate the CRC-32 of some bytes, the same one zlib and PNG use
+ *
+ * @param data the bytes
+ * @param size the number of bytes
+ * @return uint32_t the CRC
+ */
+uint32_t crc32(const uint8_t* data, size_t size);
+
+/**
+ * @brief Hash the name of a value in a config file
+ *
+ * This is the same 32 bit FNV-1a as pathNameHash, so names known at compile time are hashed at compile time
+ *
+ * @param key the name of the value
+ * @return uint32_t the hash
+ */
+constexpr uint32_t configKeyHash(std::string_view key) { return pathNameHash(key); }
+
+/**
+ * @brief Tuning values stored in a compact binary file on the SD card
+ *
+ * Gains, offsets, and characterization results can be stored here instead of as literals in the program, so they
+ * can be changed without building and uploading again. The file is read with a single read and checked with a
+ * CRC-32, so loading it takes a few hundred microseconds, most of it the card. Values are looked up by the hash of
+ * their name, and values the file doesn't have fall back to the ones in the program
+ *
+ * Chassis::loadConfig applies the values a chassis uses, and Chassis::saveConfig stores them, so the result of a
+ * tuning tool can be saved on the robot and used from the next run on
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::ConfigStore config("/usd/robot.cfg");
+ *
+ * void initialize() {
+ *     // the values of the last run of the tuning tools, if there are any
+ *     config.load();
+ *     chassis.loadConfig(config);
+ *     chassis.calibrate();
+ * }
+ *
+ * void autonomous() {
+ *     // keep the proposed gains for the next run
+ *     const lemlib::AutotuneResult result = chassis.autotune(lemlib::AutotuneController::ANGULAR);
+ *     if (result.success) {
+ *         config.set("angular.kP", result.kP);
+ *         config.set("angular.kI", result.kI);
+ *         config.set("angular.kD", result.kD);
+ *         config.save();
+ *     }
+ * }
+ * @endcode
+ */
+class ConfigStore {
+    public:
+        /**
+         * @brief Construct a new Config Store. Nothing is read until load is called
+         *
+         * @param path the path of the file. Files on the SD card start with /usd/. "/usd/lemlib.cfg" by default
+         */
+        ConfigStore(const std::string& path = "/usd/lemlib.cfg");
+        /**
+         * @brief Read the values from the file, replacing the values in the store
+         *
+         * @return true the file was read
+         * @return false there is no SD card or file, or the file is corrupt or from a different version of LemLib.
+         * The values in the store are left as they were
+         */
+        bool load();
+        /**
+         * @brief Write the values to the file, replacing it
+         *
+         * @return true the file was written
+         * @return false there is no SD card, or the file couldn't be written
+         */
+        bool save() const;
+        /**
+         * @brief Get a value
+         *
+         * @param key the name of the value
+         * @return std::optional<float> the value, or std::nullopt if the store doesn't have it
+         */
+        std::optional<float> get(std::string_view key) const;
+        /**
+         * @brief Get a value, or a fallback if the store doesn't have it
+         *
+         * @param key the name of the value
+         * @param fallback returned if the store doesn't have the value
+         * @return float the value
+         */
+        float get(std::string_view key, float fallback) const;
+        /**
+         * @brief Set a value. It is only written to the file by save
+         *
+         * @param key the name of the value
+         * @param value the value
+         */
+        void set(std::string_view key, float value);
+        /**
+         * @brief Get the number of values in the store
+         *
+         * @return size_t the number of values
+         */
+        size_t size() const;
+    private:
+        std::string path;
+        /** the values, sorted by key so they can be binary searched */
+        std::vector<ConfigEntry> entries;
+};
+} // namespace lemlib
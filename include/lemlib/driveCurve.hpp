@@ -1,3 +1,8 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
 namespace lemlib {
 
 /**
@@ -24,6 +29,10 @@ class DriveCurve {
  *
  * see https://www.desmos.com/calculator/umicbymbnl for an interactive graph
  * see https://www.vexforum.com/t/expo-drive-lemlibs-implementation for a detailed explanation
+ *
+ * The output for every joystick input from -127 to 127 is calculated when the curve is constructed, so curving an
+ * input is a single load from a table. The constructor is constexpr, so a curve declared globally with constant
+ * parameters has its table built by the compiler
  */
 class ExpoDriveCurve : public DriveCurve {
     public:
@@ -46,7 +55,14 @@ class ExpoDriveCurve : public DriveCurve {
          * lemlib::ExpoDriveCurve driveCurve(5, 12, 1.132);
          * @endcode
          */
-        ExpoDriveCurve(float deadband, float minOutput, float curve);
+        constexpr ExpoDriveCurve(float deadband, float minOutput, float curve)
+            : deadband(deadband),
+              minOutput(minOutput),
+              curveGain(curve) {
+            for (int input = -JOYSTICK_RANGE; input <= JOYSTICK_RANGE; input++) {
+                this->table[input + JOYSTICK_RANGE] = this->compute(input);
+            }
+        }
         /**
          * @brief curve an input
          *
@@ -66,10 +82,36 @@ class ExpoDriveCurve : public DriveCurve {
          * }
          * @endcode
          */
-        float curve(float input);
+        float curve(float input) override;
     private:
+        // the largest input from a joystick
+        static constexpr int JOYSTICK_RANGE = 127;
+
+        /**
+         * @brief Calculate the output of the curve, without the table
+         *
+         * @param input the input to curve
+         * @return float the curved output
+         */
+        constexpr float compute(float input) const {
+            const float sign = input < 0 ? -1 : 1;
+            // return 0 if input is within deadzone
+            if (std::fabs(input) <= deadband) return 0;
+            // g is the output of g(x) as defined in the Desmos graph
+            const float g = std::fabs(input) - deadband;
+            // g127 is the output of g(127) as defined in the Desmos graph
+            const float g127 = 127 - deadband;
+            // i is the output of i(x) as defined in the Desmos graph
+            const float i = std::pow(double(curveGain), double(g - 127)) * g * sign;
+            // i127 is the output of i(127) as defined in the Desmos graph
+            const float i127 = std::pow(double(curveGain), double(g127 - 127)) * g127;
+            return (127.0 - minOutput) / (127) * i * 127 / i127 + minOutput * sign;
+        }
+
         const float deadband = 0;
         const float minOutput = 0;
         const float curveGain = 1;
+        // the output for each input from -127 to 127
+        std::array<float, 2 * JOYSTICK_RANGE + 1> table {};
 };
 } // namespace lemlib
\ No newline at end of file
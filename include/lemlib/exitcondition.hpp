@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace lemlib {
 class ExitCondition {
     public:
@@ -49,6 +51,71 @@ class ExitCondition {
          * @endcode
          */
         bool update(const float input);
+        /**
+         * @brief update the exit condition, using a timestamp that was already read
+         *
+         * @param input the input for the exit condition
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return true exit condition met
+         * @return false exit condition not met
+         *
+         * @b Example
+         * @code {.cpp}
+         * // read the clock once per iteration, and share it between every exit condition
+         * const uint64_t now = pros::micros();
+         * smallExit.update(error, now);
+         * largeExit.update(error, now);
+         * @endcode
+         */
+        bool update(const float input, const uint64_t now);
+        /**
+         * @brief update the exit condition, exiting early if the robot is about to settle in range
+         *
+         * If the input is in range, the robot is slower than the velocity set by setVelocityExit, and the predicted
+         * input is in range too, the exit condition is met immediately instead of waiting for the timeout
+         *
+         * @param input the input for the exit condition
+         * @param velocity how fast the input is changing, in units per second
+         * @param predictedInput the input where the robot is predicted to stop
+         * @return true exit condition met
+         * @return false exit condition not met
+         *
+         * @b Example
+         * @code {.cpp}
+         * // exit as soon as the robot stops within range
+         * ec.setVelocityExit(2);
+         * while (!ec.getExit()) {
+         *     // do something
+         *     ec.update(error, velocity, error - velocity * 0.05);
+         * }
+         * @endcode
+         */
+        bool update(const float input, const float velocity, const float predictedInput);
+        /**
+         * @brief update the exit condition, exiting early if the robot is about to settle in range, using a
+         * timestamp that was already read
+         *
+         * @param input the input for the exit condition
+         * @param velocity how fast the input is changing, in units per second
+         * @param predictedInput the input where the robot is predicted to stop
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return true exit condition met
+         * @return false exit condition not met
+         */
+        bool update(const float input, const float velocity, const float predictedInput, const uint64_t now);
+        /**
+         * @brief set the velocity below which the exit condition can exit early
+         *
+         * @param maxVelocity the velocity, in units per second. 0 to disable early exits, which is the default
+         */
+        void setVelocityExit(const float maxVelocity);
+        /**
+         * @brief change the range and time of the exit condition
+         *
+         * @param range the range where the countdown is allowed to start
+         * @param time how much time to wait while in range before exiting
+         */
+        void setThreshold(const float range, const int time);
         /**
          * @brief reset the exit condition timer
          *
@@ -60,9 +127,11 @@ class ExitCondition {
          */
         void reset();
     protected:
-        const float range;
-        const int time;
-        int startTime = -1;
+        float range;
+        int time;
+        float maxVelocity = 0;
+        // when the input entered the range, in microseconds. 0 while out of range
+        uint64_t startTime = 0;
         bool done = false;
 };
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include "lemlib/pose.hpp"
+
+/**
+ * @brief Float-only trig and angle wrapping for the hot paths of the motion loops
+ *
+ * The brain's CPU has no hardware for trig, and <math.h> computes it in double precision in software. These functions
+ * stay in float, so they take a fraction of the time. They trade accuracy for it, within the bounds below, which are
+ * far smaller than anything a sensor can measure
+ *
+ * - sin and cos: within 2e-6 of the exact value for angles within 2 turns of 0
+ * - wrapAngle and angleError: within 2e-6 radians for angles within 2 turns of 0
+ * - atan2: within 2e-6 radians of the exact angle
+ *
+ * Past 2 turns the error of the angle functions grows by about 1e-7 per radian, since a float can't hold a large
+ * angle more precisely than that
+ *
+ * @b Example
+ * @code {.cpp}
+ * float s, c;
+ * lemlib::fastmath::sincos(pose.theta, s, c);
+ * // the heading from the robot to the target, in standard form
+ * const float heading = lemlib::fastmath::atan2(target.y - pose.y, target.x - pose.x);
+ * @endcode
+ */
+namespace lemlib::fastmath {
+constexpr float PI = M_PI;
+constexpr float TWO_PI = 2 * M_PI;
+constexpr float HALF_PI = M_PI_2;
+constexpr float INV_TWO_PI = 1 / (2 * M_PI);
+
+/**
+ * @brief Wrap an angle to between -pi and pi, without branches
+ *
+ * @param angle the angle, in radians
+ * @return float the same angle, between -pi and pi
+ */
+inline float wrapAngle(float angle) {
+    const float turns = angle * INV_TWO_PI;
+    // truncate to between -1 and 1 turns, then fold the half turns on each side back in. The comparisons compile
+    // to conditional instructions, not branches
+    float fraction = turns - float(int32_t(turns));
+    fraction -= float(fraction > 0.5f);
+    fraction += float(fraction < -0.5f);
+    return fraction * TWO_PI;
+}
+
+/**
+ * @brief Calculate the shortest error between 2 angles
+ *
+ * Equivalent to lemlib::angleError with radians and AngularDirection::AUTO
+ *
+ * @param target the target angle, in radians
+ * @param position the position angle, in radians
+ * @return float the error, between -pi and pi
+ */
+inline float angleError(float target, float position) { return wrapAngle(target - position); }
+
+/**
+ * @brief Calculate the sine of an angle
+ *
+ * @param angle the angle, in radians. Any angle works, it is wrapped first
+ * @return float the sine
+ */
+inline float sin(float angle) {
+    float x = wrapAngle(angle);
+    // sin(x) = sin(pi - x), so angles past a quarter turn fold back into the range the polynomial is fitted to
+    const float folded = std::copysign(PI, x) - x;
+    x = std::fabs(x) > HALF_PI ? folded : x;
+    // minimax polynomial on -pi/2 to pi/2
+    const float x2 = x * x;
+    return x * (0.999996616f + x2 * (-0.166648285f + x2 * (0.00830632613f + x2 * -0.000183636736f)));
+}
+
+/**
+ * @brief Calculate the cosine of an angle
+ *
+ * @param angle the angle, in radians. Any angle works, it is wrapped first
+ * @return float the cosine
+ */
+inline float cos(float angle) { return fastmath::sin(angle + HALF_PI); }
+
+/**
+ * @brief Calculate the sine and cosine of an angle
+ *
+ * @param angle the angle, in radians. Any angle works, it is wrapped first
+ * @param s where the sine is written
+ * @param c where the cosine is written
+ */
+inline void sincos(float angle, float& s, float& c) {
+    s = fastmath::sin(angle);
+    c = fastmath::cos(angle);
+}
+
+/**
+ * @brief Calculate the angle of a vector from the x axis, like std::atan2
+ *
+ * @param y the y component of the vector
+ * @param x the x component of the vector
+ * @return float the angle, between -pi and pi. 0 if both components are 0
+ */
+inline float atan2(float y, float x) {
+    const float absX = std::fabs(x);
+    const float absY = std::fabs(y);
+    const float larger = std::fmax(absX, absY);
+    if (larger == 0) return 0;
+    // the polynomial is fitted to atan on 0 to 1, so the other octants are reflected into it
+    const float z = std::fmin(absX, absY) / larger;
+    const float z2 = z * z;
+    float angle = z * (0.999977221f +
+                       z2 * (-0.332622842f +
+                             z2 * (0.193540411f + z2 * (-0.116426502f + z2 * (0.0526473319f + z2 * -0.0117191181f)))));
+    if (absY > absX) angle = HALF_PI - angle;
+    if (x < 0) angle = PI - angle;
+    return std::copysign(angle, y);
+}
+
+/**
+ * @brief Calculate the angle from one pose to another, like Pose::angle
+ *
+ * @param from the pose the angle is measured from
+ * @param to the pose the angle is measured to
+ * @return float the angle, in radians, in standard form
+ */
+inline float angle(Pose from, Pose to) { return fastmath::atan2(to.y - from.y, to.x - from.x); }
+} // namespace lemlib::fastmath
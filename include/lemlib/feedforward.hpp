@@ -0,0 +1,47 @@
+#pragma once
+
+namespace lemlib {
+/**
+ * @brief Feedforward model of a drivetrain side
+ *
+ * Predicts the voltage needed for a wheel velocity and acceleration, so the controllers only have to correct the
+ * difference between the model and the real robot. Set every gain to 0 to disable it
+ */
+class Feedforward {
+    public:
+        /**
+         * @brief Construct a new Feedforward
+         *
+         * @param kS voltage needed to overcome static friction, in volts
+         * @param kV voltage per unit of velocity, in volts per inch per second
+         * @param kA voltage per unit of acceleration, in volts per inch per second squared
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::Feedforward feedforward(0.8, // static friction (kS)
+         *                                 0.18, // velocity gain (kV)
+         *                                 0.02); // acceleration gain (kA)
+         * @endcode
+         */
+        Feedforward(float kS = 0, float kV = 0, float kA = 0);
+        /**
+         * @brief Calculate the voltage for a wheel velocity and acceleration
+         *
+         * @param velocity the velocity, in inches per second
+         * @param acceleration the acceleration, in inches per second squared
+         * @return float the voltage, in volts
+         */
+        float calculate(float velocity, float acceleration = 0) const;
+        /**
+         * @brief Whether the model can turn velocities into voltages
+         *
+         * @return true kV is set
+         * @return false kV is 0, so velocities can't be converted
+         */
+        bool isEnabled() const;
+
+        float kS;
+        float kV;
+        float kA;
+};
+} // namespace lemlib
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief A change of coordinates from the frame a route is written in to the field
+ *
+ * The route is mirrored first, then rotated. Headings are in degrees, clockwise from the positive y axis, like the
+ * targets of motions. A transform that mirrors exactly one axis also swaps clockwise and counterclockwise, and the
+ * left and right sides of the robot
+ *
+ * @b Example
+ * @code {.cpp}
+ * // the blue side of the field is the red side mirrored across the y axis
+ * const lemlib::FieldTransform blue(true, false);
+ * // x = 10, y = 20, theta = 45 becomes x = -10, y = 20, theta = -45
+ * const lemlib::Pose pose = blue.apply(lemlib::Pose(10, 20, 45));
+ * @endcode
+ */
+struct FieldTransform {
+        /**
+         * @brief Construct a new Field Transform
+         *
+         * @param mirrorX whether x is negated. False by default
+         * @param mirrorY whether y is negated. False by default
+         * @param rotation how far the route is rotated clockwise around the origin after mirroring, in degrees. 0 by
+         * default
+         */
+        FieldTransform(bool mirrorX = false, bool mirrorY = false, float rotation = 0);
+        /**
+         * @brief Whether the transform changes nothing
+         *
+         * @return true the route is already in field coordinates
+         * @return false the route is mirrored or rotated
+         */
+        bool isIdentity() const;
+        /**
+         * @brief Whether the transform swaps clockwise and counterclockwise
+         *
+         * @return true exactly one axis is mirrored
+         * @return false the transform keeps the handedness of the route
+         */
+        bool flipsHandedness() const;
+        /**
+         * @brief Transform a pose from the route to the field
+         *
+         * @param pose the pose in the route, with theta in degrees
+         * @return Pose the pose on the field
+         */
+        Pose apply(Pose pose) const;
+        /**
+         * @brief Transform a heading from the route to the field
+         *
+         * @param theta the heading in the route, in degrees
+         * @return float the heading on the field, in degrees
+         */
+        float applyHeading(float theta) const;
+        /**
+         * @brief Transform a pose from the field back to the route
+         *
+         * @param pose the pose on the field, with theta in degrees
+         * @return Pose the pose in the route
+         */
+        Pose invert(Pose pose) const;
+
+        /** whether x is negated */
+        bool mirrorX;
+        /** whether y is negated */
+        bool mirrorY;
+        /** clockwise rotation after mirroring, in degrees */
+        float rotation;
+};
+} // namespace lemlib
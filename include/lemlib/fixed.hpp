@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace lemlib {
+/**
+ * @brief A Q16.16 fixed point number, for comparing the cost and accuracy of integer math with float
+ *
+ * The value is stored as a 32 bit integer in 1/65536ths, so it covers -32768 to 32768 with a resolution of about
+ * 1.5e-5. Addition and subtraction are a single integer instruction, and multiplication and division use a 64 bit
+ * intermediate so they don't overflow inside the range. Dividing by 0 saturates instead of trapping
+ *
+ * Fixed works anywhere a float does in the templated math, like BasicPose and BasicPID. Square roots and trig are
+ * computed by converting to float and back, since the brain has hardware for float and none for integer roots
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::Fixed error = 12.5;
+ * lemlib::BasicPID<lemlib::Fixed> pid(5, 0, 20);
+ * // about 62.5
+ * const float output = float(pid.update(error));
+ * @endcode
+ */
+class Fixed {
+    public:
+        /** the raw value of 1 */
+        static constexpr int32_t ONE = 1 << 16;
+
+        /**
+         * @brief Construct a fixed point 0
+         */
+        constexpr Fixed() = default;
+
+        /**
+         * @brief Convert a number to fixed point, rounded to the nearest step
+         *
+         * @param value the number. Must be between -32768 and 32768
+         */
+        template <typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+        constexpr Fixed(U value)
+            : raw(toRaw(value)) {}
+
+        /**
+         * @brief Make a fixed point number from its raw value
+         *
+         * @param raw the value in 1/65536ths
+         * @return constexpr Fixed the number
+         */
+        static constexpr Fixed fromRaw(int32_t raw) {
+            Fixed fixed;
+            fixed.raw = raw;
+            return fixed;
+        }
+
+        /**
+         * @brief Get the raw value
+         *
+         * @return constexpr int32_t the value in 1/65536ths
+         */
+        constexpr int32_t getRaw() const { return raw; }
+
+        /**
+         * @brief Convert the number to float, double, or an integer, which truncates
+         */
+        template <typename U, typename = std::enable_if_t<std::is_arithmetic_v<U>>>
+        constexpr explicit operator U() const {
+            return U(double(raw) / ONE);
+        }
+
+        friend constexpr Fixed operator+(Fixed a, Fixed b) { return fromRaw(a.raw + b.raw); }
+
+        friend constexpr Fixed operator-(Fixed a, Fixed b) { return fromRaw(a.raw - b.raw); }
+
+        friend constexpr Fixed operator-(Fixed a) { return fromRaw(-a.raw); }
+
+        friend constexpr Fixed operator*(Fixed a, Fixed b) { return fromRaw(int32_t((int64_t(a.raw) * b.raw) >> 16)); }
+
+        friend constexpr Fixed operator/(Fixed a, Fixed b) {
+            if (b.raw == 0) return fromRaw(a.raw < 0 ? std::numeric_limits<int32_t>::min() : MAX_RAW);
+            return fromRaw(int32_t(int64_t(a.raw) * ONE / b.raw));
+        }
+
+        constexpr Fixed& operator+=(Fixed other) { return *this = *this + other; }
+
+        constexpr Fixed& operator-=(Fixed other) { return *this = *this - other; }
+
+        constexpr Fixed& operator*=(Fixed other) { return *this = *this * other; }
+
+        constexpr Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+        friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+
+        friend constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+
+        friend constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+
+        friend constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+
+        friend constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+
+        friend constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+
+        // The math functions are found by argument dependent lookup, so templated code calls them unqualified after
+        // "using std::sqrt", and so on. Being friends, they don't hide the standard functions for other types
+
+        friend constexpr Fixed fabs(Fixed value) { return fromRaw(value.raw < 0 ? -value.raw : value.raw); }
+
+        friend Fixed sqrt(Fixed value) { return Fixed(std::sqrt(float(value))); }
+
+        friend Fixed sin(Fixed value) { return Fixed(std::sin(float(value))); }
+
+        friend Fixed cos(Fixed value) { return Fixed(std::cos(float(value))); }
+
+        friend Fixed atan2(Fixed y, Fixed x) { return Fixed(std::atan2(float(y), float(x))); }
+
+        /**
+         * @brief Calculate sqrt(x * x + y * y) without the squares overflowing, which they would past 181
+         */
+        friend Fixed hypot(Fixed x, Fixed y) {
+            // the squares are in 1/2^32ths, so their square root is back in 1/65536ths
+            const int64_t squares = int64_t(x.raw) * x.raw + int64_t(y.raw) * y.raw;
+            return fromRaw(int32_t(std::sqrt(double(squares))));
+        }
+    private:
+        // the largest raw value
+        static constexpr int32_t MAX_RAW = std::numeric_limits<int32_t>::max();
+
+        template <typename U> static constexpr int32_t toRaw(U value) {
+            if constexpr (std::is_floating_point_v<U>) return int32_t(value * ONE + (value < 0 ? -0.5 : 0.5));
+            else return int32_t(value) * ONE;
+        }
+
+        int32_t raw = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+
+namespace lemlib {
+/**
+ * @brief What a gain schedule is keyed by
+ */
+enum class ScheduleKey {
+    ERROR, /** the magnitude of the error */
+    VELOCITY /** the magnitude of the derivative, the change in error per 10 ms update */
+};
+
+/**
+ * @brief PID gains
+ */
+struct Gains {
+        float kP = 0;
+        float kI = 0;
+        float kD = 0;
+};
+
+/**
+ * @brief The gains of a gain schedule at one value of its key
+ */
+struct GainPoint {
+        /** the value of the key */
+        float key;
+        /** the gains at the value */
+        Gains gains;
+};
+
+/**
+ * @brief A table of PID gains, interpolated by the magnitude of the error or velocity
+ *
+ * The points are resampled into a table with evenly spaced keys when the schedule is constructed, so looking up the
+ * gains takes constant time no matter how many points there are. Resampling slightly rounds the table at points that
+ * don't land on an entry. Keys outside of the points use the gains of the nearest point
+ *
+ * @b Example
+ * @code {.cpp}
+ * // aggressive gains for small turns, gentle gains for large turns
+ * lemlib::GainSchedule schedule(lemlib::ScheduleKey::ERROR, {{10, {4, 0, 20}}, {90, {2, 0, 12}}, {180, {1.5, 0, 10}}});
+ * @endcode
+ */
+class GainSchedule {
+    public:
+        /**
+         * @brief Construct a new Gain Schedule
+         *
+         * @param key what the schedule is keyed by
+         * @param points the gains at values of the key, in any order. Needs at least 1 point
+         */
+        GainSchedule(ScheduleKey key, std::initializer_list<GainPoint> points);
+        /**
+         * @brief Find the gains at a value of the key
+         *
+         * @param value the value. Its magnitude is used
+         * @return Gains the interpolated gains
+         */
+        Gains lookup(float value) const;
+        /**
+         * @brief Get what the schedule is keyed by
+         *
+         * @return ScheduleKey the key
+         */
+        ScheduleKey getKey() const;
+    private:
+        /** number of entries in the resampled table */
+        static constexpr size_t TABLE_SIZE = 32;
+
+        ScheduleKey key;
+        float minKey = 0;
+        /** difference between the keys of neighboring entries. 0 if every point has the same key */
+        float step = 0;
+        std::array<Gains, TABLE_SIZE> table {};
+};
+} // namespace lemlib
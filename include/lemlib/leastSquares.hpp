@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+namespace lemlib {
+/**
+ * @brief Streaming linear least squares fit
+ *
+ * Samples are accumulated into the normal equations as they arrive, so the fit uses a fixed amount of memory no
+ * matter how many samples there are. Accumulators are doubles, so millions of samples don't lose precision
+ *
+ * @tparam N the number of coefficients
+ *
+ * @b Example
+ * @code {.cpp}
+ * // fit y = a + b * x
+ * lemlib::LeastSquares<2> fit;
+ * fit.add({1, 0}, 1);
+ * fit.add({1, 1}, 3);
+ * fit.add({1, 2}, 5);
+ * std::array<float, 2> coefficients;
+ * if (fit.solve(coefficients)) std::cout << coefficients[0] << ", " << coefficients[1] << std::endl; // 1, 2
+ * @endcode
+ */
+template <size_t N> class LeastSquares {
+    public:
+        /**
+         * @brief Add a sample
+         *
+         * @param inputs the inputs of the sample, one per coefficient
+         * @param output the measured output of the sample
+         */
+        void add(const std::array<float, N>& inputs, float output) {
+            for (size_t row = 0; row < N; row++) {
+                for (size_t col = 0; col < N; col++) normal[row][col] += double(inputs[row]) * inputs[col];
+                target[row] += double(inputs[row]) * output;
+            }
+            sumSquares += double(output) * output;
+            sum += output;
+            count++;
+        }
+
+        /**
+         * @brief Find the coefficients that fit the samples best
+         *
+         * @param coefficients where the coefficients are written
+         * @return true the coefficients were found
+         * @return false the samples don't determine every coefficient, e.g. an input was always 0
+         */
+        bool solve(std::array<float, N>& coefficients) const {
+            // gaussian elimination with partial pivoting on a copy of the normal equations
+            std::array<std::array<double, N + 1>, N> system;
+            for (size_t row = 0; row < N; row++) {
+                for (size_t col = 0; col < N; col++) system[row][col] = normal[row][col];
+                system[row][N] = target[row];
+            }
+            for (size_t col = 0; col < N; col++) {
+                size_t pivot = col;
+                for (size_t row = col + 1; row < N; row++) {
+                    if (std::fabs(system[row][col]) > std::fabs(system[pivot][col])) pivot = row;
+                }
+                if (std::fabs(system[pivot][col]) < 1e-9) return false;
+                std::swap(system[col], system[pivot]);
+                for (size_t row = 0; row < N; row++) {
+                    if (row == col) continue;
+                    const double factor = system[row][col] / system[col][col];
+                    for (size_t i = col; i <= N; i++) system[row][i] -= factor * system[col][i];
+                }
+            }
+            for (size_t row = 0; row < N; row++) coefficients[row] = system[row][N] / system[row][row];
+            return true;
+        }
+
+        /**
+         * @brief Find how well coefficients fit the samples
+         *
+         * @param coefficients the coefficients, usually from solve
+         * @return float the coefficient of determination (r squared). 1 is a perfect fit
+         */
+        float rSquared(const std::array<float, N>& coefficients) const {
+            if (count == 0) return 0;
+            // the residual sum of squares, expanded so it can be found from the accumulators
+            double residual = sumSquares;
+            for (size_t row = 0; row < N; row++) {
+                residual -= 2 * coefficients[row] * target[row];
+                for (size_t col = 0; col < N; col++)
+                    residual += coefficients[row] * normal[row][col] * coefficients[col];
+            }
+            const double total = sumSquares - sum * sum / count;
+            return total <= 0 ? 0 : 1 - residual / total;
+        }
+
+        /**
+         * @brief Get the number of samples
+         *
+         * @return size_t the number of samples
+         */
+        size_t size() const { return count; }
+    private:
+        std::array<std::array<double, N>, N> normal {};
+        std::array<double, N> target {};
+        double sumSquares = 0;
+        double sum = 0;
+        size_t count = 0;
+};
+} // namespace lemlib
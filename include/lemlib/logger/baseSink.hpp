@@ -1,15 +1,55 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <initializer_list>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include "pros/rtos.hpp"
 
-#define FMT_HEADER_ONLY
-#include "fmt/core.h"
+// format.h has the formatters of types with a format_as, like Pose. What it compiles to is in fmt.cpp, only once
+#include "fmt/format.h"
 #include "fmt/args.h"
 
+#include "lemlib/boundedQueue.hpp"
 #include "lemlib/logger/message.hpp"
+#include "lemlib/logger/rateLimit.hpp"
+
+/**
+ * @brief The lowest level that is compiled in. Messages below it are removed from the program entirely
+ *
+ * Set it to the name of a level when building, e.g. -DLEMLIB_MIN_LOG_LEVEL=WARN in EXTRA_CXXFLAGS, to strip debug
+ * and info messages out of competition builds
+ */
+#ifndef LEMLIB_MIN_LOG_LEVEL
+#define LEMLIB_MIN_LOG_LEVEL INFO
+#endif
 
 namespace lemlib {
+/**
+ * @brief The lowest level that is compiled in
+ */
+constexpr Level MIN_LOG_LEVEL = Level::LEMLIB_MIN_LOG_LEVEL;
+
+/**
+ * @brief Get the token of a format string, the 32 bit FNV-1a hash of its text
+ *
+ * firmware/logtokens.py hashes the string literals in the source the same way, to make the dictionary that turns
+ * tokenized messages back into text. It is constexpr, so the hash of a literal can be folded at compile time
+ *
+ * @param format the format string
+ * @return uint32_t the token
+ */
+constexpr uint32_t logToken(std::string_view format) {
+    uint32_t hash = 2166136261u;
+    for (const char c : format) hash = (hash ^ uint8_t(c)) * 16777619u;
+    return hash;
+}
+
 /**
  * @brief A base for any sink in LemLib to implement.
  *
@@ -50,10 +90,21 @@ class BaseSink {
          */
         void setLowestLevel(Level level);
 
+        /**
+         * @brief Check whether messages at a level would be logged
+         * If this is a combined sink, messages are logged if any of the parent sinks logs them.
+         *
+         * @param level the level
+         * @return true messages at the level are logged
+         * @return false messages at the level are ignored
+         */
+        bool isEnabled(Level level) const;
+
         /**
          * @brief Log a message at the given level
          * If this is a combined sink, this operation will
-         * apply for all the parent sinks.
+         * apply for all the parent sinks. The message is only formatted once, no matter how many sinks there are,
+         * so parent sinks don't defer it.
          *
          * @tparam T
          * @param level The level at which to send the message.
@@ -67,29 +118,157 @@ class BaseSink {
 
          */
         template <typename... T> void log(Level level, fmt::format_string<T...> format, T&&... args) {
-            if (!sinks.empty()) {
-                for (std::shared_ptr<BaseSink> sink : sinks) { sink->log(level, format, std::forward<T>(args)...); }
+            if (level < MIN_LOG_LEVEL) return;
+            // only the token and the arguments are sent, the text is rebuilt on the computer
+            if (tokenized.load(std::memory_order_relaxed)) {
+                if (!isEnabled(level)) return;
+                uint8_t payload[TOKEN_PAYLOAD_SIZE];
+                size_t size = TOKEN_HEADER_SIZE;
+                const bool fits = (packToken(payload, size, args) && ...);
+                const fmt::string_view text = format.get();
+                sendToken(level, logToken({text.data(), text.size()}), payload, fits ? size : 0, text,
+                          fmt::make_format_args(args...));
                 return;
             }
+            // copy the arguments for the formatting task, if they can be copied safely
+            if constexpr ((isDeferrable<T>() && ...) && argsSize<std::decay_t<T>...>() <= DEFERRED_ARGS_SIZE) {
+                if (sinks.empty() ? deferred && level >= lowestLevel : isDeferring() && isEnabled(level)) {
+                    DeferredMessage deferredMessage;
+                    deferredMessage.format = &formatDeferred<std::decay_t<T>...>;
+                    deferredMessage.formatString = format.get().data();
+                    deferredMessage.formatSize = format.get().size();
+                    deferredMessage.stamp = stampMessage(level);
+                    packArgs<std::decay_t<T>...>(deferredMessage.args, std::index_sequence_for<T...>(), args...);
+                    if (!sinks.empty()) logDeferred(deferredMessage, fmt::make_format_args(args...));
+                    else if (!deferredQueue->push(deferredMessage)) dropped++;
+                    return;
+                }
+            }
 
-            if (level < lowestLevel) { return; }
+            // only the arguments are captured here. The formatting is compiled once, in vlog
+            vlog(level, format.get(), fmt::make_format_args(args...));
+        }
 
-            // substitute the user's arguments into the format.
-            std::string messageString = fmt::format(format, std::forward<T>(args)...);
+        /**
+         * @brief Log a message whose arguments have already been captured
+         * If this is a combined sink, the message is formatted once, and each parent sink only adds its own format.
+         *
+         * Every log call that is formatted right away ends up here, so the code that formats messages is compiled
+         * once instead of in every file that logs. The message is always formatted here, since the arguments may
+         * not outlive the call, and sinks that defer only queue its text
+         *
+         * @param level the level at which to send the message
+         * @param format the format of the message
+         * @param args the arguments, from fmt::make_format_args
+         *
+         * <h3> Example Usage </h3>
+         * @code
+         * const int count = 3;
+         * sink.vlog(lemlib::Level::INFO, "{} paths loaded", fmt::make_format_args(count));
+         * @endcode
+         */
+        void vlog(Level level, fmt::string_view format, fmt::format_args args);
+
+        /**
+         * @brief Format messages on a background task instead of the task that logs them
+         *
+         * A deferred log call only copies the format string and the arguments into a preallocated queue, so logging
+         * in a control loop takes well under a microsecond. Messages with arguments that aren't safe to copy, like
+         * strings and pointers, are formatted right away, and only their text is queued. Messages are dropped if the
+         * queue fills up, and the number dropped is logged once there is room.
+         *
+         * Each sink has its own queue and task, so a slow destination, like an SD card, only holds up its own
+         * messages. A combined sink copies each message into the queue of every parent that defers, and formats it
+         * once for the parents that don't.
+         * If this is a combined sink, this operation will apply for all the parent sinks.
+         *
+         * @note the format string of a deferred message must be a string literal
+         *
+         * <h3> Example Usage </h3>
+         * @code
+         * lemlib::infoSink()->setDeferred(true);
+         * // only copies the pose, the formatting happens on another task
+         * lemlib::infoSink()->info("pose: {}", chassis.getPose());
+         * @endcode
+         *
+         * @param deferred whether messages are formatted on a background task
+         */
+        void setDeferred(bool deferred);
 
-            Message message = Message {.level = level, .time = pros::millis()};
+        /**
+         * @brief Set the priority of the task that formats and sends the deferred messages of this sink
+         *
+         * Sinks whose destination is slow, or that aren't urgent, can run below the others, so they never hold up
+         * the sinks that are. The task starts at the logger priority of the task configuration.
+         * If this is a combined sink, this operation will apply for all the parent sinks.
+         *
+         * <h3> Example Usage </h3>
+         * @code
+         * static auto sdSink = std::make_shared<lemlib::SdSink>("match");
+         * sdSink->setDeferred(true);
+         * // the SD card only writes when nothing else needs to run
+         * sdSink->setDeferredPriority(TASK_PRIORITY_MIN + 1);
+         * @endcode
+         *
+         * @param priority the priority of the task
+         */
+        void setDeferredPriority(uint32_t priority);
 
-            // get the arguments
-            fmt::dynamic_format_arg_store<fmt::format_context> formattingArgs = getExtraFormattingArgs(message);
+        /**
+         * @brief Check whether messages are formatted on a background task
+         * If this is a combined sink, messages are deferred if any of the parent sinks defers them.
+         *
+         * @return true messages are deferred
+         * @return false messages are formatted when they are logged
+         */
+        bool isDeferring() const;
 
-            formattingArgs.push_back(fmt::arg("time", message.time));
-            formattingArgs.push_back(fmt::arg("level", message.level));
-            formattingArgs.push_back(fmt::arg("message", messageString));
+        /**
+         * @brief Also send every message this sink logs to another sink, like a flight recorder
+         *
+         * The tap gets the message without this sink's format, and only if it logs the level too. Messages below the
+         * lowest level of this sink never reach the tap.
+         *
+         * <h3> Example Usage </h3>
+         * @code
+         * static lemlib::FlightRecorder recorder;
+         * lemlib::infoSink()->setTap(&recorder);
+         * @endcode
+         *
+         * @param tap the sink, or nullptr to stop. It must outlive this sink
+         */
+        void setTap(BaseSink* tap);
 
-            std::string formattedString = fmt::vformat(logFormat, std::move(formattingArgs));
-            message.message = std::move(formattedString);
-            sendMessage(std::move(message));
-        }
+        /**
+         * @brief Send messages as the token of their format string and their arguments in binary, instead of text
+         *
+         * Most of a log message is its format string, which never changes. A tokenized message is a TOKEN frame on
+         * binary telemetry with the level, the logToken of the format string, and the arguments, which is a fraction
+         * of the size of the text. Numbers are sent as they are, with doubles as floats, and anything else, like a
+         * pose, is formatted on its own and sent as text. Messages whose arguments don't fit in a frame are sent as
+         * MESSAGE frames.
+         *
+         * Tokenized messages go to the terminal, instead of wherever the sink sends messages. The tap still gets the
+         * text. firmware/telemetry.py turns them back into text with a dictionary made by firmware/logtokens.py from
+         * the source, which `make tokens` writes to bin/logtokens.json.
+         * If this is a combined sink, this operation will apply for all the parent sinks.
+         *
+         * @note format strings are matched by their text, so the dictionary has to be made from the same source
+         *
+         * <h3> Example Usage </h3>
+         * @code
+         * lemlib::infoSink()->setTokenized(true);
+         * // sends a 24 byte frame instead of about 60 bytes of text
+         * lemlib::infoSink()->info("lateralOut: {} angularOut: {}", lateralOut, angularOut);
+         * @endcode
+         * @code{.sh}
+         * make tokens
+         * pros terminal --raw | python3 firmware/telemetry.py --tokens bin/logtokens.json
+         * @endcode
+         *
+         * @param tokenized whether messages are tokenized
+         */
+        void setTokenized(bool tokenized);
 
         /**
          * @brief Log a message at the debug level.
@@ -166,6 +345,9 @@ class BaseSink {
          * Changing the format of the sink changes the way each logged message looks. The following named formatting
          * specifiers can be used:
          * - {time} The time the message was sent in milliseconds since the program started.
+         * - {micros} The time the message was sent in microseconds since the program started.
+         * - {sequence} The number of messages logged before this one, by any sink.
+         * - {task} The name of the task that logged the message.
          * - {level} The level of the logged message.
          * - {message} The message itself.
          *
@@ -201,9 +383,248 @@ class BaseSink {
          */
         virtual fmt::dynamic_format_arg_store<fmt::format_context> getExtraFormattingArgs(const Message& messageInfo);
     private:
+        /** bytes of arguments a deferred message can hold */
+        static constexpr size_t DEFERRED_ARGS_SIZE = 48;
+        /** longest text a deferred message can hold. Longer text that was formatted when it was logged is cut off */
+        static constexpr size_t DEFERRED_TEXT_SIZE = 128;
+        /** number of deferred messages that can wait for the formatting task */
+        static constexpr size_t DEFERRED_QUEUE_DEPTH = 64;
+        /** bytes of a tokenized message, the largest binary telemetry payload */
+        static constexpr size_t TOKEN_PAYLOAD_SIZE = 58;
+        /** bytes in front of the arguments of a tokenized message, the level and the token */
+        static constexpr size_t TOKEN_HEADER_SIZE = 5;
+
+        /**
+         * @brief A message whose arguments haven't been formatted yet
+         */
+        struct DeferredMessage {
+                /** formats the message. Knows the types of the arguments. nullptr if the message has its text */
+                std::string (*format)(const DeferredMessage& message) = nullptr;
+                /** the format string, which is a string literal */
+                const char* formatString = nullptr;
+                size_t formatSize = 0;
+                /** when and where the message was logged, always without the text, so queueing doesn't allocate */
+                Message stamp {};
+
+                union {
+                        /** the arguments, copied byte for byte */
+                        alignas(8) unsigned char args[DEFERRED_ARGS_SIZE];
+                        /** the text, if the message was formatted when it was logged */
+                        char text[DEFERRED_TEXT_SIZE];
+                };
+
+                /** length of the text */
+                size_t textSize = 0;
+        };
+
+        /**
+         * @brief Whether an argument can be copied and formatted later
+         *
+         * Pointers and string views could point to memory that is gone by the time the message is formatted
+         */
+        template <typename T> static constexpr bool isDeferrable() {
+            using Type = std::decay_t<T>;
+            return std::is_trivially_copyable_v<Type> && !std::is_pointer_v<Type> &&
+                   !std::is_same_v<Type, std::string_view> && !std::is_same_v<Type, fmt::string_view> &&
+                   alignof(Type) <= 8;
+        }
+
+        /**
+         * @brief Find where each argument is stored in a deferred message
+         */
+        template <typename... T> static constexpr std::array<size_t, sizeof...(T) + 1> argOffsets() {
+            constexpr size_t sizes[] = {sizeof(T)..., 0};
+            constexpr size_t alignments[] = {alignof(T)..., 1};
+            std::array<size_t, sizeof...(T) + 1> offsets {};
+            size_t offset = 0;
+            for (size_t i = 0; i <= sizeof...(T); i++) {
+                offset = (offset + alignments[i] - 1) / alignments[i] * alignments[i];
+                offsets[i] = offset;
+                offset += sizes[i];
+            }
+            return offsets;
+        }
+
+        /**
+         * @brief Get the number of bytes the arguments take up in a deferred message
+         */
+        template <typename... T> static constexpr size_t argsSize() { return argOffsets<T...>()[sizeof...(T)]; }
+
+        /**
+         * @brief Copy arguments into a deferred message
+         */
+        template <typename... T, size_t... I, typename... Args>
+        static void packArgs([[maybe_unused]] unsigned char* buffer, std::index_sequence<I...>, const Args&... args) {
+            // unused when there are no arguments
+            [[maybe_unused]] constexpr std::array<size_t, sizeof...(T) + 1> offsets = argOffsets<T...>();
+            (std::memcpy(buffer + offsets[I], &args, sizeof(T)), ...);
+        }
+
+        /**
+         * @brief Format a deferred message with the types it was logged with
+         */
+        template <typename... T> static std::string formatDeferred(const DeferredMessage& message) {
+            return unpackArgs<T...>(message, std::index_sequence_for<T...>());
+        }
+
+        template <typename... T, size_t... I>
+        static std::string unpackArgs(const DeferredMessage& message, std::index_sequence<I...>) {
+            [[maybe_unused]] constexpr std::array<size_t, sizeof...(T) + 1> offsets = argOffsets<T...>();
+            // the arguments are trivially copyable and were copied to aligned offsets, so they can be read in place
+            return fmt::format(fmt::runtime(std::string_view(message.formatString, message.formatSize)),
+                               *reinterpret_cast<const T*>(message.args + offsets[I])...);
+        }
+
+        /**
+         * @brief Add a value to a tokenized message, after the character for its type
+         *
+         * @return false the value doesn't fit
+         */
+        static bool putToken(uint8_t* payload, size_t& size, char type, const void* value, size_t bytes);
+
+        /**
+         * @brief Add text to a tokenized message, after its length as a uint8
+         *
+         * @return false the text doesn't fit
+         */
+        static bool putTokenText(uint8_t* payload, size_t& size, std::string_view text);
+
+        /**
+         * @brief Add an argument to a tokenized message. The type characters are the ones Python's struct uses
+         *
+         * @return false the argument doesn't fit
+         */
+        template <typename T> static bool packToken(uint8_t* payload, size_t& size, const T& arg) {
+            using Type = std::decay_t<T>;
+            if constexpr (std::is_same_v<Type, bool> || std::is_same_v<Type, char>) {
+                return putToken(payload, size, std::is_same_v<Type, bool> ? '?' : 'c', &arg, 1);
+            } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+                if constexpr (sizeof(Type) <= 4) {
+                    const int32_t value = arg;
+                    return putToken(payload, size, 'i', &value, sizeof(value));
+                } else {
+                    const int64_t value = arg;
+                    return putToken(payload, size, 'q', &value, sizeof(value));
+                }
+            } else if constexpr (std::is_integral_v<Type>) {
+                if constexpr (sizeof(Type) <= 4) {
+                    const uint32_t value = arg;
+                    return putToken(payload, size, 'I', &value, sizeof(value));
+                } else {
+                    const uint64_t value = arg;
+                    return putToken(payload, size, 'Q', &value, sizeof(value));
+                }
+            } else if constexpr (std::is_floating_point_v<Type>) {
+                const float value = arg;
+                return putToken(payload, size, 'f', &value, sizeof(value));
+            } else if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+                return putTokenText(payload, size, std::string_view(arg));
+            } else {
+                return putTokenText(payload, size, fmt::format("{}", arg));
+            }
+        }
+
+        /**
+         * @brief Queue a formatted message for each parent sink that defers, and send it to the rest
+         *
+         * @param stamp when and where the message was logged, with the text
+         */
+        void logText(const Message& stamp);
+
+        /**
+         * @brief Queue a deferred message for each parent sink that defers, and send it to the rest
+         *
+         * @param message the message, with its arguments copied
+         * @param args the arguments, from fmt::make_format_args, for the parents that don't defer
+         */
+        void logDeferred(const DeferredMessage& message, fmt::format_args args);
+
+        /**
+         * @brief Send a tokenized message, and its text to the tap
+         *
+         * @param level the level of the message
+         * @param token the token of the format string
+         * @param payload the packed arguments, after room for the level and the token
+         * @param size the size of the payload, in bytes. 0 if the arguments didn't fit, so the text is sent instead
+         * @param format the format of the message
+         * @param args the arguments, from fmt::make_format_args
+         */
+        void sendToken(Level level, uint32_t token, uint8_t* payload, size_t size, fmt::string_view format,
+                       fmt::format_args args);
+
+        /**
+         * @brief Add the sink's format to a formatted message and send it
+         * If this is a combined sink, the message is sent by each parent sink that logs its level.
+         *
+         * @param stamp when and where the message was logged, without the text
+         * @param messageString the message, with the user's arguments substituted
+         */
+        void send(const Message& stamp, const std::string& messageString);
+
+        /** whether messages are formatted on the formatting task */
+        std::atomic<bool> deferred = false;
+        /** messages waiting for the formatting task. Created the first time messages are deferred */
+        BoundedQueue<DeferredMessage>* deferredQueue = nullptr;
+        /** task that formats deferred messages */
+        pros::Task* deferredTask = nullptr;
+        /** priority of the formatting task. 0 for the logger priority of the task configuration */
+        std::atomic<uint32_t> deferredPriority = 0;
+        /** number of deferred messages dropped because the queue was full */
+        std::atomic<uint32_t> dropped = 0;
+        /** sink that gets a copy of every message. nullptr if there isn't one */
+        std::atomic<BaseSink*> tap = nullptr;
+        /** whether messages are sent as tokens */
+        std::atomic<bool> tokenized = false;
+
         Level lowestLevel = Level::WARN;
         std::string logFormat;
 
         std::vector<std::shared_ptr<BaseSink>> sinks {};
 };
 } // namespace lemlib
+
+/**
+ * @brief Log a message, only evaluating the arguments if the message would be logged
+ *
+ * Arguments to a log method are evaluated before the method can check the level, so expensive arguments are paid
+ * for even when the message is ignored. This checks the level first, and removes the call entirely if the level is
+ * below LEMLIB_MIN_LOG_LEVEL
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // toHex is only called if the info sink logs debug messages
+ * LEMLIB_LOG(lemlib::infoSink(), lemlib::Level::DEBUG, "raw data: {}", toHex(data));
+ * @endcode
+ */
+#define LEMLIB_LOG(sink, level, ...)                                                                                   \
+    do {                                                                                                               \
+        if constexpr ((level) >= ::lemlib::MIN_LOG_LEVEL) {                                                            \
+            auto&& lemlibLogSink = (sink);                                                                             \
+            if (lemlibLogSink->isEnabled(level)) lemlibLogSink->log(level, __VA_ARGS__);                               \
+        }                                                                                                              \
+    } while (0)
+
+/**
+ * @brief Log a message at most a few times per second from this line, like LEMLIB_LOG
+ *
+ * Meant for logs in loops that run every 10 ms. Messages over the limit are counted, and the count is logged the
+ * next time a message gets through
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // at most 5 messages per second, no matter how fast the loop runs
+ * LEMLIB_LOG_EVERY(lemlib::infoSink(), lemlib::Level::DEBUG, 5, "error: {}", error);
+ * @endcode
+ */
+#define LEMLIB_LOG_EVERY(sink, level, perSecond, ...)                                                                  \
+    do {                                                                                                               \
+        if constexpr ((level) >= ::lemlib::MIN_LOG_LEVEL) {                                                            \
+            static ::lemlib::RateLimit lemlibRateLimit(perSecond);                                                     \
+            auto&& lemlibLogSink = (sink);                                                                             \
+            uint32_t lemlibSuppressed;                                                                                 \
+            if (lemlibLogSink->isEnabled(level) && lemlibRateLimit.allow(pros::millis(), lemlibSuppressed)) {          \
+                if (lemlibSuppressed > 0) lemlibLogSink->log(level, "{} messages suppressed", lemlibSuppressed);       \
+                lemlibLogSink->log(level, __VA_ARGS__);                                                                \
+            }                                                                                                          \
+        }                                                                                                              \
+    } while (0)
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <string_view>
+#include "lemlib/logger/buffer.hpp"
+#include "lemlib/logger/message.hpp"
+
+namespace lemlib {
+/**
+ * @brief The type of a binary telemetry record, and the fields it holds. Every field is a little endian float32
+ * unless noted otherwise
+ */
+enum class TelemetryType : uint8_t {
+    POSE = 1, /** x and y in inches, theta in degrees */
+    VELOCITY = 2, /** forwards velocity in inches per second, angular velocity in radians per second */
+    MOTOR_OUTPUT = 3, /** power of the left and right sides of the drivetrain */
+    PID = 4, /** the controller as a uint8, then the error and the P, I, and D terms */
+    /**
+     * x, y, theta, and the x and y of the target as int16 in hundredths of an inch or degree. theta is between -180
+     * and 180. The target is INT16_MIN if there isn't one
+     */
+    POSE_KEYFRAME = 5,
+    /** the change of each field of the last POSE_KEYFRAME or POSE_DELTA, as int8 in hundredths */
+    POSE_DELTA = 6,
+    /** a MotionSample, laid out as described by MotionTrace */
+    MOTION = 7,
+    /**
+     * the readings of an odometry update before they were aligned: vertical1, vertical2, horizontal1, and horizontal2
+     * in inches, and the inertial sensor in radians
+     */
+    SENSOR_FRAME = 8,
+    /**
+     * a log message: the Level as a uint8, the sequence number as a uint32, the time in microseconds as a uint64, then
+     * the text, cut off to fit
+     */
+    MESSAGE = 9,
+    /**
+     * the Level as a uint8, the logToken of the format string as a uint32, then each argument as a character for its
+     * type and the value. See BaseSink::setTokenized
+     */
+    TOKEN = 10,
+    /**
+     * the lookahead point of pure pursuit: x and y in inches, how far along the path it is, the curvature of the arc
+     * to it, and the target velocity. How far along is in inches, or the parameter of a spline path
+     */
+    PATH = 11,
+    /** a MotionSummary, laid out as described by MotionLog */
+    MOTION_SUMMARY = 12,
+    /**
+     * the answer to a clock sync request: the sequence number of the request as a uint32, then the time the host
+     * sent it in its own clock, the time the brain received it, and the time the brain answered it, as uint64 in
+     * microseconds. See BinaryTelemetry::sendClockSync
+     */
+    CLOCK_SYNC = 13
+};
+
+/**
+ * @brief A group of binary telemetry records that can be turned on or off, or slowed down, on its own
+ */
+enum class TelemetryChannel : uint8_t {
+    ODOM, /** POSE and VELOCITY, every iteration of the motion loop */
+    MOTION, /** MOTION, every iteration of a motion */
+    MOTORS, /** MOTOR_OUTPUT, every time the chassis drives */
+    PID, /** PID, for the lateral (0) and angular (1) controllers every iteration of the motion loop */
+    PATH /** PATH, every iteration of pure pursuit */
+};
+
+/** the number of telemetry channels */
+constexpr size_t TELEMETRY_CHANNELS = 5;
+
+/**
+ * @brief Binary telemetry, for sending lots of data to a computer
+ *
+ * Records are sent as fixed layout little endian fields instead of text, so they are smaller and don't need to be
+ * formatted. Each frame is the record type, the time in milliseconds, the record, and a CRC-16/CCITT, COBS encoded
+ * so the frame contains no zero bytes, followed by a zero byte. A decoder can find the start of every frame, even
+ * when it is mixed with text from the other sinks, and the CRC throws away anything that isn't a frame.
+ * firmware/telemetry.py decodes the frames into CSV
+ *
+ * While it is enabled, the chassis sends its pose and velocity every iteration of the motion loop, and the power
+ * every time it drives. The records are grouped into channels, which can be turned off or slowed down on their own
+ * to spend the bandwidth of the link on what is being debugged. A channel that is off only costs a branch where it
+ * would have been recorded. TuningConsole changes the channels from the terminal
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::binaryTelemetry().setEnabled(true);
+ * // only the pose, 10 times a second, and the motors
+ * lemlib::binaryTelemetry().setChannel(lemlib::TelemetryChannel::ODOM, true, 100);
+ * lemlib::binaryTelemetry().setChannel(lemlib::TelemetryChannel::MOTION, false);
+ * lemlib::binaryTelemetry().setChannel(lemlib::TelemetryChannel::PID, false);
+ * lemlib::binaryTelemetry().setChannel(lemlib::TelemetryChannel::PATH, false);
+ * // records of your own
+ * lemlib::binaryTelemetry().sendPid(0, error, p, i, d);
+ * @endcode
+ */
+class BinaryTelemetry {
+    public:
+        /** largest payload of any record, in bytes */
+        static constexpr size_t MAX_PAYLOAD = 58;
+        /** largest encoded frame, including the zero byte that ends it */
+        static constexpr size_t MAX_ENCODED = 1 + 4 + MAX_PAYLOAD + 2 + 2;
+
+        /**
+         * @brief Construct a new Binary Telemetry object
+         *
+         * @param buffer the buffer frames are sent through
+         */
+        BinaryTelemetry(Buffer& buffer);
+        /**
+         * @brief Send the pose of the robot
+         *
+         * @param x x position, in inches
+         * @param y y position, in inches
+         * @param theta heading, in degrees
+         */
+        void sendPose(float x, float y, float theta);
+        /**
+         * @brief Send the velocity of the robot
+         *
+         * @param linear forwards velocity, in inches per second
+         * @param angular angular velocity, in radians per second
+         */
+        void sendVelocity(float linear, float angular);
+        /**
+         * @brief Send the power sent to the drivetrain
+         *
+         * @param left power of the left side
+         * @param right power of the right side
+         */
+        void sendMotorOutput(float left, float right);
+        /**
+         * @brief Send the terms of a PID controller
+         *
+         * @param controller a number for the controller, so the decoder can tell controllers apart
+         * @param error the error
+         * @param p the proportional term
+         * @param i the integral term
+         * @param d the derivative term
+         */
+        void sendPid(uint8_t controller, float error, float p, float i, float d);
+        /**
+         * @brief Send the lookahead point of pure pursuit
+         *
+         * @param x x position of the lookahead point, in inches
+         * @param y y position of the lookahead point, in inches
+         * @param distance how far along the path the lookahead point is, in inches or the parameter of a spline
+         * @param curvature curvature of the arc to the lookahead point
+         * @param velocity the target velocity
+         */
+        void sendPath(float x, float y, float distance, float curvature, float velocity);
+        /**
+         * @brief Answer a clock sync request from the host, whether or not binary telemetry is on
+         *
+         * The host stamps the request when it sends it and the answer when it arrives, so with the times the brain
+         * stamps, each round trip gives the offset between the clocks like NTP: the average of the time the request
+         * took to arrive and the time the answer took, each measured across both clocks. The round trips that took
+         * the least time were delayed the least by the buffers, and bound the offset the closest.
+         * firmware/clocksync.py sends the requests through TuningConsole, and puts every record on the host clock
+         *
+         * @param sequence the sequence number of the request
+         * @param hostTime the time the host sent the request, in microseconds of its own clock
+         * @param receiveTime the time the brain received the request, in microseconds
+         */
+        void sendClockSync(uint32_t sequence, uint64_t hostTime, uint64_t receiveTime);
+        /**
+         * @brief Turn a channel on or off, and set how often its records are sent
+         *
+         * Channels are on by default, and only send records while binary telemetry is on
+         *
+         * @param channel the channel
+         * @param enabled whether its records are sent
+         * @param period least time between the records of each type, in milliseconds. Records in the same
+         * millisecond are all sent, so records taken together stay together. 0 to send every record, the default
+         */
+        void setChannel(TelemetryChannel channel, bool enabled, uint32_t period = 0);
+        /**
+         * @brief Turn a channel on or off by its name: odom, motion, motors, pid, or path
+         *
+         * @param name the name of the channel
+         * @param enabled whether its records are sent
+         * @param period least time between records, in milliseconds. 0 to send every record
+         * @return true the channel was changed
+         * @return false there is no channel with that name
+         */
+        bool setChannel(std::string_view name, bool enabled, uint32_t period = 0);
+        /**
+         * @brief Check whether binary telemetry and a channel are on. Only a load and a branch
+         *
+         * @param channel the channel
+         * @return true the records of the channel are sent, at its rate
+         * @return false the records of the channel are ignored
+         */
+        bool isEnabled(TelemetryChannel channel) const {
+            return channels[size_t(channel)].open.load(std::memory_order_relaxed);
+        }
+        /**
+         * @brief Check whether a record of a channel should be sent now, by whether the channel is on and its rate
+         *
+         * @param channel the channel
+         * @return true send the record
+         * @return false skip the record
+         */
+        bool isDue(TelemetryChannel channel) { return isEnabled(channel) && checkRate(channel); }
+        /**
+         * @brief Turn binary telemetry on or off. It is off by default, so the terminal isn't filled with frames
+         *
+         * @param enabled whether records are sent
+         */
+        void setEnabled(bool enabled);
+        /**
+         * @brief Check whether binary telemetry is on
+         *
+         * @return true records are sent
+         * @return false records are ignored
+         */
+        bool isEnabled() const;
+        /**
+         * @brief Frame a record and send it, whether or not binary telemetry is on
+         *
+         * For streams with their own switch, like PoseStream
+         *
+         * @param type the type of the record
+         * @param payload the fields of the record, already little endian
+         * @param size the size of the payload, in bytes. At most MAX_PAYLOAD
+         */
+        void sendFrame(TelemetryType type, const uint8_t* payload, size_t size);
+        /**
+         * @brief Frame a record that was taken at an earlier time and send it, whether or not binary telemetry is on
+         *
+         * @param type the type of the record
+         * @param payload the fields of the record, already little endian
+         * @param size the size of the payload, in bytes. At most MAX_PAYLOAD
+         * @param time the time of the record, in milliseconds
+         */
+        void sendFrame(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time);
+        /**
+         * @brief Frame a record without sending it, so it can be stored somewhere else, like the SD card
+         *
+         * @param type the type of the record
+         * @param payload the fields of the record, already little endian
+         * @param size the size of the payload, in bytes. At most MAX_PAYLOAD
+         * @param time the time of the record, in milliseconds
+         * @param out where the frame is written. Must hold MAX_ENCODED bytes
+         * @return size_t the size of the frame, including the zero byte that ends it
+         */
+        static size_t encodeFrame(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time,
+                                  uint8_t* out);
+        /**
+         * @brief Lay out a log message as a MESSAGE record, so it is recorded without formatting its stamp
+         *
+         * @param message the message
+         * @param out where the record is written. Must hold MAX_PAYLOAD bytes
+         * @return size_t the size of the record, in bytes
+         */
+        static size_t packMessage(const Message& message, uint8_t* out);
+        /**
+         * @brief Get the number of strings the buffer has dropped, frames or not
+         *
+         * @return uint32_t the number of strings
+         */
+        uint32_t getDropped();
+    private:
+        /**
+         * @brief Check whether the period of a channel has passed since its last record, and start the next one
+         */
+        bool checkRate(TelemetryChannel channel);
+        /**
+         * @brief Open or close the channels for the switch of binary telemetry and their own
+         */
+        void updateChannels();
+
+        /**
+         * @brief The state of a channel
+         */
+        struct Channel {
+                /** binary telemetry and the channel are both on */
+                std::atomic<bool> open = false;
+                std::atomic<bool> enabled = true;
+                std::atomic<uint32_t> period = 0;
+                /** the time the last record was sent, in milliseconds */
+                std::atomic<uint32_t> last = 0;
+        };
+
+        Buffer& buffer;
+        std::atomic<bool> enabled = false;
+        Channel channels[TELEMETRY_CHANNELS];
+};
+
+/**
+ * @brief Get the binary telemetry, which sends frames through bufferedStdout
+ *
+ * @return BinaryTelemetry&
+ */
+BinaryTelemetry& binaryTelemetry();
+} // namespace lemlib
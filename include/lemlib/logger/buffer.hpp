@@ -1,25 +1,56 @@
 #pragma once
 
-#include <deque>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "pros/rtos.hpp"
 
 namespace lemlib {
+/**
+ * @brief What a buffer does with a string that doesn't fit
+ */
+enum class DropPolicy {
+    DROP_NEWEST, /** the new string is dropped */
+    DROP_OLDEST /** the oldest strings are dropped until the new string fits */
+};
+
+/**
+ * @brief Statistics of a buffer, for checking whether it is big enough
+ */
+struct BufferStats {
+        /** number of strings dropped because the buffer was full */
+        uint32_t dropped = 0;
+        /** most bytes the buffer has held at once */
+        size_t highWaterMark = 0;
+        /** number of bytes processed */
+        uint64_t bytesSent = 0;
+};
+
 /**
  * @brief A buffer implementation
  *
- * Asynchronously processes a backlog of strings at a given rate. The strings are processed in a first in last out
- * order.
+ * Asynchronously processes a backlog of strings at a given rate. The strings are processed in a first in first out
+ * order. Every cycle, all of the pending strings are joined and processed at once, up to the byte budget, so the
+ * throughput depends on how many bytes the output can take, not on how many messages there are.
+ *
+ * Strings are stored in a fixed size ring of bytes that is allocated once, so a burst of messages can't use up the
+ * heap. When the ring is full, strings are dropped by the drop policy.
  */
 class Buffer {
     public:
         /**
          * @brief Construct a new Buffer object
          *
+         * @param bufferFunc the function that processes the strings
+         * @param capacity the size of the ring, in bytes. Each string takes 2 bytes more than its length
+         * @param policy what to do with strings that don't fit
          */
-        Buffer(std::function<void(const std::string&)> bufferFunc);
+        Buffer(std::function<void(const std::string&)> bufferFunc, size_t capacity = 4096,
+               DropPolicy policy = DropPolicy::DROP_NEWEST);
 
         /**
          * @brief Destroy the Buffer object
@@ -33,9 +64,10 @@ class Buffer {
         /**
          * @brief Push to the buffer
          *
+         * Strings are processed without the mutex held, so this only waits for other tasks pushing to the buffer
          * @param bufferData
          */
-        void pushToBuffer(const std::string& bufferData);
+        void pushToBuffer(std::string_view bufferData);
 
         /**
          * @brief Set the rate of the sink
@@ -45,7 +77,30 @@ class Buffer {
         void setRate(uint32_t rate);
 
         /**
-         * @brief Check to see if the internal buffer is empty
+         * @brief Set the most bytes processed each cycle
+         *
+         * A string longer than the budget is still processed, on its own
+         *
+         * @param bytes the budget, in bytes. 0 for no limit
+         */
+        void setByteBudget(size_t bytes);
+
+        /**
+         * @brief Set what to do with strings that don't fit
+         *
+         * @param policy the drop policy
+         */
+        void setDropPolicy(DropPolicy policy);
+
+        /**
+         * @brief Get the statistics of the buffer
+         *
+         * @return BufferStats the statistics
+         */
+        BufferStats getStats();
+
+        /**
+         * @brief Check to see if the internal buffer is empty, and everything taken from it has been processed
          *
          */
         bool buffersEmpty();
@@ -60,13 +115,40 @@ class Buffer {
          * @brief The function that will be applied to each string in the buffer when it is removed.
          *
          */
-        std::function<void(std::string)> bufferFunc;
+        std::function<void(const std::string&)> bufferFunc;
+
+        /**
+         * @brief Copy bytes out of the ring, starting at an offset. Wraps around the end of the ring
+         */
+        void readRing(size_t offset, char* out, size_t size) const;
 
-        std::deque<std::string> buffer = {};
+        /**
+         * @brief Get the length of the oldest string in the ring
+         */
+        size_t frontLength() const;
+
+        /**
+         * @brief Remove the oldest string from the ring
+         */
+        void popFront();
+
+        /** the strings, each stored as a 2 byte length followed by its characters */
+        std::vector<char> ring;
+        /** offset of the oldest string in the ring */
+        size_t head = 0;
+        /** number of bytes used in the ring */
+        size_t used = 0;
+        /** the strings taken from the ring to be processed. Only used by the task */
+        std::string batch;
+        DropPolicy policy;
+        BufferStats stats;
+        /** whether a batch taken from the buffer is still being processed */
+        bool writing = false;
+
+        uint32_t rate = 50;
+        size_t byteBudget = 1024;
 
         pros::Mutex mutex;
         pros::Task task;
-
-        uint32_t rate;
 };
 } // namespace lemlib
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "pros/misc.h"
+#include "pros/rtos.hpp"
+#include "lemlib/logger/message.hpp"
+#include "lemlib/logger/baseSink.hpp"
+
+namespace lemlib {
+/**
+ * @brief Sink for showing messages and status on the controller screen
+ *
+ * The controller takes a new line of text at most once every 50 ms, and a write sent too early is dropped. The sink
+ * keeps a copy of what each of the 3 lines should say, and what was last sent. Changing a line only updates the
+ * copy, so logging and setLine never wait for the controller, and a line changed many times between writes is only
+ * sent once, with its newest text. A task of its own at the lowest priority sends one changed line per write,
+ * taking turns between the lines, and sends it again later if the controller didn't take it.
+ *
+ * Logged messages are shown on the bottom line, and the other lines can be set to anything with setLine. Lines are
+ * cut to the 19 characters that fit on the screen
+ *
+ * @note the sink is meant to live for the rest of the program, like the other sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * std::shared_ptr<lemlib::ControllerSink> screen = std::make_shared<lemlib::ControllerSink>();
+ *
+ * void opcontrol() {
+ *     while (true) {
+ *         // only sent when the pose changes, and never more often than the controller allows
+ *         const lemlib::Pose pose = chassis.getPose();
+ *         screen->setLine(0, "{:.1f} {:.1f} {:.0f}", pose.x, pose.y, pose.theta);
+ *         pros::delay(10);
+ *     }
+ * }
+ * // warnings show up on the bottom line
+ * screen->warn("motor hot");
+ * @endcode
+ */
+class ControllerSink : public BaseSink {
+    public:
+        /**
+         * @brief Construct a new Controller Sink
+         *
+         * @param controller the controller to write to. The master controller by default
+         */
+        ControllerSink(pros::controller_id_e_t controller = pros::E_CONTROLLER_MASTER);
+        ControllerSink(const ControllerSink&) = delete;
+        ControllerSink& operator=(const ControllerSink&) = delete;
+
+        /**
+         * @brief Set the text of a line
+         *
+         * @param line the line, from 0 at the top to 2 at the bottom
+         * @param format the format of the text. Use "{}" as placeholders
+         * @param args the values that will be substituted into the placeholders
+         */
+        template <typename... T> void setLine(uint8_t line, fmt::format_string<T...> format, T&&... args) {
+            char text[COLUMNS + 1];
+            const auto result = fmt::format_to_n(text, COLUMNS, format, std::forward<T>(args)...);
+            text[result.size < COLUMNS ? result.size : COLUMNS] = '\0';
+            setText(line, text);
+        }
+
+        /**
+         * @brief Set the text of a line, without formatting it
+         *
+         * @param line the line, from 0 at the top to 2 at the bottom
+         * @param text the text
+         */
+        void setText(uint8_t line, const char* text);
+
+        /**
+         * @brief The number of lines on the controller screen
+         */
+        static constexpr size_t LINES = 3;
+        /**
+         * @brief The number of characters that fit on a line
+         */
+        static constexpr size_t COLUMNS = 19;
+    private:
+        /**
+         * @brief Show the message on the bottom line
+         *
+         * @param message
+         */
+        void sendMessage(const Message& message) override;
+
+        /**
+         * @brief Send changed lines to the controller until the program ends. Runs on the sink's task
+         */
+        void taskLoop();
+
+        pros::controller_id_e_t controller;
+        /** what each line should say. Every line is padded with spaces, so sending it overwrites the whole line */
+        std::array<std::array<char, COLUMNS + 1>, LINES> wanted;
+        /** what was last sent to each line */
+        std::array<std::array<char, COLUMNS + 1>, LINES> shown;
+        /** the line that is checked first on the next write */
+        size_t nextLine = 0;
+
+        pros::Mutex mutex;
+        pros::Task task;
+};
+} // namespace lemlib
@@ -3,24 +3,42 @@
 #include <memory>
 #include <array>
 
-#define FMT_HEADER_ONLY
 #include "fmt/core.h"
 
 #include "lemlib/logger/baseSink.hpp"
 #include "lemlib/logger/infoSink.hpp"
 #include "lemlib/logger/telemetrySink.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+#include "lemlib/logger/poseStream.hpp"
+#include "lemlib/logger/sdSink.hpp"
+#include "lemlib/logger/controllerSink.hpp"
 
 namespace lemlib {
 
 /**
  * @brief Get the info sink.
- * @return std::shared_ptr<InfoSink>
+ *
+ * Returned by reference, so logging doesn't copy the shared_ptr and touch its reference count
+ * @return const std::shared_ptr<InfoSink>&
  */
-std::shared_ptr<InfoSink> infoSink();
+const std::shared_ptr<InfoSink>& infoSink();
 
 /**
  * @brief Get the telemetry sink.
- * @return std::shared_ptr<TelemetrySink>
+ *
+ * Returned by reference, so logging doesn't copy the shared_ptr and touch its reference count
+ * @return const std::shared_ptr<TelemetrySink>&
  */
-std::shared_ptr<TelemetrySink> telemetrySink();
+const std::shared_ptr<TelemetrySink>& telemetrySink();
 } // namespace lemlib
+
+/**
+ * @brief Log a debug message to the info sink, only evaluating the arguments if it would be logged
+ */
+#define LEMLIB_DEBUG(...) LEMLIB_LOG(::lemlib::infoSink(), ::lemlib::Level::DEBUG, __VA_ARGS__)
+
+/**
+ * @brief Log a debug message to the info sink at most a few times per second from this line
+ */
+#define LEMLIB_DEBUG_EVERY(perSecond, ...)                                                                             \
+    LEMLIB_LOG_EVERY(::lemlib::infoSink(), ::lemlib::Level::DEBUG, perSecond, __VA_ARGS__)
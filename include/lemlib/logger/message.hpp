@@ -2,6 +2,7 @@
 
 #include <string>
 #include <cstdint>
+#include "pros/rtos.h"
 
 namespace lemlib {
 /**
@@ -23,8 +24,27 @@ struct Message {
 
         /** The time the message was logged, in milliseconds */
         uint32_t time;
+
+        /** The time the message was logged, in microseconds, for lining it up with other records */
+        uint64_t micros;
+
+        /** The number of messages logged before this one by any sink, so messages logged together can be ordered */
+        uint32_t sequence;
+
+        /** The task that logged the message */
+        pros::task_t task;
 };
 
+/**
+ * @brief Make a message that is being logged now by this task, with the next sequence number and no text
+ *
+ * Nothing is formatted, so a message can be stamped where it is logged and formatted later
+ *
+ * @param level the level of the message
+ * @return Message the message, without the text
+ */
+Message stampMessage(Level level);
+
 /**
  * @brief Format a level
  *
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include "lemlib/pose.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings of a PoseStream
+ */
+struct PoseStreamSettings {
+        /** least time between poses, in milliseconds */
+        uint32_t minPeriod = 10;
+        /** most time between poses, in milliseconds. A robot that isn't moving is still sent this often */
+        uint32_t maxPeriod = 250;
+        /** how far the robot or the target has to move before a pose is sent, in inches */
+        float minDistance = 0.25;
+        /** how far the robot has to turn before a pose is sent, in degrees */
+        float minAngle = 1;
+        /** most deltas between keyframes, so a decoder that starts late or lost a frame catches up */
+        uint32_t keyframeInterval = 25;
+};
+
+/**
+ * @brief Streams the pose of the robot and the target it is driving to, for a path visualizer
+ *
+ * Poses are sent as binary telemetry records, in fixed point hundredths of an inch or degree. Most records are
+ * POSE_DELTA, the change since the last record in a byte per field, which is 14 bytes a frame instead of 21 for a
+ * POSE record. A POSE_KEYFRAME with the whole pose is sent first, when a change doesn't fit in a byte, when the
+ * target appears or goes away, every keyframeInterval records, and after the buffer drops anything. The deltas are
+ * between the rounded values, so rounding errors don't add up.
+ *
+ * A pose is only sent once the robot or the target has moved enough, so the rate follows the speed of the robot: up
+ * to every 10 ms while driving fast, and 4 times a second while still.
+ *
+ * While it is enabled, the chassis sends its pose every iteration of the motion loop, and follow sets the lookahead
+ * point as the target. firmware/telemetry.py decodes the records back into poses
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::poseStream().setEnabled(true);
+ * chassis.follow(myPath_txt, 15, 4000);
+ * @endcode
+ */
+class PoseStream {
+    public:
+        /**
+         * @brief Construct a new Pose Stream
+         *
+         * @param telemetry the binary telemetry the records are sent through. It doesn't have to be enabled
+         * @param settings the settings. Defaults are used if not given
+         */
+        PoseStream(BinaryTelemetry& telemetry, PoseStreamSettings settings = PoseStreamSettings());
+        /**
+         * @brief Send a pose, if it moved enough since the last one
+         *
+         * @param pose the pose of the robot, with theta in degrees
+         * @param time the time of the pose, in milliseconds
+         */
+        void update(Pose pose, uint32_t time);
+        /**
+         * @brief Set the target sent with each pose
+         *
+         * @param x x position, in inches. NAN if there is no target
+         * @param y y position, in inches
+         */
+        void setTarget(float x, float y);
+        /**
+         * @brief Turn the stream on or off. It is off by default
+         *
+         * @param enabled whether poses are sent
+         */
+        void setEnabled(bool enabled);
+        /**
+         * @brief Check whether the stream is on
+         *
+         * @return true poses are sent
+         * @return false poses are ignored
+         */
+        bool isEnabled() const;
+    private:
+        /** x, y, theta, and the x and y of the target, in hundredths */
+        using Fields = std::array<int32_t, 5>;
+
+        /**
+         * @brief Send a frame with the whole pose
+         */
+        void sendKeyframe(const Fields& fields);
+
+        BinaryTelemetry& telemetry;
+        PoseStreamSettings settings;
+        std::atomic<bool> enabled = false;
+        float targetX = NAN;
+        float targetY = NAN;
+        /** the last pose sent, rounded, which the next delta is from */
+        Fields last {};
+        uint32_t lastTime = 0;
+        /** deltas sent since the last keyframe. Starts full, so the first pose is a keyframe */
+        uint32_t deltas = UINT32_MAX;
+        uint32_t dropped = 0;
+};
+
+/**
+ * @brief Get the pose stream, which sends records through binaryTelemetry
+ *
+ * @return PoseStream&
+ */
+PoseStream& poseStream();
+} // namespace lemlib
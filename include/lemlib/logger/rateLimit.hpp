@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Limits how many times something happens per second, and counts the times it was stopped
+ *
+ * Used by LEMLIB_LOG_EVERY, which keeps one for each place it is used
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::RateLimit limit(5);
+ * uint32_t suppressed;
+ * if (limit.allow(pros::millis(), suppressed)) std::cout << "at most 5 per second" << std::endl;
+ * @endcode
+ */
+class RateLimit {
+    public:
+        /**
+         * @brief Construct a new Rate Limit
+         *
+         * @param perSecond the most times per second
+         */
+        constexpr RateLimit(uint32_t perSecond)
+            : perSecond(perSecond) {}
+
+        /**
+         * @brief Check whether it can happen now
+         *
+         * @param now the time, in milliseconds
+         * @param suppressed set to the number of times it was stopped in the last second, when it is allowed at the
+         * start of a new second. 0 otherwise
+         * @return true it can happen
+         * @return false it already happened too many times this second
+         */
+        bool allow(uint32_t now, uint32_t& suppressed) {
+            suppressed = 0;
+            uint32_t start = windowStart.load(std::memory_order_relaxed);
+            // a new second started. Only one task wins the exchange, so only one reports the suppressed count
+            if (count.load(std::memory_order_relaxed) == 0 || now - start >= 1000) {
+                if (windowStart.compare_exchange_strong(start, now, std::memory_order_relaxed)) {
+                    count.store(1, std::memory_order_relaxed);
+                    suppressed = dropped.exchange(0, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            if (count.fetch_add(1, std::memory_order_relaxed) < perSecond) return true;
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    private:
+        const uint32_t perSecond;
+        std::atomic<uint32_t> windowStart = 0;
+        std::atomic<uint32_t> count = 0;
+        std::atomic<uint32_t> dropped = 0;
+};
+} // namespace lemlib
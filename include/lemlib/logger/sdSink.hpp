@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "lemlib/logger/message.hpp"
+#include "lemlib/logger/baseSink.hpp"
+#include "lemlib/logger/sdWriter.hpp"
+
+namespace lemlib {
+/**
+ * @brief Sink for writing messages to files on the SD card
+ *
+ * Messages are written through an SdWriter, so logging never waits for the card. If both of its blocks are full, new
+ * messages are dropped and counted. Files are rotated when they reach the maximum size, so a long run doesn't end up
+ * in one huge file.
+ *
+ * @note the sink is meant to live for the rest of the program, like the other sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // writes /usd/match_000.log, /usd/match_001.log, ...
+ * std::shared_ptr<lemlib::SdSink> sd = std::make_shared<lemlib::SdSink>("match");
+ * sd->setLowestLevel(lemlib::Level::INFO);
+ * sd->info("pose: {}", chassis.getPose());
+ * // or log to the terminal and the card at once
+ * lemlib::BaseSink both({lemlib::infoSink(), sd});
+ * @endcode
+ */
+class SdSink : public BaseSink {
+    public:
+        /**
+         * @brief Construct a new SD Sink
+         *
+         * @param name the start of the file names. Files are named name_000.log, name_001.log, and so on, starting
+         * after the files already on the card
+         * @param maxFileSize the size a file can grow to before a new one is started, in bytes
+         */
+        SdSink(const std::string& name = "lemlib", size_t maxFileSize = 1 << 20);
+        /**
+         * @brief Get the number of messages dropped because both blocks were full
+         *
+         * @return uint32_t the number of messages
+         */
+        uint32_t getDropped() const;
+    private:
+        /**
+         * @brief Copy a message into the current block
+         *
+         * @param message
+         */
+        void sendMessage(const Message& message) override;
+
+        SdWriter writer;
+};
+} // namespace lemlib
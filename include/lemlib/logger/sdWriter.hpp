@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include "pros/rtos.hpp"
+#include "lemlib/taskMonitor.hpp"
+
+namespace lemlib {
+/**
+ * @brief Writes data to files on the SD card without making the caller wait for the card
+ *
+ * Data is copied into one of two blocks. When a block fills up, a low priority task writes it to the card in one
+ * write while data goes into the other block. If both blocks are full, new data is dropped and counted. Files are
+ * rotated when they reach the maximum size, so a long run doesn't end up in one huge file. Each write goes into a
+ * single block, so it is never split between 2 files.
+ *
+ * @note the writer is meant to live for the rest of the program, since its task references it
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * // writes /usd/data_000.csv, /usd/data_001.csv, ...
+ * lemlib::SdWriter writer("data", "csv");
+ * writer.write({"1,2,3", "\n"});
+ * @endcode
+ */
+class SdWriter {
+    public:
+        /** size of a block, and the largest write. A multiple of the SD card's sector size */
+        static constexpr size_t BLOCK_SIZE = 4096;
+
+        /**
+         * @brief Construct a new SD Writer
+         *
+         * @param name the start of the file names. Files are named name_000.extension, name_001.extension, and so
+         * on, starting after the files already on the card
+         * @param extension the extension of the file names
+         * @param maxFileSize the size a file can grow to before a new one is started, in bytes
+         * @param header written at the start of every file
+         */
+        SdWriter(const std::string& name, const std::string& extension, size_t maxFileSize = 1 << 20,
+                 const std::string& header = "");
+        SdWriter(const SdWriter&) = delete;
+        SdWriter& operator=(const SdWriter&) = delete;
+        /**
+         * @brief Copy data into the current block, one part after another
+         *
+         * @param parts the data. The parts are kept together in the same block
+         * @return true the data will be written
+         * @return false the data was dropped, because it is bigger than a block or both blocks are full
+         */
+        bool write(std::initializer_list<std::string_view> parts);
+        /**
+         * @brief Get the number of writes dropped because both blocks were full
+         *
+         * @return uint32_t the number of writes
+         */
+        uint32_t getDropped() const;
+    private:
+        /**
+         * @brief Write full blocks to the card, and write the current block if it hasn't filled up for a while
+         */
+        void taskLoop();
+        /**
+         * @brief Start writing the current block, and switch to the other one. The mutex must be held
+         *
+         * @return true the block will be written
+         * @return false the other block is still being written
+         */
+        bool swapBlocks();
+        /**
+         * @brief Open the next file, closing the current one
+         */
+        void openNextFile();
+
+        std::array<std::array<char, BLOCK_SIZE>, 2> blocks;
+        /** bytes in each block */
+        std::array<size_t, 2> used {};
+        /** the block data is copied into */
+        size_t current = 0;
+        /** the block waiting to be written, or -1 if there isn't one */
+        int pending = -1;
+        std::atomic<uint32_t> dropped = 0;
+
+        std::string name;
+        std::string extension;
+        std::string header;
+        size_t maxFileSize;
+        int fileIndex = 0;
+        size_t fileSize = 0;
+        FILE* file = nullptr;
+
+        pros::Mutex mutex;
+        TaskMonitor monitor {"sd writer"};
+        pros::Task task;
+};
+} // namespace lemlib
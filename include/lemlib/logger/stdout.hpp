@@ -1,6 +1,5 @@
 #pragma once
 
-#define FMT_HEADER_ONLY
 #include "fmt/core.h"
 
 #include "lemlib/logger/buffer.hpp"
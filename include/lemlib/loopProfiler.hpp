@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace lemlib {
+/**
+ * @brief Percentiles of a timing, in microseconds
+ *
+ * Percentiles are the top of the histogram bucket they fall in, so they are rounded up to the bucket width
+ */
+struct TimingStats {
+        /** median */
+        uint32_t p50 = 0;
+        /** 99th percentile */
+        uint32_t p99 = 0;
+        /** longest */
+        uint32_t max = 0;
+};
+
+/**
+ * @brief Get the exact percentiles of a set of timings, for timings that are kept instead of put in a histogram
+ *
+ * @param samples the timings. Sorted in place
+ * @param count number of timings
+ * @return TimingStats the percentiles, all 0 if there are no timings
+ */
+TimingStats timingStats(uint32_t* samples, size_t count);
+
+/**
+ * @brief Timing statistics of a control loop
+ */
+struct LoopStats {
+        /** time each iteration spent running, from waking up to starting to wait for the next iteration */
+        TimingStats compute;
+        /** how long after it was due each iteration woke up */
+        TimingStats lateness;
+        /** number of iterations recorded */
+        uint32_t iterations = 0;
+        /** number of iterations that ran for longer than the period */
+        uint32_t overruns = 0;
+};
+
+/**
+ * @brief Records how long the iterations of a control loop take, and how late they start
+ *
+ * Timings go into fixed histograms, so recording an iteration is a few additions and takes no memory. The chassis
+ * keeps one for each type of motion, and odometry keeps one for its updates
+ *
+ * @b Example
+ * @code {.cpp}
+ * const lemlib::LoopStats stats = chassis.getLoopProfiler(lemlib::MotionType::MOVE_TO_POSE).getStats();
+ * std::cout << "p99 compute: " << stats.compute.p99 << " us" << std::endl;
+ * @endcode
+ */
+class LoopProfiler {
+    public:
+        /**
+         * @brief Record an iteration of the loop
+         *
+         * @param compute time the iteration spent running, in microseconds
+         * @param lateness how long after it was due the iteration woke up, in microseconds
+         * @param period the period of the loop, in microseconds
+         */
+        void record(uint32_t compute, uint32_t lateness, uint32_t period);
+        /**
+         * @brief Get the statistics of the recorded iterations
+         *
+         * @note the statistics can be slightly off if they are read while the loop is recording
+         *
+         * @return LoopStats the statistics
+         */
+        LoopStats getStats() const;
+        /**
+         * @brief Forget every recorded iteration
+         */
+        void reset();
+        /**
+         * @brief Send the statistics to the telemetry sink, as "name,iterations,overruns," followed by the p50, p99
+         * and max of the compute time, then of the lateness
+         *
+         * @param name the name of the loop
+         */
+        void report(std::string_view name) const;
+    private:
+        /** width of a histogram bucket, in microseconds */
+        static constexpr uint32_t BUCKET_WIDTH = 50;
+        /** number of buckets. The last bucket holds everything too long for the others */
+        static constexpr uint32_t BUCKETS = 128;
+
+        /**
+         * @brief A histogram of a timing
+         */
+        struct Histogram {
+                std::array<uint32_t, BUCKETS> buckets {};
+                uint32_t max = 0;
+
+                void add(uint32_t time);
+                TimingStats stats(uint32_t count) const;
+        };
+
+        Histogram compute;
+        Histogram lateness;
+        uint32_t iterations = 0;
+        uint32_t overruns = 0;
+};
+} // namespace lemlib
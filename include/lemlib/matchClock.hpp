@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief The periods of a match
+ */
+enum class MatchPeriod {
+    DISABLED, /** the robot is disabled, before or between the periods */
+    AUTONOMOUS, /** the autonomous period */
+    DRIVER /** the driver control period */
+};
+
+/**
+ * @brief How long each period of a match is
+ */
+struct MatchTiming {
+        /** length of the autonomous period, in milliseconds. 15000 by default, 60000 for autonomous skills */
+        uint32_t autonomous = 15000;
+        /** length of the driver control period, in milliseconds. 105000 by default, 60000 for driver skills */
+        uint32_t driver = 105000;
+};
+
+/**
+ * @brief Keeps the time of the match, from the competition state
+ *
+ * The competition state is read every time the clock is asked for the time, and by the odometry task every update,
+ * and the time it changes is recorded as the start of the period. The field doesn't tell the robot how long a period
+ * is, so the remaining time is the length of the period in the timing minus the time since it started. Reading the
+ * clock is a read of the competition state and of an atomic, so motion loops can check it every iteration
+ *
+ * Without a field or competition switch, the robot is always in driver control, enabled. A period can be started by
+ * hand to practice with the real match time, and it lasts until the competition state changes
+ *
+ * @b Example
+ * @code {.cpp}
+ * void autonomous() {
+ *     chassis.moveToPose(24, 48, 90, 4000);
+ *     // only score the last goal if there are at least 3 seconds left
+ *     if (lemlib::matchClock().getRemaining() > 3000) chassis.moveToPose(48, 48, 90, 3000);
+ *     // get to the bar with a second to spare
+ *     chassis.moveToPose(0, 60, 0, 5000, {.deadlineMs = float(lemlib::matchClock().getDeadline(1000))});
+ * }
+ * @endcode
+ */
+class MatchClock {
+    public:
+        /**
+         * @brief Construct a new Match Clock
+         *
+         * @param timing how long each period of a match is
+         */
+        MatchClock(MatchTiming timing = {});
+        /**
+         * @brief Set how long each period of a match is, like for skills
+         *
+         * @param timing the timing
+         */
+        void setTiming(MatchTiming timing);
+        /**
+         * @brief Read the competition state, and start a period if it changed. Called by every other method
+         */
+        void update();
+        /**
+         * @brief Start a period by hand, as if the competition state had changed to it
+         *
+         * @param period the period
+         */
+        void start(MatchPeriod period);
+        /**
+         * @brief Get the current period
+         *
+         * @return MatchPeriod the period
+         */
+        MatchPeriod getPeriod();
+        /**
+         * @brief Get the time the current period started
+         *
+         * @return uint32_t the time, in milliseconds since the program started
+         */
+        uint32_t getPeriodStart();
+        /**
+         * @brief Get the time since the current period started
+         *
+         * @return uint32_t the time, in milliseconds
+         */
+        uint32_t getElapsed();
+        /**
+         * @brief Get the time left in the current period
+         *
+         * @return uint32_t the time, in milliseconds. 0 once the period should have ended, and while disabled
+         */
+        uint32_t getRemaining();
+        /**
+         * @brief Get the time until a moment before the end of the current period, for the deadline of a motion
+         *
+         * @param reserve how long before the end of the period, in milliseconds
+         * @return uint32_t the time, in milliseconds. At least 1, so it can be used as a deadline even when the time
+         * is up
+         */
+        uint32_t getDeadline(uint32_t reserve = 0);
+        /**
+         * @brief Whether the current period is a real period of a match, with a length
+         *
+         * Without a field or competition switch, the driver control period starts when the program does, so the
+         * remaining time runs out while nothing is timing the robot
+         *
+         * @return true a field or competition switch is connected, or the period was started by hand
+         * @return false the robot isn't in a match, so the remaining time doesn't mean anything
+         */
+        bool isTimed();
+    private:
+        /**
+         * @brief Get the length of a period
+         */
+        uint32_t periodLength(MatchPeriod period) const;
+
+        std::atomic<uint32_t> autonomousLength;
+        std::atomic<uint32_t> driverLength;
+        /**
+         * the period in the low byte, the competition state it started at in the next byte, whether it was started
+         * by hand in the bit after, and the time it started in the high 32 bits. Kept in 1 atomic, so a reader never
+         * sees a period with the start of another one
+         */
+        std::atomic<uint64_t> state;
+};
+
+/**
+ * @brief Get the match clock used by the chassis and routines
+ *
+ * @return MatchClock&
+ */
+MatchClock& matchClock();
+} // namespace lemlib
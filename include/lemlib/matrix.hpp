@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace lemlib {
+/**
+ * @brief A fixed size matrix of floats
+ *
+ * The size is known at compile time, so matrices are stored inline and never allocate memory
+ *
+ * @tparam Rows number of rows
+ * @tparam Cols number of columns
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::Matrix<2, 2> a = lemlib::Matrix<2, 2>::identity();
+ * a(0, 1) = 2;
+ * lemlib::Matrix<2, 2> b = a * a.transpose();
+ * @endcode
+ */
+template <size_t Rows, size_t Cols> class Matrix {
+    public:
+        /**
+         * @brief Get an element of the matrix
+         *
+         * @param row the row of the element
+         * @param col the column of the element
+         * @return float& the element
+         */
+        float& operator()(size_t row, size_t col) { return data[row * Cols + col]; }
+
+        /**
+         * @brief Get an element of the matrix
+         *
+         * @param row the row of the element
+         * @param col the column of the element
+         * @return float the element
+         */
+        float operator()(size_t row, size_t col) const { return data[row * Cols + col]; }
+
+        /**
+         * @brief Get the identity matrix
+         *
+         * @return Matrix the identity matrix
+         */
+        static Matrix identity() {
+            static_assert(Rows == Cols, "only square matrices have an identity");
+            Matrix result;
+            for (size_t i = 0; i < Rows; i++) result(i, i) = 1;
+            return result;
+        }
+
+        /**
+         * @brief Add 2 matrices
+         *
+         * @param other the other matrix
+         * @return Matrix the sum
+         */
+        Matrix operator+(const Matrix& other) const {
+            Matrix result;
+            for (size_t i = 0; i < Rows * Cols; i++) result.data[i] = data[i] + other.data[i];
+            return result;
+        }
+
+        /**
+         * @brief Subtract 2 matrices
+         *
+         * @param other the other matrix
+         * @return Matrix the difference
+         */
+        Matrix operator-(const Matrix& other) const {
+            Matrix result;
+            for (size_t i = 0; i < Rows * Cols; i++) result.data[i] = data[i] - other.data[i];
+            return result;
+        }
+
+        /**
+         * @brief Multiply 2 matrices
+         *
+         * @tparam OtherCols number of columns of the other matrix
+         * @param other the other matrix
+         * @return Matrix<Rows, OtherCols> the product
+         */
+        template <size_t OtherCols> Matrix<Rows, OtherCols> operator*(const Matrix<Cols, OtherCols>& other) const {
+            Matrix<Rows, OtherCols> result;
+            for (size_t row = 0; row < Rows; row++) {
+                for (size_t col = 0; col < OtherCols; col++) {
+                    float sum = 0;
+                    for (size_t i = 0; i < Cols; i++) sum += (*this)(row, i) * other(i, col);
+                    result(row, col) = sum;
+                }
+            }
+            return result;
+        }
+
+        /**
+         * @brief Multiply the matrix by a scalar
+         *
+         * @param scalar the scalar
+         * @return Matrix the product
+         */
+        Matrix operator*(float scalar) const {
+            Matrix result;
+            for (size_t i = 0; i < Rows * Cols; i++) result.data[i] = data[i] * scalar;
+            return result;
+        }
+
+        /**
+         * @brief Transpose the matrix
+         *
+         * @return Matrix<Cols, Rows> the transpose
+         */
+        Matrix<Cols, Rows> transpose() const {
+            Matrix<Cols, Rows> result;
+            for (size_t row = 0; row < Rows; row++) {
+                for (size_t col = 0; col < Cols; col++) result(col, row) = (*this)(row, col);
+            }
+            return result;
+        }
+    private:
+        std::array<float, Rows * Cols> data {};
+};
+} // namespace lemlib
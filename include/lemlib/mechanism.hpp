@@ -0,0 +1,223 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/boundedQueue.hpp"
+#include "lemlib/exitcondition.hpp"
+#include "lemlib/feedforward.hpp"
+#include "lemlib/motionProfile.hpp"
+#include "lemlib/pid.hpp"
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/motionHandle.hpp"
+
+namespace lemlib {
+class Scheduler;
+
+/**
+ * @brief How gravity pulls on a mechanism
+ */
+enum class MechanismGravity {
+    NONE, /** gravity doesn't pull on the mechanism, like a turret or an intake */
+    CONSTANT, /** gravity pulls the same at every position, like a lift */
+    COSINE /** gravity pulls the most when the mechanism is level, like an arm. Level is position 0 */
+};
+
+/**
+ * @brief The physical setup of a mechanism
+ */
+struct MechanismConfig {
+        /** the motors that drive the mechanism. Must outlive the mechanism */
+        pros::MotorGroup* motors;
+        /** the rotation sensor that measures the mechanism. Must outlive the mechanism */
+        pros::Rotation* sensor;
+        /** degrees the sensor turns for each unit the mechanism moves. 1 by default, so positions are in degrees */
+        float ratio = 1;
+        /** feedforward of the mechanism, in volts, with velocity in units per second */
+        Feedforward feedforward = Feedforward();
+        /** how gravity pulls on the mechanism */
+        MechanismGravity gravity = MechanismGravity::NONE;
+        /** voltage that holds the mechanism against gravity, in volts */
+        float kG = 0;
+};
+
+/**
+ * @brief Optional parameters of Mechanism::moveTo
+ */
+struct MechanismMoveParams {
+        /** fastest speed of the motion profile, in units per second. 0 uses the controller settings */
+        float maxVelocity = 0;
+        /** whether the mechanism holds the target after the move ends. True by default */
+        bool hold = true;
+        /** the move ends early once the mechanism is within this range of the target, in units. 0 to settle */
+        float earlyExitRange = 0;
+};
+
+/**
+ * @brief Moves a motor group to a position measured by a rotation sensor, like a lift or an arm
+ *
+ * Each move follows a motion profile from the controller settings when maxVelocity and maxAcceleration are set, and
+ * steps straight to the target otherwise. Every tick, the PID corrects the error from the profile, and the
+ * feedforward and gravity terms add the voltage the profile needs. The move settles on the same small and large
+ * error exit conditions as the chassis, and returns a MotionHandle, so it can be waited on, given callbacks, and
+ * used in a Routine like a chassis motion.
+ *
+ * The control loop never blocks, so it runs as a job on a Scheduler, on the same tick as odometry. Without a
+ * scheduler it runs on a task of its own, at the motion priority of getTaskConfig(). A new move replaces the move
+ * that is running, which ends as CANCELLED
+ *
+ * @note the mechanism can't be copied or moved, since its control loop references it
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * pros::MotorGroup liftMotors({7, -8});
+ * pros::Rotation liftSensor(9);
+ * lemlib::MechanismConfig liftConfig {&liftMotors, &liftSensor};
+ * liftConfig.feedforward = lemlib::Feedforward(0.5, 0.01);
+ * liftConfig.gravity = lemlib::MechanismGravity::CONSTANT;
+ * liftConfig.kG = 1.2;
+ * // 400 degrees per second, 1200 degrees per second squared
+ * lemlib::Mechanism lift(liftConfig, lemlib::ControllerSettings(3, 0, 10, 0, 2, 100, 5, 500, 0, false, 400, 1200));
+ * void autonomous() {
+ *     lift.calibrate();
+ *     // raise the lift while driving, and score once both are done
+ *     lemlib::MotionHandle raise = lift.moveTo(360, 1500);
+ *     chassis.moveToPoint(0, 24, 2000);
+ *     raise.wait();
+ * }
+ * @endcode
+ */
+class Mechanism : public MotionExecutor {
+    public:
+        /**
+         * @brief Construct a new Mechanism
+         *
+         * @param config the motors, sensor, and feedforward of the mechanism
+         * @param settings the gains, exit conditions, and motion profile limits. Errors are in units, and velocities
+         * in units per second. slew and gyroDerivative aren't used
+         * @param scheduler runs the control loop, or nullptr to run it on a task of its own. Must outlive the
+         * mechanism
+         * @param period time between ticks of the control loop, in milliseconds
+         */
+        Mechanism(MechanismConfig config, ControllerSettings settings, Scheduler* scheduler = nullptr,
+                  uint32_t period = 10);
+        Mechanism(const Mechanism&) = delete;
+        Mechanism& operator=(const Mechanism&) = delete;
+        /**
+         * @brief Set the position of the mechanism, and start the control loop if it isn't running
+         *
+         * @param position the current position of the mechanism, in units. 0 by default
+         */
+        void calibrate(float position = 0);
+        /**
+         * @brief Move the mechanism to a position
+         *
+         * @param target the position, in units
+         * @param timeout longest time the move can take, in milliseconds
+         * @param params optional parameters
+         * @param async whether to return before the move ends. True by default
+         * @return MotionHandle a handle to the move. Its progress is the distance moved, in units
+         */
+        MotionHandle moveTo(float target, int timeout, MechanismMoveParams params = {}, bool async = true);
+        /**
+         * @brief End the running move, and stop holding
+         */
+        void cancel();
+        /**
+         * @brief Get the position of the mechanism
+         *
+         * @return float the position, in units
+         */
+        float getPosition() const;
+        /**
+         * @brief Get the velocity of the mechanism
+         *
+         * @return float the velocity, in units per second
+         */
+        float getVelocity() const;
+        /**
+         * @brief Check whether the rotation sensor failed to read on the last tick
+         *
+         * The motors are stopped while the sensor can't be read
+         *
+         *
+         * @return true the sensor failed to read
+         */
+        bool hasSensorError() const;
+        /**
+         * @brief Wait until the move that is running has ended
+         */
+        void waitUntilDone();
+    private:
+        /** a move waiting to be started by the control loop */
+        struct MechanismCommand {
+                uint32_t id = 0;
+                float target = 0;
+                int timeout = 0;
+                MechanismMoveParams params;
+        };
+
+        MotionRecord* getMotionRecord(uint32_t id) override;
+        void waitForMotion(uint32_t id, float dist) override;
+        /**
+         * @brief Run one iteration of the control loop
+         */
+        void tick();
+        /**
+         * @brief Start a move taken from the queue
+         */
+        void startMove(const MechanismCommand& command, float position);
+        /**
+         * @brief Set why a move ended, and run its completion callbacks
+         */
+        void finishMove(uint32_t id, MotionEndReason reason);
+        /**
+         * @brief Run the callbacks of the running move whose trigger was reached
+         */
+        void fireCallbacks(MotionRecord& record, bool ended);
+        /**
+         * @brief Drive the motors
+         *
+         * @param power the power, from -127 to 127
+         */
+        void drive(float power);
+        /**
+         * @brief Get the voltage that holds the mechanism against gravity at a position, scaled to -127 to 127
+         */
+        float gravityPower(float position) const;
+
+        MechanismConfig config;
+        ControllerSettings settings;
+        uint32_t period;
+        Scheduler* scheduler;
+        PID pid;
+        ExitCondition smallExit;
+        ExitCondition largeExit;
+        BoundedQueue<MechanismCommand> commands {4};
+        std::array<MotionRecord, 8> records;
+        std::atomic<uint32_t> movesQueued = 0;
+        std::atomic<bool> cancelRequested = false;
+        // the running move. Only used by the control loop
+        uint32_t running = 0;
+        MechanismCommand move;
+        MotionProfile profile {0, 1, 1};
+        bool profiled = false;
+        float startPosition = 0;
+        uint64_t startTime = 0;
+        // position held after a move ends. NAN when not holding
+        float holdTarget = NAN;
+        // whether the sensor failed to read this tick
+        std::atomic<bool> sensorError = false;
+        std::atomic<float> position = 0;
+        std::atomic<float> velocity = 0;
+        // tasks waiting for a move. More tasks than this can wait, but they poll instead
+        std::array<std::atomic<pros::task_t>, 4> waiters {};
+        TaskMonitor monitor {"mechanism"};
+        pros::Task* task = nullptr;
+        int schedulerJob = -1;
+};
+} // namespace lemlib
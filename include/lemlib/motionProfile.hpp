@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace lemlib {
+/**
+ * @brief The planned state of a motion profile at a point in time
+ */
+struct ProfileState {
+        /** distance from the start of the profile */
+        float position = 0;
+        /** velocity, in units per second */
+        float velocity = 0;
+        /** acceleration, in units per second squared */
+        float acceleration = 0;
+};
+
+/**
+ * @brief A time-parameterized motion profile that starts and ends at rest
+ *
+ * Without a jerk limit the profile is trapezoidal: it accelerates at the maximum acceleration, cruises at the
+ * maximum velocity, and decelerates at the maximum acceleration. With a jerk limit it is an S-curve, which
+ * ramps the acceleration as well. If the distance is too short to reach the maximum velocity, the profile peaks at a
+ * lower velocity instead. Units are up to the user, as long as they are consistent
+ *
+ * @b Example
+ * @code {.cpp}
+ * // 48 inches at up to 60 in/s, 120 in/s^2, and 600 in/s^3
+ * lemlib::MotionProfile profile(48, 60, 120, 600);
+ * // where the robot should be half a second in
+ * lemlib::ProfileState state = profile.sample(0.5);
+ * @endcode
+ */
+class MotionProfile {
+    public:
+        /**
+         * @brief Construct a new Motion Profile
+         *
+         * @param distance the distance to travel. Can be negative
+         * @param maxVelocity the maximum velocity, in units per second
+         * @param maxAcceleration the maximum acceleration, in units per second squared
+         * @param maxJerk the maximum jerk, in units per second cubed. 0 for a trapezoidal profile
+         */
+        MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk = 0);
+        /**
+         * @brief Get the planned state at a point in time
+         *
+         * @param time the time since the start of the profile, in seconds
+         * @return ProfileState the state. At rest at the start or the end if the time is outside of the profile
+         */
+        ProfileState sample(float time) const;
+        /**
+         * @brief Get how long the profile takes
+         *
+         * @return float the duration, in seconds
+         */
+        float getDuration() const;
+        /**
+         * @brief Get the distance the profile travels
+         *
+         * @return float the distance
+         */
+        float getDistance() const;
+    private:
+        /**
+         * @brief A part of the profile with constant jerk
+         */
+        struct Segment {
+                float duration;
+                float jerk;
+                /** acceleration at the start of the segment. Acceleration can jump between trapezoidal segments */
+                float acceleration;
+        };
+
+        /**
+         * @brief Add the segments that accelerate from rest to a velocity, or decelerate from it to rest
+         *
+         * @param velocity the velocity
+         * @param sign 1 to accelerate, -1 to decelerate
+         */
+        void addRamp(float velocity, float sign);
+
+        float distance;
+        float maxAcceleration;
+        float maxJerk;
+        std::array<Segment, 7> segments {};
+        size_t segmentCount = 0;
+        float duration = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include "lemlib/path/generator.hpp"
+#include "lemlib/path/path.hpp"
+
+namespace lemlib {
+/**
+ * @brief Math that can run at compile time, for bakePath
+ *
+ * The functions of cmath aren't constexpr until C++26, so these are computed with series and Newton's method in
+ * double precision, which is at least as accurate as the float math of generatePath
+ */
+namespace constexprMath {
+constexpr double abs(double x) { return x < 0 ? -x : x; }
+
+constexpr double min(double a, double b) { return a < b ? a : b; }
+
+constexpr double max(double a, double b) { return a > b ? a : b; }
+
+constexpr double ceil(double x) {
+    const double truncated = double(int64_t(x));
+    return truncated < x ? truncated + 1 : truncated;
+}
+
+constexpr double sqrt(double x) {
+    if (x <= 0) return 0;
+    // Newton's method from above the root, which converges from one side, so it stops when the estimate stops falling
+    double estimate = x > 1 ? x : 1;
+    for (int i = 0; i < 128; i++) {
+        const double next = (estimate + x / estimate) / 2;
+        if (next >= estimate) break;
+        estimate = next;
+    }
+    return estimate;
+}
+
+constexpr double hypot(double x, double y) { return sqrt(x * x + y * y); }
+
+constexpr double sin(double x) {
+    // bring the angle within -pi to pi, where the series converges quickly
+    constexpr double pi = 3.14159265358979323846;
+    x -= 2 * pi * double(int64_t(x / (2 * pi) + (x < 0 ? -0.5 : 0.5)));
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 20; n++) {
+        term *= -x * x / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cos(double x) { return sin(x + 3.14159265358979323846 / 2); }
+} // namespace constexprMath
+
+/**
+ * @brief Called when a baked path has more points than it was given room for. It isn't constexpr, so baking the path
+ * at compile time fails with an error that names this function
+ */
+inline void bakedPathHasTooManyPoints() {}
+
+/**
+ * @brief A path computed at compile time by bakePath
+ *
+ * The points and the arc length index are stored together, so a baked path declared constexpr lives in flash, and
+ * following it costs nothing at runtime: no asset is parsed, and nothing is generated or allocated
+ *
+ * @tparam N the most points the path can have
+ */
+template <size_t N> struct BakedPath {
+        /** x positions of the points, in inches */
+        float x[N] {};
+        /** y positions of the points, in inches */
+        float y[N] {};
+        /** velocities of the points, in the same units as path files */
+        float velocity[N] {};
+        /** the arc length index of the path, in the layout of Path */
+        float index[N * Path::INDEX_FLOATS] {};
+        /** the number of points the path has */
+        size_t size = 0;
+        /** distance between the points, in inches */
+        float spacing = 0;
+
+        /**
+         * @brief Get a path that Chassis::follow can drive, which references the baked points
+         *
+         * @note the baked path must outlive the path
+         *
+         * @return Path the path
+         */
+        Path path() const { return Path(x, y, velocity, size, index, spacing); }
+};
+
+/**
+ * @brief Generate a path through waypoints at compile time
+ *
+ * The path is the same one generatePath makes from the same waypoints and constraints: the splines, the spacing of
+ * the points, and the velocities planned from the curvature and acceleration limits. Declaring the result constexpr
+ * makes the compiler do all of the work, which suits routes that never change
+ *
+ * @tparam N the most points the path can have. The path has about its length divided by the spacing, plus 1. Baking
+ * fails to compile if it needs more
+ * @param waypoints the points the path passes through, in order. At least 2 are needed
+ * @param constraints struct to simulate named parameters
+ * @return BakedPath<N> the path. Empty if there are too few waypoints
+ *
+ * @b Example
+ * @code {.cpp}
+ * // room for 100 points, a point every 1 inch by default
+ * constexpr auto route = lemlib::bakePath<100>({{0, 0, 0}, {24, 48, 90}, {48, 48, 90}});
+ *
+ * void autonomous() {
+ *     chassis.follow(route.path(), 10, 4000, true, false);
+ * }
+ * @endcode
+ */
+template <size_t N, size_t W>
+constexpr BakedPath<N> bakePath(const Waypoint (&waypoints)[W], const PathConstraints& constraints = {}) {
+    namespace cm = constexprMath;
+    BakedPath<N> baked {};
+    if (W < 2 || constraints.spacing <= 0 || N < 2) return baked;
+    const double spacing = constraints.spacing;
+    constexpr double degToRad = 3.14159265358979323846 / 180;
+
+    /**
+     * a spline between 2 waypoints, with its tangents along the heading of each waypoint. The same curves as
+     * generatePath
+     */
+    struct Spline {
+            double x0, y0, x1, y1, tx0, ty0, tx1, ty1;
+    };
+
+    struct SplinePoint {
+            double x, y, dx, dy, ddx, ddy;
+    };
+
+    const auto makeSpline = [&](const Waypoint& start, const Waypoint& end) {
+        const double length = constraints.tangentScale * cm::hypot(end.x - start.x, end.y - start.y);
+        return Spline {start.x,
+                       start.y,
+                       end.x,
+                       end.y,
+                       length * cm::sin(start.theta * degToRad),
+                       length * cm::cos(start.theta * degToRad),
+                       length * cm::sin(end.theta * degToRad),
+                       length * cm::cos(end.theta * degToRad)};
+    };
+    const auto evaluate = [&](const Spline& s, double t) {
+        const double t2 = t * t;
+        const double t3 = t2 * t;
+        double p0 = 0, m0 = 0, p1 = 0, m1 = 0, dp0 = 0, dm0 = 0, dp1 = 0, dm1 = 0, ddp0 = 0, ddm0 = 0, ddp1 = 0,
+               ddm1 = 0;
+        if (constraints.type == SplineType::CUBIC_BEZIER) {
+            p0 = 2 * t3 - 3 * t2 + 1, m0 = t3 - 2 * t2 + t, p1 = -2 * t3 + 3 * t2, m1 = t3 - t2;
+            dp0 = 6 * t2 - 6 * t, dm0 = 3 * t2 - 4 * t + 1, dp1 = -6 * t2 + 6 * t, dm1 = 3 * t2 - 2 * t;
+            ddp0 = 12 * t - 6, ddm0 = 6 * t - 4, ddp1 = -12 * t + 6, ddm1 = 6 * t - 2;
+        } else {
+            const double t4 = t3 * t;
+            const double t5 = t4 * t;
+            p0 = 1 - 10 * t3 + 15 * t4 - 6 * t5, m0 = t - 6 * t3 + 8 * t4 - 3 * t5;
+            p1 = 10 * t3 - 15 * t4 + 6 * t5, m1 = -4 * t3 + 7 * t4 - 3 * t5;
+            dp0 = -30 * t2 + 60 * t3 - 30 * t4, dm0 = 1 - 18 * t2 + 32 * t3 - 15 * t4;
+            dp1 = -dp0, dm1 = -12 * t2 + 28 * t3 - 15 * t4;
+            ddp0 = -60 * t + 180 * t2 - 120 * t3, ddm0 = -36 * t + 96 * t2 - 60 * t3;
+            ddp1 = -ddp0, ddm1 = -24 * t + 84 * t2 - 60 * t3;
+        }
+        return SplinePoint {p0 * s.x0 + m0 * s.tx0 + p1 * s.x1 + m1 * s.tx1,
+                            p0 * s.y0 + m0 * s.ty0 + p1 * s.y1 + m1 * s.ty1,
+                            dp0 * s.x0 + dm0 * s.tx0 + dp1 * s.x1 + dm1 * s.tx1,
+                            dp0 * s.y0 + dm0 * s.ty0 + dp1 * s.y1 + dm1 * s.ty1,
+                            ddp0 * s.x0 + ddm0 * s.tx0 + ddp1 * s.x1 + ddm1 * s.tx1,
+                            ddp0 * s.y0 + ddm0 * s.ty0 + ddp1 * s.y1 + ddm1 * s.ty1};
+    };
+    // the same number of integration steps as generatePath
+    const auto steps = [&](const Spline& s) {
+        return int(cm::max(16, cm::ceil(cm::hypot(s.x1 - s.x0, s.y1 - s.y0) / spacing * 4)));
+    };
+
+    // first pass: find the length of the path, so the number of points is known
+    double length = 0;
+    for (size_t i = 0; i + 1 < W; i++) {
+        const Spline spline = makeSpline(waypoints[i], waypoints[i + 1]);
+        const int count = steps(spline);
+        SplinePoint last = evaluate(spline, 0);
+        for (int step = 1; step <= count; step++) {
+            const SplinePoint point = evaluate(spline, double(step) / count);
+            length += cm::hypot(point.x - last.x, point.y - last.y);
+            last = point;
+        }
+    }
+    size_t count = size_t(cm::ceil(length / spacing)) + 1;
+    if (count > N) {
+        bakedPathHasTooManyPoints();
+        count = N;
+    }
+
+    // second pass: place the points, and limit the velocity of each by the curvature of the spline there
+    size_t placed = 0;
+    double traveled = 0;
+    for (size_t i = 0; i + 1 < W && placed + 1 < count; i++) {
+        const Spline spline = makeSpline(waypoints[i], waypoints[i + 1]);
+        const int stepCount = steps(spline);
+        SplinePoint last = evaluate(spline, 0);
+        for (int step = 1; step <= stepCount && placed + 1 < count; step++) {
+            const SplinePoint point = evaluate(spline, double(step) / stepCount);
+            const double stepLength = cm::hypot(point.x - last.x, point.y - last.y);
+            while (placed + 1 < count && placed * spacing <= traveled + stepLength) {
+                const double t = stepLength == 0 ? 0 : (placed * spacing - traveled) / stepLength;
+                baked.x[placed] = last.x + (point.x - last.x) * t;
+                baked.y[placed] = last.y + (point.y - last.y) * t;
+                const double speed = cm::hypot(last.dx, last.dy);
+                const double curvature =
+                    speed == 0 ? 0 : cm::abs(last.dx * last.ddy - last.dy * last.ddx) / (speed * speed * speed);
+                double target = constraints.maxVelocity;
+                if (constraints.k > 0 && curvature > 0) target = cm::min(target, constraints.k / curvature);
+                baked.velocity[placed] = cm::max(target, constraints.minVelocity);
+                placed++;
+            }
+            traveled += stepLength;
+            last = point;
+        }
+    }
+    while (placed + 1 < count) {
+        baked.x[placed] = baked.x[placed - 1];
+        baked.y[placed] = baked.y[placed - 1];
+        baked.velocity[placed] = baked.velocity[placed - 1];
+        placed++;
+    }
+    baked.x[count - 1] = waypoints[W - 1].x;
+    baked.y[count - 1] = waypoints[W - 1].y;
+    baked.velocity[count - 1] = 0;
+
+    // the arc length index, the same as Path calculates. Each array is stored back to back
+    float* curvatures = baked.index;
+    float* distances = baked.index + count;
+    float* segmentLengths = baked.index + 2 * count;
+    float* directionsX = baked.index + 3 * count;
+    float* directionsY = baked.index + 4 * count;
+    double distance = 0;
+    for (size_t i = 0; i < count; i++) {
+        distances[i] = distance;
+        if (i + 1 == count) break;
+        const double dx = double(baked.x[i + 1]) - baked.x[i];
+        const double dy = double(baked.y[i + 1]) - baked.y[i];
+        const double segment = cm::hypot(dx, dy);
+        segmentLengths[i] = segment;
+        directionsX[i] = segment == 0 ? 0 : dx / segment;
+        directionsY[i] = segment == 0 ? 0 : dy / segment;
+        distance += segment;
+    }
+    for (size_t i = 1; i + 1 < count; i++) {
+        const double ax = double(baked.x[i]) - baked.x[i - 1], ay = double(baked.y[i]) - baked.y[i - 1];
+        const double bx = double(baked.x[i + 1]) - baked.x[i], by = double(baked.y[i + 1]) - baked.y[i];
+        const double chord =
+            cm::hypot(double(baked.x[i + 1]) - baked.x[i - 1], double(baked.y[i + 1]) - baked.y[i - 1]);
+        const double product = double(segmentLengths[i - 1]) * segmentLengths[i] * chord;
+        curvatures[i] = product == 0 ? 0 : 2 * (ax * by - ay * bx) / product;
+    }
+
+    // limit how quickly the velocity changes over the indexed distances, the same passes as limitAcceleration
+    if (constraints.maxAcceleration > 0) {
+        const double twiceAcceleration = 2 * constraints.maxAcceleration;
+        double prev = constraints.minVelocity;
+        for (size_t i = 0; i + 1 < count; i++) {
+            const double segment = i == 0 ? 0 : segmentLengths[i - 1];
+            baked.velocity[i] = cm::min(baked.velocity[i], cm::sqrt(prev * prev + twiceAcceleration * segment));
+            prev = baked.velocity[i];
+        }
+        double next = constraints.minVelocity;
+        for (size_t i = count - 1; i-- > 0;) {
+            const double segment = segmentLengths[i];
+            baked.velocity[i] = cm::min(baked.velocity[i], cm::sqrt(next * next + twiceAcceleration * segment));
+            next = baked.velocity[i];
+        }
+    }
+    baked.size = count;
+    baked.spacing = constraints.spacing;
+    return baked;
+}
+} // namespace lemlib
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "lemlib/asset.hpp"
+
+namespace lemlib {
+/**
+ * @brief Header of a path bundle asset
+ *
+ * Path bundles pack many paths into one asset, so a route doesn't need an asset for every path. They are generated
+ * from the text paths in static/ at build time by `firmware/pathbundle.py`.
+ *
+ * The header is followed by a hash table of `tableSize` BundleEntry, then the paths in the packed binary path format.
+ * Each path is named after the file it was generated from, without the extension
+ */
+struct BundleHeader {
+        /** magic number used to identify path bundles. Always equal to BUNDLE_MAGIC */
+        uint32_t magic;
+        /** version of the path bundle format. Always equal to BUNDLE_VERSION */
+        uint16_t version;
+        /** reserved for future use */
+        uint16_t flags;
+        /** number of paths in the bundle */
+        uint32_t count;
+        /** number of entries in the hash table. Always a power of 2 */
+        uint32_t tableSize;
+};
+
+/**
+ * @brief Entry in the hash table of a path bundle
+ */
+struct BundleEntry {
+        /** hash of the name of the path, from pathNameHash. 0 if the entry is empty */
+        uint32_t hash;
+        /** offset of the path from the start of the bundle, in bytes */
+        uint32_t offset;
+        /** size of the path, in bytes. 0 if the entry is empty */
+        uint32_t size;
+};
+
+static_assert(sizeof(BundleHeader) == 16, "BundleHeader must be 16 bytes");
+static_assert(sizeof(BundleEntry) == 12, "BundleEntry must be 12 bytes");
+
+/** magic number of path bundles, "LLPK" in little endian */
+constexpr uint32_t BUNDLE_MAGIC = 0x4B504C4C;
+/** current version of the path bundle format */
+constexpr uint16_t BUNDLE_VERSION = 1;
+
+/**
+ * @brief Hash the name of a path in a bundle
+ *
+ * This is 32 bit FNV-1a, the same hash `firmware/pathbundle.py` uses. It is constexpr, so names known at compile time
+ * are hashed at compile time
+ *
+ * @param name the name of the path
+ * @return uint32_t the hash
+ */
+constexpr uint32_t pathNameHash(std::string_view name) {
+    uint32_t hash = 0x811C9DC5;
+    for (const char c : name) hash = (hash ^ uint8_t(c)) * 0x01000193;
+    return hash;
+}
+
+/**
+ * @brief Find a path in a path bundle
+ *
+ * The path is found in the hash table of the bundle, so this takes constant time. Nothing is copied, the returned
+ * asset points into the bundle
+ *
+ * @param bundle the path bundle asset
+ * @param name the name of the path
+ * @return asset the path, in the packed binary path format. Empty if the bundle doesn't have the path
+ *
+ * @b Example
+ * @code {.cpp}
+ * // every text path in static/ is packed into paths.lpk at build time
+ * ASSET(paths_lpk);
+ *
+ * void autonomous() {
+ *     // follow the path made from static/segment3.txt
+ *     chassis.follow(paths_lpk, "segment3", 10, 4000);
+ * }
+ * @endcode
+ */
+asset findPath(const asset& bundle, std::string_view name);
+} // namespace lemlib
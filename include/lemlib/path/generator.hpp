@@ -0,0 +1,183 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "lemlib/path/path.hpp"
+#include "lemlib/chassis/driverMacro.hpp"
+
+namespace lemlib {
+/**
+ * @brief Preallocated memory that generated paths are written into
+ *
+ * The memory is allocated once, usually in initialize, so paths can be generated during autonomous without touching
+ * the heap. Paths reference the arena, so they must not be followed after the arena is reset or destroyed
+ *
+ * @b Example
+ * @code {.cpp}
+ * // room for 1000 points, spread across any number of paths
+ * lemlib::PathArena arena(1000);
+ * @endcode
+ */
+class PathArena {
+    public:
+        /**
+         * @brief Construct a new Path Arena
+         *
+         * @param points how many points it can hold, across every path generated into it
+         */
+        PathArena(size_t points);
+        ~PathArena();
+        PathArena(const PathArena&) = delete;
+        PathArena& operator=(const PathArena&) = delete;
+        /**
+         * @brief Reserve memory for a path
+         *
+         * @param points the number of points of the path
+         * @return float* memory for the points and the index of the path. nullptr if the arena is full
+         */
+        float* allocate(size_t points);
+        /**
+         * @brief Free the memory of the last path, so a path that was rejected doesn't use up the arena
+         *
+         * @note the path can't be used after this
+         *
+         * @param points the number of points of the path, as it was allocated
+         */
+        void release(size_t points);
+        /**
+         * @brief Free every path in the arena at once
+         *
+         * @note paths generated into the arena can't be used after this
+         */
+        void reset();
+        /**
+         * @brief Get how many more points the arena can hold
+         *
+         * @return size_t the number of points
+         */
+        size_t remaining() const;
+        /** the number of floats each point uses: x, y, velocity, and the arc length index */
+        static constexpr size_t POINT_FLOATS = 3 + Path::INDEX_FLOATS;
+    private:
+        float* buffer;
+        size_t capacity;
+        size_t used = 0;
+};
+
+/**
+ * @brief The curve used between waypoints
+ */
+enum class SplineType {
+    CUBIC_BEZIER, /** cubic Bézier curve, with control points placed along the heading of each waypoint */
+    QUINTIC_HERMITE /** quintic Hermite spline, which also has no curvature at each waypoint, so segments join smoothly
+                     */
+};
+
+/**
+ * @brief A point a generated path passes through
+ */
+struct Waypoint {
+        /** x location, in inches */
+        float x;
+        /** y location, in inches */
+        float y;
+        /** heading the path passes through the point at, in degrees */
+        float theta;
+};
+
+/**
+ * @brief Parameters for generatePath
+ *
+ * We use a struct to simplify customization. generatePath has many
+ * parameters and specifying them all just to set one optional param harms
+ * readability. By passing a struct to the function, we can have named
+ * parameters, overcoming the c/c++ limitation
+ */
+struct PathConstraints {
+        /** the curve used between waypoints. CUBIC_BEZIER by default */
+        SplineType type = SplineType::CUBIC_BEZIER;
+        /** distance between the points of the path, in inches. 1 by default */
+        float spacing = 1;
+        /** the maximum velocity. Units are the same as path files: power out of 127, or inches per second with a
+         * feedforward model. 127 by default */
+        float maxVelocity = 127;
+        /** the minimum velocity, so the robot doesn't stall before the end of the path. 20 by default */
+        float minVelocity = 20;
+        /** how quickly the velocity can change, in velocity units per second: inches per second squared with a
+         * feedforward model. 0 for no limit, which is the default */
+        float maxAcceleration = 0;
+        /** how much the robot slows down around turns. The velocity at a point is at most k divided by the curvature.
+         * 0 for no limit. 3 by default */
+        float k = 3;
+        /** how far the curve bulges out at each waypoint, as a fraction of the distance between waypoints. 1 by
+         * default */
+        float tangentScale = 1;
+};
+
+/**
+ * @brief Generate a path through waypoints
+ *
+ * The path is written into the arena, so generating it doesn't allocate. The velocity of the last point is 0, so
+ * Chassis::follow stops at the end of the path
+ *
+ * @param arena where the path is written
+ * @param waypoints the points the path passes through, in order. At least 2 are needed
+ * @param constraints struct to simulate named parameters
+ * @return Path the path. Empty if there are too few waypoints or the arena is full
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::PathArena arena(1000);
+ *
+ * void autonomous() {
+ *     // a path chosen at runtime
+ *     const lemlib::Path path = lemlib::generatePath(arena, {{0, 0, 0}, {24, 48, 90}, {48, 48, 90}});
+ *     chassis.follow(path, 10, 4000);
+ * }
+ * @endcode
+ */
+Path generatePath(PathArena& arena, const std::vector<Waypoint>& waypoints, const PathConstraints& constraints = {});
+
+/**
+ * @brief Options for macroToPath
+ */
+struct MacroPathOptions {
+        /** how far the simplified route can be from the recorded poses, in inches. 1 by default */
+        float tolerance = 1;
+        /** the constraints the path is generated with, like generatePath. The velocities are planned from them, not
+         * from how fast the driver drove */
+        PathConstraints constraints;
+};
+
+/**
+ * @brief Turn the poses of a driver macro into a path for Chassis::follow
+ *
+ * The recorded poses are simplified with the Douglas-Peucker algorithm, so only the points that shape the route are
+ * kept. A spline is fit through them, passing each in the direction the robot was heading, and its velocities are
+ * planned from the constraints. A route a driver taught slowly can be followed as fast as the robot can drive it.
+ * Write the path with writeBinaryPath to follow it from the SD card later.
+ *
+ * The path goes the way the robot drove. A route driven backwards is the same path followed with forwards set to
+ * false, but a route that changes direction is turned into one path that loops around where it reversed, so record
+ * each direction as its own macro
+ *
+ * @param arena where the path is written
+ * @param macro the macro
+ * @param options struct to simulate named parameters
+ * @return Path the path. Empty if the robot didn't move, or the arena is full
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::PathArena arena(2000);
+ *
+ * void autonomous() {
+ *     lemlib::DriverMacro macro;
+ *     if (!macro.load("/usd/skills.lmc")) return;
+ *     const lemlib::Path path = lemlib::macroToPath(arena, macro, {.tolerance = 0.5});
+ *     lemlib::writeBinaryPath(path, "/usd/skills.lpb");
+ *     chassis.follow(path, 10, 15000);
+ * }
+ * @endcode
+ */
+Path macroToPath(PathArena& arena, const DriverMacro& macro, const MacroPathOptions& options = {});
+} // namespace lemlib
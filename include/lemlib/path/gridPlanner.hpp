@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "lemlib/path/generator.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief Settings for a GridPlanner
+ */
+struct GridPlannerSettings {
+        /** the width of a cell of the grid, in inches. 2 by default */
+        float resolution = 2;
+        /** how far obstacles are grown, so the center of the robot can be planned as a point, in inches. 9 by default
+         */
+        float robotRadius = 9;
+        /** the band past robotRadius where paths cost more, so they keep their distance when there is room, in
+         * inches. 6 by default */
+        float clearance = 6;
+        /** the width of the square field, centered on the origin, in inches. 144 by default */
+        float fieldSize = 144;
+};
+
+/**
+ * @brief The results of the last GridPlanner::plan
+ */
+struct GridPlanStats {
+        /** whether a path to the target was found */
+        bool found = false;
+        /** the number of cells the search expanded */
+        size_t expanded = 0;
+        /** the number of waypoints left once the path was smoothed */
+        size_t waypoints = 0;
+        /** how long the plan took, in microseconds */
+        uint32_t time = 0;
+};
+
+/**
+ * @brief Plans paths around the known elements of the field, so the robot can drive to a target without a hand made
+ * path
+ *
+ * The obstacles are grown by the radius of the robot and drawn into a grid once, usually in initialize. Each cell of
+ * the grid is packed into 2 bits: free, near an obstacle, close to an obstacle, or blocked. A plan runs A* over the
+ * grid with memory that was allocated by build, cuts the corners of the result wherever the robot can see past them,
+ * and generates a path through what is left that Chassis::follow can drive. A plan of the full field takes a few
+ * milliseconds.
+ *
+ * The robot may start inside a grown obstacle, for example right after scoring on a goal, and is planned out of it
+ * first. The walls of the field are always obstacles
+ *
+ * @note not thread safe. Plan from a single task, and don't plan while building
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::PathArena arena(1000);
+ * lemlib::GridPlanner planner;
+ *
+ * void initialize() {
+ *     // the goal in the middle of the field, and a post
+ *     planner.addRectangle(-12, -12, 12, 12);
+ *     planner.addCircle(-48, 0, 3);
+ *     planner.build();
+ * }
+ *
+ * void autonomous() {
+ *     arena.reset();
+ *     const lemlib::Path path = planner.plan(arena, chassis.getPose(), 48, 0);
+ *     if (path.size() != 0) chassis.follow(path, 10, 4000, true, false);
+ * }
+ * @endcode
+ */
+class GridPlanner {
+    public:
+        /**
+         * @brief Construct a new Grid Planner
+         *
+         * @param settings the settings
+         */
+        GridPlanner(GridPlannerSettings settings = {});
+        /**
+         * @brief Add a rectangular obstacle, aligned with the field. Takes effect on the next build
+         *
+         * @param x1 x of one corner, in inches
+         * @param y1 y of one corner, in inches
+         * @param x2 x of the opposite corner, in inches
+         * @param y2 y of the opposite corner, in inches
+         */
+        void addRectangle(float x1, float y1, float x2, float y2);
+        /**
+         * @brief Add a round obstacle. Takes effect on the next build
+         *
+         * @param x x of the center, in inches
+         * @param y y of the center, in inches
+         * @param radius the radius, in inches
+         */
+        void addCircle(float x, float y, float radius);
+        /**
+         * @brief Remove every obstacle. Takes effect on the next build
+         */
+        void clearObstacles();
+        /**
+         * @brief Draw the grown obstacles into the grid, and allocate the memory plans use
+         *
+         * This is the slow part, so it should be called once, in initialize
+         */
+        void build();
+        /**
+         * @brief Check whether the center of the robot can be at a point
+         *
+         * @param x x of the point, in inches
+         * @param y y of the point, in inches
+         * @return true the point is on the field and away from the grown obstacles
+         */
+        bool isFree(float x, float y) const;
+        /**
+         * @brief Plan a path from a pose to a target
+         *
+         * @param arena where the path is written
+         * @param start where the robot starts. The heading isn't used
+         * @param x x of the target, in inches
+         * @param y y of the target, in inches
+         * @param constraints the constraints the path is generated with
+         * @return Path the path. Empty if the planner isn't built, the target is blocked, or the robot can't reach
+         * it
+         */
+        Path plan(PathArena& arena, Pose start, float x, float y, const PathConstraints& constraints = {});
+        /**
+         * @brief Get the results of the last plan
+         *
+         * @return GridPlanStats the results
+         */
+        GridPlanStats getLastStats() const;
+    private:
+        /**
+         * @brief An obstacle, before it is drawn into the grid
+         */
+        struct Obstacle {
+                /** the corners of a rectangle, or the center of a circle in x1 and y1 */
+                float x1, y1, x2, y2;
+                /** the radius of a circle. Negative for a rectangle */
+                float radius;
+        };
+
+        /**
+         * @brief Get the cost level of a cell, from 0 for free to BLOCKED
+         */
+        uint8_t level(size_t cell) const;
+        /**
+         * @brief Get the cost level at a point. Points off the field are blocked
+         */
+        uint8_t levelAt(float x, float y) const;
+        /**
+         * @brief Find the cell a point is in
+         *
+         * @return int the cell, or -1 if the point is off the field
+         */
+        int cellAt(float x, float y) const;
+        /**
+         * @brief Get the center of a cell
+         */
+        Pose cellCenter(size_t cell) const;
+        /**
+         * @brief Run A* from one cell to another, filling in the parents of the cells on the way
+         *
+         * @return true the goal was reached
+         */
+        bool search(size_t start, size_t goal);
+        /**
+         * @brief Check whether the robot can drive straight between 2 points without entering a cell above a level
+         */
+        bool lineOfSight(Pose from, Pose to, uint8_t maxLevel) const;
+        /**
+         * @brief Restore the heap property from a position in the open list towards the top
+         */
+        void siftUp(size_t position);
+        /**
+         * @brief Restore the heap property from a position in the open list towards the bottom
+         */
+        void siftDown(size_t position);
+
+        GridPlannerSettings settings;
+        std::vector<Obstacle> obstacles;
+        /** the number of cells along each side of the grid */
+        size_t width = 0;
+        /** the cost level of each cell, 4 cells to a byte */
+        std::vector<uint8_t> grid;
+        // the memory of a search, allocated by build
+        /** the cost from the start to each cell. Only valid if the cell was visited by this search */
+        std::vector<float> cost;
+        /** the cell each cell was reached from */
+        std::vector<uint32_t> parent;
+        /** the search each cell was last visited by, so the arrays don't have to be cleared between searches */
+        std::vector<uint16_t> visited;
+        /** the position of each cell in the open list, or CLOSED once it has been expanded */
+        std::vector<uint32_t> heapPosition;
+        /** the open list, a binary heap of cells ordered by their cost plus heuristic */
+        std::vector<uint32_t> heap;
+        std::vector<float> priority;
+        size_t heapSize = 0;
+        uint16_t searchId = 0;
+        /** the cells of the last search, from the goal back to the start */
+        std::vector<uint32_t> route;
+        std::vector<Waypoint> waypoints;
+        GridPlanStats stats;
+};
+} // namespace lemlib
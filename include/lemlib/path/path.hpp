@@ -0,0 +1,408 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lemlib/asset.hpp"
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief Header of a packed binary path asset
+ *
+ * Binary paths are generated from the text path format at build time by `firmware/path2bin.py`.
+ * The header is followed by 3 flat float arrays, each with `size` elements: x positions, y positions, and velocities.
+ * The arrays are stored back to back, so a binary path can be read in place without any parsing or allocation.
+ *
+ * The header is 16 bytes long so the float arrays that follow it stay 4 byte aligned.
+ */
+struct BinaryPathHeader {
+        /** magic number used to identify binary paths. Always equal to BINARY_PATH_MAGIC */
+        uint32_t magic;
+        /** version of the binary path format. Always equal to BINARY_PATH_VERSION */
+        uint16_t version;
+        /** reserved for future use */
+        uint16_t flags;
+        /** number of points in the path */
+        uint32_t size;
+        /** reserved for future use */
+        uint32_t reserved;
+};
+
+static_assert(sizeof(BinaryPathHeader) == 16, "BinaryPathHeader must be 16 bytes");
+
+/** magic number of binary paths, "LLPB" in little endian */
+constexpr uint32_t BINARY_PATH_MAGIC = 0x42504C4C;
+/** current version of the binary path format */
+constexpr uint16_t BINARY_PATH_VERSION = 1;
+
+/**
+ * @brief Header of a compressed path asset
+ *
+ * Compressed paths are generated from the text path format at build time by `firmware/path2bin.py --compress`.
+ * Positions are stored in hundredths of an inch: the header is followed by the first point as 2 int32 (x, y), then
+ * 2 int16 arrays with `size` elements holding the change in x and y from the previous point, then a uint8 array of
+ * quantized velocities. That is 5 bytes per point, instead of about 24 for a text path
+ */
+struct CompressedPathHeader {
+        /** magic number used to identify compressed paths. Always equal to COMPRESSED_PATH_MAGIC */
+        uint32_t magic;
+        /** version of the compressed path format. Always equal to COMPRESSED_PATH_VERSION */
+        uint16_t version;
+        /** reserved for future use */
+        uint16_t flags;
+        /** number of points in the path */
+        uint32_t size;
+        /** velocity of each step of a quantized velocity, so the velocity is the quantized value times this */
+        float velocityScale;
+};
+
+static_assert(sizeof(CompressedPathHeader) == 16, "CompressedPathHeader must be 16 bytes");
+
+/** magic number of compressed paths, "LLPC" in little endian */
+constexpr uint32_t COMPRESSED_PATH_MAGIC = 0x43504C4C;
+/** current version of the compressed path format */
+constexpr uint16_t COMPRESSED_PATH_VERSION = 1;
+
+// defined in generator.hpp
+struct PathConstraints;
+
+/**
+ * @brief A path that can be followed by the chassis
+ *
+ * Points are stored as 3 separate arrays: x positions, y positions, and velocities. A path either owns its points,
+ * for example when they were parsed from a text asset, or references them in place, for example when they are read
+ * straight from a binary path asset.
+ *
+ * The curvature of the path at each point is also stored in its own array. Keeping each value in a separate array lets
+ * the per point math, like finding the closest point, be vectorized with NEON.
+ *
+ * When a path is created, it is indexed by arc length: the distance along the path to each point, and the length and
+ * direction of each segment are calculated once. This lets points on the path be found by distance in O(log n) time.
+ *
+ * @note paths can be moved but not copied, since a path may reference memory it doesn't own
+ */
+class Path {
+    public:
+        /**
+         * @brief Construct a new empty path
+         */
+        Path() = default;
+        /**
+         * @brief Construct a new path that owns its points
+         *
+         * @param points the points of the path. The theta of each point is its velocity
+         *
+         * @b Example
+         * @code {.cpp}
+         * // create a path with 2 points
+         * lemlib::Path path({{0, 0, 100}, {0, 10, 0}});
+         * @endcode
+         */
+        Path(const std::vector<Pose>& points);
+        /**
+         * @brief Construct a new path that references points it does not own
+         *
+         * @note the arrays must outlive the path
+         *
+         * @param x array of x positions
+         * @param y array of y positions
+         * @param velocity array of velocities
+         * @param size number of points in the path
+         */
+        Path(const float* x, const float* y, const float* velocity, size_t size);
+        /**
+         * @brief Construct a new path that references points and an arc length index it does not own
+         *
+         * Nothing is allocated, so paths can be built at runtime from preallocated memory, like a PathArena
+         *
+         * @note the arrays must outlive the path
+         *
+         * @param x array of x positions
+         * @param y array of y positions
+         * @param velocity array of velocities
+         * @param size number of points in the path
+         * @param indexStorage memory for the arc length index, with room for INDEX_FLOATS * size floats
+         */
+        Path(const float* x, const float* y, const float* velocity, size_t size, float* indexStorage);
+        /**
+         * @brief Construct a new path that references points and an arc length index that were already calculated,
+         * like a path baked by bakePath
+         *
+         * Nothing is calculated or allocated, so the points and the index can live in flash
+         *
+         * @note the arrays must outlive the path
+         *
+         * @param x array of x positions
+         * @param y array of y positions
+         * @param velocity array of velocities
+         * @param size number of points in the path
+         * @param index the arc length index, INDEX_FLOATS * size floats in the layout bakePath writes
+         * @param spacing the distance between the points, or 0 if they aren't evenly spaced
+         */
+        Path(const float* x, const float* y, const float* velocity, size_t size, const float* index, float spacing);
+        /** number of floats of the arc length index for each point */
+        static constexpr size_t INDEX_FLOATS = 5;
+        Path(Path&& other) = default;
+        Path& operator=(Path&& other) = default;
+        Path(const Path&) = delete;
+        Path& operator=(const Path&) = delete;
+        /**
+         * @brief Get the number of points in the path
+         *
+         * @return size_t number of points
+         */
+        size_t size() const { return count; }
+        /**
+         * @brief Get a point on the path
+         *
+         * @param index the index of the point
+         * @return Pose the point. The theta of the pose is the velocity of the path at that point
+         */
+        Pose at(size_t index) const { return Pose(xData[index], yData[index], velocityData[index]); }
+        /**
+         * @brief Get the velocity of the path at a point
+         *
+         * @param index the index of the point
+         * @return float velocity
+         */
+        float velocity(size_t index) const { return velocityData[index]; }
+        /**
+         * @brief Get the curvature of the path at a point
+         *
+         * @param index the index of the point
+         * @return float signed curvature, positive when the path turns counterclockwise. 0 for the first and last point
+         */
+        float curvature(size_t index) const { return curvatures[index]; }
+        /**
+         * @brief Find the point closest to a pose in a range of points
+         *
+         * On the V5 brain, 4 points are compared at a time using NEON
+         *
+         * @param pose the pose to find the closest point to
+         * @param start index of the first point to search
+         * @param end index after the last point to search
+         * @param closestDist output for the distance between the pose and the closest point
+         * @return size_t index of the closest point. start if the range is empty
+         */
+        size_t closest(Pose pose, size_t start, size_t end, float& closestDist) const;
+        /**
+         * @brief Get the distance along the path from the first point to a point
+         *
+         * @param index the index of the point
+         * @return float distance along the path
+         */
+        float distance(size_t index) const { return distances[index]; }
+        /**
+         * @brief Get the length of the segment between a point and the next point
+         *
+         * @param index the index of the first point of the segment
+         * @return float length of the segment. 0 for the last point
+         */
+        float segmentLength(size_t index) const { return segmentLengths[index]; }
+        /**
+         * @brief Get the direction of the segment between a point and the next point
+         *
+         * @param index the index of the first point of the segment
+         * @return Pose unit vector pointing along the segment. Zero for the last point
+         */
+        Pose segmentDirection(size_t index) const { return Pose(directionsX[index], directionsY[index]); }
+        /**
+         * @brief Get the total length of the path
+         *
+         * @return float length of the path
+         */
+        float length() const { return count == 0 ? 0 : distances[count - 1]; }
+        /**
+         * @brief Find the segment which contains the point a certain distance along the path
+         *
+         * This uses a binary search, so it takes O(log n) time. Paths made by resample have evenly spaced points, so
+         * the segment is found in O(1) time instead
+         *
+         * @param distance distance along the path
+         * @return size_t index of the first point of the segment
+         */
+        size_t segmentAt(float distance) const;
+        /**
+         * @brief Get the point a certain distance along the path
+         *
+         * @param distance distance along the path. Clamped to the start and end of the path
+         * @return Pose the point. The theta of the pose is the velocity of the segment the point is on
+         */
+        Pose pointAt(float distance) const;
+        /**
+         * @brief Get how far along the path a pose is, by projecting it onto the segments around a point
+         *
+         * @param pose the pose to project
+         * @param index index of the point closest to the pose
+         * @return float distance along the path of the projected pose
+         */
+        float project(Pose pose, size_t index) const;
+        /**
+         * @brief Replace the velocities of the path with ones planned from its curvature
+         *
+         * The velocity at each point is limited by the curvature there, then forward and backward passes limit how
+         * quickly it changes, so the robot can speed up and slow down in time. The last point is always 0, so the
+         * robot stops at the end of the path. Velocities in a binary path asset aren't changed, the path is given its
+         * own copy
+         *
+         * @note the path must not be followed while its velocities are planned
+         *
+         * @param constraints the limits of the drivetrain, like generatePath. Only the velocity limits are used
+         * @param voltageScale fraction of the maximum velocity the battery can reach, from 0 to 1. 1 by default
+         */
+        void planVelocity(const PathConstraints& constraints, float voltageScale = 1);
+        /**
+         * @brief Make a copy of the path with evenly spaced points
+         *
+         * Points are placed every spacing inches along the path, and take the velocity of the segment they are on. The
+         * last point is kept as is, so the robot still stops at the end of the path
+         *
+         * @param spacing the distance between points, in inches
+         * @return Path the resampled path. It owns its points
+         *
+         * @b Example
+         * @code {.cpp}
+         * // a point every 4 inches, instead of every 2 like most exported paths
+         * lemlib::Path path = lemlib::loadPath(myPath_txt).resample(4);
+         * @endcode
+         */
+        Path resample(float spacing) const;
+        /**
+         * @brief Make a copy of the path with the points that don't change its shape removed
+         *
+         * Uses the Douglas-Peucker algorithm: points are only kept if leaving them out would move the path more than
+         * the tolerance, so straights end up with very few points. The first and last points are always kept
+         *
+         * @param tolerance the furthest the simplified path can be from the original, in inches
+         * @return Path the simplified path. It owns its points
+         */
+        Path decimate(float tolerance) const;
+        /**
+         * @brief Make a copy of the path in other coordinates, like the route mirrored for the other alliance
+         *
+         * Rigid transforms and mirrors don't change the spacing, curvature, or length of a path, so the copy is
+         * searched as quickly as the original
+         *
+         * @param transform the transform from the coordinates of the path to the field
+         * @return Path the transformed path. It owns its points, and keeps their velocities
+         */
+        Path transformed(const FieldTransform& transform) const;
+    private:
+        /**
+         * @brief Calculate the arc length index of the path
+         *
+         * @param memory where the index is written, with room for INDEX_FLOATS * count floats. If it is null, the
+         * path allocates the index itself
+         */
+        void index(float* memory = nullptr);
+
+        std::vector<float> storage;
+        std::vector<float> indexStorage;
+        std::vector<float> plannedVelocities;
+        // distance between points of a resampled path, 0 if the points aren't evenly spaced
+        float spacing = 0;
+        const float* curvatures = nullptr;
+        const float* distances = nullptr;
+        const float* segmentLengths = nullptr;
+        const float* directionsX = nullptr;
+        const float* directionsY = nullptr;
+        const float* xData = nullptr;
+        const float* yData = nullptr;
+        const float* velocityData = nullptr;
+        size_t count = 0;
+};
+
+/**
+ * @brief Limit how quickly the velocities of a path change, so the robot can speed up and slow down in time
+ *
+ * A forward pass speeds up from the minimum velocity, and a backward pass slows down to it at the last point. The
+ * velocity of the last point isn't changed. Used by generatePath and Path::planVelocity
+ *
+ * @param path the path, for the distances between its points
+ * @param velocities the velocities of the points of the path, limited in place
+ * @param minVelocity the velocity at the start and the end of the path
+ * @param maxAcceleration how quickly the velocity can change, like PathConstraints::maxAcceleration. 0 for no limit
+ */
+void limitAcceleration(const Path& path, float* velocities, float minVelocity, float maxAcceleration);
+
+/**
+ * @brief Check whether an asset is a packed binary path
+ *
+ * @param path the asset to check
+ * @return true the asset is a binary path
+ * @return false the asset is not a binary path
+ */
+bool isBinaryPath(const asset& path);
+
+/**
+ * @brief Read a packed binary path in place
+ *
+ * No parsing or allocation is done, the returned path references the asset buffer directly.
+ * If the asset is malformed, an empty path is returned.
+ *
+ * @param path the binary path asset
+ * @return Path the path
+ */
+Path readBinaryPath(const asset& path);
+
+/**
+ * @brief Write a path to a file in the packed binary path format
+ *
+ * The file can be followed from the SD card with Chassis::follow, or copied into static/ and embedded with ASSET()
+ *
+ * @param path the path
+ * @param filename the name of the file. Files on the SD card start with /usd/
+ * @return true the file was written
+ * @return false the path is empty, or the file couldn't be written
+ */
+bool writeBinaryPath(const Path& path, const std::string& filename);
+
+/**
+ * @brief Check whether an asset is a compressed path
+ *
+ * @param path the asset to check
+ * @return true the asset is a compressed path
+ * @return false the asset is not a compressed path
+ */
+bool isCompressedPath(const asset& path);
+
+/**
+ * @brief Decode a compressed path
+ *
+ * Each point only depends on the point before it, so the path is decoded in a single pass with one allocation.
+ * If the asset is malformed, an empty path is returned.
+ *
+ * @param path the compressed path asset
+ * @return Path the path. It owns its points
+ */
+Path readCompressedPath(const asset& path);
+
+/**
+ * @brief Load a path from an asset
+ *
+ * Binary paths are read in place. Compressed paths are decoded and text paths are parsed, and the returned path owns
+ * the points.
+ * If the asset can't be read, an empty path is returned.
+ *
+ * @note prefer Chassis::preloadPath or pathCache() over calling this directly, so the path is only loaded once
+ *
+ * @param path the asset to load
+ * @return Path the path
+ */
+Path loadPath(const asset& path);
+
+/**
+ * @brief How paths are simplified when they are loaded, see PathCache::setLoadOptions
+ */
+struct PathLoadOptions {
+        /** distance between points after resampling, in inches. 0 to keep the points in the file, which is the
+         * default */
+        float spacing = 0;
+        /** how far a simplified path can be from the original, in inches. 0 to keep every point, which is the
+         * default. Applied after resampling, so the points aren't evenly spaced anymore */
+        float tolerance = 0;
+};
+} // namespace lemlib
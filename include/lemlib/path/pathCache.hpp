@@ -0,0 +1,205 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "pros/rtos.hpp"
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/path/generator.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/trajectory.hpp"
+
+namespace lemlib {
+/**
+ * @brief A cache of loaded paths, keyed by the asset they were loaded from
+ *
+ * Loading a text path means parsing it, which can take a long time for big paths. The cache makes sure every asset
+ * is only loaded once, no matter how many times it is followed. Paths can be loaded ahead of time with preload(), so
+ * the motion that follows them starts immediately. Paths can also be read from the SD card with file(), so routes
+ * can be changed without uploading the program again.
+ *
+ * @note cached paths are never freed
+ */
+class PathCache {
+    public:
+        PathCache() = default;
+        PathCache(const PathCache&) = delete;
+        PathCache& operator=(const PathCache&) = delete;
+        /**
+         * @brief Get the path loaded from an asset, loading it if it isn't in the cache yet
+         *
+         * A transformed path is made from the loaded path once, and cached next to it, so following a mirrored route
+         * costs the same as following the original. This function is thread safe. The returned reference is valid
+         * for the lifetime of the program
+         *
+         * @param path the path asset
+         * @param transform the transform from the coordinates of the path to the field. None by default
+         * @return const Path& the loaded path
+         */
+        const Path& get(const asset& path, const FieldTransform& transform = FieldTransform());
+        /**
+         * @brief Load a path into the cache if it isn't in the cache yet
+         *
+         * @param path the path asset
+         * @param transform the transform from the coordinates of the path to the field. None by default
+         * @return true the path was loaded successfully
+         * @return false the path is empty or couldn't be read
+         *
+         * @b Example
+         * @code {.cpp}
+         * ASSET(myPath_txt);
+         *
+         * void initialize() {
+         *     // parse the path before autonomous starts
+         *     lemlib::pathCache().preload(myPath_txt);
+         * }
+         * @endcode
+         */
+        bool preload(const asset& path, const FieldTransform& transform = FieldTransform());
+        /**
+         * @brief Check whether a path is in the cache
+         *
+         * @param path the path asset
+         * @return true the path has been loaded
+         * @return false the path has not been loaded
+         */
+        bool contains(const asset& path);
+        /**
+         * @brief Get a path file on the SD card as an asset, reading it if it hasn't been read yet
+         *
+         * The file is read once, and kept for the lifetime of the program, so the asset can be followed and preloaded
+         * like one made with ASSET(). Binary paths are read in place from it. If the file is being read by prefetch,
+         * this waits for it to be read instead of reading it again. This function is thread safe
+         *
+         * @param filename the name of the file, like "/usd/paths/route1.lpb"
+         * @return asset the contents of the file. Empty if the file couldn't be read
+         *
+         * @b Example
+         * @code {.cpp}
+         * void autonomous() {
+         *     chassis.follow(lemlib::pathCache().file("/usd/paths/route1.lpb"), 10, 4000);
+         * }
+         * @endcode
+         */
+        asset file(const std::string& filename);
+        /**
+         * @brief Read and load a path file on the SD card in the background
+         *
+         * Files are read and loaded in order by a low priority task, so reading the SD card doesn't hold up the
+         * caller or the motions. The task is started the first time this is called
+         *
+         * @param filename the name of the file, like "/usd/paths/route1.lpb"
+         * @param transform the transform from the coordinates of the path to the field. None by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // read the routes while the robot waits for autonomous
+         *     lemlib::pathCache().prefetch("/usd/paths/route1.lpb");
+         *     lemlib::pathCache().prefetch("/usd/paths/route2.lpb");
+         * }
+         * @endcode
+         */
+        void prefetch(const std::string& filename, const FieldTransform& transform = FieldTransform());
+        /**
+         * @brief Get the trajectory planned along the path loaded from an asset, planning it if it isn't in the cache
+         *
+         * Trajectories are planned once for each path and direction, with the constraints they were first requested
+         * with. This function is thread safe. The returned reference is valid for the lifetime of the program
+         *
+         * @param path the path asset
+         * @param forwards whether the robot drives the path forwards
+         * @param constraints the limits of the drivetrain
+         * @param transform the transform from the coordinates of the path to the field. None by default
+         * @return const Trajectory& the planned trajectory. Empty if the path couldn't be loaded
+         */
+        const Trajectory& getTrajectory(const asset& path, bool forwards, const TrajectoryConstraints& constraints,
+                                        const FieldTransform& transform = FieldTransform());
+        /**
+         * @brief Plan the velocities of paths when they are loaded, instead of using the velocities in the file
+         *
+         * The maximum velocity is scaled by the battery voltage when the path is loaded, so the robot doesn't ask
+         * for more than the battery can give. Paths that are already loaded are replanned
+         *
+         * @param constraints the limits of the drivetrain, like generatePath. Only the velocity limits are used.
+         * std::nullopt to use the velocities in the path files for paths loaded from now on
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     const lemlib::PathConstraints constraints {.maxVelocity = 100, .maxAcceleration = 200};
+         *     lemlib::pathCache().setVelocityConstraints(constraints);
+         *     chassis.preloadPath(myPath_txt);
+         * }
+         * @endcode
+         */
+        void setVelocityConstraints(std::optional<PathConstraints> constraints);
+        /**
+         * @brief Resample and simplify paths when they are loaded
+         *
+         * Exported paths usually have a point every 2 inches. Spacing them out, and removing the points on straights,
+         * makes finding the closest point and the lookahead point cheaper every iteration of follow. Resampled
+         * binary paths are copied, since their points change
+         *
+         * @note only paths loaded after this is called are changed, so call it before preloading any paths
+         *
+         * @param options how paths are simplified
+         *
+         * @b Example
+         * @code {.cpp}
+         * void initialize() {
+         *     // a point every 4 inches, with points less than 0.1 inches from the path removed
+         *     lemlib::pathCache().setLoadOptions({4, 0.1});
+         *     chassis.preloadPath(myPath_txt);
+         * }
+         * @endcode
+         */
+        void setLoadOptions(PathLoadOptions options);
+        /**
+         * @brief Plan the velocities of every loaded path again, with the current battery voltage
+         *
+         * Call this right before autonomous starts, since the battery sags more under load the longer it has been
+         * running. Does nothing if setVelocityConstraints hasn't been called
+         *
+         * @note no loaded path may be followed while this runs
+         */
+        void replan();
+    private:
+        /**
+         * @brief Plan the velocities of a path with the current battery voltage, if there are constraints
+         */
+        void plan(Path& path);
+
+        PathLoadOptions loadOptions;
+        std::optional<PathConstraints> constraints;
+        /**
+         * @brief The key of a transformed path: the asset, then the mirrors of x and y, and the rotation
+         */
+        using TransformKey = std::tuple<const uint8_t*, bool, bool, float>;
+
+        std::map<const uint8_t*, Path> paths;
+        std::map<TransformKey, Path> transformedPaths;
+        std::map<std::pair<TransformKey, bool>, Trajectory> trajectories;
+        pros::Mutex mutex;
+        // the contents of the files read from the SD card. Their buffers are the keys of the paths loaded from them
+        std::map<std::string, std::vector<uint8_t>> files;
+        // files waiting to be read by the prefetch task
+        std::vector<std::pair<std::string, FieldTransform>> prefetchQueue;
+        pros::Task* prefetchTask = nullptr;
+        // guards the queue and the task, and is never held while a file is read, so prefetch doesn't wait for the SD
+        // card
+        pros::Mutex queueMutex;
+        // guards the files, and is held while one is read, so reading the SD card doesn't block getting a path
+        pros::Mutex fileMutex;
+};
+
+/**
+ * @brief Get the path cache used by the chassis
+ *
+ * @return PathCache&
+ */
+PathCache& pathCache();
+} // namespace lemlib
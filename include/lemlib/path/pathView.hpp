@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief A view of one or more paths, driven backwards, cut short, chained, or mirrored, without copying any points
+ *
+ * A view is a short list of parts. Each part is a range of the points of a path, read forwards or backwards, and
+ * moved by a rotation or a mirror. Points, distances, and segments of the view are worked out from the arc length
+ * index of each path when they are needed, and finding the closest point searches the paths themselves, so a view is
+ * followed nearly as quickly as a path. One stored path, usually one that is cached, covers every variant of a route
+ * without another file in the static folder.
+ *
+ * The last point of a view always has a velocity of 0, so the robot stops at the end of the view. Inside the view, the
+ * ends of the paths it is made of take the velocity of the point before them, so the robot doesn't stop between
+ * chained paths or at the start of a reversed path. Parts are joined by a straight segment, which is empty if they
+ * meet
+ *
+ * Views are small and are copied by value, so they can be built in place when a motion is queued
+ *
+ * @note the paths must outlive the view, and every motion that follows it
+ *
+ * @b Example
+ * @code {.cpp}
+ * ASSET(toGoal_txt);
+ * ASSET(toLadder_txt);
+ *
+ * void autonomous() {
+ *     const lemlib::PathView toGoal(lemlib::pathCache().get(toGoal_txt));
+ *     const lemlib::PathView toLadder(lemlib::pathCache().get(toLadder_txt));
+ *     // out to the goal, then back the way the robot came
+ *     chassis.follow(toGoal, 10, 4000);
+ *     chassis.follow(toGoal.reversed(), 10, 4000, false);
+ *     // the same route on the other side of the field, then straight on to the ladder
+ *     chassis.follow(toGoal.transformed(lemlib::FieldTransform(true)).then(toLadder), 10, 6000);
+ *     // only the first 20 points of the route
+ *     chassis.follow(toGoal.subrange(0, 20), 10, 2000);
+ * }
+ * @endcode
+ */
+class PathView {
+    public:
+        /** most parts a view can have */
+        static constexpr size_t MAX_PARTS = 4;
+        /**
+         * @brief Construct a new empty view
+         */
+        PathView() = default;
+        /**
+         * @brief Construct a new view of a whole path
+         *
+         * @param path the path. Must outlive the view
+         */
+        PathView(const Path& path);
+        /**
+         * @brief Get a view of the same points in the opposite order
+         *
+         * @return PathView the reversed view
+         */
+        PathView reversed() const;
+        /**
+         * @brief Get a view of a range of the points of this view
+         *
+         * @param begin index of the first point of the range
+         * @param end index after the last point of the range. Clamped to the size of the view
+         * @return PathView the view of the range. Empty if the range is empty
+         */
+        PathView subrange(size_t begin, size_t end) const;
+        /**
+         * @brief Get a view of this view followed by another
+         *
+         * @param next the view driven after this one
+         * @return PathView the chained view. Empty if the views have more than MAX_PARTS parts between them
+         */
+        PathView then(const PathView& next) const;
+        /**
+         * @brief Get a view of the points moved to other coordinates, like the route mirrored for the other alliance
+         *
+         * @param transform the transform from the coordinates of this view to the new ones
+         * @return PathView the transformed view
+         */
+        PathView transformed(const FieldTransform& transform) const;
+        /**
+         * @brief Get the number of points in the view
+         *
+         * @return size_t number of points
+         */
+        size_t size() const { return count; }
+        /**
+         * @brief Get a point of the view
+         *
+         * @param index the index of the point
+         * @return Pose the point. The theta of the pose is the velocity of the view at that point
+         */
+        Pose at(size_t index) const;
+        /**
+         * @brief Get the velocity of the view at a point
+         *
+         * @param index the index of the point
+         * @return float velocity. 0 for the last point
+         */
+        float velocity(size_t index) const;
+        /**
+         * @brief Get the curvature of the view at a point
+         *
+         * @param index the index of the point
+         * @return float signed curvature, positive when the view turns counterclockwise. 0 for the first and last point
+         */
+        float curvature(size_t index) const;
+        /**
+         * @brief Find the point closest to a pose in a range of points
+         *
+         * Each part is searched by its path, so the search is vectorized the same way
+         *
+         * @param pose the pose to find the closest point to
+         * @param start index of the first point to search
+         * @param end index after the last point to search
+         * @param closestDist output for the distance between the pose and the closest point
+         * @return size_t index of the closest point. start if the range is empty
+         */
+        size_t closest(Pose pose, size_t start, size_t end, float& closestDist) const;
+        /**
+         * @brief Get the distance along the view from the first point to a point
+         *
+         * @param index the index of the point
+         * @return float distance along the view
+         */
+        float distance(size_t index) const;
+        /**
+         * @brief Get the length of the segment between a point and the next point
+         *
+         * @param index the index of the first point of the segment
+         * @return float length of the segment. 0 for the last point
+         */
+        float segmentLength(size_t index) const;
+        /**
+         * @brief Get the total length of the view
+         *
+         * @return float length of the view
+         */
+        float length() const { return count == 0 ? 0 : distance(count - 1); }
+        /**
+         * @brief Find the segment which contains the point a certain distance along the view
+         *
+         * @param distance distance along the view
+         * @return size_t index of the first point of the segment
+         */
+        size_t segmentAt(float distance) const;
+        /**
+         * @brief Get the point a certain distance along the view
+         *
+         * @param distance distance along the view. Clamped to the start and end of the view
+         * @return Pose the point. The theta of the pose is the velocity of the segment the point is on
+         */
+        Pose pointAt(float distance) const;
+        /**
+         * @brief Get how far along the view a pose is, by projecting it onto the segments around a point
+         *
+         * @param pose the pose to project
+         * @param index index of the point closest to the pose
+         * @return float distance along the view of the projected pose
+         */
+        float project(Pose pose, size_t index) const;
+    private:
+        /**
+         * @brief A range of the points of a path, as the view sees them
+         */
+        struct Part {
+                const Path* path = nullptr;
+                /** the range of points of the path, end exclusive */
+                size_t begin = 0;
+                size_t end = 0;
+                /** whether the points are read from end to begin */
+                bool reversed = false;
+                /** the rotation or mirror from the path to the view. A 2 by 2 matrix, by rows */
+                float xx = 1, xy = 0, yx = 0, yy = 1;
+                /** index in the view of the first point of the part */
+                size_t first = 0;
+                /** distance along the view of the first point of the part */
+                float offset = 0;
+                /** distance along the path of the first point of the part */
+                float start = 0;
+                /** length of the part, not counting the segment joining it to the next part */
+                float length = 0;
+                /** length of the segment joining the part to the next part */
+                float gap = 0;
+        };
+
+        /**
+         * @brief Get the part a point is in
+         */
+        const Part& partOf(size_t index) const;
+        /**
+         * @brief Get the index in the path of a point of a part
+         */
+        static size_t source(const Part& part, size_t index);
+        /**
+         * @brief Move a point of a path to the view
+         */
+        static Pose place(const Part& part, Pose point);
+        /**
+         * @brief Work out where each part starts, and the length of the view, after the parts change
+         */
+        void join();
+
+        std::array<Part, MAX_PARTS> parts;
+        size_t partCount = 0;
+        size_t count = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "lemlib/path/generator.hpp"
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief A path stored as a piecewise cubic curve, instead of a list of points
+ *
+ * The path is made of one cubic Hermite spline between each pair of waypoints, with tangents along the heading of
+ * each waypoint, the same curves generatePath makes with CUBIC_BEZIER. The closest point and the lookahead point are
+ * found on the curve itself with Newton's method, so a path only needs a few coefficients per waypoint and its
+ * accuracy doesn't depend on how densely it is sampled.
+ *
+ * Positions on the path are given by a parameter from 0 to the number of splines. The integer part is the spline,
+ * and the fractional part is how far along the spline
+ *
+ * @b Example
+ * @code {.cpp}
+ * const lemlib::SplinePath path({{0, 0, 0}, {24, 48, 90}, {48, 48, 90}});
+ * chassis.follow(path, 10, 4000);
+ * @endcode
+ */
+class SplinePath {
+    public:
+        /**
+         * @brief Construct a new Spline Path
+         *
+         * @param waypoints the points the path passes through, in order. At least 2 are needed
+         * @param constraints the maximum velocity, the minimum velocity, k, and the tangent scale are used. Velocities
+         * are in the same units as path files
+         */
+        SplinePath(const std::vector<Waypoint>& waypoints, const PathConstraints& constraints = {});
+        /**
+         * @brief Get the number of splines in the path
+         *
+         * @return size_t the number of splines. The parameter of the end of the path
+         */
+        size_t size() const { return splines.size(); }
+        /**
+         * @brief Get the point at a parameter
+         *
+         * @param u the parameter, clamped to the path
+         * @return Pose the point. The theta is 0
+         */
+        Pose at(float u) const;
+        /**
+         * @brief Get the signed curvature of the path at a parameter
+         *
+         * @param u the parameter, clamped to the path
+         * @return float the curvature, positive when the path turns counterclockwise
+         */
+        float curvature(float u) const;
+        /**
+         * @brief Get the target velocity at a parameter
+         *
+         * @param u the parameter, clamped to the path
+         * @return float the velocity, limited by the curvature. 0 at the end of the path
+         */
+        float velocity(float u) const;
+        /**
+         * @brief Find the parameter of the point on the path closest to a pose
+         *
+         * Newton's method is started from a guess, usually the closest point from the last iteration, so it only
+         * takes a few steps
+         *
+         * @param pose the pose
+         * @param guess the parameter to start from
+         * @return float the parameter of the closest point
+         */
+        float closest(Pose pose, float guess) const;
+        /**
+         * @brief Find the parameter of the lookahead point
+         *
+         * The lookahead point is the first point after the closest point that is the lookahead distance from the pose.
+         * If the end of the path is closer than that, the end of the path is used
+         *
+         * @param pose the pose
+         * @param closest the parameter of the closest point
+         * @param guess the parameter to start from, usually the lookahead point from the last iteration
+         * @param lookahead the lookahead distance, in inches
+         * @return float the parameter of the lookahead point
+         */
+        float lookahead(Pose pose, float closest, float guess, float lookahead) const;
+    private:
+        /**
+         * @brief Coefficients of a cubic spline: a + b t + c t^2 + d t^3 on each axis
+         */
+        struct Spline {
+                float ax, bx, cx, dx;
+                float ay, by, cy, dy;
+        };
+
+        /**
+         * @brief Find the spline and the parameter on it
+         *
+         * @param u the parameter of the path
+         * @param t set to the parameter on the spline, from 0 to 1
+         * @return const Spline& the spline
+         */
+        const Spline& locate(float u, float& t) const;
+        /**
+         * @brief Get the point, first derivative, and second derivative at a parameter
+         */
+        void evaluate(float u, Pose& point, Pose& first, Pose& second) const;
+
+        std::vector<Spline> splines;
+        float maxVelocity;
+        float minVelocity;
+        float k;
+};
+} // namespace lemlib
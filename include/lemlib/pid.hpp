@@ -1,8 +1,48 @@
 #pragma once
 
+#include <optional>
+#include "lemlib/fixed.hpp"
+#include "lemlib/gainSchedule.hpp"
+
 namespace lemlib {
-class PID {
+/**
+ * @brief The update period the gains of the PIDs of the chassis and mechanisms are tuned for, in milliseconds
+ *
+ * Controllers that update at another period scale their time step by the period divided by this, with setTimeStep
+ */
+constexpr float TUNED_PERIOD = 10;
+
+/**
+ * @brief How the PID keeps the integral from winding up while the output is limited
+ */
+enum class AntiWindup {
+    NONE, /** only the windup range and sign flip reset are used */
+    CLAMP, /** the integral stops growing while the output is limited and the error would push it further */
+    BACK_CALCULATION /** the integral is pulled back by how much the output was limited */
+};
+
+/**
+ * @brief A PID controller
+ *
+ * The math is done in float by default, which lemlib::PID is an alias of. BasicPID<double> and
+ * BasicPID<lemlib::Fixed> run the same controller in double and fixed point precision, so the cost and accuracy of
+ * each can be compared. Gain schedules are always looked up in float
+ *
+ * @tparam T the type the math is done in. float, double, or lemlib::Fixed
+ */
+template <typename T = float> class BasicPID {
     public:
+        /**
+         * @brief The terms of the output of the last update, before the output limit
+         */
+        struct Terms {
+                T p = T(0);
+                T i = T(0);
+                T d = T(0);
+                /** the error the terms were found from */
+                T error = T(0);
+        };
+
         /**
          * @brief Construct a new PID
          *
@@ -22,13 +62,13 @@ class PID {
          *         false); // don't reset integral when sign of error flips
          * @endcode
          */
-        PID(float kP, float kI, float kD, float windupRange = 0, bool signFlipReset = false);
+        BasicPID(T kP, T kI, T kD, T windupRange = T(0), bool signFlipReset = false);
 
         /**
          * @brief Update the PID
          *
          * @param error target minus position - AKA error
-         * @return float output
+         * @return T output
          *
          * @b Example
          * @code {.cpp}
@@ -41,7 +81,132 @@ class PID {
          * }
          * @endcode
          */
-        float update(float error);
+        T update(T error);
+
+        /**
+         * @brief Update the PID, using a derivative measured by a sensor
+         *
+         * Taking the derivative from the measurement instead of the change in error avoids the noise of
+         * differentiating a sampled value, and isn't a tick out of date
+         *
+         * @param error target minus position - AKA error
+         * @param derivative the change in error per update. If the target doesn't move, this is the negative of
+         * the change in position per update
+         * @return T output
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // create a PID
+         *     PID pid(5, 0, 20);
+         *     // the position is moving towards the target at 2 units per update
+         *     float output = pid.update(10, -2);
+         * }
+         * @endcode
+         */
+        T update(T error, T derivative);
+
+        /**
+         * @brief Set the length of the following updates, relative to the update period the gains were tuned at
+         *
+         * The integral is accumulated in proportion to the time step, and the derivative is divided by it, so the
+         * output stays the same when the update period changes
+         *
+         * @param timeStep the time step. 1 by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // create a PID, tuned with updates every 10 ms
+         *     PID pid(5, 0.01, 20);
+         *     // this update happened 5 ms after the last one
+         *     pid.setTimeStep(0.5);
+         *     float output = pid.update(10);
+         * }
+         * @endcode
+         */
+        void setTimeStep(T timeStep);
+
+        /**
+         * @brief Change the constant gains
+         *
+         * The integral and derivative state are kept, so the gains can be changed while the PID is running
+         *
+         * @param kP proportional gain
+         * @param kI integral gain
+         * @param kD derivative gain
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     PID pid(5, 0, 20);
+         *     // use the gains found by a tuning tool
+         *     pid.setGains(6, 0, 25);
+         * }
+         * @endcode
+         */
+        void setGains(T kP, T kI, T kD);
+
+        /**
+         * @brief Set a gain schedule, which replaces the constant gains
+         *
+         * @param schedule the schedule, or std::nullopt to use the constant gains again
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // create a PID
+         *     PID pid(5, 0, 20);
+         *     // use higher gains when the error is small
+         *     pid.setGainSchedule(GainSchedule(ScheduleKey::ERROR, {{5, {8, 0, 30}}, {40, {5, 0, 20}}}));
+         *     float output = pid.update(10);
+         * }
+         * @endcode
+         */
+        void setGainSchedule(std::optional<GainSchedule> schedule);
+
+        /**
+         * @brief Low pass filter the derivative, so noise in the error doesn't make the output chatter
+         *
+         * The filter is first order, and the time step is taken into account, so it filters the same at any update
+         * period
+         *
+         * @param timeConstant the time constant of the filter, in updates of the period the gains were tuned at.
+         * Higher values filter more. 0 to disable the filter, which is the default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // create a PID
+         *     PID pid(5, 0, 20);
+         *     // filter the derivative over about 2 updates
+         *     pid.setDerivativeFilter(2);
+         *     float output = pid.update(10);
+         * }
+         * @endcode
+         */
+        void setDerivativeFilter(T timeConstant);
+
+        /**
+         * @brief Limit the output of the PID
+         *
+         * @param limit the largest magnitude of the output. 0 for no limit, which is the default
+         * @param antiWindup how the integral is kept from winding up while the output is limited
+         * @param backCalculationGain how fast back calculation pulls the integral back, as a fraction of the
+         * amount the output was limited per update. Only used by AntiWindup::BACK_CALCULATION. 1 by default
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     // create a PID
+         *     PID pid(5, 0.1, 20);
+         *     // the motors can't do more than 127, so don't let the integral grow past that
+         *     pid.setOutputLimit(127, AntiWindup::CLAMP);
+         *     float output = pid.update(100); // output = 127
+         * }
+         * @endcode
+         */
+        void setOutputLimit(T limit, AntiWindup antiWindup = AntiWindup::CLAMP, T backCalculationGain = T(1));
 
         /**
          * @brief reset integral, derivative, and prevTime
@@ -60,17 +225,50 @@ class PID {
          * @endcode
          */
         void reset();
+
+        /**
+         * @brief Get the terms of the last update, for telemetry
+         *
+         * @return const Terms& the proportional, integral, and derivative terms. 0 after a reset
+         *
+         * @b Example
+         * @code {.cpp}
+         * void opcontrol() {
+         *     PID pid(5, 0.01, 20);
+         *     pid.update(10);
+         *     float p = pid.getTerms().p; // p = 50
+         * }
+         * @endcode
+         */
+        const Terms& getTerms() const;
     protected:
         // gains
-        const float kP;
-        const float kI;
-        const float kD;
+        T kP;
+        T kI;
+        T kD;
 
         // optimizations
-        const float windupRange;
+        const T windupRange;
         const bool signFlipReset;
 
-        float integral = 0;
-        float prevError = 0;
+        T integral = 0;
+        T prevError = 0;
+        T timeStep = 1;
+        std::optional<GainSchedule> schedule = std::nullopt;
+
+        T derivativeFilter = 0;
+        T filteredDerivative = 0;
+        T outputLimit = 0;
+        AntiWindup antiWindup = AntiWindup::NONE;
+        T backCalculationGain = 1;
+        Terms terms;
 };
+
+/** a PID controller that does its math in float, the precision used throughout LemLib */
+using PID = BasicPID<float>;
+
+// the precisions are compiled once, in pid.cpp
+extern template class BasicPID<float>;
+extern template class BasicPID<double>;
+extern template class BasicPID<Fixed>;
 } // namespace lemlib
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <cmath>
+#include <cstddef>
 #include <string>
+#include <type_traits>
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 namespace lemlib {
 /**
@@ -11,12 +17,18 @@ namespace lemlib {
  * especially in motion algorithms and position tracking.
  *
  * The Pose class overloads operators so you can easily add, subtract, multiply, etc.
+ *
+ * The components are float by default, which lemlib::Pose is an alias of. BasicPose<double> and
+ * BasicPose<lemlib::Fixed> use the same math in double and fixed point precision, so the cost and accuracy of each can
+ * be compared, or double can be used where rounding adds up
+ *
+ * @tparam T the type of the components. float, double, or lemlib::Fixed
  */
-class Pose {
+template <typename T = float> class BasicPose {
     public:
-        float x;
-        float y;
-        float theta;
+        T x;
+        T y;
+        T theta;
         /**
          * @brief Create a new pose
          *
@@ -36,7 +48,23 @@ class Pose {
          * lemlib::Pose poseB(5.2, 22); // x and y position, heading defaults to 0
          * @endcode
          */
-        Pose(float x, float y, float theta = 0);
+        BasicPose(T x, T y, T theta = T(0));
+        /**
+         * @brief Convert a pose of another precision
+         *
+         * @param other the pose to convert
+         *
+         * @b Example
+         * @code {.cpp}
+         * // round a pose accumulated in double precision to float
+         * lemlib::BasicPose<double> precise(5, 10, 1.57);
+         * lemlib::Pose pose(precise);
+         * @endcode
+         */
+        template <typename U> explicit BasicPose(const BasicPose<U>& other)
+            : x(T(other.x)),
+              y(T(other.y)),
+              theta(T(other.theta)) {}
         /**
          * @brief Add a pose to this pose
          *
@@ -56,7 +84,7 @@ class Pose {
          * // poseC.x = 10.2, poseC.y = 32, poseC.theta = 1.57
          * @endcode
          */
-        Pose operator+(const Pose& other) const;
+        BasicPose operator+(const BasicPose& other) const;
         /**
          * @brief Subtract a pose from this pose
          *
@@ -76,7 +104,7 @@ class Pose {
          * // poseC.x = -0.2, poseC.y = -12, poseC.theta = 1.57
          * @endcode
          */
-        Pose operator-(const Pose& other) const;
+        BasicPose operator-(const BasicPose& other) const;
         /**
          * @brief Multiply a pose by this pose (dot product)
          *
@@ -95,7 +123,7 @@ class Pose {
          * float result = poseA * poseB; // 246
          * @endcode
          */
-        float operator*(const Pose& other) const;
+        T operator*(const BasicPose& other) const;
         /**
          * @brief Multiply a pose by a float
          *
@@ -113,7 +141,7 @@ class Pose {
          * // result.x = 4, result.y = 8
          * @endcode
          */
-        Pose operator*(const float& other) const;
+        BasicPose operator*(const T& other) const;
         /**
          * @brief Divide a pose by a float
          *
@@ -131,7 +159,7 @@ class Pose {
          * // result.x = 3, result.y = 4
          * @endcode
          */
-        Pose operator/(const float& other) const;
+        BasicPose operator/(const T& other) const;
         /**
          * @brief Linearly interpolate between two poses
          *
@@ -151,7 +179,7 @@ class Pose {
          * // result.x = 0, result.y = 1
          * @endcode
          */
-        Pose lerp(Pose other, float t) const;
+        BasicPose lerp(BasicPose other, T t) const;
         /**
          * @brief Get the distance between two poses
          *
@@ -169,7 +197,7 @@ class Pose {
          * float result = poseA.distance(poseB); // result = 5
          * @endcode
          */
-        float distance(Pose other) const;
+        T distance(BasicPose other) const;
         /**
          * @brief Get the angle between two poses
          *
@@ -187,7 +215,7 @@ class Pose {
          * float result = poseA.angle(poseB); // result = 0.785398
          * @endcode
          */
-        float angle(Pose other) const;
+        T angle(BasicPose other) const;
         /**
          * @brief Rotate a pose by an angle
          *
@@ -205,9 +233,128 @@ class Pose {
          * // result.x = 0, result.y = 1
          * @endcode
          */
-        Pose rotate(float angle) const;
+        BasicPose rotate(T angle) const;
 };
 
+/** a pose with float components, the precision used throughout LemLib */
+using Pose = BasicPose<float>;
+
+// x and y are loaded and stored as a pair, so they must be next to each other
+static_assert(offsetof(Pose, y) == offsetof(Pose, x) + sizeof(float), "Pose::x and Pose::y must be adjacent");
+
+// The arithmetic is defined here so it can be inlined into the motion and tracking loops. On the brain, the x and y of
+// a float pose are worked on together as a pair in a NEON register, and theta is carried through untouched. The
+// math functions are called unqualified so lemlib::Fixed can provide its own
+
+// whether the NEON path of a pose with components of type T is used
+template <typename T> constexpr bool USE_NEON =
+#if defined(__ARM_NEON)
+    std::is_same_v<T, float>;
+#else
+    false;
+#endif
+
+template <typename T> inline BasicPose<T>::BasicPose(T x, T y, T theta)
+    : x(x),
+      y(y),
+      theta(theta) {}
+
+template <typename T> inline BasicPose<T> BasicPose<T>::operator+(const BasicPose& other) const {
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t sum = vadd_f32(vld1_f32(&this->x), vld1_f32(&other.x));
+        return BasicPose(vget_lane_f32(sum, 0), vget_lane_f32(sum, 1), this->theta);
+    }
+#endif
+    return BasicPose(this->x + other.x, this->y + other.y, this->theta);
+}
+
+template <typename T> inline BasicPose<T> BasicPose<T>::operator-(const BasicPose& other) const {
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t difference = vsub_f32(vld1_f32(&this->x), vld1_f32(&other.x));
+        return BasicPose(vget_lane_f32(difference, 0), vget_lane_f32(difference, 1), this->theta);
+    }
+#endif
+    return BasicPose(this->x - other.x, this->y - other.y, this->theta);
+}
+
+template <typename T> inline T BasicPose<T>::operator*(const BasicPose& other) const {
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t product = vmul_f32(vld1_f32(&this->x), vld1_f32(&other.x));
+        return vget_lane_f32(vpadd_f32(product, product), 0);
+    }
+#endif
+    return this->x * other.x + this->y * other.y;
+}
+
+template <typename T> inline BasicPose<T> BasicPose<T>::operator*(const T& other) const {
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t product = vmul_n_f32(vld1_f32(&this->x), other);
+        return BasicPose(vget_lane_f32(product, 0), vget_lane_f32(product, 1), this->theta);
+    }
+#endif
+    return BasicPose(this->x * other, this->y * other, this->theta);
+}
+
+// NEON has no division, and a reciprocal estimate isn't exact, so this stays on the scalar FPU
+template <typename T> inline BasicPose<T> BasicPose<T>::operator/(const T& other) const {
+    return BasicPose(this->x / other, this->y / other, this->theta);
+}
+
+template <typename T> inline BasicPose<T> BasicPose<T>::lerp(BasicPose other, T t) const {
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t from = vld1_f32(&this->x);
+        const float32x2_t result = vmla_n_f32(from, vsub_f32(vld1_f32(&other.x), from), t);
+        return BasicPose(vget_lane_f32(result, 0), vget_lane_f32(result, 1), this->theta);
+    }
+#endif
+    return BasicPose(this->x + (other.x - this->x) * t, this->y + (other.y - this->y) * t, this->theta);
+}
+
+template <typename T> inline T BasicPose<T>::distance(BasicPose other) const {
+    using std::sqrt;
+    // the coordinates on a field are far too small for the sum of squares to overflow a float, so the extra work
+    // std::hypot does to avoid that isn't needed
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        const float32x2_t difference = vsub_f32(vld1_f32(&this->x), vld1_f32(&other.x));
+        const float32x2_t squares = vmul_f32(difference, difference);
+        return sqrt(vget_lane_f32(vpadd_f32(squares, squares), 0));
+    }
+#endif
+    const T dx = this->x - other.x;
+    const T dy = this->y - other.y;
+    // fixed point squares do overflow, past 181
+    if constexpr (std::is_floating_point_v<T>) return sqrt(dx * dx + dy * dy);
+    else return hypot(dx, dy);
+}
+
+template <typename T> inline T BasicPose<T>::angle(BasicPose other) const {
+    using std::atan2;
+    return atan2(other.y - this->y, other.x - this->x);
+}
+
+template <typename T> inline BasicPose<T> BasicPose<T>::rotate(T angle) const {
+    using std::cos;
+    using std::sin;
+    const T s = sin(angle);
+    const T c = cos(angle);
+#if defined(__ARM_NEON)
+    if constexpr (USE_NEON<T>) {
+        // (x, x) * (c, s) + (y, y) * (-s, c)
+        const float32x2_t cosSin = vset_lane_f32(s, vdup_n_f32(c), 1);
+        const float32x2_t negSinCos = vset_lane_f32(c, vdup_n_f32(-s), 1);
+        const float32x2_t result = vmla_n_f32(vmul_n_f32(cosSin, this->x), negSinCos, this->y);
+        return BasicPose(vget_lane_f32(result, 0), vget_lane_f32(result, 1), this->theta);
+    }
+#endif
+    return BasicPose(this->x * c - this->y * s, this->x * s + this->y * c, this->theta);
+}
+
 /**
  * @brief Format a pose
  *
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lemlib {
+/**
+ * @brief Read the cycle counter
+ *
+ * On the brain this is the Cortex-A9 performance monitor's cycle counter, which counts every CPU cycle. Anywhere
+ * else it is the time in nanoseconds, so profiles still work on a computer
+ *
+ * @return uint32_t the count. It wraps around every few seconds on the brain, so only use it for short durations
+ */
+uint32_t readCycles();
+
+/**
+ * @brief A named place in the code that is profiled, made by LEMLIB_PROFILE_SCOPE
+ *
+ * Sites link themselves into a list the first time they run, so they never allocate
+ */
+class ProfileSite {
+    public:
+        /**
+         * @brief Construct a new Profile Site, and add it to the list of sites
+         *
+         * @param name the name of the site. Must be a string literal
+         */
+        ProfileSite(const char* name);
+
+        const char* const name;
+        /** number of times the scope ran */
+        uint32_t count = 0;
+        /** cycles spent in the scope */
+        uint64_t total = 0;
+        /** most cycles spent in the scope at once */
+        uint32_t max = 0;
+        /** the next site in the list */
+        ProfileSite* next;
+};
+
+/**
+ * @brief Counts the cycles from when it is constructed until it is destroyed, and adds them to a site
+ */
+class ProfileScope {
+    public:
+        ProfileScope(ProfileSite& site)
+            : site(site),
+              start(readCycles()) {}
+
+        ~ProfileScope() {
+            const uint32_t cycles = readCycles() - start;
+            site.count++;
+            site.total += cycles;
+            if (cycles > site.max) site.max = cycles;
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+    private:
+        ProfileSite& site;
+        const uint32_t start;
+};
+
+/**
+ * @brief Log the count, average, and most cycles of every profiled scope to the info sink, at the info level
+ *
+ * @b Example
+ * @code {.cpp}
+ * // after building with -DLEMLIB_PROFILE in EXTRA_CXXFLAGS
+ * chassis.follow(myPath_txt, 10, 4000, true, false);
+ * lemlib::infoSink()->setLowestLevel(lemlib::Level::INFO);
+ * lemlib::dumpProfile();
+ * @endcode
+ */
+void dumpProfile();
+
+/**
+ * @brief Reset the statistics of every profiled scope
+ */
+void resetProfile();
+} // namespace lemlib
+
+#define LEMLIB_PROFILE_CONCAT_INNER(a, b) a##b
+#define LEMLIB_PROFILE_CONCAT(a, b) LEMLIB_PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Count the cycles spent in the rest of the enclosing scope
+ *
+ * Only compiled in when LEMLIB_PROFILE is defined, e.g. with -DLEMLIB_PROFILE in EXTRA_CXXFLAGS. Otherwise it is
+ * removed entirely. Statistics aren't atomic, so a scope that runs on multiple tasks at once can lose counts
+ *
+ * @b Example
+ * @code {.cpp}
+ * float expensive() {
+ *     LEMLIB_PROFILE_SCOPE("expensive");
+ *     // ...
+ * }
+ * @endcode
+ */
+#ifdef LEMLIB_PROFILE
+#define LEMLIB_PROFILE_SCOPE(name)                                                                                     \
+    static ::lemlib::ProfileSite LEMLIB_PROFILE_CONCAT(lemlibProfileSite, __LINE__)(name);                             \
+    const ::lemlib::ProfileScope LEMLIB_PROFILE_CONCAT(lemlibProfileScope, __LINE__)(                                  \
+        LEMLIB_PROFILE_CONCAT(lemlibProfileSite, __LINE__))
+#else
+#define LEMLIB_PROFILE_SCOPE(name) static_cast<void>(0)
+#endif
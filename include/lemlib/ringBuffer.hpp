@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace lemlib {
+/**
+ * @brief A fixed capacity buffer that overwrites its oldest element when it is full
+ *
+ * All storage is held inline, so the buffer never allocates memory
+ *
+ * @tparam T the type of the elements
+ * @tparam Capacity the maximum number of elements
+ */
+template <typename T, size_t Capacity> class RingBuffer {
+    public:
+        /**
+         * @brief Add an element to the buffer, overwriting the oldest element if the buffer is full
+         *
+         * @param value the element to add
+         *
+         * @b Example
+         * @code {.cpp}
+         * lemlib::RingBuffer<int, 2> buffer;
+         * buffer.push(1);
+         * buffer.push(2);
+         * buffer.push(3); // buffer now contains 2, 3
+         * @endcode
+         */
+        void push(const T& value) {
+            data[(start + count) % Capacity] = value;
+            if (count < Capacity) count++;
+            else start = (start + 1) % Capacity;
+        }
+
+        /**
+         * @brief Get an element of the buffer
+         *
+         * @param index the index of the element. 0 is the oldest element
+         * @return const T& the element
+         */
+        const T& operator[](size_t index) const { return data[(start + index) % Capacity]; }
+
+        /**
+         * @brief Get the newest element of the buffer
+         *
+         * @note the buffer must not be empty
+         *
+         * @return const T& the newest element
+         */
+        const T& back() const { return (*this)[count - 1]; }
+
+        /**
+         * @brief Get the number of elements in the buffer
+         *
+         * @return size_t number of elements
+         */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Get the maximum number of elements in the buffer
+         *
+         * @return size_t capacity
+         */
+        constexpr size_t capacity() const { return Capacity; }
+
+        /**
+         * @brief Remove all elements from the buffer
+         */
+        void clear() {
+            start = 0;
+            count = 0;
+        }
+    private:
+        std::array<T, Capacity> data {};
+        size_t start = 0;
+        size_t count = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+#include "lemlib/chassis/motionHandle.hpp"
+
+namespace lemlib {
+/**
+ * @brief A sequence of steps that runs cooperatively with other routines on a single task
+ *
+ * Each step either runs to completion immediately, or waits for something: a motion to end or travel a distance, a
+ * time, or a condition. When a routine is waiting, the task runs the other routines instead, and sleeps until a
+ * motion callback wakes it. This lets an autonomous do things while driving without creating extra tasks.
+ *
+ * Motions started by a routine must be asynchronous, otherwise the step blocks every routine until the motion ends
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::Routine drive;
+ * drive.move([] { return chassis.moveToPose(24, 48, 90, 4000, {}, true); })
+ *     .move([] { return chassis.turnToHeading(180, 1000, {}, true); });
+ * lemlib::Routine intake;
+ * // start the intake once the robot has driven 20 inches
+ * intake.waitUntilProgress(drive, 0, 20).then([] { intakeMotor.move(127); });
+ * lemlib::Routine::runConcurrently({&drive, &intake});
+ * @endcode
+ */
+class Routine {
+    public:
+        /**
+         * @brief Add a step that calls a function
+         *
+         * @param action the function to call. It must not block
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& then(std::function<void()> action);
+        /**
+         * @brief Add a step that starts a motion, without waiting for it to end
+         *
+         * @param motion starts the motion and returns its handle. The motion must be asynchronous
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& start(std::function<MotionHandle()> motion);
+        /**
+         * @brief Add a step that starts a motion, and waits for it to end
+         *
+         * @param motion starts the motion and returns its handle. The motion must be asynchronous
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& move(std::function<MotionHandle()> motion);
+        /**
+         * @brief Add a step that waits until the last motion started by a routine ends
+         *
+         * @param routine the routine that started the motion. Can be this routine
+         * @param motion the index of the motion, counting the motions started by the routine from 0. -1 for the
+         * last motion it started
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& waitUntilDone(const Routine& routine, int motion = -1);
+        /**
+         * @brief Add a step that waits until a motion started by a routine has traveled a distance, or has ended
+         *
+         * @param routine the routine that started the motion. Can be this routine
+         * @param motion the index of the motion, counting the motions started by the routine from 0. -1 for the
+         * last motion it started
+         * @param progress the distance, in inches for moveToPoint, moveToPose, and follow, degrees for everything
+         * else
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& waitUntilProgress(const Routine& routine, int motion, float progress);
+        /**
+         * @brief Add a step that waits for a time
+         *
+         * @param time how long to wait, in milliseconds
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& delay(uint32_t time);
+        /**
+         * @brief Add a step that waits until a condition is true
+         *
+         * The condition is checked every 10 ms while the routine is waiting
+         *
+         * @param condition returns whether to stop waiting. It must not block
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& waitFor(std::function<bool()> condition);
+        /**
+         * @brief Add a step that ends the routine if there isn't enough time left in the period of the match
+         *
+         * The time left comes from the match clock. Motions the routine already started keep running. Without a field
+         * or competition switch, the step does nothing unless a period was started with MatchClock::start, since the
+         * clock would otherwise count down the driver control period from when the program started
+         *
+         * @param time the time the rest of the routine needs, in milliseconds
+         * @return Routine& this routine, so steps can be chained
+         */
+        Routine& requireTime(uint32_t time);
+        /**
+         * @brief Whether every step has run
+         *
+         * @return true the routine has finished
+         * @return false the routine is still running, or hasn't run yet
+         */
+        bool isDone() const;
+        /**
+         * @brief Run the routine on the calling task. Blocks until it finishes
+         */
+        void run();
+        /**
+         * @brief Run several routines at the same time on the calling task. Blocks until they all finish
+         *
+         * @param routines the routines to run. A routine can only wait for motions of routines run with it
+         *
+         * @note motions that are waited for wake the calling task when they end, so the task must outlive them
+         */
+        static void runConcurrently(std::initializer_list<Routine*> routines);
+    private:
+        enum class StepType { ACTION, START, WAIT_DONE, WAIT_PROGRESS, DELAY, CONDITION, REQUIRE_TIME };
+
+        /**
+         * @brief A step of the routine. Only the members used by its type are set
+         */
+        struct Step {
+                StepType type;
+                std::function<void()> action;
+                std::function<MotionHandle()> motion;
+                std::function<bool()> condition;
+                /** the routine whose motion is waited for */
+                const Routine* routine = nullptr;
+                /** the index of the motion that is waited for, or -1 for the last one */
+                int index = -1;
+                /** the progress or time that is waited for */
+                float value = 0;
+        };
+
+        /**
+         * @brief Reset the routine so it can be run again
+         */
+        void reset();
+        /**
+         * @brief Run steps until one has to wait
+         *
+         * @param task the task running the routine, which motion callbacks notify
+         * @return uint32_t the longest the task can sleep before the routine has to be resumed, in milliseconds
+         */
+        uint32_t resume(void* task);
+        /**
+         * @brief Get a motion started by this routine
+         *
+         * @param index the index of the motion, or -1 for the last one
+         * @param motion where the motion is copied to
+         * @return true the motion was found
+         * @return false the routine hasn't started the motion yet
+         */
+        bool getMotion(int index, MotionHandle& motion) const;
+
+        std::vector<Step> steps;
+        /** motions started by this routine, in order */
+        std::vector<MotionHandle> motions;
+        size_t current = 0;
+        /** whether the current step has started waiting */
+        bool waiting = false;
+        /** whether the current step has registered its callbacks */
+        bool registered = false;
+        /** whether a callback will wake the task when the current step is done */
+        bool notified = false;
+        /** the time the current step started waiting, in milliseconds */
+        uint32_t waitStart = 0;
+};
+} // namespace lemlib
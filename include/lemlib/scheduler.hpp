@@ -0,0 +1,128 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "pros/rtos.hpp"
+#include "lemlib/taskMonitor.hpp"
+
+namespace lemlib {
+/**
+ * @brief Timing statistics of a scheduled job
+ */
+struct JobStats {
+        /** the name of the job */
+        const char* name = nullptr;
+        /** time between runs, in milliseconds */
+        uint32_t period = 0;
+        /** number of times the job ran */
+        uint32_t runs = 0;
+        /** number of releases skipped because the job, or the jobs before it, ran past them */
+        uint32_t overruns = 0;
+        /** longest a run took, in microseconds */
+        uint32_t maxBusy = 0;
+        /** latest a run started after it was due, in microseconds */
+        uint32_t maxLateness = 0;
+};
+
+/**
+ * @brief Runs periodic jobs on a single task, instead of a task for each
+ *
+ * Every job is released on a multiple of its period after the scheduler started, so the phase between jobs doesn't
+ * depend on when they were added. When several jobs are due at once they run shortest period first, like rate
+ * monotonic scheduling, so a 5 ms job always runs before the 10 ms and 50 ms jobs due at the same time, and sees the
+ * same ordering every time. Between releases the task sleeps until the next job is due, so the CPU doesn't switch
+ * between tasks that would otherwise wake up at the same time.
+ *
+ * Jobs run to completion and can't block, so a job must return quickly and never wait. A job that runs past its
+ * next release skips it instead of running twice in a row, and the skip is counted as an overrun.
+ *
+ * Odometry runs as a job with Odometry::setScheduler(). Motions keep running on the chassis motion task, because
+ * they wait for their exit conditions, but they wake as soon as each odometry update finishes, so they stay in phase
+ * with the odometry job
+ *
+ * @note the scheduler is meant to live for the rest of the program, like the sinks
+ *
+ * <h3> Example Usage </h3>
+ * @code
+ * lemlib::Scheduler scheduler;
+ * void sendIntake(void*, uint32_t) { std::cout << intake.get_actual_velocity() << std::endl; }
+ * void initialize() {
+ *     // run odometry on the scheduler, instead of on its own task
+ *     chassis.getOdometry().setScheduler(&scheduler);
+ *     chassis.calibrate();
+ *     scheduler.addJob("intake telemetry", 50, sendIntake);
+ * }
+ * @endcode
+ */
+class Scheduler {
+    public:
+        /** the most jobs a scheduler can run */
+        static constexpr size_t MAX_JOBS = 8;
+        /**
+         * @brief A job. Called with the argument it was added with, and the time it was due, in milliseconds
+         */
+        using Callback = void (*)(void* arg, uint32_t due);
+
+        /**
+         * @brief Construct a new Scheduler, and start its task
+         *
+         * @param priority the priority of the task. By default, above the competition tasks and driver control
+         */
+        Scheduler(uint32_t priority = TASK_PRIORITY_DEFAULT + 2);
+        Scheduler(const Scheduler&) = delete;
+        Scheduler& operator=(const Scheduler&) = delete;
+        /**
+         * @brief Add a job. It first runs at the next multiple of its period after the scheduler started
+         *
+         * @param name the name of the job. Must outlive the scheduler, like a string literal
+         * @param period time between runs, in milliseconds. At least 1
+         * @param callback the job
+         * @param arg passed to the job
+         * @return int the id of the job, or -1 if the scheduler already has MAX_JOBS jobs
+         */
+        int addJob(const char* name, uint32_t period, Callback callback, void* arg = nullptr);
+        /**
+         * @brief Change the period of a job. Takes effect after the next run of the job
+         *
+         * @param job the id of the job
+         * @param period time between runs, in milliseconds. At least 1
+         */
+        void setPeriod(int job, uint32_t period);
+        /**
+         * @brief Get the timing statistics of a job
+         *
+         * @note the statistics can be slightly off if they are read while the job is running
+         *
+         * @param job the id of the job
+         * @return JobStats the statistics. Empty if there is no such job
+         */
+        JobStats getStats(int job) const;
+    private:
+        struct Job {
+                const char* name = nullptr;
+                Callback callback = nullptr;
+                void* arg = nullptr;
+                std::atomic<uint32_t> period = 1;
+                /** when the job is next due, in milliseconds. Only used by the task */
+                uint32_t next = 0;
+                uint32_t runs = 0;
+                uint32_t overruns = 0;
+                uint32_t maxBusy = 0;
+                uint32_t maxLateness = 0;
+        };
+
+        /**
+         * @brief Run the jobs as they become due
+         */
+        void taskLoop();
+
+        std::array<Job, MAX_JOBS> jobs;
+        /** number of jobs. A job is filled in before the count is raised, so the task never sees a partial job */
+        std::atomic<size_t> count = 0;
+        pros::Mutex addMutex;
+        TaskMonitor monitor {"scheduler"};
+        pros::Task task;
+};
+} // namespace lemlib
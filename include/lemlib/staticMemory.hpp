@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Static memory mode is turned on by building with -DLEMLIB_STATIC_MEMORY in EXTRA_CXXFLAGS.
+ *
+ * In this mode, Chassis::calibrate makes everything the hot paths need: the tasks, queues, and substituted tracking
+ * wheels, and the deferred queue of the info sink, so log calls on a hot path are copied into it instead of being
+ * formatted there. After that, every heap allocation made by a task while it is in a hot path is counted, and fails
+ * an assert unless NDEBUG is defined. The hot paths are the odometry update, and the motion loops from their first
+ * tick until the motion ends
+ *
+ * Without the flag, the hot path functions do nothing and compile away
+ */
+
+namespace lemlib {
+/**
+ * @brief How much of the heap a program uses
+ */
+struct HeapUsage {
+        /** bytes in blocks that are allocated */
+        size_t used;
+        /** bytes the heap has taken for itself, allocated or free. It never shrinks, so it is the peak of the heap */
+        size_t reserved;
+        /** allocations since the program started. Only counted in static memory mode, 0 otherwise */
+        uint32_t allocations;
+};
+
+/**
+ * @brief Measure the heap
+ *
+ * Reading it walks the free blocks of the heap, so it takes longer the more the heap is fragmented. Read it now and
+ * then, not every iteration of a loop
+ *
+ * @b Example
+ * @code {.cpp}
+ * const lemlib::HeapUsage heap = lemlib::getHeapUsage();
+ * printf("heap: %u bytes used, %u reserved\n", heap.used, heap.reserved);
+ * @endcode
+ *
+ * @return HeapUsage the usage of the heap
+ */
+HeapUsage getHeapUsage();
+
+#ifdef LEMLIB_STATIC_MEMORY
+/**
+ * @brief Mark the current task as being in a hot path, until endHotPath is called. Does nothing if it already is
+ */
+void beginHotPath();
+
+/**
+ * @brief Mark the current task as no longer being in a hot path
+ */
+void endHotPath();
+
+/**
+ * @brief Check whether the current task is in a hot path
+ *
+ * @return true the current task is in a hot path, so it must not allocate
+ * @return false the current task may allocate
+ */
+bool inHotPath();
+
+/**
+ * @brief Get the number of heap allocations made in hot paths since the program started
+ *
+ * @return uint32_t the number of allocations. 0 in a program that never allocates after calibrating
+ */
+uint32_t getHotPathAllocations();
+#else
+inline void beginHotPath() {}
+
+inline void endHotPath() {}
+
+inline bool inHotPath() { return false; }
+
+inline uint32_t getHotPathAllocations() { return 0; }
+#endif
+
+/**
+ * @brief Marks the current task as being in a hot path from when it is constructed until it is destroyed
+ *
+ * @b Example
+ * @code {.cpp}
+ * while (true) {
+ *     {
+ *         lemlib::HotPathScope hotPath;
+ *         // code that must not allocate
+ *     }
+ *     pros::delay(10);
+ * }
+ * @endcode
+ */
+class HotPathScope {
+    public:
+        HotPathScope() { beginHotPath(); }
+
+        ~HotPathScope() { endHotPath(); }
+
+        HotPathScope(const HotPathScope&) = delete;
+        HotPathScope& operator=(const HotPathScope&) = delete;
+};
+} // namespace lemlib
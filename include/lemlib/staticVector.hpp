@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace lemlib {
+/**
+ * @brief A vector with a fixed capacity
+ *
+ * All storage is held inline, so the vector never allocates memory, and its elements are next to whatever holds it.
+ * It is used where the number of elements has a small upper bound, like the motors in a group or the IMUs in a
+ * group, in places that run often
+ *
+ * @tparam T the type of the elements. Must be default constructible
+ * @tparam Capacity the maximum number of elements
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::StaticVector<float, 4> values;
+ * values.push(1);
+ * values.push(2);
+ * for (float value : values) printf("%f\n", value);
+ * @endcode
+ */
+template <typename T, size_t Capacity> class StaticVector {
+    public:
+        StaticVector() = default;
+
+        /**
+         * @brief Construct a new Static Vector holding copies of a value
+         *
+         * @param count the number of elements. Limited to the capacity
+         * @param value the value of every element
+         */
+        StaticVector(size_t count, const T& value) { this->resize(count, value); }
+
+        /**
+         * @brief Add an element to the end of the vector
+         *
+         * @param value the element to add
+         * @return true the element was added
+         * @return false the vector is full, so the element wasn't added
+         */
+        bool push(const T& value) {
+            if (count == Capacity) return false;
+            data[count++] = value;
+            return true;
+        }
+
+        /**
+         * @brief Remove the last element of the vector
+         *
+         * @note the vector must not be empty
+         */
+        void pop() { data[--count] = T(); }
+
+        /**
+         * @brief Change the number of elements
+         *
+         * @param size the new number of elements. Limited to the capacity
+         * @param value the value of elements that are added
+         */
+        void resize(size_t size, const T& value = T()) {
+            if (size > Capacity) size = Capacity;
+            for (size_t i = count; i < size; i++) data[i] = value;
+            for (size_t i = size; i < count; i++) data[i] = T();
+            count = size;
+        }
+
+        /**
+         * @brief Remove all elements from the vector
+         */
+        void clear() { this->resize(0); }
+
+        T& operator[](size_t index) { return data[index]; }
+
+        const T& operator[](size_t index) const { return data[index]; }
+
+        /**
+         * @brief Get the last element of the vector
+         *
+         * @note the vector must not be empty
+         *
+         * @return T& the last element
+         */
+        T& back() { return data[count - 1]; }
+
+        const T& back() const { return data[count - 1]; }
+
+        T* begin() { return data.data(); }
+
+        T* end() { return data.data() + count; }
+
+        const T* begin() const { return data.data(); }
+
+        const T* end() const { return data.data() + count; }
+
+        /**
+         * @brief Get the number of elements in the vector
+         *
+         * @return size_t number of elements
+         */
+        size_t size() const { return count; }
+
+        /**
+         * @brief Check whether the vector has no elements
+         *
+         * @return true the vector is empty
+         * @return false the vector has elements
+         */
+        bool empty() const { return count == 0; }
+
+        /**
+         * @brief Get the maximum number of elements in the vector
+         *
+         * @return size_t capacity
+         */
+        constexpr size_t capacity() const { return Capacity; }
+    private:
+        std::array<T, Capacity> data {};
+        size_t count = 0;
+};
+} // namespace lemlib
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include "pros/rtos.hpp"
+
+namespace lemlib {
+/**
+ * @brief The priority and stack of a task
+ */
+struct TaskSettings {
+        /** the priority of the task, from TASK_PRIORITY_MIN to TASK_PRIORITY_MAX */
+        uint32_t priority;
+        /** the size of the stack of the task, in 4 byte words */
+        uint16_t stackSize = TASK_STACK_DEPTH_DEFAULT;
+};
+
+/**
+ * @brief The priorities and stacks of the tasks LemLib starts
+ *
+ * The competition tasks and tasks made without a priority run at TASK_PRIORITY_DEFAULT, and the driver control task
+ * of the chassis at TASK_PRIORITY_DEFAULT + 1. By default odometry runs above all of them, so a busy user task can't
+ * delay the pose, and the motions run above user code too. Logging runs below user code, since a late message only
+ * costs latency
+ */
+struct TaskConfig {
+        /** the odometry tracking task */
+        TaskSettings tracking {TASK_PRIORITY_DEFAULT + 2};
+        /** the motion task of each chassis. Chassis::setMotionStackSize() overrides the stack of a chassis */
+        TaskSettings motion {TASK_PRIORITY_DEFAULT + 1};
+        /** the tasks that write log messages, bufferedStdout and deferred sinks */
+        TaskSettings logger {TASK_PRIORITY_DEFAULT - 1};
+};
+
+/**
+ * @brief Set the priorities and stacks of the tasks LemLib starts
+ *
+ * Each task reads the configuration once, when it is made, so this should be the first thing in initialize(). Tasks
+ * that are already running keep their settings. Odometry and motion tasks are made when the chassis is calibrated,
+ * and bufferedStdout when it is first printed to
+ *
+ * @note not thread safe. Call it before starting any tasks that use LemLib
+ *
+ * @param config the configuration
+ *
+ * @b Example
+ * @code {.cpp}
+ * void initialize() {
+ *     lemlib::TaskConfig config;
+ *     // leave room for a user task at TASK_PRIORITY_DEFAULT + 2
+ *     config.tracking.priority = TASK_PRIORITY_DEFAULT + 3;
+ *     config.motion.stackSize = TASK_STACK_DEPTH_DEFAULT * 2;
+ *     lemlib::setTaskConfig(config);
+ *     chassis.calibrate();
+ * }
+ * @endcode
+ */
+void setTaskConfig(const TaskConfig& config);
+
+/**
+ * @brief Get the priorities and stacks of the tasks LemLib starts
+ *
+ * @return const TaskConfig& the configuration
+ */
+const TaskConfig& getTaskConfig();
+} // namespace lemlib
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "pros/rtos.hpp"
+
+namespace lemlib {
+/**
+ * @brief How much CPU and stack a task uses, and how often it misses its deadline
+ */
+struct TaskHealth {
+        /** the name of the task */
+        const char* name;
+        /** the priority of the task */
+        uint32_t priority;
+        /** the size of the stack of the task, in words */
+        uint32_t stackSize;
+        /** the least free stack the task has ever had, in words. 0 when it can't be measured, like on a computer */
+        uint32_t stackFree;
+        /** fraction of the time since the monitor was reset that the task spent busy, from 0 to 1 */
+        float cpuShare;
+        /** number of iterations recorded */
+        uint32_t iterations;
+        /** number of iterations that didn't finish before the next one was due */
+        uint32_t missedDeadlines;
+};
+
+/**
+ * @brief Keeps track of the health of a LemLib task
+ *
+ * The task records how long it is busy each time it wakes up, so the CPU share is measured by the task itself and
+ * costs a read of the clock. Time the task spends preempted by higher priority tasks while it is busy is counted
+ * too, so the shares of tasks of different priorities can add up to more than 1. The stack high water mark comes
+ * from the RTOS
+ *
+ * Every monitor adds itself to a list, so getTaskHealth and reportTaskHealth cover every LemLib task that is running
+ *
+ * @b Example
+ * @code {.cpp}
+ * chassis.moveToPose(24, 24, 90, 4000);
+ * chassis.waitUntilDone();
+ * for (const lemlib::TaskHealth& health : lemlib::getTaskHealth()) {
+ *     std::cout << health.name << ": " << health.cpuShare * 100 << "% CPU, " << health.stackFree
+ *               << " words of stack free" << std::endl;
+ * }
+ * @endcode
+ */
+class TaskMonitor {
+    public:
+        /**
+         * @brief Construct a new Task Monitor, and add it to the list of monitors
+         *
+         * @param name the name of the task. Must outlive the monitor, like a string literal
+         */
+        TaskMonitor(const char* name);
+        /**
+         * @brief Destroy the Task Monitor, removing it from the list of monitors
+         */
+        ~TaskMonitor();
+        TaskMonitor(const TaskMonitor&) = delete;
+        TaskMonitor& operator=(const TaskMonitor&) = delete;
+        /**
+         * @brief Set the task that is monitored, and start measuring from now
+         *
+         * Monitors without a task aren't reported
+         *
+         * @param task the task
+         * @param stackSize the size of the stack the task was created with, in words
+         */
+        void attach(pros::Task& task, uint32_t stackSize = TASK_STACK_DEPTH_DEFAULT);
+        /**
+         * @brief Record an iteration of the task
+         *
+         * @note only call this from the monitored task
+         *
+         * @param busy how long the iteration ran, in microseconds
+         * @param missedDeadline whether the iteration didn't finish before the next one was due
+         */
+        void record(uint32_t busy, bool missedDeadline = false);
+        /**
+         * @brief Get the health of the task
+         *
+         * @return TaskHealth the health of the task
+         */
+        TaskHealth getHealth() const;
+        /**
+         * @brief Forget every recorded iteration, and start measuring the CPU share from now
+         */
+        void reset();
+        /**
+         * @brief Whether the monitor has a task
+         *
+         * @return true the task was attached
+         * @return false the task wasn't attached
+         */
+        bool isAttached() const;
+    private:
+        const char* const name;
+        pros::task_t task = nullptr;
+        uint32_t stackSize = 0;
+        /** time the CPU share is measured from, in microseconds */
+        uint64_t since = 0;
+        /** time spent busy since the CPU share started being measured, in microseconds */
+        uint64_t busy = 0;
+        uint32_t iterations = 0;
+        uint32_t missedDeadlines = 0;
+};
+
+/**
+ * @brief Get the health of every LemLib task that is running
+ *
+ * @return std::vector<TaskHealth> the health of each task
+ */
+std::vector<TaskHealth> getTaskHealth();
+
+/**
+ * @brief Send the health of every LemLib task to the telemetry sink, one line each, as
+ * "task,name,priority,stackSize,stackFree,cpuShare,iterations,missedDeadlines". The CPU share is a percentage
+ *
+ * @b Example
+ * @code {.cpp}
+ * lemlib::telemetrySink()->setLowestLevel(lemlib::Level::INFO);
+ * // report the health of the tasks every second
+ * pros::Task reporter([] {
+ *     while (true) {
+ *         lemlib::reportTaskHealth();
+ *         pros::delay(1000);
+ *     }
+ * });
+ * @endcode
+ */
+void reportTaskHealth();
+
+/**
+ * @brief Reset the monitor of every LemLib task, so the CPU shares are measured from now
+ */
+void resetTaskHealth();
+} // namespace lemlib
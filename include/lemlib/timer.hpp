@@ -52,6 +52,29 @@ class Timer {
          * @endcode
          */
         uint32_t getTimeLeft();
+        /**
+         * @brief Get the amount of time left on the timer, using a timestamp that was already read
+         *
+         * Reading the clock once per update and passing the timestamp to every timer means they all agree on the
+         * time, without a system call for each check
+         *
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return uint32_t time in milliseconds
+         *
+         * @b Example
+         * @code {.cpp}
+         * const uint64_t now = pros::micros();
+         * const uint32_t time = timer.getTimeLeft(now);
+         * @endcode
+         */
+        uint32_t getTimeLeft(uint64_t now);
+        /**
+         * @brief Get the amount of time left on the timer, in microseconds
+         *
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return uint64_t time in microseconds
+         */
+        uint64_t getTimeLeftMicros(uint64_t now);
         /**
          * @brief Get the amount of time passed on the timer
          *
@@ -68,6 +91,20 @@ class Timer {
          * @endcode
          */
         uint32_t getTimePassed();
+        /**
+         * @brief Get the amount of time passed on the timer, using a timestamp that was already read
+         *
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return uint32_t time in milliseconds
+         */
+        uint32_t getTimePassed(uint64_t now);
+        /**
+         * @brief Get the amount of time passed on the timer, in microseconds
+         *
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return uint64_t time in microseconds
+         */
+        uint64_t getTimePassedMicros(uint64_t now);
         /**
          * @brief Get whether the timer is done or not
          *
@@ -89,6 +126,24 @@ class Timer {
          * @endcode
          */
         bool isDone();
+        /**
+         * @brief Get whether the timer is done or not, using a timestamp that was already read
+         *
+         * @param now the current time, in microseconds, from pros::micros()
+         * @return true the timer is done
+         * @return false the timer is not done
+         *
+         * @b Example
+         * @code {.cpp}
+         * while (true) {
+         *     // read the clock once, and share it between every check in this iteration
+         *     const uint64_t now = pros::micros();
+         *     if (timer.isDone(now)) break;
+         *     pros::delay(10);
+         * }
+         * @endcode
+         */
+        bool isDone(uint64_t now);
         /**
          * @brief Get whether the timer is paused or not
          *
@@ -192,9 +247,17 @@ class Timer {
          */
         void waitUntilDone();
     private:
-        uint32_t period;
-        uint32_t lastTime;
-        uint32_t timeWaited = 0;
+        /**
+         * @brief Count the time since the last update, unless the timer is paused
+         *
+         * @param now the current time, in microseconds
+         */
+        void update(uint64_t now);
+
+        // times are kept in microseconds, so timestamps from pros::micros() don't lose precision
+        uint64_t period;
+        uint64_t lastTime;
+        uint64_t timeWaited = 0;
         bool paused = false;
 };
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "lemlib/pose.hpp"
+
+namespace lemlib {
+/**
+ * @brief The planned state of a trajectory at a point in time
+ *
+ * Positions and headings are in standard form: theta is in radians, counterclockwise from the x axis
+ */
+struct TrajectoryState {
+        /** time since the start of the trajectory, in seconds */
+        float time = 0;
+        /** x position, in inches */
+        float x = 0;
+        /** y position, in inches */
+        float y = 0;
+        /** heading, in radians */
+        float theta = 0;
+        /** velocity, in inches per second. Negative when driving backwards */
+        float velocity = 0;
+        /** acceleration, in inches per second squared */
+        float acceleration = 0;
+        /** angular velocity, in radians per second. Positive is counterclockwise */
+        float angularVelocity = 0;
+};
+
+/**
+ * @brief Limits a trajectory is planned with
+ */
+struct TrajectoryConstraints {
+        /** the maximum velocity, in inches per second */
+        float maxVelocity;
+        /** the maximum acceleration, in inches per second squared */
+        float maxAcceleration;
+        /** how fast the robot can go around corners, the same as Drivetrain::horizontalDrift */
+        float horizontalDrift;
+        /** the velocity of a drivetrain side at full power, in inches per second. Used to convert the slip limit */
+        float topSpeed;
+};
+
+/**
+ * @brief A path with the time the robot should reach each point of it
+ *
+ * Trajectories are planned ahead of time, so following one only has to look up where the robot should be and
+ * correct the error, instead of working out the path every iteration. The same trajectory is always driven the
+ * same way
+ *
+ * @b Example
+ * @code {.cpp}
+ * // plan the boomerang curve from (0, 0) facing 0 degrees to (24, 24) facing 90 degrees
+ * lemlib::Trajectory trajectory = lemlib::Trajectory::boomerang({0, 0, M_PI_2}, {24, 24, 0}, 0.6, true,
+ *                                                               {60, 120, 2, 70});
+ * // where the robot should be half a second in
+ * lemlib::TrajectoryState state = trajectory.sample(0.5);
+ * @endcode
+ */
+class Trajectory {
+    public:
+        /**
+         * @brief Construct a new empty Trajectory
+         */
+        Trajectory() = default;
+        /**
+         * @brief Construct a new Trajectory from a list of points
+         *
+         * The headings, velocities, and times of the states are planned from the positions of the points
+         *
+         * @param points the points, in inches. The theta of each point is ignored
+         * @param forwards whether the robot drives the path forwards
+         * @param constraints the limits of the drivetrain
+         */
+        Trajectory(const std::vector<Pose>& points, bool forwards, const TrajectoryConstraints& constraints);
+        /**
+         * @brief Plan the curve Chassis::moveToPose drives along
+         *
+         * The robot is simulated driving towards the carrot point, the same way moveToPose does, so the curve matches
+         * the one moveToPose would drive from the start pose
+         *
+         * @param start the pose the robot starts at, in standard form
+         * @param target the target pose, in standard form. The theta is the way the front of the robot faces
+         * @param lead carrot point multiplier, the same as MoveToPoseParams::lead
+         * @param forwards whether the robot drives forwards
+         * @param constraints the limits of the drivetrain
+         * @return Trajectory the planned trajectory
+         */
+        static Trajectory boomerang(Pose start, Pose target, float lead, bool forwards,
+                                    const TrajectoryConstraints& constraints);
+        /**
+         * @brief Get the planned state at a point in time
+         *
+         * This uses a binary search, so it takes O(log n) time
+         *
+         * @param time the time since the start of the trajectory, in seconds
+         * @return TrajectoryState the state, interpolated between the closest states. At rest at the start or the
+         * end if the time is outside of the trajectory
+         */
+        TrajectoryState sample(float time) const;
+        /**
+         * @brief Get the index of the state at or just before a point in time
+         *
+         * @param time the time since the start of the trajectory, in seconds
+         * @return size_t the index
+         */
+        size_t indexAt(float time) const;
+        /**
+         * @brief Get how long the trajectory takes
+         *
+         * @return float the duration, in seconds
+         */
+        float getDuration() const;
+        /**
+         * @brief Get the number of states in the trajectory
+         *
+         * @return size_t number of states
+         */
+        size_t size() const { return states.size(); }
+        /**
+         * @brief Get a state of the trajectory
+         *
+         * @param index the index of the state
+         * @return const TrajectoryState& the state
+         */
+        const TrajectoryState& at(size_t index) const { return states[index]; }
+    private:
+        std::vector<TrajectoryState> states;
+};
+} // namespace lemlib
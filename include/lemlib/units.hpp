@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cmath>
+
+namespace lemlib {
+/** degrees in a radian */
+constexpr float DEG_PER_RAD = 180 / M_PI;
+/** radians in a degree */
+constexpr float RAD_PER_DEG = M_PI / 180;
+/** inches in a centimeter */
+constexpr float IN_PER_CM = 1 / 2.54;
+/** inches in a field tile */
+constexpr float IN_PER_TILE = 24;
+
+/**
+ * @brief An angle, which converts to and from degrees and radians at compile time
+ *
+ * The angle is stored in radians. Every conversion is a multiplication by a constant, and every member is constexpr,
+ * so conversions of constants fold away completely and conversions in loops are a single float multiply
+ *
+ * @b Example
+ * @code {.cpp}
+ * using namespace lemlib::literals;
+ * // folded to a constant at compile time
+ * constexpr float quarter = (90_deg).radians();
+ * const lemlib::Angle error = lemlib::Angle::fromRadians(angleError(target, pose.theta));
+ * pid.update(error.degrees());
+ * @endcode
+ */
+class Angle {
+    public:
+        /**
+         * @brief Make an angle from radians
+         *
+         * @param radians the angle, in radians
+         * @return constexpr Angle the angle
+         */
+        static constexpr Angle fromRadians(float radians) { return Angle(radians); }
+
+        /**
+         * @brief Make an angle from degrees
+         *
+         * @param degrees the angle, in degrees
+         * @return constexpr Angle the angle
+         */
+        static constexpr Angle fromDegrees(float degrees) { return Angle(degrees * RAD_PER_DEG); }
+
+        /**
+         * @brief Get the angle in radians
+         *
+         * @return constexpr float the angle, in radians
+         */
+        constexpr float radians() const { return value; }
+
+        /**
+         * @brief Get the angle in degrees
+         *
+         * @return constexpr float the angle, in degrees
+         */
+        constexpr float degrees() const { return value * DEG_PER_RAD; }
+
+        constexpr Angle operator+(Angle other) const { return Angle(value + other.value); }
+
+        constexpr Angle operator-(Angle other) const { return Angle(value - other.value); }
+
+        constexpr Angle operator-() const { return Angle(-value); }
+
+        constexpr Angle operator*(float scale) const { return Angle(value * scale); }
+
+        constexpr Angle operator/(float scale) const { return Angle(value / scale); }
+
+        constexpr bool operator<(Angle other) const { return value < other.value; }
+
+        constexpr bool operator>(Angle other) const { return value > other.value; }
+
+        constexpr bool operator==(Angle other) const { return value == other.value; }
+
+        constexpr bool operator!=(Angle other) const { return value != other.value; }
+    private:
+        constexpr explicit Angle(float radians)
+            : value(radians) {}
+
+        float value;
+};
+
+/**
+ * @brief A length, which converts to and from inches, centimeters, and field tiles at compile time
+ *
+ * The length is stored in inches, the unit the rest of LemLib uses
+ *
+ * @b Example
+ * @code {.cpp}
+ * using namespace lemlib::literals;
+ * // 1.5 tiles forward
+ * chassis.moveToPoint(0, (1.5_tiles).inches(), 2000);
+ * @endcode
+ */
+class Length {
+    public:
+        /**
+         * @brief Make a length from inches
+         *
+         * @param inches the length, in inches
+         * @return constexpr Length the length
+         */
+        static constexpr Length fromInches(float inches) { return Length(inches); }
+
+        /**
+         * @brief Make a length from centimeters
+         *
+         * @param centimeters the length, in centimeters
+         * @return constexpr Length the length
+         */
+        static constexpr Length fromCentimeters(float centimeters) { return Length(centimeters * IN_PER_CM); }
+
+        /**
+         * @brief Make a length from field tiles
+         *
+         * @param tiles the length, in 24 inch tiles
+         * @return constexpr Length the length
+         */
+        static constexpr Length fromTiles(float tiles) { return Length(tiles * IN_PER_TILE); }
+
+        /**
+         * @brief Get the length in inches
+         *
+         * @return constexpr float the length, in inches
+         */
+        constexpr float inches() const { return value; }
+
+        /**
+         * @brief Get the length in centimeters
+         *
+         * @return constexpr float the length, in centimeters
+         */
+        constexpr float centimeters() const { return value * (1 / IN_PER_CM); }
+
+        /**
+         * @brief Get the length in field tiles
+         *
+         * @return constexpr float the length, in 24 inch tiles
+         */
+        constexpr float tiles() const { return value * (1 / IN_PER_TILE); }
+
+        constexpr Length operator+(Length other) const { return Length(value + other.value); }
+
+        constexpr Length operator-(Length other) const { return Length(value - other.value); }
+
+        constexpr Length operator-() const { return Length(-value); }
+
+        constexpr Length operator*(float scale) const { return Length(value * scale); }
+
+        constexpr Length operator/(float scale) const { return Length(value / scale); }
+
+        constexpr bool operator<(Length other) const { return value < other.value; }
+
+        constexpr bool operator>(Length other) const { return value > other.value; }
+
+        constexpr bool operator==(Length other) const { return value == other.value; }
+
+        constexpr bool operator!=(Length other) const { return value != other.value; }
+    private:
+        constexpr explicit Length(float inches)
+            : value(inches) {}
+
+        float value;
+};
+
+/**
+ * @brief Literals for angles and lengths, like 90_deg or 1.5_tiles
+ */
+namespace literals {
+constexpr Angle operator""_deg(long double degrees) { return Angle::fromDegrees(degrees); }
+
+constexpr Angle operator""_deg(unsigned long long degrees) { return Angle::fromDegrees(degrees); }
+
+constexpr Angle operator""_rad(long double radians) { return Angle::fromRadians(radians); }
+
+constexpr Angle operator""_rad(unsigned long long radians) { return Angle::fromRadians(radians); }
+
+constexpr Length operator""_in(long double inches) { return Length::fromInches(inches); }
+
+constexpr Length operator""_in(unsigned long long inches) { return Length::fromInches(inches); }
+
+constexpr Length operator""_cm(long double centimeters) { return Length::fromCentimeters(centimeters); }
+
+constexpr Length operator""_cm(unsigned long long centimeters) { return Length::fromCentimeters(centimeters); }
+
+constexpr Length operator""_tiles(long double tiles) { return Length::fromTiles(tiles); }
+
+constexpr Length operator""_tiles(unsigned long long tiles) { return Length::fromTiles(tiles); }
+} // namespace literals
+} // namespace lemlib
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include <vector>
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/pose.hpp"
+#include "lemlib/units.hpp"
 
 namespace lemlib {
 /**
@@ -40,7 +42,7 @@ float slew(float target, float current, float maxChange);
  * radToDeg(M_PI); // returns 180
  * @endcode
  */
-constexpr float radToDeg(float rad) { return rad * 180 / M_PI; }
+constexpr float radToDeg(float rad) { return rad * DEG_PER_RAD; }
 
 /**
  * @brief Convert degrees to radians
@@ -53,7 +55,7 @@ constexpr float radToDeg(float rad) { return rad * 180 / M_PI; }
  * degToRad(180); // returns 3.14159... (pi)
  * @endcode
  */
-constexpr float degToRad(float deg) { return deg * M_PI / 180; }
+constexpr float degToRad(float deg) { return deg * RAD_PER_DEG; }
 
 /**
  * @brief Sanitize an angle so its positive and within the range of 0 to 2pi or 0 to 360
@@ -75,7 +77,15 @@ constexpr float degToRad(float deg) { return deg * M_PI / 180; }
  * sanitizeAngle(7 * M_PI); // returns pi
  * @endcode
  */
-constexpr float sanitizeAngle(float angle, bool radians = true);
+constexpr float sanitizeAngle(float angle, bool radians = true) {
+    // std::fmod isn't constexpr, so whole turns are removed by truncating, in double precision so nothing is lost
+    if (angle - angle != 0) return angle - angle; // infinity and NaN have no angle
+    const double full = radians ? 2 * M_PI : 360;
+    const double turns = angle / full;
+    double fraction = turns - double(int64_t(turns));
+    if (fraction < 0) fraction += 1;
+    return fraction * full;
+}
 
 /**
  * @brief Calculate the error between 2 angles. Useful when calculating the error between 2 headings
@@ -122,7 +132,7 @@ template <typename T> constexpr T sgn(T value) { return value < 0 ? -1 : 1; }
  * avg(values); // returns 3
  * @endcode
  */
-float avg(std::vector<float> values);
+float avg(const std::vector<float>& values);
 
 /**
  * @brief Exponential moving average
@@ -153,7 +163,7 @@ float ema(float current, float previous, float smooth);
  *
  * @param pose the first pose
  * @param other the second pose
- * @return float curvature
+ * @return float curvature. 0 if the poses are at the same point
  *
  * @b Example
  * @code {.cpp}
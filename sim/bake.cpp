@@ -0,0 +1,64 @@
+// Checks that paths baked at compile time are the ones generatePath makes at runtime, and prints how far apart they
+// are. Exits with 1 if any of them differ by more than float rounding
+#include <cmath>
+#include <cstdio>
+#include "lemlib/api.hpp"
+
+// largest difference allowed between a baked and a generated path, in inches, velocity units, and 1 / inches
+constexpr float POSITION_TOLERANCE = 0.01;
+constexpr float VELOCITY_TOLERANCE = 0.05;
+constexpr float CURVATURE_TOLERANCE = 0.001;
+
+// an S curve through the middle of the field, like a route to the other side
+constexpr lemlib::Waypoint S_CURVE[] = {{0, 0, 0}, {24, 36, 45}, {0, 72, -45}, {24, 96, 0}};
+// a sharp turn, so the velocity is limited by the curvature
+constexpr lemlib::Waypoint HOOK[] = {{0, 0, 0}, {0, 36, 0}, {24, 36, 180}};
+
+constexpr lemlib::PathConstraints DEFAULT_CONSTRAINTS {};
+constexpr lemlib::PathConstraints LIMITED_CONSTRAINTS {
+    .type = lemlib::SplineType::QUINTIC_HERMITE, .spacing = 2, .maxVelocity = 90, .maxAcceleration = 60, .k = 2};
+
+// declared constexpr, so the compiler bakes them
+constexpr auto S_CURVE_BAKED = lemlib::bakePath<200>(S_CURVE, DEFAULT_CONSTRAINTS);
+constexpr auto S_CURVE_LIMITED = lemlib::bakePath<200>(S_CURVE, LIMITED_CONSTRAINTS);
+constexpr auto HOOK_BAKED = lemlib::bakePath<200>(HOOK, DEFAULT_CONSTRAINTS);
+constexpr auto HOOK_LIMITED = lemlib::bakePath<200>(HOOK, LIMITED_CONSTRAINTS);
+
+/**
+ * @brief Compare a baked path with the path generatePath makes from the same waypoints and constraints
+ *
+ * @return true the paths are the same, within the tolerances
+ */
+template <size_t N, size_t W>
+static bool compare(const char* name, const lemlib::BakedPath<N>& baked, const lemlib::Waypoint (&waypoints)[W],
+                    const lemlib::PathConstraints& constraints) {
+    lemlib::PathArena arena(N);
+    const lemlib::Path generated = lemlib::generatePath(arena, {waypoints, waypoints + W}, constraints);
+    const lemlib::Path path = baked.path();
+    if (generated.size() != path.size()) {
+        std::printf("%-16s %zu points baked, %zu generated\n", name, path.size(), generated.size());
+        return false;
+    }
+    float position = 0, velocity = 0, curvature = 0, distance = 0;
+    for (size_t i = 0; i < path.size(); i++) {
+        position = std::fmax(position, path.at(i).distance(generated.at(i)));
+        velocity = std::fmax(velocity, std::fabs(path.velocity(i) - generated.velocity(i)));
+        curvature = std::fmax(curvature, std::fabs(path.curvature(i) - generated.curvature(i)));
+        distance = std::fmax(distance, std::fabs(path.distance(i) - generated.distance(i)));
+    }
+    const bool same = position <= POSITION_TOLERANCE && distance <= POSITION_TOLERANCE &&
+                      velocity <= VELOCITY_TOLERANCE && curvature <= CURVATURE_TOLERANCE;
+    std::printf("%-16s %6zu %10.5f %10.5f %10.5f %10.5f  %s\n", name, path.size(), position, distance, velocity,
+                curvature, same ? "ok" : "DIFFERENT");
+    return same;
+}
+
+int main() {
+    std::printf("%-16s %6s %10s %10s %10s %10s\n", "path", "points", "position", "distance", "velocity", "curvature");
+    bool same = true;
+    same &= compare("s curve", S_CURVE_BAKED, S_CURVE, DEFAULT_CONSTRAINTS);
+    same &= compare("s curve limited", S_CURVE_LIMITED, S_CURVE, LIMITED_CONSTRAINTS);
+    same &= compare("hook", HOOK_BAKED, HOOK, DEFAULT_CONSTRAINTS);
+    same &= compare("hook limited", HOOK_LIMITED, HOOK, LIMITED_CONSTRAINTS);
+    return same ? 0 : 1;
+}
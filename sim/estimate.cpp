@@ -0,0 +1,54 @@
+// Estimates how long an autonomous route takes on the simulated robot, and how much slack each motion has
+#include <cstdio>
+#include "lemlib/api.hpp"
+#include "sim/route.hpp"
+
+// the same robot as main.cpp
+pros::Motor leftFront(-1, pros::E_MOTOR_GEARSET_06), leftMiddle(-2, pros::E_MOTOR_GEARSET_06),
+    leftBack(-3, pros::E_MOTOR_GEARSET_06);
+pros::Motor rightFront(4, pros::E_MOTOR_GEARSET_06), rightMiddle(5, pros::E_MOTOR_GEARSET_06),
+    rightBack(6, pros::E_MOTOR_GEARSET_06);
+pros::MotorGroup leftMotors({leftFront, leftMiddle, leftBack});
+pros::MotorGroup rightMotors({rightFront, rightMiddle, rightBack});
+pros::Imu imu(10);
+pros::Rotation verticalEncoder(11);
+pros::Rotation horizontalEncoder(12);
+lemlib::TrackingWheel vertical(&verticalEncoder, lemlib::Omniwheel::NEW_275, -0.5);
+lemlib::TrackingWheel horizontal(&horizontalEncoder, lemlib::Omniwheel::NEW_275, -3);
+
+int main() {
+    sim::RobotModel robot;
+    robot.leftPorts = {1, 2, 3};
+    robot.rightPorts = {4, 5, 6};
+    robot.imuPort = 10;
+    robot.trackingWheels = {{sim::TrackingWheelModel::Encoder::ROTATION, 11, 2.75, -0.5, true},
+                            {sim::TrackingWheelModel::Encoder::ROTATION, 12, 2.75, -3, false}};
+    lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+    lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+    const lemlib::ControllerSettings lateral(10, 0, 3, 3, 1, 100, 3, 500, 20);
+    const lemlib::ControllerSettings angular(2, 0, 10, 3, 1, 100, 3, 500, 0);
+
+    sim::RouteEstimator route(robot, drivetrain, lateral, angular, sensors);
+    route.add("to goal", 3000, [](lemlib::Chassis& chassis, int timeout) {
+        return chassis.moveToPose(24, 24, 90, timeout);
+    });
+    route.add("face wall", 1000, [](lemlib::Chassis& chassis, int timeout) {
+        return chassis.turnToHeading(180, timeout);
+    });
+    route.add("to wall", 2000, [](lemlib::Chassis& chassis, int timeout) {
+        return chassis.moveToPoint(24, -12, timeout);
+    });
+    route.add("back to start", 4000, [](lemlib::Chassis& chassis, int timeout) {
+        return chassis.moveToPose(0, 0, 0, timeout, {.forwards = false});
+    });
+
+    const sim::RouteEstimate estimate = route.run();
+    std::printf("%-16s %10s %10s %10s %10s  %s\n", "segment", "start ms", "ms", "timeout", "slack", "end");
+    for (const sim::SegmentEstimate& segment : estimate.segments) {
+        std::printf("%-16s %10u %10u %10u %10u  %s\n", segment.name.c_str(), segment.start, segment.duration,
+                    segment.timeout, segment.slack, sim::reasonName(segment.reason));
+    }
+    std::printf("total %u ms, %d ms of the %u ms budget left%s\n", estimate.total, estimate.slack, route.budget,
+                estimate.reason == sim::StopReason::FINISHED ? "" : ", the route did not finish");
+    return estimate.reason == sim::StopReason::FINISHED && estimate.slack >= 0 ? 0 : 1;
+}
@@ -0,0 +1,53 @@
+// Follows a corpus of paths on the simulated robot at several lookaheads and speeds, and prints how closely each was
+// tracked, how long it took, and how much CPU time each iteration of pursuit used
+#include <cstdio>
+#include "lemlib/api.hpp"
+#include "sim/followBench.hpp"
+
+// the same robot as main.cpp
+pros::Motor leftFront(-1, pros::E_MOTOR_GEARSET_06), leftMiddle(-2, pros::E_MOTOR_GEARSET_06),
+    leftBack(-3, pros::E_MOTOR_GEARSET_06);
+pros::Motor rightFront(4, pros::E_MOTOR_GEARSET_06), rightMiddle(5, pros::E_MOTOR_GEARSET_06),
+    rightBack(6, pros::E_MOTOR_GEARSET_06);
+pros::MotorGroup leftMotors({leftFront, leftMiddle, leftBack});
+pros::MotorGroup rightMotors({rightFront, rightMiddle, rightBack});
+pros::Imu imu(10);
+pros::Rotation verticalEncoder(11);
+pros::Rotation horizontalEncoder(12);
+lemlib::TrackingWheel vertical(&verticalEncoder, lemlib::Omniwheel::NEW_275, -0.5);
+lemlib::TrackingWheel horizontal(&horizontalEncoder, lemlib::Omniwheel::NEW_275, -3);
+
+int main() {
+    sim::RobotModel robot;
+    robot.leftPorts = {1, 2, 3};
+    robot.rightPorts = {4, 5, 6};
+    robot.imuPort = 10;
+    robot.trackingWheels = {{sim::TrackingWheelModel::Encoder::ROTATION, 11, 2.75, -0.5, true},
+                            {sim::TrackingWheelModel::Encoder::ROTATION, 12, 2.75, -3, false}};
+    lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+    lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+    const lemlib::ControllerSettings lateral(10, 0, 3, 3, 1, 100, 3, 500, 20);
+    const lemlib::ControllerSettings angular(2, 0, 10, 3, 1, 100, 3, 500, 0);
+
+    sim::FollowBenchmark benchmark(robot, drivetrain, lateral, angular, sensors);
+    benchmark.paths.push_back({"tight s-curve", {{0, 0, 0}, {18, 18, 90}, {36, 0, 180}, {54, -18, 90}}});
+    benchmark.paths.push_back({"long straight", {{0, 0, 0}, {0, 96, 0}}});
+    benchmark.paths.push_back({"skills route", {{-48, -60, 0},
+                                                 {-24, -24, 45},
+                                                 {0, 0, 90},
+                                                 {36, 12, 45},
+                                                 {48, 48, 0},
+                                                 {24, 60, -90},
+                                                 {-24, 48, -135}},
+                               15000});
+
+    std::printf("%-14s %9s %6s %10s %10s %10s %10s %7s %10s\n", "path", "lookahead", "speed", "motion ms", "mean err",
+                "max err", "final err", "ticks", "ns/tick");
+    for (const sim::FollowResult& result : benchmark.run({6, 10, 15}, {60, 90, 127})) {
+        std::printf("%-14s %9.1f %6.0f %10u %10.2f %10.2f %10.2f %7u %10.0f%s%s\n",
+                    benchmark.paths[result.settings.path].name.c_str(), result.settings.lookahead,
+                    result.settings.speed, result.motionTime, result.meanError, result.maxError, result.finalError,
+                    result.ticks, result.tickTime, result.reason == sim::StopReason::FINISHED ? "" : "  did not finish",
+                    result.endReason == lemlib::MotionEndReason::TIMEOUT ? "  timed out" : "");
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/path/generator.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+/**
+ * @brief A path in the corpus of a follow benchmark
+ */
+struct BenchPath {
+        /** the name the path is reported with */
+        std::string name;
+        /** the waypoints the path is generated through. The robot starts at the first, theta in degrees */
+        std::vector<lemlib::Waypoint> waypoints;
+        /** the timeout of the motion, in milliseconds. 10000 by default */
+        int timeout = 10000;
+};
+
+/**
+ * @brief The settings of 1 run of a follow benchmark
+ */
+struct FollowCase {
+        /** index of the path in the corpus */
+        std::size_t path;
+        /** the lookahead distance, in inches */
+        float lookahead;
+        /** the max velocity the path is generated with, in the units of path files */
+        float speed;
+};
+
+/**
+ * @brief How well the robot followed a path in 1 run of a follow benchmark
+ *
+ * Errors are measured from the simulated robot, not from odometry, so odometry error shows up too
+ */
+struct FollowResult {
+        /** the settings of the run */
+        FollowCase settings;
+        /** why the simulation stopped. Anything but FINISHED means the motion never returned */
+        StopReason reason;
+        /** why the motion ended */
+        lemlib::MotionEndReason endReason;
+        /** how long the motion ran, in milliseconds */
+        std::uint32_t motionTime;
+        /** mean distance from the robot to the path while it was followed, in inches */
+        float meanError;
+        /** farthest the robot was from the path, in inches */
+        float maxError;
+        /** distance from the robot to the end of the path when the motion ended, in inches */
+        float finalError;
+        /** number of iterations of the motion loop */
+        std::uint32_t ticks;
+        /** CPU time of the motion task on the computer for each iteration, in nanoseconds */
+        double tickTime;
+};
+
+/**
+ * @brief Runs Chassis::follow on the simulated robot over a corpus of paths, at every combination of lookahead and
+ * speed
+ *
+ * Each path is generated with generatePath at the speed of the run, so pursuit gets the same points it gets from a
+ * path file. Like MotionSweep, each run gets a world of its own, and the runs are spread across threads. The paths
+ * and the errors are deterministic, but the CPU time depends on the computer and what else it is running, so it is
+ * only comparable between runs on the same machine.
+ *
+ * @note the devices in the drivetrain and sensors are shared by every run, so they must not be used by anything
+ * else during the benchmark
+ *
+ * @b Example
+ * @code {.cpp}
+ * sim::FollowBenchmark benchmark(robot, drivetrain, lateral, angular, sensors);
+ * benchmark.paths.push_back({"s-curve", {{0, 0, 0}, {24, 24, 90}, {48, 48, 0}}});
+ * for (const sim::FollowResult& result : benchmark.run({8, 12}, {80, 127})) {
+ *     std::cout << result.settings.lookahead << ": " << result.meanError << " in" << std::endl;
+ * }
+ * @endcode
+ */
+class FollowBenchmark {
+    public:
+        /**
+         * @brief Construct a new Follow Benchmark
+         *
+         * @param robot the physical properties of the simulated robot
+         * @param drivetrain the drivetrain of the chassis
+         * @param lateral the lateral controller settings of the chassis
+         * @param angular the angular controller settings of the chassis
+         * @param sensors the odometry sensors of the chassis
+         */
+        FollowBenchmark(RobotModel robot, lemlib::Drivetrain drivetrain, lemlib::ControllerSettings lateral,
+                        lemlib::ControllerSettings angular, lemlib::OdomSensors sensors);
+        /**
+         * @brief Follow every path with every combination of lookahead and speed
+         *
+         * @param lookaheads the lookahead distances to try, in inches
+         * @param speeds the max velocities to try, in the units of path files
+         * @param threads the number of threads to run on. 0 to use every core. 0 by default
+         * @return std::vector<FollowResult> a result for each combination, with the speeds varying fastest, then the
+         * lookaheads, then the paths
+         */
+        std::vector<FollowResult> run(const std::vector<float>& lookaheads, const std::vector<float>& speeds,
+                                      unsigned threads = 0) const;
+        /**
+         * @brief Follow 1 path with 1 lookahead and speed
+         *
+         * @param settings the settings
+         * @return FollowResult how well the path was followed
+         */
+        FollowResult runCase(const FollowCase& settings) const;
+
+        /** the paths that are followed */
+        std::vector<BenchPath> paths;
+    private:
+        RobotModel robot;
+        lemlib::Drivetrain drivetrain;
+        lemlib::ControllerSettings lateral;
+        lemlib::ControllerSettings angular;
+        lemlib::OdomSensors sensors;
+};
+} // namespace sim
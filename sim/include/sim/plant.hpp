@@ -0,0 +1,312 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "pros/motors.h"
+#include "lemlib/pose.hpp"
+
+namespace sim {
+/**
+ * @brief A tracking wheel on the simulated robot
+ */
+struct TrackingWheelModel {
+        /** the kind of encoder the wheel is read with */
+        enum class Encoder { ROTATION, ADI_ENCODER };
+
+        Encoder encoder;
+        /** smart port of the rotation sensor, or the top port of the ADI encoder, from 'A' to 'H' */
+        std::uint8_t port;
+        /** diameter of the wheel, in inches */
+        float diameter;
+        /**
+         * distance from the center of rotation, in inches. Positive is right for vertical wheels, and forwards for
+         * horizontal wheels, the same as lemlib::TrackingWheel
+         */
+        float offset;
+        /** true if the wheel measures forwards motion, false if it measures sideways motion */
+        bool vertical;
+        /** gear ratio between the wheel and the encoder */
+        float gearRatio = 1;
+};
+
+/**
+ * @brief The physical properties of the simulated robot
+ *
+ * Motors are assumed to be reversed correctly in the code, so a positive voltage on any drive motor pushes its side
+ * forwards, or its wheel on an X-drive, and every encoder counts up when its wheel moves forwards, or left for
+ * horizontal tracking wheels. The defaults are close to a 15 lb robot with a 450 rpm drivetrain on 3.25" wheels
+ */
+struct RobotModel {
+        /** smart ports of the motors on the left side of the drivetrain */
+        std::vector<std::uint8_t> leftPorts;
+        /** smart ports of the motors on the right side of the drivetrain */
+        std::vector<std::uint8_t> rightPorts;
+        /**
+         * smart ports of the motors of each wheel of an X-drive: front left, front right, back left, and back right.
+         * If any are set, the robot is an X-drive and leftPorts and rightPorts aren't used
+         */
+        std::array<std::vector<std::uint8_t>, 4> xDrivePorts;
+        /** distance between the front and back wheels of an X-drive, in inches */
+        float wheelBase = 12;
+        /** distance between the left and right wheels, in inches */
+        float trackWidth = 12;
+        /** diameter of the drive wheels, in inches */
+        float wheelDiameter = 3.25;
+        /** speed of the drive wheels when the motors run at their free speed, in rpm */
+        float rpm = 450;
+        /** free speed of the cartridge in the drive motors, in rpm */
+        float motorRpm = 600;
+        /** mass of the robot, in kilograms */
+        float mass = 6.8;
+        /** moment of inertia of the robot around its center of rotation, in kilogram square meters */
+        float inertia = 0.25;
+        /** coefficient of friction between the drive wheels and the floor, in the direction they roll */
+        float traction = 1.1;
+        /** coefficient of friction between the drive wheels and the floor, sideways */
+        float lateralTraction = 0.9;
+        /** fraction of the stall torque of the drive motors that is lost to friction in the drivetrain */
+        float friction = 0.05;
+        /** rotating mass of each side of the drivetrain, as a mass at the tread of the wheels, in kilograms */
+        float wheelMass = 0.4;
+        /** the tracking wheels */
+        std::vector<TrackingWheelModel> trackingWheels;
+        /** smart port of the inertial sensor, or 0 if there isn't one */
+        std::uint8_t imuPort = 0;
+        /** how fast the heading measured by the inertial sensor drifts, in degrees per second */
+        float imuDrift = 0;
+        /** how long the inertial sensor takes to calibrate, in milliseconds */
+        std::uint32_t imuCalibrationTime = 2000;
+};
+
+/**
+ * @brief The state of a motor on a smart port
+ *
+ * Set by the simulated PROS motor classes, and read by the plant. Ports that aren't part of the drivetrain keep the
+ * commands they are sent, but never move
+ */
+struct MotorState {
+        /** voltage the motor was told to output, in millivolts */
+        std::int32_t voltage = 0;
+        /** the brake mode, used when the motor is braking */
+        pros::motor_brake_mode_e_t brakeMode = pros::E_MOTOR_BRAKE_COAST;
+        /** true after the motor is told to brake, until it is sent another command */
+        bool braking = false;
+        /** true when the motor holds its position, after braking in hold mode or moving to a position */
+        bool holding = false;
+        /** where a holding motor holds its position, in degrees */
+        double holdPosition = 0;
+        /** position of the output shaft, in degrees */
+        double position = 0;
+        /** velocity of the output shaft, in rpm */
+        double velocity = 0;
+        /** torque on the output shaft, in newton meters */
+        double torque = 0;
+};
+
+/**
+ * @brief The state of the simulated robot, in the units of LemLib
+ */
+struct PlantState {
+        /** pose of the robot, theta in degrees */
+        lemlib::Pose pose;
+        /** velocity of the robot relative to itself, in inches per second. Theta is in degrees per second */
+        lemlib::Pose localVelocity;
+        /** whether the left wheels are slipping. On an X-drive, whether either left wheel is */
+        bool leftSlipping;
+        /** whether the right wheels are slipping. On an X-drive, whether either right wheel is */
+        bool rightSlipping;
+        /** time since the simulation started, in microseconds */
+        std::uint64_t time;
+};
+
+/**
+ * @brief Dynamics of a differential drive robot
+ *
+ * Each drivetrain motor is a DC motor with the stall torque and free speed of a V5 motor. The wheels grip the floor
+ * until the force on them is more than friction can hold, then they slip until their speed matches the floor again.
+ * Sideways, the wheels hold the robot until it turns fast enough that friction can't provide the centripetal force,
+ * which is what horizontalDrift compensates for
+ *
+ * An X-drive has a wheel at each corner, turned 45 degrees, and each wheel only grips the floor in the direction it
+ * rolls, so the robot can be pushed in any direction
+ *
+ * The tracking wheels measure the motion of the robot over the floor, while the motor encoders measure the motion of
+ * the drive wheels, so wheel slip shows up the same way it does on a real robot
+ *
+ * @b Example
+ * @code {.cpp}
+ * sim::RobotModel robot;
+ * robot.leftPorts = {1, 2, 3};
+ * robot.rightPorts = {4, 5, 6};
+ * sim::DrivePlant plant(robot);
+ * // full power forwards for 1 second
+ * for (int port = 1; port <= 6; port++) plant.motor(port).voltage = 12000;
+ * for (int i = 0; i < 1000; i++) plant.step(1000);
+ * std::cout << lemlib::format_as(plant.getState().pose) << std::endl;
+ * @endcode
+ */
+class DrivePlant {
+    public:
+        /**
+         * @brief Construct a new Drive Plant, at rest at the origin
+         *
+         * @param robot the physical properties of the robot
+         */
+        DrivePlant(RobotModel robot);
+        /**
+         * @brief Advance the simulation
+         *
+         * @param dt how long to advance by, in microseconds
+         */
+        void step(std::uint32_t dt);
+        /**
+         * @brief Get the state of the robot
+         *
+         * @return PlantState the state
+         */
+        PlantState getState() const;
+        /**
+         * @brief Move the robot, without changing its readings
+         *
+         * @param pose the new pose, theta in degrees
+         */
+        void setPose(lemlib::Pose pose);
+        /**
+         * @brief Get the physical properties of the robot
+         *
+         * @return const RobotModel& the physical properties
+         */
+        const RobotModel& getModel() const;
+        /**
+         * @brief Get the motor on a smart port
+         *
+         * @param port the port, from 1 to 21
+         * @return MotorState& the motor
+         */
+        MotorState& motor(std::uint8_t port);
+        /**
+         * @brief Get the angle of the encoder of a tracking wheel
+         *
+         * @param encoder the kind of encoder
+         * @param port the port of the encoder
+         * @return double* the angle in degrees, which can be set to reset the encoder. nullptr if there is no tracking
+         * wheel on the port
+         */
+        double* encoderAngle(TrackingWheelModel::Encoder encoder, std::uint8_t port);
+        /**
+         * @brief Get the speed of the encoder of a tracking wheel
+         *
+         * @param encoder the kind of encoder
+         * @param port the port of the encoder
+         * @return double the speed in degrees per second. 0 if there is no tracking wheel on the port
+         */
+        double encoderRate(TrackingWheelModel::Encoder encoder, std::uint8_t port) const;
+        /**
+         * @brief Get the rotation measured by the inertial sensor
+         *
+         * @return double& the rotation in degrees, clockwise positive. It can be set to tare the sensor
+         */
+        double& imuRotation();
+        /**
+         * @brief Get the angular velocity of the robot, as measured by the inertial sensor
+         *
+         * @return double the angular velocity in degrees per second, clockwise positive
+         */
+        double imuRate() const;
+        /**
+         * @brief Start calibrating the inertial sensor
+         */
+        void calibrateImu();
+        /**
+         * @brief Whether the inertial sensor is calibrating
+         *
+         * @return true the inertial sensor is calibrating
+         * @return false the inertial sensor is ready
+         */
+        bool imuCalibrating() const;
+    private:
+        /**
+         * @brief The state of 1 side of the drivetrain
+         */
+        struct Side {
+                /** speed of the tread of the wheels, in meters per second */
+                double speed = 0;
+                /** whether the wheels are slipping on the floor */
+                bool slipping = false;
+                /** force the floor pushes the robot with, in newtons */
+                double force = 0;
+        };
+
+        /**
+         * @brief Find the force the motors of a side push the wheels with
+         *
+         * Also updates the speed, position, and torque of each motor
+         *
+         * @param ports the ports of the motors
+         * @param speed the speed of the tread of the wheels, in meters per second
+         * @param dt the time since the last substep, in seconds
+         * @return double the force, in newtons
+         */
+        double driveForce(const std::vector<std::uint8_t>& ports, double speed, double dt);
+        /**
+         * @brief Update a side of the drivetrain: whether it is slipping, the force on it, and its speed
+         *
+         * @param side the side, or a wheel of an X-drive
+         * @param ports the ports of the motors of the side
+         * @param groundSpeed speed of the floor under the wheels, in meters per second
+         * @param share the fraction of the weight of the robot the wheels carry
+         * @param dt the length of the substep, in seconds
+         */
+        void updateSide(Side& side, const std::vector<std::uint8_t>& ports, double groundSpeed, double share,
+                        double dt);
+        /**
+         * @brief Update the speeds of a differential drive robot for 1 substep
+         *
+         * @param dt the length of the substep, in seconds
+         */
+        void substepDifferential(double dt);
+        /**
+         * @brief Update the speeds of an X-drive for 1 substep
+         *
+         * @param dt the length of the substep, in seconds
+         */
+        void substepXDrive(double dt);
+        /**
+         * @brief Advance the simulation by 1 substep
+         *
+         * @param dt the length of the substep, in seconds
+         */
+        void substep(double dt);
+        /**
+         * @brief Find the tracking wheel read by an encoder
+         *
+         * @return int the index of the tracking wheel in robot.trackingWheels, or -1 if there isn't one
+         */
+        int findTrackingWheel(TrackingWheelModel::Encoder encoder, std::uint8_t port) const;
+
+        RobotModel robot;
+        // the state of the robot, in meters, radians, and seconds. theta is clockwise from the y axis
+        double x = 0;
+        double y = 0;
+        double theta = 0;
+        double forwardSpeed = 0;
+        double lateralSpeed = 0; // positive is right
+        double angularSpeed = 0; // positive is clockwise
+        Side left;
+        Side right;
+        // the wheels of an X-drive, in the order of RobotModel::xDrivePorts
+        std::array<Side, 4> wheels;
+        // whether the robot is an X-drive
+        bool xDrive;
+        std::uint64_t time = 0;
+        // ports are numbered from 1, so index 0 isn't used
+        std::array<MotorState, 22> motors {};
+        // angle of the encoder of each tracking wheel in robot.trackingWheels, in degrees
+        std::vector<double> encoderAngles;
+        // speed of the encoder of each tracking wheel, in degrees per second
+        std::vector<double> encoderRates;
+        double imuAngle = 0;
+        std::uint64_t imuReadyTime = 0;
+};
+} // namespace sim
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+/**
+ * @brief How long 1 motion of a route took on the simulated robot
+ */
+struct SegmentEstimate {
+        /** the name the segment was added with */
+        std::string name;
+        /** when the motion started, in milliseconds since the route started */
+        std::uint32_t start;
+        /** how long the motion ran, in milliseconds */
+        std::uint32_t duration;
+        /** the timeout of the motion, in milliseconds */
+        std::uint32_t timeout;
+        /**
+         * how much longer the motion could have run before timing out, in milliseconds. 0 if it timed out, which
+         * usually means the timeout is too short or the motion never settles
+         */
+        std::uint32_t slack;
+        /** why the motion ended */
+        lemlib::MotionEndReason reason;
+};
+
+/**
+ * @brief Get the name of why a motion ended, to print it
+ *
+ * @param reason why the motion ended
+ * @return const char* the name. "unknown" for a reason without one
+ */
+const char* reasonName(lemlib::MotionEndReason reason);
+
+/**
+ * @brief How long a route took on the simulated robot
+ */
+struct RouteEstimate {
+        /** why the simulation stopped. Anything but FINISHED means the last segment never ended */
+        StopReason reason;
+        /** the segments that ran, in order */
+        std::vector<SegmentEstimate> segments;
+        /** how long the route took, in milliseconds */
+        std::uint32_t total;
+        /** how much time the budget had left at the end of the route, in milliseconds. Negative if it ran over */
+        std::int32_t slack;
+};
+
+/**
+ * @brief Estimates how long an autonomous route takes by running it on the simulated robot
+ *
+ * The route is a sequence of motions. Each one starts as soon as the one before it ends, like an autonomous that
+ * waits for each motion, so the estimate includes the time each motion spends settling. The robot is simulated with
+ * the real drivetrain limits and controller settings, so the same route and settings always give the same estimate
+ *
+ * @note the devices in the drivetrain and sensors must not be used by anything else while the route runs
+ *
+ * @b Example
+ * @code {.cpp}
+ * sim::RouteEstimator route(robot, drivetrain, lateralController, angularController, sensors);
+ * route.add("to goal", 3000, [](lemlib::Chassis& chassis, int timeout) {
+ *     return chassis.moveToPose(24, 48, 90, timeout);
+ * });
+ * route.add("face wall", 1000, [](lemlib::Chassis& chassis, int timeout) {
+ *     return chassis.turnToHeading(180, timeout);
+ * });
+ * const sim::RouteEstimate estimate = route.run();
+ * std::cout << "the route takes " << estimate.total << " ms, leaving " << estimate.slack << " ms" << std::endl;
+ * @endcode
+ */
+class RouteEstimator {
+    public:
+        /**
+         * @brief A function that starts the motion of a segment, without waiting for it to end
+         *
+         * It is passed the chassis and the timeout of the segment, and returns the handle of the motion
+         */
+        using Motion = std::function<lemlib::MotionHandle(lemlib::Chassis&, int)>;
+
+        /**
+         * @brief Construct a new Route Estimator
+         *
+         * @param robot the physical properties of the simulated robot
+         * @param drivetrain the drivetrain of the chassis
+         * @param lateral the lateral controller settings of the chassis
+         * @param angular the angular controller settings of the chassis
+         * @param sensors the odometry sensors of the chassis
+         */
+        RouteEstimator(RobotModel robot, lemlib::Drivetrain drivetrain, lemlib::ControllerSettings lateral,
+                       lemlib::ControllerSettings angular, lemlib::OdomSensors sensors);
+        /**
+         * @brief Add a segment to the end of the route
+         *
+         * @param name the name of the segment, which the estimate of the segment is reported with
+         * @param timeout the timeout of the motion, in milliseconds
+         * @param motion starts the motion. The motion must be asynchronous
+         * @return RouteEstimator& this estimator, so segments can be chained
+         */
+        RouteEstimator& add(std::string name, int timeout, Motion motion);
+        /**
+         * @brief Run the route on a simulated robot
+         *
+         * The chassis is constructed, calibrated, and moved to start before the route starts, so none of that
+         * counts towards the total
+         *
+         * @return RouteEstimate how long each segment and the whole route took
+         */
+        RouteEstimate run() const;
+
+        /** where the robot starts, theta in degrees. The origin by default */
+        lemlib::Pose start = lemlib::Pose(0, 0, 0);
+        /** how long the route is allowed to take, in milliseconds. 15000 by default, the length of an autonomous */
+        std::uint32_t budget = 15000;
+    private:
+        struct Segment {
+                std::string name;
+                int timeout;
+                Motion motion;
+        };
+
+        RobotModel robot;
+        lemlib::Drivetrain drivetrain;
+        lemlib::ControllerSettings lateral;
+        lemlib::ControllerSettings angular;
+        lemlib::OdomSensors sensors;
+        std::vector<Segment> segments;
+};
+} // namespace sim
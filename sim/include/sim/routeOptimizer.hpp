@@ -0,0 +1,218 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/path/generator.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+/**
+ * @brief How a leg of a route is driven
+ */
+enum class LegMotion {
+    /** Chassis::moveToPose to the target of the leg */
+    POSE,
+    /** Chassis::follow along a path generated from the end of the last leg to the target */
+    PATH
+};
+
+/**
+ * @brief A leg of a route. The robot drives from where the last leg ended to the target of the leg
+ */
+struct RouteLeg {
+        /** the name of the leg. The settings and path of the leg are written with it, so it should be a valid file
+         * name */
+        std::string name;
+        /** where the leg ends, theta in degrees. The heading is only held at the end of the last leg */
+        lemlib::Waypoint target;
+        /** the timeout of the motion, in milliseconds. 4000 by default */
+        int timeout = 4000;
+        /** whether the robot drives forwards. True by default */
+        bool forwards = true;
+};
+
+/**
+ * @brief How 1 leg of a route is driven
+ */
+struct LegSettings {
+        /** the motion that drives the leg. POSE by default */
+        LegMotion motion = LegMotion::POSE;
+        /** the lead of moveToPose. 0.6 by default */
+        float lead = 0.6;
+        /** the lookahead of follow, in inches. 10 by default */
+        float lookahead = 10;
+        /** the max speed of moveToPose, or the max velocity the path is generated with. 127 by default */
+        float speed = 127;
+        /** the speed the leg is chained into the next one at. 0, the default, settles on the target */
+        float minSpeed = 0;
+        /** how far from the target the leg exits, in inches. Only used when minSpeed is set. 0 by default */
+        float earlyExitRange = 0;
+        /** how far the target of the motion is moved from the target of the leg, in inches. 0 by default */
+        float offsetX = 0;
+        float offsetY = 0;
+};
+
+/**
+ * @brief How 1 leg went when a route was run
+ */
+struct LegRun {
+        /** when the motion started, in milliseconds since the route started */
+        std::uint32_t start;
+        /** how long the motion ran, in milliseconds */
+        std::uint32_t duration;
+        /** closest the robot came to the target of the leg, during the leg or the one after it, in inches */
+        float passError;
+        /** why the motion ended */
+        lemlib::MotionEndReason reason;
+};
+
+/**
+ * @brief How a route went on the simulated robot
+ *
+ * Errors are measured from the simulated robot, not from odometry, so odometry error shows up too
+ */
+struct RouteRun {
+        /** why the simulation stopped. Anything but FINISHED means the last leg never ended */
+        StopReason reason;
+        /** whether the route met every error constraint of the optimizer, without a leg timing out */
+        bool feasible;
+        /** how long the route took, in milliseconds */
+        std::uint32_t total;
+        /** the legs that ran, in order */
+        std::vector<LegRun> legs;
+        /** distance from the robot to the target of the last leg when it ended, in inches */
+        float finalError;
+        /** difference between the heading of the robot and the target of the last leg when it ended, in degrees */
+        float finalHeadingError;
+};
+
+/**
+ * @brief The fastest settings the optimizer found for a route
+ */
+struct RouteOptimum {
+        /** the settings of each leg */
+        std::vector<LegSettings> legs;
+        /** how the route went with them */
+        RouteRun run;
+        /** the number of times the route was simulated */
+        unsigned evaluations;
+};
+
+/**
+ * @brief Searches for the fastest way to drive a route on the simulated robot
+ *
+ * Each leg of the route can be driven with moveToPose, at every lead and speed, or by following a path, at every
+ * lookahead and speed. Every leg but the last can be chained into the next at every chain speed and exit range, and
+ * its target can be moved by up to nudge in x and y, so the robot cuts the corner. The search is coordinate descent:
+ * it tries every setting of one leg at a time with the rest of the route as it is, simulating the whole route each
+ * time, so the effect a leg has on the legs after it is counted. The candidates of a leg are spread across threads
+ * like MotionSweep, and passes over the legs repeat until none of them gets faster.
+ *
+ * Settings are only kept if the route stays feasible: the robot has to pass within passTolerance of the target of
+ * every leg, end within finalTolerance and finalAngle of the target of the last leg, and no leg can time out. The runs
+ * are deterministic and ties go to the first candidate, so the result doesn't depend on the number of threads.
+ *
+ * write saves the result for the robot: the settings of each leg in a ConfigStore file, and the path of each leg
+ * that is followed as a binary path file.
+ *
+ * @note the devices in the drivetrain and sensors are shared by every run, so they must not be used by anything
+ * else during the search
+ *
+ * @b Example
+ * @code {.cpp}
+ * sim::RouteOptimizer optimizer(robot, drivetrain, lateral, angular, sensors);
+ * optimizer.legs.push_back({"to goal", {24, 24, 90}, 3000});
+ * optimizer.legs.push_back({"to wall", {48, 0, 180}, 3000});
+ * const sim::RouteOptimum optimum = optimizer.optimize();
+ * std::cout << "the route takes " << optimum.run.total << " ms" << std::endl;
+ * optimizer.write(optimum, "route");
+ * @endcode
+ */
+class RouteOptimizer {
+    public:
+        /**
+         * @brief Construct a new Route Optimizer
+         *
+         * @param robot the physical properties of the simulated robot
+         * @param drivetrain the drivetrain of the chassis
+         * @param lateral the lateral controller settings of the chassis
+         * @param angular the angular controller settings of the chassis
+         * @param sensors the odometry sensors of the chassis
+         */
+        RouteOptimizer(RobotModel robot, lemlib::Drivetrain drivetrain, lemlib::ControllerSettings lateral,
+                       lemlib::ControllerSettings angular, lemlib::OdomSensors sensors);
+        /**
+         * @brief Search for the fastest feasible settings of the route
+         *
+         * The search starts from the default settings of every leg. If those aren't feasible, the first feasible
+         * settings found are kept, and if none are, the result is the settings that came closest
+         *
+         * @param threads the number of threads to run on. 0 to use every core. 0 by default
+         * @return RouteOptimum the fastest settings found, and how the route went with them
+         */
+        RouteOptimum optimize(unsigned threads = 0) const;
+        /**
+         * @brief Run the route with 1 set of settings
+         *
+         * @param settings the settings of each leg
+         * @return RouteRun how the route went
+         */
+        RouteRun runRoute(const std::vector<LegSettings>& settings) const;
+        /**
+         * @brief Write the settings and paths of a route for the robot
+         *
+         * The settings go in directory/route.cfg, as "<leg>.motion" (0 for POSE, 1 for PATH), "<leg>.lead",
+         * "<leg>.lookahead", "<leg>.speed", "<leg>.minSpeed", "<leg>.earlyExitRange", and the target the motion drives
+         * to as "<leg>.x", "<leg>.y", and "<leg>.theta". The path of each PATH leg goes in directory/<leg>.lpb
+         *
+         * @param optimum the settings, usually from optimize
+         * @param directory the directory the files are written to. It must exist
+         * @return true every file was written
+         * @return false a file couldn't be written
+         */
+        bool write(const RouteOptimum& optimum, const std::string& directory) const;
+
+        /** where the robot starts, theta in degrees. The origin by default */
+        lemlib::Pose start = lemlib::Pose(0, 0, 0);
+        /** the legs of the route, in order */
+        std::vector<RouteLeg> legs;
+        /** the leads moveToPose is tried with */
+        std::vector<float> leads = {0.3, 0.45, 0.6};
+        /** the lookaheads follow is tried with, in inches. Empty to only try moveToPose */
+        std::vector<float> lookaheads = {8, 12};
+        /** the speeds each leg is tried with */
+        std::vector<float> speeds = {100, 127};
+        /** the speeds legs are tried chaining into the next one at. 0 settles on the target */
+        std::vector<float> chainSpeeds = {0, 50, 90};
+        /** the exit ranges chained legs are tried with, in inches */
+        std::vector<float> exitRanges = {3, 6};
+        /** how far targets are moved in x and y at a time, in inches. 0 to keep the targets. 2 by default */
+        float nudge = 2;
+        /** how close the robot has to pass to the target of every leg but the last, in inches. 4 by default */
+        float passTolerance = 4;
+        /** how close the robot has to end to the target of the last leg, in inches. 1.5 by default */
+        float finalTolerance = 1.5;
+        /** how close the heading has to end to the target of the last leg, in degrees. 3 by default */
+        float finalAngle = 3;
+        /** most passes over the legs. 4 by default */
+        unsigned passes = 4;
+    private:
+        /**
+         * @brief Generate the path of a PATH leg, from the end of the leg before it
+         */
+        lemlib::Path legPath(lemlib::PathArena& arena, const std::vector<LegSettings>& settings,
+                             std::size_t leg) const;
+        /**
+         * @brief Run several sets of settings, spread across threads
+         */
+        std::vector<RouteRun> runAll(const std::vector<std::vector<LegSettings>>& cases, unsigned threads) const;
+
+        RobotModel robot;
+        lemlib::Drivetrain drivetrain;
+        lemlib::ControllerSettings lateral;
+        lemlib::ControllerSettings angular;
+        lemlib::OdomSensors sensors;
+};
+} // namespace sim
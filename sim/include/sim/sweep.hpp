@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "sim/world.hpp"
+
+namespace sim {
+/**
+ * @brief The settings of 1 run of a sweep
+ */
+struct SweepCase {
+        lemlib::ControllerSettings lateral;
+        lemlib::ControllerSettings angular;
+        lemlib::MoveToPoseParams params;
+};
+
+/**
+ * @brief How well the motion went in 1 run of a sweep
+ *
+ * Everything is measured from the simulated robot, not from odometry, so odometry error shows up too
+ */
+struct SweepResult {
+        /** the settings of the run */
+        SweepCase settings;
+        /** why the simulation stopped. Anything but FINISHED means the motion never returned */
+        StopReason reason;
+        /** how long the motion ran before it exited, in milliseconds */
+        std::uint32_t motionTime;
+        /**
+         * how long after the motion started the robot was within the settle tolerance for good, in milliseconds.
+         * INFINITY if it wasn't within the tolerance at the end of the run
+         */
+        float settleTime;
+        /** farthest the robot went past the target, along the direction it was traveling at the end, in inches */
+        float overshoot;
+        /** farthest the robot was from the boomerang curve from the start to the target, in inches */
+        float pathError;
+        /** distance from the robot to the target at the end of the run, in inches */
+        float finalError;
+        /** difference between the heading of the robot and the target at the end of the run, in degrees */
+        float finalHeadingError;
+};
+
+/**
+ * @brief Runs the same moveToPose on the simulated robot with every combination of settings
+ *
+ * Each run gets a world of its own, and the runs are spread across threads, so a sweep of hundreds of settings
+ * takes seconds. The runs are deterministic, so the results don't depend on the number of threads.
+ *
+ * Each run constructs a chassis from the drivetrain, sensors, and settings of the run, calibrates it, sets its pose
+ * to start, and runs the motion, then keeps simulating for holdTime so overshoot after the motion exits is caught.
+ *
+ * @note the devices in the drivetrain and sensors are shared by every run, so they must not be used by anything
+ * else during the sweep
+ *
+ * @b Example
+ * @code {.cpp}
+ * sim::MotionSweep sweep(robot, drivetrain, sensors);
+ * sweep.target = lemlib::Pose(24, 24, 90);
+ * std::vector<lemlib::ControllerSettings> lateral;
+ * for (float kD = 0; kD <= 20; kD += 2) lateral.emplace_back(10, 0, kD, 3, 1, 100, 3, 500, 20);
+ * for (const sim::SweepResult& result : sweep.run(lateral, {angular}, {{.lead = 0.3}, {.lead = 0.6}})) {
+ *     std::cout << result.settings.lateral.kD << ": " << result.settleTime << " ms" << std::endl;
+ * }
+ * @endcode
+ */
+class MotionSweep {
+    public:
+        /**
+         * @brief Construct a new Motion Sweep
+         *
+         * @param robot the physical properties of the simulated robot
+         * @param drivetrain the drivetrain of the chassis
+         * @param sensors the odometry sensors of the chassis
+         */
+        MotionSweep(RobotModel robot, lemlib::Drivetrain drivetrain, lemlib::OdomSensors sensors);
+        /**
+         * @brief Run the motion with every combination of settings
+         *
+         * @param lateral the lateral controller settings to try
+         * @param angular the angular controller settings to try
+         * @param params the motion parameters to try
+         * @param threads the number of threads to run on. 0 to use every core. 0 by default
+         * @return std::vector<SweepResult> a result for each combination, with the last list varying fastest
+         */
+        std::vector<SweepResult> run(const std::vector<lemlib::ControllerSettings>& lateral,
+                                     const std::vector<lemlib::ControllerSettings>& angular,
+                                     const std::vector<lemlib::MoveToPoseParams>& params, unsigned threads = 0) const;
+        /**
+         * @brief Run the motion with 1 set of settings
+         *
+         * @param settings the settings
+         * @return SweepResult how well the motion went
+         */
+        SweepResult runCase(const SweepCase& settings) const;
+
+        /** where the robot starts, theta in degrees. The origin by default */
+        lemlib::Pose start = lemlib::Pose(0, 0, 0);
+        /** the target of the motion, theta in degrees */
+        lemlib::Pose target = lemlib::Pose(0, 0, 0);
+        /** the timeout of the motion, in milliseconds. 4000 by default */
+        int timeout = 4000;
+        /** how close the robot has to be to the target to be settled, in inches. 1 by default */
+        float settleDistance = 1;
+        /** how close the heading has to be to the target to be settled, in degrees. 2 by default */
+        float settleAngle = 2;
+        /** how long to keep simulating after the motion exits, in milliseconds. 500 by default */
+        std::uint32_t holdTime = 500;
+    private:
+        RobotModel robot;
+        lemlib::Drivetrain drivetrain;
+        lemlib::OdomSensors sensors;
+};
+} // namespace sim
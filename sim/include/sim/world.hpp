@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "sim/plant.hpp"
+
+namespace sim {
+/**
+ * @brief Why a simulation stopped
+ */
+enum class StopReason {
+    /** the routine returned */
+    FINISHED,
+    /** the routine didn't return before the timeout */
+    TIMEOUT,
+    /** every task was waiting for something that can never happen */
+    DEADLOCK
+};
+
+/**
+ * @brief The result of a simulation
+ */
+struct RunResult {
+        /** why the simulation stopped */
+        StopReason reason;
+        /** how long the simulation ran, in milliseconds of simulated time */
+        std::uint32_t time;
+};
+
+/**
+ * @brief A simulated robot, and the tasks that control it
+ *
+ * The tasks run on threads, but only 1 runs at a time, like on the single core of the brain. A task runs until it
+ * waits for something, like a delay, a notification, or a mutex, and then the highest priority task that is ready
+ * runs next. When every task is waiting, the clock jumps straight to the next time a task wakes up, and the robot is
+ * simulated up to that time. Running code takes no simulated time, so the simulation runs as fast as the computer
+ * can run the tasks, and the same routine always produces the same result
+ *
+ * The simulated PROS devices read and control the robot of the world their task belongs to, so worlds on different
+ * threads simulate different robots at the same time. Devices can be constructed anywhere, since their settings don't
+ * depend on the world. Threads that weren't started by a world belong to a world of their own, without a drivetrain
+ *
+ * @b Example
+ * @code {.cpp}
+ * pros::Motor left1(-1, pros::E_MOTOR_GEARSET_06), left2(-2, pros::E_MOTOR_GEARSET_06);
+ * pros::Motor right1(3, pros::E_MOTOR_GEARSET_06), right2(4, pros::E_MOTOR_GEARSET_06);
+ * pros::MotorGroup leftMotors({left1, left2});
+ * pros::MotorGroup rightMotors({right1, right2});
+ * lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+ *
+ * sim::RobotModel robot;
+ * robot.leftPorts = {1, 2};
+ * robot.rightPorts = {3, 4};
+ * sim::World world(robot);
+ * sim::RunResult result = world.run([&] {
+ *     lemlib::Chassis chassis(drivetrain, lateralController, angularController, sensors);
+ *     chassis.calibrate();
+ *     chassis.moveToPose(24, 24, 90, 4000);
+ *     chassis.waitUntilDone();
+ * }, 10000);
+ * std::cout << "finished in " << result.time << " ms" << std::endl;
+ * @endcode
+ */
+class World {
+    public:
+        /**
+         * @brief Construct a new World
+         *
+         * @param robot the physical properties of the robot
+         */
+        World(RobotModel robot = RobotModel());
+        World(const World&) = delete;
+        World& operator=(const World&) = delete;
+        /**
+         * @brief Destroy the World, stopping every task in it
+         */
+        ~World();
+        /**
+         * @brief Run a routine in the world, as a task at the default priority
+         *
+         * The calling thread blocks until the routine returns or the timeout passes, then every task in the world
+         * is stopped. Each world can only run once
+         *
+         * @param routine the routine. It usually constructs and calibrates a chassis, then runs motions
+         * @param timeout the longest the routine can run, in milliseconds of simulated time
+         * @return RunResult why the simulation stopped, and how long it ran
+         */
+        RunResult run(std::function<void()> routine, std::uint32_t timeout);
+        /**
+         * @brief Call a function every time the robot is simulated
+         *
+         * The function is called on the task that is advancing the clock, after every millisecond of simulated
+         * time. It must not use the PROS API
+         *
+         * @param observer the function, or nullptr to stop calling it
+         */
+        void setObserver(std::function<void(const PlantState&)> observer);
+        /**
+         * @brief Get the simulated robot
+         *
+         * @return DrivePlant& the simulated robot
+         */
+        DrivePlant& getPlant();
+        /**
+         * @brief Get the simulated time
+         *
+         * @return std::uint64_t the time since the world was created, in microseconds
+         */
+        std::uint64_t getTime() const;
+        /**
+         * @brief Get the world of the calling thread
+         *
+         * @return World& the world the calling task belongs to. Threads that weren't started by a world get a world
+         * of their own
+         */
+        static World& current();
+
+        /** the scheduler, defined in kernel.hpp. Only used by the simulated PROS API */
+        struct Kernel;
+        /**
+         * @brief Get the scheduler
+         *
+         * @return Kernel& the scheduler
+         */
+        Kernel& getKernel();
+    private:
+        std::unique_ptr<Kernel> kernel;
+};
+} // namespace sim
@@ -0,0 +1,52 @@
+// Runs a motion on the simulated robot, and prints where the robot went
+#include <cstdio>
+#include "lemlib/api.hpp"
+#include "sim/world.hpp"
+
+// the drivetrain, with 3 motors on each side
+pros::Motor leftFront(-1, pros::E_MOTOR_GEARSET_06), leftMiddle(-2, pros::E_MOTOR_GEARSET_06),
+    leftBack(-3, pros::E_MOTOR_GEARSET_06);
+pros::Motor rightFront(4, pros::E_MOTOR_GEARSET_06), rightMiddle(5, pros::E_MOTOR_GEARSET_06),
+    rightBack(6, pros::E_MOTOR_GEARSET_06);
+pros::MotorGroup leftMotors({leftFront, leftMiddle, leftBack});
+pros::MotorGroup rightMotors({rightFront, rightMiddle, rightBack});
+pros::Imu imu(10);
+pros::Rotation verticalEncoder(11);
+pros::Rotation horizontalEncoder(12);
+
+int main() {
+    sim::RobotModel robot;
+    robot.leftPorts = {1, 2, 3};
+    robot.rightPorts = {4, 5, 6};
+    robot.imuPort = 10;
+    robot.trackingWheels = {{sim::TrackingWheelModel::Encoder::ROTATION, 11, 2.75, -0.5, true},
+                            {sim::TrackingWheelModel::Encoder::ROTATION, 12, 2.75, -3, false}};
+    sim::World world(robot);
+
+    // print where the robot is every 100 ms
+    world.setObserver([](const sim::PlantState& state) {
+        if (state.time % 100000 != 0) return;
+        std::printf("%6.1f s  x %7.2f  y %7.2f  theta %7.2f%s\n", state.time / 1e6, state.pose.x, state.pose.y,
+                    state.pose.theta, state.leftSlipping || state.rightSlipping ? "  slipping" : "");
+    });
+
+    const sim::RunResult result = world.run(
+        [] {
+            lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+            lemlib::TrackingWheel vertical(&verticalEncoder, lemlib::Omniwheel::NEW_275, -0.5);
+            lemlib::TrackingWheel horizontal(&horizontalEncoder, lemlib::Omniwheel::NEW_275, -3);
+            lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+            lemlib::ControllerSettings lateral(10, 0, 3, 3, 1, 100, 3, 500, 20);
+            lemlib::ControllerSettings angular(2, 0, 10, 3, 1, 100, 3, 500, 0);
+            lemlib::Chassis chassis(drivetrain, lateral, angular, sensors);
+            chassis.calibrate();
+            chassis.moveToPose(24, 24, 90, 4000);
+            chassis.waitUntilDone();
+            const lemlib::Pose pose = chassis.getPose();
+            std::printf("odometry: x %7.2f  y %7.2f  theta %7.2f\n", pose.x, pose.y, pose.theta);
+        },
+        10000);
+    const char* reasons[] = {"finished", "timed out", "deadlocked"};
+    std::printf("%s after %u ms\n", reasons[int(result.reason)], result.time);
+    return result.reason == sim::StopReason::FINISHED ? 0 : 1;
+}
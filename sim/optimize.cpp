@@ -0,0 +1,67 @@
+// Searches for the fastest way to drive an autonomous route on the simulated robot, prints the settings of each leg,
+// and writes them and the paths of the route to the directory given as the first argument, for the robot
+#include <cstdio>
+#include <filesystem>
+#include "lemlib/api.hpp"
+#include "sim/route.hpp"
+#include "sim/routeOptimizer.hpp"
+
+// the same robot as main.cpp
+pros::Motor leftFront(-1, pros::E_MOTOR_GEARSET_06), leftMiddle(-2, pros::E_MOTOR_GEARSET_06),
+    leftBack(-3, pros::E_MOTOR_GEARSET_06);
+pros::Motor rightFront(4, pros::E_MOTOR_GEARSET_06), rightMiddle(5, pros::E_MOTOR_GEARSET_06),
+    rightBack(6, pros::E_MOTOR_GEARSET_06);
+pros::MotorGroup leftMotors({leftFront, leftMiddle, leftBack});
+pros::MotorGroup rightMotors({rightFront, rightMiddle, rightBack});
+pros::Imu imu(10);
+pros::Rotation verticalEncoder(11);
+pros::Rotation horizontalEncoder(12);
+lemlib::TrackingWheel vertical(&verticalEncoder, lemlib::Omniwheel::NEW_275, -0.5);
+lemlib::TrackingWheel horizontal(&horizontalEncoder, lemlib::Omniwheel::NEW_275, -3);
+
+int main(int argc, char** argv) {
+    sim::RobotModel robot;
+    robot.leftPorts = {1, 2, 3};
+    robot.rightPorts = {4, 5, 6};
+    robot.imuPort = 10;
+    robot.trackingWheels = {{sim::TrackingWheelModel::Encoder::ROTATION, 11, 2.75, -0.5, true},
+                            {sim::TrackingWheelModel::Encoder::ROTATION, 12, 2.75, -3, false}};
+    lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+    lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+    const lemlib::ControllerSettings lateral(10, 0, 3, 3, 1, 100, 3, 500, 20);
+    const lemlib::ControllerSettings angular(2, 0, 10, 3, 1, 100, 3, 500, 0);
+
+    // the route of estimate.cpp, without the turn in place
+    sim::RouteOptimizer optimizer(robot, drivetrain, lateral, angular, sensors);
+    optimizer.legs.push_back({"goal", {24, 24, 90}, 3000});
+    optimizer.legs.push_back({"wall", {24, -12, 180}, 3000});
+    optimizer.legs.push_back({"home", {0, 0, 0}, 4000, false});
+
+    const sim::RouteRun initial = optimizer.runRoute(std::vector<sim::LegSettings>(optimizer.legs.size()));
+    const sim::RouteOptimum optimum = optimizer.optimize();
+    std::printf("%-6s %6s %6s %9s %6s %9s %6s %7s %7s %8s %8s  %s\n", "leg", "motion", "lead", "lookahead", "speed",
+                "min speed", "exit", "x", "y", "ms", "pass err", "end");
+    for (std::size_t i = 0; i < optimum.legs.size(); i++) {
+        const sim::RouteLeg& leg = optimizer.legs[i];
+        const sim::LegSettings& settings = optimum.legs[i];
+        const sim::LegRun& run = optimum.run.legs.at(i);
+        std::printf("%-6s %6s %6.2f %9.1f %6.0f %9.0f %6.1f %7.1f %7.1f %8u %8.2f  %s\n", leg.name.c_str(),
+                    settings.motion == sim::LegMotion::PATH ? "path" : "pose", settings.lead, settings.lookahead,
+                    settings.speed, settings.minSpeed, settings.earlyExitRange, leg.target.x + settings.offsetX,
+                    leg.target.y + settings.offsetY, run.duration, run.passError, sim::reasonName(run.reason));
+    }
+    std::printf("%u ms with the default settings%s, %u ms optimized%s, after %u runs\n", initial.total,
+                initial.feasible ? "" : " (infeasible)", optimum.run.total, optimum.run.feasible ? "" : " (infeasible)",
+                optimum.evaluations);
+    std::printf("ends %.2f in and %.2f deg from the last target\n", optimum.run.finalError,
+                optimum.run.finalHeadingError);
+
+    if (argc < 2) return optimum.run.feasible ? 0 : 1;
+    std::filesystem::create_directories(argv[1]);
+    if (!optimizer.write(optimum, argv[1])) {
+        std::printf("couldn't write the route to %s\n", argv[1]);
+        return 1;
+    }
+    std::printf("wrote the route to %s\n", argv[1]);
+    return optimum.run.feasible ? 0 : 1;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <time.h>
+#include "lemlib/util.hpp"
+#include "sim/followBench.hpp"
+
+// time spent calibrating and setting up the chassis on top of the motion, in milliseconds
+constexpr std::uint32_t SETUP_TIME = 1000;
+
+/**
+ * @brief Get the distance from a point to a line segment
+ */
+static float segmentDistance(lemlib::Pose point, lemlib::Pose a, lemlib::Pose b) {
+    const lemlib::Pose ab = b - a;
+    const float lengthSquared = ab.x * ab.x + ab.y * ab.y;
+    float t = lengthSquared == 0 ? 0 : ((point.x - a.x) * ab.x + (point.y - a.y) * ab.y) / lengthSquared;
+    t = std::clamp(t, 0.0f, 1.0f);
+    return point.distance(a + ab * t);
+}
+
+/**
+ * @brief Read the CPU time of the calling thread, in nanoseconds. Used as a motion callback
+ */
+static void readCpuTime(void* time) {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    *static_cast<std::uint64_t*>(time) = std::uint64_t(now.tv_sec) * 1000000000 + now.tv_nsec;
+}
+
+sim::FollowBenchmark::FollowBenchmark(RobotModel robot, lemlib::Drivetrain drivetrain,
+                                      lemlib::ControllerSettings lateral, lemlib::ControllerSettings angular,
+                                      lemlib::OdomSensors sensors)
+    : robot(robot),
+      drivetrain(drivetrain),
+      lateral(lateral),
+      angular(angular),
+      sensors(sensors) {}
+
+std::vector<sim::FollowResult> sim::FollowBenchmark::run(const std::vector<float>& lookaheads,
+                                                         const std::vector<float>& speeds, unsigned threads) const {
+    std::vector<FollowCase> cases;
+    for (std::size_t path = 0; path < this->paths.size(); path++) {
+        for (float lookahead : lookaheads) {
+            for (float speed : speeds) cases.push_back({path, lookahead, speed});
+        }
+    }
+    // every result is overwritten by its run, but FollowResult can't be default constructed
+    std::vector<FollowResult> results;
+    for (const FollowCase& settings : cases) results.push_back({settings});
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, cases.size());
+
+    // each thread takes the next case until there are none left
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) {
+        pool.emplace_back([&] {
+            for (size_t index = next++; index < cases.size(); index = next++) results[index] = runCase(cases[index]);
+        });
+    }
+    for (std::thread& thread : pool) thread.join();
+    return results;
+}
+
+sim::FollowResult sim::FollowBenchmark::runCase(const FollowCase& settings) const {
+    FollowResult result {settings, StopReason::FINISHED, lemlib::MotionEndReason::NOT_DONE, 0, 0, 0, 0, 0, 0};
+    const BenchPath& benchPath = this->paths.at(settings.path);
+
+    // generously sized, since the number of points depends on the length of the path
+    lemlib::PathArena arena(8192);
+    const lemlib::Path path = lemlib::generatePath(arena, benchPath.waypoints, {.maxVelocity = settings.speed});
+    std::vector<lemlib::Pose> points;
+    for (size_t i = 0; i < path.size(); i++) points.push_back(path.at(i));
+    if (points.empty()) return result;
+    const lemlib::Pose end(points.back().x, points.back().y);
+    const lemlib::Waypoint& first = benchPath.waypoints.front();
+    const lemlib::Pose start(first.x, first.y, first.theta);
+
+    World world(this->robot);
+    world.getPlant().setPose(start);
+    // the observer and the routine run on the same world, one at a time, so they can share these
+    bool moving = false;
+    double errorSum = 0;
+    std::uint32_t samples = 0;
+    world.setObserver([&](const PlantState& state) {
+        if (!moving) return;
+        const lemlib::Pose position(state.pose.x, state.pose.y);
+        float distance = INFINITY;
+        for (size_t i = 0; i + 1 < points.size(); i++)
+            distance = std::min(distance, segmentDistance(position, points[i], points[i + 1]));
+        errorSum += distance;
+        samples++;
+        result.maxError = std::max(result.maxError, distance);
+        result.finalError = position.distance(end);
+    });
+
+    std::uint64_t startCpu = 0;
+    std::uint64_t endCpu = 0;
+    const std::uint32_t runTimeout = this->robot.imuCalibrationTime + benchPath.timeout + SETUP_TIME;
+    const RunResult run = world.run(
+        [&] {
+            lemlib::Chassis chassis(this->drivetrain, this->lateral, this->angular, this->sensors);
+            chassis.calibrate();
+            chassis.setPose(start);
+            const std::uint32_t motionStart = pros::micros();
+            moving = true;
+            const lemlib::MotionHandle motion = chassis.follow(path, settings.lookahead, benchPath.timeout);
+            // the callbacks run on the motion task, so the difference is the CPU time it spent following the path
+            motion.onTime(0, readCpuTime, &startCpu);
+            motion.onDone(readCpuTime, &endCpu);
+            chassis.waitUntilDone();
+            moving = false;
+            result.motionTime = (pros::micros() - motionStart) / 1000;
+            result.endReason = motion.endReason();
+            result.ticks = chassis.getLoopProfiler(lemlib::MotionType::FOLLOW).getStats().iterations;
+        },
+        runTimeout);
+    result.reason = run.reason;
+    if (samples != 0) result.meanError = errorSum / samples;
+    if (result.ticks != 0 && endCpu > startCpu) result.tickTime = double(endCpu - startCpu) / result.ticks;
+    return result;
+}
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "pros/rtos.h"
+#include "sim/world.hpp"
+
+namespace sim {
+// a time that never comes, for tasks that wait forever
+constexpr std::uint64_t FOREVER = UINT64_MAX;
+
+/**
+ * @brief Thrown in a task when its world stops, so its thread unwinds and exits
+ */
+struct Stopped {};
+
+/**
+ * @brief A task, which is a thread that only runs when the scheduler of its world lets it
+ */
+struct HostTask {
+        enum class State {
+            /** the task can run */
+            READY,
+            /** the task is waiting until wakeTime, or until it is woken */
+            BLOCKED,
+            /** the task returned, or was removed */
+            DONE
+        };
+
+        World::Kernel* kernel;
+        std::string name;
+        std::uint32_t priority;
+        State state = State::READY;
+        /** when a blocked task wakes up, in microseconds */
+        std::uint64_t wakeTime = FOREVER;
+        /** tasks with the same priority run in the order they became ready */
+        std::uint64_t readyOrder = 0;
+        std::uint32_t notifications = 0;
+        /** whether the task is blocked in notify_take, so a notification wakes it */
+        bool waitingForNotification = false;
+        /** signalled when the task is given its turn to run, or its world stops */
+        std::condition_variable turn;
+        /** the thread of the task. Threads that weren't started by a world don't have one */
+        std::thread thread;
+};
+
+/**
+ * @brief A mutex, which blocks the waiting task in simulated time
+ */
+struct HostMutex {
+        /** protects the rest of the mutex, since tasks from different worlds can use the same mutex */
+        std::mutex guard;
+        /** signalled when the mutex is given, for tasks waiting in other worlds */
+        std::condition_variable released;
+        HostTask* owner = nullptr;
+        /** tasks from the world of the owner that are waiting for the mutex */
+        std::vector<HostTask*> waiters;
+};
+
+/**
+ * @brief The scheduler of a world, and the clock it runs on
+ *
+ * Every member is protected by mutex, except now, which only the running task uses
+ */
+struct World::Kernel {
+        /**
+         * @brief Construct a new Kernel
+         *
+         * @param world the world the kernel belongs to
+         * @param robot the physical properties of the robot of the world
+         */
+        Kernel(World* world, RobotModel robot);
+        /**
+         * @brief Create a task. It runs once the scheduler gives it a turn
+         *
+         * @param function the function the task runs
+         * @param parameters passed to the function
+         * @param priority the priority of the task
+         * @param name the name of the task
+         * @return HostTask* the task
+         */
+        HostTask* spawn(pros::task_fn_t function, void* parameters, std::uint32_t priority, const char* name);
+        /**
+         * @brief Make the calling thread a task of this world, which is running
+         *
+         * @return HostTask* the task
+         */
+        HostTask* adopt();
+        /**
+         * @brief Block the running task until a time, or until it is woken
+         *
+         * @note mutex must be held by the caller
+         *
+         * @param lock the lock on mutex
+         * @param self the running task
+         * @param time when the task wakes up, in microseconds. FOREVER to wait until it is woken
+         */
+        void sleepUntil(std::unique_lock<std::mutex>& lock, HostTask* self, std::uint64_t time);
+        /**
+         * @brief Let a blocked task run again
+         *
+         * @note mutex must be held by the caller
+         *
+         * @param task the task. Nothing happens if it isn't blocked
+         */
+        void wake(HostTask* task);
+        /**
+         * @brief Give the turn to the next task, and wait until the running task gets it back
+         *
+         * @note mutex must be held by the caller
+         *
+         * @throw Stopped the world stopped while the task was waiting
+         *
+         * @param lock the lock on mutex
+         * @param self the running task. Its state is already set to why it stopped running
+         */
+        void schedule(std::unique_lock<std::mutex>& lock, HostTask* self);
+        /**
+         * @brief Choose the task that runs next, advancing the clock if no task is ready
+         *
+         * @note mutex must be held by the caller
+         *
+         * @return HostTask* the task, or nullptr if the world stopped because no task can run
+         */
+        HostTask* pickNext();
+        /**
+         * @brief Advance the clock, simulating the robot up to the new time
+         *
+         * @param time the new time, in microseconds
+         */
+        void advance(std::uint64_t time);
+        /**
+         * @brief Stop the world, waking every task so its thread exits
+         *
+         * @note mutex must be held by the caller
+         *
+         * @param reason why the world stopped
+         */
+        void stop(StopReason reason);
+        /**
+         * @brief Throw Stopped, unless the calling task is already unwinding
+         *
+         * Destructors that run while a task unwinds can use the PROS API, which returns immediately once the world
+         * has stopped
+         */
+        static void exitTask();
+
+        World* world;
+        DrivePlant plant;
+        std::function<void(const PlantState&)> observer;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<HostTask>> tasks;
+        HostTask* running = nullptr;
+        /** the task running the routine passed to World::run */
+        HostTask* routine = nullptr;
+        /** the simulated time, in microseconds */
+        std::uint64_t now = 0;
+        /** the time the routine times out, in microseconds */
+        std::uint64_t deadline = FOREVER;
+        std::uint64_t readyCount = 0;
+        bool ran = false;
+        std::atomic<bool> stopping = false;
+        StopReason reason = StopReason::FINISHED;
+        /** signalled when the world stops */
+        std::condition_variable stopped;
+};
+
+/**
+ * @brief Get the task of the calling thread
+ *
+ * @return HostTask* the task. Threads that weren't started by a world are adopted by a world of their own
+ */
+HostTask* currentTask();
+} // namespace sim
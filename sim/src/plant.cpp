@@ -0,0 +1,236 @@
+#include <cmath>
+#include "sim/plant.hpp"
+
+// meters per inch
+constexpr double INCH = 0.0254;
+// acceleration due to gravity, in meters per second squared
+constexpr double GRAVITY = 9.81;
+// stall torque of a V5 motor with the 100 rpm cartridge, in newton meters. It is inversely proportional to the
+// free speed of the cartridge
+constexpr double STALL_TORQUE_100 = 2.1;
+// the plant is advanced in substeps no longer than this, in microseconds, to keep the integration stable
+constexpr std::uint32_t SUBSTEP = 250;
+// speed below which drivetrain friction fades out, in meters per second. Friction is smoothed so it can't make the
+// robot oscillate around 0
+constexpr double FRICTION_SPEED = 0.01;
+// position error of a motor in hold mode that produces the stall torque, in degrees
+constexpr double HOLD_ERROR = 10;
+
+static double sign(double x) { return (x > 0) - (x < 0); }
+
+static double clamp(double x, double limit) { return std::fmax(-limit, std::fmin(limit, x)); }
+
+/**
+ * @brief Convert an ADI port to a number from 1 to 8, so 'A', 'a', and 1 are the same port
+ */
+static std::uint8_t adiIndex(std::uint8_t port) {
+    if (port >= 'a' && port <= 'h') return port - 'a' + 1;
+    if (port >= 'A' && port <= 'H') return port - 'A' + 1;
+    return port;
+}
+
+sim::DrivePlant::DrivePlant(RobotModel robot)
+    : robot(robot),
+      xDrive(!robot.xDrivePorts[0].empty() || !robot.xDrivePorts[1].empty() || !robot.xDrivePorts[2].empty() ||
+             !robot.xDrivePorts[3].empty()),
+      encoderAngles(robot.trackingWheels.size(), 0),
+      encoderRates(robot.trackingWheels.size(), 0) {}
+
+double sim::DrivePlant::driveForce(const std::vector<std::uint8_t>& ports, double speed, double dt) {
+    const double stallTorque = STALL_TORQUE_100 * 100 / this->robot.motorRpm;
+    const double gearRatio = this->robot.motorRpm / this->robot.rpm;
+    const double wheelRadius = this->robot.wheelDiameter * INCH / 2;
+    // every motor on a side turns with the wheels
+    const double rpm = speed / (2 * M_PI * wheelRadius) * 60 * gearRatio;
+    double torque = 0;
+    for (const std::uint8_t port : ports) {
+        MotorState& motor = this->motor(port);
+        motor.velocity = rpm;
+        motor.position += rpm / 60 * 360 * dt;
+        // torque of a DC motor, as a fraction of the stall torque
+        double fraction;
+        const double back = rpm / this->robot.motorRpm;
+        if (motor.holding) fraction = (motor.holdPosition - motor.position) / HOLD_ERROR - back;
+        else if (!motor.braking) fraction = std::fmax(-12, std::fmin(12, motor.voltage / 1000.0)) / 12 - back;
+        else if (motor.brakeMode == pros::E_MOTOR_BRAKE_COAST) fraction = 0;
+        else fraction = -back;
+        // the current limit caps the torque at the stall torque
+        motor.torque = stallTorque * clamp(fraction, 1);
+        torque += motor.torque;
+    }
+    const double force = torque * gearRatio / wheelRadius;
+    const double stallForce = ports.size() * stallTorque * gearRatio / wheelRadius;
+    return force - this->robot.friction * stallForce * std::tanh(speed / FRICTION_SPEED);
+}
+
+void sim::DrivePlant::updateSide(Side& side, const std::vector<std::uint8_t>& ports, double groundSpeed, double share,
+                                 double dt) {
+    const double limit = this->robot.traction * this->robot.mass * GRAVITY * share;
+    // wheelMass is the rotating mass of a side, which is half the wheels
+    const double wheelMass = this->robot.wheelMass * share * 2;
+    const double force = this->driveForce(ports, side.speed, dt);
+    if (!side.slipping) {
+        if (std::fabs(force) <= limit) {
+            side.force = force;
+            return;
+        }
+        side.slipping = true;
+    }
+    // sliding friction opposes the wheels sliding over the floor, and the rest of the force spins the wheels
+    const double sliding = side.speed - groundSpeed;
+    const double direction = sliding != 0 ? sign(sliding) : sign(force);
+    side.force = limit * direction;
+    side.speed += (force - side.force) / wheelMass * dt;
+    // the wheels grip again once they match the speed of the floor, if friction can hold them there
+    if (sign(side.speed - groundSpeed) != direction && std::fabs(force) <= limit) side.slipping = false;
+}
+
+void sim::DrivePlant::substepXDrive(double dt) {
+    const double halfTrack = this->robot.trackWidth * INCH / 2;
+    const double halfBase = this->robot.wheelBase * INCH / 2;
+    // where each wheel is, to the right and forwards of the center, and the direction it rolls in when driven
+    // forwards. The wheels point at the corners of the robot
+    const double positions[4][2] = {{-halfTrack, halfBase}, {halfTrack, halfBase}, {-halfTrack, -halfBase},
+                                    {halfTrack, -halfBase}};
+    const double directions[4][2] = {{M_SQRT1_2, M_SQRT1_2}, {-M_SQRT1_2, M_SQRT1_2}, {-M_SQRT1_2, M_SQRT1_2},
+                                     {M_SQRT1_2, M_SQRT1_2}};
+    // the speed of the floor under a wheel, in the direction it rolls. Turning clockwise moves a point on the robot
+    // along (y, -x)
+    const auto groundSpeed = [&](int i) {
+        const double vx = this->lateralSpeed + this->angularSpeed * positions[i][1];
+        const double vy = this->forwardSpeed - this->angularSpeed * positions[i][0];
+        return vx * directions[i][0] + vy * directions[i][1];
+    };
+    double forceX = 0;
+    double forceY = 0;
+    double torque = 0;
+    for (int i = 0; i < 4; i++) {
+        // each wheel carries a quarter of the weight of the robot
+        this->updateSide(this->wheels[i], this->robot.xDrivePorts[i], groundSpeed(i), 0.25, dt);
+        const double force = this->wheels[i].force;
+        forceX += force * directions[i][0];
+        forceY += force * directions[i][1];
+        torque += force * (directions[i][0] * positions[i][1] - directions[i][1] * positions[i][0]);
+    }
+    // the velocities are relative to the robot, which is rotating. The rollers let each wheel slide sideways, so
+    // only the force of the wheels pushes the robot
+    const double acceleration = forceY / this->robot.mass + this->angularSpeed * this->lateralSpeed;
+    const double lateralAcceleration = forceX / this->robot.mass - this->angularSpeed * this->forwardSpeed;
+    this->forwardSpeed += acceleration * dt;
+    this->lateralSpeed += lateralAcceleration * dt;
+    this->angularSpeed += torque / this->robot.inertia * dt;
+    // wheels that grip the floor move with it
+    for (int i = 0; i < 4; i++) {
+        if (!this->wheels[i].slipping) this->wheels[i].speed = groundSpeed(i);
+    }
+    this->left.slipping = this->wheels[0].slipping || this->wheels[2].slipping;
+    this->right.slipping = this->wheels[1].slipping || this->wheels[3].slipping;
+}
+
+void sim::DrivePlant::substepDifferential(double dt) {
+    const double halfTrack = this->robot.trackWidth * INCH / 2;
+    // turning clockwise moves the left side forwards, and each side carries half the weight of the robot
+    this->updateSide(this->left, this->robot.leftPorts, this->forwardSpeed + this->angularSpeed * halfTrack, 0.5, dt);
+    this->updateSide(this->right, this->robot.rightPorts, this->forwardSpeed - this->angularSpeed * halfTrack, 0.5,
+                     dt);
+
+    // the velocities are relative to the robot, which is rotating
+    const double acceleration = (this->left.force + this->right.force) / this->robot.mass +
+                                this->angularSpeed * this->lateralSpeed;
+    const double angularAcceleration = (this->left.force - this->right.force) * halfTrack / this->robot.inertia;
+    // the wheels stop the robot sliding sideways, up to the limit of friction
+    const double freeLateral = -this->angularSpeed * this->forwardSpeed;
+    const double needed = -this->lateralSpeed / dt - freeLateral;
+    const double grip = this->robot.lateralTraction * GRAVITY;
+    const double lateralAcceleration = freeLateral + clamp(needed, grip);
+    this->forwardSpeed += acceleration * dt;
+    this->lateralSpeed += lateralAcceleration * dt;
+    this->angularSpeed += angularAcceleration * dt;
+    if (std::fabs(needed) <= grip) this->lateralSpeed = 0; // prevent rounding errors from building up
+    // wheels that grip the floor move with it
+    if (!this->left.slipping) this->left.speed = this->forwardSpeed + this->angularSpeed * halfTrack;
+    if (!this->right.slipping) this->right.speed = this->forwardSpeed - this->angularSpeed * halfTrack;
+}
+
+void sim::DrivePlant::substep(double dt) {
+    if (this->xDrive) this->substepXDrive(dt);
+    else this->substepDifferential(dt);
+
+    // theta is clockwise from the y axis
+    this->x += (this->forwardSpeed * std::sin(this->theta) + this->lateralSpeed * std::cos(this->theta)) * dt;
+    this->y += (this->forwardSpeed * std::cos(this->theta) - this->lateralSpeed * std::sin(this->theta)) * dt;
+    this->theta += this->angularSpeed * dt;
+
+    // the tracking wheels roll over the floor, so they measure the motion of the robot
+    for (size_t i = 0; i < this->robot.trackingWheels.size(); i++) {
+        const TrackingWheelModel& wheel = this->robot.trackingWheels[i];
+        const double offset = wheel.offset * INCH;
+        const double speed = wheel.vertical ? this->forwardSpeed - offset * this->angularSpeed
+                                            : -this->lateralSpeed - offset * this->angularSpeed;
+        this->encoderRates[i] = speed / INCH * wheel.gearRatio * 360 / (M_PI * wheel.diameter);
+        this->encoderAngles[i] += this->encoderRates[i] * dt;
+    }
+    if (!this->imuCalibrating()) this->imuAngle += (this->angularSpeed * 180 / M_PI + this->robot.imuDrift) * dt;
+}
+
+void sim::DrivePlant::step(std::uint32_t dt) {
+    while (dt > 0) {
+        const std::uint32_t length = dt < SUBSTEP ? dt : SUBSTEP;
+        this->substep(length / 1e6);
+        this->time += length;
+        dt -= length;
+    }
+}
+
+sim::PlantState sim::DrivePlant::getState() const {
+    return {lemlib::Pose(this->x / INCH, this->y / INCH, this->theta * 180 / M_PI),
+            lemlib::Pose(this->lateralSpeed / INCH, this->forwardSpeed / INCH, this->angularSpeed * 180 / M_PI),
+            this->left.slipping,
+            this->right.slipping,
+            this->time};
+}
+
+void sim::DrivePlant::setPose(lemlib::Pose pose) {
+    this->x = pose.x * INCH;
+    this->y = pose.y * INCH;
+    this->theta = pose.theta * M_PI / 180;
+}
+
+const sim::RobotModel& sim::DrivePlant::getModel() const { return this->robot; }
+
+sim::MotorState& sim::DrivePlant::motor(std::uint8_t port) {
+    // invalid ports share the unused state at index 0
+    return this->motors[port < this->motors.size() ? port : 0];
+}
+
+int sim::DrivePlant::findTrackingWheel(TrackingWheelModel::Encoder encoder, std::uint8_t port) const {
+    for (size_t i = 0; i < this->robot.trackingWheels.size(); i++) {
+        const TrackingWheelModel& wheel = this->robot.trackingWheels[i];
+        if (wheel.encoder != encoder) continue;
+        if (encoder == TrackingWheelModel::Encoder::ROTATION ? wheel.port == port
+                                                             : adiIndex(wheel.port) == adiIndex(port))
+            return i;
+    }
+    return -1;
+}
+
+double* sim::DrivePlant::encoderAngle(TrackingWheelModel::Encoder encoder, std::uint8_t port) {
+    const int index = this->findTrackingWheel(encoder, port);
+    return index == -1 ? nullptr : &this->encoderAngles[index];
+}
+
+double sim::DrivePlant::encoderRate(TrackingWheelModel::Encoder encoder, std::uint8_t port) const {
+    const int index = this->findTrackingWheel(encoder, port);
+    return index == -1 ? 0 : this->encoderRates[index];
+}
+
+double& sim::DrivePlant::imuRotation() { return this->imuAngle; }
+
+double sim::DrivePlant::imuRate() const { return this->angularSpeed * 180 / M_PI + this->robot.imuDrift; }
+
+void sim::DrivePlant::calibrateImu() {
+    this->imuAngle = 0;
+    this->imuReadyTime = this->time + std::uint64_t(this->robot.imuCalibrationTime) * 1000;
+}
+
+bool sim::DrivePlant::imuCalibrating() const { return this->time < this->imuReadyTime; }
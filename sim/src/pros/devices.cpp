@@ -0,0 +1,605 @@
+// The PROS device API, backed by the simulated robot of the calling task's world. Devices that aren't part of the
+// robot model accept commands, but read 0 or report an error like an unplugged device
+#include <array>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+#include <stdexcept>
+#include "pros/adi.hpp"
+#include "pros/error.h"
+#include "pros/imu.hpp"
+#include "pros/motors.hpp"
+#include "pros/rotation.hpp"
+#include "sim/world.hpp"
+
+using sim::TrackingWheelModel;
+
+/**
+ * @brief Settings that a motor keeps in its own memory
+ *
+ * They are usually set when the motor is constructed, so they are shared by every world
+ */
+struct MotorSettings {
+        pros::motor_gearset_e_t gearset = pros::E_MOTOR_GEARSET_18;
+        pros::motor_encoder_units_e_t units = pros::E_MOTOR_ENCODER_DEGREES;
+        bool reversed = false;
+};
+
+static std::mutex settingsMutex;
+// indexed by port, so index 0 isn't used
+static std::array<MotorSettings, 22> motorSettings;
+static std::array<bool, 22> rotationReversed;
+
+static MotorSettings getSettings(std::uint8_t port) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    return motorSettings[port < motorSettings.size() ? port : 0];
+}
+
+static void setSettings(std::uint8_t port, MotorSettings settings) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    motorSettings[port < motorSettings.size() ? port : 0] = settings;
+}
+
+static sim::MotorState& motorState(std::uint8_t port) { return sim::World::current().getPlant().motor(port); }
+
+/**
+ * @brief Get the free speed of a gearset, in rpm
+ */
+static double gearsetRpm(pros::motor_gearset_e_t gearset) {
+    switch (gearset) {
+        case pros::E_MOTOR_GEARSET_36: return 100;
+        case pros::E_MOTOR_GEARSET_06: return 600;
+        default: return 200;
+    }
+}
+
+/**
+ * @brief Get how many encoder units there are in a degree of the output shaft
+ */
+static double unitsPerDegree(std::uint8_t port) {
+    const MotorSettings settings = getSettings(port);
+    switch (settings.units) {
+        case pros::E_MOTOR_ENCODER_ROTATIONS: return 1.0 / 360;
+        // the encoder counts 1800 ticks per revolution of the motor, before the cartridge
+        case pros::E_MOTOR_ENCODER_COUNTS: return 1800 / gearsetRpm(pros::E_MOTOR_GEARSET_36) * 100 /
+                                                  gearsetRpm(settings.gearset) / 360;
+        default: return 1;
+    }
+}
+
+namespace pros {
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse,
+             const motor_encoder_units_e_t encoder_units)
+    : _port(std::abs(port)) {
+    // a negative port reverses the motor
+    setSettings(this->_port, {gearset, encoder_units, reverse != (port < 0)});
+}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset, const bool reverse)
+    : Motor(port, gearset, reverse, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::int8_t port, const motor_gearset_e_t gearset)
+    : Motor(port, gearset, false, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::int8_t port, const bool reverse)
+    : Motor(port, E_MOTOR_GEARSET_18, reverse, E_MOTOR_ENCODER_DEGREES) {}
+
+Motor::Motor(const std::int8_t port)
+    : Motor(port, E_MOTOR_GEARSET_18, false, E_MOTOR_ENCODER_DEGREES) {}
+
+std::int32_t Motor::operator=(std::int32_t voltage) const { return this->move(voltage); }
+
+std::int32_t Motor::move(std::int32_t voltage) const { return this->move_voltage(voltage * 12000 / 127); }
+
+std::int32_t Motor::move_absolute(const double position, const std::int32_t velocity) const {
+    // the motor moves to the position as fast as it can, ignoring the velocity limit
+    sim::MotorState& state = motorState(this->_port);
+    state.braking = false;
+    state.holding = true;
+    state.holdPosition = position / unitsPerDegree(this->_port);
+    return 1;
+}
+
+std::int32_t Motor::move_relative(const double position, const std::int32_t velocity) const {
+    const sim::MotorState& state = motorState(this->_port);
+    return this->move_absolute(state.holdPosition * unitsPerDegree(this->_port) + position, velocity);
+}
+
+std::int32_t Motor::move_velocity(const std::int32_t velocity) const {
+    // open loop, since the velocity controller of the motor isn't simulated
+    return this->move_voltage(velocity * 12000 / gearsetRpm(getSettings(this->_port).gearset));
+}
+
+std::int32_t Motor::move_voltage(const std::int32_t voltage) const {
+    sim::MotorState& state = motorState(this->_port);
+    state.voltage = std::max(-12000, std::min(12000, voltage));
+    state.braking = false;
+    state.holding = false;
+    return 1;
+}
+
+std::int32_t Motor::brake(void) const {
+    sim::MotorState& state = motorState(this->_port);
+    state.voltage = 0;
+    state.braking = true;
+    state.holding = state.brakeMode == E_MOTOR_BRAKE_HOLD;
+    state.holdPosition = state.position;
+    return 1;
+}
+
+std::int32_t Motor::modify_profiled_velocity(const std::int32_t velocity) const { return 1; }
+
+double Motor::get_target_position(void) const {
+    return motorState(this->_port).holdPosition * unitsPerDegree(this->_port);
+}
+
+std::int32_t Motor::get_target_velocity(void) const { return 0; }
+
+double Motor::get_actual_velocity(void) const { return motorState(this->_port).velocity; }
+
+std::int32_t Motor::get_current_draw(void) const {
+    // the current limit of 2.5 A is reached at the stall torque
+    const double stallTorque = 2.1 * 100 / gearsetRpm(getSettings(this->_port).gearset);
+    return std::fabs(motorState(this->_port).torque) / stallTorque * 2500;
+}
+
+std::int32_t Motor::get_direction(void) const { return motorState(this->_port).velocity < 0 ? -1 : 1; }
+
+double Motor::get_efficiency(void) const { return 0; }
+
+std::int32_t Motor::is_over_current(void) const { return 0; }
+
+std::int32_t Motor::is_stopped(void) const { return motorState(this->_port).velocity == 0; }
+
+std::int32_t Motor::get_zero_position_flag(void) const { return 0; }
+
+std::uint32_t Motor::get_faults(void) const { return 0; }
+
+std::uint32_t Motor::get_flags(void) const { return 0; }
+
+std::int32_t Motor::get_raw_position(std::uint32_t* const timestamp) const {
+    if (timestamp != nullptr) *timestamp = c::millis();
+    return motorState(this->_port).position * 1800 / 360;
+}
+
+std::int32_t Motor::is_over_temp(void) const { return 0; }
+
+double Motor::get_position(void) const { return motorState(this->_port).position * unitsPerDegree(this->_port); }
+
+double Motor::get_power(void) const {
+    const sim::MotorState& state = motorState(this->_port);
+    return std::fabs(state.torque * state.velocity * 2 * M_PI / 60);
+}
+
+// motors don't heat up in the simulation
+double Motor::get_temperature(void) const { return 25; }
+
+double Motor::get_torque(void) const { return motorState(this->_port).torque; }
+
+std::int32_t Motor::get_voltage(void) const { return motorState(this->_port).voltage; }
+
+std::int32_t Motor::set_zero_position(const double position) const {
+    sim::MotorState& state = motorState(this->_port);
+    const double offset = position / unitsPerDegree(this->_port);
+    state.position -= offset;
+    state.holdPosition -= offset;
+    return 1;
+}
+
+std::int32_t Motor::tare_position(void) const { return this->set_zero_position(this->get_position()); }
+
+std::int32_t Motor::set_brake_mode(const motor_brake_mode_e_t mode) const {
+    motorState(this->_port).brakeMode = mode;
+    return 1;
+}
+
+std::int32_t Motor::set_current_limit(const std::int32_t limit) const { return 1; }
+
+std::int32_t Motor::set_encoder_units(const motor_encoder_units_e_t units) const {
+    MotorSettings settings = getSettings(this->_port);
+    settings.units = units;
+    setSettings(this->_port, settings);
+    return 1;
+}
+
+std::int32_t Motor::set_gearing(const motor_gearset_e_t gearset) const {
+    MotorSettings settings = getSettings(this->_port);
+    settings.gearset = gearset;
+    setSettings(this->_port, settings);
+    return 1;
+}
+
+std::int32_t Motor::set_pos_pid(const motor_pid_s_t pid) const { return 1; }
+
+std::int32_t Motor::set_pos_pid_full(const motor_pid_full_s_t pid) const { return 1; }
+
+std::int32_t Motor::set_vel_pid(const motor_pid_s_t pid) const { return 1; }
+
+std::int32_t Motor::set_vel_pid_full(const motor_pid_full_s_t pid) const { return 1; }
+
+std::int32_t Motor::set_reversed(const bool reverse) const {
+    MotorSettings settings = getSettings(this->_port);
+    settings.reversed = reverse;
+    setSettings(this->_port, settings);
+    return 1;
+}
+
+std::int32_t Motor::set_voltage_limit(const std::int32_t limit) const { return 1; }
+
+motor_brake_mode_e_t Motor::get_brake_mode(void) const { return motorState(this->_port).brakeMode; }
+
+std::int32_t Motor::get_current_limit(void) const { return 2500; }
+
+motor_encoder_units_e_t Motor::get_encoder_units(void) const { return getSettings(this->_port).units; }
+
+motor_gearset_e_t Motor::get_gearing(void) const { return getSettings(this->_port).gearset; }
+
+motor_pid_full_s_t Motor::get_pos_pid(void) const { return {}; }
+
+motor_pid_full_s_t Motor::get_vel_pid(void) const { return {}; }
+
+std::int32_t Motor::is_reversed(void) const { return getSettings(this->_port).reversed; }
+
+std::int32_t Motor::get_voltage_limit(void) const { return 0; }
+
+std::uint8_t Motor::get_port(void) const { return this->_port; }
+
+Motor_Group::Motor_Group(const std::initializer_list<Motor> motors)
+    : _motors(motors),
+      _motor_count(motors.size()) {}
+
+Motor_Group::Motor_Group(const std::vector<pros::Motor>& motors)
+    : _motors(motors),
+      _motor_count(motors.size()) {}
+
+Motor_Group::Motor_Group(const std::initializer_list<std::int8_t> motor_ports)
+    : Motor_Group(std::vector<std::int8_t>(motor_ports)) {}
+
+Motor_Group::Motor_Group(const std::vector<std::int8_t> motor_ports)
+    : _motor_count(motor_ports.size()) {
+    for (const std::int8_t port : motor_ports) this->_motors.emplace_back(port);
+}
+
+/**
+ * @brief Send the same command to every motor in a group
+ */
+template <typename F> static std::int32_t forEach(std::vector<Motor>& motors, F command) {
+    std::int32_t result = 1;
+    for (Motor& motor : motors) {
+        if (command(motor) != 1) result = PROS_ERR;
+    }
+    return result;
+}
+
+/**
+ * @brief Read the same value from every motor in a group
+ */
+template <typename F> static auto collect(std::vector<Motor>& motors, F read) {
+    std::vector<decltype(read(motors[0]))> values;
+    values.reserve(motors.size());
+    for (Motor& motor : motors) values.push_back(read(motor));
+    return values;
+}
+
+std::int32_t Motor_Group::operator=(std::int32_t voltage) { return this->move(voltage); }
+
+std::int32_t Motor_Group::move(std::int32_t voltage) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.move(voltage); });
+}
+
+std::int32_t Motor_Group::move_absolute(const double position, const std::int32_t velocity) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.move_absolute(position, velocity); });
+}
+
+std::int32_t Motor_Group::move_relative(const double position, const std::int32_t velocity) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.move_relative(position, velocity); });
+}
+
+std::int32_t Motor_Group::move_velocity(const std::int32_t velocity) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.move_velocity(velocity); });
+}
+
+std::int32_t Motor_Group::move_voltage(const std::int32_t voltage) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.move_voltage(voltage); });
+}
+
+std::int32_t Motor_Group::brake(void) {
+    return forEach(this->_motors, [](Motor& motor) { return motor.brake(); });
+}
+
+std::vector<std::uint32_t> Motor_Group::get_voltages(void) {
+    return collect(this->_motors, [](Motor& motor) { return std::uint32_t(motor.get_voltage()); });
+}
+
+std::vector<std::uint32_t> Motor_Group::get_voltage_limits(void) {
+    return collect(this->_motors, [](Motor& motor) { return std::uint32_t(motor.get_voltage_limit()); });
+}
+
+std::vector<std::int32_t> Motor_Group::get_raw_positions(std::vector<std::uint32_t*>& timestamps) {
+    std::vector<std::int32_t> positions;
+    for (size_t i = 0; i < this->_motors.size(); i++) {
+        positions.push_back(this->_motors[i].get_raw_position(i < timestamps.size() ? timestamps[i] : nullptr));
+    }
+    return positions;
+}
+
+Motor& Motor_Group::operator[](int i) { return this->_motors[i]; }
+
+Motor& Motor_Group::at(int i) {
+    if (i < 0 || i >= int(this->_motors.size())) throw std::out_of_range("Motor_Group index out of range");
+    return this->_motors[i];
+}
+
+std::int32_t Motor_Group::size() { return this->_motors.size(); }
+
+std::int32_t Motor_Group::set_zero_position(const double position) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_zero_position(position); });
+}
+
+std::int32_t Motor_Group::set_brake_modes(motor_brake_mode_e_t mode) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_brake_mode(mode); });
+}
+
+std::int32_t Motor_Group::set_reversed(const bool reversed) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_reversed(reversed); });
+}
+
+std::int32_t Motor_Group::set_voltage_limit(const std::int32_t limit) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_voltage_limit(limit); });
+}
+
+std::int32_t Motor_Group::set_gearing(const motor_gearset_e_t gearset) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_gearing(gearset); });
+}
+
+std::int32_t Motor_Group::set_encoder_units(const motor_encoder_units_e_t units) {
+    return forEach(this->_motors, [&](Motor& motor) { return motor.set_encoder_units(units); });
+}
+
+std::int32_t Motor_Group::tare_position(void) {
+    return forEach(this->_motors, [](Motor& motor) { return motor.tare_position(); });
+}
+
+std::vector<double> Motor_Group::get_actual_velocities(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_actual_velocity(); });
+}
+
+std::vector<std::int32_t> Motor_Group::get_target_velocities(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_target_velocity(); });
+}
+
+std::vector<double> Motor_Group::get_target_positions(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_target_position(); });
+}
+
+std::vector<double> Motor_Group::get_positions(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_position(); });
+}
+
+std::vector<double> Motor_Group::get_efficiencies(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_efficiency(); });
+}
+
+std::vector<std::int32_t> Motor_Group::are_over_current(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.is_over_current(); });
+}
+
+std::vector<std::int32_t> Motor_Group::are_over_temp(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.is_over_temp(); });
+}
+
+std::vector<motor_brake_mode_e_t> Motor_Group::get_brake_modes(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_brake_mode(); });
+}
+
+std::vector<motor_gearset_e_t> Motor_Group::get_gearing(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_gearing(); });
+}
+
+std::vector<std::int32_t> Motor_Group::get_current_draws(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_current_draw(); });
+}
+
+std::vector<std::int32_t> Motor_Group::get_current_limits(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_current_limit(); });
+}
+
+std::vector<std::uint8_t> Motor_Group::get_ports(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_port(); });
+}
+
+std::vector<std::int32_t> Motor_Group::get_directions(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_direction(); });
+}
+
+std::vector<motor_encoder_units_e_t> Motor_Group::get_encoder_units(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_encoder_units(); });
+}
+
+std::vector<double> Motor_Group::get_temperatures(void) {
+    return collect(this->_motors, [](Motor& motor) { return motor.get_temperature(); });
+}
+
+/**
+ * @brief Whether the inertial sensor of the robot is on a port
+ */
+static bool imuConnected(std::uint8_t port) {
+    if (sim::World::current().getPlant().getModel().imuPort == port) return true;
+    errno = ENODEV;
+    return false;
+}
+
+static double& imuAngle() { return sim::World::current().getPlant().imuRotation(); }
+
+// heading and rotation are the same angle, but the heading wraps around
+std::int32_t Imu::reset(bool blocking) const {
+    if (!imuConnected(this->_port)) return PROS_ERR;
+    sim::World::current().getPlant().calibrateImu();
+    while (blocking && this->is_calibrating()) c::delay(10);
+    return 1;
+}
+
+std::int32_t Imu::set_data_rate(std::uint32_t rate) const { return imuConnected(this->_port) ? 1 : PROS_ERR; }
+
+double Imu::get_rotation() const {
+    if (!imuConnected(this->_port) || this->is_calibrating()) return PROS_ERR_F;
+    return imuAngle();
+}
+
+double Imu::get_heading() const {
+    const double rotation = this->get_rotation();
+    if (rotation == PROS_ERR_F) return PROS_ERR_F;
+    const double heading = std::fmod(rotation, 360);
+    return heading < 0 ? heading + 360 : heading;
+}
+
+c::quaternion_s_t Imu::get_quaternion() const {
+    // rotation around the z axis, which points up
+    const double yaw = -this->get_yaw() * M_PI / 180;
+    return {0, 0, std::sin(yaw / 2), std::cos(yaw / 2)};
+}
+
+c::euler_s_t Imu::get_euler() const { return {0, 0, this->get_yaw()}; }
+
+double Imu::get_pitch() const { return imuConnected(this->_port) ? 0 : PROS_ERR_F; }
+
+double Imu::get_roll() const { return imuConnected(this->_port) ? 0 : PROS_ERR_F; }
+
+double Imu::get_yaw() const {
+    const double heading = this->get_heading();
+    if (heading == PROS_ERR_F) return PROS_ERR_F;
+    return heading > 180 ? heading - 360 : heading;
+}
+
+c::imu_gyro_s_t Imu::get_gyro_rate() const {
+    if (!imuConnected(this->_port)) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    // the z axis points up, so turning clockwise is negative
+    return {0, 0, -sim::World::current().getPlant().imuRate()};
+}
+
+std::int32_t Imu::tare_rotation() const { return this->set_rotation(0); }
+
+std::int32_t Imu::tare_heading() const { return this->set_heading(0); }
+
+std::int32_t Imu::tare_pitch() const { return imuConnected(this->_port) ? 1 : PROS_ERR; }
+
+std::int32_t Imu::tare_yaw() const { return this->set_heading(0); }
+
+std::int32_t Imu::tare_roll() const { return imuConnected(this->_port) ? 1 : PROS_ERR; }
+
+std::int32_t Imu::tare() const { return this->set_rotation(0); }
+
+std::int32_t Imu::tare_euler() const { return this->set_rotation(0); }
+
+std::int32_t Imu::set_heading(const double target) const { return this->set_rotation(target); }
+
+std::int32_t Imu::set_rotation(const double target) const {
+    if (!imuConnected(this->_port)) return PROS_ERR;
+    imuAngle() = target;
+    return 1;
+}
+
+std::int32_t Imu::set_yaw(const double target) const { return this->set_rotation(target); }
+
+std::int32_t Imu::set_pitch(const double target) const { return imuConnected(this->_port) ? 1 : PROS_ERR; }
+
+std::int32_t Imu::set_roll(const double target) const { return imuConnected(this->_port) ? 1 : PROS_ERR; }
+
+std::int32_t Imu::set_euler(const c::euler_s_t target) const { return this->set_rotation(target.yaw); }
+
+c::imu_accel_s_t Imu::get_accel() const {
+    if (!imuConnected(this->_port)) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {0, 0, 1}; // gravity, in g
+}
+
+c::imu_status_e_t Imu::get_status() const {
+    if (!imuConnected(this->_port)) return c::E_IMU_STATUS_ERROR;
+    return this->is_calibrating() ? c::E_IMU_STATUS_CALIBRATING : c::E_IMU_STATUS_READY;
+}
+
+bool Imu::is_calibrating() const {
+    return imuConnected(this->_port) && sim::World::current().getPlant().imuCalibrating();
+}
+
+c::imu_orientation_e_t Imu::get_physical_orientation() const { return c::E_IMU_Z_UP; }
+
+static double* rotationAngle(std::uint8_t port) {
+    double* angle = sim::World::current().getPlant().encoderAngle(TrackingWheelModel::Encoder::ROTATION, port);
+    if (angle == nullptr) errno = ENODEV;
+    return angle;
+}
+
+std::int32_t Rotation::reset() { return this->reset_position(); }
+
+std::int32_t Rotation::set_data_rate(std::uint32_t rate) const {
+    return rotationAngle(this->_port) == nullptr ? PROS_ERR : 1;
+}
+
+std::int32_t Rotation::set_position(std::uint32_t position) {
+    double* angle = rotationAngle(this->_port);
+    if (angle == nullptr) return PROS_ERR;
+    *angle = std::int32_t(position) / 100.0;
+    return 1;
+}
+
+std::int32_t Rotation::reset_position(void) { return this->set_position(0); }
+
+std::int32_t Rotation::get_position() {
+    const double* angle = rotationAngle(this->_port);
+    return angle == nullptr ? PROS_ERR : std::int32_t(std::lround(*angle * 100));
+}
+
+std::int32_t Rotation::get_velocity() {
+    if (rotationAngle(this->_port) == nullptr) return PROS_ERR;
+    sim::DrivePlant& plant = sim::World::current().getPlant();
+    return std::lround(plant.encoderRate(TrackingWheelModel::Encoder::ROTATION, this->_port) * 100);
+}
+
+std::int32_t Rotation::get_angle() {
+    const std::int32_t position = this->get_position();
+    if (position == PROS_ERR) return PROS_ERR;
+    return (position % 36000 + 36000) % 36000;
+}
+
+std::int32_t Rotation::set_reversed(bool value) {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    rotationReversed[this->_port < rotationReversed.size() ? this->_port : 0] = value;
+    return 1;
+}
+
+std::int32_t Rotation::reverse() { return this->set_reversed(!this->get_reversed()); }
+
+std::int32_t Rotation::get_reversed() {
+    std::lock_guard<std::mutex> lock(settingsMutex);
+    return rotationReversed[this->_port < rotationReversed.size() ? this->_port : 0];
+}
+
+ADIPort::ADIPort(std::uint8_t adi_port, adi_port_config_e_t type)
+    : _smart_port(INTERNAL_ADI_PORT),
+      _adi_port(adi_port) {}
+
+ADIEncoder::ADIEncoder(std::uint8_t adi_port_top, std::uint8_t adi_port_bottom, bool reversed)
+    : ADIPort(adi_port_top, E_ADI_LEGACY_ENCODER) {}
+
+ADIEncoder::ADIEncoder(ext_adi_port_tuple_t port_tuple, bool reversed)
+    : ADIPort(std::get<1>(port_tuple), E_ADI_LEGACY_ENCODER) {
+    // expanders aren't simulated separately, so their encoders share ports with the brain
+    this->_smart_port = std::get<0>(port_tuple);
+}
+
+std::int32_t ADIEncoder::reset() const {
+    double* angle = sim::World::current().getPlant().encoderAngle(TrackingWheelModel::Encoder::ADI_ENCODER,
+                                                                  this->_adi_port);
+    if (angle == nullptr) return PROS_ERR;
+    *angle = 0;
+    return 1;
+}
+
+std::int32_t ADIEncoder::get_value() const {
+    // optical shaft encoders count 360 ticks per revolution
+    const double* angle = sim::World::current().getPlant().encoderAngle(TrackingWheelModel::Encoder::ADI_ENCODER,
+                                                                        this->_adi_port);
+    return angle == nullptr ? PROS_ERR : std::int32_t(std::lround(*angle));
+}
+} // namespace pros
@@ -0,0 +1,28 @@
+// The parts of LVGL that LemLib uses, for the simulator and the benchmarks. The computer has no screen, so objects
+// are placeholders and nothing is drawn
+#include "display/lvgl.h"
+
+// stands in for every object, since none of them are ever drawn
+static lv_obj_t* placeholder() {
+    static char object[sizeof(void*)];
+    return reinterpret_cast<lv_obj_t*>(object);
+}
+
+lv_obj_t* lv_scr_act(void) { return placeholder(); }
+
+lv_obj_t* lv_canvas_create(lv_obj_t* par, const lv_obj_t* copy) { return placeholder(); }
+
+void lv_canvas_set_buffer(lv_obj_t* canvas, void* buf, lv_coord_t w, lv_coord_t h, lv_img_cf_t cf) {}
+
+void lv_obj_set_pos(lv_obj_t* obj, lv_coord_t x, lv_coord_t y) {}
+
+void lv_obj_get_coords(const lv_obj_t* obj, lv_area_t* cords_p) { *cords_p = {0, 0, 0, 0}; }
+
+void lv_inv_area(const lv_area_t* area_p) {}
+
+lv_res_t lv_obj_del(lv_obj_t* obj) { return LV_RES_INV; }
+
+// there is no LVGL task to run tasks, so none are made
+lv_task_t* lv_task_create(void (*task)(void*), uint32_t period, lv_task_prio_t prio, void* param) { return nullptr; }
+
+void lv_task_del(lv_task_t* lv_task_p) {}
@@ -0,0 +1,28 @@
+// The parts of the PROS API that don't depend on the simulated robot
+#include "pros/misc.hpp"
+
+namespace pros {
+namespace c {
+int32_t controller_rumble(controller_id_e_t id, const char* rumble_pattern) { return 1; }
+
+// the text is accepted, but there is no screen to show it on
+int32_t controller_set_text(controller_id_e_t id, uint8_t line, uint8_t col, const char* str) { return 1; }
+
+// the sticks are centered
+int32_t controller_get_analog(controller_id_e_t id, controller_analog_e_t channel) { return 0; }
+} // namespace c
+
+namespace battery {
+// a fully charged battery
+int32_t get_voltage(void) { return 12000; }
+} // namespace battery
+
+namespace competition {
+// enabled, and not connected to a field or competition switch
+std::uint8_t get_status(void) { return 0; }
+} // namespace competition
+
+namespace usd {
+std::int32_t is_installed(void) { return 0; }
+} // namespace usd
+} // namespace pros
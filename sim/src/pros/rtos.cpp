@@ -0,0 +1,218 @@
+// The PROS RTOS API, on the scheduler of the simulated world. Time only passes when every task is waiting
+#include <algorithm>
+#include <system_error>
+#include "pros/rtos.hpp"
+#include "kernel.hpp"
+
+using sim::HostMutex;
+using sim::HostTask;
+
+/**
+ * @brief Block the calling task for a number of milliseconds of simulated time
+ */
+static void sleepFor(std::uint32_t milliseconds) {
+    HostTask* self = sim::currentTask();
+    std::unique_lock<std::mutex> lock(self->kernel->mutex);
+    self->kernel->sleepUntil(lock, self, self->kernel->now + std::uint64_t(milliseconds) * 1000);
+}
+
+/**
+ * @brief Convert a timeout in milliseconds to the time it expires, in microseconds
+ */
+static std::uint64_t expiry(HostTask* task, std::uint32_t timeout) {
+    if (timeout == TIMEOUT_MAX) return sim::FOREVER;
+    return task->kernel->now + std::uint64_t(timeout) * 1000;
+}
+
+namespace pros {
+namespace c {
+uint32_t millis(void) { return sim::currentTask()->kernel->now / 1000; }
+
+uint64_t micros(void) { return sim::currentTask()->kernel->now; }
+
+void delay(const uint32_t milliseconds) { sleepFor(milliseconds); }
+
+void task_delay(const uint32_t milliseconds) { sleepFor(milliseconds); }
+
+task_t task_get_current() { return sim::currentTask(); }
+
+uint32_t task_notify(task_t task) {
+    HostTask* target = static_cast<HostTask*>(task);
+    std::unique_lock<std::mutex> lock(target->kernel->mutex);
+    target->notifications++;
+    if (target->waitingForNotification) target->kernel->wake(target);
+    return 1;
+}
+} // namespace c
+
+Task::Task(task_fn_t function, void* parameters, std::uint32_t prio, std::uint16_t stack_depth, const char* name) {
+    this->task = sim::currentTask()->kernel->spawn(function, parameters, prio, name);
+}
+
+Task::Task(task_fn_t function, void* parameters, const char* name)
+    : Task(function, parameters, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, name) {}
+
+Task::Task(task_t task)
+    : task(task) {}
+
+Task& Task::operator=(task_t in) {
+    this->task = in;
+    return *this;
+}
+
+Task Task::current() { return Task(c::task_get_current()); }
+
+void Task::remove() {
+    HostTask* self = sim::currentTask();
+    HostTask* target = static_cast<HostTask*>(this->task);
+    std::unique_lock<std::mutex> lock(target->kernel->mutex);
+    target->state = HostTask::State::DONE;
+    // the thread of a removed task stays parked until the world stops, unless it removed itself
+    if (target != self) return;
+    if (target == target->kernel->routine) target->kernel->stop(sim::StopReason::FINISHED);
+    else target->kernel->schedule(lock, target);
+    lock.unlock();
+    throw sim::Stopped();
+}
+
+std::uint32_t Task::get_priority() { return static_cast<HostTask*>(this->task)->priority; }
+
+void Task::set_priority(std::uint32_t prio) {
+    HostTask* target = static_cast<HostTask*>(this->task);
+    std::unique_lock<std::mutex> lock(target->kernel->mutex);
+    target->priority = prio;
+}
+
+std::uint32_t Task::get_state() {
+    HostTask* target = static_cast<HostTask*>(this->task);
+    std::unique_lock<std::mutex> lock(target->kernel->mutex);
+    if (target == target->kernel->running) return E_TASK_STATE_RUNNING;
+    switch (target->state) {
+        case HostTask::State::READY: return E_TASK_STATE_READY;
+        case HostTask::State::BLOCKED: return E_TASK_STATE_BLOCKED;
+        default: return E_TASK_STATE_DELETED;
+    }
+}
+
+const char* Task::get_name() { return static_cast<HostTask*>(this->task)->name.c_str(); }
+
+std::uint32_t Task::notify() { return c::task_notify(this->task); }
+
+bool Task::notify_clear() {
+    HostTask* target = static_cast<HostTask*>(this->task);
+    std::unique_lock<std::mutex> lock(target->kernel->mutex);
+    const bool pending = target->notifications > 0;
+    target->notifications = 0;
+    return pending;
+}
+
+void Task::join() {
+    // tasks only finish while the joining task waits, so polling each millisecond doesn't miss it
+    while (this->get_state() != E_TASK_STATE_DELETED) sleepFor(1);
+}
+
+std::uint32_t Task::notify_take(bool clear_on_exit, std::uint32_t timeout) {
+    HostTask* self = sim::currentTask();
+    std::unique_lock<std::mutex> lock(self->kernel->mutex);
+    if (self->notifications == 0 && timeout > 0) {
+        self->waitingForNotification = true;
+        self->kernel->sleepUntil(lock, self, expiry(self, timeout));
+        self->waitingForNotification = false;
+    }
+    const std::uint32_t value = self->notifications;
+    if (clear_on_exit) self->notifications = 0;
+    else if (value > 0) self->notifications--;
+    return value;
+}
+
+void Task::delay(const std::uint32_t milliseconds) { sleepFor(milliseconds); }
+
+void Task::delay_until(std::uint32_t* const prev_time, const std::uint32_t delta) {
+    *prev_time += delta;
+    HostTask* self = sim::currentTask();
+    std::unique_lock<std::mutex> lock(self->kernel->mutex);
+    // like FreeRTOS, a task that is already late doesn't wait
+    const std::uint64_t wakeTime = std::uint64_t(*prev_time) * 1000;
+    if (wakeTime > self->kernel->now) self->kernel->sleepUntil(lock, self, wakeTime);
+}
+
+std::uint32_t Task::get_count() {
+    HostTask* self = sim::currentTask();
+    std::unique_lock<std::mutex> lock(self->kernel->mutex);
+    std::uint32_t count = 0;
+    for (const std::unique_ptr<HostTask>& task : self->kernel->tasks) count += task->state != HostTask::State::DONE;
+    return count;
+}
+
+Clock::time_point Clock::now() { return time_point(duration(c::millis())); }
+
+Mutex::Mutex()
+    : mutex(std::make_shared<HostMutex>()) {}
+
+bool Mutex::take() { return this->take(TIMEOUT_MAX); }
+
+bool Mutex::take(std::uint32_t timeout) {
+    HostMutex* mutex = static_cast<HostMutex*>(this->mutex.get());
+    HostTask* self = sim::currentTask();
+    const std::uint64_t timeoutTime = expiry(self, timeout);
+    std::unique_lock<std::mutex> guard(mutex->guard);
+    while (mutex->owner != nullptr) {
+        if (self->kernel->stopping) {
+            guard.unlock();
+            sim::World::Kernel::exitTask();
+            return false;
+        }
+        if (timeout == 0) return false;
+        if (mutex->owner->kernel == self->kernel) {
+            // the owner is waiting in this world, so wait in simulated time until it gives the mutex
+            mutex->waiters.push_back(self);
+            guard.unlock();
+            try {
+                std::unique_lock<std::mutex> lock(self->kernel->mutex);
+                self->kernel->sleepUntil(lock, self, timeoutTime);
+            } catch (const sim::Stopped&) {
+                // the mutex can outlive the world, so it can't keep a pointer to the task
+                guard.lock();
+                mutex->waiters.erase(std::remove(mutex->waiters.begin(), mutex->waiters.end(), self),
+                                     mutex->waiters.end());
+                throw;
+            }
+            guard.lock();
+            mutex->waiters.erase(std::remove(mutex->waiters.begin(), mutex->waiters.end(), self), mutex->waiters.end());
+            if (mutex->owner != nullptr && self->kernel->now >= timeoutTime) return false;
+        } else {
+            // the owner is in another world, which runs in real time, so this world waits in real time. Checking
+            // regularly means the wait ends if this world stops
+            mutex->released.wait_for(guard, std::chrono::milliseconds(1));
+        }
+    }
+    mutex->owner = self;
+    return true;
+}
+
+bool Mutex::give() {
+    HostMutex* mutex = static_cast<HostMutex*>(this->mutex.get());
+    std::vector<HostTask*> waiters;
+    {
+        std::unique_lock<std::mutex> guard(mutex->guard);
+        mutex->owner = nullptr;
+        waiters = mutex->waiters;
+    }
+    mutex->released.notify_all();
+    for (HostTask* waiter : waiters) {
+        std::unique_lock<std::mutex> lock(waiter->kernel->mutex);
+        waiter->kernel->wake(waiter);
+    }
+    return true;
+}
+
+void Mutex::lock() {
+    // take only fails if the world stopped while the task was unwinding, so the task doesn't need the mutex
+    if (!this->take(TIMEOUT_MAX) && !sim::currentTask()->kernel->stopping)
+        throw std::system_error(std::make_error_code(std::errc::resource_deadlock_would_occur));
+}
+
+void Mutex::unlock() { this->give(); }
+
+bool Mutex::try_lock() { return this->take(0); }
+} // namespace pros
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include "sim/route.hpp"
+
+// time spent calibrating and setting up the chassis on top of the route, in milliseconds
+constexpr std::uint32_t SETUP_TIME = 1000;
+
+const char* sim::reasonName(lemlib::MotionEndReason reason) {
+    switch (reason) {
+        case lemlib::MotionEndReason::NOT_DONE: return "not done";
+        case lemlib::MotionEndReason::SETTLED: return "settled";
+        case lemlib::MotionEndReason::TIMEOUT: return "timed out";
+        case lemlib::MotionEndReason::CANCELLED: return "cancelled";
+        case lemlib::MotionEndReason::EARLY_EXIT: return "exited early";
+        case lemlib::MotionEndReason::STALLED: return "stalled";
+        case lemlib::MotionEndReason::COLLIDED: return "collided";
+        case lemlib::MotionEndReason::CONDITION_MET: return "condition met";
+        default: return "unknown";
+    }
+}
+
+sim::RouteEstimator::RouteEstimator(RobotModel robot, lemlib::Drivetrain drivetrain,
+                                    lemlib::ControllerSettings lateral, lemlib::ControllerSettings angular,
+                                    lemlib::OdomSensors sensors)
+    : robot(robot),
+      drivetrain(drivetrain),
+      lateral(lateral),
+      angular(angular),
+      sensors(sensors) {}
+
+sim::RouteEstimator& sim::RouteEstimator::add(std::string name, int timeout, Motion motion) {
+    this->segments.push_back({name, timeout, motion});
+    return *this;
+}
+
+sim::RouteEstimate sim::RouteEstimator::run() const {
+    RouteEstimate estimate {StopReason::FINISHED, {}, 0, 0};
+    // every motion ends by its timeout, so the route can't take longer than all of them together
+    std::uint32_t runTimeout = this->robot.imuCalibrationTime + SETUP_TIME;
+    for (const Segment& segment : this->segments) runTimeout += segment.timeout + SETUP_TIME;
+
+    World world(this->robot);
+    world.getPlant().setPose(this->start);
+    const RunResult run = world.run(
+        [&] {
+            lemlib::Chassis chassis(this->drivetrain, this->lateral, this->angular, this->sensors);
+            chassis.calibrate();
+            chassis.setPose(this->start);
+            const std::uint32_t routeStart = pros::millis();
+            for (const Segment& segment : this->segments) {
+                const std::uint32_t start = pros::millis();
+                const lemlib::MotionHandle motion = segment.motion(chassis, segment.timeout);
+                motion.wait();
+                const std::uint32_t duration = pros::millis() - start;
+                const std::uint32_t timeout = std::max(segment.timeout, 0);
+                const lemlib::MotionEndReason reason = motion.endReason();
+                const std::uint32_t slack =
+                    reason == lemlib::MotionEndReason::TIMEOUT ? 0 : timeout - std::min(duration, timeout);
+                estimate.segments.push_back({segment.name, start - routeStart, duration, timeout, slack, reason});
+                estimate.total = pros::millis() - routeStart;
+            }
+        },
+        runTimeout);
+    estimate.reason = run.reason;
+    estimate.slack = std::int32_t(this->budget) - std::int32_t(estimate.total);
+    return estimate;
+}
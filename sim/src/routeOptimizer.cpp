@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include "lemlib/configStore.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/util.hpp"
+#include "sim/routeOptimizer.hpp"
+
+// time spent calibrating and setting up the chassis on top of the route, in milliseconds
+constexpr std::uint32_t SETUP_TIME = 1000;
+// points of the arena for the path of each leg, generously sized like the follow benchmark
+constexpr std::size_t PATH_POINTS = 8192;
+// weight of a degree of heading error against an inch of distance error, when comparing infeasible routes
+constexpr float DEGREE_WEIGHT = 0.1;
+// penalty of a leg that timed out or never ran, in inches, when comparing infeasible routes
+constexpr float LEG_PENALTY = 100;
+
+sim::RouteOptimizer::RouteOptimizer(RobotModel robot, lemlib::Drivetrain drivetrain,
+                                    lemlib::ControllerSettings lateral, lemlib::ControllerSettings angular,
+                                    lemlib::OdomSensors sensors)
+    : robot(robot),
+      drivetrain(drivetrain),
+      lateral(lateral),
+      angular(angular),
+      sensors(sensors) {}
+
+sim::RouteOptimum sim::RouteOptimizer::optimize(unsigned threads) const {
+    // how far a route is from feasible, so the search can work its way towards feasible settings
+    auto violation = [&](const RouteRun& run) {
+        float total = LEG_PENALTY * (this->legs.size() - run.legs.size());
+        for (std::size_t i = 0; i < run.legs.size(); i++) {
+            if (run.legs[i].reason == lemlib::MotionEndReason::TIMEOUT) total += LEG_PENALTY;
+            if (i + 1 < this->legs.size()) total += std::max(run.legs[i].passError - this->passTolerance, 0.0f);
+        }
+        total += std::max(run.finalError - this->finalTolerance, 0.0f);
+        return total + DEGREE_WEIGHT * std::max(run.finalHeadingError - this->finalAngle, 0.0f);
+    };
+    // feasible routes beat infeasible ones, then faster ones beat slower ones
+    auto better = [&](const RouteRun& a, const RouteRun& b) {
+        if (a.feasible != b.feasible) return a.feasible;
+        return a.feasible ? a.total < b.total : violation(a) < violation(b);
+    };
+
+    RouteOptimum optimum {std::vector<LegSettings>(this->legs.size()), {}, 1};
+    optimum.run = this->runRoute(optimum.legs);
+    // keeps the first of the best candidates, so the result is the same on any number of threads
+    auto keepBest = [&](const std::vector<std::vector<LegSettings>>& cases) {
+        const std::vector<RouteRun> runs = this->runAll(cases, threads);
+        optimum.evaluations += runs.size();
+        bool improved = false;
+        for (std::size_t i = 0; i < runs.size(); i++) {
+            if (!better(runs[i], optimum.run)) continue;
+            optimum.legs = cases[i];
+            optimum.run = runs[i];
+            improved = true;
+        }
+        return improved;
+    };
+
+    for (unsigned pass = 0; pass < this->passes; pass++) {
+        bool improved = false;
+        for (std::size_t leg = 0; leg < this->legs.size(); leg++) {
+            // the last leg settles on its target, so it isn't chained or moved
+            const bool last = leg + 1 == this->legs.size();
+            std::vector<std::pair<float, float>> chains = {{0, 0}};
+            if (!last) {
+                for (float chainSpeed : this->chainSpeeds) {
+                    if (chainSpeed <= 0) continue;
+                    for (float exitRange : this->exitRanges) chains.push_back({chainSpeed, exitRange});
+                }
+            }
+            // every motion of the leg, with its target where it is
+            std::vector<std::vector<LegSettings>> cases;
+            for (float speed : this->speeds) {
+                for (const auto& [minSpeed, exitRange] : chains) {
+                    LegSettings settings = optimum.legs[leg];
+                    settings.speed = speed;
+                    settings.minSpeed = minSpeed;
+                    settings.earlyExitRange = exitRange;
+                    settings.motion = LegMotion::POSE;
+                    for (float lead : this->leads) {
+                        settings.lead = lead;
+                        cases.push_back(optimum.legs);
+                        cases.back()[leg] = settings;
+                    }
+                    settings.motion = LegMotion::PATH;
+                    for (float lookahead : this->lookaheads) {
+                        settings.lookahead = lookahead;
+                        cases.push_back(optimum.legs);
+                        cases.back()[leg] = settings;
+                    }
+                }
+            }
+            improved |= keepBest(cases);
+            if (last || this->nudge <= 0) continue;
+
+            // then the target moved around where it is, with the best motion
+            cases.clear();
+            for (int x = -1; x <= 1; x++) {
+                for (int y = -1; y <= 1; y++) {
+                    if (x == 0 && y == 0) continue;
+                    cases.push_back(optimum.legs);
+                    cases.back()[leg].offsetX += x * this->nudge;
+                    cases.back()[leg].offsetY += y * this->nudge;
+                }
+            }
+            improved |= keepBest(cases);
+        }
+        if (!improved) break;
+    }
+    return optimum;
+}
+
+std::vector<sim::RouteRun> sim::RouteOptimizer::runAll(const std::vector<std::vector<LegSettings>>& cases,
+                                                       unsigned threads) const {
+    std::vector<RouteRun> results(cases.size());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, cases.size());
+
+    // each thread takes the next case until there are none left
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) {
+        pool.emplace_back([&] {
+            for (size_t index = next++; index < cases.size(); index = next++) results[index] = runRoute(cases[index]);
+        });
+    }
+    for (std::thread& thread : pool) thread.join();
+    return results;
+}
+
+lemlib::Path sim::RouteOptimizer::legPath(lemlib::PathArena& arena, const std::vector<LegSettings>& settings,
+                                          std::size_t leg) const {
+    // the leg starts where the last one was driving to
+    lemlib::Waypoint from {this->start.x, this->start.y, this->start.theta};
+    if (leg != 0) {
+        from = this->legs[leg - 1].target;
+        from.x += settings[leg - 1].offsetX;
+        from.y += settings[leg - 1].offsetY;
+    }
+    lemlib::Waypoint to = this->legs[leg].target;
+    to.x += settings[leg].offsetX;
+    to.y += settings[leg].offsetY;
+    // the path goes the way the robot travels, which is behind it when it drives backwards
+    if (!this->legs[leg].forwards) {
+        from.theta += 180;
+        to.theta += 180;
+    }
+    return lemlib::generatePath(arena, {from, to}, {.maxVelocity = settings[leg].speed});
+}
+
+sim::RouteRun sim::RouteOptimizer::runRoute(const std::vector<LegSettings>& settings) const {
+    RouteRun result {StopReason::FINISHED, false, 0, {}, INFINITY, INFINITY};
+    // the paths are generated before the route starts, like path files the robot loads
+    lemlib::PathArena arena(PATH_POINTS * this->legs.size());
+    std::vector<lemlib::Path> paths;
+    for (std::size_t leg = 0; leg < this->legs.size(); leg++) {
+        paths.push_back(settings[leg].motion == LegMotion::PATH ? this->legPath(arena, settings, leg) : lemlib::Path());
+    }
+
+    World world(this->robot);
+    world.getPlant().setPose(this->start);
+    // the observer and the routine run on the same world, one at a time, so they can share these
+    std::vector<float> passErrors(this->legs.size(), INFINITY);
+    std::size_t currentLeg = SIZE_MAX;
+    lemlib::Pose position = this->start;
+    world.setObserver([&](const PlantState& state) {
+        position = lemlib::Pose(state.pose.x, state.pose.y, state.pose.theta);
+        if (currentLeg == SIZE_MAX) return;
+        // a chained leg exits before the robot gets to its target, so the leg after it counts too
+        for (std::size_t leg = currentLeg == 0 ? 0 : currentLeg - 1; leg <= currentLeg; leg++) {
+            const lemlib::Pose target(this->legs[leg].target.x, this->legs[leg].target.y);
+            passErrors[leg] = std::min(passErrors[leg], lemlib::Pose(position.x, position.y).distance(target));
+        }
+    });
+
+    // every motion ends by its timeout, so the route can't take longer than all of them together
+    std::uint32_t runTimeout = this->robot.imuCalibrationTime + SETUP_TIME;
+    for (const RouteLeg& leg : this->legs) runTimeout += leg.timeout + SETUP_TIME;
+    const RunResult run = world.run(
+        [&] {
+            lemlib::Chassis chassis(this->drivetrain, this->lateral, this->angular, this->sensors);
+            chassis.calibrate();
+            chassis.setPose(this->start);
+            const std::uint32_t routeStart = pros::millis();
+            for (std::size_t i = 0; i < this->legs.size(); i++) {
+                const RouteLeg& leg = this->legs[i];
+                const LegSettings& legSettings = settings[i];
+                currentLeg = i;
+                const std::uint32_t start = pros::millis();
+                const lemlib::MotionHandle motion =
+                    legSettings.motion == LegMotion::PATH
+                        ? chassis.follow(paths[i], legSettings.lookahead, leg.timeout, leg.forwards, true, 0,
+                                         {.minSpeed = legSettings.minSpeed,
+                                          .earlyExitRange = legSettings.earlyExitRange})
+                        : chassis.moveToPose(leg.target.x + legSettings.offsetX, leg.target.y + legSettings.offsetY,
+                                             leg.target.theta, leg.timeout,
+                                             {.forwards = leg.forwards,
+                                              .lead = legSettings.lead,
+                                              .maxSpeed = legSettings.speed,
+                                              .minSpeed = legSettings.minSpeed,
+                                              .earlyExitRange = legSettings.earlyExitRange});
+                motion.wait();
+                result.legs.push_back({start - routeStart, pros::millis() - start, INFINITY, motion.endReason()});
+                result.total = pros::millis() - routeStart;
+            }
+            const RouteLeg& last = this->legs.back();
+            const lemlib::Pose end(last.target.x, last.target.y);
+            result.finalError = lemlib::Pose(position.x, position.y).distance(end);
+            result.finalHeadingError = std::fabs(lemlib::angleError(last.target.theta, position.theta, false));
+        },
+        runTimeout);
+    result.reason = run.reason;
+
+    result.feasible = result.reason == StopReason::FINISHED && result.legs.size() == this->legs.size() &&
+                      result.finalError <= this->finalTolerance && result.finalHeadingError <= this->finalAngle;
+    for (std::size_t leg = 0; leg < result.legs.size(); leg++) {
+        result.legs[leg].passError = passErrors[leg];
+        if (result.legs[leg].reason == lemlib::MotionEndReason::TIMEOUT) result.feasible = false;
+        if (leg + 1 < this->legs.size() && passErrors[leg] > this->passTolerance) result.feasible = false;
+    }
+    return result;
+}
+
+bool sim::RouteOptimizer::write(const RouteOptimum& optimum, const std::string& directory) const {
+    std::vector<lemlib::ConfigEntry> entries;
+    auto set = [&](const std::string& key, float value) {
+        entries.push_back({lemlib::configKeyHash(key), value});
+    };
+    bool written = true;
+    lemlib::PathArena arena(PATH_POINTS * this->legs.size());
+    for (std::size_t i = 0; i < this->legs.size(); i++) {
+        const RouteLeg& leg = this->legs[i];
+        const LegSettings& settings = optimum.legs.at(i);
+        set(leg.name + ".motion", settings.motion == LegMotion::PATH);
+        set(leg.name + ".lead", settings.lead);
+        set(leg.name + ".lookahead", settings.lookahead);
+        set(leg.name + ".speed", settings.speed);
+        set(leg.name + ".minSpeed", settings.minSpeed);
+        set(leg.name + ".earlyExitRange", settings.earlyExitRange);
+        set(leg.name + ".x", leg.target.x + settings.offsetX);
+        set(leg.name + ".y", leg.target.y + settings.offsetY);
+        set(leg.name + ".theta", leg.target.theta);
+        if (settings.motion == LegMotion::PATH) {
+            written &= lemlib::writeBinaryPath(this->legPath(arena, optimum.legs, i),
+                                               directory + "/" + leg.name + ".lpb");
+        }
+    }
+
+    // ConfigStore::save only writes to an SD card, which the host doesn't have, so the file is written the same way
+    // here. Its entries are sorted by key, so it can be loaded with ConfigStore::load on the robot
+    std::sort(entries.begin(), entries.end(),
+              [](const lemlib::ConfigEntry& a, const lemlib::ConfigEntry& b) { return a.key < b.key; });
+    const std::size_t size = entries.size() * sizeof(lemlib::ConfigEntry);
+    const lemlib::ConfigHeader header {lemlib::CONFIG_MAGIC, lemlib::CONFIG_VERSION, std::uint16_t(entries.size()),
+                                       lemlib::crc32(reinterpret_cast<const std::uint8_t*>(entries.data()), size)};
+    const std::string path = directory + "/route.cfg";
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    written &= std::fwrite(&header, sizeof(header), 1, file) == 1;
+    written &= std::fwrite(entries.data(), sizeof(lemlib::ConfigEntry), entries.size(), file) == entries.size();
+    std::fclose(file);
+    return written;
+}
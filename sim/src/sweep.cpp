@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include "lemlib/util.hpp"
+#include "sim/sweep.hpp"
+
+// number of segments the reference path is split into to measure path error
+constexpr int PATH_SEGMENTS = 100;
+// time spent calibrating and setting up the chassis on top of the motion, in milliseconds
+constexpr std::uint32_t SETUP_TIME = 1000;
+
+/**
+ * @brief Get the distance from a point to a line segment
+ */
+static float segmentDistance(lemlib::Pose point, lemlib::Pose a, lemlib::Pose b) {
+    const lemlib::Pose ab = b - a;
+    const float lengthSquared = ab.x * ab.x + ab.y * ab.y;
+    float t = lengthSquared == 0 ? 0 : ((point.x - a.x) * ab.x + (point.y - a.y) * ab.y) / lengthSquared;
+    t = std::clamp(t, 0.0f, 1.0f);
+    return point.distance(a + ab * t);
+}
+
+sim::MotionSweep::MotionSweep(RobotModel robot, lemlib::Drivetrain drivetrain, lemlib::OdomSensors sensors)
+    : robot(robot),
+      drivetrain(drivetrain),
+      sensors(sensors) {}
+
+std::vector<sim::SweepResult> sim::MotionSweep::run(const std::vector<lemlib::ControllerSettings>& lateral,
+                                                    const std::vector<lemlib::ControllerSettings>& angular,
+                                                    const std::vector<lemlib::MoveToPoseParams>& params,
+                                                    unsigned threads) const {
+    std::vector<SweepCase> cases;
+    for (const lemlib::ControllerSettings& lateralSettings : lateral) {
+        for (const lemlib::ControllerSettings& angularSettings : angular) {
+            for (const lemlib::MoveToPoseParams& motionParams : params)
+                cases.push_back({lateralSettings, angularSettings, motionParams});
+        }
+    }
+    // every result is overwritten by its run, but SweepResult can't be default constructed
+    std::vector<SweepResult> results;
+    for (const SweepCase& settings : cases) results.push_back({settings});
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<size_t>(threads, cases.size());
+
+    // each thread takes the next case until there are none left
+    std::atomic<size_t> next = 0;
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threads; i++) {
+        pool.emplace_back([&] {
+            for (size_t index = next++; index < cases.size(); index = next++) results[index] = runCase(cases[index]);
+        });
+    }
+    for (std::thread& thread : pool) thread.join();
+    return results;
+}
+
+sim::SweepResult sim::MotionSweep::runCase(const SweepCase& settings) const {
+    SweepResult result {settings, StopReason::FINISHED, 0, INFINITY, 0, 0, 0, 0};
+
+    // the robot is traveling backwards at the end of a backwards motion
+    const float targetHeading = lemlib::degToRad(this->target.theta);
+    const float direction = settings.params.forwards ? 1 : -1;
+    const lemlib::Pose travel(direction * std::sin(targetHeading), direction * std::cos(targetHeading));
+    // the curve moveToPose follows if the robot tracks the carrot point perfectly
+    const lemlib::Pose targetPoint(this->target.x, this->target.y);
+    const lemlib::Pose startPoint(this->start.x, this->start.y);
+    const lemlib::Pose carrot = targetPoint - travel * (settings.params.lead * startPoint.distance(targetPoint));
+    std::vector<lemlib::Pose> path;
+    for (int i = 0; i <= PATH_SEGMENTS; i++) {
+        const float t = float(i) / PATH_SEGMENTS;
+        path.push_back(startPoint * ((1 - t) * (1 - t)) + carrot * (2 * (1 - t) * t) + targetPoint * (t * t));
+    }
+
+    World world(this->robot);
+    world.getPlant().setPose(this->start);
+    // the observer and the routine run on the same world, one at a time, so they can share these
+    bool moving = false;
+    std::uint64_t motionStart = 0;
+    bool settled = false;
+    world.setObserver([&](const PlantState& state) {
+        if (!moving) return;
+        const lemlib::Pose position(state.pose.x, state.pose.y);
+        const float distance = position.distance(targetPoint);
+        const float headingError = std::fabs(lemlib::angleError(this->target.theta, state.pose.theta, false));
+        // the robot has to stay within the tolerance to be settled
+        if (distance > this->settleDistance || headingError > this->settleAngle) {
+            settled = false;
+            result.settleTime = INFINITY;
+        } else if (!settled) {
+            settled = true;
+            result.settleTime = (state.time - motionStart) / 1000.0f;
+        }
+        const lemlib::Pose offset = position - targetPoint;
+        result.overshoot = std::max(result.overshoot, offset.x * travel.x + offset.y * travel.y);
+        float pathDistance = INFINITY;
+        for (int i = 0; i < PATH_SEGMENTS; i++)
+            pathDistance = std::min(pathDistance, segmentDistance(position, path[i], path[i + 1]));
+        result.pathError = std::max(result.pathError, pathDistance);
+        result.finalError = distance;
+        result.finalHeadingError = headingError;
+    });
+
+    const std::uint32_t runTimeout = this->robot.imuCalibrationTime + this->timeout + this->holdTime + SETUP_TIME;
+    const RunResult run = world.run(
+        [&] {
+            lemlib::Chassis chassis(this->drivetrain, settings.lateral, settings.angular, this->sensors);
+            chassis.calibrate();
+            chassis.setPose(this->start);
+            motionStart = pros::micros();
+            moving = true;
+            chassis.moveToPose(this->target.x, this->target.y, this->target.theta, this->timeout, settings.params);
+            chassis.waitUntilDone();
+            result.motionTime = (pros::micros() - motionStart) / 1000;
+            pros::delay(this->holdTime);
+        },
+        runTimeout);
+    result.reason = run.reason;
+    return result;
+}
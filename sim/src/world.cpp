@@ -0,0 +1,213 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include "sim/world.hpp"
+#include "kernel.hpp"
+
+// the robot is simulated in steps no longer than this, in microseconds, and the observer is called after each one
+constexpr std::uint64_t STEP = 1000;
+
+// the task the calling thread runs, or nullptr if the thread hasn't used the PROS API yet
+static thread_local sim::HostTask* threadTask = nullptr;
+// the world of a thread that wasn't started by a world
+static thread_local std::unique_ptr<sim::World> ownWorld;
+
+sim::HostTask* sim::currentTask() {
+    if (threadTask == nullptr) {
+        ownWorld = std::make_unique<World>();
+        threadTask = ownWorld->getKernel().adopt();
+    }
+    return threadTask;
+}
+
+sim::World::Kernel::Kernel(World* world, RobotModel robot)
+    : world(world),
+      plant(robot) {}
+
+sim::HostTask* sim::World::Kernel::spawn(pros::task_fn_t function, void* parameters, std::uint32_t priority,
+                                         const char* name) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->tasks.push_back(std::make_unique<HostTask>());
+    HostTask* task = this->tasks.back().get();
+    task->kernel = this;
+    task->name = name == nullptr ? "" : name;
+    task->priority = priority;
+    task->readyOrder = ++this->readyCount;
+    // tasks created while the world stops never run
+    if (this->stopping) {
+        task->state = HostTask::State::DONE;
+        return task;
+    }
+    task->thread = std::thread([this, task, function, parameters] {
+        threadTask = task;
+        std::unique_lock<std::mutex> lock(this->mutex);
+        task->turn.wait(lock, [&] { return this->running == task || this->stopping; });
+        if (this->stopping) return;
+        lock.unlock();
+        try {
+            function(parameters);
+        } catch (const Stopped&) {
+            return;
+        }
+        lock.lock();
+        task->state = HostTask::State::DONE;
+        // the routine is over, so the rest of the tasks don't need to run
+        if (task == this->routine) this->stop(StopReason::FINISHED);
+        else if (!this->stopping) this->schedule(lock, task);
+    });
+    return task;
+}
+
+sim::HostTask* sim::World::Kernel::adopt() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->tasks.push_back(std::make_unique<HostTask>());
+    HostTask* task = this->tasks.back().get();
+    task->kernel = this;
+    task->name = "main";
+    task->priority = TASK_PRIORITY_DEFAULT;
+    this->running = task;
+    return task;
+}
+
+void sim::World::Kernel::sleepUntil(std::unique_lock<std::mutex>& lock, HostTask* self, std::uint64_t time) {
+    self->state = HostTask::State::BLOCKED;
+    self->wakeTime = time;
+    this->schedule(lock, self);
+}
+
+void sim::World::Kernel::wake(HostTask* task) {
+    if (task->state != HostTask::State::BLOCKED) return;
+    task->state = HostTask::State::READY;
+    task->wakeTime = FOREVER;
+    task->readyOrder = ++this->readyCount;
+}
+
+void sim::World::Kernel::schedule(std::unique_lock<std::mutex>& lock, HostTask* self) {
+    if (this->stopping) {
+        lock.unlock();
+        exitTask();
+        return;
+    }
+    HostTask* next = this->pickNext();
+    if (next != nullptr) {
+        this->running = next;
+        if (next != self) next->turn.notify_one();
+    }
+    if (self->state == HostTask::State::DONE) return;
+    self->turn.wait(lock, [&] { return this->running == self || this->stopping; });
+    if (this->stopping) {
+        lock.unlock();
+        exitTask();
+    }
+}
+
+sim::HostTask* sim::World::Kernel::pickNext() {
+    while (true) {
+        // the highest priority task that is ready runs, and tasks with the same priority take turns
+        HostTask* next = nullptr;
+        for (const std::unique_ptr<HostTask>& task : this->tasks) {
+            if (task->state != HostTask::State::READY) continue;
+            if (next == nullptr || task->priority > next->priority ||
+                (task->priority == next->priority && task->readyOrder < next->readyOrder))
+                next = task.get();
+        }
+        if (next != nullptr) return next;
+        // every task is blocked, so skip ahead to the next time one wakes up
+        std::uint64_t wakeTime = FOREVER;
+        for (const std::unique_ptr<HostTask>& task : this->tasks) {
+            if (task->state == HostTask::State::BLOCKED && task->wakeTime < wakeTime) wakeTime = task->wakeTime;
+        }
+        if (wakeTime == FOREVER) {
+            // a thread that wasn't started by a world has nothing to report a deadlock to
+            if (this->routine == nullptr) {
+                std::fprintf(stderr, "sim: every task is waiting forever\n");
+                std::abort();
+            }
+            this->stop(StopReason::DEADLOCK);
+            return nullptr;
+        }
+        if (wakeTime > this->deadline) {
+            this->advance(this->deadline);
+            this->stop(StopReason::TIMEOUT);
+            return nullptr;
+        }
+        this->advance(wakeTime);
+        for (const std::unique_ptr<HostTask>& task : this->tasks) {
+            if (task->state == HostTask::State::BLOCKED && task->wakeTime <= this->now) this->wake(task.get());
+        }
+    }
+}
+
+void sim::World::Kernel::advance(std::uint64_t time) {
+    while (this->now < time) {
+        // steps end on whole milliseconds, so the observer sees the robot at the same times every run
+        const std::uint64_t step = std::min(STEP - this->now % STEP, time - this->now);
+        this->plant.step(step);
+        this->now += step;
+        if (this->observer && this->now % STEP == 0) this->observer(this->plant.getState());
+    }
+}
+
+void sim::World::Kernel::stop(StopReason reason) {
+    if (this->stopping) return;
+    this->stopping = true;
+    this->reason = reason;
+    for (const std::unique_ptr<HostTask>& task : this->tasks) task->turn.notify_one();
+    this->stopped.notify_all();
+}
+
+void sim::World::Kernel::exitTask() {
+    if (std::uncaught_exceptions() == 0) throw Stopped();
+}
+
+sim::World::World(RobotModel robot)
+    : kernel(std::make_unique<Kernel>(this, robot)) {}
+
+sim::World::~World() {
+    {
+        std::unique_lock<std::mutex> lock(this->kernel->mutex);
+        this->kernel->stop(this->kernel->reason);
+    }
+    for (const std::unique_ptr<HostTask>& task : this->kernel->tasks) {
+        if (task->thread.joinable() && task->thread.get_id() != std::this_thread::get_id()) task->thread.join();
+        else if (task->thread.joinable()) task->thread.detach();
+    }
+}
+
+sim::RunResult sim::World::run(std::function<void()> routine, std::uint32_t timeout) {
+    if (this->kernel->ran) {
+        std::fprintf(stderr, "sim: a world can only run once\n");
+        return {StopReason::DEADLOCK, 0};
+    }
+    this->kernel->ran = true;
+    const std::uint64_t start = this->kernel->now;
+    this->kernel->deadline = start + std::uint64_t(timeout) * 1000;
+    this->kernel->routine = this->kernel->spawn(
+        [](void* routine) { (*static_cast<std::function<void()>*>(routine))(); }, &routine, TASK_PRIORITY_DEFAULT,
+        "routine");
+
+    std::unique_lock<std::mutex> lock(this->kernel->mutex);
+    this->kernel->running = this->kernel->pickNext();
+    this->kernel->running->turn.notify_one();
+    this->kernel->stopped.wait(lock, [&] { return this->kernel->stopping.load(); });
+    const RunResult result {this->kernel->reason, std::uint32_t((this->kernel->now - start) / 1000)};
+    lock.unlock();
+    for (const std::unique_ptr<HostTask>& task : this->kernel->tasks) {
+        if (task->thread.joinable()) task->thread.join();
+    }
+    return result;
+}
+
+void sim::World::setObserver(std::function<void(const PlantState&)> observer) {
+    std::unique_lock<std::mutex> lock(this->kernel->mutex);
+    this->kernel->observer = observer;
+}
+
+sim::DrivePlant& sim::World::getPlant() { return this->kernel->plant; }
+
+std::uint64_t sim::World::getTime() const { return this->kernel->now; }
+
+sim::World& sim::World::current() { return *currentTask()->kernel->world; }
+
+sim::World::Kernel& sim::World::getKernel() { return *this->kernel; }
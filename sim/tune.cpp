@@ -0,0 +1,45 @@
+// Sweeps the lateral kD and the lead of a moveToPose on the simulated robot, and prints how each combination did
+#include <cstdio>
+#include "lemlib/api.hpp"
+#include "sim/sweep.hpp"
+
+// the same robot as main.cpp
+pros::Motor leftFront(-1, pros::E_MOTOR_GEARSET_06), leftMiddle(-2, pros::E_MOTOR_GEARSET_06),
+    leftBack(-3, pros::E_MOTOR_GEARSET_06);
+pros::Motor rightFront(4, pros::E_MOTOR_GEARSET_06), rightMiddle(5, pros::E_MOTOR_GEARSET_06),
+    rightBack(6, pros::E_MOTOR_GEARSET_06);
+pros::MotorGroup leftMotors({leftFront, leftMiddle, leftBack});
+pros::MotorGroup rightMotors({rightFront, rightMiddle, rightBack});
+pros::Imu imu(10);
+pros::Rotation verticalEncoder(11);
+pros::Rotation horizontalEncoder(12);
+lemlib::TrackingWheel vertical(&verticalEncoder, lemlib::Omniwheel::NEW_275, -0.5);
+lemlib::TrackingWheel horizontal(&horizontalEncoder, lemlib::Omniwheel::NEW_275, -3);
+
+int main() {
+    sim::RobotModel robot;
+    robot.leftPorts = {1, 2, 3};
+    robot.rightPorts = {4, 5, 6};
+    robot.imuPort = 10;
+    robot.trackingWheels = {{sim::TrackingWheelModel::Encoder::ROTATION, 11, 2.75, -0.5, true},
+                            {sim::TrackingWheelModel::Encoder::ROTATION, 12, 2.75, -3, false}};
+    lemlib::Drivetrain drivetrain(&leftMotors, &rightMotors, 12, lemlib::Omniwheel::NEW_325, 450, 2);
+    lemlib::OdomSensors sensors(&vertical, nullptr, &horizontal, nullptr, &imu);
+
+    sim::MotionSweep sweep(robot, drivetrain, sensors);
+    sweep.target = lemlib::Pose(24, 24, 90);
+    std::vector<lemlib::ControllerSettings> lateral;
+    for (float kD = 0; kD <= 20; kD += 4) lateral.emplace_back(10, 0, kD, 3, 1, 100, 3, 500, 20);
+    const lemlib::ControllerSettings angular(2, 0, 10, 3, 1, 100, 3, 500, 0);
+    std::vector<lemlib::MoveToPoseParams> params;
+    for (float lead = 0.2; lead < 0.85; lead += 0.2) params.push_back({.lead = lead});
+
+    std::printf("%6s %6s %10s %10s %10s %10s %10s %10s\n", "kD", "lead", "motion ms", "settle ms", "overshoot",
+                "path err", "final err", "final deg");
+    for (const sim::SweepResult& result : sweep.run(lateral, {angular}, params)) {
+        std::printf("%6.1f %6.2f %10u %10.0f %10.2f %10.2f %10.2f %10.2f%s\n", result.settings.lateral.kD,
+                    result.settings.params.lead, result.motionTime, result.settleTime, result.overshoot,
+                    result.pathError, result.finalError, result.finalHeadingError,
+                    result.reason == sim::StopReason::FINISHED ? "" : "  did not finish");
+    }
+}
@@ -0,0 +1,31 @@
+#include <cstdio>
+#include "lemlib/binaryFile.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// bytes read from a file at once
+constexpr size_t CHUNK_SIZE = 512;
+
+namespace lemlib {
+std::vector<uint8_t> readFile(const std::string& path) {
+    std::vector<uint8_t> data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return data;
+    uint8_t chunk[CHUNK_SIZE];
+    size_t read;
+    while ((read = fread(chunk, 1, sizeof(chunk), file)) > 0) data.insert(data.end(), chunk, chunk + read);
+    fclose(file);
+    return data;
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& data) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        infoSink()->error("Couldn't write {}!", path);
+        return false;
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    if (!written) infoSink()->error("Couldn't write {}!", path);
+    return written;
+}
+} // namespace lemlib
@@ -0,0 +1,104 @@
+#include <cmath>
+#include <cstdio>
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/timer.hpp"
+#include "lemlib/util.hpp"
+
+// error the robot has to cross before the relay flips, so sensor noise can't flip it early. Inches
+constexpr float LATERAL_HYSTERESIS = 0.25;
+// error the robot has to cross before the relay flips, so sensor noise can't flip it early. Degrees
+constexpr float ANGULAR_HYSTERESIS = 1;
+// where the result is appended, if there is an SD card
+constexpr const char* AUTOTUNE_FILE = "/usd/autotune.txt";
+
+lemlib::AutotuneResult lemlib::Chassis::autotune(AutotuneController controller, float relayPower, int cycles,
+                                                 int timeout) {
+    this->cancelAllMotions();
+    this->resetDriveOutput();
+    const bool angular = controller == AutotuneController::ANGULAR;
+    const float hysteresis = angular ? ANGULAR_HYSTERESIS : LATERAL_HYSTERESIS;
+    relayPower = std::fabs(relayPower);
+    const Pose start = this->getPose();
+
+    float output = relayPower;
+    float maxError = -INFINITY;
+    float minError = INFINITY;
+    int risingEdges = 0;
+    uint32_t lastRise = 0;
+    float periodSum = 0;
+    float amplitudeSum = 0;
+    int measured = 0;
+    Timer timer(timeout);
+    uint32_t now = pros::millis();
+    while (!timer.isDone() && measured < cycles) {
+        // the target is where the robot started
+        const Pose pose = this->getPose();
+        float error;
+        if (angular) {
+            error = angleError(start.theta, pose.theta, false);
+        } else {
+            const float traveled = (pose.x - start.x) * std::sin(degToRad(start.theta)) +
+                                   (pose.y - start.y) * std::cos(degToRad(start.theta));
+            error = -traveled;
+        }
+        maxError = std::fmax(maxError, error);
+        minError = std::fmin(minError, error);
+
+        // flip the relay once the robot has crossed the target
+        if (output > 0 && error < -hysteresis) {
+            output = -relayPower;
+        } else if (output < 0 && error > hysteresis) {
+            output = relayPower;
+            // a cycle ends on each rising edge. The first cycle is skipped, since it starts from rest
+            const uint32_t time = pros::millis();
+            risingEdges++;
+            if (risingEdges >= 3) {
+                periodSum += time - lastRise;
+                amplitudeSum += (maxError - minError) / 2;
+                measured++;
+            }
+            lastRise = time;
+            maxError = error;
+            minError = error;
+        }
+
+        if (angular) this->setDrivePower(output, -output);
+        else this->setDrivePower(output, output);
+        pros::Task::delay_until(&now, this->controlPeriod);
+    }
+    this->setDrivePower(0, 0);
+
+    AutotuneResult result;
+    if (measured < cycles || amplitudeSum <= 0) {
+        infoSink()->error("Autotune failed, only measured {} of {} cycles. Try a higher relay power or timeout",
+                          measured, cycles);
+        return result;
+    }
+    // describing function of a relay: ultimate gain = 4 * relay / (pi * amplitude)
+    const float amplitude = amplitudeSum / measured;
+    const float period = periodSum / measured / 1000;
+    result.success = true;
+    result.ultimateGain = 4 * relayPower / (M_PI * amplitude);
+    result.ultimatePeriod = period * 1000;
+    // classic Ziegler-Nichols rules, converted to the integral and derivative per 10 ms update the PIDs use
+    const float dt = TUNED_PERIOD / 1000;
+    result.kP = 0.6 * result.ultimateGain;
+    result.kI = 1.2 * result.ultimateGain / period * dt;
+    result.kD = 0.075 * result.ultimateGain * period / dt;
+
+    const char* name = angular ? "angular" : "lateral";
+    infoSink()->info("Autotune {}: kP {}, kI {}, kD {}, ultimate gain {}, ultimate period {} ms", name, result.kP,
+                     result.kI, result.kD, result.ultimateGain, result.ultimatePeriod);
+    if (pros::usd::is_installed()) {
+        FILE* file = fopen(AUTOTUNE_FILE, "a");
+        if (file != nullptr) {
+            fprintf(file, "%s: kP %f, kI %f, kD %f, ultimate gain %f, ultimate period %f ms\n", name, result.kP,
+                    result.kI, result.kD, result.ultimateGain, result.ultimatePeriod);
+            fclose(file);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <cmath>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/leastSquares.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/util.hpp"
+
+// time between samples, in milliseconds
+constexpr uint32_t SAMPLE_PERIOD = 10;
+// time the robot rests between tests, in milliseconds
+constexpr uint32_t REST_TIME = 1000;
+// samples slower than this are skipped, since static friction doesn't follow the model, in inches per second
+constexpr float MIN_VELOCITY = 0.5;
+// weight of the newest sample in the smoothed acceleration
+constexpr float ACCELERATION_SMOOTHING = 0.3;
+
+lemlib::Feedforward lemlib::Chassis::characterize(float rampRate, float stepVoltage, uint32_t duration) {
+    this->cancelAllMotions();
+    this->resetDriveOutput();
+    // the motors are measured even with tracking wheels, so both can be compared in the log
+    TrackingWheel leftWheel(drivetrain.leftMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    TrackingWheel rightWheel(drivetrain.rightMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    // calibrate() fills in the drive motors when there are no vertical tracking wheels, so check for a real one like
+    // odom does, by the type of the wheel
+    TrackingWheel* vertical1 = this->sensors.vertical1;
+    TrackingWheel* vertical2 = this->sensors.vertical2;
+    const bool useTrackingWheels =
+        (vertical1 != nullptr && !vertical1->getType()) || (vertical2 != nullptr && !vertical2->getType());
+    LeastSquares<3> fit;
+
+    for (int test = 0; test < 4; test++) {
+        const bool dynamic = test >= 2;
+        const float direction = test % 2 == 0 ? 1 : -1;
+        float prevVelocity = 0;
+        float acceleration = 0;
+        const uint32_t start = pros::millis();
+        uint32_t now = start;
+        while (pros::millis() - start < duration) {
+            const float time = (pros::millis() - start) / 1000.0;
+            const float voltage = direction * std::fmin(dynamic ? stepVoltage : rampRate * time, 12);
+            this->sendDriveCommand(DriveSide::LEFT, std::round(voltage * 1000));
+            this->sendDriveCommand(DriveSide::RIGHT, std::round(voltage * 1000));
+            pros::Task::delay_until(&now, SAMPLE_PERIOD);
+
+            // measure how the drivetrain responded to the voltage
+            const float motorVelocity = (leftWheel.getVelocity() + rightWheel.getVelocity()) / 2;
+            const float trackingVelocity = this->odom.getState().localSpeed.y;
+            const float velocity = useTrackingWheels ? trackingVelocity : motorVelocity;
+            const float newAcceleration = (velocity - prevVelocity) / (SAMPLE_PERIOD / 1000.0);
+            acceleration = ACCELERATION_SMOOTHING * newAcceleration + (1 - ACCELERATION_SMOOTHING) * acceleration;
+            prevVelocity = velocity;
+            LEMLIB_DEBUG("Characterize: voltage {}, tracking velocity {}, motor velocity {}, acceleration {}",
+                         voltage, trackingVelocity, motorVelocity, acceleration);
+
+            // voltage = kS * sgn(velocity) + kV * velocity + kA * acceleration
+            if (std::fabs(velocity) < MIN_VELOCITY) continue;
+            fit.add({float(sgn(velocity)), velocity, acceleration}, voltage);
+        }
+        // let the robot stop before the next test
+        this->sendDriveCommand(DriveSide::LEFT, 0);
+        this->sendDriveCommand(DriveSide::RIGHT, 0);
+        pros::delay(REST_TIME);
+    }
+
+    std::array<float, 3> gains;
+    if (!fit.solve(gains)) {
+        infoSink()->error("Characterization failed, the robot didn't move. Keeping the current feedforward model");
+        return this->feedforward;
+    }
+    infoSink()->info("Characterization: kS {}, kV {}, kA {}, r squared {} over {} samples", gains[0], gains[1],
+                     gains[2], fit.rSquared(gains), fit.size());
+    this->feedforward = Feedforward(gains[0], gains[1], gains[2]);
+    return this->feedforward;
+}
@@ -1,31 +1,85 @@
+#include <algorithm>
+#include <cmath>
 #include <math.h>
+#include <type_traits>
+#include "pros/error.h"
 #include "pros/motors.h"
 #include "pros/motors.hpp"
 #include "pros/misc.hpp"
 #include "pros/rtos.h"
 #include "lemlib/logger/logger.hpp"
+#include "lemlib/matchClock.hpp"
+#include "lemlib/staticMemory.hpp"
+#include "lemlib/taskConfig.hpp"
 #include "lemlib/util.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/odom.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/path/pathCache.hpp"
 #include "pros/rtos.hpp"
 
+// how long the robot is assumed to take to stop, if the motion profile doesn't set a deceleration, in seconds
+constexpr float STOP_TIME = 0.2;
+// the voltage of the motors at full power, in millivolts
+constexpr float MAX_VOLTAGE = 12000;
+// the part of the limits of the drivetrain a time optimal turn plans with. The rest is left for the PID
+constexpr float TURN_HEADROOM = 0.85;
+// acceleration of the wheels in a time optimal turn, if there is no feedforward model or slew rate, in in/s^2
+constexpr float DEFAULT_TURN_ACCELERATION = 80;
+// acceleration of gravity, in in/s^2
+constexpr float GRAVITY = 386.09;
+// the shares of the friction of a wheel a time optimal swing uses toward the center of its arc, and along it
+constexpr float TRACTION_CENTRIPETAL = 0.8;
+constexpr float TRACTION_TANGENTIAL = 0.6;
+
 lemlib::OdomSensors::OdomSensors(TrackingWheel* vertical1, TrackingWheel* vertical2, TrackingWheel* horizontal1,
-                                 TrackingWheel* horizontal2, pros::Imu* imu)
+                                 TrackingWheel* horizontal2, pros::Imu* imu, pros::Gps* gps)
     : vertical1(vertical1),
       vertical2(vertical2),
       horizontal1(horizontal1),
       horizontal2(horizontal2),
-      imu(imu) {}
+      imu(imu),
+      gps(gps) {}
 
 lemlib::Drivetrain::Drivetrain(pros::MotorGroup* leftMotors, pros::MotorGroup* rightMotors, float trackWidth,
-                               float wheelDiameter, float rpm, float horizontalDrift)
+                               float wheelDiameter, float rpm, float horizontalDrift, PowerManager* powerManager,
+                               HolonomicDrivetrain* holonomic)
     : leftMotors(leftMotors),
       rightMotors(rightMotors),
       trackWidth(trackWidth),
       wheelDiameter(wheelDiameter),
       rpm(rpm),
-      horizontalDrift(horizontalDrift) {}
+      horizontalDrift(horizontalDrift),
+      powerManager(powerManager),
+      holonomic(holonomic) {}
+
+lemlib::DrivetrainKinematics lemlib::Drivetrain::kinematics() const {
+    return DrivetrainKinematics(this->trackWidth, this->wheelDiameter, this->rpm, this->horizontalDrift);
+}
+
+void lemlib::Drivetrain::setBrakeMode(pros::motor_brake_mode_e mode) {
+    this->setBrakeMode(DriveSide::LEFT, mode);
+    this->setBrakeMode(DriveSide::RIGHT, mode);
+}
+
+void lemlib::Drivetrain::setBrakeMode(DriveSide side, pros::motor_brake_mode_e mode) {
+    pros::motor_brake_mode_e& current = side == DriveSide::LEFT ? this->leftBrakeMode : this->rightBrakeMode;
+    // sending the mode the motors already have is a round trip to every motor for nothing
+    if (current == mode) return;
+    current = mode;
+    if (side == DriveSide::LEFT) this->leftMotors->set_brake_modes(mode);
+    else this->rightMotors->set_brake_modes(mode);
+}
+
+pros::motor_brake_mode_e lemlib::Drivetrain::getBrakeMode(DriveSide side) {
+    pros::motor_brake_mode_e& current = side == DriveSide::LEFT ? this->leftBrakeMode : this->rightBrakeMode;
+    if (current == pros::E_MOTOR_BRAKE_INVALID) {
+        pros::Motor_Group* motors = side == DriveSide::LEFT ? this->leftMotors : this->rightMotors;
+        // the first motor is read directly, so no vector is allocated
+        if (motors->size() > 0) current = (*motors)[0].get_brake_mode();
+    }
+    return current;
+}
 
 lemlib::Chassis::Chassis(Drivetrain drivetrain, ControllerSettings linearSettings, ControllerSettings angularSettings,
                          OdomSensors sensors, DriveCurve* throttleCurve, DriveCurve* steerCurve)
@@ -40,123 +94,1351 @@ lemlib::Chassis::Chassis(Drivetrain drivetrain, ControllerSettings linearSetting
       lateralLargeExit(lateralSettings.largeError, lateralSettings.largeErrorTimeout),
       lateralSmallExit(lateralSettings.smallError, lateralSettings.smallErrorTimeout),
       angularLargeExit(angularSettings.largeError, angularSettings.largeErrorTimeout),
-      angularSmallExit(angularSettings.smallError, angularSettings.smallErrorTimeout) {}
+      angularSmallExit(angularSettings.smallError, angularSettings.smallErrorTimeout) {
+    this->lateralPID.setGainSchedule(linearSettings.gainSchedule);
+    this->angularPID.setGainSchedule(angularSettings.gainSchedule);
+    this->lateralSmallExit.setVelocityExit(linearSettings.exitVelocity);
+    this->angularSmallExit.setVelocityExit(angularSettings.exitVelocity);
+    this->lateralPID.setDerivativeFilter(linearSettings.derivativeFilter);
+    this->angularPID.setDerivativeFilter(angularSettings.derivativeFilter);
+    // the motors saturate at 127, so that is where the integral stops winding up
+    if (linearSettings.antiWindup != AntiWindup::NONE) this->lateralPID.setOutputLimit(127, linearSettings.antiWindup);
+    if (angularSettings.antiWindup != AntiWindup::NONE)
+        this->angularPID.setOutputLimit(127, angularSettings.antiWindup);
+}
 
 /**
- * @brief calibrate the IMU given a sensors struct
+ * @brief calibrate the IMU, retrying if it fails
  *
- * @param sensors reference to the sensors struct
+ * @param imu the IMU
+ * @return true the IMU was calibrated
+ * @return false every attempt failed
  */
-void calibrateIMU(lemlib::OdomSensors& sensors) {
-    int attempt = 1;
-    bool calibrated = false;
+static bool calibrateIMU(pros::Imu* imu) {
     // calibrate inertial, and if calibration fails, then repeat 5 times or until successful
-    while (attempt <= 5) {
-        sensors.imu->reset();
+    for (int attempt = 1; attempt <= 5; attempt++) {
+        imu->reset();
         // wait until IMU is calibrated
         do pros::delay(10);
-        while (sensors.imu->get_status() != 0xFF && sensors.imu->is_calibrating());
+        while (imu->get_status() != 0xFF && imu->is_calibrating());
         // exit if imu has been calibrated
-        if (!isnanf(sensors.imu->get_heading()) && !isinf(sensors.imu->get_heading())) {
-            calibrated = true;
-            break;
-        }
+        if (!isnanf(imu->get_heading()) && !isinf(imu->get_heading())) return true;
         // indicate error
         pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, "---");
         lemlib::infoSink()->warn("IMU failed to calibrate! Attempt #{}", attempt);
-        attempt++;
-    }
-    // check if calibration attempts were successful
-    if (attempt > 5) {
-        sensors.imu = nullptr;
-        lemlib::infoSink()->error("IMU calibration failed, defaulting to tracking wheels / motor encoders");
     }
+    lemlib::infoSink()->error("IMU calibration failed, defaulting to tracking wheels / motor encoders");
+    return false;
 }
 
 void lemlib::Chassis::calibrate(bool calibrateImu) {
     // calibrate the IMU if it exists and the user doesn't specify otherwise
-    if (sensors.imu != nullptr && calibrateImu) calibrateIMU(sensors);
+    if (sensors.imu != nullptr && calibrateImu && !calibrateIMU(sensors.imu)) {
+        sensors.imu = nullptr;
+        this->imuState = ImuState::FAILED;
+    } else if (sensors.imu != nullptr) {
+        this->imuState = ImuState::READY;
+    }
+    this->startTracking(sensors.imu);
+    // rumble to controller to indicate success
+    pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, ".");
+}
+
+void lemlib::Chassis::calibrateAsync(void (*callback)(ImuState state, void* arg), void* arg) {
+    // claim the calibration in 1 step, so 2 callers can't both start one
+    ImuState previous = this->imuState.load();
+    do {
+        if (previous == ImuState::CALIBRATING) {
+            infoSink()->warn("The IMU is already calibrating");
+            return;
+        }
+    } while (!this->imuState.compare_exchange_weak(previous, ImuState::CALIBRATING));
+    // odometry runs without the IMU until it is calibrated
+    this->startTracking(nullptr);
+    if (sensors.imu == nullptr) {
+        this->imuState = previous;
+        pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, ".");
+        return;
+    }
+    // the last calibration has finished, so its handle can be replaced. Destroying a handle doesn't stop its task
+    this->imuTask.emplace([this, callback, arg] {
+        const bool calibrated = calibrateIMU(this->sensors.imu);
+        if (calibrated) this->odom.addImu(this->sensors.imu);
+        this->imuState = calibrated ? ImuState::READY : ImuState::FAILED;
+        if (calibrated) pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, ".");
+        if (callback != nullptr) callback(this->imuState, arg);
+    });
+}
+
+lemlib::ImuState lemlib::Chassis::getImuState() const { return this->imuState; }
+
+lemlib::ImuState lemlib::Chassis::waitForImu(uint32_t timeout) {
+    const uint32_t start = pros::millis();
+    while (this->imuState == ImuState::CALIBRATING && pros::millis() - start < timeout) pros::delay(10);
+    return this->imuState;
+}
+
+void lemlib::Chassis::startTracking(pros::Imu* imu) {
     // initialize odom
-    if (sensors.vertical1 == nullptr)
-        sensors.vertical1 = new lemlib::TrackingWheel(drivetrain.leftMotors, drivetrain.wheelDiameter,
-                                                      -(drivetrain.trackWidth / 2), drivetrain.rpm);
-    if (sensors.vertical2 == nullptr)
-        sensors.vertical2 = new lemlib::TrackingWheel(drivetrain.rightMotors, drivetrain.wheelDiameter,
-                                                      drivetrain.trackWidth / 2, drivetrain.rpm);
+    // the drive motors are used as vertical tracking wheels if there are none, and replace a vertical tracking wheel
+    // that fails. They are stored in the chassis, so calibrating again doesn't allocate
+    this->leftVertical.emplace(drivetrain.leftMotors, drivetrain.wheelDiameter, -(drivetrain.trackWidth / 2),
+                               drivetrain.rpm);
+    this->rightVertical.emplace(drivetrain.rightMotors, drivetrain.wheelDiameter, drivetrain.trackWidth / 2,
+                                drivetrain.rpm);
+    if (sensors.vertical1 == nullptr) sensors.vertical1 = &*this->leftVertical;
+    if (sensors.vertical2 == nullptr) sensors.vertical2 = &*this->rightVertical;
+    this->leftVertical->reset();
+    this->rightVertical->reset();
     sensors.vertical1->reset();
     sensors.vertical2->reset();
     if (sensors.horizontal1 != nullptr) sensors.horizontal1->reset();
     if (sensors.horizontal2 != nullptr) sensors.horizontal2->reset();
-    setSensors(sensors, drivetrain);
-    init();
-    // rumble to controller to indicate success
-    pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, ".");
+    OdomSensors odomSensors = sensors;
+    odomSensors.imu = imu;
+    odom.setSensors(odomSensors);
+    odom.setFallbackWheels(&*this->leftVertical, &*this->rightVertical);
+    odom.init();
+    // start the task that runs async motions
+    this->startMotionTask();
+#ifdef LEMLIB_STATIC_MEMORY
+    // log calls on the hot paths are copied into the preallocated queue, instead of being formatted where they are made
+    infoSink()->setDeferred(true);
+#endif
 }
 
 void lemlib::Chassis::setPose(float x, float y, float theta, bool radians) {
-    lemlib::setPose(lemlib::Pose(x, y, theta), radians);
+    this->setPose(lemlib::Pose(x, y, theta), radians);
+}
+
+void lemlib::Chassis::setPose(Pose pose, bool radians) {
+    if (!this->fieldTransform.isIdentity()) {
+        if (radians) pose.theta = radToDeg(pose.theta);
+        pose = this->fieldTransform.apply(pose);
+        if (radians) pose.theta = degToRad(pose.theta);
+    }
+    this->odom.setPose(pose, radians);
+    this->holdMoved = true;
 }
 
-void lemlib::Chassis::setPose(Pose pose, bool radians) { lemlib::setPose(pose, radians); }
+void lemlib::Chassis::setFieldTransform(FieldTransform transform) { this->fieldTransform = transform; }
+
+lemlib::FieldTransform lemlib::Chassis::getFieldTransform() const { return this->fieldTransform; }
+
+void lemlib::Chassis::applyFieldTransform(MotionCommand& command) const {
+    command.transform = this->fieldTransform;
+    if (this->fieldTransform.isIdentity()) return;
+    // motions that don't use some of these ignore them, so every field is transformed
+    const Pose target = this->fieldTransform.apply(Pose(command.x, command.y, command.theta));
+    command.x = target.x;
+    command.y = target.y;
+    command.theta = target.theta;
+    if (std::isfinite(command.blendX) && std::isfinite(command.blendY)) {
+        const Pose blend = this->fieldTransform.apply(Pose(command.blendX, command.blendY));
+        command.blendX = blend.x;
+        command.blendY = blend.y;
+    }
+    if (!this->fieldTransform.flipsHandedness()) return;
+    // in a mirrored route, turns go the other way, and swings lock the other side
+    command.lockedSide = command.lockedSide == DriveSide::LEFT ? DriveSide::RIGHT : DriveSide::LEFT;
+    std::visit(
+        [](auto& params) {
+            using Params = std::decay_t<decltype(params)>;
+            if constexpr (std::is_same_v<Params, TurnToPointParams> || std::is_same_v<Params, TurnToHeadingParams> ||
+                          std::is_same_v<Params, SwingToPointParams> ||
+                          std::is_same_v<Params, SwingToHeadingParams>) {
+                if (params.direction == AngularDirection::CW_CLOCKWISE) {
+                    params.direction = AngularDirection::CCW_COUNTERCLOCKWISE;
+                } else if (params.direction == AngularDirection::CCW_COUNTERCLOCKWISE) {
+                    params.direction = AngularDirection::CW_CLOCKWISE;
+                }
+            }
+        },
+        command.params);
+}
 
 lemlib::Pose lemlib::Chassis::getPose(bool radians, bool standardPos) {
-    Pose pose = lemlib::getPose(true);
+    Pose pose = this->odom.getPose(true);
+    if (standardPos) pose.theta = M_PI_2 - pose.theta;
+    if (!radians) pose.theta = radToDeg(pose.theta);
+    return pose;
+}
+
+lemlib::Pose lemlib::Chassis::getPredictedPose(float latency, bool radians, bool standardPos) {
+    if (latency <= 0) return this->getPose(radians, standardPos);
+    Pose pose = this->odom.estimatePose(latency / 1000, true);
     if (standardPos) pose.theta = M_PI_2 - pose.theta;
     if (!radians) pose.theta = radToDeg(pose.theta);
     return pose;
 }
 
+lemlib::Odometry& lemlib::Chassis::getOdometry() { return this->odom; }
+
 void lemlib::Chassis::waitUntil(float dist) {
-    // do while to give the thread time to start
-    do pros::delay(10);
-    while (distTraveled <= dist && distTraveled != -1);
+    // wait for the last queued motion
+    this->waitForMotion(this->motionsQueued, dist);
+}
+
+void lemlib::Chassis::waitForMotion(uint32_t id, float dist) {
+    // the motion has ended, or is running and has traveled far enough
+    this->waitFor(
+        [&] {
+            const MotionRecord* record = this->getMotionRecord(id);
+            if (record == nullptr || record->reason != MotionEndReason::NOT_DONE) return true;
+            return this->runningMotion == id && this->motionState == MotionState::RUNNING && distTraveled > dist;
+        },
+        dist);
+}
+
+template <typename F> void lemlib::Chassis::waitFor(F done, float dist) {
+    if (done()) return;
+
+    // register this task so the motion task notifies it. If every slot is taken, this task polls instead
+    const pros::task_t current = pros::c::task_get_current();
+    MotionWaiter* waiter = nullptr;
+    for (MotionWaiter& slot : this->waiters) {
+        pros::task_t expected = nullptr;
+        if (slot.task.compare_exchange_strong(expected, current)) {
+            waiter = &slot;
+            break;
+        }
+    }
+    if (waiter != nullptr) waiter->distance = dist;
+    // the timeout is a fallback, a notification normally arrives first
+    while (!done()) pros::Task::notify_take(true, 10);
+    if (waiter != nullptr) waiter->task = nullptr;
 }
 
-void lemlib::Chassis::waitUntilDone() {
-    do pros::delay(10);
-    while (distTraveled != -1);
+void lemlib::Chassis::waitUntilDone() { this->waitUntil(INFINITY); }
+
+void lemlib::Chassis::notifyWaiters(bool ended) {
+    for (MotionWaiter& waiter : this->waiters) {
+        const pros::task_t task = waiter.task;
+        if (task != nullptr && (ended || distTraveled > waiter.distance)) pros::c::task_notify(task);
+    }
 }
 
-void lemlib::Chassis::requestMotionStart() {
-    if (this->isInMotion()) this->motionQueued = true; // indicate a motion is queued
-    else this->motionRunning = true; // indicate a motion is running
+bool lemlib::Chassis::requestMotionStart() {
+    MotionState expected = MotionState::STARTING;
+    if (this->motionState.compare_exchange_strong(expected, MotionState::RUNNING)) {
+        // time triggers count from here
+        MotionRecord* record = this->getMotionRecord(this->runningMotion);
+        if (record != nullptr) record->startTime = pros::millis();
+        this->applyParameters();
+        this->resetTick();
+        this->resetDriveOutput();
+        this->blendHandedOff = false;
+        this->maxMotionSpeed = 0;
+        this->stallStart = 0;
+        this->motionStalled = false;
+        this->motionCollisions = this->collisionCount;
+        this->motionCollided = false;
+        this->motionConditionMet = false;
+        this->tipScale = 1;
+        if (this->antiTip && this->imuState == ImuState::READY) {
+            const double pitch = this->sensors.imu->get_pitch();
+            const double roll = this->sensors.imu->get_roll();
+            this->basePitch = pitch == PROS_ERR_F ? 0 : pitch;
+            this->baseRoll = roll == PROS_ERR_F ? 0 : roll;
+        }
+        return true;
+    }
+    // the motion was cancelled before it started
+    this->motionState = MotionState::IDLE;
+    return false;
+}
 
-    // wait until this motion is at front of "queue"
-    this->mutex.take(TIMEOUT_MAX);
+void lemlib::Chassis::endMotion(MotionEndReason reason) {
+    if (this->motionState == MotionState::CANCELLING) {
+        reason = MotionEndReason::CANCELLED;
+    } else if (reason == MotionEndReason::CANCELLED && this->motionPreempted()) {
+        if (this->preemptPolicy == PreemptPolicy::SUSPEND) {
+            // the motion task keeps the motion to run again, so it isn't finished
+            this->motionSuspended = true;
+            this->motionState = MotionState::IDLE;
+            return;
+        }
+        // skip the motions with a lower priority than the highest waiting one that were queued before it
+        for (size_t priority = this->motionsWaiting.size(); priority-- > 0;) {
+            if (this->motionsWaiting[priority] <= 0) continue;
+            this->dropPriority = MotionPriority(priority);
+            this->dropBefore = this->motionsQueued.load();
+            break;
+        }
+    }
+    this->finishMotion(this->runningMotion, reason);
+    this->motionState = MotionState::IDLE;
+}
 
-    // this->motionRunning should be true
-    // and this->motionQueued should be false
-    // indicating this motion is running
+lemlib::MotionEndReason lemlib::Chassis::exitReason(bool settled, bool timedOut) const {
+    if (this->motionState == MotionState::CANCELLING) return MotionEndReason::CANCELLED;
+    if (settled) return MotionEndReason::SETTLED;
+    if (this->motionStalled) return MotionEndReason::STALLED;
+    if (this->motionCollided) return MotionEndReason::COLLIDED;
+    if (this->motionConditionMet) return MotionEndReason::CONDITION_MET;
+    if (timedOut) return MotionEndReason::TIMEOUT;
+    if (this->motionPreempted()) return MotionEndReason::CANCELLED;
+    return MotionEndReason::EARLY_EXIT;
 }
 
-void lemlib::Chassis::endMotion() {
-    // move the "queue" forward 1
-    this->motionRunning = this->motionQueued;
-    this->motionQueued = false;
+lemlib::MotionHandle lemlib::Chassis::currentMotion() { return MotionHandle(this, this->runningMotion); }
 
-    // permit queued motion to run
-    this->mutex.give();
+lemlib::MotionRecord* lemlib::Chassis::getMotionRecord(uint32_t id) {
+    if (this->motionRecords == nullptr || id == 0) return nullptr;
+    MotionRecord& record = this->motionRecords[id % this->motionRecordCount];
+    return record.id == id ? &record : nullptr;
 }
 
+void lemlib::Chassis::finishMotion(uint32_t id, MotionEndReason reason) {
+    MotionRecord* record = this->getMotionRecord(id);
+    if (record == nullptr) return;
+    MotionEndReason expected = MotionEndReason::NOT_DONE;
+    if (!record->reason.compare_exchange_strong(expected, reason)) return;
+    // run the completion callbacks
+    for (MotionCallback& callback : record->callbacks) {
+        if (callback.trigger == MotionTrigger::END) this->fireCallback(callback);
+    }
+}
+
+void lemlib::Chassis::reportProgress(int pathIndex) {
+    MotionRecord* record = this->getMotionRecord(this->runningMotion);
+    if (record != nullptr) {
+        record->progress = distTraveled;
+        const uint32_t elapsed = pros::millis() - record->startTime;
+        // run the callbacks whose trigger was reached
+        for (MotionCallback& callback : record->callbacks) {
+            if (callback.state != MotionCallback::READY) continue;
+            bool reached = false;
+            switch (callback.trigger) {
+                case MotionTrigger::PROGRESS: reached = distTraveled > callback.threshold; break;
+                case MotionTrigger::PATH_INDEX: reached = pathIndex >= callback.threshold; break;
+                case MotionTrigger::TIME: reached = elapsed >= callback.threshold; break;
+                case MotionTrigger::END:
+                case MotionTrigger::COLLISION:
+                case MotionTrigger::CONDITION: break;
+            }
+            if (reached) this->fireCallback(callback);
+        }
+    }
+    this->notifyWaiters();
+}
+
+void lemlib::Chassis::fireCallback(MotionCallback& callback) {
+    uint8_t state = MotionCallback::READY;
+    if (!callback.state.compare_exchange_strong(state, MotionCallback::FIRED)) return;
+    if (!callback.deferred) {
+        callback.callback(callback.arg);
+        return;
+    }
+    // hand the callback to the callback task, so the motion loop isn't blocked
+    if (!this->callbackQueue->push({callback.callback, callback.arg})) {
+        infoSink()->warn("Callback queue is full, running a deferred callback on the motion task");
+        callback.callback(callback.arg);
+        return;
+    }
+    this->callbackTask->notify();
+}
+
+bool lemlib::Chassis::motionRunning() const {
+    return this->motionState == MotionState::RUNNING && !this->motionPreempted() && !this->motionStalled &&
+           !this->motionCollided && !this->motionConditionMet;
+}
+
+bool lemlib::Chassis::onMotionTask() {
+    return this->motionTask != nullptr && pros::c::task_get_current() == static_cast<pros::task_t>(*this->motionTask);
+}
+
+void lemlib::Chassis::resetTick() {
+    this->lastTick = 0;
+    this->tickTime = pros::micros();
+    this->tickDeadline = pros::millis();
+    this->tickSequence = this->odom.getSequence();
+    this->tickScale = float(this->controlPeriod) / TUNED_PERIOD;
+    this->lateralPID.setTimeStep(this->tickScale);
+    this->angularPID.setTimeStep(this->tickScale);
+}
+
+void lemlib::Chassis::waitForTick() {
+    const uint32_t period = this->controlPeriod;
+    // time since this iteration woke up
+    const uint32_t compute = pros::micros() - this->tickTime;
+    if (this->odom.getTiming().period == period) {
+        // phase-lock to odometry. Give up after 2 periods, so motions still run if odometry has stopped. A pose
+        // published while this iteration ran is used right away, instead of waiting for the one after it
+        const uint32_t start = pros::millis();
+        while (this->motionRunning()) {
+            const uint32_t elapsed = pros::millis() - start;
+            if (elapsed >= period * 2 || this->odom.waitForUpdateAfter(this->tickSequence, period * 2 - elapsed))
+                break;
+        }
+        this->tickDeadline = pros::millis();
+    } else {
+        // odometry runs at a different rate, so run on a fixed schedule that doesn't drift
+        pros::Task::delay_until(&this->tickDeadline, period);
+    }
+    this->tickSequence = this->odom.getSequence();
+    // the motion has set up, so the rest of it must not allocate
+    beginHotPath();
+    // tuning changes are applied between iterations, so an iteration never sees half of one
+    this->applyParameters();
+    // measure the real period, so the controllers can be scaled by it
+    const uint64_t now = pros::micros();
+    uint32_t lateness = 0;
+    if (this->lastTick != 0) {
+        const float dt = (now - this->lastTick) / 1000.0;
+        this->tickScale = std::clamp(dt, period * 0.5f, period * 2.0f) / TUNED_PERIOD;
+        const uint64_t due = this->lastTick + period * 1000;
+        if (now > due) lateness = now - due;
+    }
+    this->loopProfilers[size_t(this->profiledMotion)].record(compute, lateness, period * 1000);
+    this->motionMonitor.record(compute, compute > period * 1000);
+    this->lastTick = now;
+    this->tickTime = now;
+    this->lateralPID.setTimeStep(this->tickScale);
+    this->angularPID.setTimeStep(this->tickScale);
+    if (this->motionLog.load(std::memory_order_relaxed) != nullptr)
+        this->maxMotionSpeed = std::max(this->maxMotionSpeed, std::fabs(this->odom.getLocalSpeed().y));
+    if (this->stallDetection) this->checkStall();
+    if (this->antiTip) this->updateTipScale();
+    if (this->collisionDetection) this->checkCollision();
+    // checked last, so the conditions see the sensors as fresh as the rest of the iteration does
+    MotionRecord* record = this->getMotionRecord(this->runningMotion);
+    if (record != nullptr && exitConditionMet(*record)) this->motionConditionMet = true;
+    // stream the state of the robot once per iteration of the motion loop, if odometry has published a new one
+    if (binaryTelemetry().isEnabled(TelemetryChannel::ODOM) && this->telemetrySequence != this->tickSequence) {
+        this->telemetrySequence = this->tickSequence;
+        const Pose pose = this->getPose();
+        const Pose speed = this->odom.getLocalSpeed(true);
+        binaryTelemetry().sendPose(pose.x, pose.y, pose.theta);
+        binaryTelemetry().sendVelocity(speed.y, speed.theta);
+    }
+    if (binaryTelemetry().isEnabled(TelemetryChannel::PID)) {
+        const PID::Terms& lateral = this->lateralPID.getTerms();
+        const PID::Terms& angular = this->angularPID.getTerms();
+        binaryTelemetry().sendPid(0, lateral.error, lateral.p, lateral.i, lateral.d);
+        binaryTelemetry().sendPid(1, angular.error, angular.p, angular.i, angular.d);
+    }
+    // the pose stream decides for itself whether the pose changed enough to send
+    if (poseStream().isEnabled()) poseStream().update(this->getPose(), pros::millis());
+}
+
+void lemlib::Chassis::setControlPeriod(uint32_t period) {
+    this->odom.setUpdatePeriod(period);
+    // odometry clamps the period to what the sensors can do
+    this->controlPeriod = this->odom.getTiming().period;
+}
+
+uint32_t lemlib::Chassis::getControlPeriod() { return this->controlPeriod; }
+
+lemlib::LoopProfiler& lemlib::Chassis::getLoopProfiler(MotionType type) { return this->loopProfilers[size_t(type)]; }
+
+void lemlib::Chassis::setMotionTrace(MotionTrace* trace) { this->motionTrace = trace; }
+
+void lemlib::Chassis::setMotionLog(MotionLog* log) { this->motionLog = log; }
+
+void lemlib::Chassis::setFlightRecorder(FlightRecorder* recorder) {
+    this->flightRecorder = recorder;
+    this->odom.setFlightRecorder(recorder);
+}
+
+void lemlib::Chassis::trace(MotionSample& sample) {
+    MotionTrace* trace = this->motionTrace.load(std::memory_order_relaxed);
+    FlightRecorder* recorder = this->flightRecorder.load(std::memory_order_relaxed);
+    const bool stream = binaryTelemetry().isEnabled(TelemetryChannel::MOTION);
+    if (trace == nullptr && recorder == nullptr && !stream) return;
+    sample.time = this->tickTime / 1000;
+    sample.type = this->profiledMotion;
+    if (trace != nullptr) trace->record(sample);
+    if (recorder != nullptr) recorder->recordMotion(sample);
+    if (stream && binaryTelemetry().isDue(TelemetryChannel::MOTION)) {
+        uint8_t payload[MotionSample::PACKED_SIZE];
+        sample.pack(payload);
+        binaryTelemetry().sendFrame(TelemetryType::MOTION, payload, sizeof(payload), sample.time);
+    }
+}
+
+void lemlib::Chassis::startMotionTask() {
+    if (this->motionTask != nullptr) return;
+    this->motionQueues[size_t(MotionPriority::NORMAL)] = new BoundedQueue<MotionCommand>(this->motionQueueDepth);
+    this->motionQueues[size_t(MotionPriority::ELEVATED)] = new BoundedQueue<MotionCommand>(PRIORITY_QUEUE_DEPTH);
+    this->motionQueues[size_t(MotionPriority::URGENT)] = new BoundedQueue<MotionCommand>(PRIORITY_QUEUE_DEPTH);
+    // enough records for every motion that can be queued or suspended, twice over
+    size_t inFlight = this->suspendedMotions.size();
+    for (BoundedQueue<MotionCommand>* queue : this->motionQueues) inFlight += queue->capacity();
+    this->motionRecordCount = inFlight * 2;
+    this->motionRecords = new MotionRecord[this->motionRecordCount];
+    const TaskSettings settings = getTaskConfig().motion;
+    // setMotionStackSize overrides the configured stack
+    if (this->motionStackSize == 0) this->motionStackSize = settings.stackSize;
+    this->motionTask = new pros::Task {[this] {
+        MotionCommand command {MotionType::FOLLOW};
+        while (true) {
+            // sleep until a motion is queued, holding the robot where the last motion left it
+            if (!this->holdPose()) pros::Task::notify_take(true, TIMEOUT_MAX);
+            // whether a motion drove the robot, so it is held where the motion left it
+            bool moved = false;
+            while (true) {
+                // set before the motion is taken from the queue, so cancelMotion can't miss a motion that is starting
+                this->motionState = MotionState::STARTING;
+                if (!this->nextMotion(command)) break;
+                // skip motions that were queued before cancelAllMotions was called, or dropped by a preempting motion
+                const bool dropped = command.id <= this->dropBefore && command.priority < this->dropPriority;
+                // motions that would start after the deadline are skipped, and the rest time out at it
+                const uint32_t deadline = this->motionDeadline;
+                const bool late = deadline != 0 && int32_t(pros::millis() - deadline) >= 0;
+                if (late && command.generation == this->cancelGeneration && !dropped)
+                    infoSink()->warn("Motion {} was skipped, since it would start after the deadline", command.id);
+                if (command.generation == this->cancelGeneration && !dropped && !late) {
+                    if (deadline != 0) command.timeout = std::min(command.timeout, int(deadline - pros::millis()));
+                    this->runningMotion = command.id;
+                    this->runningPriority = command.priority;
+                    this->runMotion(command);
+                    moved = true;
+                    if (!this->motionSuspended) this->summarizeMotion(command);
+                    // the motion may only allocate before its first tick, and the code between motions may allocate
+                    endHotPath();
+                    this->runningPriority = MotionPriority::NORMAL;
+                    // a suspended motion runs again after the motions that preempted it, so it hasn't finished
+                    if (this->motionSuspended) {
+                        this->motionSuspended = false;
+                        if (this->suspendedCount < this->suspendedMotions.size()) {
+                            this->suspendedMotions[this->suspendedCount++] = command;
+                            continue;
+                        }
+                        infoSink()->warn("Too many motions are suspended, so motion {} was dropped", command.id);
+                    }
+                }
+                // motions that were skipped, or cancelled before they started, end here
+                this->finishMotion(command.id, MotionEndReason::CANCELLED);
+                this->motionsFinished++;
+                this->notifyWaiters(true);
+            }
+            // a blended segment left the drivetrain running, but the motion after it was cancelled
+            if (this->blendHandedOff) {
+                this->blendHandedOff = false;
+                this->setDrivePower(0, 0);
+            }
+            this->motionState = MotionState::IDLE;
+            if (moved && this->poseHold) {
+                this->holdTarget = this->getPose(true, true);
+                this->holdPeriodStart = matchClock().getPeriodStart();
+                this->holdMoved = false;
+                this->holdArmed = true;
+            }
+            // wake tasks waiting for a motion that was cancelled before it started
+            this->notifyWaiters(true);
+        }
+    }, settings.priority, this->motionStackSize};
+    this->prepareQueue = new BoundedQueue<MotionCommand>(this->motionQueueDepth);
+    // runs below the motion task, so it only uses time the motion loops leave idle. Mutexes inherit priority, so the
+    // motion task can't be stuck behind it for long if it needs a path that is being loaded
+    this->prepareTask = new pros::Task {[this] {
+        MotionCommand command {MotionType::FOLLOW};
+        while (true) {
+            // sleep until a path motion is queued
+            pros::Task::notify_take(true, TIMEOUT_MAX);
+            while (this->prepareQueue->pop(command)) {
+                // the motion was cancelled, so its path isn't needed
+                if (command.generation != this->cancelGeneration) continue;
+                const uint64_t start = pros::micros();
+                if (command.type == MotionType::TRAJECTORY) {
+                    pathCache().getTrajectory(command.path, command.forwards, this->trajectoryConstraints(),
+                                              command.transform);
+                } else {
+                    pathCache().get(command.path, command.transform);
+                }
+                this->prepareMonitor.record(pros::micros() - start);
+            }
+        }
+    }, TASK_PRIORITY_DEFAULT - 1};
+    this->callbackQueue = new BoundedQueue<DeferredCallback>(CALLBACK_QUEUE_DEPTH);
+    this->callbackTask = new pros::Task {[this] {
+        DeferredCallback callback;
+        while (true) {
+            // sleep until a deferred callback is reached
+            pros::Task::notify_take(true, TIMEOUT_MAX);
+            while (this->callbackQueue->pop(callback)) {
+                const uint64_t start = pros::micros();
+                callback.callback(callback.arg);
+                this->callbackMonitor.record(pros::micros() - start);
+            }
+        }
+    }};
+    this->motionMonitor.attach(*this->motionTask, this->motionStackSize);
+    this->prepareMonitor.attach(*this->prepareTask);
+    this->callbackMonitor.attach(*this->callbackTask);
+}
+
+lemlib::MotionHandle lemlib::Chassis::queueMotion(MotionCommand command) {
+    this->startMotionTask();
+    // the motion will wait for the next odometry update, so don't make it wait for an idle one
+    this->odom.wake();
+    // path motions have no priority in their parameters, so they are always NORMAL
+    command.priority = std::visit(
+        [](const auto& params) {
+            using Params = std::decay_t<decltype(params)>;
+            if constexpr (std::is_same_v<Params, std::monostate> || std::is_same_v<Params, FollowParams>) {
+                return MotionPriority::NORMAL;
+            } else {
+                return params.priority;
+            }
+        },
+        command.params);
+    // targets are transformed once, here, so motions run in field coordinates
+    this->applyFieldTransform(command);
+    command.generation = this->cancelGeneration;
+    command.id = ++this->motionsQueued;
+    // reset the record of the motion. The id is written last, so handles to the old motion stop using it first
+    MotionRecord& record = this->motionRecords[command.id % this->motionRecordCount];
+    record.id = 0;
+    record.progress = 0;
+    record.startTime = 0;
+    record.reason = MotionEndReason::NOT_DONE;
+    for (MotionCallback& callback : record.callbacks) callback.state = MotionCallback::EMPTY;
+    record.id = command.id;
+    // the queue is only full if the user queues more motions than the queue depth
+    BoundedQueue<MotionCommand>& queue = *this->motionQueues[size_t(command.priority)];
+    if (!queue.push(command)) {
+        infoSink()->warn("Motion queue is full, waiting for a motion to finish. Use setMotionQueueDepth to queue more");
+        while (!queue.push(command)) pros::delay(10);
+    }
+    // the running motion sees this on its next check, and the notification below wakes it if it is waiting for a tick
+    this->motionsWaiting[size_t(command.priority)]++;
+    this->motionTask->notify();
+    // load the path while the motions ahead of it run. If the queue is full, the motion loads it when it starts
+    const bool pathMotion = command.type == MotionType::FOLLOW || command.type == MotionType::TRAJECTORY;
+    if (pathMotion && command.path.buf != nullptr && this->prepareQueue->push(command)) this->prepareTask->notify();
+    return MotionHandle(this, command.id);
+}
+
+void lemlib::Chassis::setMotionQueueDepth(size_t depth) {
+    if (this->motionTask != nullptr) {
+        infoSink()->warn("The motion queue depth can't be changed after the chassis is calibrated");
+        return;
+    }
+    this->motionQueueDepth = depth;
+}
+
+bool lemlib::Chassis::nextMotion(MotionCommand& command) {
+    for (size_t priority = this->motionQueues.size(); priority-- > 0;) {
+        // the last suspended motion has the highest priority, and was running before anything in its queue
+        if (this->suspendedCount > 0 && size_t(this->suspendedMotions[this->suspendedCount - 1].priority) == priority) {
+            command = this->suspendedMotions[--this->suspendedCount];
+            return true;
+        }
+        if (this->motionQueues[priority]->pop(command)) {
+            this->motionsWaiting[priority]--;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool lemlib::Chassis::motionPreempted() const {
+    const size_t running = size_t(this->runningPriority.load());
+    for (size_t priority = running + 1; priority < this->motionsWaiting.size(); priority++) {
+        if (this->motionsWaiting[priority] > 0) return true;
+    }
+    return false;
+}
+
+void lemlib::Chassis::setPreemptPolicy(PreemptPolicy policy) { this->preemptPolicy = policy; }
+
+void lemlib::Chassis::setMotionDeadline(uint32_t deadline) { this->motionDeadline = deadline; }
+
+uint32_t lemlib::Chassis::getMotionDeadline() const { return this->motionDeadline; }
+
+void lemlib::Chassis::setMotionStackSize(uint16_t words) {
+    if (this->motionTask != nullptr) {
+        infoSink()->warn("The motion stack size can't be changed after the chassis is calibrated");
+        return;
+    }
+    this->motionStackSize = words;
+}
+
+void lemlib::Chassis::runMotion(const MotionCommand& command) {
+    this->profiledMotion = command.type;
+    switch (command.type) {
+        case MotionType::TURN_TO_POINT:
+            this->turnToPoint(command.x, command.y, command.timeout, std::get<TurnToPointParams>(command.params),
+                              false);
+            break;
+        case MotionType::TURN_TO_HEADING:
+            this->turnToHeading(command.theta, command.timeout, std::get<TurnToHeadingParams>(command.params), false);
+            break;
+        case MotionType::SWING_TO_POINT:
+            this->swingToPoint(command.x, command.y, command.lockedSide, command.timeout,
+                               std::get<SwingToPointParams>(command.params), false);
+            break;
+        case MotionType::SWING_TO_HEADING:
+            this->swingToHeading(command.theta, command.lockedSide, command.timeout,
+                                 std::get<SwingToHeadingParams>(command.params), false);
+            break;
+        case MotionType::MOVE_TO_POSE:
+            this->moveToPose(command.x, command.y, command.theta, command.timeout,
+                             std::get<MoveToPoseParams>(command.params), false);
+            break;
+        case MotionType::MOVE_TO_POINT:
+            this->blendX = command.blendX;
+            this->blendY = command.blendY;
+            this->blendRadius = command.blendRadius;
+            this->moveToPoint(command.x, command.y, command.timeout, std::get<MoveToPointParams>(command.params),
+                              false);
+            break;
+        case MotionType::FOLLOW: {
+            const FollowParams params = std::get<FollowParams>(command.params);
+            if (command.pathData != nullptr) {
+                this->follow(*command.pathData, command.lookahead, command.timeout, command.forwards, false,
+                             command.deadline, params);
+            } else if (command.view.size() != 0) {
+                this->follow(command.view, command.lookahead, command.timeout, command.forwards, false,
+                             command.deadline, params);
+            } else if (command.spline != nullptr) {
+                this->follow(*command.spline, command.lookahead, command.timeout, command.forwards, false,
+                             command.deadline, params);
+            } else {
+                // the path asset in the field coordinates the motion was queued with
+                this->follow(pathCache().get(command.path, command.transform), command.lookahead, command.timeout,
+                             command.forwards, false, command.deadline, params);
+            }
+            break;
+        }
+        case MotionType::TRAJECTORY:
+            if (command.trajectory != nullptr) {
+                this->followTrajectory(*command.trajectory, command.timeout, false);
+            } else {
+                const Trajectory& trajectory = pathCache().getTrajectory(
+                    command.path, command.forwards, this->trajectoryConstraints(), command.transform);
+                this->followTrajectory(trajectory, command.timeout, false);
+            }
+            break;
+        case MotionType::MACRO:
+            this->runMacro(*command.macro, std::get<MacroParams>(command.params), command.transform);
+            break;
+    }
+}
+
+void lemlib::Chassis::summarizeMotion(const MotionCommand& command) {
+    MotionLog* log = this->motionLog.load(std::memory_order_relaxed);
+    const MotionRecord* record = this->getMotionRecord(command.id);
+    // motions that were cancelled before they started have no summary
+    if (log == nullptr || record == nullptr || record->startTime == 0) return;
+    MotionSummary summary;
+    summary.type = command.type;
+    summary.reason = record->reason;
+    summary.startTime = record->startTime;
+    summary.duration = pros::millis() - record->startTime;
+    summary.maxSpeed = this->maxMotionSpeed;
+    const Pose pose = this->getPose();
+    switch (command.type) {
+        case MotionType::TURN_TO_POINT:
+        case MotionType::SWING_TO_POINT: {
+            const bool forwards = command.type == MotionType::TURN_TO_POINT
+                                      ? std::get<TurnToPointParams>(command.params).forwards
+                                      : std::get<SwingToPointParams>(command.params).forwards;
+            summary.targetX = command.x;
+            summary.targetY = command.y;
+            const float facing = radToDeg(M_PI_2 - std::atan2(command.y - pose.y, command.x - pose.x));
+            summary.angularError = std::fabs(angleError(forwards ? facing : facing + 180, pose.theta, false));
+            break;
+        }
+        case MotionType::TURN_TO_HEADING:
+        case MotionType::SWING_TO_HEADING:
+            summary.targetTheta = command.theta;
+            summary.angularError = std::fabs(angleError(command.theta, pose.theta, false));
+            break;
+        case MotionType::MOVE_TO_POSE:
+            summary.targetTheta = command.theta;
+            summary.angularError = std::fabs(angleError(command.theta, pose.theta, false));
+            [[fallthrough]];
+        case MotionType::MOVE_TO_POINT:
+            summary.targetX = command.x;
+            summary.targetY = command.y;
+            summary.lateralError = pose.distance(Pose(command.x, command.y));
+            break;
+        case MotionType::FOLLOW:
+        case MotionType::TRAJECTORY:
+            // paths are followed in field coordinates, so their end is set by the motion
+            summary.targetX = this->pathEnd.x;
+            summary.targetY = this->pathEnd.y;
+            summary.lateralError = pose.distance(this->pathEnd);
+            this->pathEnd = Pose(NAN, NAN);
+            break;
+        case MotionType::MACRO:
+            // the end of the macro is set by the motion, like a path
+            summary.targetX = this->pathEnd.x;
+            summary.targetY = this->pathEnd.y;
+            summary.targetTheta = this->pathEnd.theta;
+            summary.lateralError = pose.distance(this->pathEnd);
+            summary.angularError = std::fabs(angleError(this->pathEnd.theta, pose.theta, false));
+            this->pathEnd = Pose(NAN, NAN);
+            break;
+    }
+    log->record(summary);
+}
+
+float lemlib::Chassis::updateAngularPID(float error) {
+    if (!this->angularSettings.gyroDerivative || this->imuState != ImuState::READY)
+        return this->angularPID.update(error);
+    // the gyro z axis is counterclockwise positive, but heading is clockwise positive
+    const float rate = -this->sensors.imu->get_gyro_rate().z;
+    // fall back to the change in error if the gyro couldn't be read
+    if (!std::isfinite(rate)) return this->angularPID.update(error);
+    // derivative on measurement: the error changes by the negative of the change in heading each update
+    return this->angularPID.update(error, -rate * this->tickScale * TUNED_PERIOD / 1000);
+}
+
+float lemlib::Chassis::trackProfile(std::optional<MotionProfile>& profile, const ControllerSettings& settings,
+                                    float error, uint32_t time, ProfileState& setpoint) {
+    setpoint = ProfileState();
+    if (settings.maxVelocity <= 0 || settings.maxAcceleration <= 0) return error;
+    if (profile == std::nullopt) {
+        // hot motors plan a gentler profile, so they draw less current before the firmware limits it
+        const float scale = this->thermalScale();
+        profile = MotionProfile(error, settings.maxVelocity * scale, settings.maxAcceleration * scale,
+                                settings.maxJerk * scale);
+    }
+    // the setpoint is the target minus the distance the profile has left to travel
+    setpoint = profile->sample(time / 1000.0);
+    return error - (profile->getDistance() - setpoint.position);
+}
+
+lemlib::ControllerSettings lemlib::Chassis::turnProfileSettings(float maxSpeed, bool timeOptimal, float radius,
+                                                               float traction) {
+    ControllerSettings settings = this->angularSettings;
+    if (!timeOptimal || (settings.maxVelocity > 0 && settings.maxAcceleration > 0)) return settings;
+    const float topSpeed = this->drivetrain.kinematics().topSpeed;
+    float wheelSpeed = topSpeed * TURN_HEADROOM * std::fabs(maxSpeed) / 127;
+    float wheelAcceleration = DEFAULT_TURN_ACCELERATION;
+    if (this->feedforward.isEnabled() && this->feedforward.kA > 0) {
+        // the voltage left for accelerating shrinks as the wheels speed up, so plan with what is left halfway
+        const float voltage = MAX_VOLTAGE / 1000 * TURN_HEADROOM - this->feedforward.kS -
+                              this->feedforward.kV * wheelSpeed / 2;
+        if (voltage > 0) wheelAcceleration = voltage / this->feedforward.kA;
+    } else if (settings.slew > 0) {
+        // the slew rate is the most power the output can change by every 10 ms
+        wheelAcceleration = settings.slew * topSpeed / 127 * 100;
+    }
+    if (traction > 0) {
+        // friction is shared between the acceleration toward the center of the arc at full speed, and the
+        // acceleration along it. The shares are 0.8 and 0.6, so together they never exceed the friction
+        const float friction = traction * GRAVITY;
+        wheelSpeed = std::fmin(wheelSpeed, std::sqrt(TRACTION_CENTRIPETAL * friction * radius));
+        wheelAcceleration = std::fmin(wheelAcceleration, TRACTION_TANGENTIAL * friction);
+    }
+    settings.maxVelocity = radToDeg(wheelSpeed / radius);
+    settings.maxAcceleration = radToDeg(wheelAcceleration / radius);
+    settings.maxJerk = 0;
+    return settings;
+}
+
+float lemlib::Chassis::feedforwardPower(float velocity, float acceleration) {
+    if (!this->feedforward.isEnabled()) return 0;
+    // convert from volts to the -127 to 127 scale
+    return this->feedforward.calculate(velocity, acceleration) * 127 / (MAX_VOLTAGE / 1000);
+}
+
+float lemlib::Chassis::velocityPower(DriveSide side, float velocity, float acceleration) {
+    const float power = this->feedforwardPower(velocity, acceleration);
+    if (!this->velocityControl) return power;
+    PID& pid = side == DriveSide::LEFT ? this->leftVelocityPID : this->rightVelocityPID;
+    // a side asked to stand still is left to the outer loop of the motion, so the velocity loop doesn't damp it
+    // while it settles on the target
+    if (velocity == 0 && acceleration == 0) {
+        pid.reset();
+        return power;
+    }
+    TrackingWheel& wheel = side == DriveSide::LEFT ? *this->leftDriveWheel : *this->rightDriveWheel;
+    pid.setTimeStep(this->tickScale);
+    return power + pid.update(velocity - wheel.getVelocity());
+}
+
+float lemlib::Chassis::tickDuration() const { return this->tickScale * TUNED_PERIOD / 1000; }
+
+void lemlib::Chassis::updateSmallExit(ExitCondition& exit, const ControllerSettings& settings, float error,
+                                      float speed) {
+    if (settings.exitVelocity <= 0) {
+        exit.update(error, this->tickTime);
+        return;
+    }
+    const float stopTime = settings.maxAcceleration > 0 ? std::fabs(speed) / settings.maxAcceleration : STOP_TIME;
+    // decelerating evenly to a stop covers half the distance of holding the speed, the same extrapolation
+    // estimatePose does at half the stop time
+    exit.update(error, speed, error - speed * stopTime / 2, this->tickTime);
+}
+
+void lemlib::Chassis::setFeedforward(Feedforward feedforward) { this->feedforward = feedforward; }
+
+lemlib::Feedforward lemlib::Chassis::getFeedforward() { return this->feedforward; }
+
+void lemlib::Chassis::setAdaptiveLookahead(std::optional<AdaptiveLookahead> settings) {
+    this->adaptiveLookahead = settings;
+}
+
+void lemlib::Chassis::setFollowLatencyCompensation(float ms) { this->followLatency = ms; }
+
 void lemlib::Chassis::cancelMotion() {
-    this->motionRunning = false;
-    pros::delay(10); // give time for motion to stop
+    // cancel the running motion, or the motion that is being taken from the queue
+    MotionState state = this->motionState;
+    while ((state == MotionState::STARTING || state == MotionState::RUNNING) &&
+           !this->motionState.compare_exchange_weak(state, MotionState::CANCELLING));
+    if (this->motionState != MotionState::CANCELLING || this->onMotionTask()) return;
+    // interrupt the motion while it waits for odometry, so it stops now instead of on the next tick
+    this->motionTask->notify();
+    // wait until the motion has stopped the drivetrain and ended
+    this->waitFor([this] { return this->motionState != MotionState::CANCELLING; }, INFINITY);
 }
 
 void lemlib::Chassis::cancelAllMotions() {
-    this->motionRunning = false;
-    this->motionQueued = false;
-    pros::delay(10); // give time for motion to stop
+    // motions queued before this are skipped by the motion task, even if it already took them from the queue
+    this->cancelGeneration++;
+    this->cancelMotion();
 }
 
-bool lemlib::Chassis::isInMotion() const { return this->motionRunning; }
+bool lemlib::Chassis::isInMotion() const { return this->motionsFinished != this->motionsQueued; }
 
 void lemlib::Chassis::resetLocalPosition() {
     float theta = this->getPose().theta;
-    lemlib::setPose(lemlib::Pose(0, 0, theta), false);
+    this->odom.setPose(lemlib::Pose(0, 0, theta), false);
 }
 
 void lemlib::Chassis::setBrakeMode(pros::motor_brake_mode_e mode) {
-    drivetrain.leftMotors->set_brake_modes(mode);
-    drivetrain.rightMotors->set_brake_modes(mode);
+    this->drivetrain.setBrakeMode(mode);
+}
+
+void lemlib::Chassis::setDrivePower(float left, float right) {
+    if (this->drivetrain.powerManager != nullptr) {
+        // desaturate to the power the budget allows, so both sides keep their ratio and the robot its arc
+        const float limit = 127 * this->drivetrain.powerManager->getScale(this->drivetrain.leftMotors,
+                                                                          this->drivetrain.rightMotors);
+        const float largest = std::fmax(std::fabs(left), std::fabs(right));
+        if (largest > limit) {
+            left *= limit / largest;
+            right *= limit / largest;
+        }
+    }
+    if (this->traction) this->controlTraction(left, right);
+    // read the motors while they are driven, so the temperature estimate keeps up between motions
+    if (this->thermalModel) this->thermalModel->getScale();
+    if (binaryTelemetry().isEnabled(TelemetryChannel::MOTORS)) binaryTelemetry().sendMotorOutput(left, right);
+    this->setDrivePower(DriveSide::LEFT, left);
+    this->setDrivePower(DriveSide::RIGHT, right);
+}
+
+void lemlib::Chassis::setDrivePower(DriveSide side, float power) {
+    if (this->drivetrain.powerManager != nullptr) {
+        const float limit = 127 * this->drivetrain.powerManager->getScale(this->drivetrain.leftMotors,
+                                                                          this->drivetrain.rightMotors);
+        power = std::clamp(power, -limit, limit);
+    }
+    // convert from the -127 to 127 scale of move() to millivolts
+    const float voltage = std::clamp(power, -127.0f, 127.0f) * MAX_VOLTAGE / 127;
+    this->sendDriveCommand(side, std::round(voltage));
+}
+
+lemlib::WheelPowers lemlib::Chassis::setHolonomicPower(float forward, float strafe, float turn, float maxPower) {
+    if (this->drivetrain.powerManager != nullptr) {
+        // the sides hold the same motors as the wheels
+        maxPower = std::fmin(maxPower, 127 * this->drivetrain.powerManager->getScale(this->drivetrain.leftMotors,
+                                                                                      this->drivetrain.rightMotors));
+    }
+    const WheelPowers powers = HolonomicDrivetrain::inverseKinematics(forward, strafe, turn, maxPower);
+    if (this->thermalModel) this->thermalModel->getScale();
+    if (binaryTelemetry().isEnabled(TelemetryChannel::MOTORS)) {
+        binaryTelemetry().sendMotorOutput((powers.frontLeft + powers.backLeft) / 2,
+                                          (powers.frontRight + powers.backRight) / 2);
+    }
+    WheelPowers sent = powers;
+    if (this->batteryCompensation) {
+        const float scale = this->batteryScale();
+        for (float* power : {&sent.frontLeft, &sent.frontRight, &sent.backLeft, &sent.backRight}) *power *= scale;
+    }
+    this->drivetrain.holonomic->move(sent);
+    // the motors of the sides were sent other commands, so the next command to each side is sent even if it matches
+    this->leftCommand = NO_COMMAND;
+    this->rightCommand = NO_COMMAND;
+    return powers;
+}
+
+void lemlib::Chassis::makeDriveWheels() {
+    if (this->leftDriveWheel) return;
+    this->leftDriveWheel.emplace(this->drivetrain.leftMotors, this->drivetrain.wheelDiameter, 0, this->drivetrain.rpm);
+    this->rightDriveWheel.emplace(this->drivetrain.rightMotors, this->drivetrain.wheelDiameter, 0,
+                                  this->drivetrain.rpm);
+}
+
+void lemlib::Chassis::setTractionControl(std::optional<TractionSettings> settings) {
+    if (settings) this->makeDriveWheels();
+    this->slip = SlipState();
+    this->traction = settings;
+}
+
+void lemlib::Chassis::setVelocityControl(std::optional<VelocityControlSettings> settings) {
+    if (settings) {
+        this->makeDriveWheels();
+        for (PID* pid : {&this->leftVelocityPID, &this->rightVelocityPID}) {
+            pid->setGains(settings->kP, settings->kI, settings->kD);
+            // the integral stops growing while the correction is limited, so it doesn't wind up during a stall
+            pid->setOutputLimit(settings->maxCorrection);
+            pid->reset();
+        }
+    }
+    this->velocityControl = settings;
+}
+
+void lemlib::Chassis::setBatteryCompensation(std::optional<BatteryCompensationSettings> settings) {
+    this->compensationScale = 1;
+    this->lastBatteryRead = 0;
+    this->batteryCompensation = settings;
+}
+
+float lemlib::Chassis::batteryScale() {
+    const std::optional<BatteryCompensationSettings> settings = this->batteryCompensation;
+    if (!settings) return 1;
+    const uint32_t now = pros::millis();
+    const uint32_t last = this->lastBatteryRead;
+    if (last != 0 && now - last < settings->period) return this->compensationScale;
+    this->lastBatteryRead = std::max(now, uint32_t(1));
+    // a battery that couldn't be read keeps the last scale
+    const int32_t battery = pros::battery::get_voltage();
+    if (battery <= 0 || battery == PROS_ERR) return this->compensationScale;
+    // the battery sags under load, and a larger command draws more, so the scale moves halfway to the new reading
+    // each time instead of chasing the sag
+    const float target = settings->nominal / battery;
+    const float scale = last == 0 ? target : (this->compensationScale + target) / 2;
+    this->compensationScale = scale;
+    return scale;
+}
+
+void lemlib::Chassis::setThermalModel(std::optional<ThermalSettings> settings) {
+    if (settings) this->thermalModel.emplace(this->drivetrain.leftMotors, this->drivetrain.rightMotors, *settings);
+    else this->thermalModel.reset();
+}
+
+lemlib::ThermalReading lemlib::Chassis::getThermalReading() {
+    return this->thermalModel ? this->thermalModel->getReading() : ThermalReading();
+}
+
+float lemlib::Chassis::thermalScale() { return this->thermalModel ? this->thermalModel->getScale() : 1; }
+
+lemlib::SlipState lemlib::Chassis::getSlip() { return this->slip; }
+
+/**
+ * @brief Limit how fast a power can grow from the last power
+ */
+static float limitRamp(float target, float previous, float maxChange) {
+    // a change of direction grows from 0
+    if (target * previous < 0) previous = 0;
+    // slowing down is never limited, since it can only help the wheels grip
+    if (std::fabs(target) <= std::fabs(previous)) return target;
+    return lemlib::slew(target, previous, maxChange);
+}
+
+void lemlib::Chassis::controlTraction(float& left, float& right) {
+    const uint64_t now = pros::micros();
+    const float elapsed = this->lastPowerTime == 0 ? TUNED_PERIOD : (now - this->lastPowerTime) / 1000.0f;
+    this->lastPowerTime = now;
+
+    // the speed of each side over the ground, from the tracking wheels. Turning clockwise speeds up the left side
+    const Pose speed = this->odom.getLocalSpeed(true);
+    const float turning = speed.theta * this->drivetrain.kinematics().halfTrack;
+    const float leftGround = speed.y + turning;
+    const float rightGround = speed.y - turning;
+    this->slip.left = this->leftDriveWheel->getVelocity() - leftGround;
+    this->slip.right = this->rightDriveWheel->getVelocity() - rightGround;
+    const TractionSettings settings = *this->traction;
+    const bool leftSlipping =
+        std::fabs(this->slip.left) > settings.slipSpeed + settings.slipRatio * std::fabs(leftGround);
+    const bool rightSlipping =
+        std::fabs(this->slip.right) > settings.slipSpeed + settings.slipRatio * std::fabs(rightGround);
+    this->slip.slipping = leftSlipping || rightSlipping;
+
+    // the power of both sides stops growing until the slipping side grips again
+    if (this->slip.slipping && settings.ramp > 0) {
+        const float maxChange = settings.ramp * std::fmin(elapsed / TUNED_PERIOD, 1);
+        left = limitRamp(left, this->lastLeftPower, maxChange);
+        right = limitRamp(right, this->lastRightPower, maxChange);
+    }
+    this->lastLeftPower = left;
+    this->lastRightPower = right;
+}
+
+void lemlib::Chassis::brakeDriveSide(DriveSide side) { this->sendDriveCommand(side, BRAKE_COMMAND); }
+
+void lemlib::Chassis::setActiveStop(std::optional<ActiveStopSettings> settings) {
+    if (settings) this->makeDriveWheels();
+    this->activeStop = settings;
+}
+
+void lemlib::Chassis::setPoseHold(std::optional<PoseHoldSettings> settings) { this->poseHold = settings; }
+
+void lemlib::Chassis::setStallDetection(std::optional<StallSettings> settings) {
+    if (settings) this->makeDriveWheels();
+    this->stallDetection = settings;
+}
+
+void lemlib::Chassis::checkStall() {
+    const StallSettings& settings = *this->stallDetection;
+    // the commands are in millivolts
+    const float minCommand = settings.minPower * MAX_VOLTAGE / 127;
+    const int32_t left = this->leftCommand;
+    const int32_t right = this->rightCommand;
+    const bool leftPushing = left != NO_COMMAND && left != BRAKE_COMMAND && std::abs(left) >= minCommand;
+    const bool rightPushing = right != NO_COMMAND && right != BRAKE_COMMAND && std::abs(right) >= minCommand;
+    const Pose speed = this->odom.getLocalSpeed(true);
+    const float turning = std::fabs(speed.theta) * this->drivetrain.kinematics().halfTrack;
+    bool stalled = (leftPushing || rightPushing) && std::fabs(speed.y) < settings.stallSpeed &&
+                   turning < settings.stallSpeed;
+    if (stalled) {
+        const bool wheelsStopped = std::fabs(this->leftDriveWheel->getVelocity()) < settings.stallSpeed &&
+                                   std::fabs(this->rightDriveWheel->getVelocity()) < settings.stallSpeed;
+        bool drawing = false;
+        if (!wheelsStopped && settings.minCurrent > 0) {
+            // the wheels are spinning in place, which only draws a lot of current if they are pushing
+            float current = 0;
+            const int32_t count = this->drivetrain.leftMotors->size() + this->drivetrain.rightMotors->size();
+            for (int32_t i = 0; i < this->drivetrain.leftMotors->size(); i++)
+                current += std::abs((*this->drivetrain.leftMotors)[i].get_current_draw());
+            for (int32_t i = 0; i < this->drivetrain.rightMotors->size(); i++)
+                current += std::abs((*this->drivetrain.rightMotors)[i].get_current_draw());
+            drawing = count != 0 && current / count >= settings.minCurrent;
+        }
+        stalled = wheelsStopped || drawing;
+    }
+    if (!stalled) {
+        this->stallStart = 0;
+        return;
+    }
+    const uint32_t now = std::max<uint32_t>(pros::millis(), 1);
+    if (this->stallStart == 0) this->stallStart = now;
+    if (now - this->stallStart < settings.time) return;
+    infoSink()->debug("Motion {} stalled", this->runningMotion.load());
+    const float pushed = float(leftPushing ? left : 0) + (rightPushing ? right : 0);
+    if (settings.walls) this->resetAgainstWall(settings, sgn(pushed));
+    this->motionStalled = true;
+}
+
+void lemlib::Chassis::resetAgainstWall(const StallSettings& settings, float direction) {
+    const Pose pose = this->getPose(true);
+    // the heading the robot pushed in, snapped to the nearest wall, where 0 is +y and pi / 2 is +x
+    const float heading = direction > 0 ? pose.theta : pose.theta + M_PI;
+    const float snapped = std::round(heading / M_PI_2) * M_PI_2;
+    if (std::fabs(angleError(heading, snapped, true)) > degToRad(settings.squareAngle)) return;
+    const float offset = direction > 0 ? settings.frontOffset : settings.backOffset;
+    const int side = int(std::lround(snapped / M_PI_2)) % 4;
+    const FieldMap& walls = *settings.walls;
+    float x = 0, y = 0;
+    switch (side < 0 ? side + 4 : side) {
+        case 0: y = walls.maxY - offset - pose.y; break;
+        case 1: x = walls.maxX - offset - pose.x; break;
+        case 2: y = walls.minY + offset - pose.y; break;
+        default: x = walls.minX + offset - pose.x; break;
+    }
+    if (std::fabs(x) > settings.maxCorrection || std::fabs(y) > settings.maxCorrection) {
+        infoSink()->warn("Stalled {} in from a wall, so odometry wasn't reset against it", std::hypot(x, y));
+        return;
+    }
+    this->odom.correctPosition(x, y, 0);
+}
+
+void lemlib::Chassis::setCollisionDetection(std::optional<CollisionSettings> settings) {
+    this->collisionCooldown = settings ? settings->cooldown : 0;
+    this->collisionThreshold = settings ? settings->threshold : 0;
+    this->collisionDetection = settings;
+    // odometry sensors can't be removed, so the sensor is added once and stops detecting when the threshold is 0
+    if (settings && this->collisionSensor < 0) {
+        this->collisionSensor = this->odom.addSensor([this] { return this->readCollision(); });
+        if (this->collisionSensor < 0) infoSink()->warn("Odometry has no room for a sensor to detect collisions");
+    }
+}
+
+lemlib::Collision lemlib::Chassis::getLastCollision() const {
+    Collision collision;
+    collision.count = this->collisionCount.load(std::memory_order_acquire);
+    collision.time = this->collisionTime;
+    collision.strength = this->collisionStrength;
+    return collision;
+}
+
+float lemlib::Chassis::readCollision() {
+    const float threshold = this->collisionThreshold;
+    if (threshold <= 0 || this->imuState != ImuState::READY) {
+        this->prevAccelX = NAN;
+        return 0;
+    }
+    const pros::c::imu_accel_s_t accel = this->sensors.imu->get_accel();
+    if (accel.x == PROS_ERR_F || accel.y == PROS_ERR_F) return 0;
+    // the acceleration across the field only, so driving over a bump isn't a collision
+    const float jump =
+        std::isnan(this->prevAccelX) ? 0 : std::hypot(accel.x - this->prevAccelX, accel.y - this->prevAccelY);
+    this->prevAccelX = accel.x;
+    this->prevAccelY = accel.y;
+    const uint32_t now = std::max<uint32_t>(pros::millis(), 1);
+    const bool coolingDown = this->collisionCount != 0 && now - this->collisionTime < this->collisionCooldown;
+    if (jump >= threshold && !coolingDown) {
+        this->collisionTime = now;
+        this->collisionStrength = jump;
+        this->collisionCount.fetch_add(1, std::memory_order_release);
+    }
+    return jump;
+}
+
+void lemlib::Chassis::checkCollision() {
+    const uint32_t count = this->collisionCount.load(std::memory_order_acquire);
+    if (count == this->motionCollisions) return;
+    this->motionCollisions = count;
+    infoSink()->debug("Motion {} hit something, {} g", this->runningMotion.load(), this->collisionStrength.load());
+    MotionRecord* record = this->getMotionRecord(this->runningMotion);
+    if (record != nullptr) {
+        for (MotionCallback& callback : record->callbacks) {
+            if (callback.trigger == MotionTrigger::COLLISION) this->fireCallback(callback);
+        }
+    }
+    if (this->collisionDetection->abort) this->motionCollided = true;
+}
+
+void lemlib::Chassis::setAntiTip(std::optional<AntiTipSettings> settings) {
+    this->tipScale = 1;
+    this->antiTip = settings;
+}
+
+void lemlib::Chassis::updateTipScale() {
+    if (this->imuState != ImuState::READY) return;
+    const AntiTipSettings& settings = *this->antiTip;
+    const double pitch = this->sensors.imu->get_pitch();
+    const double roll = this->sensors.imu->get_roll();
+    const pros::c::imu_gyro_s_t rate = this->sensors.imu->get_gyro_rate();
+    // keep the last scale if the sensor couldn't be read
+    if (pitch == PROS_ERR_F || roll == PROS_ERR_F || rate.x == PROS_ERR_F || rate.y == PROS_ERR_F) return;
+    // the x and y axes of the gyro are the axes the robot rolls and pitches about
+    const float tilt = std::fmax(std::fabs(pitch - this->basePitch), std::fabs(roll - this->baseRoll)) +
+                       std::fmax(std::fabs(rate.x), std::fabs(rate.y)) * settings.lead / 1000;
+    const float range = std::fmax(settings.tiltLimit - settings.tiltStart, 0.001f);
+    const float tipping = std::clamp((tilt - settings.tiltStart) / range, 0.0f, 1.0f);
+    this->tipScale = 1 - (1 - settings.minScale) * tipping;
+}
+
+float lemlib::Chassis::lateralSlew(const ControllerSettings& settings) const {
+    if (!this->antiTip) return settings.slew;
+    const float slew = this->antiTip->slew > 0 ? this->antiTip->slew : settings.slew;
+    return slew * this->tipScale;
+}
+
+void lemlib::Chassis::stopDrivetrain(MotionEndReason reason) {
+    const std::optional<ActiveStopSettings> settings = this->activeStop;
+    // a motion that exits early leaves the robot moving for the next one
+    const bool stopping = reason == MotionEndReason::SETTLED || reason == MotionEndReason::TIMEOUT ||
+                          reason == MotionEndReason::CONDITION_MET;
+    if (!settings || !stopping) {
+        this->setDrivePower(0, 0);
+        return;
+    }
+    TrackingWheel* wheels[] = {&*this->leftDriveWheel, &*this->rightDriveWheel};
+    const DriveSide sides[] = {DriveSide::LEFT, DriveSide::RIGHT};
+    // the direction each side is turning when the motion ends. 0 once it has stopped
+    float directions[2];
+    for (int i = 0; i < 2; i++) {
+        const float velocity = wheels[i]->getVelocity();
+        directions[i] = std::fabs(velocity) > settings->stopSpeed ? sgn(velocity) : 0;
+    }
+    const uint32_t start = pros::millis();
+    while (directions[0] != 0 || directions[1] != 0) {
+        // a motion waiting to run takes the robot as it is
+        if (this->motionState == MotionState::CANCELLING || this->motionPreempted()) break;
+        if (pros::millis() - start >= settings->maxTime) break;
+        for (int i = 0; i < 2; i++) {
+            if (directions[i] == 0) continue;
+            // a side that has slowed down enough, or started turning the other way, is stopped
+            const float speed = wheels[i]->getVelocity() * directions[i];
+            if (speed <= settings->stopSpeed) {
+                directions[i] = 0;
+                if (settings->brake) this->brakeDriveSide(sides[i]);
+                else this->setDrivePower(sides[i], 0);
+                continue;
+            }
+            this->setDrivePower(sides[i], -directions[i] * std::fmin(settings->kP * speed, settings->maxPower));
+        }
+        this->waitForTick();
+    }
+    for (const DriveSide side : sides) {
+        if (settings->brake) this->brakeDriveSide(side);
+        else this->setDrivePower(side, 0);
+    }
+}
+
+bool lemlib::Chassis::holdPose() {
+    // whether the last correction drove the motors, so they are braked when the hold ends
+    bool driving = false;
+    while (this->holdArmed) {
+        const std::optional<PoseHoldSettings> settings = this->poseHold;
+        // the robot may have been moved by hand while it was disabled, so it is only held in the period it stopped in
+        if (!settings || matchClock().getPeriodStart() != this->holdPeriodStart) break;
+        if (pros::Task::notify_take(true, settings->period) > 0) return true;
+        // the driver took the robot
+        if (!this->holdArmed) return false;
+        const Pose pose = this->getPose(true, true);
+        if (this->holdMoved.exchange(false)) this->holdTarget = pose;
+        const Pose target = this->holdTarget;
+        // how far the robot was pushed, relative to the robot
+        const float deltaX = target.x - pose.x;
+        const float deltaY = target.y - pose.y;
+        const float cosTheta = std::cos(pose.theta);
+        const float sinTheta = std::sin(pose.theta);
+        const float forwardError = deltaX * cosTheta + deltaY * sinTheta;
+        const float strafeError = deltaX * sinTheta - deltaY * cosTheta;
+        const float angularError = radToDeg(angleError(pose.theta, target.theta));
+        const bool holonomic = this->drivetrain.holonomic != nullptr;
+        const float maxPower = settings->maxPower;
+        auto power = [](float error, float tolerance, float gain, float maxPower) {
+            return std::fabs(error) > tolerance ? std::clamp(error * gain, -maxPower, maxPower) : 0.0f;
+        };
+        const float forward = power(forwardError, settings->tolerance, settings->kP, maxPower);
+        const float strafe = holonomic ? power(strafeError, settings->tolerance, settings->kP, maxPower) : 0;
+        const float turn = power(angularError, settings->angleTolerance, settings->kTurn, maxPower);
+        driving = forward != 0 || strafe != 0 || turn != 0;
+        if (!driving) {
+            // the brake mode holds the robot while it is within the tolerances
+            this->brakeDriveSide(DriveSide::LEFT);
+            this->brakeDriveSide(DriveSide::RIGHT);
+        } else if (holonomic) {
+            this->setHolonomicPower(forward, strafe, turn, maxPower);
+        } else {
+            // scale both sides down together, so the robot still turns back as it drives back
+            const float scale = std::fmin(maxPower / (std::fabs(forward) + std::fabs(turn)), 1);
+            this->setDrivePower((forward + turn) * scale, (forward - turn) * scale);
+        }
+    }
+    if (driving) {
+        this->brakeDriveSide(DriveSide::LEFT);
+        this->brakeDriveSide(DriveSide::RIGHT);
+    }
+    this->holdArmed = false;
+    return false;
+}
+
+void lemlib::Chassis::resetDriveOutput() {
+    this->leftCommand = NO_COMMAND;
+    this->rightCommand = NO_COMMAND;
+    this->leftVelocityPID.reset();
+    this->rightVelocityPID.reset();
+}
+
+void lemlib::Chassis::sendDriveCommand(DriveSide side, int32_t command) {
+    if (command != BRAKE_COMMAND && this->batteryCompensation) {
+        command = std::round(std::clamp(command * this->batteryScale(), -MAX_VOLTAGE, MAX_VOLTAGE));
+    }
+    std::atomic<int32_t>& last = side == DriveSide::LEFT ? this->leftCommand : this->rightCommand;
+    // stops are always sent, since user code may have driven the motors without going through the chassis
+    const bool stop = command == 0 || command == BRAKE_COMMAND;
+    if (last.exchange(command) == command && !stop) return;
+    // measureMotionLatency times the first time the motion it queued drives, and stops
+    const uint32_t timed = this->latencyMotion.load(std::memory_order_relaxed);
+    if (timed != 0 && this->runningMotion == timed) {
+        std::atomic<uint32_t>& time = stop ? this->latencyStop : this->latencyDrive;
+        uint32_t unset = 0;
+        time.compare_exchange_strong(unset, std::max<uint32_t>(pros::micros(), 1));
+    }
+    pros::MotorGroup* motors = side == DriveSide::LEFT ? this->drivetrain.leftMotors : this->drivetrain.rightMotors;
+    if (command == BRAKE_COMMAND) motors->brake();
+    else motors->move_voltage(command);
 }
@@ -0,0 +1,139 @@
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/configStore.hpp"
+
+/**
+ * @brief Replace the offset of a tracking wheel with the one in a config store, if there is a tracking wheel
+ */
+static void loadOffset(const lemlib::ConfigStore& config, std::string_view key, lemlib::TrackingWheel* wheel) {
+    if (wheel != nullptr) wheel->setOffset(config.get(key, wheel->getOffset()));
+}
+
+/**
+ * @brief Replace the diameter of a tracking wheel with the one in a config store, if there is a tracking wheel
+ */
+static void loadDiameter(const lemlib::ConfigStore& config, std::string_view key, lemlib::TrackingWheel* wheel) {
+    if (wheel != nullptr) wheel->setDiameter(config.get(key, wheel->getDiameter()));
+}
+
+/**
+ * @brief Store the offset of a tracking wheel in a config store, if there is a tracking wheel
+ */
+static void saveOffset(lemlib::ConfigStore& config, std::string_view key, lemlib::TrackingWheel* wheel) {
+    if (wheel != nullptr) config.set(key, wheel->getOffset());
+}
+
+/**
+ * @brief Store the diameter of a tracking wheel in a config store, if it is a tracking wheel and not the drive motors
+ */
+static void saveDiameter(lemlib::ConfigStore& config, std::string_view key, lemlib::TrackingWheel* wheel) {
+    if (wheel != nullptr && !wheel->getType()) config.set(key, wheel->getDiameter());
+}
+
+void lemlib::Chassis::loadConfig(const ConfigStore& config) {
+    ControllerSettings& lateral = this->lateralSettings;
+    lateral.kP = config.get("lateral.kP", lateral.kP);
+    lateral.kI = config.get("lateral.kI", lateral.kI);
+    lateral.kD = config.get("lateral.kD", lateral.kD);
+    this->lateralPID.setGains(lateral.kP, lateral.kI, lateral.kD);
+    ControllerSettings& angular = this->angularSettings;
+    angular.kP = config.get("angular.kP", angular.kP);
+    angular.kI = config.get("angular.kI", angular.kI);
+    angular.kD = config.get("angular.kD", angular.kD);
+    this->angularPID.setGains(angular.kP, angular.kI, angular.kD);
+
+    Feedforward& feedforward = this->feedforward;
+    feedforward.kS = config.get("feedforward.kS", feedforward.kS);
+    feedforward.kV = config.get("feedforward.kV", feedforward.kV);
+    feedforward.kA = config.get("feedforward.kA", feedforward.kA);
+
+    // missing vertical tracking wheels are substituted by calibrate, from the track width
+    loadOffset(config, "vertical1.offset", this->sensors.vertical1);
+    loadOffset(config, "vertical2.offset", this->sensors.vertical2);
+    loadOffset(config, "horizontal1.offset", this->sensors.horizontal1);
+    loadOffset(config, "horizontal2.offset", this->sensors.horizontal2);
+    loadDiameter(config, "vertical1.diameter", this->sensors.vertical1);
+    loadDiameter(config, "vertical2.diameter", this->sensors.vertical2);
+    loadDiameter(config, "horizontal1.diameter", this->sensors.horizontal1);
+    loadDiameter(config, "horizontal2.diameter", this->sensors.horizontal2);
+    this->drivetrain.trackWidth = config.get("drivetrain.trackWidth", this->drivetrain.trackWidth);
+    this->odom.setImuScale(config.get("imu.scale", this->odom.getImuScale()));
+}
+
+bool lemlib::Chassis::saveConfig(ConfigStore& config) {
+    config.set("lateral.kP", this->lateralSettings.kP);
+    config.set("lateral.kI", this->lateralSettings.kI);
+    config.set("lateral.kD", this->lateralSettings.kD);
+    config.set("angular.kP", this->angularSettings.kP);
+    config.set("angular.kI", this->angularSettings.kI);
+    config.set("angular.kD", this->angularSettings.kD);
+    config.set("feedforward.kS", this->feedforward.kS);
+    config.set("feedforward.kV", this->feedforward.kV);
+    config.set("feedforward.kA", this->feedforward.kA);
+    saveOffset(config, "vertical1.offset", this->sensors.vertical1);
+    saveOffset(config, "vertical2.offset", this->sensors.vertical2);
+    saveOffset(config, "horizontal1.offset", this->sensors.horizontal1);
+    saveOffset(config, "horizontal2.offset", this->sensors.horizontal2);
+    saveDiameter(config, "vertical1.diameter", this->sensors.vertical1);
+    saveDiameter(config, "vertical2.diameter", this->sensors.vertical2);
+    saveDiameter(config, "horizontal1.diameter", this->sensors.horizontal1);
+    saveDiameter(config, "horizontal2.diameter", this->sensors.horizontal2);
+    config.set("drivetrain.trackWidth", this->drivetrain.trackWidth);
+    config.set("imu.scale", this->odom.getImuScale());
+    return config.save();
+}
+
+float* lemlib::Chassis::findParameter(uint32_t key) {
+    switch (key) {
+        case configKeyHash("lateral.kP"): return &this->lateralSettings.kP;
+        case configKeyHash("lateral.kI"): return &this->lateralSettings.kI;
+        case configKeyHash("lateral.kD"): return &this->lateralSettings.kD;
+        case configKeyHash("lateral.slew"): return &this->lateralSettings.slew;
+        case configKeyHash("lateral.smallError"): return &this->lateralSettings.smallError;
+        case configKeyHash("lateral.smallErrorTimeout"): return &this->lateralSettings.smallErrorTimeout;
+        case configKeyHash("lateral.largeError"): return &this->lateralSettings.largeError;
+        case configKeyHash("lateral.largeErrorTimeout"): return &this->lateralSettings.largeErrorTimeout;
+        case configKeyHash("angular.kP"): return &this->angularSettings.kP;
+        case configKeyHash("angular.kI"): return &this->angularSettings.kI;
+        case configKeyHash("angular.kD"): return &this->angularSettings.kD;
+        case configKeyHash("angular.slew"): return &this->angularSettings.slew;
+        case configKeyHash("angular.smallError"): return &this->angularSettings.smallError;
+        case configKeyHash("angular.smallErrorTimeout"): return &this->angularSettings.smallErrorTimeout;
+        case configKeyHash("angular.largeError"): return &this->angularSettings.largeError;
+        case configKeyHash("angular.largeErrorTimeout"): return &this->angularSettings.largeErrorTimeout;
+        case configKeyHash("feedforward.kS"): return &this->feedforward.kS;
+        case configKeyHash("feedforward.kV"): return &this->feedforward.kV;
+        case configKeyHash("feedforward.kA"): return &this->feedforward.kA;
+        default: return nullptr;
+    }
+}
+
+bool lemlib::Chassis::setParameter(std::string_view key, float value) {
+    const uint32_t hash = configKeyHash(key);
+    if (this->findParameter(hash) == nullptr) return false;
+    return this->parameterQueue.push({hash, value});
+}
+
+std::optional<float> lemlib::Chassis::getParameter(std::string_view key) {
+    const float* parameter = this->findParameter(configKeyHash(key));
+    if (parameter == nullptr) return std::nullopt;
+    return *parameter;
+}
+
+void lemlib::Chassis::applyParameters() {
+    ParameterUpdate update;
+    bool changed = false;
+    while (this->parameterQueue.pop(update)) {
+        *this->findParameter(update.key) = update.value;
+        changed = true;
+    }
+    if (!changed) return;
+    // the controllers and exit conditions keep copies of the settings
+    const ControllerSettings& lateral = this->lateralSettings;
+    const ControllerSettings& angular = this->angularSettings;
+    this->lateralPID.setGains(lateral.kP, lateral.kI, lateral.kD);
+    this->angularPID.setGains(angular.kP, angular.kI, angular.kD);
+    this->lateralSmallExit.setThreshold(lateral.smallError, lateral.smallErrorTimeout);
+    this->lateralLargeExit.setThreshold(lateral.largeError, lateral.largeErrorTimeout);
+    this->angularSmallExit.setThreshold(angular.smallError, angular.smallErrorTimeout);
+    this->angularLargeExit.setThreshold(angular.largeError, angular.largeErrorTimeout);
+}
@@ -0,0 +1,67 @@
+#include <array>
+#include <cmath>
+#include "lemlib/chassis/driverLatency.hpp"
+
+namespace lemlib {
+/**
+ * @brief Get the percentiles of the samples in a ring
+ */
+static TimingStats timingStats(const RingBuffer<uint32_t, DriverLatency::SAMPLES>& ring) {
+    std::array<uint32_t, DriverLatency::SAMPLES> samples;
+    for (size_t i = 0; i < ring.size(); i++) samples[i] = ring[i];
+    return timingStats(samples.data(), ring.size());
+}
+
+DriverLatency::DriverLatency(TrackingWheel* left, TrackingWheel* right, DriverLatencySettings settings)
+    : left(left),
+      right(right),
+      settings(settings) {}
+
+void DriverLatency::updateStep(Step& step, TrackingWheel* wheel, float power, float lastPower, uint64_t readTime,
+                               uint64_t now) {
+    if (step.pending) {
+        // the wheels are only read while a step is timed
+        const float velocity = wheel->getVelocity() * step.direction;
+        if (velocity >= this->settings.responseSpeed) {
+            this->response.push(now - step.commandTime);
+            this->total.push(now - step.readTime);
+            this->steps++;
+            step.pending = false;
+        } else if (now - step.commandTime > uint64_t(this->settings.timeout) * 1000 ||
+                   power * step.direction < this->settings.restPower) {
+            // the wheel was stuck, or the driver let go before it turned
+            step.pending = false;
+        }
+        return;
+    }
+    if (std::fabs(lastPower) > this->settings.restPower || std::fabs(power) < this->settings.stepPower) return;
+    step.direction = power > 0 ? 1 : -1;
+    // a wheel that is already turning, like one coasting, would respond right away
+    if (std::fabs(wheel->getVelocity()) >= this->settings.responseSpeed) return;
+    step.pending = true;
+    step.readTime = readTime;
+    step.commandTime = now;
+}
+
+void DriverLatency::record(uint64_t readTime, float left, float right) {
+    const uint64_t now = pros::micros();
+    this->mutex.take();
+    this->command.push(now - readTime);
+    this->updateStep(this->leftStep, this->left, left, this->lastLeft, readTime, now);
+    this->updateStep(this->rightStep, this->right, right, this->lastRight, readTime, now);
+    this->lastLeft = left;
+    this->lastRight = right;
+    this->mutex.give();
+}
+
+DriverLatencyStats DriverLatency::getStats() {
+    this->mutex.take();
+    DriverLatencyStats stats;
+    stats.command = timingStats(this->command);
+    stats.response = timingStats(this->response);
+    stats.total = timingStats(this->total);
+    stats.steps = this->steps;
+    this->mutex.give();
+    return stats;
+}
+} // namespace lemlib
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/binaryFile.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/chassis/driverMacro.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// written at the start of every macro, "LMC" and the format version
+constexpr char HEADER[] = {'L', 'M', 'C', 1};
+// size of the header, with the drive scheme, the drive curve flag, the desaturate bias, and the periods
+constexpr size_t HEADER_SIZE = sizeof(HEADER) + 3 + 2 * 2;
+// longest time between recorded readings before the macro is paused, in milliseconds
+constexpr uint32_t MAX_GAP = 100;
+// most samples a repeat record counts
+constexpr int MAX_REPEAT = 128;
+// tags of the records that aren't repeats or small changes
+constexpr uint8_t SMALL_CHANGE = 0x80;
+constexpr uint8_t SAMPLE = 0xC0;
+constexpr uint8_t POSE = 0xC1;
+constexpr uint8_t POSE_CHANGE = 0xC2;
+// fixed point units of the poses in an inch and in a degree
+constexpr float POSITION_SCALE = 4;
+constexpr float ANGLE_SCALE = 2;
+// a full turn, in fixed point units
+constexpr int32_t FULL_TURN = 360 * ANGLE_SCALE;
+
+/**
+ * @brief Whether a change of a stick fits in the 3 bits of a small change record
+ */
+static bool smallChange(int change) { return change >= -4 && change <= 3; }
+
+namespace lemlib {
+DriverMacro::DriverMacro(uint32_t period, uint32_t posePeriod)
+    : period(std::max<uint32_t>(period, 1)),
+      poseInterval(std::max<uint32_t>(std::lround(float(posePeriod) / this->period), 1)) {}
+
+void DriverMacro::begin(DriveScheme scheme, bool disableDriveCurve, float desaturateBias) {
+    data.assign(HEADER, HEADER + sizeof(HEADER));
+    put(data, uint8_t(scheme));
+    put(data, uint8_t(disableDriveCurve));
+    put(data, uint8_t(std::clamp(std::lround(desaturateBias * 100), 0l, 100l)));
+    put(data, uint16_t(period));
+    put(data, uint16_t(period * poseInterval));
+    samples = 0;
+    lastThrottle = 0;
+    lastTurn = 0;
+    repeatPosition = SIZE_MAX;
+    hasPose = false;
+}
+
+void DriverMacro::record(int throttle, int turn, Pose pose, uint32_t time) {
+    // begin hasn't been called
+    if (data.size() < HEADER_SIZE) return;
+    // after a long gap the macro carries on from where it paused, instead of filling the gap
+    if (samples == 0 || time - lastTime > MAX_GAP) startTime = time - samples * period;
+    lastTime = time;
+    while (time - startTime >= samples * period) {
+        if (samples % poseInterval == 0) addPose(pose);
+        addSample(throttle, turn);
+    }
+}
+
+void DriverMacro::addSample(int throttle, int turn) {
+    throttle = std::clamp(throttle, -127, 127);
+    turn = std::clamp(turn, -127, 127);
+    samples++;
+    const int throttleChange = throttle - lastThrottle;
+    const int turnChange = turn - lastTurn;
+    lastThrottle = throttle;
+    lastTurn = turn;
+    // held sticks are counted by the last record, if it is a repeat
+    if (throttleChange == 0 && turnChange == 0) {
+        if (repeatPosition != SIZE_MAX && data[repeatPosition] < MAX_REPEAT - 1) {
+            data[repeatPosition]++;
+        } else {
+            repeatPosition = data.size();
+            data.push_back(0);
+        }
+        return;
+    }
+    repeatPosition = SIZE_MAX;
+    if (smallChange(throttleChange) && smallChange(turnChange)) {
+        data.push_back(SMALL_CHANGE | (throttleChange & 0x7) << 3 | (turnChange & 0x7));
+        return;
+    }
+    data.push_back(SAMPLE);
+    put(data, int8_t(throttle));
+    put(data, int8_t(turn));
+}
+
+void DriverMacro::addPose(Pose pose) {
+    const int32_t x = std::lround(pose.x * POSITION_SCALE);
+    const int32_t y = std::lround(pose.y * POSITION_SCALE);
+    const int32_t theta = std::lround(std::remainder(pose.theta, 360.0f) * ANGLE_SCALE);
+    // the short way around, so crossing 180 degrees is a small change
+    int32_t thetaChange = theta - lastTheta;
+    if (thetaChange >= FULL_TURN / 2) thetaChange -= FULL_TURN;
+    if (thetaChange < -FULL_TURN / 2) thetaChange += FULL_TURN;
+    const int32_t changes[] = {x - lastX, y - lastY, thetaChange};
+    const bool fits = std::all_of(std::begin(changes), std::end(changes),
+                                  [](int32_t value) { return value >= INT8_MIN && value <= INT8_MAX; });
+    // the next held sample starts a new repeat, so it comes after the pose
+    repeatPosition = SIZE_MAX;
+    if (hasPose && fits) {
+        data.push_back(POSE_CHANGE);
+        for (int32_t change : changes) put(data, int8_t(change));
+    } else {
+        data.push_back(POSE);
+        put(data, int16_t(std::clamp<int32_t>(x, INT16_MIN, INT16_MAX)));
+        put(data, int16_t(std::clamp<int32_t>(y, INT16_MIN, INT16_MAX)));
+        put(data, int16_t(theta));
+    }
+    // the decoder adds up the changes, so it has the rounded pose exactly
+    hasPose = true;
+    lastX = x;
+    lastY = y;
+    lastTheta = theta;
+}
+
+bool DriverMacro::decode(std::vector<MacroSample>& samples, std::vector<MacroPose>& poses) const {
+    samples.clear();
+    poses.clear();
+    if (data.size() < HEADER_SIZE || std::memcmp(data.data(), HEADER, sizeof(HEADER)) != 0) return false;
+    size_t position = HEADER_SIZE;
+    MacroSample sample;
+    int32_t x = 0, y = 0, theta = 0;
+    // the decoded heading isn't wrapped, so it turns the same way the robot did
+    while (position < data.size()) {
+        const uint8_t tag = data[position++];
+        if (tag < MAX_REPEAT) {
+            samples.insert(samples.end(), tag + 1, sample);
+        } else if (tag < SAMPLE) {
+            // sign extend the 3 bit changes
+            sample.throttle += int8_t((tag >> 3 & 0x7) << 5) >> 5;
+            sample.turn += int8_t((tag & 0x7) << 5) >> 5;
+            samples.push_back(sample);
+        } else if (tag == SAMPLE) {
+            if (!get(data, position, sample.throttle) || !get(data, position, sample.turn)) return false;
+            samples.push_back(sample);
+        } else if (tag == POSE) {
+            int16_t newX, newY, newTheta;
+            if (!get(data, position, newX) || !get(data, position, newY) || !get(data, position, newTheta)) {
+                return false;
+            }
+            x = newX;
+            y = newY;
+            theta = newTheta;
+            poses.push_back({uint32_t(samples.size() * period),
+                             Pose(x / POSITION_SCALE, y / POSITION_SCALE, theta / ANGLE_SCALE)});
+        } else if (tag == POSE_CHANGE) {
+            int8_t changeX, changeY, changeTheta;
+            if (!get(data, position, changeX) || !get(data, position, changeY) || !get(data, position, changeTheta)) {
+                return false;
+            }
+            x += changeX;
+            y += changeY;
+            theta += changeTheta;
+            poses.push_back({uint32_t(samples.size() * period),
+                             Pose(x / POSITION_SCALE, y / POSITION_SCALE, theta / ANGLE_SCALE)});
+        } else {
+            return false;
+        }
+    }
+    return !samples.empty();
+}
+
+bool DriverMacro::save(const std::string& path) const { return writeFile(path, data); }
+
+bool DriverMacro::load(const std::string& path) {
+    DriverMacro loaded;
+    loaded.data = readFile(path);
+    if (loaded.data.empty()) {
+        infoSink()->error("Couldn't read {}!", path);
+        return false;
+    }
+    // the periods are read first, since the times of the poses are decoded with them
+    uint16_t period = 0, posePeriod = 0;
+    size_t position = sizeof(HEADER) + 3;
+    const bool header = get(loaded.data, position, period) && get(loaded.data, position, posePeriod) && period != 0;
+    if (header) {
+        loaded.period = period;
+        loaded.poseInterval = std::max(posePeriod / period, 1);
+    }
+    std::vector<MacroSample> samples;
+    std::vector<MacroPose> poses;
+    if (!header || !loaded.decode(samples, poses)) {
+        infoSink()->error("{} is not a driver macro, or was made for a different version of LemLib!", path);
+        return false;
+    }
+    loaded.samples = samples.size();
+    // a loaded macro isn't recorded to until begin is called again, so the encoder state is left as it is
+    *this = std::move(loaded);
+    return true;
+}
+
+Pose DriverMacro::getStart() const {
+    // the first record is the pose of the first sample
+    int16_t x, y, theta;
+    size_t position = HEADER_SIZE + 1;
+    if (data.size() <= HEADER_SIZE || data[HEADER_SIZE] != POSE || !get(data, position, x) ||
+        !get(data, position, y) || !get(data, position, theta)) {
+        return Pose(0, 0, 0);
+    }
+    return Pose(x / POSITION_SCALE, y / POSITION_SCALE, theta / ANGLE_SCALE);
+}
+
+const std::vector<uint8_t>& DriverMacro::getData() const { return data; }
+
+uint32_t DriverMacro::getPeriod() const { return period; }
+
+uint32_t DriverMacro::getDuration() const { return samples * period; }
+
+DriveScheme DriverMacro::getScheme() const {
+    return data.size() < HEADER_SIZE ? DriveScheme::ARCADE : DriveScheme(data[sizeof(HEADER)]);
+}
+
+bool DriverMacro::driveCurveDisabled() const { return data.size() >= HEADER_SIZE && data[sizeof(HEADER) + 1] != 0; }
+
+float DriverMacro::getDesaturateBias() const {
+    return data.size() < HEADER_SIZE ? 0.5 : data[sizeof(HEADER) + 2] / 100.0f;
+}
+} // namespace lemlib
@@ -0,0 +1,89 @@
+#include <cmath>
+#include "lemlib/chassis/ekf.hpp"
+
+lemlib::ExtendedKalmanFilter::ExtendedKalmanFilter(EKFSettings settings)
+    : settings(settings) {}
+
+void lemlib::ExtendedKalmanFilter::reset(Pose pose) {
+    this->pose = pose;
+    // the pose was set by the user, so it is assumed to be exact
+    this->covariance = Matrix<3, 3>();
+}
+
+void lemlib::ExtendedKalmanFilter::predict(Pose prevPose, Pose pose) {
+    // the motion model is the odometry arc. Its jacobian with respect to the state is found by differentiating
+    // x += d * sin(avgHeading) and y += d * cos(avgHeading) with respect to the heading
+    const float deltaX = pose.x - prevPose.x;
+    const float deltaY = pose.y - prevPose.y;
+    const float deltaTheta = pose.theta - prevPose.theta;
+    Matrix<3, 3> jacobian = Matrix<3, 3>::identity();
+    jacobian(0, 2) = deltaY;
+    jacobian(1, 2) = -deltaX;
+
+    // process noise grows with how far the robot moved
+    Matrix<3, 3> noise;
+    const float distance = std::hypot(deltaX, deltaY);
+    noise(0, 0) = settings.translationNoise * distance;
+    noise(1, 1) = settings.translationNoise * distance;
+    noise(2, 2) = settings.rotationNoise * std::fabs(deltaTheta);
+
+    this->pose = pose;
+    this->covariance = jacobian * this->covariance * jacobian.transpose() + noise;
+}
+
+void lemlib::ExtendedKalmanFilter::correctHeading(float heading, float variance) {
+    // the measurement is only the heading, so the innovation covariance is a scalar and nothing needs to be inverted
+    const float innovation = heading - this->pose.theta;
+    const float innovationVariance = this->covariance(2, 2) + variance;
+    if (innovationVariance <= 0) return;
+    Matrix<3, 1> gain;
+    for (size_t i = 0; i < 3; i++) gain(i, 0) = this->covariance(i, 2) / innovationVariance;
+
+    this->pose.x += gain(0, 0) * innovation;
+    this->pose.y += gain(1, 0) * innovation;
+    this->pose.theta += gain(2, 0) * innovation;
+
+    // covariance = (I - K * H) * covariance, where H selects the heading
+    Matrix<1, 3> measurement;
+    measurement(0, 2) = 1;
+    this->covariance = (Matrix<3, 3>::identity() - gain * measurement) * this->covariance;
+}
+
+void lemlib::ExtendedKalmanFilter::correctPosition(float x, float y, float variance) {
+    // the innovation covariance is the 2x2 position block of the covariance plus the measurement noise, which is
+    // small enough to invert directly
+    const float a = this->covariance(0, 0) + variance;
+    const float b = this->covariance(0, 1);
+    const float c = this->covariance(1, 0);
+    const float d = this->covariance(1, 1) + variance;
+    const float determinant = a * d - b * c;
+    if (determinant <= 0) return;
+    Matrix<2, 2> inverse;
+    inverse(0, 0) = d / determinant;
+    inverse(0, 1) = -b / determinant;
+    inverse(1, 0) = -c / determinant;
+    inverse(1, 1) = a / determinant;
+
+    // H selects the position, so covariance * H^T is the first 2 columns of the covariance
+    Matrix<3, 2> crossCovariance;
+    for (size_t i = 0; i < 3; i++) {
+        crossCovariance(i, 0) = this->covariance(i, 0);
+        crossCovariance(i, 1) = this->covariance(i, 1);
+    }
+    const Matrix<3, 2> gain = crossCovariance * inverse;
+
+    const float innovationX = x - this->pose.x;
+    const float innovationY = y - this->pose.y;
+    this->pose.x += gain(0, 0) * innovationX + gain(0, 1) * innovationY;
+    this->pose.y += gain(1, 0) * innovationX + gain(1, 1) * innovationY;
+    this->pose.theta += gain(2, 0) * innovationX + gain(2, 1) * innovationY;
+
+    Matrix<2, 3> measurement;
+    measurement(0, 0) = 1;
+    measurement(1, 1) = 1;
+    this->covariance = (Matrix<3, 3>::identity() - gain * measurement) * this->covariance;
+}
+
+lemlib::Pose lemlib::ExtendedKalmanFilter::getPose() { return this->pose; }
+
+lemlib::EKFSettings lemlib::ExtendedKalmanFilter::getSettings() { return this->settings; }
@@ -0,0 +1,218 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include "lemlib/chassis/fieldDisplay.hpp"
+#include "lemlib/util.hpp"
+
+lemlib::FieldDisplay::FieldDisplay(Chassis& chassis)
+    : chassis(chassis) {}
+
+lemlib::FieldDisplay::~FieldDisplay() {
+    if (this->task == nullptr) return;
+    // the drawing task is only removed while it doesn't hold the buffers
+    this->mutex.take();
+    this->task->remove();
+    delete this->task;
+    this->mutex.give();
+    // without a flush task, nothing else touches the canvas
+    if (this->flushTask == nullptr) {
+        lv_obj_del(this->canvas);
+        return;
+    }
+    this->stopping = true;
+    while (!this->stopped) pros::delay(1);
+}
+
+void lemlib::FieldDisplay::start(FieldDisplaySettings settings) {
+    if (this->task != nullptr) return;
+    this->settings = settings;
+    const size_t area = size_t(settings.size) * settings.size;
+    this->background.assign(area, lv_color_hex(settings.fieldColor));
+    this->pixels.resize(area);
+    this->drawField();
+    this->canvas = lv_canvas_create(lv_scr_act(), nullptr);
+    lv_canvas_set_buffer(this->canvas, this->pixels.data(), settings.size, settings.size, LV_IMG_CF_TRUE_COLOR);
+    lv_obj_set_pos(this->canvas, settings.x, settings.y);
+    this->redrawAll();
+    // drawing is slow but never urgent, so it only runs when nothing else needs the cpu
+    this->task = new pros::Task {[this] {
+        uint32_t now = pros::millis();
+        while (true) {
+            const uint64_t start = pros::micros();
+            this->update();
+            this->monitor.record(pros::micros() - start);
+            pros::Task::delay_until(&now, this->settings.period);
+        }
+    }, TASK_PRIORITY_MIN + 1};
+    this->monitor.attach(*this->task);
+    this->flushTask = lv_task_create(&FieldDisplay::flush, settings.period, LV_TASK_PRIO_LOW, this);
+}
+
+void lemlib::FieldDisplay::drawPath(const Path& path) {
+    if (this->canvas == nullptr) return;
+    this->mutex.take();
+    std::fill(this->background.begin(), this->background.end(), lv_color_hex(this->settings.fieldColor));
+    this->drawField();
+    const lv_color_t color = lv_color_hex(this->settings.pathColor);
+    for (size_t i = 1; i < path.size(); i++) {
+        int x1, y1, x2, y2;
+        this->toPixel(path.at(i - 1).x, path.at(i - 1).y, x1, y1);
+        this->toPixel(path.at(i).x, path.at(i).y, x2, y2);
+        this->drawLine(this->background, x1, y1, x2, y2, color);
+    }
+    this->redrawAll();
+    this->mutex.give();
+}
+
+void lemlib::FieldDisplay::clearPath() {
+    if (this->canvas == nullptr) return;
+    this->mutex.take();
+    std::fill(this->background.begin(), this->background.end(), lv_color_hex(this->settings.fieldColor));
+    this->drawField();
+    this->redrawAll();
+    this->mutex.give();
+}
+
+void lemlib::FieldDisplay::update() {
+    if (this->canvas == nullptr) return;
+    const Pose pose = this->chassis.getPose();
+    int x, y, tipX, tipY;
+    this->markerAt(pose, x, y, tipX, tipY);
+    this->mutex.take();
+    // the marker would be drawn on exactly the same pixels
+    if (x == this->lastX && y == this->lastY && tipX == this->lastTipX && tipY == this->lastTipY) {
+        this->mutex.give();
+        return;
+    }
+    // erase the old marker by copying the background over it
+    const Rect old = this->marker;
+    for (int row = old.y1; row <= old.y2; row++) {
+        const size_t start = size_t(row) * this->settings.size;
+        std::copy(this->background.begin() + start + old.x1, this->background.begin() + start + old.x2 + 1,
+                  this->pixels.begin() + start + old.x1);
+    }
+    this->marker = this->drawMarker(pose);
+    // redraw the old and the new marker in one rectangle. They are usually next to each other
+    this->invalidate(old);
+    this->invalidate(this->marker);
+    this->mutex.give();
+}
+
+void lemlib::FieldDisplay::drawField() {
+    const lv_color_t color = lv_color_hex(this->settings.lineColor);
+    const int last = this->settings.size - 1;
+    const int tiles = std::lround(this->settings.fieldSize / this->settings.tileSize);
+    for (int i = 0; i <= tiles; i++) {
+        const int at = std::min(int(std::lround(float(i) * this->settings.size / tiles)), last);
+        this->drawLine(this->background, at, 0, at, last, color);
+        this->drawLine(this->background, 0, at, last, at, color);
+    }
+}
+
+void lemlib::FieldDisplay::redrawAll() {
+    std::copy(this->background.begin(), this->background.end(), this->pixels.begin());
+    this->marker = this->drawMarker(this->chassis.getPose());
+    this->invalidate({0, 0, int16_t(this->settings.size - 1), int16_t(this->settings.size - 1)});
+}
+
+void lemlib::FieldDisplay::drawLine(std::vector<lv_color_t>& buffer, int x1, int y1, int x2, int y2,
+                                    lv_color_t color) {
+    // Bresenham's line algorithm
+    const int dx = std::abs(x2 - x1);
+    const int dy = -std::abs(y2 - y1);
+    const int stepX = x1 < x2 ? 1 : -1;
+    const int stepY = y1 < y2 ? 1 : -1;
+    int error = dx + dy;
+    const int size = this->settings.size;
+    while (true) {
+        if (x1 >= 0 && x1 < size && y1 >= 0 && y1 < size) buffer[size_t(y1) * size + x1] = color;
+        if (x1 == x2 && y1 == y2) break;
+        const int error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x1 += stepX;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y1 += stepY;
+        }
+    }
+}
+
+lemlib::FieldDisplay::Rect lemlib::FieldDisplay::drawMarker(Pose pose) {
+    const int radius = this->settings.markerRadius;
+    const lv_color_t color = lv_color_hex(this->settings.robotColor);
+    const int size = this->settings.size;
+    int x, y, tipX, tipY;
+    this->markerAt(pose, x, y, tipX, tipY);
+    this->lastX = x;
+    this->lastY = y;
+    this->lastTipX = tipX;
+    this->lastTipY = tipY;
+    // a filled circle, and a line from its center to twice its radius in the direction the robot faces
+    for (int row = std::max(y - radius, 0); row <= std::min(y + radius, size - 1); row++) {
+        for (int column = std::max(x - radius, 0); column <= std::min(x + radius, size - 1); column++) {
+            const int offsetX = column - x;
+            const int offsetY = row - y;
+            if (offsetX * offsetX + offsetY * offsetY > radius * radius) continue;
+            this->pixels[size_t(row) * size + column] = color;
+        }
+    }
+    this->drawLine(this->pixels, x, y, tipX, tipY, color);
+    // entirely off the canvas
+    if (x + 2 * radius < 0 || y + 2 * radius < 0 || x - 2 * radius >= size || y - 2 * radius >= size) return Rect();
+    // the tip is inside a square twice the radius of the circle
+    Rect covered;
+    covered.x1 = std::max(x - 2 * radius, 0);
+    covered.y1 = std::max(y - 2 * radius, 0);
+    covered.x2 = std::min(x + 2 * radius, size - 1);
+    covered.y2 = std::min(y + 2 * radius, size - 1);
+    return covered;
+}
+
+void lemlib::FieldDisplay::markerAt(Pose pose, int& x, int& y, int& tipX, int& tipY) const {
+    const int length = 2 * this->settings.markerRadius;
+    this->toPixel(pose.x, pose.y, x, y);
+    tipX = x + std::lround(length * std::sin(degToRad(pose.theta)));
+    tipY = y - std::lround(length * std::cos(degToRad(pose.theta)));
+}
+
+void lemlib::FieldDisplay::invalidate(Rect rect) {
+    if (rect.x2 < rect.x1) return;
+    if (this->pending.x2 < this->pending.x1) {
+        this->pending = rect;
+        return;
+    }
+    this->pending.x1 = std::min(this->pending.x1, rect.x1);
+    this->pending.y1 = std::min(this->pending.y1, rect.y1);
+    this->pending.x2 = std::max(this->pending.x2, rect.x2);
+    this->pending.y2 = std::max(this->pending.y2, rect.y2);
+}
+
+void lemlib::FieldDisplay::flush(void* display) {
+    FieldDisplay* self = static_cast<FieldDisplay*>(display);
+    if (self->stopping) {
+        lv_obj_del(self->canvas);
+        lv_task_del(self->flushTask);
+        // the display may be gone as soon as this is set
+        self->stopped = true;
+        return;
+    }
+    // skipped instead of waiting for a redraw, so the LVGL task never blocks on the display
+    if (!self->mutex.take(0)) return;
+    const Rect rect = self->pending;
+    self->pending = Rect();
+    self->mutex.give();
+    if (rect.x2 < rect.x1) return;
+    lv_area_t coords;
+    lv_obj_get_coords(self->canvas, &coords);
+    const lv_area_t area = {lv_coord_t(coords.x1 + rect.x1), lv_coord_t(coords.y1 + rect.y1),
+                            lv_coord_t(coords.x1 + rect.x2), lv_coord_t(coords.y1 + rect.y2)};
+    lv_inv_area(&area);
+}
+
+void lemlib::FieldDisplay::toPixel(float x, float y, int& px, int& py) const {
+    const float scale = this->settings.size / this->settings.fieldSize;
+    px = std::lround((x + this->settings.fieldSize / 2) * scale);
+    py = std::lround((this->settings.fieldSize / 2 - y) * scale);
+}
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include "pros/misc.hpp"
+#include "lemlib/chassis/flightRecorder.hpp"
+#include "lemlib/chassis/odom.hpp"
+
+// time between checks of the competition state, in milliseconds
+constexpr uint32_t POLL_PERIOD = 20;
+// files are named name_000.lfr to name_999.lfr
+constexpr int MAX_FILES = 1000;
+
+// the recorder dumped by the terminate handler
+static std::atomic<lemlib::FlightRecorder*> terminateRecorder = nullptr;
+
+/**
+ * @brief Write a float, little endian. The V5 is little endian, so the bytes are copied directly
+ */
+static uint8_t* put(uint8_t* out, float value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+/**
+ * @brief Round a size up to a power of 2
+ */
+static size_t roundUp(size_t size) {
+    size_t rounded = 1;
+    while (rounded < size) rounded <<= 1;
+    return rounded;
+}
+
+namespace lemlib {
+FlightRecorder::FlightRecorder(size_t capacity, const std::string& name)
+    : ring(new uint8_t[roundUp(capacity)]()),
+      mask(roundUp(capacity) - 1),
+      name(name),
+      task([this] { taskLoop(); }, TASK_PRIORITY_MIN + 1) {
+    monitor.attach(task);
+    setFormat("{message}");
+    setLowestLevel(Level::DEBUG);
+}
+
+void FlightRecorder::record(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time) {
+    if (dumping.load(std::memory_order_relaxed)) return;
+    uint8_t frame[BinaryTelemetry::MAX_ENCODED];
+    const size_t length = BinaryTelemetry::encodeFrame(type, payload, size, time, frame);
+    // reserve the bytes, so tasks recording at the same time write to different parts of the ring
+    const size_t start = head.fetch_add(length, std::memory_order_relaxed) & mask;
+    const size_t first = std::min(length, mask + 1 - start);
+    std::memcpy(ring + start, frame, first);
+    std::memcpy(ring, frame + first, length - first);
+}
+
+void FlightRecorder::recordFrame(const SensorFrame& frame) {
+    uint8_t payload[5 * sizeof(float)];
+    uint8_t* out = put(put(payload, frame.vertical1), frame.vertical2);
+    put(put(put(out, frame.horizontal1), frame.horizontal2), frame.imu);
+    record(TelemetryType::SENSOR_FRAME, payload, sizeof(payload), frame.time / 1000);
+}
+
+void FlightRecorder::recordPose(Pose pose, uint32_t time) {
+    uint8_t payload[3 * sizeof(float)];
+    put(put(put(payload, pose.x), pose.y), pose.theta);
+    record(TelemetryType::POSE, payload, sizeof(payload), time);
+}
+
+void FlightRecorder::recordMotion(const MotionSample& sample) {
+    uint8_t payload[MotionSample::PACKED_SIZE];
+    sample.pack(payload);
+    record(TelemetryType::MOTION, payload, sizeof(payload), sample.time);
+}
+
+void FlightRecorder::sendMessage(const Message& message) {
+    uint8_t payload[BinaryTelemetry::MAX_PAYLOAD];
+    const size_t length = BinaryTelemetry::packMessage(message, payload);
+    record(TelemetryType::MESSAGE, payload, length, message.time);
+}
+
+void FlightRecorder::dump() { task.notify(); }
+
+bool FlightRecorder::dumpNow() {
+    if (dumping.exchange(true)) return false;
+    // skip files that are already on the card, so old dumps aren't overwritten. The path is formatted without
+    // allocating, so only the file itself needs the heap
+    FILE* file = nullptr;
+    for (char path[64]; fileIndex < MAX_FILES && file == nullptr; fileIndex++) {
+        std::snprintf(path, sizeof(path), "/usd/%s_%03d.lfr", name.c_str(), fileIndex);
+        FILE* existing = std::fopen(path, "r");
+        if (existing != nullptr) {
+            std::fclose(existing);
+            continue;
+        }
+        file = std::fopen(path, "w");
+    }
+    if (file != nullptr) {
+        // the oldest bytes are the ones the next record would overwrite
+        const uint32_t end = head.load(std::memory_order_relaxed);
+        const size_t size = std::min(size_t(end), mask + 1);
+        const size_t start = (end - size) & mask;
+        const size_t first = std::min(size, mask + 1 - start);
+        std::fwrite(ring + start, 1, first, file);
+        std::fwrite(ring, 1, size - first, file);
+        std::fclose(file);
+    }
+    dumping = false;
+    return file != nullptr;
+}
+
+void FlightRecorder::setDumpOnCompetitionChange(bool enabled) { dumpOnCompetitionChange = enabled; }
+
+void FlightRecorder::dumpOnTerminate() {
+    terminateRecorder = this;
+    std::set_terminate([] {
+        FlightRecorder* recorder = terminateRecorder.load();
+        if (recorder != nullptr) recorder->dumpNow();
+        std::abort();
+    });
+}
+
+void FlightRecorder::taskLoop() {
+    uint8_t status = pros::competition::get_status();
+    while (true) {
+        const bool asked = pros::Task::notify_take(true, POLL_PERIOD) != 0;
+        const uint32_t start = pros::micros();
+        const uint8_t newStatus = pros::competition::get_status();
+        const bool changed = newStatus != status;
+        status = newStatus;
+        if (asked || (changed && dumpOnCompetitionChange)) dumpNow();
+        monitor.record(pros::micros() - start);
+    }
+}
+} // namespace lemlib
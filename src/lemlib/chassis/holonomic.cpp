@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/chassis/holonomic.hpp"
+
+// the voltage of full power, in millivolts
+constexpr float FULL_VOLTAGE = 12000;
+
+/**
+ * @brief Convert a power from -127 to 127 to millivolts
+ */
+static int32_t voltage(float power) { return std::round(std::clamp(power, -127.0f, 127.0f) * FULL_VOLTAGE / 127); }
+
+lemlib::HolonomicDrivetrain::HolonomicDrivetrain(pros::MotorGroup* frontLeft, pros::MotorGroup* frontRight,
+                                                 pros::MotorGroup* backLeft, pros::MotorGroup* backRight)
+    : frontLeft(frontLeft),
+      frontRight(frontRight),
+      backLeft(backLeft),
+      backRight(backRight) {}
+
+lemlib::WheelPowers lemlib::HolonomicDrivetrain::inverseKinematics(float forward, float strafe, float turn,
+                                                                   float maxPower) {
+    WheelPowers powers {forward + strafe + turn, forward - strafe - turn, forward - strafe + turn,
+                        forward + strafe - turn};
+    const float largest = std::max({std::fabs(powers.frontLeft), std::fabs(powers.frontRight),
+                                    std::fabs(powers.backLeft), std::fabs(powers.backRight)});
+    if (largest > maxPower) {
+        const float ratio = maxPower / largest;
+        powers.frontLeft *= ratio;
+        powers.frontRight *= ratio;
+        powers.backLeft *= ratio;
+        powers.backRight *= ratio;
+    }
+    return powers;
+}
+
+void lemlib::HolonomicDrivetrain::move(const WheelPowers& powers) {
+    this->frontLeft->move_voltage(voltage(powers.frontLeft));
+    this->frontRight->move_voltage(voltage(powers.frontRight));
+    this->backLeft->move_voltage(voltage(powers.backLeft));
+    this->backRight->move_voltage(voltage(powers.backRight));
+}
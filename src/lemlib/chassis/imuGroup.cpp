@@ -0,0 +1,204 @@
+#include <cmath>
+#include "pros/error.h"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/chassis/imuGroup.hpp"
+
+lemlib::ImuGroup::ImuGroup(std::vector<pros::Imu*> imus, std::vector<float> weights, float maxDisagreement)
+    : pros::Imu(0),
+      maxDisagreement(maxDisagreement) {
+    if (imus.size() > MAX_IMUS) infoSink()->warn("An IMU group can only hold {} IMUs, leaving the rest out", MAX_IMUS);
+    for (size_t i = 0; i < imus.size() && i < MAX_IMUS; i++)
+        this->members.push({imus[i], i < weights.size() ? weights[i] : 1.0f, NAN, false, true});
+}
+
+void lemlib::ImuGroup::rebase() const {
+    for (Member& member : this->members) {
+        member.lastReading = NAN;
+        member.active = false;
+        member.readable = true;
+    }
+    this->lastDelta = 0;
+}
+
+std::int32_t lemlib::ImuGroup::reset(bool blocking) const {
+    this->mutex.take();
+    // start every calibration before waiting for any of them, so they run at the same time
+    bool started = false;
+    for (const Member& member : this->members) started |= member.imu->reset(false) != PROS_ERR;
+    this->rotation = 0;
+    this->headingOffset = 0;
+    this->rebase();
+    this->mutex.give();
+    while (blocking && this->is_calibrating()) pros::delay(10);
+    return started ? 1 : PROS_ERR;
+}
+
+std::int32_t lemlib::ImuGroup::set_data_rate(std::uint32_t rate) const {
+    bool set = false;
+    for (const Member& member : this->members) set |= member.imu->set_data_rate(rate) != PROS_ERR;
+    return set ? 1 : PROS_ERR;
+}
+
+double lemlib::ImuGroup::get_rotation() const {
+    this->mutex.take();
+    // measure the change in rotation of each IMU since its last read
+    StaticVector<double, MAX_IMUS> deltas(this->members.size(), NAN);
+    bool read = false;
+    for (size_t i = 0; i < this->members.size(); i++) {
+        Member& member = this->members[i];
+        const double reading = member.imu->get_rotation();
+        if (!std::isfinite(reading)) {
+            if (member.readable) infoSink()->warn("IMU {} of the group can't be read, leaving it out", i);
+            member.lastReading = NAN;
+            member.readable = false;
+            continue;
+        }
+        read = true;
+        member.readable = true;
+        // an IMU that couldn't be read last time starts measuring from here, so it rejoins without a jump
+        if (!std::isnan(member.lastReading)) deltas[i] = reading - member.lastReading;
+        member.lastReading = reading;
+    }
+    if (!read) {
+        for (Member& member : this->members) member.active = false;
+        this->mutex.give();
+        return PROS_ERR_F;
+    }
+
+    // the heading changes smoothly, so the change closest to the last one is the most likely to be right. The
+    // changes that agree with it are averaged, and the rest are rejected
+    double reference = NAN;
+    for (const double delta : deltas) {
+        if (std::isnan(delta)) continue;
+        if (std::isnan(reference) || std::fabs(delta - this->lastDelta) < std::fabs(reference - this->lastDelta))
+            reference = delta;
+    }
+    double sum = 0;
+    double totalWeight = 0;
+    for (size_t i = 0; i < this->members.size(); i++) {
+        Member& member = this->members[i];
+        member.active = !std::isnan(deltas[i]) && std::fabs(deltas[i] - reference) <= this->maxDisagreement;
+        if (!member.active) continue;
+        sum += member.weight * deltas[i];
+        totalWeight += member.weight;
+    }
+    this->lastDelta = totalWeight > 0 ? sum / totalWeight : 0;
+    this->rotation += this->lastDelta;
+    const double rotation = this->rotation;
+    this->mutex.give();
+    return rotation;
+}
+
+double lemlib::ImuGroup::get_heading() const {
+    const double rotation = this->get_rotation();
+    if (!std::isfinite(rotation)) return PROS_ERR_F;
+    this->mutex.take();
+    const double heading = std::fmod(rotation + this->headingOffset, 360);
+    this->mutex.give();
+    return heading < 0 ? heading + 360 : heading;
+}
+
+pros::c::imu_gyro_s_t lemlib::ImuGroup::get_gyro_rate() const {
+    pros::c::imu_gyro_s_t sum {0, 0, 0};
+    float totalWeight = 0;
+    for (const Member& member : this->members) {
+        const pros::c::imu_gyro_s_t rate = member.imu->get_gyro_rate();
+        if (!std::isfinite(rate.x) || !std::isfinite(rate.y) || !std::isfinite(rate.z)) continue;
+        sum.x += member.weight * rate.x;
+        sum.y += member.weight * rate.y;
+        sum.z += member.weight * rate.z;
+        totalWeight += member.weight;
+    }
+    if (totalWeight == 0) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return {sum.x / totalWeight, sum.y / totalWeight, sum.z / totalWeight};
+}
+
+std::int32_t lemlib::ImuGroup::tare_rotation() const { return this->set_rotation(0); }
+
+std::int32_t lemlib::ImuGroup::tare_heading() const { return this->set_heading(0); }
+
+std::int32_t lemlib::ImuGroup::set_rotation(const double target) const {
+    this->mutex.take();
+    this->rotation = target;
+    this->mutex.give();
+    return 1;
+}
+
+std::int32_t lemlib::ImuGroup::set_heading(const double target) const {
+    this->mutex.take();
+    this->headingOffset = target - this->rotation;
+    this->mutex.give();
+    return 1;
+}
+
+pros::c::imu_status_e_t lemlib::ImuGroup::get_status() const {
+    if (this->is_calibrating()) return pros::c::E_IMU_STATUS_CALIBRATING;
+    for (const Member& member : this->members)
+        if (member.imu->get_status() != pros::c::E_IMU_STATUS_ERROR) return pros::c::E_IMU_STATUS_READY;
+    return pros::c::E_IMU_STATUS_ERROR;
+}
+
+bool lemlib::ImuGroup::is_calibrating() const {
+    for (const Member& member : this->members)
+        if (member.imu->is_calibrating()) return true;
+    return false;
+}
+
+pros::Imu* lemlib::ImuGroup::primary() const {
+    for (const Member& member : this->members)
+        if (member.readable) return member.imu;
+    return this->members.empty() ? nullptr : this->members[0].imu;
+}
+
+double lemlib::ImuGroup::get_pitch() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    return imu == nullptr ? PROS_ERR_F : imu->get_pitch();
+}
+
+double lemlib::ImuGroup::get_roll() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    return imu == nullptr ? PROS_ERR_F : imu->get_roll();
+}
+
+double lemlib::ImuGroup::get_yaw() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    return imu == nullptr ? PROS_ERR_F : imu->get_yaw();
+}
+
+pros::c::euler_s_t lemlib::ImuGroup::get_euler() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return imu->get_euler();
+}
+
+pros::c::quaternion_s_t lemlib::ImuGroup::get_quaternion() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return imu->get_quaternion();
+}
+
+pros::c::imu_accel_s_t lemlib::ImuGroup::get_accel() const {
+    this->mutex.take();
+    pros::Imu* imu = this->primary();
+    this->mutex.give();
+    if (imu == nullptr) return {PROS_ERR_F, PROS_ERR_F, PROS_ERR_F};
+    return imu->get_accel();
+}
+
+size_t lemlib::ImuGroup::getActiveCount() const {
+    this->mutex.take();
+    size_t count = 0;
+    for (const Member& member : this->members) count += member.active;
+    this->mutex.give();
+    return count;
+}
@@ -0,0 +1,94 @@
+#include <cmath>
+#include "lemlib/chassis/motionHandle.hpp"
+
+bool lemlib::exitConditionMet(MotionRecord& record) {
+    for (MotionCallback& callback : record.callbacks) {
+        if (callback.trigger != MotionTrigger::CONDITION || callback.state != MotionCallback::READY) continue;
+        if (!callback.condition(callback.arg)) continue;
+        // the slot is only written while it is free, so it is safe to mark it done here
+        callback.state = MotionCallback::FIRED;
+        return true;
+    }
+    return false;
+}
+
+lemlib::MotionHandle::MotionHandle(MotionExecutor* executor, uint32_t id)
+    : executor(executor),
+      id(id) {}
+
+lemlib::MotionRecord* lemlib::MotionHandle::record() const {
+    if (this->executor == nullptr) return nullptr;
+    return this->executor->getMotionRecord(this->id);
+}
+
+float lemlib::MotionHandle::progress() const {
+    const MotionRecord* record = this->record();
+    return record == nullptr ? NAN : record->progress.load();
+}
+
+bool lemlib::MotionHandle::isDone() const { return this->endReason() != MotionEndReason::NOT_DONE; }
+
+lemlib::MotionEndReason lemlib::MotionHandle::endReason() const {
+    const MotionRecord* record = this->record();
+    return record == nullptr ? MotionEndReason::UNKNOWN : record->reason.load();
+}
+
+void lemlib::MotionHandle::wait() const { this->waitUntil(INFINITY); }
+
+void lemlib::MotionHandle::waitUntil(float progress) const {
+    if (this->executor != nullptr) this->executor->waitForMotion(this->id, progress);
+}
+
+bool lemlib::MotionHandle::addCallback(MotionTrigger trigger, float threshold, void (*callback)(void*), void* arg,
+                                       bool deferred, bool (*condition)(void*)) const {
+    MotionRecord* record = this->record();
+    if (record == nullptr || (callback == nullptr && condition == nullptr)) return false;
+    if (record->reason != MotionEndReason::NOT_DONE) return false;
+    for (MotionCallback& slot : record->callbacks) {
+        // claim a free slot, then fill it in before the motion task can see it
+        uint8_t state = MotionCallback::EMPTY;
+        if (!slot.state.compare_exchange_strong(state, MotionCallback::WRITING)) continue;
+        slot.trigger = trigger;
+        slot.deferred = deferred;
+        slot.threshold = threshold;
+        slot.callback = callback;
+        slot.condition = condition;
+        slot.arg = arg;
+        slot.state = MotionCallback::READY;
+        // the motion may have ended while the slot was written, and skipped it. Whichever side takes the slot from
+        // READY runs it, so it runs exactly once
+        if (record->reason == MotionEndReason::NOT_DONE) return true;
+        uint8_t ready = MotionCallback::READY;
+        if (!slot.state.compare_exchange_strong(ready, MotionCallback::FIRED)) return true;
+        if (trigger != MotionTrigger::END) return false;
+        callback(arg);
+        return true;
+    }
+    return false;
+}
+
+bool lemlib::MotionHandle::onProgress(float threshold, void (*callback)(void*), void* arg, bool deferred) const {
+    return this->addCallback(MotionTrigger::PROGRESS, threshold, callback, arg, deferred);
+}
+
+bool lemlib::MotionHandle::onPathIndex(size_t index, void (*callback)(void*), void* arg, bool deferred) const {
+    return this->addCallback(MotionTrigger::PATH_INDEX, index, callback, arg, deferred);
+}
+
+bool lemlib::MotionHandle::onTime(uint32_t time, void (*callback)(void*), void* arg, bool deferred) const {
+    return this->addCallback(MotionTrigger::TIME, time, callback, arg, deferred);
+}
+
+bool lemlib::MotionHandle::onDone(void (*callback)(void*), void* arg, bool deferred) const {
+    return this->addCallback(MotionTrigger::END, 0, callback, arg, deferred);
+}
+
+bool lemlib::MotionHandle::onCollision(void (*callback)(void*), void* arg, bool deferred) const {
+    return this->addCallback(MotionTrigger::COLLISION, 0, callback, arg, deferred);
+}
+
+bool lemlib::MotionHandle::exitWhen(bool (*condition)(void*), void* arg) const {
+    return this->addCallback(MotionTrigger::CONDITION, 0, nullptr, arg, false, condition);
+}
+
+uint32_t lemlib::MotionHandle::getId() const { return this->id; }
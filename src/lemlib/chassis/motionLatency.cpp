@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// how long a motion drives before it is preempted or cancelled, in milliseconds
+constexpr uint32_t DRIVE_TIME = 100;
+// longest time a motion can take to drive or stop before the sample is skipped, in milliseconds
+constexpr uint32_t MAX_WAIT = 500;
+// time the robot rests between samples, in milliseconds
+constexpr uint32_t REST_TIME = 250;
+
+/**
+ * @brief Wait until the timed motion sends its first drive command, or stop command
+ *
+ * @param latency where the time from start is written, in microseconds
+ * @return false the command didn't come in time
+ */
+static bool waitForCommand(const std::atomic<uint32_t>& time, uint32_t start, std::vector<uint32_t>& latency) {
+    const uint32_t begin = pros::millis();
+    while (time == 0) {
+        if (pros::millis() - begin > MAX_WAIT) return false;
+        pros::delay(1);
+    }
+    latency.push_back(time - start);
+    return true;
+}
+
+lemlib::MotionLatency lemlib::Chassis::measureMotionLatency(int samples, float distance) {
+    this->cancelAllMotions();
+    std::vector<uint32_t> start, preempt, stop;
+    int skipped = 0;
+    for (int i = 0; i < samples; i++) {
+        // drive forwards and backwards in turn, so the robot stays near where it started
+        const bool forwards = i % 2 == 0;
+        const Pose pose = this->getPose(true);
+        const float direction = forwards ? distance : -distance;
+        const float x = pose.x + direction * std::sin(pose.theta);
+        const float y = pose.y + direction * std::cos(pose.theta);
+
+        // the motion ids are only taken by the motions queued here, so the next one is known before it is queued
+        this->latencyDrive = 0;
+        this->latencyMotion = this->motionsQueued + 1;
+        uint32_t now = pros::micros();
+        this->moveToPoint(x, y, 2000, {.forwards = forwards}, true);
+        const bool started = waitForCommand(this->latencyDrive, now, start);
+        pros::delay(DRIVE_TIME);
+
+        this->latencyDrive = 0;
+        this->latencyStop = 0;
+        this->latencyMotion = this->motionsQueued + 1;
+        now = pros::micros();
+        this->moveToPoint(pose.x, pose.y, 2000, {.forwards = !forwards, .priority = MotionPriority::URGENT}, true);
+        const bool preempted = waitForCommand(this->latencyDrive, now, preempt);
+        pros::delay(DRIVE_TIME);
+
+        now = pros::micros();
+        // the preempted motion would run again once the urgent motion is done, so it is cancelled too
+        this->cancelAllMotions();
+        const bool stopped = waitForCommand(this->latencyStop, now, stop);
+        this->latencyMotion = 0;
+
+        if (!started || !preempted || !stopped) skipped++;
+        pros::delay(REST_TIME);
+    }
+    MotionLatency result;
+    result.samples = std::min({start.size(), preempt.size(), stop.size()});
+    result.start = timingStats(start.data(), start.size());
+    result.preempt = timingStats(preempt.data(), preempt.size());
+    result.stop = timingStats(stop.data(), stop.size());
+    if (skipped != 0) infoSink()->warn("Motion latency: {} samples were skipped, since a motion didn't drive", skipped);
+    infoSink()->info("Motion latency in us, p50/p99/max: start {}/{}/{}, preempt {}/{}/{}, stop {}/{}/{}",
+                     result.start.p50, result.start.p99, result.start.max, result.preempt.p50, result.preempt.p99,
+                     result.preempt.max, result.stop.p50, result.stop.p99, result.stop.max);
+    return result;
+}
@@ -0,0 +1,67 @@
+#include <cstdio>
+#include <cstring>
+#include "lemlib/chassis/motionLog.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// time between appends to the file, in milliseconds. Motions take longer than this, so the queue barely fills
+constexpr uint32_t WRITE_PERIOD = 250;
+static_assert(lemlib::MotionSummary::PACKED_SIZE <= lemlib::BinaryTelemetry::MAX_PAYLOAD);
+
+/**
+ * @brief Write a value, little endian. The V5 is little endian, so the bytes are copied directly
+ */
+template <typename T> static uint8_t* put(uint8_t* out, T value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+namespace lemlib {
+void MotionSummary::pack(uint8_t* out) const {
+    out[0] = uint8_t(type);
+    out[1] = uint8_t(reason);
+    out = put(put(out + 2, tag), duration);
+    out = put(put(put(out, targetX), targetY), targetTheta);
+    put(put(put(out, lateralError), angularError), maxSpeed);
+}
+
+MotionLog::MotionLog(const std::string& path, uint16_t tag, size_t capacity)
+    : path(path),
+      tag(tag),
+      queue(capacity),
+      task([this] { taskLoop(); }, TASK_PRIORITY_MIN + 1) {}
+
+void MotionLog::record(MotionSummary summary) {
+    summary.tag = tag;
+    if (!queue.push(summary)) dropped++;
+}
+
+void MotionLog::setTag(uint16_t tag) { this->tag = tag; }
+
+uint32_t MotionLog::getDropped() const { return dropped; }
+
+void MotionLog::taskLoop() {
+    bool warned = false;
+    uint32_t now = pros::millis();
+    while (true) {
+        pros::Task::delay_until(&now, WRITE_PERIOD);
+        if (queue.size() == 0) continue;
+        // the file is only open while it is written, so turning the robot off can't lose summaries
+        FILE* file = std::fopen(path.c_str(), "ab");
+        if (file == nullptr && !warned) {
+            infoSink()->warn("Couldn't open the motion log {}. Is there an SD card?", path);
+            warned = true;
+        }
+        MotionSummary summary;
+        while (queue.pop(summary)) {
+            uint8_t payload[MotionSummary::PACKED_SIZE];
+            summary.pack(payload);
+            uint8_t frame[BinaryTelemetry::MAX_ENCODED];
+            const size_t length = BinaryTelemetry::encodeFrame(TelemetryType::MOTION_SUMMARY, payload,
+                                                               sizeof(payload), summary.startTime, frame);
+            if (file == nullptr || std::fwrite(frame, 1, length, file) != length) dropped++;
+        }
+        if (file != nullptr) std::fclose(file);
+    }
+}
+} // namespace lemlib
@@ -0,0 +1,70 @@
+#include <cstring>
+#include <string_view>
+#include "lemlib/chassis/motionTrace.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+
+// time between drains of the queue, in milliseconds
+constexpr uint32_t DRAIN_PERIOD = 20;
+static_assert(lemlib::MotionSample::PACKED_SIZE <= lemlib::BinaryTelemetry::MAX_PAYLOAD);
+
+/**
+ * @brief Write a float, little endian. The V5 is little endian, so the bytes are copied directly
+ */
+static uint8_t* put(uint8_t* out, float value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+/**
+ * @brief Write the terms of a PID
+ */
+static uint8_t* put(uint8_t* out, const lemlib::PID::Terms& terms) {
+    return put(put(put(out, terms.p), terms.i), terms.d);
+}
+
+namespace lemlib {
+void MotionSample::pack(uint8_t* out) const {
+    out[0] = uint8_t(type);
+    out[1] = clamps;
+    out = put(put(out + 2, lateralError), angularError);
+    out = put(put(out, lateral), angular);
+    out = put(put(put(put(out, targetX), targetY), curvature), slipLimit);
+    put(put(out, left), right);
+}
+
+MotionTrace::MotionTrace(TraceOutput output, size_t capacity, const std::string& name)
+    : output(output),
+      queue(capacity),
+      writer(output == TraceOutput::SD ? new SdWriter(name, "lmt") : nullptr),
+      task([this] { taskLoop(); }, TASK_PRIORITY_MIN + 1) {
+    monitor.attach(task);
+}
+
+void MotionTrace::record(const MotionSample& sample) {
+    if (!queue.push(sample)) dropped++;
+}
+
+uint32_t MotionTrace::getDropped() const { return dropped + (writer != nullptr ? writer->getDropped() : 0); }
+
+void MotionTrace::taskLoop() {
+    uint32_t now = pros::millis();
+    while (true) {
+        const uint32_t start = pros::micros();
+        MotionSample sample;
+        while (queue.pop(sample)) {
+            uint8_t payload[MotionSample::PACKED_SIZE];
+            sample.pack(payload);
+            if (output == TraceOutput::TELEMETRY) {
+                binaryTelemetry().sendFrame(TelemetryType::MOTION, payload, sizeof(payload), sample.time);
+                continue;
+            }
+            uint8_t frame[BinaryTelemetry::MAX_ENCODED];
+            const size_t length =
+                BinaryTelemetry::encodeFrame(TelemetryType::MOTION, payload, sizeof(payload), sample.time, frame);
+            writer->write({std::string_view(reinterpret_cast<const char*>(frame), length)});
+        }
+        monitor.record(pros::micros() - start);
+        pros::Task::delay_until(&now, DRAIN_PERIOD);
+    }
+}
+} // namespace lemlib
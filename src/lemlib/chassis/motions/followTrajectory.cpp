@@ -0,0 +1,228 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/path/pathCache.hpp"
+#include "lemlib/timer.hpp"
+#include "lemlib/util.hpp"
+
+// RAMSETE convergence gain, the usual 2 per square meter converted to per square inch
+constexpr float RAMSETE_B = 2 / (39.37 * 39.37);
+// RAMSETE damping ratio
+constexpr float RAMSETE_ZETA = 0.7;
+// acceleration used to plan trajectories if the lateral controller has no acceleration or slew limit, in in/s^2
+constexpr float DEFAULT_ACCELERATION = 80;
+// iterations of the bisection that finds the slowest speed that meets a deadline. Each halves the error
+constexpr int DEADLINE_ITERATIONS = 12;
+
+lemlib::TrajectoryConstraints lemlib::Chassis::trajectoryConstraints(float maxSpeed) {
+    const float topSpeed = drivetrain.kinematics().topSpeed;
+    TrajectoryConstraints constraints;
+    constraints.topSpeed = topSpeed;
+    constraints.horizontalDrift = drivetrain.horizontalDrift;
+    constraints.maxVelocity = lateralSettings.maxVelocity > 0 ? lateralSettings.maxVelocity : topSpeed;
+    constraints.maxVelocity = std::fmin(constraints.maxVelocity, topSpeed * std::fabs(maxSpeed) / 127);
+    // the slew rate is the most power the output can change by every 10 ms
+    if (lateralSettings.maxAcceleration > 0) constraints.maxAcceleration = lateralSettings.maxAcceleration;
+    else if (lateralSettings.slew > 0) constraints.maxAcceleration = lateralSettings.slew * topSpeed / 127 * 100;
+    else constraints.maxAcceleration = DEFAULT_ACCELERATION;
+    return constraints;
+}
+
+float lemlib::Chassis::deadlineScale(float distance, float speed, float deadline, float maxSpeed) {
+    if (deadline <= 0) return 1;
+    const TrajectoryConstraints constraints = this->trajectoryConstraints(maxSpeed);
+    const float time = deadline / 1000;
+    const float acceleration = constraints.maxAcceleration;
+    const float topSpeed = constraints.maxVelocity;
+    distance = std::fabs(distance);
+    speed = std::fabs(speed);
+    // the time a trapezoidal profile takes, if it goes from the speed of the robot to a cruise speed, holds it, and
+    // decelerates to a stop
+    const auto duration = [&](float cruise) {
+        const float change = std::fabs(cruise - speed) / acceleration;
+        const float stop = cruise / acceleration;
+        const float cruiseDistance = distance - (speed + cruise) / 2 * change - cruise / 2 * stop;
+        return change + stop + cruiseDistance / cruise;
+    };
+    if (topSpeed <= 0 || duration(topSpeed) > time) return 1;
+    // slower cruise speeds take longer, so the slowest one that is still on time is found by bisection
+    float low = 0;
+    float high = topSpeed;
+    for (int i = 0; i < DEADLINE_ITERATIONS; i++) {
+        const float middle = (low + high) / 2;
+        if (middle > 0 && duration(middle) <= time) high = middle;
+        else low = middle;
+    }
+    return high / topSpeed;
+}
+
+lemlib::Trajectory lemlib::Chassis::planPose(Pose start, float x, float y, float theta, MoveToPoseParams params) {
+    TrajectoryConstraints constraints = this->trajectoryConstraints(params.maxSpeed);
+    if (params.horizontalDrift != 0) constraints.horizontalDrift = params.horizontalDrift;
+    // the trajectory is planned in standard form
+    const Pose startPose(start.x, start.y, M_PI_2 - degToRad(start.theta));
+    const Pose target(x, y, M_PI_2 - degToRad(theta));
+    return Trajectory::boomerang(startPose, target, params.lead, params.forwards, constraints);
+}
+
+bool lemlib::Chassis::preloadTrajectory(const asset& path, bool forwards) {
+    const bool loaded =
+        pathCache().getTrajectory(path, forwards, this->trajectoryConstraints(), this->fieldTransform).size() != 0;
+    if (!loaded) infoSink()->error("Failed to preload trajectory! Do you have the right format?");
+    return loaded;
+}
+
+lemlib::MotionHandle lemlib::Chassis::followTrajectory(const asset& path, int timeout, bool forwards, bool async) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::TRAJECTORY};
+        command.timeout = timeout;
+        command.path = path;
+        command.forwards = forwards;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    // plan the path on the motion task, so the caller doesn't wait for it
+    const Trajectory& trajectory = pathCache().getTrajectory(path, forwards, this->trajectoryConstraints());
+    return this->followTrajectory(trajectory, timeout, false);
+}
+
+lemlib::MotionHandle lemlib::Chassis::followTrajectory(const Trajectory& trajectory, int timeout, bool async) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::TRAJECTORY};
+        command.timeout = timeout;
+        command.trajectory = &trajectory;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
+
+    if (trajectory.size() == 0) {
+        infoSink()->error("Trajectory is empty! Skipping motion");
+        distTraveled = -1;
+        this->endMotion(MotionEndReason::CANCELLED);
+        return this->currentMotion();
+    }
+
+    lateralSmallExit.reset();
+    const DrivetrainKinematics kinematics = drivetrain.kinematics();
+    const float topSpeed = kinematics.topSpeed;
+    const float duration = trajectory.getDuration();
+    const TrajectoryState& end = trajectory.at(trajectory.size() - 1);
+    this->pathEnd = Pose(end.x, end.y);
+    Pose lastPose = getPose(true, true);
+    distTraveled = 0;
+    Timer timer(timeout);
+    bool settled = false;
+    // whether the PIDs are settling the error left at the end of the trajectory
+    bool settling = false;
+    // hot motors play the trajectory slower, which lowers the velocity by the scale and the acceleration by its
+    // square, so they draw less current before the firmware limits it
+    const float thermal = this->thermalScale();
+
+    while (!timer.isDone(this->tickTime) && this->motionRunning()) {
+        const Pose pose = getPose(true, true);
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        // where the robot should be now
+        const float time = timer.getTimePassedMicros(this->tickTime) / 1000000.0 * thermal;
+        TrajectoryState reference = trajectory.sample(time);
+        reference.velocity *= thermal;
+        reference.angularVelocity *= thermal;
+        reference.acceleration *= thermal * thermal;
+        this->reportProgress(trajectory.indexAt(time));
+
+        // once the trajectory has ended, wait for the robot to settle on the last point
+        const bool ended = time >= duration;
+        if (ended) {
+            const float distance = std::hypot(end.x - pose.x, end.y - pose.y);
+            settled = lateralSmallExit.update(distance, this->tickTime);
+            if (settled) break;
+        }
+
+        // error in the frame of the robot
+        const float dx = reference.x - pose.x;
+        const float dy = reference.y - pose.y;
+        const float forwardError = std::cos(pose.theta) * dx + std::sin(pose.theta) * dy;
+        const float sideError = -std::sin(pose.theta) * dx + std::cos(pose.theta) * dy;
+        const float headingError = angleError(reference.theta, pose.theta);
+
+        // the RAMSETE gain is 0 once the reference has stopped, so the last error is settled with the PIDs
+        if (ended) {
+            if (!settling) {
+                settling = true;
+                lateralPID.reset();
+                angularPID.reset();
+            }
+            const float lateralOut = std::clamp(lateralPID.update(forwardError), -127.0f, 127.0f);
+            const float angularOut = std::clamp(angularPID.update(radToDeg(headingError)), -127.0f, 127.0f);
+            // leave the wheel that is driven hardest enough power to turn
+            const float ratio = std::fmin(127 / (std::fabs(lateralOut) + std::fabs(angularOut)), 1);
+            MotionSample sample;
+            sample.lateralError = forwardError;
+            sample.angularError = radToDeg(headingError);
+            sample.lateral = lateralPID.getTerms();
+            sample.angular = angularPID.getTerms();
+            sample.targetX = reference.x;
+            sample.targetY = reference.y;
+            sample.left = (lateralOut - angularOut) * ratio;
+            sample.right = (lateralOut + angularOut) * ratio;
+            this->setDrivePower(sample.left, sample.right);
+            this->trace(sample);
+            this->waitForTick();
+            continue;
+        }
+
+        // RAMSETE
+        const float v = reference.velocity;
+        const float omega = reference.angularVelocity;
+        const float gain = 2 * RAMSETE_ZETA * std::sqrt(omega * omega + RAMSETE_B * v * v);
+        const float sinc = std::fabs(headingError) < 1e-6 ? 1 : std::sin(headingError) / headingError;
+        const float velocity = v * std::cos(headingError) + gain * forwardError;
+        const float angularVelocity = omega + gain * headingError + RAMSETE_B * v * sinc * sideError;
+
+        // convert to wheel velocities, then to power
+        const float turn = angularVelocity * kinematics.halfTrack;
+        float leftPower = velocityPower(DriveSide::LEFT, velocity - turn, reference.acceleration);
+        float rightPower = velocityPower(DriveSide::RIGHT, velocity + turn, reference.acceleration);
+        // without a feedforward model the velocities are scaled to power by the top speed, and only the velocity
+        // loop corrects them
+        if (!this->feedforward.isEnabled()) {
+            leftPower += (velocity - turn) / topSpeed * 127;
+            rightPower += (velocity + turn) / topSpeed * 127;
+        }
+        // ratio the speeds to respect the max speed
+        const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.lateralError = forwardError;
+        sample.angularError = radToDeg(headingError);
+        sample.targetX = reference.x;
+        sample.targetY = reference.y;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+            sample.clamps |= uint8_t(TraceClamp::RATIO);
+        }
+
+        this->setDrivePower(leftPower, rightPower);
+        sample.left = leftPower;
+        sample.right = rightPower;
+        this->trace(sample);
+        this->waitForTick();
+    }
+
+    // stop the drivetrain
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
+    // set distTraveled to -1 to indicate that the function has finished
+    distTraveled = -1;
+    this->endMotion(reason);
+    return this->currentMotion();
+}
@@ -0,0 +1,105 @@
+#include <cmath>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/util.hpp"
+
+// turns sharper than this, in radians, stop at the target instead of cornering through it
+constexpr float MAX_CORNER_ANGLE = M_PI_2;
+
+lemlib::MotionHandle lemlib::Chassis::moveChain(const std::vector<ChainTarget>& targets, int timeout,
+                                                ChainParams params, bool async) {
+    if (targets.empty()) return this->currentMotion();
+    if (params.horizontalDrift == 0) params.horizontalDrift = drivetrain.horizontalDrift;
+    params.exitRange = std::fabs(params.exitRange);
+    params.blendRadius = std::fabs(params.blendRadius);
+    const size_t count = targets.size();
+
+    // find the length of each segment, and the direction the robot travels in when it reaches its target
+    // the first segment starts where the robot is now
+    std::vector<float> lengths(count);
+    std::vector<float> arrival(count);
+    std::vector<float> departure(count);
+    // the targets are in the coordinates of the route, and are transformed when each segment is queued
+    const Pose start = this->fieldTransform.invert(this->getPose());
+    float prevX = start.x;
+    float prevY = start.y;
+    for (size_t i = 0; i < count; i++) {
+        const ChainTarget& target = targets[i];
+        lengths[i] = std::hypot(target.x - prevX, target.y - prevY);
+        departure[i] = std::atan2(target.y - prevY, target.x - prevX);
+        if (std::isnan(target.theta)) arrival[i] = departure[i];
+        else arrival[i] = M_PI_2 - degToRad(target.theta) + (target.forwards ? 0 : M_PI);
+        prevX = target.x;
+        prevY = target.y;
+    }
+
+    // fastest speed through each target, limited by how far the robot has to turn to the next one
+    // the robot follows an arc that starts exitRange, or the blend radius, before the target, so sharper turns mean a
+    // tighter arc
+    const float cornerStart = std::fmax(params.exitRange, params.blendRadius);
+    std::vector<float> speeds(count, 0);
+    for (size_t i = 0; i + 1 < count; i++) {
+        // reversing needs the robot to stop
+        if (targets[i].forwards != targets[i + 1].forwards) continue;
+        const float turn = std::fabs(angleError(departure[i + 1], arrival[i]));
+        if (turn >= MAX_CORNER_ANGLE) continue;
+        if (turn < 1e-3) {
+            speeds[i] = params.maxSpeed;
+            continue;
+        }
+        const float radius = cornerStart / std::tan(turn / 2);
+        // the same slip limit moveToPose uses
+        speeds[i] = std::fmin(params.maxSpeed, std::sqrt(params.horizontalDrift * radius * 9.8));
+    }
+
+    // limit the speeds by how fast the robot can speed up and slow down between targets
+    // the speeds are converted to inches per second, so the acceleration can be applied
+    const float maxAcceleration = this->lateralSettings.maxAcceleration;
+    const float topSpeed = drivetrain.kinematics().topSpeed;
+    if (maxAcceleration > 0 && topSpeed > 0) {
+        const float scale = topSpeed / 127;
+        for (size_t i = count - 1; i-- > 0;) {
+            const float next = speeds[i + 1] * scale;
+            const float reachable = std::sqrt(next * next + 2 * maxAcceleration * lengths[i + 1]) / scale;
+            speeds[i] = std::fmin(speeds[i], reachable);
+        }
+        float prev = 0;
+        for (size_t i = 0; i < count; i++) {
+            const float reachable = std::sqrt(prev * prev + 2 * maxAcceleration * lengths[i]) / scale;
+            speeds[i] = std::fmin(speeds[i], reachable);
+            prev = speeds[i] * scale;
+        }
+    }
+
+    // queue every segment. The last one, and any the robot has to stop at, settle normally
+    MotionHandle handle = this->currentMotion();
+    for (size_t i = 0; i < count; i++) {
+        const ChainTarget& target = targets[i];
+        const float minSpeed = speeds[i];
+        const float exitRange = minSpeed > 0 ? params.exitRange : 0;
+        LEMLIB_DEBUG("Chain segment {}: exit speed {}, exit range {}", i, minSpeed, exitRange);
+        if (std::isnan(target.theta) && minSpeed > 0 && params.blendRadius > 0) {
+            // blend into the next target. The blend starts at most halfway along the segment, so the aim doesn't jump
+            // when the segment starts
+            MotionCommand command {MotionType::MOVE_TO_POINT,
+                                   MoveToPointParams {target.forwards, params.maxSpeed, minSpeed, exitRange},
+                                   target.x,
+                                   target.y,
+                                   0,
+                                   timeout};
+            command.blendX = targets[i + 1].x;
+            command.blendY = targets[i + 1].y;
+            command.blendRadius = std::fmin(params.blendRadius, lengths[i] / 2);
+            handle = this->queueMotion(command);
+        } else if (std::isnan(target.theta)) {
+            handle = this->moveToPoint(target.x, target.y, timeout,
+                                       {target.forwards, params.maxSpeed, minSpeed, exitRange});
+        } else {
+            handle = this->moveToPose(target.x, target.y, target.theta, timeout,
+                                      {target.forwards, params.horizontalDrift, params.lead, params.maxSpeed,
+                                       minSpeed, exitRange});
+        }
+    }
+    if (!async) handle.wait();
+    return handle;
+}
@@ -1,22 +1,22 @@
 #include <cmath>
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/fastmath.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
-void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointParams params, bool async) {
+lemlib::MotionHandle lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointParams params,
+                                                  bool async) {
     params.earlyExitRange = fabs(params.earlyExitRange);
-    this->requestMotionStart();
-    // were all motions cancelled?
-    if (!this->motionRunning) return;
-    // if the function is async, run it in a new task
-    if (async) {
-        pros::Task task([&]() { moveToPoint(x, y, timeout, params, false); });
-        this->endMotion();
-        pros::delay(10); // delay to give the task time to start
-        return;
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        const MotionHandle handle = this->queueMotion({MotionType::MOVE_TO_POINT, params, x, y, 0, timeout});
+        if (!async) handle.wait();
+        return handle;
     }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
 
     // reset PIDs and exit conditions
     lateralPID.reset();
@@ -33,77 +33,158 @@ void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointPara
     float prevAngularOut = 0; // previous angular power
     const int compState = pros::competition::get_status();
     std::optional<bool> prevSide = std::nullopt;
+    std::optional<MotionProfile> profile = std::nullopt;
 
     // calculate target pose in standard form
     Pose target(x, y);
     target.theta = lastPose.angle(target);
+    // the direction of the target doesn't change, so it is only calculated once
+    const float targetCos = cos(target.theta);
+    const float targetSin = sin(target.theta);
+    // a deadline slows the motion down to the speed that gets there in time, and the profile with it
+    const float maxSpeed = params.maxSpeed;
+    ControllerSettings profileSettings = lateralSettings;
+    profileSettings.maxVelocity *= this->deadlineScale(lastPose.distance(target), 0, params.deadlineMs, maxSpeed);
+    // the trig in the loop uses the float approximations if the motion opts in
+    const auto error = [&](float a, float b) {
+        return params.fastMath ? fastmath::angleError(a, b) : angleError(a, b);
+    };
+    const auto cosine = [&](float angle) { return params.fastMath ? fastmath::cos(angle) : cos(angle); };
+    // a segment of a blended chain steers into the next target before it reaches its own
+    const bool blend = this->blendRadius > 0 && std::isfinite(this->blendX) && std::isfinite(this->blendY);
+    const Pose next(this->blendX, this->blendY);
+    const float blendLength = blend ? target.distance(next) : 0;
+    float blendWeight = 0;
+    bool handedOff = false;
 
     // main loop
-    while (!timer.isDone() && ((!lateralSmallExit.getExit() && !lateralLargeExit.getExit()) || !close) &&
-           this->motionRunning) {
-        // update position
-        const Pose pose = getPose(true, true);
+    while (!timer.isDone(this->tickTime) && ((!lateralSmallExit.getExit() && !lateralLargeExit.getExit()) || !close) &&
+           this->motionRunning()) {
+        // update position, predicted ahead by the latency of the loop if the motion opts in
+        const Pose pose = getPredictedPose(params.latencyCompensationMs, true, true);
 
         // update distance traveled
         distTraveled += pose.distance(lastPose);
+        // run progress callbacks and wake tasks waiting for this distance
+        this->reportProgress();
         lastPose = pose;
 
         // calculate distance to the target point
         const float distTarget = pose.distance(target);
 
-        // check if the robot is close enough to the target to start settling
-        if (distTarget < 7.5 && close == false) {
+        // the speed for the deadline is planned again every iteration from the distance and time that are left, so
+        // the robot makes up for time it lost. The robot has to be at the target for the small exit timeout to settle
+        if (params.deadlineMs > 0 && !close) {
+            const float timeLeft =
+                params.deadlineMs - lateralSettings.smallErrorTimeout - timer.getTimePassed(this->tickTime);
+            params.maxSpeed = maxSpeed * this->deadlineScale(distTarget, odom.getLocalSpeed().y, timeLeft, maxSpeed);
+        }
+
+        // check if the robot is close enough to the target to start settling. A blended segment never settles
+        if (!blend && distTarget < 7.5 && close == false) {
             close = true;
             params.maxSpeed = fmax(fabs(prevLateralOut), 60);
         }
 
         // motion chaining
         const bool side =
-            (pose.y - target.y) * -sin(target.theta) <= (pose.x - target.x) * cos(target.theta) + params.earlyExitRange;
+            (pose.y - target.y) * -targetSin <= (pose.x - target.x) * targetCos + params.earlyExitRange;
         if (prevSide == std::nullopt) prevSide = side;
         const bool sameSide = side == prevSide;
         // exit if close
-        if (!sameSide && params.minSpeed != 0) break;
+        if (!sameSide && (params.minSpeed != 0 || blend)) {
+            handedOff = blend;
+            break;
+        }
         prevSide = side;
 
+        // the aim slides from the target to the next one as the robot gets to the line where it hands over, so the
+        // heading the robot steers to is continuous when the next segment starts
+        Pose aim = target;
+        // distance left to that line, along the direction to the target
+        const float remaining =
+            -(pose.x - target.x) * targetCos - (pose.y - target.y) * targetSin - params.earlyExitRange;
+        if (blend) {
+            const float t = std::clamp(1 - remaining / this->blendRadius, 0.0f, 1.0f);
+            // smoothstep, so the robot eases into the curve and out of it. It never moves back
+            blendWeight = std::fmax(blendWeight, t * t * (3 - 2 * t));
+            aim = target.lerp(next, blendWeight);
+        }
+
         // calculate error
         const float adjustedRobotTheta = params.forwards ? pose.theta : pose.theta + M_PI;
-        const float angularError = angleError(adjustedRobotTheta, pose.angle(target));
-        float lateralError = pose.distance(target) * cos(angleError(pose.theta, pose.angle(target)));
+        const float targetAngle = params.fastMath ? fastmath::angle(pose, aim) : pose.angle(aim);
+        const float angularError = error(adjustedRobotTheta, targetAngle);
+        // the robot passes beside the target of a blended segment, so its distance is measured along the segment. The
+        // next segment is counted too, so the error carries on into the next segment instead of dropping to 0, and the
+        // robot doesn't slow down for the handover
+        const float toGo = remaining + blendLength;
+        float lateralError = blend ? (params.forwards ? toGo : -toGo)
+                                   : pose.distance(target) * cosine(error(pose.theta, targetAngle));
 
         // update exit conditions
-        lateralSmallExit.update(lateralError);
-        lateralLargeExit.update(lateralError);
+        // the error shrinks as the robot drives forwards
+        updateSmallExit(lateralSmallExit, lateralSettings, lateralError, odom.getLocalSpeed().y);
+        lateralLargeExit.update(lateralError, this->tickTime);
 
         // get output from PIDs
-        float lateralOut = lateralPID.update(lateralError);
+        // follow the motion profile, if there is one
+        ProfileState setpoint;
+        const float profileError =
+            trackProfile(profile, profileSettings, lateralError, timer.getTimePassed(this->tickTime), setpoint);
+        // the feedforward drives the robot along the profile, and the PID corrects the difference. Averaging the sides
+        // leaves the turning out of the velocity loop
+        const float profilePower = (velocityPower(DriveSide::LEFT, setpoint.velocity, setpoint.acceleration) +
+                                    velocityPower(DriveSide::RIGHT, setpoint.velocity, setpoint.acceleration)) /
+                                   2;
+        float lateralOut = lateralPID.update(profileError) + profilePower;
         float angularOut = angularPID.update(radToDeg(angularError));
         if (close) angularOut = 0;
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.lateralError = lateralError;
+        sample.angularError = radToDeg(angularError);
+        sample.lateral = lateralPID.getTerms();
+        sample.angular = angularPID.getTerms();
+        sample.targetX = aim.x;
+        sample.targetY = aim.y;
 
         // apply restrictions on angular speed
-        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
-        angularOut = slew(angularOut, prevAngularOut, angularSettings.slew);
+        angularOut = sample.limit(TraceClamp::MAX_SPEED, angularOut,
+                                  std::clamp(angularOut, -params.maxSpeed, params.maxSpeed));
+        angularOut = sample.limit(TraceClamp::SLEW, angularOut,
+                                  slew(angularOut, prevAngularOut, angularSettings.slew * tickScale));
 
         // apply restrictions on lateral speed
-        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut,
+                                  std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed));
         // constrain lateral output by max accel
         // but not for decelerating, since that would interfere with settling
-        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+        if (!close)
+            lateralOut = sample.limit(TraceClamp::SLEW, lateralOut,
+                                      slew(lateralOut, prevLateralOut, this->lateralSlew(lateralSettings) * tickScale));
 
         // prevent moving in the wrong direction
-        if (params.forwards && !close) lateralOut = std::fmax(lateralOut, 0);
-        else if (!params.forwards && !close) lateralOut = std::fmin(lateralOut, 0);
+        if (params.forwards && !close)
+            lateralOut = sample.limit(TraceClamp::DIRECTION, lateralOut, std::fmax(lateralOut, 0));
+        else if (!params.forwards && !close)
+            lateralOut = sample.limit(TraceClamp::DIRECTION, lateralOut, std::fmin(lateralOut, 0));
 
         // constrain lateral output by the minimum speed
-        if (params.forwards && lateralOut < fabs(params.minSpeed) && lateralOut > 0) lateralOut = fabs(params.minSpeed);
-        if (!params.forwards && -lateralOut < fabs(params.minSpeed) && lateralOut < 0)
+        if (params.forwards && lateralOut < fabs(params.minSpeed) && lateralOut > 0) {
+            lateralOut = fabs(params.minSpeed);
+            sample.clamps |= uint8_t(TraceClamp::MIN_SPEED);
+        }
+        if (!params.forwards && -lateralOut < fabs(params.minSpeed) && lateralOut < 0) {
             lateralOut = -fabs(params.minSpeed);
+            sample.clamps |= uint8_t(TraceClamp::MIN_SPEED);
+        }
 
         // update previous output
         prevAngularOut = angularOut;
         prevLateralOut = lateralOut;
 
-        infoSink()->debug("Angular Out: {}, Lateral Out: {}", angularOut, lateralOut);
+        LEMLIB_DEBUG_EVERY(10, "Angular Out: {}, Lateral Out: {}", angularOut, lateralOut);
 
         // ratio the speeds to respect the max speed
         float leftPower = lateralOut + angularOut;
@@ -112,20 +193,26 @@ void lemlib::Chassis::moveToPoint(float x, float y, int timeout, MoveToPointPara
         if (ratio > 1) {
             leftPower /= ratio;
             rightPower /= ratio;
+            sample.clamps |= uint8_t(TraceClamp::RATIO);
         }
 
         // move the drivetrain
-        drivetrain.leftMotors->move(leftPower);
-        drivetrain.rightMotors->move(rightPower);
+        this->setDrivePower(leftPower, rightPower);
+        sample.left = leftPower;
+        sample.right = rightPower;
+        this->trace(sample);
 
-        // delay to save resources
-        pros::delay(10);
+        // wait for the next pose from odometry
+        this->waitForTick();
     }
 
-    // stop the drivetrain
-    drivetrain.leftMotors->move(0);
-    drivetrain.rightMotors->move(0);
+    // stop the drivetrain, unless the next segment of a blended chain takes over on its first tick
+    const bool settled = (lateralSmallExit.getExit() || lateralLargeExit.getExit()) && close;
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    if (handedOff) this->blendHandedOff = true;
+    else this->stopDrivetrain(reason);
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
-    this->endMotion();
+    this->endMotion(reason);
+    return this->currentMotion();
 }
\ No newline at end of file
@@ -1,22 +1,21 @@
 #include <cmath>
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/fastmath.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/timer.hpp"
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
-void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params, bool async) {
-    // take the mutex
-    this->requestMotionStart();
-    // were all motions cancelled?
-    if (!this->motionRunning) return;
-    // if the function is async, run it in a new task
-    if (async) {
-        pros::Task task([&]() { moveToPose(x, y, theta, timeout, params, false); });
-        this->endMotion();
-        pros::delay(10); // delay to give the task time to start
-        return;
+lemlib::MotionHandle lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params,
+                                                 bool async) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        const MotionHandle handle = this->queueMotion({MotionType::MOVE_TO_POSE, params, x, y, theta, timeout});
+        if (!async) handle.wait();
+        return handle;
     }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
 
     // reset PIDs and exit conditions
     lateralPID.reset();
@@ -26,12 +25,30 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
     angularLargeExit.reset();
     angularSmallExit.reset();
 
+    if (params.holonomic) {
+        if (drivetrain.holonomic != nullptr) {
+            return this->moveToPoseHolonomic(Pose(x, y, M_PI_2 - degToRad(theta)), timeout, params);
+        }
+        infoSink()->warn("moveToPose can't strafe without a holonomic drivetrain! Driving a boomerang curve instead");
+    }
+
     // calculate target pose in standard form
     Pose target(x, y, M_PI_2 - degToRad(theta));
     if (!params.forwards) target.theta = fmod(target.theta + M_PI, 2 * M_PI); // backwards movement
 
     // use global horizontalDrift is horizontalDrift is 0
     if (params.horizontalDrift == 0) params.horizontalDrift = drivetrain.horizontalDrift;
+    const DrivetrainKinematics kinematics(drivetrain.trackWidth, drivetrain.wheelDiameter, drivetrain.rpm,
+                                          params.horizontalDrift);
+
+    // the direction of the target doesn't change, so it is only calculated once
+    const float targetCos = cos(target.theta);
+    const float targetSin = sin(target.theta);
+    // the trig in the loop uses the float approximations if the motion opts in
+    const auto error = [&](float a, float b) {
+        return params.fastMath ? fastmath::angleError(a, b) : angleError(a, b);
+    };
+    const auto cosine = [&](float angle) { return params.fastMath ? fastmath::cos(angle) : cos(angle); };
 
     // initialize vars used between iterations
     Pose lastPose = getPose();
@@ -43,21 +60,46 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
     float prevLateralOut = 0; // previous lateral power
     float prevAngularOut = 0; // previous angular power
     const int compState = pros::competition::get_status();
+    // a deadline slows the lateral output down to the speed that gets there in time, and leaves the turning as it is.
+    // The robot drives a boomerang curve, so the distance left is stretched by how much longer than a straight line
+    // the curve it would be planned on is
+    float lateralSpeed = params.maxSpeed;
+    float stretch = 1;
+    if (params.deadlineMs > 0) {
+        const Trajectory curve = this->planPose(lastPose, x, y, theta, params);
+        float length = 0;
+        for (size_t i = 1; i < curve.size(); i++)
+            length += std::hypot(curve.at(i).x - curve.at(i - 1).x, curve.at(i).y - curve.at(i - 1).y);
+        const float straight = std::hypot(x - lastPose.x, y - lastPose.y);
+        if (straight > 0) stretch = std::fmax(length / straight, 1);
+    }
 
     // main loop
-    while (!timer.isDone() &&
+    while (!timer.isDone(this->tickTime) &&
            ((!lateralSettled || (!angularLargeExit.getExit() && !angularSmallExit.getExit())) || !close) &&
-           this->motionRunning) {
-        // update position
-        const Pose pose = getPose(true, true);
+           this->motionRunning()) {
+        // update position, predicted ahead by the latency of the loop if the motion opts in
+        const Pose pose = getPredictedPose(params.latencyCompensationMs, true, true);
 
         // update distance traveled
         distTraveled += pose.distance(lastPose);
+        // run progress callbacks and wake tasks waiting for this distance
+        this->reportProgress();
         lastPose = pose;
 
         // calculate distance to the target point
         const float distTarget = pose.distance(target);
 
+        // the speed for the deadline is planned again every iteration from the distance and time that are left, so
+        // the robot makes up for time it lost. The robot has to be at the target for the small exit timeout to settle
+        if (params.deadlineMs > 0 && !close) {
+            const float timeLeft =
+                params.deadlineMs - lateralSettings.smallErrorTimeout - timer.getTimePassed(this->tickTime);
+            const float distanceLeft = distTarget * stretch;
+            lateralSpeed = params.maxSpeed *
+                           this->deadlineScale(distanceLeft, odom.getLocalSpeed().y, timeLeft, params.maxSpeed);
+        }
+
         // check if the robot is close enough to the target to start settling
         if (distTarget < 7.5 && close == false) {
             close = true;
@@ -68,14 +110,14 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
         if (lateralLargeExit.getExit() && lateralSmallExit.getExit()) lateralSettled = true;
 
         // calculate the carrot point
-        Pose carrot = target - Pose(cos(target.theta), sin(target.theta)) * params.lead * distTarget;
+        Pose carrot = target - Pose(targetCos, targetSin) * params.lead * distTarget;
         if (close) carrot = target; // settling behavior
 
         // calculate if the robot is on the same side as the carrot point
         const bool robotSide =
-            (pose.y - target.y) * -sin(target.theta) <= (pose.x - target.x) * cos(target.theta) + params.earlyExitRange;
-        const bool carrotSide = (carrot.y - target.y) * -sin(target.theta) <=
-                                (carrot.x - target.x) * cos(target.theta) + params.earlyExitRange;
+            (pose.y - target.y) * -targetSin <= (pose.x - target.x) * targetCos + params.earlyExitRange;
+        const bool carrotSide =
+            (carrot.y - target.y) * -targetSin <= (carrot.x - target.x) * targetCos + params.earlyExitRange;
         const bool sameSide = robotSide == carrotSide;
         // exit if close
         if (!sameSide && prevSameSide && close && params.minSpeed != 0) break;
@@ -83,57 +125,87 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
 
         // calculate error
         const float adjustedRobotTheta = params.forwards ? pose.theta : pose.theta + M_PI;
+        const float carrotAngle = params.fastMath ? fastmath::angle(pose, carrot) : pose.angle(carrot);
         const float angularError =
-            close ? angleError(adjustedRobotTheta, target.theta) : angleError(adjustedRobotTheta, pose.angle(carrot));
+            close ? error(adjustedRobotTheta, target.theta) : error(adjustedRobotTheta, carrotAngle);
         float lateralError = pose.distance(carrot);
         // only use cos when settling
         // otherwise just multiply by the sign of cos
         // maxSlipSpeed takes care of lateralOut
-        if (close) lateralError *= cos(angleError(pose.theta, pose.angle(carrot)));
-        else lateralError *= sgn(cos(angleError(pose.theta, pose.angle(carrot))));
+        if (close) lateralError *= cosine(error(pose.theta, carrotAngle));
+        else lateralError *= sgn(cosine(error(pose.theta, carrotAngle)));
 
         // update exit conditions
-        lateralSmallExit.update(lateralError);
-        lateralLargeExit.update(lateralError);
-        angularSmallExit.update(radToDeg(angularError));
-        angularLargeExit.update(radToDeg(angularError));
+        // the error shrinks as the robot drives forwards
+        updateSmallExit(lateralSmallExit, lateralSettings, lateralError, odom.getLocalSpeed().y);
+        lateralLargeExit.update(lateralError, this->tickTime);
+        const float angularErrorDegrees = radToDeg(angularError);
+        angularSmallExit.update(angularErrorDegrees, this->tickTime);
+        angularLargeExit.update(angularErrorDegrees, this->tickTime);
 
         // get output from PIDs
         float lateralOut = lateralPID.update(lateralError);
-        float angularOut = angularPID.update(radToDeg(angularError));
+        float angularOut = angularPID.update(angularErrorDegrees);
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.lateralError = lateralError;
+        sample.angularError = angularErrorDegrees;
+        sample.lateral = lateralPID.getTerms();
+        sample.angular = angularPID.getTerms();
+        sample.targetX = carrot.x;
+        sample.targetY = carrot.y;
 
         // apply restrictions on angular speed
-        angularOut = std::clamp(angularOut, -params.maxSpeed, params.maxSpeed);
+        angularOut = sample.limit(TraceClamp::MAX_SPEED, angularOut,
+                                  std::clamp(angularOut, -params.maxSpeed, params.maxSpeed));
 
         // apply restrictions on lateral speed
-        lateralOut = std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed);
+        lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut,
+                                  std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed));
+        if (!close)
+            lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut,
+                                      std::clamp(lateralOut, -lateralSpeed, lateralSpeed));
 
         // constrain lateral output by max accel
-        if (!close) lateralOut = slew(lateralOut, prevLateralOut, lateralSettings.slew);
+        if (!close)
+            lateralOut = sample.limit(TraceClamp::SLEW, lateralOut,
+                                      slew(lateralOut, prevLateralOut, this->lateralSlew(lateralSettings) * tickScale));
 
         // constrain lateral output by the max speed it can travel at without
         // slipping
-        const float radius = 1 / fabs(getCurvature(pose, carrot));
-        const float maxSlipSpeed(sqrt(params.horizontalDrift * radius * 9.8));
-        lateralOut = std::clamp(lateralOut, -maxSlipSpeed, maxSlipSpeed);
+        sample.curvature = getCurvature(pose, carrot);
+        const float radius = 1 / fabs(sample.curvature);
+        const float maxSlipSpeed(sqrt(kinematics.slipAcceleration * radius));
+        sample.slipLimit = maxSlipSpeed;
+        lateralOut = sample.limit(TraceClamp::SLIP, lateralOut, std::clamp(lateralOut, -maxSlipSpeed, maxSlipSpeed));
         // prioritize angular movement over lateral movement
         const float overturn = fabs(angularOut) + fabs(lateralOut) - params.maxSpeed;
-        if (overturn > 0) lateralOut -= lateralOut > 0 ? overturn : -overturn;
+        if (overturn > 0) {
+            lateralOut -= lateralOut > 0 ? overturn : -overturn;
+            sample.clamps |= uint8_t(TraceClamp::OVERTURN);
+        }
 
         // prevent moving in the wrong direction
-        if (params.forwards && !close) lateralOut = std::fmax(lateralOut, 0);
-        else if (!params.forwards && !close) lateralOut = std::fmin(lateralOut, 0);
+        if (params.forwards && !close)
+            lateralOut = sample.limit(TraceClamp::DIRECTION, lateralOut, std::fmax(lateralOut, 0));
+        else if (!params.forwards && !close)
+            lateralOut = sample.limit(TraceClamp::DIRECTION, lateralOut, std::fmin(lateralOut, 0));
 
         // constrain lateral output by the minimum speed
-        if (params.forwards && lateralOut < fabs(params.minSpeed) && lateralOut > 0) lateralOut = fabs(params.minSpeed);
-        if (!params.forwards && -lateralOut < fabs(params.minSpeed) && lateralOut < 0)
+        if (params.forwards && lateralOut < fabs(params.minSpeed) && lateralOut > 0) {
+            lateralOut = fabs(params.minSpeed);
+            sample.clamps |= uint8_t(TraceClamp::MIN_SPEED);
+        }
+        if (!params.forwards && -lateralOut < fabs(params.minSpeed) && lateralOut < 0) {
             lateralOut = -fabs(params.minSpeed);
+            sample.clamps |= uint8_t(TraceClamp::MIN_SPEED);
+        }
 
         // update previous output
         prevAngularOut = angularOut;
         prevLateralOut = lateralOut;
 
-        infoSink()->debug("lateralOut: {} angularOut: {}", lateralOut, angularOut);
+        LEMLIB_DEBUG_EVERY(10, "lateralOut: {} angularOut: {}", lateralOut, angularOut);
 
         // ratio the speeds to respect the max speed
         float leftPower = lateralOut + angularOut;
@@ -142,20 +214,142 @@ void lemlib::Chassis::moveToPose(float x, float y, float theta, int timeout, Mov
         if (ratio > 1) {
             leftPower /= ratio;
             rightPower /= ratio;
+            sample.clamps |= uint8_t(TraceClamp::RATIO);
         }
 
         // move the drivetrain
-        drivetrain.leftMotors->move(leftPower);
-        drivetrain.rightMotors->move(rightPower);
+        this->setDrivePower(leftPower, rightPower);
+        sample.left = leftPower;
+        sample.right = rightPower;
+        this->trace(sample);
 
-        // delay to save resources
-        pros::delay(10);
+        // wait for the next pose from odometry
+        this->waitForTick();
     }
 
     // stop the drivetrain
-    drivetrain.leftMotors->move(0);
-    drivetrain.rightMotors->move(0);
+    const bool settled = lateralSettled && (angularLargeExit.getExit() || angularSmallExit.getExit()) && close;
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
-    this->endMotion();
+    this->endMotion(reason);
+    return this->currentMotion();
+}
+
+lemlib::MotionHandle lemlib::Chassis::moveToPoseHolonomic(Pose target, int timeout, MoveToPoseParams params) {
+    Pose lastPose = getPose(true, true);
+    // the direction the robot starts in, so it can tell when it has passed the target
+    const float startDistance = lastPose.distance(target);
+    const float startX = startDistance > 0 ? (target.x - lastPose.x) / startDistance : 0;
+    const float startY = startDistance > 0 ? (target.y - lastPose.y) / startDistance : 0;
+    distTraveled = 0;
+    Timer timer(timeout);
+    bool close = false;
+    bool lateralSettled = false;
+    float prevLateralOut = 0;
+    float lateralSpeed = params.maxSpeed;
+
+    while (!timer.isDone(this->tickTime) &&
+           ((!lateralSettled || (!angularLargeExit.getExit() && !angularSmallExit.getExit())) || !close) &&
+           this->motionRunning()) {
+        // update position, predicted ahead by the latency of the loop if the motion opts in
+        const Pose pose = getPredictedPose(params.latencyCompensationMs, true, true);
+        distTraveled += pose.distance(lastPose);
+        this->reportProgress();
+        lastPose = pose;
+
+        // the robot drives straight at the target, so the distance to it is the lateral error
+        const float deltaX = target.x - pose.x;
+        const float deltaY = target.y - pose.y;
+        const float distTarget = std::hypot(deltaX, deltaY);
+        const Pose speed = this->odom.getSpeed();
+        const float closingSpeed = distTarget > 0 ? (speed.x * deltaX + speed.y * deltaY) / distTarget : 0;
+
+        if (params.deadlineMs > 0 && !close) {
+            const float timeLeft =
+                params.deadlineMs - lateralSettings.smallErrorTimeout - timer.getTimePassed(this->tickTime);
+            lateralSpeed =
+                params.maxSpeed * this->deadlineScale(distTarget, closingSpeed, timeLeft, params.maxSpeed);
+        }
+        // check if the robot is close enough to the target to start settling
+        if (distTarget < 7.5 && close == false) {
+            close = true;
+            params.maxSpeed = fmax(fabs(prevLateralOut), 60);
+        }
+        if (lateralLargeExit.getExit() && lateralSmallExit.getExit()) lateralSettled = true;
+        // exit once the robot has passed the target, or is within the early exit range of it along the way
+        const float remaining = deltaX * startX + deltaY * startY;
+        if (close && params.minSpeed != 0 && remaining <= params.earlyExitRange) break;
+
+        const float angularErrorDegrees = radToDeg(angleError(pose.theta, target.theta));
+        updateSmallExit(lateralSmallExit, lateralSettings, distTarget, closingSpeed);
+        lateralLargeExit.update(distTarget, this->tickTime);
+        angularSmallExit.update(angularErrorDegrees, this->tickTime);
+        angularLargeExit.update(angularErrorDegrees, this->tickTime);
+
+        float lateralOut = lateralPID.update(distTarget);
+        float angularOut = angularPID.update(angularErrorDegrees);
+        MotionSample sample;
+        sample.lateralError = distTarget;
+        sample.angularError = angularErrorDegrees;
+        sample.lateral = lateralPID.getTerms();
+        sample.angular = angularPID.getTerms();
+        sample.targetX = target.x;
+        sample.targetY = target.y;
+
+        angularOut = sample.limit(TraceClamp::MAX_SPEED, angularOut,
+                                  std::clamp(angularOut, -params.maxSpeed, params.maxSpeed));
+        lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut,
+                                  std::clamp(lateralOut, -params.maxSpeed, params.maxSpeed));
+        if (!close) {
+            lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut,
+                                      std::clamp(lateralOut, -lateralSpeed, lateralSpeed));
+            lateralOut = sample.limit(TraceClamp::SLEW, lateralOut,
+                                      slew(lateralOut, prevLateralOut, this->lateralSlew(lateralSettings) * tickScale));
+            // prevent moving away from the target
+            lateralOut = sample.limit(TraceClamp::DIRECTION, lateralOut, std::fmax(lateralOut, 0));
+        }
+        if (lateralOut < fabs(params.minSpeed) && lateralOut > 0) {
+            lateralOut = fabs(params.minSpeed);
+            sample.clamps |= uint8_t(TraceClamp::MIN_SPEED);
+        }
+        prevLateralOut = lateralOut;
+
+        // point the lateral output at the target, relative to the robot
+        const float cosTheta = std::cos(pose.theta);
+        const float sinTheta = std::sin(pose.theta);
+        float forward = 0;
+        float strafe = 0;
+        if (distTarget > 0) {
+            forward = lateralOut * (deltaX * cosTheta + deltaY * sinTheta) / distTarget;
+            strafe = lateralOut * (deltaX * sinTheta - deltaY * cosTheta) / distTarget;
+        }
+        // prioritize angular movement over lateral movement, by leaving the wheel that is driven hardest enough power
+        // to turn
+        const float translation = std::fmax(std::fabs(forward + strafe), std::fabs(forward - strafe));
+        const float overturn = translation + std::fabs(angularOut) - params.maxSpeed;
+        if (overturn > 0 && translation > 0) {
+            const float ratio = std::fmax(translation - overturn, 0) / translation;
+            forward *= ratio;
+            strafe *= ratio;
+            sample.clamps |= uint8_t(TraceClamp::OVERTURN);
+        }
+
+        LEMLIB_DEBUG_EVERY(10, "forward: {} strafe: {} angularOut: {}", forward, strafe, angularOut);
+
+        const WheelPowers powers = this->setHolonomicPower(forward, strafe, angularOut, params.maxSpeed);
+        sample.left = (powers.frontLeft + powers.backLeft) / 2;
+        sample.right = (powers.frontRight + powers.backRight) / 2;
+        this->trace(sample);
+
+        this->waitForTick();
+    }
+
+    const bool settled = lateralSettled && (angularLargeExit.getExit() || angularSmallExit.getExit()) && close;
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
+    distTraveled = -1;
+    this->endMotion(reason);
+    return this->currentMotion();
 }
@@ -3,113 +3,72 @@
 // Here is a link to the original document
 // https://www.chiefdelphi.com/uploads/default/original/3X/b/e/be0e06de00e07db66f97686505c3f4dde2e332dc.pdf
 
+#include <algorithm>
 #include <cmath>
 #include <vector>
-#include <string>
 #include "pros/misc.hpp"
 #include "lemlib/logger/logger.hpp"
 #include "lemlib/chassis/chassis.hpp"
+#include "lemlib/path/path.hpp"
+#include "lemlib/path/pathCache.hpp"
+#include "lemlib/profiler.hpp"
+#include "lemlib/timer.hpp"
 #include "lemlib/util.hpp"
 
-/**
- * @brief function that returns elements in a file line, separated by a delimeter
- *
- * @param input the raw string
- * @param delimeter string separating the elements in the line
- * @return std::vector<std::string> array of elements read from the file
- */
-std::vector<std::string> readElement(const std::string& input, const std::string& delimiter) {
-    std::string token;
-    std::string s = input;
-    std::vector<std::string> output;
-    size_t pos = 0;
-
-    // main loop
-    while ((pos = s.find(delimiter)) != std::string::npos) { // while there are still delimiters in the string
-        token = s.substr(0, pos); // processed substring
-        output.push_back(token);
-        s.erase(0, pos + delimiter.length()); // remove the read substring
-    }
-
-    output.push_back(s); // add the last element to the returned string
-
-    return output;
-}
+// number of points ahead of the last closest point that are searched every iteration
+constexpr int CLOSEST_SEARCH_WINDOW = 16;
+// number of segments, starting at the segment lookaheadDist along the path, that are checked for the lookahead point
+constexpr int LOOKAHEAD_SEARCH_WINDOW = 8;
+// most points ahead of the closest point that are checked for the sharpest curvature by the adaptive lookahead
+constexpr int CURVATURE_SEARCH_WINDOW = 32;
+// points sampled on each spline of a spline path to estimate how long it takes to follow
+constexpr int SPLINE_TIME_SAMPLES = 16;
 
 /**
- * @brief Convert a string to hex
+ * @brief find the closest point on the path to the robot
  *
- * @param input the string to convert
- * @return std::string hexadecimal output
- */
-std::string stringToHex(const std::string& input) {
-    static const char hex_digits[] = "0123456789ABCDEF";
-
-    std::string output;
-    output.reserve(input.length() * 2);
-    for (unsigned char c : input) {
-        output.push_back(hex_digits[c >> 4]);
-        output.push_back(hex_digits[c & 15]);
-    }
-    return output;
-}
-
-/**
- * @brief Get a path from the sd card
+ * Only a small window of points ahead of the last closest point is searched, so the cost doesn't depend on the length
+ * of the path. The whole path is only searched if the robot has left the path
  *
- * @param filePath The file to read from
- * @return std::vector<lemlib::Pose> vector of points on the path
+ * @tparam P a Path or a PathView
+ * @param pose the current pose of the robot
+ * @param path the path to follow
+ * @param lastClosest index of the closest point found last iteration
+ * @param rescanDist if the closest point in the window is further than this, the whole path is searched
+ * @return int index to the closest point
  */
-std::vector<lemlib::Pose> getData(const asset& path) {
-    std::vector<lemlib::Pose> robotPath;
-
-    // format data from the asset
-    const std::string data(reinterpret_cast<char*>(path.buf), path.size);
-    const std::vector<std::string> dataLines = readElement(data, "\n");
-
-    // read the points until 'endData' is read
-    for (std::string line : dataLines) {
-        lemlib::infoSink()->debug("read raw line {}", stringToHex(line));
-        if (line == "endData" || line == "endData\r") break;
-        const std::vector<std::string> pointInput = readElement(line, ", "); // parse line
-        // check if the line was read correctly
-        if (pointInput.size() != 3) {
-            lemlib::infoSink()->error("Failed to read path file! Are you using the right format? Raw line: {}",
-                                      stringToHex(line));
-            break;
-        }
-        lemlib::Pose pathPoint(0, 0);
-        pathPoint.x = std::stof(pointInput.at(0)); // x position
-        pathPoint.y = std::stof(pointInput.at(1)); // y position
-        pathPoint.theta = std::stof(pointInput.at(2)); // velocity
-        robotPath.push_back(pathPoint); // save data
-        lemlib::infoSink()->debug("read point {}", pathPoint);
-    }
-
-    return robotPath;
+template <typename P> int findClosest(lemlib::Pose pose, const P& path, int lastClosest, float rescanDist) {
+    float closestDist;
+    const int end = std::min(lastClosest + CLOSEST_SEARCH_WINDOW, int(path.size()));
+    const int closestPoint = path.closest(pose, lastClosest, end, closestDist);
+    // the robot left the path, so it could be closest to any point
+    if (closestDist > rescanDist) return path.closest(pose, 0, path.size(), closestDist);
+    return closestPoint;
 }
 
 /**
- * @brief find the closest point on the path to the robot
+ * @brief Find the closest point on the path to the robot again after its pose jumped
  *
- * @param pose the current pose of the robot
+ * The window around the last closest point is searched first, in both directions since the pose may have jumped
+ * backwards along the path, and widened until the closest point in it is near the robot. A small correction only
+ * searches a few more points than findClosest does
+ *
+ * @tparam P a Path or a PathView
+ * @param pose the pose of the robot after the jump
  * @param path the path to follow
+ * @param lastClosest index of the closest point before the jump
+ * @param rescanDist the window is widened until its closest point is no further than this
  * @return int index to the closest point
  */
-int findClosest(lemlib::Pose pose, std::vector<lemlib::Pose> path) {
-    int closestPoint;
-    float closestDist = infinity();
-
-    // loop through all path points
-    for (int i = 0; i < path.size(); i++) {
-        const float dist = pose.distance(path.at(i));
-        if (dist < closestDist) { // new closest point
-            closestDist = dist;
-            closestPoint = i;
-        }
+template <typename P> static int relocateClosest(lemlib::Pose pose, const P& path, int lastClosest, float rescanDist) {
+    const int size = path.size();
+    for (int radius = CLOSEST_SEARCH_WINDOW;; radius *= 2) {
+        const int begin = std::max(lastClosest - radius, 0);
+        const int end = std::min(lastClosest + radius, size);
+        float closestDist;
+        const int closest = path.closest(pose, begin, end, closestDist);
+        if (closestDist <= rescanDist || (begin == 0 && end == size)) return closest;
     }
-
-    return closestPoint;
 }
 
 /**
@@ -122,6 +81,7 @@ int findClosest(lemlib::Pose pose, std::vector<lemlib::Pose> path) {
  * @return float how far along the line the
  */
 float circleIntersect(lemlib::Pose p1, lemlib::Pose p2, lemlib::Pose pose, float lookaheadDist) {
+    LEMLIB_PROFILE_SCOPE("circleIntersect");
     // calculations
     // uses the quadratic formula to calculate intersection points
     lemlib::Pose d = p2 - p1;
@@ -149,21 +109,29 @@ float circleIntersect(lemlib::Pose p1, lemlib::Pose p2, lemlib::Pose pose, float
 /**
  * @brief returns the lookahead point
  *
- * @param lastLookahead - the last lookahead point
+ * The path is indexed by arc length, so the segment the lookahead point should be on is found with a binary search.
+ * Only a few segments from there are checked for an intersection with the lookahead circle, so the cost doesn't
+ * depend on the length of the path
+ *
+ * @tparam P a Path or a PathView
+ * @param lastLookahead - the last lookahead point. Its theta is its distance along the path
  * @param pose - the current position of the robot
  * @param path - the path to follow
  * @param closest - the index of the point closest to the robot
  * @param lookaheadDist - the lookahead distance of the algorithm
+ * @return lemlib::Pose the lookahead point. Its theta is its distance along the path
  */
-lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, std::vector<lemlib::Pose> path, int closest,
+template <typename P>
+lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, const P& path, int closest,
                             float lookaheadDist) {
     // optimizations applied:
-    // only consider intersections that have an index greater than or equal to the point closest
-    // to the robot
-    // and intersections that have an index greater than or equal to the index of the last
-    // lookahead point
-    const int start = std::max(closest, int(lastLookahead.theta));
-    for (int i = start; i < path.size() - 1; i++) {
+    // a chord is never longer than the arc it spans, so the intersection is at least lookaheadDist along the path
+    // from the robot
+    // and the lookahead point never moves backwards along the path
+    const float targetDist = std::max(path.project(pose, closest) + lookaheadDist, lastLookahead.theta);
+    const int start = path.segmentAt(targetDist);
+    const int end = std::min(start + LOOKAHEAD_SEARCH_WINDOW, int(path.size()) - 1);
+    for (int i = start; i < end; i++) {
         lemlib::Pose lastPathPose = path.at(i);
         lemlib::Pose currentPathPose = path.at(i + 1);
 
@@ -171,57 +139,220 @@ lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, std::
 
         if (t != -1) {
             lemlib::Pose lookahead = lastPathPose.lerp(currentPathPose, t);
-            lookahead.theta = i;
+            lookahead.theta = path.distance(i) + t * path.segmentLength(i);
             return lookahead;
         }
     }
 
-    // robot deviated from path, use last lookahead point
-    return lastLookahead;
+    // robot deviated from path, use the point lookaheadDist along the path from the robot
+    lemlib::Pose lookahead = path.pointAt(targetDist);
+    lookahead.theta = targetDist;
+    return lookahead;
+}
+
+// the benchmarks measure these on paths
+template int findClosest(lemlib::Pose pose, const lemlib::Path& path, int lastClosest, float rescanDist);
+template lemlib::Pose lookaheadPoint(lemlib::Pose lastLookahead, lemlib::Pose pose, const lemlib::Path& path,
+                                     int closest, float lookaheadDist);
+
+/**
+ * @brief Find the lookahead distance for the speed of the robot and the curvature of the path ahead of it
+ *
+ * @tparam P a Path or a PathView
+ * @param settings the adaptive lookahead settings
+ * @param path the path to follow
+ * @param closest the index of the point closest to the robot
+ * @param speed the speed of the robot, in inches per second
+ * @param maxLookahead the longest the lookahead can be
+ * @return float the lookahead distance
+ */
+template <typename P>
+static float adaptLookahead(const lemlib::AdaptiveLookahead& settings, const P& path, int closest, float speed,
+                            float maxLookahead) {
+    // the sharpest curvature between the robot and the furthest the lookahead point could be
+    const int end = std::min({int(path.segmentAt(path.distance(closest) + maxLookahead)) + 1,
+                              closest + CURVATURE_SEARCH_WINDOW, int(path.size())});
+    float curvature = 0;
+    for (int i = closest; i < end; i++) curvature = std::fmax(curvature, std::fabs(path.curvature(i)));
+    const float lookahead =
+        (settings.minLookahead + settings.speedGain * std::fabs(speed)) / (1 + settings.curvatureGain * curvature);
+    return std::clamp(lookahead, std::fmin(settings.minLookahead, maxLookahead), maxLookahead);
+}
+
+/**
+ * @brief Find a starting guess for the closest point on a spline path after the pose of the robot jumped
+ *
+ * Points are sampled on the splines around the last closest point, widening to more splines until one is near the
+ * robot, like relocateClosest
+ *
+ * @param pose the pose of the robot after the jump
+ * @param path the path to follow
+ * @param lastClosest the parameter of the closest point before the jump
+ * @param rescanDist the search is widened until its nearest point is no further than this
+ * @return float the parameter of the nearest point sampled
+ */
+static float relocateSpline(lemlib::Pose pose, const lemlib::SplinePath& path, float lastClosest, float rescanDist) {
+    const float size = path.size();
+    for (float radius = 1;; radius *= 2) {
+        const float begin = std::fmax(std::floor(lastClosest) - radius, 0);
+        const float end = std::fmin(std::floor(lastClosest) + radius + 1, size);
+        float best = lastClosest;
+        float bestDist = INFINITY;
+        for (float u = begin; u <= end; u += 1.0f / SPLINE_TIME_SAMPLES) {
+            const float dist = pose.distance(path.at(u));
+            if (dist < bestDist) {
+                best = u;
+                bestDist = dist;
+            }
+        }
+        if (bestDist <= rescanDist || (begin == 0 && end == size)) return best;
+    }
+}
+
+/**
+ * @brief Estimate how long following a path takes at its own velocities
+ *
+ * @tparam P a Path or a PathView
+ * @param path the path
+ * @param unit the speed in inches per second of 1 unit of velocity of the path
+ * @return float the time, in seconds
+ */
+template <typename P> static float pathTime(const P& path, float unit) {
+    float time = 0;
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        // the last point has a velocity of 0, so each segment is driven at the average of its ends
+        const float velocity = (path.velocity(i) + path.velocity(i + 1)) / 2 * unit;
+        if (velocity > 0) time += path.segmentLength(i) / velocity;
+    }
+    return time;
 }
 
 /**
- * @brief Get the curvature of a circle that intersects the robot and the lookahead point
+ * @brief Estimate how long following a spline path takes at its own velocities
  *
- * @param pos the position of the robot
- * @param heading the heading of the robot
- * @param lookahead the lookahead point
- * @return float curvature
+ * @param path the path
+ * @param unit the speed in inches per second of 1 unit of velocity of the path
+ * @return float the time, in seconds
  */
-float findLookaheadCurvature(lemlib::Pose pose, float heading, lemlib::Pose lookahead) {
-    // calculate whether the robot is on the left or right side of the circle
-    float side = lemlib::sgn(std::sin(heading) * (lookahead.x - pose.x) - std::cos(heading) * (lookahead.y - pose.y));
-    // calculate center point and radius
-    float a = -std::tan(heading);
-    float c = std::tan(heading) * pose.x - pose.y;
-    float x = std::fabs(a * lookahead.x + lookahead.y + c) / std::sqrt((a * a) + 1);
-    float d = std::hypot(lookahead.x - pose.x, lookahead.y - pose.y);
-
-    // return curvature
-    return side * ((2 * x) / (d * d));
+static float pathTime(const lemlib::SplinePath& path, float unit) {
+    float time = 0;
+    lemlib::Pose last = path.at(0);
+    float lastVelocity = path.velocity(0);
+    for (int i = 1; i <= int(path.size()) * SPLINE_TIME_SAMPLES; i++) {
+        const float u = float(i) / SPLINE_TIME_SAMPLES;
+        const lemlib::Pose point = path.at(u);
+        const float velocity = path.velocity(u);
+        const float average = (velocity + lastVelocity) / 2 * unit;
+        if (average > 0) time += point.distance(last) / average;
+        last = point;
+        lastVelocity = velocity;
+    }
+    return time;
 }
 
-void lemlib::Chassis::follow(const asset& path, float lookahead, int timeout, bool forwards, bool async) {
-    this->requestMotionStart();
-    // were all motions cancelled?
-    if (!this->motionRunning) return;
-    // if the function is async, run it in a new task
-    if (async) {
-        pros::Task task([&]() { follow(path, lookahead, timeout, forwards, false); });
-        this->endMotion();
-        pros::delay(10); // delay to give the task time to start
-        return;
+/**
+ * @brief Find how much the velocities of a path have to be scaled to reach its end by a deadline
+ *
+ * @param time how long the rest of the path takes at its own velocities, in seconds
+ * @param deadline time left until the deadline, in milliseconds
+ * @return float the scale. 1 if there is no time left, or the path can't be followed in time even at its velocities
+ */
+static float timeScale(float time, int deadline) {
+    if (deadline <= 0) return 1;
+    return std::fmin(time / (deadline / 1000.0f), 1);
+}
+
+bool lemlib::Chassis::preloadPath(const asset& path) {
+    const bool loaded = pathCache().preload(path, this->fieldTransform);
+    if (!loaded) infoSink()->error("Failed to preload path! Do you have the right format?");
+    return loaded;
+}
+
+void lemlib::Chassis::prefetchPath(const std::string& file) { pathCache().prefetch(file, this->fieldTransform); }
+
+lemlib::MotionHandle lemlib::Chassis::follow(const asset& path, float lookahead, int timeout, bool forwards,
+                                             bool async, int deadline, FollowParams params) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::FOLLOW};
+        command.timeout = timeout;
+        command.path = path;
+        command.lookahead = lookahead;
+        command.forwards = forwards;
+        command.deadline = deadline;
+        command.params = params;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
     }
+    // load the path on the motion task, so the caller doesn't wait for it to be parsed
+    return this->follow(pathCache().get(path), lookahead, timeout, forwards, false, deadline, params);
+}
+
+lemlib::MotionHandle lemlib::Chassis::follow(const asset& bundle, std::string_view name, float lookahead,
+                                             int timeout, bool forwards, bool async, int deadline,
+                                             FollowParams params) {
+    // a path that isn't in the bundle is empty, so the motion is skipped
+    return this->follow(findPath(bundle, name), lookahead, timeout, forwards, async, deadline, params);
+}
+
+lemlib::MotionHandle lemlib::Chassis::follow(const std::string& file, float lookahead, int timeout, bool forwards,
+                                             bool async, int deadline, FollowParams params) {
+    // a file that couldn't be read is an empty asset, so the motion is skipped
+    return this->follow(pathCache().file(file), lookahead, timeout, forwards, async, deadline, params);
+}
+
+lemlib::MotionHandle lemlib::Chassis::follow(const Path& pathPoints, float lookahead, int timeout, bool forwards,
+                                             bool async, int deadline, FollowParams params) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::FOLLOW};
+        command.timeout = timeout;
+        command.pathData = &pathPoints;
+        command.lookahead = lookahead;
+        command.forwards = forwards;
+        command.deadline = deadline;
+        command.params = params;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    return this->followPoints(pathPoints, lookahead, timeout, forwards, deadline, params);
+}
+
+lemlib::MotionHandle lemlib::Chassis::follow(const PathView& path, float lookahead, int timeout, bool forwards,
+                                             bool async, int deadline, FollowParams params) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::FOLLOW};
+        command.timeout = timeout;
+        command.view = path;
+        command.lookahead = lookahead;
+        command.forwards = forwards;
+        command.deadline = deadline;
+        command.params = params;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    return this->followPoints(path, lookahead, timeout, forwards, deadline, params);
+}
+
+template <typename P>
+lemlib::MotionHandle lemlib::Chassis::followPoints(const P& pathPoints, float lookahead, int timeout, bool forwards,
+                                                   int deadline, const FollowParams& params) {
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
 
-    std::vector<lemlib::Pose> pathPoints = getData(path); // get list of path points
     if (pathPoints.size() == 0) {
         infoSink()->error("No points in path! Do you have the right format? Skipping motion");
         // set distTraveled to -1 to indicate that the function has finished
         distTraveled = -1;
-        // give the mutex back
-        this->endMotion();
-        return;
+        // let the next motion start
+        this->endMotion(MotionEndReason::CANCELLED);
+        return this->currentMotion();
     }
+    this->pathEnd = pathPoints.at(pathPoints.size() - 1);
     Pose pose = this->getPose(true);
     Pose lastPose = pose;
     Pose lookaheadPose(0, 0, 0);
@@ -231,73 +362,393 @@ void lemlib::Chassis::follow(const asset& path, float lookahead, int timeout, bo
     float targetVel;
     float prevLeftVel = 0;
     float prevRightVel = 0;
-    int closestPoint;
+    int closestPoint = 0;
     float leftInput = 0;
     float rightInput = 0;
     float prevVel = 0;
+    // hot motors follow the path slower, so they draw less current before the firmware limits it
+    const float thermal = this->thermalScale();
+    const DrivetrainKinematics kinematics = drivetrain.kinematics();
+    // a deadline slows the robot down to the speed that reaches the end in time. Velocities of the path are in inches
+    // per second with a feedforward model, and power without one
+    const float unit = feedforward.isEnabled() ? 1 : kinematics.speedPerPower;
+    const float pathDuration = deadline > 0 ? pathTime(pathPoints, unit) : 0;
+    // the slowest the robot follows the path when it is chained into the next motion, in the units of the path
+    const float minVel = feedforward.isEnabled() ? params.minSpeed * kinematics.speedPerPower : params.minSpeed;
     int compState = pros::competition::get_status();
     distTraveled = 0;
+    // a minimum speed leaves the path at speed for the next motion, so the end isn't settled on
+    const bool finishing = params.finishDistance > 0 && params.minSpeed == 0;
+    // the pose jumps when it is set or corrected, and the search for the closest point has to start again
+    uint32_t poseJumps = this->odom.getState().jumps;
+
+    Timer timer(timeout);
 
     // loop until the robot is within the end tolerance
-    for (int i = 0; i < timeout / 10 && pros::competition::get_status() == compState && this->motionRunning; i++) {
-        // get the current position of the robot
-        pose = this->getPose(true);
+    while (!timer.isDone(this->tickTime) && pros::competition::get_status() == compState && this->motionRunning()) {
+        // get the current position of the robot, predicted ahead by the latency of the loop if it is set
+        const uint32_t jumps = this->odom.getState().jumps;
+        pose = this->getPredictedPose(this->followLatency, true);
         if (!forwards) pose.theta -= M_PI;
 
+        // the pose jumped, so the closest point is found around the new pose, and the lookahead point may move back
+        const bool jumped = jumps != poseJumps;
+        poseJumps = jumps;
+        if (jumped) {
+            lastPose = pose;
+            closestPoint = relocateClosest(pose, pathPoints, closestPoint, lookahead);
+            lastLookahead.theta = pathPoints.distance(closestPoint);
+        }
+
         // update completion vars
         distTraveled += pose.distance(lastPose);
         lastPose = pose;
 
         // find the closest point on the path to the robot
-        closestPoint = findClosest(pose, pathPoints);
+        // if no point in the search window is within the lookahead distance, the robot has left the path
+        closestPoint = findClosest(pose, pathPoints, closestPoint, lookahead);
+        // run the callbacks that were reached and wake tasks waiting for this distance
+        this->reportProgress(closestPoint);
         // if the robot is at the end of the path, then stop
-        if (pathPoints.at(closestPoint).theta == 0) break;
+        if (pathPoints.velocity(closestPoint) == 0) break;
+        // exit before the end of the path, so the next motion takes the robot while it is moving
+        const float remaining = pathPoints.length() - pathPoints.distance(closestPoint);
+        if (params.earlyExitRange > 0 && remaining < params.earlyExitRange) break;
+        // hand the rest of the path to the lateral controller, which settles on the end
+        if (finishing && remaining < params.finishDistance) break;
 
         // find the lookahead point
-        lookaheadPose = lookaheadPoint(lastLookahead, pose, pathPoints, closestPoint, lookahead);
+        float lookaheadDist = lookahead;
+        if (this->adaptiveLookahead) {
+            lookaheadDist = adaptLookahead(*this->adaptiveLookahead, pathPoints, closestPoint,
+                                           this->odom.getLocalSpeed().y, lookahead);
+        }
+        lookaheadPose = lookaheadPoint(lastLookahead, pose, pathPoints, closestPoint, lookaheadDist);
         lastLookahead = lookaheadPose; // update last lookahead position
+        poseStream().setTarget(lookaheadPose.x, lookaheadPose.y);
 
         // get the curvature of the arc between the robot and the lookahead point
-        float curvatureHeading = M_PI / 2 - pose.theta;
-        curvature = findLookaheadCurvature(pose, curvatureHeading, lookaheadPose);
-
-        // get the target velocity of the robot
-        targetVel = pathPoints.at(closestPoint).theta;
-        targetVel = slew(targetVel, prevVel, lateralSettings.slew);
+        curvature = getCurvature(Pose(pose.x, pose.y, M_PI / 2 - pose.theta), lookaheadPose);
+
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.targetX = lookaheadPose.x;
+        sample.targetY = lookaheadPose.y;
+        sample.curvature = curvature;
+
+        // get the target velocity of the robot. The speed for the deadline is planned again every iteration from the
+        // part of the path that is left, so the robot makes up for time it lost
+        const float left = pathPoints.length() > 0 ? 1 - pathPoints.distance(closestPoint) / pathPoints.length() : 0;
+        const float scale =
+            thermal * timeScale(pathDuration * left, deadline - int(timer.getTimePassed(this->tickTime)));
+        targetVel = std::fmax(pathPoints.velocity(closestPoint) * scale, minVel);
+        targetVel = sample.limit(TraceClamp::SLEW, targetVel,
+                                 slew(targetVel, prevVel, this->lateralSlew(lateralSettings) * scale * tickScale));
         prevVel = targetVel;
+        if (binaryTelemetry().isEnabled(TelemetryChannel::PATH)) {
+            binaryTelemetry().sendPath(lookaheadPose.x, lookaheadPose.y, lookaheadPose.theta, curvature, targetVel);
+        }
 
         // calculate target left and right velocities
-        float targetLeftVel = targetVel * (2 + curvature * drivetrain.trackWidth) / 2;
-        float targetRightVel = targetVel * (2 - curvature * drivetrain.trackWidth) / 2;
+        float targetLeftVel = targetVel * (1 + curvature * kinematics.halfTrack);
+        float targetRightVel = targetVel * (1 - curvature * kinematics.halfTrack);
+
+        // with a feedforward model the velocities are in inches per second, otherwise they are sent as power
+        float leftPower = targetLeftVel;
+        float rightPower = targetRightVel;
+        if (feedforward.isEnabled()) {
+            const float dt = tickDuration();
+            const float leftAccel = (targetLeftVel - prevLeftVel) / dt;
+            const float rightAccel = (targetRightVel - prevRightVel) / dt;
+            if (forwards) {
+                leftPower = velocityPower(DriveSide::LEFT, targetLeftVel, leftAccel);
+                rightPower = velocityPower(DriveSide::RIGHT, targetRightVel, rightAccel);
+            } else {
+                // backwards, the left of the path is driven by the right wheels, with the powers mirrored
+                leftPower = -velocityPower(DriveSide::RIGHT, -targetLeftVel, -leftAccel);
+                rightPower = -velocityPower(DriveSide::LEFT, -targetRightVel, -rightAccel);
+            }
+        }
+
+        // update previous velocities
+        prevLeftVel = targetLeftVel;
+        prevRightVel = targetRightVel;
 
         // ratio the speeds to respect the max speed
-        float ratio = std::max(std::fabs(targetLeftVel), std::fabs(targetRightVel)) / 127;
+        float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
         if (ratio > 1) {
-            targetLeftVel /= ratio;
-            targetRightVel /= ratio;
+            leftPower /= ratio;
+            rightPower /= ratio;
+            sample.clamps |= uint8_t(TraceClamp::RATIO);
         }
 
-        // update previous velocities
+        // move the drivetrain
+        if (forwards) {
+            this->setDrivePower(leftPower, rightPower);
+            sample.left = leftPower;
+            sample.right = rightPower;
+        } else {
+            this->setDrivePower(-rightPower, -leftPower);
+            sample.left = -rightPower;
+            sample.right = -leftPower;
+        }
+        this->trace(sample);
+
+        // wait for the next pose from odometry
+        this->waitForTick();
+    }
+
+    // stop the robot. Reaching the end of the path with a minimum speed is an early exit, so the robot isn't stopped
+    bool settled = pathPoints.velocity(closestPoint) == 0 && params.minSpeed == 0;
+    if (finishing && this->motionRunning() && !timer.isDone(this->tickTime)) {
+        const int left = timeout - int(timer.getTimePassed(this->tickTime));
+        settled = this->finishPath(this->pathEnd, left, compState, closestPoint);
+    }
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
+    poseStream().setTarget(NAN, NAN);
+    // set distTraveled to -1 to indicate that the function has finished
+    distTraveled = -1;
+    // let the next motion start
+    this->endMotion(reason);
+    return this->currentMotion();
+}
+
+bool lemlib::Chassis::finishPath(Pose target, int timeout, int compState, int pathIndex) {
+    lateralPID.reset();
+    angularPID.reset();
+    lateralLargeExit.reset();
+    lateralSmallExit.reset();
+    Pose lastPose = this->getPose(true);
+    Timer timer(timeout);
+    // the controller may drive as fast as the robot was following the path and no faster, so it neither brakes hard
+    // nor speeds up when it takes over
+    const float maxPowerSpeed = drivetrain.kinematics().topSpeed;
+    const float entryPower = std::fabs(this->odom.getLocalSpeed().y) / maxPowerSpeed * 127;
+    const float maxSpeed = std::min(entryPower, 127.0f);
+
+    while (!timer.isDone(this->tickTime) && !lateralSmallExit.getExit() && !lateralLargeExit.getExit() &&
+           pros::competition::get_status() == compState && this->motionRunning()) {
+        const Pose pose = this->getPose(true);
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+        this->reportProgress(pathIndex);
+
+        // the error is along the heading of the robot, so the robot drives straight onto the end without turning,
+        // like moveToPoint once it is close to its target
+        const float lateralError = pose.distance(target) * std::cos(angleError(pose.theta, pose.angle(target)));
+        updateSmallExit(lateralSmallExit, lateralSettings, lateralError, this->odom.getLocalSpeed().y);
+        lateralLargeExit.update(lateralError, this->tickTime);
+
+        MotionSample sample;
+        sample.lateralError = lateralError;
+        sample.targetX = target.x;
+        sample.targetY = target.y;
+        float lateralOut = lateralPID.update(lateralError);
+        sample.lateral = lateralPID.getTerms();
+        lateralOut = sample.limit(TraceClamp::MAX_SPEED, lateralOut, std::clamp(lateralOut, -maxSpeed, maxSpeed));
+        // slow down no faster than the robot can decelerate, so it doesn't overshoot the end
+        if (lateralSettings.maxAcceleration > 0) {
+            const float stopSpeed = std::sqrt(2 * lateralSettings.maxAcceleration * std::fabs(lateralError));
+            const float stopPower = stopSpeed / maxPowerSpeed * 127;
+            lateralOut =
+                sample.limit(TraceClamp::MAX_SPEED, lateralOut, std::clamp(lateralOut, -stopPower, stopPower));
+        }
+
+        // steer onto the end while it is far enough away that turning doesn't swing the robot past it
+        const float targetTheta = lateralError >= 0 ? pose.angle(target) : pose.angle(target) + M_PI;
+        const float angularError = radToDeg(angleError(pose.theta, targetTheta));
+        const float angularOut = pose.distance(target) > 3 ? angularPID.update(angularError) : 0;
+        this->setDrivePower(lateralOut + angularOut, lateralOut - angularOut);
+        sample.left = lateralOut + angularOut;
+        sample.right = lateralOut - angularOut;
+        this->trace(sample);
+        this->waitForTick();
+    }
+    return lateralSmallExit.getExit() || lateralLargeExit.getExit();
+}
+
+lemlib::MotionHandle lemlib::Chassis::follow(const SplinePath& path, float lookahead, int timeout, bool forwards,
+                                             bool async, int deadline, FollowParams params) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::FOLLOW};
+        command.timeout = timeout;
+        command.spline = &path;
+        command.lookahead = lookahead;
+        command.forwards = forwards;
+        command.deadline = deadline;
+        command.params = params;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
+
+    if (path.size() == 0) {
+        infoSink()->error("No splines in path! Does it have at least 2 waypoints? Skipping motion");
+        // set distTraveled to -1 to indicate that the function has finished
+        distTraveled = -1;
+        // let the next motion start
+        this->endMotion(MotionEndReason::CANCELLED);
+        return this->currentMotion();
+    }
+    this->pathEnd = path.at(path.size());
+    Pose pose = this->getPose(true);
+    Pose lastPose = pose;
+    // parameters of the closest point and the lookahead point. Each is the starting guess for the next iteration
+    float closest = path.closest(pose, 0);
+    float lookaheadParam = closest;
+    float prevLeftVel = 0;
+    float prevRightVel = 0;
+    float prevVel = 0;
+    // hot motors follow the path slower, so they draw less current before the firmware limits it
+    const float thermal = this->thermalScale();
+    const DrivetrainKinematics kinematics = drivetrain.kinematics();
+    // a deadline slows the robot down to the speed that reaches the end in time. Velocities of the path are in inches
+    // per second with a feedforward model, and power without one
+    const float unit = feedforward.isEnabled() ? 1 : kinematics.speedPerPower;
+    const float pathDuration = deadline > 0 ? pathTime(path, unit) : 0;
+    // the slowest the robot follows the path when it is chained into the next motion, in the units of the path
+    const float minVel = feedforward.isEnabled() ? params.minSpeed * kinematics.speedPerPower : params.minSpeed;
+    int compState = pros::competition::get_status();
+    distTraveled = 0;
+    // a minimum speed leaves the path at speed for the next motion, so the end isn't settled on
+    const bool finishing = params.finishDistance > 0 && params.minSpeed == 0;
+    // the pose jumps when it is set or corrected, and the search for the closest point has to start again
+    uint32_t poseJumps = this->odom.getState().jumps;
+
+    Timer timer(timeout);
+
+    // loop until the robot is at the end of the path
+    while (!timer.isDone(this->tickTime) && pros::competition::get_status() == compState && this->motionRunning()) {
+        // get the current position of the robot, predicted ahead by the latency of the loop if it is set
+        const uint32_t jumps = this->odom.getState().jumps;
+        pose = this->getPredictedPose(this->followLatency, true);
+        if (!forwards) pose.theta -= M_PI;
+
+        // the pose jumped, so Newton's method is started from the nearest of the points sampled around the new pose,
+        // and the lookahead point may move back
+        const bool jumped = jumps != poseJumps;
+        poseJumps = jumps;
+        if (jumped) {
+            lastPose = pose;
+            closest = relocateSpline(pose, path, closest, lookahead);
+            lookaheadParam = closest;
+        }
+
+        // update completion vars
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+
+        // find the closest point on the path to the robot
+        closest = path.closest(pose, closest);
+        // run the callbacks that were reached and wake tasks waiting for this distance
+        this->reportProgress(int(closest));
+        // if the robot is at the end of the path, then stop
+        if (path.velocity(closest) == 0) break;
+        // exit before the end of the path, so the next motion takes the robot while it is moving. A spline path has no
+        // length, so the distance is measured straight to its end
+        if (params.earlyExitRange > 0 && pose.distance(this->pathEnd) < params.earlyExitRange) break;
+        // hand the rest of the path to the lateral controller, which settles on the end
+        if (finishing && pose.distance(this->pathEnd) < params.finishDistance) break;
+
+        // find the lookahead point. It never moves backwards along the path
+        float lookaheadDist = lookahead;
+        if (this->adaptiveLookahead) {
+            const AdaptiveLookahead& settings = *this->adaptiveLookahead;
+            const float speed = std::fabs(this->odom.getLocalSpeed().y);
+            const float curve = std::fabs(path.curvature(closest));
+            lookaheadDist = std::clamp((settings.minLookahead + settings.speedGain * speed) /
+                                           (1 + settings.curvatureGain * curve),
+                                       std::fmin(settings.minLookahead, lookahead), lookahead);
+        }
+        lookaheadParam = path.lookahead(pose, closest, std::max(lookaheadParam, closest), lookaheadDist);
+        const Pose lookaheadPose = path.at(lookaheadParam);
+        poseStream().setTarget(lookaheadPose.x, lookaheadPose.y);
+
+        // get the curvature of the arc between the robot and the lookahead point
+        const float curvature = getCurvature(Pose(pose.x, pose.y, M_PI / 2 - pose.theta), lookaheadPose);
+
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.targetX = lookaheadPose.x;
+        sample.targetY = lookaheadPose.y;
+        sample.curvature = curvature;
+
+        // get the target velocity of the robot
+        // the speed for the deadline is planned again every iteration from the splines that are left
+        const float left = 1 - closest / path.size();
+        const float scale =
+            thermal * timeScale(pathDuration * left, deadline - int(timer.getTimePassed(this->tickTime)));
+        float targetVel = std::fmax(path.velocity(closest) * scale, minVel);
+        targetVel = sample.limit(TraceClamp::SLEW, targetVel,
+                                 slew(targetVel, prevVel, this->lateralSlew(lateralSettings) * scale * tickScale));
+        prevVel = targetVel;
+        if (binaryTelemetry().isEnabled(TelemetryChannel::PATH)) {
+            binaryTelemetry().sendPath(lookaheadPose.x, lookaheadPose.y, lookaheadParam, curvature, targetVel);
+        }
+
+        // calculate target left and right velocities
+        const float targetLeftVel = targetVel * (1 + curvature * kinematics.halfTrack);
+        const float targetRightVel = targetVel * (1 - curvature * kinematics.halfTrack);
+
+        // with a feedforward model the velocities are in inches per second, otherwise they are sent as power
+        float leftPower = targetLeftVel;
+        float rightPower = targetRightVel;
+        if (feedforward.isEnabled()) {
+            const float dt = tickDuration();
+            const float leftAccel = (targetLeftVel - prevLeftVel) / dt;
+            const float rightAccel = (targetRightVel - prevRightVel) / dt;
+            if (forwards) {
+                leftPower = velocityPower(DriveSide::LEFT, targetLeftVel, leftAccel);
+                rightPower = velocityPower(DriveSide::RIGHT, targetRightVel, rightAccel);
+            } else {
+                // backwards, the left of the path is driven by the right wheels, with the powers mirrored
+                leftPower = -velocityPower(DriveSide::RIGHT, -targetLeftVel, -leftAccel);
+                rightPower = -velocityPower(DriveSide::LEFT, -targetRightVel, -rightAccel);
+            }
+        }
         prevLeftVel = targetLeftVel;
         prevRightVel = targetRightVel;
 
+        // ratio the speeds to respect the max speed
+        const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+            sample.clamps |= uint8_t(TraceClamp::RATIO);
+        }
+
         // move the drivetrain
         if (forwards) {
-            drivetrain.leftMotors->move(targetLeftVel);
-            drivetrain.rightMotors->move(targetRightVel);
+            this->setDrivePower(leftPower, rightPower);
+            sample.left = leftPower;
+            sample.right = rightPower;
         } else {
-            drivetrain.leftMotors->move(-targetRightVel);
-            drivetrain.rightMotors->move(-targetLeftVel);
+            this->setDrivePower(-rightPower, -leftPower);
+            sample.left = -rightPower;
+            sample.right = -leftPower;
         }
+        this->trace(sample);
 
-        pros::delay(10);
+        // wait for the next pose from odometry
+        this->waitForTick();
     }
 
-    // stop the robot
-    drivetrain.leftMotors->move(0);
-    drivetrain.rightMotors->move(0);
+    // stop the robot. Reaching the end of the path with a minimum speed is an early exit, so the robot isn't stopped
+    bool settled = path.velocity(closest) == 0 && params.minSpeed == 0;
+    if (finishing && this->motionRunning() && !timer.isDone(this->tickTime)) {
+        const int left = timeout - int(timer.getTimePassed(this->tickTime));
+        settled = this->finishPath(this->pathEnd, left, compState, int(closest));
+    }
+    const MotionEndReason reason = this->exitReason(settled, timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
+    poseStream().setTarget(NAN, NAN);
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
-    // give the mutex back
-    this->endMotion();
+    // let the next motion start
+    this->endMotion(reason);
+    return this->currentMotion();
 }
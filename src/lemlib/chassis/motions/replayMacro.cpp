@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/timer.hpp"
+#include "lemlib/util.hpp"
+
+lemlib::MotionHandle lemlib::Chassis::replayMacro(const DriverMacro& macro, MacroParams params, bool async) {
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        MotionCommand command {MotionType::MACRO, params};
+        command.macro = &macro;
+        const MotionHandle handle = this->queueMotion(command);
+        if (!async) handle.wait();
+        return handle;
+    }
+    return this->runMacro(macro, params, this->fieldTransform);
+}
+
+lemlib::MotionHandle lemlib::Chassis::runMacro(const DriverMacro& macro, MacroParams params,
+                                               const FieldTransform& transform) {
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
+
+    // decoded on the motion task, so the caller doesn't wait for it
+    std::vector<MacroSample> samples;
+    std::vector<MacroPose> poses;
+    if (!macro.decode(samples, poses)) {
+        infoSink()->error("Driver macro is empty! Skipping motion");
+        distTraveled = -1;
+        this->endMotion(MotionEndReason::CANCELLED);
+        return this->currentMotion();
+    }
+    // the poses were recorded in the coordinates of the route, like the targets of other motions
+    for (MacroPose& pose : poses) pose.pose = transform.apply(pose.pose);
+    // in a mirrored route the robot turns the other way, and the sides of tank swap
+    const bool mirrored = transform.flipsHandedness();
+    const DriveScheme scheme = macro.getScheme();
+    const uint32_t period = macro.getPeriod();
+    this->pathEnd = poses.empty() ? Pose(NAN, NAN) : poses.back().pose;
+    Pose lastPose = getPose();
+    distTraveled = 0;
+    Timer timer(samples.size() * period);
+    size_t poseIndex = 0;
+
+    while (!timer.isDone(this->tickTime) && this->motionRunning()) {
+        const Pose pose = getPose();
+        distTraveled += pose.distance(lastPose);
+        lastPose = pose;
+        this->reportProgress();
+
+        // the sticks of the sample the recording had at this time
+        const uint32_t time = timer.getTimePassedMicros(this->tickTime) / 1000;
+        const MacroSample& sample = samples[std::min<size_t>(time / period, samples.size() - 1)];
+        int throttle = sample.throttle;
+        int turn = sample.turn;
+        if (mirrored && scheme == DriveScheme::TANK) std::swap(throttle, turn);
+        else if (mirrored) turn = -turn;
+        auto [leftPower, rightPower] =
+            this->drivePower(scheme, throttle, turn, macro.driveCurveDisabled(), macro.getDesaturateBias());
+
+        // the internals of this iteration, for the motion trace
+        MotionSample trace;
+        if (!poses.empty()) {
+            // where the robot was at this time in the recording, between the poses around it
+            while (poseIndex + 1 < poses.size() && poses[poseIndex + 1].time <= time) poseIndex++;
+            Pose target = poses[poseIndex].pose;
+            if (poseIndex + 1 < poses.size()) {
+                const MacroPose& prev = poses[poseIndex];
+                const MacroPose& next = poses[poseIndex + 1];
+                const float t = std::min(float(time - prev.time) / (next.time - prev.time), 1.0f);
+                target.x += (next.pose.x - target.x) * t;
+                target.y += (next.pose.y - target.y) * t;
+                target.theta += angleError(next.pose.theta, target.theta, false) * t;
+            }
+
+            // error in the frame of the robot
+            const float theta = degToRad(pose.theta);
+            const float dx = target.x - pose.x;
+            const float dy = target.y - pose.y;
+            const float forwardError = std::sin(theta) * dx + std::cos(theta) * dy;
+            const float sideError = std::cos(theta) * dx - std::sin(theta) * dy;
+            const float headingError = angleError(target.theta, pose.theta, false);
+
+            // the robot can only turn back to the recorded path while it drives, and turns the other way backwards
+            const float drive = std::clamp((leftPower + rightPower) / 127, -1.0f, 1.0f);
+            const float linear = params.kLinear * forwardError;
+            const float angular = params.kAngular * headingError + params.kLateral * sideError * drive;
+            leftPower += std::clamp(linear + angular, -params.maxCorrection, params.maxCorrection);
+            rightPower += std::clamp(linear - angular, -params.maxCorrection, params.maxCorrection);
+            trace.lateralError = forwardError;
+            trace.angularError = headingError;
+            trace.targetX = target.x;
+            trace.targetY = target.y;
+        }
+
+        // ratio the speeds to respect the max speed
+        const float ratio = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+        if (ratio > 1) {
+            leftPower /= ratio;
+            rightPower /= ratio;
+            trace.clamps |= uint8_t(TraceClamp::RATIO);
+        }
+
+        this->setDrivePower(leftPower, rightPower);
+        trace.left = leftPower;
+        trace.right = rightPower;
+        this->trace(trace);
+        this->waitForTick();
+    }
+
+    // the macro ends when its last sample does
+    const MotionEndReason reason = this->exitReason(timer.isDone(this->tickTime), false);
+    this->stopDrivetrain(reason);
+    // set distTraveled to -1 to indicate that the function has finished
+    distTraveled = -1;
+    this->endMotion(reason);
+    return this->currentMotion();
+}
@@ -5,19 +5,18 @@
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
-void lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int timeout, SwingToHeadingParams params,
-                                     bool async) {
+lemlib::MotionHandle lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int timeout,
+                                                     SwingToHeadingParams params, bool async) {
     params.minSpeed = fabs(params.minSpeed);
-    this->requestMotionStart();
-    // were all motions cancelled?
-    if (!this->motionRunning) return;
-    // if the function is async, run it in a new task
-    if (async) {
-        pros::Task task([&]() { swingToHeading(theta, lockedSide, timeout, params, false); });
-        this->endMotion();
-        pros::delay(10); // delay to give the task time to start
-        return;
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        const MotionHandle handle =
+            this->queueMotion({MotionType::SWING_TO_HEADING, params, 0, 0, theta, timeout, lockedSide});
+        if (!async) handle.wait();
+        return handle;
     }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
     float targetTheta;
     float deltaTheta;
     float motorPower;
@@ -26,6 +25,12 @@ void lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int time
     bool settling = false;
     std::optional<float> prevRawDeltaTheta = std::nullopt;
     std::optional<float> prevDeltaTheta = std::nullopt;
+    std::optional<MotionProfile> profile = std::nullopt;
+    // the outer side swings around the locked side, so its wheels move along an arc of the track width
+    const ControllerSettings settings =
+        this->turnProfileSettings(params.maxSpeed, params.timeOptimal, drivetrain.trackWidth, params.traction);
+    // the profile limits the acceleration, so slew would only hold the robot back from it
+    const bool profiled = settings.maxVelocity > 0 && settings.maxAcceleration > 0;
     std::uint8_t compState = pros::competition::get_status();
     distTraveled = 0;
     Timer timer(timeout);
@@ -33,21 +38,21 @@ void lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int time
     angularSmallExit.reset();
     angularPID.reset();
     // get original braking mode of that side of the drivetrain so we can set it back to it after this motion ends
-    pros::motor_brake_mode_e brakeMode = (lockedSide == DriveSide::LEFT)
-                                             ? this->drivetrain.leftMotors->get_brake_modes().at(0)
-                                             : this->drivetrain.rightMotors->get_brake_modes().at(0);
+    const pros::motor_brake_mode_e brakeMode = this->drivetrain.getBrakeMode(lockedSide);
     // set brake mode of the locked side to hold
-    if (lockedSide == DriveSide::LEFT) this->drivetrain.leftMotors->set_brake_modes(pros::E_MOTOR_BRAKE_HOLD);
-    else this->drivetrain.rightMotors->set_brake_modes(pros::E_MOTOR_BRAKE_HOLD);
+    this->drivetrain.setBrakeMode(lockedSide, pros::E_MOTOR_BRAKE_HOLD);
 
     // main loop
-    while (!timer.isDone() && !angularLargeExit.getExit() && !angularSmallExit.getExit() && this->motionRunning) {
+    while (!timer.isDone(this->tickTime) && !angularLargeExit.getExit() && !angularSmallExit.getExit() &&
+           this->motionRunning()) {
         // update variables
         Pose pose = getPose();
         pose.theta = fmod(pose.theta, 360);
 
         // update completion vars
         distTraveled = fabs(angleError(pose.theta, startTheta, false));
+        // run progress callbacks and wake tasks waiting for this distance
+        this->reportProgress();
         targetTheta = theta;
 
         // check if settling
@@ -57,7 +62,7 @@ void lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int time
         prevRawDeltaTheta = rawDeltaTheta;
 
         // calculate deltaTheta
-        if (settling) deltaTheta = angleError(targetTheta, pose.theta, false);
+        if (settling) deltaTheta = rawDeltaTheta; // the shortest error was already calculated
         else deltaTheta = angleError(targetTheta, pose.theta, false, params.direction);
         if (prevDeltaTheta == std::nullopt) prevDeltaTheta = deltaTheta;
 
@@ -66,41 +71,66 @@ void lemlib::Chassis::swingToHeading(float theta, DriveSide lockedSide, int time
         if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(prevDeltaTheta)) break;
 
         // calculate the speed
-        motorPower = angularPID.update(deltaTheta);
-        angularLargeExit.update(deltaTheta);
-        angularSmallExit.update(deltaTheta);
+        // follow the motion profile, if there is one
+        ProfileState setpoint;
+        const float profileError =
+            trackProfile(profile, settings, deltaTheta, timer.getTimePassed(this->tickTime), setpoint);
+        motorPower = updateAngularPID(profileError);
+        // the feedforward drives the outer side along the profile
+        const float wheelSpeed = degToRad(setpoint.velocity) * drivetrain.trackWidth;
+        const float wheelAcceleration = degToRad(setpoint.acceleration) * drivetrain.trackWidth;
+        motorPower += lockedSide == DriveSide::LEFT
+                          ? -velocityPower(DriveSide::RIGHT, -wheelSpeed, -wheelAcceleration)
+                          : velocityPower(DriveSide::LEFT, wheelSpeed, wheelAcceleration);
+        angularLargeExit.update(deltaTheta, this->tickTime);
+        // the error shrinks as the heading moves towards the target
+        updateSmallExit(angularSmallExit, settings, deltaTheta, odom.getSpeed().theta);
+
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.angularError = deltaTheta;
+        sample.angular = angularPID.getTerms();
 
         // cap the speed
-        if (motorPower > params.maxSpeed) motorPower = params.maxSpeed;
-        else if (motorPower < -params.maxSpeed) motorPower = -params.maxSpeed;
-        if (fabs(deltaTheta) > 20) motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
-        if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
-        else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
+        if (motorPower > params.maxSpeed) motorPower = sample.limit(TraceClamp::MAX_SPEED, motorPower, params.maxSpeed);
+        else if (motorPower < -params.maxSpeed)
+            motorPower = sample.limit(TraceClamp::MAX_SPEED, motorPower, -params.maxSpeed);
+        if (!profiled && fabs(deltaTheta) > 20)
+            motorPower = sample.limit(TraceClamp::SLEW, motorPower,
+                                      slew(motorPower, prevMotorPower, angularSettings.slew * tickScale));
+        if (motorPower < 0 && motorPower > -params.minSpeed)
+            motorPower = sample.limit(TraceClamp::MIN_SPEED, motorPower, -params.minSpeed);
+        else if (motorPower > 0 && motorPower < params.minSpeed)
+            motorPower = sample.limit(TraceClamp::MIN_SPEED, motorPower, params.minSpeed);
         prevMotorPower = motorPower;
 
-        infoSink()->debug("Turn Motor Power: {} ", motorPower);
+        LEMLIB_DEBUG_EVERY(10, "Turn Motor Power: {} ", motorPower);
 
         // move the drivetrain
         if (lockedSide == DriveSide::LEFT) {
-            drivetrain.rightMotors->move(-motorPower);
-            drivetrain.leftMotors->brake();
+            this->setDrivePower(DriveSide::RIGHT, -motorPower);
+            this->brakeDriveSide(DriveSide::LEFT);
+            sample.right = -motorPower;
         } else {
-            drivetrain.leftMotors->move(motorPower);
-            drivetrain.rightMotors->brake();
+            this->setDrivePower(DriveSide::LEFT, motorPower);
+            this->brakeDriveSide(DriveSide::RIGHT);
+            sample.left = motorPower;
         }
+        this->trace(sample);
 
-        // delay to save resources
-        pros::delay(10);
+        // wait for the next pose from odometry
+        this->waitForTick();
     }
 
     // set the brake mode of the locked side of the drivetrain to its
     // original value
-    if (lockedSide == DriveSide::LEFT) this->drivetrain.leftMotors->set_brake_modes(brakeMode);
-    else this->drivetrain.rightMotors->set_brake_modes(brakeMode);
+    this->drivetrain.setBrakeMode(lockedSide, brakeMode);
     // stop the drivetrain
-    drivetrain.leftMotors->move(0);
-    drivetrain.rightMotors->move(0);
+    const MotionEndReason reason =
+        this->exitReason(angularLargeExit.getExit() || angularSmallExit.getExit(), timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
-    this->endMotion();
+    this->endMotion(reason);
+    return this->currentMotion();
 }
\ No newline at end of file
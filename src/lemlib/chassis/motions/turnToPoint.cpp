@@ -5,18 +5,17 @@
 #include "lemlib/util.hpp"
 #include "pros/misc.hpp"
 
-void lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointParams params, bool async) {
+lemlib::MotionHandle lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointParams params,
+                                                  bool async) {
     params.minSpeed = std::abs(params.minSpeed);
-    this->requestMotionStart();
-    // were all motions cancelled?
-    if (!this->motionRunning) return;
-    // if the function is async, run it in a new task
-    if (async) {
-        pros::Task task([&]() { turnToPoint(x, y, timeout, params, false); });
-        this->endMotion();
-        pros::delay(10); // delay to give the task time to start
-        return;
+    // motions only run on the motion task. Motions that aren't async wait for it to finish
+    if (!this->onMotionTask()) {
+        const MotionHandle handle = this->queueMotion({MotionType::TURN_TO_POINT, params, x, y, 0, timeout});
+        if (!async) handle.wait();
+        return handle;
     }
+    // was the motion cancelled before it started?
+    if (!this->requestMotionStart()) return this->currentMotion();
     float targetTheta;
     float deltaX, deltaY, deltaTheta;
     float motorPower;
@@ -25,6 +24,12 @@ void lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointPara
     bool settling = false;
     std::optional<float> prevRawDeltaTheta = std::nullopt;
     std::optional<float> prevDeltaTheta = std::nullopt;
+    std::optional<MotionProfile> profile = std::nullopt;
+    // the wheels turn in place along an arc of half the track width
+    const float halfTrack = drivetrain.kinematics().halfTrack;
+    const ControllerSettings settings = this->turnProfileSettings(params.maxSpeed, params.timeOptimal, halfTrack);
+    // the profile limits the acceleration, so slew would only hold the robot back from it
+    const bool profiled = settings.maxVelocity > 0 && settings.maxAcceleration > 0;
     std::uint8_t compState = pros::competition::get_status();
     distTraveled = 0;
     Timer timer(timeout);
@@ -33,13 +38,16 @@ void lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointPara
     angularPID.reset();
 
     // main loop
-    while (!timer.isDone() && !angularLargeExit.getExit() && !angularSmallExit.getExit() && this->motionRunning) {
+    while (!timer.isDone(this->tickTime) && !angularLargeExit.getExit() && !angularSmallExit.getExit() &&
+           this->motionRunning()) {
         // update variables
         Pose pose = getPose();
         pose.theta = (params.forwards) ? fmod(pose.theta, 360) : fmod(pose.theta - 180, 360);
 
         // update completion vars
         distTraveled = fabs(angleError(pose.theta, startTheta, false));
+        // run progress callbacks and wake tasks waiting for this distance
+        this->reportProgress();
 
         deltaX = x - pose.x;
         deltaY = y - pose.y;
@@ -52,7 +60,7 @@ void lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointPara
         prevRawDeltaTheta = rawDeltaTheta;
 
         // calculate deltaTheta
-        if (settling) deltaTheta = angleError(targetTheta, pose.theta, false);
+        if (settling) deltaTheta = rawDeltaTheta; // the shortest error was already calculated
         else deltaTheta = angleError(targetTheta, pose.theta, false, params.direction);
         if (prevDeltaTheta == std::nullopt) prevDeltaTheta = deltaTheta;
 
@@ -61,31 +69,59 @@ void lemlib::Chassis::turnToPoint(float x, float y, int timeout, TurnToPointPara
         if (params.minSpeed != 0 && sgn(deltaTheta) != sgn(prevDeltaTheta)) break;
 
         // calculate the speed
-        motorPower = angularPID.update(deltaTheta);
-        angularLargeExit.update(deltaTheta);
-        angularSmallExit.update(deltaTheta);
+        // follow the motion profile, if there is one
+        ProfileState setpoint;
+        const float profileError =
+            trackProfile(profile, settings, deltaTheta, timer.getTimePassed(this->tickTime), setpoint);
+        motorPower = updateAngularPID(profileError);
+        // the feedforward turns the robot along the profile. Each side moves along an arc of half the track width
+        const float wheelSpeed = degToRad(setpoint.velocity) * halfTrack;
+        const float wheelAcceleration = degToRad(setpoint.acceleration) * halfTrack;
+        motorPower += (velocityPower(DriveSide::LEFT, wheelSpeed, wheelAcceleration) -
+                       velocityPower(DriveSide::RIGHT, -wheelSpeed, -wheelAcceleration)) /
+                      2;
+        angularLargeExit.update(deltaTheta, this->tickTime);
+        // the error shrinks as the heading moves towards the target
+        updateSmallExit(angularSmallExit, settings, deltaTheta, odom.getSpeed().theta);
+
+        // the internals of this iteration, for the motion trace
+        MotionSample sample;
+        sample.angularError = deltaTheta;
+        sample.angular = angularPID.getTerms();
+        sample.targetX = x;
+        sample.targetY = y;
 
         // cap the speed
-        if (motorPower > params.maxSpeed) motorPower = params.maxSpeed;
-        else if (motorPower < -params.maxSpeed) motorPower = -params.maxSpeed;
-        if (fabs(deltaTheta) > 20) motorPower = slew(motorPower, prevMotorPower, angularSettings.slew);
-        if (motorPower < 0 && motorPower > -params.minSpeed) motorPower = -params.minSpeed;
-        else if (motorPower > 0 && motorPower < params.minSpeed) motorPower = params.minSpeed;
+        if (motorPower > params.maxSpeed) motorPower = sample.limit(TraceClamp::MAX_SPEED, motorPower, params.maxSpeed);
+        else if (motorPower < -params.maxSpeed)
+            motorPower = sample.limit(TraceClamp::MAX_SPEED, motorPower, -params.maxSpeed);
+        if (!profiled && fabs(deltaTheta) > 20)
+            motorPower = sample.limit(TraceClamp::SLEW, motorPower,
+                                      slew(motorPower, prevMotorPower, angularSettings.slew * tickScale));
+        if (motorPower < 0 && motorPower > -params.minSpeed)
+            motorPower = sample.limit(TraceClamp::MIN_SPEED, motorPower, -params.minSpeed);
+        else if (motorPower > 0 && motorPower < params.minSpeed)
+            motorPower = sample.limit(TraceClamp::MIN_SPEED, motorPower, params.minSpeed);
         prevMotorPower = motorPower;
 
-        infoSink()->debug("Turn Motor Power: {} ", motorPower);
+        LEMLIB_DEBUG_EVERY(10, "Turn Motor Power: {} ", motorPower);
 
         // move the drivetrain
-        drivetrain.leftMotors->move(motorPower);
-        drivetrain.rightMotors->move(-motorPower);
+        this->setDrivePower(motorPower, -motorPower);
+        sample.left = motorPower;
+        sample.right = -motorPower;
+        this->trace(sample);
 
-        pros::delay(10);
+        // wait for the next pose from odometry
+        this->waitForTick();
     }
 
     // stop the drivetrain
-    drivetrain.leftMotors->move(0);
-    drivetrain.rightMotors->move(0);
+    const MotionEndReason reason =
+        this->exitReason(angularLargeExit.getExit() || angularSmallExit.getExit(), timer.isDone(this->tickTime));
+    this->stopDrivetrain(reason);
     // set distTraveled to -1 to indicate that the function has finished
     distTraveled = -1;
-    this->endMotion();
+    this->endMotion(reason);
+    return this->currentMotion();
 }
\ No newline at end of file
@@ -4,59 +4,742 @@
 // http://thepilons.ca/wp-content/uploads/2018/10/Tracking.pdf
 
 #include <math.h>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+#include "pros/error.h"
+#include "pros/misc.hpp"
 #include "pros/rtos.hpp"
 #include "lemlib/util.hpp"
+#include "lemlib/matchClock.hpp"
+#include "lemlib/staticMemory.hpp"
+#include "lemlib/staticVector.hpp"
+#include "lemlib/scheduler.hpp"
+#include "lemlib/taskConfig.hpp"
+#include "lemlib/logger/logger.hpp"
 #include "lemlib/chassis/odom.hpp"
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/chassis/trackingWheel.hpp"
+#include "lemlib/chassis/particleFilter.hpp"
+#include "lemlib/chassis/sensorLog.hpp"
+#include "lemlib/chassis/flightRecorder.hpp"
 
-// tracking thread
-pros::Task* trackingTask = nullptr;
+// how much measured velocities are trusted over differentiated velocities, from 0 to 1
+constexpr float MEASURED_VELOCITY_WEIGHT = 0.8;
 
-// global variables
-lemlib::OdomSensors odomSensors(nullptr, nullptr, nullptr, nullptr, nullptr); // the sensors to be used for odometry
-lemlib::Drivetrain drive(nullptr, nullptr, 0, 0, 0, 0); // the drivetrain to be used for odometry
-lemlib::Pose odomPose(0, 0, 0); // the pose of the robot
-lemlib::Pose odomSpeed(0, 0, 0); // the speed of the robot
-lemlib::Pose odomLocalSpeed(0, 0, 0); // the local speed of the robot
+// standard deviation of the particles around a pose that was set, in inches
+constexpr float POSE_RESET_SPREAD = 1;
 
-float prevVertical = 0;
-float prevVertical1 = 0;
-float prevVertical2 = 0;
-float prevHorizontal = 0;
-float prevHorizontal1 = 0;
-float prevHorizontal2 = 0;
-float prevImu = 0;
+// the shortest step of a position correction in 1 update that is a jump of the pose, in inches
+constexpr float POSE_JUMP_DISTANCE = 0.5;
 
-void lemlib::setSensors(lemlib::OdomSensors sensors, lemlib::Drivetrain drivetrain) {
-    odomSensors = sensors;
-    drive = drivetrain;
+// inches in a meter, the unit the GPS sensor reports in
+constexpr float INCHES_PER_METER = 39.3701;
+
+// the odometry used by the lemlib::getPose family of functions
+lemlib::Odometry* defaultOdometry = nullptr;
+
+/**
+ * @brief Get the odometry used by the lemlib::getPose family of functions
+ *
+ * @return lemlib::Odometry& the first odometry that was started, or a fallback if none have been started yet
+ */
+static lemlib::Odometry& getDefaultOdometry() {
+    static lemlib::Odometry fallback;
+    if (defaultOdometry == nullptr) return fallback;
+    return *defaultOdometry;
+}
+
+/**
+ * @brief Calculate the change in heading using the horizontal tracking wheels
+ */
+static float horizontalHeadingChange(const lemlib::SensorFrame& delta, float scale) {
+    return -(delta.horizontal1 - delta.horizontal2) * scale;
+}
+
+/**
+ * @brief Calculate the change in heading using the vertical tracking wheels
+ */
+static float verticalHeadingChange(const lemlib::SensorFrame& delta, float scale) {
+    return -(delta.vertical1 - delta.vertical2) * scale;
+}
+
+/**
+ * @brief Calculate the change in heading using the inertial sensor
+ */
+static float imuHeadingChange(const lemlib::SensorFrame& delta, float) { return delta.imu; }
+
+/**
+ * @brief Calculate the change in local pose, assuming the robot moved along an arc
+ *
+ * @tparam T the precision of the math, like lemlib::BasicPose
+ */
+template <typename T>
+static lemlib::BasicPose<T> arcIntegrate(T deltaX, T deltaY, T deltaHeading, lemlib::BasicPose<T>, T horizontalOffset,
+                                         T verticalOffset) {
+    if (deltaHeading == 0) return lemlib::BasicPose<T>(deltaX, deltaY); // prevent divide by 0
+    return lemlib::BasicPose<T>(2 * sin(deltaHeading / 2) * (deltaX / deltaHeading + horizontalOffset),
+                                2 * sin(deltaHeading / 2) * (deltaY / deltaHeading + verticalOffset));
+}
+
+/**
+ * @brief Calculate the change in local pose, assuming the motion of the robot changed at a constant rate
+ *
+ * The speeds and the turn rate of the tracking center change linearly through the update, by the change in its motion
+ * since the last update, so the robot moves along a curve that tightens or loosens instead of an arc. The motion is
+ * integrated with 3 point Gauss-Legendre quadrature, which is exact for a polynomial of degree 5, in the frame of the
+ * heading halfway through the update like the arc
+ *
+ * @tparam T the precision of the math, like lemlib::BasicPose
+ */
+template <typename T>
+static lemlib::BasicPose<T> secondOrderIntegrate(T deltaX, T deltaY, T deltaHeading, lemlib::BasicPose<T> change,
+                                                 T horizontalOffset, T verticalOffset) {
+    // sqrt(3 / 5) / 2, the outer nodes on an update from -1/2 to 1/2
+    constexpr T NODE = 0.387298334620741688;
+    constexpr T NODES[] = {-NODE, 0, NODE};
+    constexpr T WEIGHTS[] = {T(5) / 18, T(8) / 18, T(5) / 18};
+    // the distances the tracking center moved
+    const T sideways = deltaX + horizontalOffset * deltaHeading;
+    const T forward = deltaY + verticalOffset * deltaHeading;
+    T x = 0;
+    T y = 0;
+    for (int i = 0; i < 3; i++) {
+        const T t = NODES[i];
+        const T sidewaysRate = sideways + change.x * t;
+        const T forwardRate = forward + change.y * t;
+        // the heading relative to the heading halfway through the update, the average of the heading at the start
+        // and at the end
+        const T angle = deltaHeading * t + change.theta * (t * t - T(0.25)) / 2;
+        const T cosine = cos(angle);
+        const T sine = sin(angle);
+        x += WEIGHTS[i] * (sidewaysRate * cosine - forwardRate * sine);
+        y += WEIGHTS[i] * (forwardRate * cosine + sidewaysRate * sine);
+    }
+    return lemlib::BasicPose<T>(x, y);
+}
+
+lemlib::Odometry::Odometry()
+    : strategy {arcIntegrate<float>, imuHeadingChange, 0, &SensorFrame::vertical1, &SensorFrame::horizontal1, 0, 0, 0,
+                0} {}
+
+lemlib::Odometry::~Odometry() {
+    if (this->task != nullptr) {
+        this->task->remove();
+        delete this->task;
+    }
+    if (defaultOdometry == this) defaultOdometry = nullptr;
+}
+
+void lemlib::Odometry::publishState(uint64_t time) {
+    const uint32_t sequence = this->sequence.load(std::memory_order_relaxed);
+    // an odd sequence number means the state is being written
+    this->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // each publish adds 2 to the sequence number, so this is the number of the state being published
+    this->published = {this->pose, this->speed, this->localSpeed, time, this->poseJumps, sequence / 2 + 1};
+    this->publishedFrame = this->lastFrame;
+    this->publishedReadings = this->sharedReadings;
+    this->history.push({this->pose, time});
+    this->sequence.store(sequence + 2, std::memory_order_release);
+    // wake the tasks waiting for this update
+    for (std::atomic<pros::task_t>& waiter : this->updateWaiters) {
+        const pros::task_t task = waiter.load();
+        if (task != nullptr) pros::c::task_notify(task);
+    }
+}
+
+bool lemlib::Odometry::waitForUpdate(uint32_t timeout) {
+    return this->waitForUpdateAfter(this->getSequence(), timeout);
+}
+
+uint32_t lemlib::Odometry::getSequence() const {
+    // the sequence number is odd while a state is written, which doesn't count until it is done
+    return this->sequence.load(std::memory_order_acquire) / 2;
+}
+
+bool lemlib::Odometry::waitForUpdateAfter(uint32_t sequence, uint32_t timeout) {
+    // the difference handles the sequence number wrapping around
+    const auto published = [this, sequence] { return int32_t(this->getSequence() - sequence) > 0; };
+    if (published()) return true;
+    // register this task so publishState notifies it
+    const pros::task_t current = pros::c::task_get_current();
+    std::atomic<pros::task_t>* slot = nullptr;
+    for (std::atomic<pros::task_t>& waiter : this->updateWaiters) {
+        pros::task_t expected = nullptr;
+        if (waiter.compare_exchange_strong(expected, current)) {
+            slot = &waiter;
+            break;
+        }
+    }
+    if (slot != nullptr) {
+        // the update may have been published before this task registered
+        if (!published()) pros::Task::notify_take(true, timeout);
+        slot->store(nullptr);
+    } else {
+        // every slot is taken, so poll instead
+        const uint32_t startTime = pros::millis();
+        while (!published() && pros::millis() - startTime < timeout) pros::delay(1);
+    }
+    return published();
+}
+
+template <typename F> auto lemlib::Odometry::readState(F read) {
+    while (true) {
+        const uint32_t before = this->sequence.load(std::memory_order_acquire);
+        const auto value = read();
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint32_t after = this->sequence.load(std::memory_order_relaxed);
+        // read again if the state was written while it was read
+        if (before == after && before % 2 == 0) return value;
+        // if the writer was preempted by a higher priority reader, it needs time to finish writing
+        if (after % 2 != 0) pros::delay(1);
+    }
+}
+
+lemlib::OdomState lemlib::Odometry::getState() {
+    return readState([this] { return this->published; });
+}
+
+lemlib::SensorFrame lemlib::Odometry::getSensorFrame() {
+    return readState([this] { return this->publishedFrame; });
+}
+
+int lemlib::Odometry::addSensor(std::function<float()> read) {
+    // writers are serialized by the write mutex, and the tracking task only reads sensors below the count
+    this->writeMutex.take();
+    const size_t index = this->sharedSensorCount.load();
+    if (index < MAX_SHARED_SENSORS) {
+        this->sharedSensors[index] = std::move(read);
+        this->sharedSensorCount.store(index + 1, std::memory_order_release);
+    }
+    this->writeMutex.give();
+    return index < MAX_SHARED_SENSORS ? int(index) : -1;
+}
+
+lemlib::SensorReading lemlib::Odometry::getSensor(int sensor) {
+    if (sensor < 0 || size_t(sensor) >= MAX_SHARED_SENSORS) return {};
+    return readState([this, sensor] { return this->publishedReadings[sensor]; });
+}
+
+lemlib::Pose lemlib::Odometry::getPoseAt(uint32_t time, bool radians) {
+    const uint64_t target = uint64_t(time) * 1000;
+    Pose pose = readState([this, target] {
+        const size_t size = this->history.size();
+        if (size == 0) return this->published.pose;
+        // binary search for the first pose measured at or after the target time
+        size_t low = 0;
+        size_t high = size;
+        while (low < high) {
+            const size_t mid = (low + high) / 2;
+            if (this->history[mid].time < target) low = mid + 1;
+            else high = mid;
+        }
+        // clamp to the oldest and newest poses
+        if (low == 0) return this->history[0].pose;
+        if (low == size) return this->history.back().pose;
+        // interpolate between the poses before and after the target time
+        const PoseSample& prev = this->history[low - 1];
+        const PoseSample& next = this->history[low];
+        const float t = float(target - prev.time) / float(next.time - prev.time);
+        Pose interpolated = prev.pose.lerp(next.pose, t);
+        interpolated.theta = prev.pose.theta + (next.pose.theta - prev.pose.theta) * t;
+        return interpolated;
+    });
+    if (!radians) pose.theta = radToDeg(pose.theta);
+    return pose;
+}
+
+lemlib::PoseHistory lemlib::Odometry::getHistory() {
+    return readState([this] { return this->history; });
+}
+
+void lemlib::Odometry::setSensorDataRates() {
+    const uint32_t rate = this->timing.period;
+    if (this->sensors.vertical1 != nullptr) this->sensors.vertical1->setDataRate(rate);
+    if (this->sensors.vertical2 != nullptr) this->sensors.vertical2->setDataRate(rate);
+    if (this->sensors.horizontal1 != nullptr) this->sensors.horizontal1->setDataRate(rate);
+    if (this->sensors.horizontal2 != nullptr) this->sensors.horizontal2->setDataRate(rate);
+    if (this->sensors.imu != nullptr) this->sensors.imu->set_data_rate(rate);
+}
+
+void lemlib::Odometry::chooseStrategy() {
+    TrackingWheel* vertical1 = this->sensors.vertical1;
+    TrackingWheel* vertical2 = this->sensors.vertical2;
+    TrackingWheel* horizontal1 = this->sensors.horizontal1;
+    TrackingWheel* horizontal2 = this->sensors.horizontal2;
+    // Chassis::calibrate substitutes missing vertical tracking wheels, so they should never be nullptr
+    if (vertical1 == nullptr || vertical2 == nullptr) return;
+    this->strategy.verticalScale = 1 / (vertical1->getOffset() - vertical2->getOffset());
+    this->strategy.horizontalScale = horizontal1 != nullptr && horizontal2 != nullptr
+                                         ? 1 / (horizontal1->getOffset() - horizontal2->getOffset())
+                                         : 0;
+
+    // choose the heading source
+    // Priority:
+    // 1. Horizontal tracking wheels
+    // 2. Vertical tracking wheels
+    // 3. Inertial Sensor
+    // 4. Drivetrain
+    if (horizontal1 != nullptr && horizontal2 != nullptr) {
+        this->strategy.headingChange = horizontalHeadingChange;
+        this->strategy.headingScale = 1 / (horizontal1->getOffset() - horizontal2->getOffset());
+    } else if (!vertical1->getType() && !vertical2->getType()) {
+        this->strategy.headingChange = verticalHeadingChange;
+        this->strategy.headingScale = 1 / (vertical1->getOffset() - vertical2->getOffset());
+    } else if (this->sensors.imu != nullptr) {
+        this->strategy.headingChange = imuHeadingChange;
+        this->strategy.headingScale = 0;
+    } else {
+        this->strategy.headingChange = verticalHeadingChange;
+        this->strategy.headingScale = 1 / (vertical1->getOffset() - vertical2->getOffset());
+    }
+
+    // choose tracking wheels to use
+    // Prioritize non-powered tracking wheels
+    if (!vertical1->getType() || vertical2->getType()) {
+        this->strategy.vertical = &SensorFrame::vertical1;
+        this->strategy.verticalVelocity = &SensorFrame::vertical1Velocity;
+        this->strategy.verticalOffset = vertical1->getOffset();
+    } else {
+        this->strategy.vertical = &SensorFrame::vertical2;
+        this->strategy.verticalVelocity = &SensorFrame::vertical2Velocity;
+        this->strategy.verticalOffset = vertical2->getOffset();
+    }
+    // missing horizontal tracking wheels always read 0
+    if (horizontal1 == nullptr && horizontal2 != nullptr) {
+        this->strategy.horizontal = &SensorFrame::horizontal2;
+        this->strategy.horizontalVelocity = &SensorFrame::horizontal2Velocity;
+        this->strategy.horizontalOffset = horizontal2->getOffset();
+    } else {
+        this->strategy.horizontal = &SensorFrame::horizontal1;
+        this->strategy.horizontalVelocity = &SensorFrame::horizontal1Velocity;
+        this->strategy.horizontalOffset = horizontal1 == nullptr ? 0 : horizontal1->getOffset();
+    }
+}
+
+void lemlib::Odometry::setSensors(OdomSensors sensors) {
+    this->sensors = sensors;
+    this->chooseStrategy();
+    this->setSensorDataRates();
+}
+
+void lemlib::Odometry::addImu(pros::Imu* imu) { this->pendingImu = imu; }
+
+void lemlib::Odometry::switchInImu() {
+    pros::Imu* imu = this->pendingImu.exchange(nullptr);
+    if (imu == nullptr) return;
+    this->writeMutex.take();
+    this->sensors.imu = imu;
+    this->chooseStrategy();
+    imu->set_data_rate(this->timing.period);
+    // the change in heading is measured from the reading now, so the heading continues from the current pose
+    this->prevFrame.imu = degToRad(imu->get_rotation()) * this->imuScale;
+    this->imuHeading = this->pose.theta;
+    this->writeMutex.give();
 }
 
-lemlib::Pose lemlib::getPose(bool radians) {
-    if (radians) return odomPose;
-    else return lemlib::Pose(odomPose.x, odomPose.y, radToDeg(odomPose.theta));
+void lemlib::Odometry::setFallbackWheels(TrackingWheel* left, TrackingWheel* right) {
+    this->leftFallback = left;
+    this->rightFallback = right;
+    if (left != nullptr) this->prevLeftFallback = left->getDistanceTraveled();
+    if (right != nullptr) this->prevRightFallback = right->getDistanceTraveled();
 }
 
-void lemlib::setPose(lemlib::Pose pose, bool radians) {
-    if (radians) odomPose = pose;
-    else odomPose = lemlib::Pose(pose.x, pose.y, degToRad(pose.theta));
+void lemlib::Odometry::setHealthSettings(OdomHealthSettings settings) { this->healthSettings = settings; }
+
+lemlib::OdomFaults lemlib::Odometry::getFaults() { return this->faults; }
+
+void lemlib::Odometry::setIdleSettings(OdomIdleSettings settings) {
+    settings.period = std::max(settings.period, MIN_UPDATE_PERIOD);
+    this->idleSettings = settings;
+    if (!settings.enabled) this->wake();
+}
+
+void lemlib::Odometry::wake() {
+    if (!this->idle) return;
+    this->wakeRequested = true;
+    if (this->task != nullptr) this->task->notify();
+}
+
+bool lemlib::Odometry::isIdle() const { return this->idle; }
+
+uint32_t lemlib::Odometry::currentPeriod() const {
+    return this->idle ? std::max(this->idleSettings.period, this->timing.period) : this->timing.period;
 }
 
-lemlib::Pose lemlib::getSpeed(bool radians) {
-    if (radians) return odomSpeed;
-    else return lemlib::Pose(odomSpeed.x, odomSpeed.y, radToDeg(odomSpeed.theta));
+void lemlib::Odometry::updateIdle() {
+    const uint32_t now = pros::millis();
+    const bool moving = std::hypot(this->speed.x, this->speed.y) > this->idleSettings.maxSpeed ||
+                        std::abs(this->speed.theta) > this->idleSettings.maxTurnRate;
+    const bool disabled = (pros::competition::get_status() & COMPETITION_DISABLED) != 0;
+    const bool allowed = this->idleSettings.enabled && (disabled || !this->idleSettings.onlyWhenDisabled);
+    bool idle = this->idle;
+    if (this->wakeRequested.exchange(false) || moving || !allowed) {
+        this->activeTime = now;
+        idle = false;
+    } else if (now - this->activeTime >= this->idleSettings.delay) {
+        idle = true;
+    }
+    if (idle == this->idle) return;
+    this->idle = idle;
+    if (this->schedulerJob >= 0) this->scheduler->setPeriod(this->schedulerJob, this->currentPeriod());
 }
 
-lemlib::Pose lemlib::getLocalSpeed(bool radians) {
-    if (radians) return odomLocalSpeed;
-    else return lemlib::Pose(odomLocalSpeed.x, odomLocalSpeed.y, radToDeg(odomLocalSpeed.theta));
+void lemlib::Odometry::setWatchdogSettings(OdomWatchdogSettings settings) {
+    settings.maxSteps = std::max(settings.maxSteps, uint32_t(1));
+    this->watchdogSettings = settings;
 }
 
-lemlib::Pose lemlib::estimatePose(float time, bool radians) {
-    // get current position and speed
-    Pose curPose = getPose(true);
-    Pose localSpeed = getLocalSpeed(true);
+void lemlib::Odometry::checkSensors(SensorFrame& frame) {
+    const OdomHealthSettings& settings = this->healthSettings;
+    if (!settings.enabled) return;
+    // the thresholds are for the time since the last update, and never less than the period, so jitter doesn't fail a
+    // sensor that is working
+    const uint64_t minElapsed = uint64_t(this->timing.period) * 1000;
+    const uint64_t elapsed = this->prevFrame.time == 0 ? minElapsed : std::max(frame.time - this->prevFrame.time,
+                                                                                minElapsed);
+    const float dt = elapsed / 1000000.0f;
+
+    // how far the drive motors moved, to tell a stuck tracking wheel apart from a robot that isn't moving
+    const bool haveDrive = this->leftFallback != nullptr && this->rightFallback != nullptr &&
+                           this->leftFallback->getOffset() != this->rightFallback->getOffset();
+    float leftDelta = 0;
+    float rightDelta = 0;
+    if (haveDrive) {
+        const float left = this->leftFallback->getDistanceTraveled();
+        const float right = this->rightFallback->getDistanceTraveled();
+        if (std::isfinite(left) && std::isfinite(right)) {
+            leftDelta = left - this->prevLeftFallback;
+            rightDelta = right - this->prevRightFallback;
+            this->prevLeftFallback = left;
+            this->prevRightFallback = right;
+        }
+    }
+
+    TrackingWheel** wheels[] = {&this->sensors.vertical1, &this->sensors.vertical2, &this->sensors.horizontal1,
+                                &this->sensors.horizontal2};
+    float SensorFrame::*const readings[] = {&SensorFrame::vertical1, &SensorFrame::vertical2,
+                                            &SensorFrame::horizontal1, &SensorFrame::horizontal2};
+    float SensorFrame::*const velocities[] = {&SensorFrame::vertical1Velocity, &SensorFrame::vertical2Velocity,
+                                              &SensorFrame::horizontal1Velocity, &SensorFrame::horizontal2Velocity};
+    uint64_t SensorFrame::*const times[] = {&SensorFrame::vertical1Time, &SensorFrame::vertical2Time,
+                                            &SensorFrame::horizontal1Time, &SensorFrame::horizontal2Time};
+    bool OdomFaults::*const faults[] = {&OdomFaults::vertical1, &OdomFaults::vertical2, &OdomFaults::horizontal1,
+                                        &OdomFaults::horizontal2};
+    const char* names[] = {"vertical tracking wheel 1", "vertical tracking wheel 2", "horizontal tracking wheel 1",
+                           "horizontal tracking wheel 2"};
+    bool changed = false;
+    for (int i = 0; i < 4; i++) {
+        TrackingWheel*& wheel = *wheels[i];
+        if (wheel == nullptr) continue;
+        const float reading = frame.*readings[i];
+        const float step = reading - this->prevFrame.*readings[i];
+        bool failed = !std::isfinite(reading) || std::fabs(step) > settings.maxWheelSpeed * dt;
+        // a vertical tracking wheel moves like the drive motors at its offset would
+        if (i < 2 && haveDrive && !wheel->getType()) {
+            const float leftOffset = this->leftFallback->getOffset();
+            const float rightOffset = this->rightFallback->getOffset();
+            const float expected =
+                leftDelta + (wheel->getOffset() - leftOffset) * (rightDelta - leftDelta) / (rightOffset - leftOffset);
+            if (step != 0) this->staleMotion[i] = 0;
+            else this->staleMotion[i] += expected;
+            if (std::fabs(this->staleMotion[i]) > settings.staleDistance) failed = true;
+        }
+        if (!failed) continue;
+
+        // a vertical tracking wheel is replaced by the drive motors on its side, unless they are already used
+        TrackingWheel* replacement = nullptr;
+        if (i < 2) {
+            TrackingWheel* other = i == 0 ? this->sensors.vertical2 : this->sensors.vertical1;
+            replacement = wheel->getOffset() < 0 ? this->leftFallback : this->rightFallback;
+            if (replacement == other) replacement = replacement == this->leftFallback ? this->rightFallback
+                                                                                      : this->leftFallback;
+            if (replacement == wheel || replacement == other) replacement = nullptr;
+        }
+        if (i < 2 && replacement == nullptr) {
+            // nothing can replace it, so skip this reading and check it again next update
+            if (!(this->faults.*faults[i])) infoSink()->warn("Odometry: {} failed, and can't be replaced", names[i]);
+            this->faults.*faults[i] = true;
+            frame.*readings[i] = this->prevFrame.*readings[i];
+            frame.*velocities[i] = NAN;
+            frame.*times[i] = 0;
+            continue;
+        }
+        this->faults.*faults[i] = true;
+        infoSink()->warn("Odometry: {} failed, {}", names[i],
+                         replacement == nullptr                ? "continuing without it"
+                         : replacement == this->leftFallback ? "switching to the left drive motors"
+                                                               : "switching to the right drive motors");
+        wheel = replacement;
+        // the replacement continues from here. If the wheel was stuck, the motion it missed is added back this update
+        frame.*readings[i] = replacement == nullptr ? 0 : replacement->getDistanceTraveled();
+        this->prevFrame.*readings[i] = frame.*readings[i] - (i < 2 ? this->staleMotion[i] : 0);
+        if (i < 2) this->staleMotion[i] = 0;
+        frame.*velocities[i] = NAN;
+        frame.*times[i] = 0;
+        changed = true;
+    }
+
+    if (this->sensors.imu != nullptr) {
+        const float step = frame.imu - this->prevFrame.imu;
+        if (!std::isfinite(frame.imu) || std::fabs(step) > settings.maxTurnRate * dt) {
+            this->faults.imu = true;
+            infoSink()->warn("Odometry: inertial sensor failed, continuing without it");
+            this->sensors.imu = nullptr;
+            frame.imu = this->prevFrame.imu;
+            frame.imuVelocity = NAN;
+            frame.imuTime = 0;
+            changed = true;
+        }
+    }
+    // the heading source and tracking wheels are chosen again from the sensors that are left
+    if (changed) this->chooseStrategy();
+}
+
+void lemlib::Odometry::resetEKF() {
+    this->ekf.reset(this->pose);
+    this->horizontalHeading = this->pose.theta;
+    this->verticalHeading = this->pose.theta;
+    this->imuHeading = this->pose.theta;
+}
+
+void lemlib::Odometry::setEKF(bool enabled, EKFSettings settings) {
+    this->writeMutex.take();
+    this->ekfEnabled = enabled;
+    this->ekf = ExtendedKalmanFilter(settings);
+    this->resetEKF();
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::fuseHeadings(Pose prevPose, const SensorFrame& delta) {
+    const EKFSettings settings = this->ekf.getSettings();
+    this->ekf.predict(prevPose, this->pose);
+    // every heading source except the one the pose was integrated with corrects the heading
+    if (this->strategy.horizontalScale != 0) {
+        this->horizontalHeading += horizontalHeadingChange(delta, this->strategy.horizontalScale);
+        if (this->strategy.headingChange != horizontalHeadingChange)
+            this->ekf.correctHeading(this->horizontalHeading, settings.horizontalVariance);
+    }
+    if (this->sensors.vertical1 != nullptr && this->sensors.vertical2 != nullptr) {
+        this->verticalHeading += verticalHeadingChange(delta, this->strategy.verticalScale);
+        // motor encoders slip, so they are trusted less than tracking wheels
+        const bool substituted = this->sensors.vertical1->getType() || this->sensors.vertical2->getType();
+        if (this->strategy.headingChange != verticalHeadingChange)
+            this->ekf.correctHeading(this->verticalHeading,
+                                     substituted ? settings.driveVariance : settings.verticalVariance);
+    }
+    if (this->sensors.imu != nullptr) {
+        this->imuHeading += imuHeadingChange(delta, 0);
+        if (this->strategy.headingChange != imuHeadingChange)
+            this->ekf.correctHeading(this->imuHeading, settings.imuVariance);
+    }
+    this->pose = this->ekf.getPose();
+}
+
+void lemlib::Odometry::setIntegrator(OdomIntegrator integrator) {
+    this->writeMutex.take();
+    if (integrator == OdomIntegrator::SECOND_ORDER) this->strategy.integrate = secondOrderIntegrate<float>;
+    else this->strategy.integrate = arcIntegrate<float>;
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::setVelocitySource(OdomVelocitySource source) { this->velocitySource = source; }
+
+void lemlib::Odometry::setImuScale(float scale) { this->imuScale = scale; }
+
+float lemlib::Odometry::getImuScale() const { return this->imuScale; }
+
+void lemlib::Odometry::fuseVelocities(const SensorFrame& frame, float deltaHeading) {
+    // the gyro measures angular velocity directly
+    float angular = this->localSpeed.theta;
+    if (!std::isnan(frame.imuVelocity))
+        angular = MEASURED_VELOCITY_WEIGHT * frame.imuVelocity + (1 - MEASURED_VELOCITY_WEIGHT) * angular;
+    // the velocity of the tracking center is the velocity of the tracking wheel plus the velocity from rotating
+    const float measuredY = frame.*this->strategy.verticalVelocity + this->strategy.verticalOffset * angular;
+    const float measuredX = frame.*this->strategy.horizontalVelocity + this->strategy.horizontalOffset * angular;
+    // tracking wheels that don't measure velocity keep the differentiated velocity
+    if (!std::isnan(measuredY))
+        this->localSpeed.y = MEASURED_VELOCITY_WEIGHT * measuredY + (1 - MEASURED_VELOCITY_WEIGHT) * this->localSpeed.y;
+    if (!std::isnan(measuredX))
+        this->localSpeed.x = MEASURED_VELOCITY_WEIGHT * measuredX + (1 - MEASURED_VELOCITY_WEIGHT) * this->localSpeed.x;
+    this->localSpeed.theta = angular;
+
+    // the global speed is the local speed rotated by the heading
+    const float heading = this->pose.theta - deltaHeading / 2;
+    this->speed.x = this->localSpeed.y * sin(heading) - this->localSpeed.x * cos(heading);
+    this->speed.y = this->localSpeed.y * cos(heading) + this->localSpeed.x * sin(heading);
+    this->speed.theta = angular;
+}
+
+void lemlib::Odometry::setGpsSettings(GpsSettings settings) {
+    this->writeMutex.take();
+    this->gpsSettings = settings;
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::setHeadingAnchor(HeadingAnchorSettings settings) {
+    this->writeMutex.take();
+    this->anchorSettings = settings;
+    this->imuHeading = this->pose.theta;
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::anchorHeading(float imuChange, float dt) {
+    if (this->sensors.imu == nullptr) return;
+    this->imuHeading += imuChange;
+    // the heading already comes from the inertial sensor
+    if (this->strategy.headingChange == imuHeadingChange) {
+        this->imuHeading = this->pose.theta;
+        return;
+    }
+    const float difference = this->imuHeading - this->pose.theta;
+    if (std::fabs(difference) > degToRad(this->anchorSettings.maxDisagreement)) {
+        infoSink()->warn("Heading disagrees with the inertial sensor by {} degrees, anchoring it again",
+                         radToDeg(difference));
+        this->imuHeading = this->pose.theta;
+        return;
+    }
+    // a fixed part of the difference each second, so the correction doesn't depend on the update rate
+    const float limit = degToRad(this->anchorSettings.maxCorrection) * dt;
+    this->pose.theta += std::clamp(difference * std::fmin(this->anchorSettings.rate * dt, 1.0f), -limit, limit);
+}
+
+void lemlib::Odometry::sampleGps() {
+    if (this->sensors.gps == nullptr) return;
+    const pros::c::gps_status_s_t status = this->sensors.gps->get_status();
+    const double error = this->sensors.gps->get_error();
+    if (status.x == PROS_ERR_F || error == PROS_ERR_F) return;
+    const float x = status.x * INCHES_PER_METER;
+    const float y = status.y * INCHES_PER_METER;
+    // the GPS reports at its own rate, so most updates read the same reading again. Merging it more than once would
+    // count it more than once
+    if (x == this->gpsX && y == this->gpsY) return;
+    this->gpsX = x;
+    this->gpsY = y;
+    this->gpsError = error * INCHES_PER_METER;
+    this->gpsFresh = true;
+}
+
+void lemlib::Odometry::fuseGps() {
+    this->gpsFresh = false;
+    const GpsSettings& settings = this->gpsSettings;
+    if (this->gpsError > settings.maxError) return;
+    const float innovationX = this->gpsX - this->pose.x;
+    const float innovationY = this->gpsY - this->pose.y;
+    if (std::hypot(innovationX, innovationY) > settings.maxInnovation) return;
+    if (this->ekfEnabled) {
+        const float error = std::max(this->gpsError, settings.minError);
+        this->ekf.correctPosition(this->gpsX, this->gpsY, error * error);
+        this->pose = this->ekf.getPose();
+    } else {
+        this->pose.x += settings.gain * innovationX;
+        this->pose.y += settings.gain * innovationY;
+    }
+}
+
+void lemlib::Odometry::setParticleFilter(ParticleFilter* filter) {
+    this->writeMutex.take();
+    this->filter = filter;
+    if (filter != nullptr) filter->reset(this->pose, POSE_RESET_SPREAD);
+    this->writeMutex.give();
+}
+
+lemlib::Pose lemlib::Odometry::getPose(bool radians) {
+    const Pose pose = this->getState().pose;
+    if (radians) return pose;
+    else return Pose(pose.x, pose.y, radToDeg(pose.theta));
+}
+
+void lemlib::Odometry::setPose(Pose pose, bool radians) {
+    this->writeMutex.take();
+    if (radians) this->pose = pose;
+    else this->pose = Pose(pose.x, pose.y, degToRad(pose.theta));
+    this->accumulatedX = this->pose.x;
+    this->accumulatedY = this->pose.y;
+    this->accumulatedTheta = this->pose.theta;
+    this->correctionUpdates = 0;
+    this->poseJumps++;
+    this->imuHeading = this->pose.theta;
+    if (this->filter != nullptr) this->filter->reset(this->pose, POSE_RESET_SPREAD);
+    if (this->ekfEnabled) this->resetEKF();
+    if (this->sensorLog != nullptr)
+        this->sensorLog->record({SensorRecordType::POSE, {}, this->pose.x, this->pose.y, this->pose.theta});
+    this->publishState(pros::micros());
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::correctPosition(float x, float y, uint32_t blendTime) {
+    this->writeMutex.take();
+    this->correctionX = x;
+    this->correctionY = y;
+    this->correctionUpdates = std::max(blendTime / this->timing.period, uint32_t(1));
+    this->writeMutex.give();
+}
+
+lemlib::Pose lemlib::Odometry::getSpeed(bool radians) {
+    const Pose speed = this->getState().speed;
+    if (radians) return speed;
+    else return Pose(speed.x, speed.y, radToDeg(speed.theta));
+}
+
+lemlib::Pose lemlib::Odometry::getLocalSpeed(bool radians) {
+    const Pose localSpeed = this->getState().localSpeed;
+    if (radians) return localSpeed;
+    else return Pose(localSpeed.x, localSpeed.y, radToDeg(localSpeed.theta));
+}
+
+void lemlib::Odometry::setUpdatePeriod(uint32_t period) {
+    if (period < MIN_UPDATE_PERIOD) {
+        infoSink()->warn("Odometry update period of {} ms is too low, using {} ms", period, MIN_UPDATE_PERIOD);
+        period = MIN_UPDATE_PERIOD;
+    }
+    this->timing.period = period;
+    if (this->schedulerJob >= 0) this->scheduler->setPeriod(this->schedulerJob, this->currentPeriod());
+    this->setSensorDataRates();
+}
+
+lemlib::OdomTiming lemlib::Odometry::getTiming() { return this->timing; }
+
+lemlib::LoopProfiler& lemlib::Odometry::getProfiler() { return this->profiler; }
+
+lemlib::ReadStats lemlib::Odometry::getImuReadStats() { return this->imuReads.getStats(); }
+
+void lemlib::Odometry::reportSensorReads() {
+    // 4 tracking wheels and an IMU
+    StaticVector<std::pair<const char*, ReadStats>, 5> sensors;
+    if (this->sensors.vertical1 != nullptr) sensors.push({"vertical1", this->sensors.vertical1->getReadStats()});
+    if (this->sensors.vertical2 != nullptr) sensors.push({"vertical2", this->sensors.vertical2->getReadStats()});
+    if (this->sensors.horizontal1 != nullptr)
+        sensors.push({"horizontal1", this->sensors.horizontal1->getReadStats()});
+    if (this->sensors.horizontal2 != nullptr)
+        sensors.push({"horizontal2", this->sensors.horizontal2->getReadStats()});
+    if (this->sensors.imu != nullptr) sensors.push({"imu", this->imuReads.getStats()});
+    // the sensors that take the most time are reported first
+    std::sort(sensors.begin(), sensors.end(),
+              [](const auto& a, const auto& b) { return a.second.average > b.second.average; });
+    const float period = this->timing.period * 1000.0f;
+    for (const auto& [name, stats] : sensors) {
+        telemetrySink()->info("sensor,{},{},{:.1f},{},{},{:.1f},{:.1f}", name, stats.reads, stats.average, stats.max,
+                              stats.unchanged, stats.updateInterval, stats.average / period * 100);
+    }
+}
+
+void lemlib::Odometry::resetSensorReads() {
+    if (this->sensors.vertical1 != nullptr) this->sensors.vertical1->resetReadStats();
+    if (this->sensors.vertical2 != nullptr) this->sensors.vertical2->resetReadStats();
+    if (this->sensors.horizontal1 != nullptr) this->sensors.horizontal1->resetReadStats();
+    if (this->sensors.horizontal2 != nullptr) this->sensors.horizontal2->resetReadStats();
+    this->imuReads.reset();
+}
+
+lemlib::Pose lemlib::Odometry::estimatePose(float time, bool radians) {
+    // get current position and speed from the same update
+    const OdomState state = this->getState();
+    Pose curPose = state.pose;
+    Pose localSpeed = state.localSpeed;
     // calculate the change in local position
     Pose deltaLocalPose = localSpeed * time;
 
@@ -72,123 +755,383 @@ lemlib::Pose lemlib::estimatePose(float time, bool radians) {
     return futurePose;
 }
 
-void lemlib::update() {
-    // TODO: add particle filter
-    // get the current sensor values
-    float vertical1Raw = 0;
-    float vertical2Raw = 0;
-    float horizontal1Raw = 0;
-    float horizontal2Raw = 0;
-    float imuRaw = 0;
-    if (odomSensors.vertical1 != nullptr) vertical1Raw = odomSensors.vertical1->getDistanceTraveled();
-    if (odomSensors.vertical2 != nullptr) vertical2Raw = odomSensors.vertical2->getDistanceTraveled();
-    if (odomSensors.horizontal1 != nullptr) horizontal1Raw = odomSensors.horizontal1->getDistanceTraveled();
-    if (odomSensors.horizontal2 != nullptr) horizontal2Raw = odomSensors.horizontal2->getDistanceTraveled();
-    if (odomSensors.imu != nullptr) imuRaw = degToRad(odomSensors.imu->get_rotation());
+lemlib::SensorFrame lemlib::Odometry::sampleSensors() {
+    SensorFrame frame {0, 0, 0, 0, 0, 0};
+    // tag each reading with the time it was read, so they can be aligned to a common time
+    if (this->sensors.vertical1 != nullptr) {
+        frame.vertical1Time = pros::micros();
+        frame.vertical1 = this->sensors.vertical1->getDistanceTraveled();
+    }
+    if (this->sensors.vertical2 != nullptr) {
+        frame.vertical2Time = pros::micros();
+        frame.vertical2 = this->sensors.vertical2->getDistanceTraveled();
+    }
+    if (this->sensors.horizontal1 != nullptr) {
+        frame.horizontal1Time = pros::micros();
+        frame.horizontal1 = this->sensors.horizontal1->getDistanceTraveled();
+    }
+    if (this->sensors.horizontal2 != nullptr) {
+        frame.horizontal2Time = pros::micros();
+        frame.horizontal2 = this->sensors.horizontal2->getDistanceTraveled();
+    }
+    if (this->sensors.imu != nullptr) {
+        frame.imuTime = pros::micros();
+        const double rotation = this->sensors.imu->get_rotation();
+        this->imuReads.record(frame.imuTime, pros::micros(), rotation);
+        frame.imu = degToRad(rotation) * this->imuScale;
+    }
+    // velocities are only read when they are used
+    if (this->velocitySource == OdomVelocitySource::HARDWARE) {
+        if (this->sensors.vertical1 != nullptr) frame.vertical1Velocity = this->sensors.vertical1->getVelocity();
+        if (this->sensors.vertical2 != nullptr) frame.vertical2Velocity = this->sensors.vertical2->getVelocity();
+        if (this->sensors.horizontal1 != nullptr)
+            frame.horizontal1Velocity = this->sensors.horizontal1->getVelocity();
+        if (this->sensors.horizontal2 != nullptr)
+            frame.horizontal2Velocity = this->sensors.horizontal2->getVelocity();
+        // the gyro z axis is counterclockwise positive, but heading is clockwise positive
+        if (this->sensors.imu != nullptr)
+            frame.imuVelocity = -degToRad(this->sensors.imu->get_gyro_rate().z) * this->imuScale;
+    }
+    // the readings are aligned to the time the last sensor was read
+    frame.time = pros::micros();
+    return frame;
+}
+
+/**
+ * @brief Extrapolate a reading to the time of its frame
+ *
+ * @param reading the reading
+ * @param readingTime when the reading was taken, in microseconds. 0 if it was taken at the time of the frame
+ * @param velocity the measured rate of change of the reading per second, NAN if it isn't measured
+ * @param prevReading the reading at the time of the previous frame
+ * @param prevTime the time of the previous frame, in microseconds. 0 if there is no previous frame
+ * @param time the time of the frame, in microseconds
+ * @return float the reading at the time of the frame
+ */
+static float extrapolate(float reading, uint64_t readingTime, float velocity, float prevReading, uint64_t prevTime,
+                         uint64_t time) {
+    if (readingTime == 0 || readingTime >= time) return reading;
+    // use the measured rate if there is one, otherwise the rate since the previous frame
+    if (std::isnan(velocity)) {
+        if (prevTime == 0 || readingTime <= prevTime) return reading;
+        velocity = (reading - prevReading) / ((readingTime - prevTime) / 1000000.0f);
+    }
+    return reading + velocity * ((time - readingTime) / 1000000.0f);
+}
+
+lemlib::SensorFrame lemlib::Odometry::alignFrame(const SensorFrame& frame) {
+    const SensorFrame& prev = this->prevFrame;
+    SensorFrame aligned = frame;
+    aligned.vertical1 = extrapolate(frame.vertical1, frame.vertical1Time, frame.vertical1Velocity, prev.vertical1,
+                                    prev.time, frame.time);
+    aligned.vertical2 = extrapolate(frame.vertical2, frame.vertical2Time, frame.vertical2Velocity, prev.vertical2,
+                                    prev.time, frame.time);
+    aligned.horizontal1 = extrapolate(frame.horizontal1, frame.horizontal1Time, frame.horizontal1Velocity,
+                                      prev.horizontal1, prev.time, frame.time);
+    aligned.horizontal2 = extrapolate(frame.horizontal2, frame.horizontal2Time, frame.horizontal2Velocity,
+                                      prev.horizontal2, prev.time, frame.time);
+    aligned.imu = extrapolate(frame.imu, frame.imuTime, frame.imuVelocity, prev.imu, prev.time, frame.time);
+    aligned.vertical1Time = 0;
+    aligned.vertical2Time = 0;
+    aligned.horizontal1Time = 0;
+    aligned.horizontal2Time = 0;
+    aligned.imuTime = 0;
+    return aligned;
+}
+
+void lemlib::Odometry::update() {
+    // the sensor has to be switched in before it is sampled, or the first change in heading would be its whole reading
+    this->switchInImu();
+    // the GPS is read here rather than in sampleSensors, so replaying a sensor log doesn't read the live sensor
+    this->sampleGps();
+    SensorFrame frame = this->sampleSensors();
+    // the shared sensors are read with the odometry sensors, so their readings are from the same moment
+    const size_t sharedCount = this->sharedSensorCount.load(std::memory_order_acquire);
+    for (size_t i = 0; i < sharedCount; i++) {
+        const float value = this->sharedSensors[i]();
+        this->sharedReadings[i] = {value, pros::micros()};
+    }
+    // only live readings are checked. A sensor log records the readings after they were fixed
+    this->checkSensors(frame);
+    this->update(frame);
+}
+
+void lemlib::Odometry::update(const SensorFrame& rawFrame) {
+    // prevent setPose from changing the pose in the middle of the update
+    this->writeMutex.take();
+    if (this->sensorLog != nullptr) this->sensorLog->record({SensorRecordType::FRAME, rawFrame});
+    FlightRecorder* recorder = this->flightRecorder.load(std::memory_order_relaxed);
+    if (recorder != nullptr) recorder->recordFrame(rawFrame);
+    this->lastFrame = rawFrame;
+    // the sensors were read at slightly different times, so align them before they are integrated
+    const SensorFrame frame = this->alignFrame(rawFrame);
+    // measure the time since the last update, so jitter in the tracking loop doesn't affect the speed
+    const uint64_t now = frame.time;
+    // the period the update was due at, so idle updates aren't counted as jitter or stalls
+    const uint32_t periodMicros = this->currentPeriod() * 1000;
+    const uint32_t dtMicros = this->prevUpdateTime == 0 ? periodMicros : now - this->prevUpdateTime;
+    this->prevUpdateTime = now;
+    // a stalled update is integrated in steps of about 1 period, so the whole gap isn't integrated along 1 heading
+    uint32_t steps = 1;
+    if (this->watchdogSettings.enabled && dtMicros > periodMicros * this->watchdogSettings.stallPeriods) {
+        steps = std::min((dtMicros + periodMicros / 2) / periodMicros, this->watchdogSettings.maxSteps);
+        this->timing.stalls++;
+        this->timing.longestStall = std::max(this->timing.longestStall, dtMicros);
+    }
+    const float dt = dtMicros / 1000000.0f;
+    this->timing.updates++;
+    this->timing.lastDt = dtMicros;
+    const uint32_t jitter = dtMicros > periodMicros ? dtMicros - periodMicros : periodMicros - dtMicros;
+    if (jitter > this->timing.maxJitter) this->timing.maxJitter = jitter;
 
     // calculate the change in sensor values
-    float deltaVertical1 = vertical1Raw - prevVertical1;
-    float deltaVertical2 = vertical2Raw - prevVertical2;
-    float deltaHorizontal1 = horizontal1Raw - prevHorizontal1;
-    float deltaHorizontal2 = horizontal2Raw - prevHorizontal2;
-    float deltaImu = imuRaw - prevImu;
-
-    // update the previous sensor values
-    prevVertical1 = vertical1Raw;
-    prevVertical2 = vertical2Raw;
-    prevHorizontal1 = horizontal1Raw;
-    prevHorizontal2 = horizontal2Raw;
-    prevImu = imuRaw;
-
-    // calculate the heading of the robot
-    // Priority:
-    // 1. Horizontal tracking wheels
-    // 2. Vertical tracking wheels
-    // 3. Inertial Sensor
-    // 4. Drivetrain
-    float heading = odomPose.theta;
-    // calculate the heading using the horizontal tracking wheels
-    if (odomSensors.horizontal1 != nullptr && odomSensors.horizontal2 != nullptr)
-        heading -= (deltaHorizontal1 - deltaHorizontal2) /
-                   (odomSensors.horizontal1->getOffset() - odomSensors.horizontal2->getOffset());
-    // else, if both vertical tracking wheels aren't substituted by the drivetrain, use the vertical tracking wheels
-    else if (!odomSensors.vertical1->getType() && !odomSensors.vertical2->getType())
-        heading -= (deltaVertical1 - deltaVertical2) /
-                   (odomSensors.vertical1->getOffset() - odomSensors.vertical2->getOffset());
-    // else, if the inertial sensor exists, use it
-    else if (odomSensors.imu != nullptr) heading += deltaImu;
-    // else, use the the substituted tracking wheels
-    else
-        heading -= (deltaVertical1 - deltaVertical2) /
-                   (odomSensors.vertical1->getOffset() - odomSensors.vertical2->getOffset());
-    float deltaHeading = heading - odomPose.theta;
-    float avgHeading = odomPose.theta + deltaHeading / 2;
+    const SensorFrame delta {frame.vertical1 - this->prevFrame.vertical1,
+                             frame.vertical2 - this->prevFrame.vertical2,
+                             frame.horizontal1 - this->prevFrame.horizontal1,
+                             frame.horizontal2 - this->prevFrame.horizontal2,
+                             frame.imu - this->prevFrame.imu,
+                             dtMicros};
+    this->prevFrame = frame;
+
+    // calculate the change in heading of the robot, using the sensors chosen in setSensors
+    const float deltaHeading = this->strategy.headingChange(delta, this->strategy.headingScale);
+
+    // calculate change in x and y, using the tracking wheels chosen in setSensors
+    const float deltaX = delta.*this->strategy.horizontal;
+    const float deltaY = delta.*this->strategy.vertical;
+    const float horizontalOffset = this->strategy.horizontalOffset;
+    const float verticalOffset = this->strategy.verticalOffset;
+
+    // save previous pose
+    Pose prevPose = this->pose;
+
+    // the motion of the tracking center in each step, and how much it changed since the last update. The change is
+    // measured from the middle of the last update to the middle of this one, and scaled to the length of this one. A
+    // stall is integrated as if the robot moved evenly through it, so it has no change
+    const float stepHeading = deltaHeading / steps;
+    const uint32_t stepMicros = dtMicros / steps;
+    const Pose twist((deltaX + horizontalOffset * deltaHeading) / steps,
+                     (deltaY + verticalOffset * deltaHeading) / steps, stepHeading);
+    Pose twistChange(0, 0, 0);
+    if (steps == 1 && this->prevTwistTime != 0 && stepMicros != 0) {
+        const float ratio = float(stepMicros) / this->prevTwistTime;
+        const float scale = 2 * float(stepMicros) / (stepMicros + this->prevTwistTime);
+        twistChange = Pose((twist.x - this->prevTwist.x * ratio) * scale, (twist.y - this->prevTwist.y * ratio) * scale,
+                           (twist.theta - this->prevTwist.theta * ratio) * scale);
+    }
+    this->prevTwist = twist;
+    this->prevTwistTime = stepMicros;
 
-    // choose tracking wheels to use
-    // Prioritize non-powered tracking wheels
-    lemlib::TrackingWheel* verticalWheel = nullptr;
-    lemlib::TrackingWheel* horizontalWheel = nullptr;
-    if (!odomSensors.vertical1->getType()) verticalWheel = odomSensors.vertical1;
-    else if (!odomSensors.vertical2->getType()) verticalWheel = odomSensors.vertical2;
-    else verticalWheel = odomSensors.vertical1;
-    if (odomSensors.horizontal1 != nullptr) horizontalWheel = odomSensors.horizontal1;
-    else if (odomSensors.horizontal2 != nullptr) horizontalWheel = odomSensors.horizontal2;
-    float rawVertical = 0;
-    float rawHorizontal = 0;
-    if (verticalWheel != nullptr) rawVertical = verticalWheel->getDistanceTraveled();
-    if (horizontalWheel != nullptr) rawHorizontal = horizontalWheel->getDistanceTraveled();
-    float horizontalOffset = 0;
-    float verticalOffset = 0;
-    if (verticalWheel != nullptr) verticalOffset = verticalWheel->getOffset();
-    if (horizontalWheel != nullptr) horizontalOffset = horizontalWheel->getOffset();
-
-    // calculate change in x and y
-    float deltaX = 0;
-    float deltaY = 0;
-    if (verticalWheel != nullptr) deltaY = rawVertical - prevVertical;
-    if (horizontalWheel != nullptr) deltaX = rawHorizontal - prevHorizontal;
-    prevVertical = rawVertical;
-    prevHorizontal = rawHorizontal;
-
-    // calculate local x and y
     float localX = 0;
     float localY = 0;
-    if (deltaHeading == 0) { // prevent divide by 0
-        localX = deltaX;
-        localY = deltaY;
-    } else {
-        localX = 2 * sin(deltaHeading / 2) * (deltaX / deltaHeading + horizontalOffset);
-        localY = 2 * sin(deltaHeading / 2) * (deltaY / deltaHeading + verticalOffset);
-    }
+    for (uint32_t step = 0; step < steps; step++) {
+        const float avgHeading = prevPose.theta + stepHeading * (step + 0.5f);
+        // calculate local x and y, using the integrator chosen with setIntegrator
+        const Pose local = this->strategy.integrate(deltaX / steps, deltaY / steps, stepHeading, twistChange,
+                                                    horizontalOffset, verticalOffset);
+        localX += local.x;
+        localY += local.y;
 
-    // save previous pose
-    lemlib::Pose prevPose = odomPose;
+        // calculate global x and y
+        // the pose is accumulated in double precision, so small changes aren't lost to rounding when it is large
+        this->accumulatedX += local.y * sin(avgHeading);
+        this->accumulatedY += local.y * cos(avgHeading);
+        this->accumulatedX += local.x * -cos(avgHeading);
+        this->accumulatedY += local.x * sin(avgHeading);
+    }
+    this->accumulatedTheta += deltaHeading;
+    this->pose = Pose(this->accumulatedX, this->accumulatedY, this->accumulatedTheta);
+    const Pose integrated = this->pose;
 
-    // calculate global x and y
-    odomPose.x += localY * sin(avgHeading);
-    odomPose.y += localY * cos(avgHeading);
-    odomPose.x += localX * -cos(avgHeading);
-    odomPose.y += localX * sin(avgHeading);
-    odomPose.theta = heading;
+    // blend in the other heading sources
+    if (this->ekfEnabled) this->fuseHeadings(prevPose, delta);
 
     // calculate speed
-    odomSpeed.x = ema((odomPose.x - prevPose.x) / 0.01, odomSpeed.x, 0.95);
-    odomSpeed.y = ema((odomPose.y - prevPose.y) / 0.01, odomSpeed.y, 0.95);
-    odomSpeed.theta = ema((odomPose.theta - prevPose.theta) / 0.01, odomSpeed.theta, 0.95);
-
-    // calculate local speed
-    odomLocalSpeed.x = ema(localX / 0.01, odomLocalSpeed.x, 0.95);
-    odomLocalSpeed.y = ema(localY / 0.01, odomLocalSpeed.y, 0.95);
-    odomLocalSpeed.theta = ema(deltaHeading / 0.01, odomLocalSpeed.theta, 0.95);
-}
-
-void lemlib::init() {
-    if (trackingTask == nullptr) {
-        trackingTask = new pros::Task {[=] {
-            while (true) {
-                update();
-                pros::delay(10);
-            }
-        }};
+    // prevent divide by 0 if 2 updates happen at the same time
+    if (dt != 0) {
+        this->speed.x = ema((this->pose.x - prevPose.x) / dt, this->speed.x, 0.95);
+        this->speed.y = ema((this->pose.y - prevPose.y) / dt, this->speed.y, 0.95);
+        this->speed.theta = ema((this->pose.theta - prevPose.theta) / dt, this->speed.theta, 0.95);
+
+        // calculate local speed
+        this->localSpeed.x = ema(localX / dt, this->localSpeed.x, 0.95);
+        this->localSpeed.y = ema(localY / dt, this->localSpeed.y, 0.95);
+        this->localSpeed.theta = ema(deltaHeading / dt, this->localSpeed.theta, 0.95);
+    }
+
+    // blend in the velocities measured by the sensors, which don't lag like differentiated velocities
+    if (this->velocitySource == OdomVelocitySource::HARDWARE) this->fuseVelocities(frame, deltaHeading);
+
+    // correct the pose using the particle filter
+    // this is done after the speed is calculated so corrections don't show up as spikes in the speed
+    if (this->filter != nullptr) this->pose = this->filter->update(prevPose, this->pose);
+
+    // bound the drift of the position with the GPS, when it has a new reading
+    if (this->gpsFresh) this->fuseGps();
+
+    // keep the heading of the tracking wheels from drifting away from the inertial sensor
+    if (this->anchorSettings.enabled && !this->ekfEnabled) this->anchorHeading(delta.imu, dt);
+
+    // apply the next part of the position correction
+    if (this->correctionUpdates > 0) {
+        const float stepX = this->correctionX / this->correctionUpdates;
+        const float stepY = this->correctionY / this->correctionUpdates;
+        this->pose.x += stepX;
+        this->pose.y += stepY;
+        this->correctionX -= stepX;
+        this->correctionY -= stepY;
+        this->correctionUpdates--;
+        // a correction applied at once, or blended in quickly, moves the pose further than motions expect it to move
+        if (std::hypot(stepX, stepY) > POSE_JUMP_DISTANCE) this->poseJumps++;
+    }
+
+    // apply the corrections from the filters to the accumulated pose too
+    this->accumulatedX += this->pose.x - integrated.x;
+    this->accumulatedY += this->pose.y - integrated.y;
+    this->accumulatedTheta += this->pose.theta - integrated.theta;
+
+    // let other tasks read the new state
+    this->publishState(now);
+    if (recorder != nullptr)
+        recorder->recordPose(Pose(this->pose.x, this->pose.y, radToDeg(this->pose.theta)), now / 1000);
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::setSensorLog(SensorLog* log) {
+    this->writeMutex.take();
+    this->sensorLog = log;
+    // a log doesn't record the motion of the last update, so the recorded odometry forgets it too, and a replay
+    // integrates the first update the same way
+    this->prevTwistTime = 0;
+    if (log != nullptr)
+        log->record({SensorRecordType::START, this->prevFrame, this->accumulatedX, this->accumulatedY,
+                     this->accumulatedTheta, this->prevUpdateTime, this->timing.period});
+    this->writeMutex.give();
+}
+
+void lemlib::Odometry::setFlightRecorder(FlightRecorder* recorder) { this->flightRecorder = recorder; }
+
+size_t lemlib::Odometry::replay(SensorLogReader& reader, std::function<void(const OdomState&)> onUpdate) {
+    size_t updates = 0;
+    SensorRecord record;
+    while (reader.next(record)) {
+        switch (record.type) {
+            case SensorRecordType::START:
+                // continue from the state the odometry was in when recording started
+                this->writeMutex.take();
+                this->accumulatedX = record.x;
+                this->accumulatedY = record.y;
+                this->accumulatedTheta = record.theta;
+                this->pose = Pose(record.x, record.y, record.theta);
+                this->prevFrame = record.frame;
+                this->prevUpdateTime = record.prevUpdateTime;
+                this->prevTwistTime = 0;
+                this->timing.period = record.period;
+                if (this->filter != nullptr) this->filter->reset(this->pose, POSE_RESET_SPREAD);
+                if (this->ekfEnabled) this->resetEKF();
+                this->publishState(record.prevUpdateTime);
+                this->writeMutex.give();
+                break;
+            case SensorRecordType::FRAME:
+                this->update(record.frame);
+                updates++;
+                if (onUpdate) onUpdate(this->getState());
+                break;
+            case SensorRecordType::POSE: this->setPose(Pose(record.x, record.y, record.theta), true); break;
+        }
+    }
+    return updates;
+}
+
+void lemlib::Odometry::tick(uint32_t due) {
+    const uint64_t start = pros::micros();
+    {
+        HotPathScope hotPath;
+        this->update();
+    }
+    // the update took longer than the period, so the next update will start late
+    const bool overran = pros::millis() - due > this->timing.period;
+    if (overran) this->timing.overruns++;
+    const uint64_t dueMicros = uint64_t(due) * 1000;
+    const uint32_t busy = pros::micros() - start;
+    this->profiler.record(busy, start > dueMicros ? start - dueMicros : 0, this->timing.period * 1000);
+    this->taskMonitor.record(busy, overran);
+    // warned here rather than in the update, since the update can't allocate
+    const uint32_t stalls = this->timing.stalls;
+    if (stalls != this->reportedStalls) {
+        this->reportedStalls = stalls;
+        infoSink()->warn("Odometry stalled for {} ms, {} stalls so far", this->timing.longestStall / 1000, stalls);
+    }
+    this->updateIdle();
+    // timestamps changes of the competition state within an update, even when nothing asks for the time
+    matchClock().update();
+}
+
+void lemlib::Odometry::setScheduler(Scheduler* scheduler) {
+    if (this->task != nullptr || this->schedulerJob >= 0) {
+        infoSink()->warn("Odometry is already running, so it can't be moved to a scheduler");
+        return;
+    }
+    this->scheduler = scheduler;
+}
+
+void lemlib::Odometry::init() {
+    if (defaultOdometry == nullptr) defaultOdometry = this;
+    if (this->task != nullptr || this->schedulerJob >= 0) return;
+    if (this->scheduler != nullptr) {
+        this->schedulerJob = this->scheduler->addJob(
+            "odometry", this->timing.period,
+            [](void* odometry, uint32_t due) { static_cast<Odometry*>(odometry)->tick(due); }, this);
+        if (this->schedulerJob >= 0) return;
+        infoSink()->warn("Scheduler has no room for odometry, so odometry is running on its own task");
     }
+    const TaskSettings settings = getTaskConfig().tracking;
+    this->task = new pros::Task {[this] {
+        uint32_t prevTime = pros::millis();
+        while (true) {
+            this->tick(prevTime);
+            if (!this->idle) {
+                pros::Task::delay_until(&prevTime, this->timing.period);
+                continue;
+            }
+            // sleep at the idle rate, but wake as soon as the full rate is needed
+            pros::Task::notify_take(true, this->currentPeriod());
+            prevTime = pros::millis();
+        }
+    }, settings.priority, settings.stackSize};
+    this->taskMonitor.attach(*this->task, settings.stackSize);
 }
+
+void lemlib::setSensors(lemlib::OdomSensors sensors, lemlib::Drivetrain drivetrain) {
+    getDefaultOdometry().setSensors(sensors);
+}
+
+lemlib::OdomState lemlib::getState() { return getDefaultOdometry().getState(); }
+
+lemlib::Pose lemlib::getPose(bool radians) { return getDefaultOdometry().getPose(radians); }
+
+lemlib::Pose lemlib::getPoseAt(uint32_t time, bool radians) { return getDefaultOdometry().getPoseAt(time, radians); }
+
+lemlib::PoseHistory lemlib::getHistory() { return getDefaultOdometry().getHistory(); }
+
+void lemlib::setPose(lemlib::Pose pose, bool radians) { getDefaultOdometry().setPose(pose, radians); }
+
+lemlib::Pose lemlib::getSpeed(bool radians) { return getDefaultOdometry().getSpeed(radians); }
+
+lemlib::Pose lemlib::getLocalSpeed(bool radians) { return getDefaultOdometry().getLocalSpeed(radians); }
+
+lemlib::Pose lemlib::estimatePose(float time, bool radians) { return getDefaultOdometry().estimatePose(time, radians); }
+
+void lemlib::setUpdatePeriod(uint32_t period) { getDefaultOdometry().setUpdatePeriod(period); }
+
+lemlib::OdomTiming lemlib::getOdomTiming() { return getDefaultOdometry().getTiming(); }
+
+uint32_t lemlib::getOdomSequence() { return getDefaultOdometry().getSequence(); }
+
+lemlib::SensorFrame lemlib::sampleSensors() { return getDefaultOdometry().sampleSensors(); }
+
+void lemlib::update() { getDefaultOdometry().update(); }
+
+void lemlib::update(const SensorFrame& frame) { getDefaultOdometry().update(frame); }
+
+void lemlib::init() { getDefaultOdometry().init(); }
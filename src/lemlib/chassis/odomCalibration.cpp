@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/timer.hpp"
+#include "lemlib/util.hpp"
+
+// the robot is pushing against the wall once it has been slower than this for CONTACT_TIME, in inches per second
+constexpr float CONTACT_SPEED = 1;
+// how long the robot has to be slow before it is against the wall, in milliseconds
+constexpr uint32_t CONTACT_TIME = 250;
+// how long the robot keeps pushing against the wall, so it turns square to it, in milliseconds
+constexpr uint32_t SQUARE_TIME = 500;
+// time the robot rests before the sensors are read, so it has stopped, in milliseconds
+constexpr uint32_t SETTLE_TIME = 500;
+// the spin stops this many degrees before the turns, since the robot coasts
+constexpr float COAST_ANGLE = 15;
+// the vertical tracking wheels have to measure at least this fraction of the gap, or they aren't working
+constexpr float MIN_MEASURED = 0.5;
+
+lemlib::OdomCalibrationResult lemlib::Chassis::calibrateOdometry(ConfigStore& config, float gap, int turns,
+                                                                 float power, int timeout) {
+    OdomCalibrationResult result;
+    if (this->imuState != ImuState::READY) {
+        infoSink()->error("Odometry calibration needs a calibrated inertial sensor");
+        return result;
+    }
+    this->cancelAllMotions();
+    this->resetDriveOutput();
+    power = std::fabs(power);
+    turns = std::max(turns, 1);
+    // the drive motors are measured for the track width, even when odometry uses tracking wheels
+    TrackingWheel leftWheel(drivetrain.leftMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    TrackingWheel rightWheel(drivetrain.rightMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    TrackingWheel* const vertical[2] = {this->sensors.vertical1, this->sensors.vertical2};
+    TrackingWheel* const horizontal[2] = {this->sensors.horizontal1, this->sensors.horizontal2};
+    const float imuScale = this->odom.getImuScale();
+
+    // the readings once the robot has stopped. The inertial sensor is in radians, without its scale
+    struct Reading {
+            SensorFrame frame;
+            float left, right, imu;
+    };
+
+    const auto settle = [&] {
+        this->setDrivePower(0, 0);
+        pros::delay(SETTLE_TIME);
+        const SensorFrame frame = this->odom.getSensorFrame();
+        return Reading {frame, leftWheel.getDistanceTraveled(), rightWheel.getDistanceTraveled(),
+                        frame.imu / imuScale};
+    };
+    // drive forwards until the robot stops against the wall, then push it square
+    const auto driveToWall = [&] {
+        Timer timer(timeout);
+        bool moving = false;
+        uint32_t lastFast = pros::millis();
+        uint32_t now = pros::millis();
+        while (!timer.isDone()) {
+            this->setDrivePower(power, power);
+            pros::Task::delay_until(&now, this->controlPeriod);
+            if (std::fabs(this->odom.getState().localSpeed.y) > 2 * CONTACT_SPEED) {
+                moving = true;
+                lastFast = now;
+            } else if (moving && now - lastFast >= CONTACT_TIME) {
+                pros::delay(SQUARE_TIME);
+                return true;
+            }
+        }
+        this->setDrivePower(0, 0);
+        infoSink()->error("Odometry calibration failed, the robot didn't reach the wall");
+        return false;
+    };
+
+    // 1. the vertical tracking wheels measure the gap
+    const Reading start = settle();
+    if (!driveToWall()) return result;
+    const Reading atWall = settle();
+    float diameters[2] = {NAN, NAN};
+    for (int i = 0; i < 2; i++) {
+        TrackingWheel* wheel = vertical[i];
+        if (wheel == nullptr || wheel->getType()) continue;
+        const float turned = (atWall.imu - start.imu) * imuScale;
+        const float measured = (i == 0 ? atWall.frame.vertical1 - start.frame.vertical1
+                                       : atWall.frame.vertical2 - start.frame.vertical2) +
+                               wheel->getOffset() * turned;
+        if (measured < MIN_MEASURED * gap) {
+            infoSink()->error("Odometry calibration failed, vertical tracking wheel {} only measured {} inches",
+                              i + 1, measured);
+            return result;
+        }
+        diameters[i] = wheel->getDiameter() * gap / measured;
+    }
+
+    // 2. back up to the middle of the gap, and spin
+    const Pose wallPose = this->getPose();
+    Timer backTimer(timeout);
+    uint32_t now = pros::millis();
+    while (!backTimer.isDone() && this->getPose().distance(wallPose) < gap / 2) {
+        this->setDrivePower(-power, -power);
+        pros::Task::delay_until(&now, this->controlPeriod);
+    }
+    const Reading beforeSpin = settle();
+    const float spin = degToRad(turns * 360 - COAST_ANGLE);
+    Timer spinTimer(timeout * turns);
+    while (!spinTimer.isDone() && this->odom.getSensorFrame().imu - beforeSpin.frame.imu < spin) {
+        this->setDrivePower(power, -power);
+        pros::Task::delay_until(&now, this->controlPeriod);
+    }
+    const Reading afterSpin = settle();
+
+    // 3. turn back and square up against the wall, so the robot has turned exactly the whole turns
+    this->turnToHeading(wallPose.theta, timeout, {}, false);
+    if (!driveToWall()) return result;
+    const Reading end = settle();
+    const float total = end.imu - atWall.imu;
+    const float wholeTurns = std::round(total * imuScale / (2 * M_PI));
+    if (wholeTurns < 1) {
+        infoSink()->error("Odometry calibration failed, the robot didn't spin");
+        return result;
+    }
+    result.imuScale = wholeTurns * 2 * M_PI / total;
+
+    // a wheel that rolls d for each radian the robot turns is -d from the center of rotation
+    const float turned = (afterSpin.imu - beforeSpin.imu) * result.imuScale;
+    const float rolled[4] = {afterSpin.frame.vertical1 - beforeSpin.frame.vertical1,
+                             afterSpin.frame.vertical2 - beforeSpin.frame.vertical2,
+                             afterSpin.frame.horizontal1 - beforeSpin.frame.horizontal1,
+                             afterSpin.frame.horizontal2 - beforeSpin.frame.horizontal2};
+    float offsets[4] = {NAN, NAN, NAN, NAN};
+    for (int i = 0; i < 4; i++) {
+        TrackingWheel* wheel = i < 2 ? vertical[i] : horizontal[i - 2];
+        if (wheel == nullptr || wheel->getType()) continue;
+        // the distances were measured with the old diameters
+        const float scale = i < 2 ? diameters[i] / wheel->getDiameter() : 1;
+        offsets[i] = -rolled[i] * scale / turned;
+    }
+    result.vertical1Offset = offsets[0];
+    result.vertical2Offset = offsets[1];
+    result.horizontal1Offset = offsets[2];
+    result.horizontal2Offset = offsets[3];
+    result.vertical1Diameter = diameters[0];
+    result.vertical2Diameter = diameters[1];
+    result.trackWidth = ((afterSpin.left - beforeSpin.left) - (afterSpin.right - beforeSpin.right)) / turned;
+    result.success = true;
+
+    infoSink()->info("Odometry calibration: imu scale {}, offsets {} {} {} {}, diameters {} {}, track width {}",
+                     result.imuScale, offsets[0], offsets[1], offsets[2], offsets[3], diameters[0], diameters[1],
+                     result.trackWidth);
+    const char* offsetKeys[4] = {"vertical1.offset", "vertical2.offset", "horizontal1.offset", "horizontal2.offset"};
+    for (int i = 0; i < 4; i++) {
+        if (std::isfinite(offsets[i])) config.set(offsetKeys[i], offsets[i]);
+    }
+    if (std::isfinite(diameters[0])) config.set("vertical1.diameter", diameters[0]);
+    if (std::isfinite(diameters[1])) config.set("vertical2.diameter", diameters[1]);
+    config.set("imu.scale", result.imuScale);
+    config.set("drivetrain.trackWidth", result.trackWidth);
+    if (!config.save()) infoSink()->warn("Couldn't save the odometry calibration. Is there an SD card?");
+    return result;
+}
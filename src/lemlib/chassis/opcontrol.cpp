@@ -1,72 +1,201 @@
 #include "lemlib/chassis/chassis.hpp"
 #include "lemlib/util.hpp"
+#include "pros/misc.h"
 #include <math.h>
+#include <utility>
 
 namespace lemlib {
 
 ExpoDriveCurve defaultDriveCurve = ExpoDriveCurve(0, 0, 1);
 
-void Chassis::tank(int left, int right, bool disableDriveCurve) {
-    if (disableDriveCurve) {
-        drivetrain.leftMotors->move(left);
-        drivetrain.rightMotors->move(right);
-    } else {
-        drivetrain.leftMotors->move(throttleCurve->curve(left));
-        drivetrain.rightMotors->move(throttleCurve->curve(right));
-    }
+uint64_t Chassis::driverInputTime() const {
+    const uint64_t readTime = driverReadTime;
+    return readTime != 0 ? readTime : pros::micros();
 }
 
-void Chassis::arcade(int throttle, int turn, bool disableDriveCurve, float desaturateBias) {
-    // use drive curves if they have not been disabled
-    if (!disableDriveCurve) {
-        throttle = std::round(throttleCurve->curve(throttle));
-        turn = std::round(throttleCurve->curve(turn));
-    }
-    // desaturate motors based on joyBias
-    if (std::abs(throttle) + std::abs(turn) > 127) {
-        int oldThrottle = throttle;
-        int oldTurn = turn;
-        throttle *= (1 - desaturateBias * std::abs(oldTurn / 127.0));
-        turn *= (1 - (1 - desaturateBias) * std::abs(oldThrottle / 127.0));
-        // ensure the sum of the two values is equal to 127
-        // this check is necessary because of integer division
-        if (std::abs(turn) + std::abs(throttle) == 126) {
-            if (desaturateBias < 0.5) throttle += sgn(throttle);
-            else turn += sgn(turn);
+void Chassis::setDriverPower(uint64_t readTime, float left, float right) {
+    // the driver takes the robot from the pose hold
+    holdArmed = false;
+    setDrivePower(left, right);
+    if (driverLatency) driverLatency->record(readTime, left, right);
+}
+
+std::pair<float, float> Chassis::drivePower(DriveScheme scheme, int throttle, int turn, bool disableDriveCurve,
+                                            float desaturateBias) {
+    switch (scheme) {
+        case DriveScheme::TANK:
+            // the throttle is the left side, and the turn the right side
+            if (disableDriveCurve) return {throttle, turn};
+            return {throttleCurve->curve(throttle), throttleCurve->curve(turn)};
+        case DriveScheme::ARCADE: {
+            // use drive curves if they have not been disabled
+            if (!disableDriveCurve) {
+                throttle = std::round(throttleCurve->curve(throttle));
+                turn = std::round(throttleCurve->curve(turn));
+            }
+            // desaturate motors based on joyBias
+            if (std::abs(throttle) + std::abs(turn) > 127) {
+                int oldThrottle = throttle;
+                int oldTurn = turn;
+                throttle *= (1 - desaturateBias * std::abs(oldTurn / 127.0));
+                turn *= (1 - (1 - desaturateBias) * std::abs(oldThrottle / 127.0));
+                // ensure the sum of the two values is equal to 127
+                // this check is necessary because of integer division
+                if (std::abs(turn) + std::abs(throttle) == 126) {
+                    if (desaturateBias < 0.5) throttle += sgn(throttle);
+                    else turn += sgn(turn);
+                }
+            }
+            return {throttle + turn, throttle - turn};
+        }
+        case DriveScheme::CURVATURE: {
+            // If we're not moving forwards change to arcade drive
+            if (throttle == 0) return drivePower(DriveScheme::ARCADE, throttle, turn, disableDriveCurve, 0.5);
+
+            // use drive curves if they have not been disabled
+            if (!disableDriveCurve) {
+                throttle = throttleCurve->curve(throttle);
+                turn = throttleCurve->curve(turn);
+            }
+
+            float leftPower = throttle + (std::fabs(throttle) * turn / 127.0);
+            float rightPower = throttle - (std::fabs(throttle) * turn / 127.0);
+
+            // desaturate output
+            float max = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
+            if (max > 1) {
+                leftPower /= max;
+                rightPower /= max;
+            }
+            return {leftPower, rightPower};
         }
     }
+    return {0, 0};
+}
 
-    int leftPower = throttle + turn;
-    int rightPower = throttle - turn;
+void Chassis::tank(int left, int right, bool disableDriveCurve) {
+    const uint64_t readTime = driverInputTime();
+    const auto [leftPower, rightPower] = drivePower(DriveScheme::TANK, left, right, disableDriveCurve, 0.5);
+    setDriverPower(readTime, leftPower, rightPower);
+}
 
+void Chassis::arcade(int throttle, int turn, bool disableDriveCurve, float desaturateBias) {
+    const uint64_t readTime = driverInputTime();
+    const auto [leftPower, rightPower] =
+        drivePower(DriveScheme::ARCADE, throttle, turn, disableDriveCurve, desaturateBias);
     // move drive
-    drivetrain.leftMotors->move(leftPower);
-    drivetrain.rightMotors->move(rightPower);
+    setDriverPower(readTime, leftPower, rightPower);
 }
 
 void Chassis::curvature(int throttle, int turn, bool disableDriveCurve) {
-    // If we're not moving forwards change to arcade drive
-    if (throttle == 0) {
-        arcade(throttle, turn, disableDriveCurve);
+    const uint64_t readTime = driverInputTime();
+    const auto [leftPower, rightPower] = drivePower(DriveScheme::CURVATURE, throttle, turn, disableDriveCurve, 0.5);
+    setDriverPower(readTime, leftPower, rightPower);
+}
+
+void Chassis::holonomic(int forward, int strafe, int turn, bool disableDriveCurve) {
+    if (drivetrain.holonomic == nullptr) return;
+    float forwardPower = forward;
+    float strafePower = strafe;
+    float turnPower = turn;
+    if (!disableDriveCurve) {
+        forwardPower = throttleCurve->curve(forward);
+        strafePower = throttleCurve->curve(strafe);
+        turnPower = steerCurve->curve(turn);
+    }
+    holdArmed = false;
+    setHolonomicPower(forwardPower, strafePower, turnPower);
+}
+
+void Chassis::startDriverControl(DriverControlSettings settings) {
+    driverMutex.take();
+    driverSettings = settings;
+    driverMutex.give();
+    driverEnabled = true;
+    if (driverTask != nullptr) {
+        // wake the task, in case it was stopped
+        driverTask->notify();
         return;
     }
+    // above the default priority, so the rest of opcontrol can't delay it. Each iteration only takes a few
+    // microseconds, so it barely takes time from anything else
+    driverTask = new pros::Task {[this] { runDriverControl(); }, TASK_PRIORITY_DEFAULT + 1};
+    driverMonitor.attach(*driverTask);
+}
 
-    // use drive curves if they have not been disabled
-    if (!disableDriveCurve) {
-        throttle = throttleCurve->curve(throttle);
-        turn = throttleCurve->curve(turn);
+void Chassis::stopDriverControl() { driverEnabled = false; }
+
+bool Chassis::driverControlRunning() const { return driverEnabled; }
+
+void Chassis::setDriverLatencyTracking(std::optional<DriverLatencySettings> settings) {
+    if (settings) {
+        makeDriveWheels();
+        driverLatency.emplace(&*leftDriveWheel, &*rightDriveWheel, *settings);
+    } else {
+        driverLatency.reset();
     }
+}
 
-    float leftPower = throttle + (std::fabs(throttle) * turn / 127.0);
-    float rightPower = throttle - (std::fabs(throttle) * turn / 127.0);
+DriverLatencyStats Chassis::getDriverLatency() {
+    return driverLatency ? driverLatency->getStats() : DriverLatencyStats();
+}
 
-    // desaturate output
-    float max = std::max(std::fabs(leftPower), std::fabs(rightPower)) / 127;
-    if (max > 1) {
-        leftPower /= max;
-        rightPower /= max;
+void Chassis::startMacroRecording(DriverMacro& macro) {
+    stopMacroRecording();
+    driverMutex.take();
+    macro.begin(driverSettings.scheme, driverSettings.disableDriveCurve, driverSettings.desaturateBias);
+    driverMutex.give();
+    macroRecording = &macro;
+}
+
+void Chassis::stopMacroRecording() {
+    macroRecording = nullptr;
+    // the driver task could be in the middle of recording a sample, so wait for it to finish
+    driverMutex.take();
+    driverMutex.give();
+}
+
+void Chassis::runDriverControl() {
+    uint32_t deadline = pros::millis();
+    while (true) {
+        if (!driverEnabled) {
+            // stop the drivetrain, then sleep until driver control is started again
+            if (!motionRunning()) setDrivePower(0, 0);
+            pros::Task::notify_take(true, TIMEOUT_MAX);
+            deadline = pros::millis();
+            continue;
+        }
+        driverMutex.take();
+        const DriverControlSettings settings = driverSettings;
+        driverMutex.give();
+
+        const uint64_t start = pros::micros();
+        // a running motion has the drivetrain, like a macro during driver control
+        if (!motionRunning()) {
+            driverReadTime = std::max<uint64_t>(pros::micros(), 1);
+            const int throttle = pros::c::controller_get_analog(settings.controller, settings.throttleAxis);
+            const int turn = pros::c::controller_get_analog(settings.controller, settings.turnAxis);
+            const int right = settings.scheme == DriveScheme::TANK
+                                  ? pros::c::controller_get_analog(settings.controller, settings.rightAxis)
+                                  : 0;
+            switch (settings.scheme) {
+                case DriveScheme::TANK: tank(throttle, right, settings.disableDriveCurve); break;
+                case DriveScheme::ARCADE:
+                    arcade(throttle, turn, settings.disableDriveCurve, settings.desaturateBias);
+                    break;
+                case DriveScheme::CURVATURE: curvature(throttle, turn, settings.disableDriveCurve); break;
+            }
+            driverReadTime = 0;
+            // the mutex makes stopMacroRecording wait for a sample being recorded
+            driverMutex.take();
+            DriverMacro* macro = macroRecording;
+            if (macro != nullptr) {
+                macro->record(throttle, settings.scheme == DriveScheme::TANK ? right : turn, getPose(), pros::millis());
+            }
+            driverMutex.give();
+        }
+        driverMonitor.record(pros::micros() - start);
+        pros::Task::delay_until(&deadline, settings.period);
     }
-    drivetrain.leftMotors->move(leftPower);
-    drivetrain.rightMotors->move(rightPower);
 }
 } // namespace lemlib
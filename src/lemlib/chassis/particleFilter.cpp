@@ -0,0 +1,226 @@
+#include <algorithm>
+#include <cmath>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/particleFilter.hpp"
+#include "lemlib/util.hpp"
+
+// standard deviation of the change in position of each particle, as a fraction of the distance traveled
+constexpr float TRANSLATION_NOISE = 0.05;
+// standard deviation of the change in heading of each particle, in radians per update
+constexpr float ROTATION_NOISE = 0.002;
+// the number of particles is never reduced below this to meet the time budget
+constexpr size_t MIN_PARTICLES = 16;
+// readings further than this, in inches, are too noisy to use. The sensor reads 9999 mm if it doesn't see anything
+constexpr float MAX_READING = 78;
+// readings with a lower confidence than this are ignored. Confidence is between 0 and 63
+constexpr int MIN_CONFIDENCE = 20;
+// the particles are resampled when the effective number of particles is less than this fraction of the particles
+constexpr float RESAMPLE_THRESHOLD = 0.5;
+
+lemlib::ParticleFilter::ParticleFilter(std::vector<DistanceSensor> sensors, FieldMap map, size_t particles)
+    : sensors(sensors),
+      map(map),
+      capacity(std::max(particles, MIN_PARTICLES)),
+      count(capacity),
+      x(capacity),
+      y(capacity),
+      theta(capacity),
+      logWeight(capacity),
+      sinTheta(capacity),
+      cosTheta(capacity),
+      nextX(capacity),
+      nextY(capacity),
+      nextTheta(capacity) {}
+
+float lemlib::ParticleFilter::uniform() {
+    // xorshift32, which is much faster than the generators in <random>
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+}
+
+float lemlib::ParticleFilter::gaussian() {
+    // the sum of 4 uniform random numbers is close enough to normally distributed, with a variance of 1/3
+    return (uniform() + uniform() + uniform() + uniform() - 2) * 1.7320508f;
+}
+
+void lemlib::ParticleFilter::reset(Pose pose, float spread) {
+    for (size_t i = 0; i < capacity; i++) {
+        x[i] = pose.x + gaussian() * spread;
+        y[i] = pose.y + gaussian() * spread;
+        theta[i] = pose.theta;
+        logWeight[i] = 0;
+    }
+    estimate = pose;
+}
+
+void lemlib::ParticleFilter::weigh(const DistanceSensor& sensor, float reading) {
+    const float offsetX = sensor.offset.x;
+    const float offsetY = sensor.offset.y;
+    const float sinMount = std::sin(sensor.offset.theta);
+    const float cosMount = std::cos(sensor.offset.theta);
+    const float scale = 1 / (2 * sensor.stdDev * sensor.stdDev);
+    size_t i = 0;
+#ifdef __ARM_NEON
+    // weigh 4 particles at a time
+    const float32x4_t minX = vdupq_n_f32(map.minX);
+    const float32x4_t maxX = vdupq_n_f32(map.maxX);
+    const float32x4_t minY = vdupq_n_f32(map.minY);
+    const float32x4_t maxY = vdupq_n_f32(map.maxY);
+    const float32x4_t zero = vdupq_n_f32(0);
+    const float32x4_t epsilon = vdupq_n_f32(1e-6);
+    for (; i + 4 <= count; i += 4) {
+        const float32x4_t s = vld1q_f32(&sinTheta[i]);
+        const float32x4_t c = vld1q_f32(&cosTheta[i]);
+        // position of the sensor on the field
+        const float32x4_t sensorX = vmlaq_n_f32(vmlaq_n_f32(vld1q_f32(&x[i]), c, offsetX), s, offsetY);
+        const float32x4_t sensorY = vmlsq_n_f32(vmlaq_n_f32(vld1q_f32(&y[i]), c, offsetY), s, offsetX);
+        // direction the sensor faces on the field
+        const float32x4_t dirX = vmlaq_n_f32(vmulq_n_f32(s, cosMount), c, sinMount);
+        const float32x4_t dirY = vmlsq_n_f32(vmulq_n_f32(c, cosMount), s, sinMount);
+        // distance to the walls the sensor faces, using the reciprocal estimate refined by 1 Newton step
+        const float32x4_t safeX = vbslq_f32(vcltq_f32(vabsq_f32(dirX), epsilon), epsilon, dirX);
+        const float32x4_t safeY = vbslq_f32(vcltq_f32(vabsq_f32(dirY), epsilon), epsilon, dirY);
+        float32x4_t invX = vrecpeq_f32(safeX);
+        invX = vmulq_f32(invX, vrecpsq_f32(safeX, invX));
+        float32x4_t invY = vrecpeq_f32(safeY);
+        invY = vmulq_f32(invY, vrecpsq_f32(safeY, invY));
+        const float32x4_t wallX = vbslq_f32(vcgtq_f32(safeX, zero), maxX, minX);
+        const float32x4_t wallY = vbslq_f32(vcgtq_f32(safeY, zero), maxY, minY);
+        const float32x4_t distX = vmulq_f32(vsubq_f32(wallX, sensorX), invX);
+        const float32x4_t distY = vmulq_f32(vsubq_f32(wallY, sensorY), invY);
+        // particles outside the field have a negative distance, which is treated as 0
+        const float32x4_t expected = vmaxq_f32(vminq_f32(distX, distY), zero);
+        const float32x4_t error = vsubq_f32(expected, vdupq_n_f32(reading));
+        vst1q_f32(&logWeight[i], vmlsq_n_f32(vld1q_f32(&logWeight[i]), vmulq_f32(error, error), scale));
+    }
+#endif
+    // weigh the remaining particles
+    for (; i < count; i++) {
+        const float s = sinTheta[i];
+        const float c = cosTheta[i];
+        const float sensorX = x[i] + c * offsetX + s * offsetY;
+        const float sensorY = y[i] + c * offsetY - s * offsetX;
+        float dirX = s * cosMount + c * sinMount;
+        float dirY = c * cosMount - s * sinMount;
+        // prevent divide by 0 if the sensor is parallel to a wall
+        if (std::fabs(dirX) < 1e-6) dirX = 1e-6;
+        if (std::fabs(dirY) < 1e-6) dirY = 1e-6;
+        const float distX = ((dirX > 0 ? map.maxX : map.minX) - sensorX) / dirX;
+        const float distY = ((dirY > 0 ? map.maxY : map.minY) - sensorY) / dirY;
+        const float error = std::max(std::min(distX, distY), 0.0f) - reading;
+        logWeight[i] -= error * error * scale;
+    }
+}
+
+void lemlib::ParticleFilter::resample() {
+    // convert the log weights to weights. The max is subtracted so the largest weight is 1 and nothing underflows
+    const float maxLog = *std::max_element(logWeight.begin(), logWeight.begin() + count);
+    float sum = 0;
+    float sumSquared = 0;
+    float estimateX = 0;
+    float estimateY = 0;
+    float estimateSin = 0;
+    float estimateCos = 0;
+    for (size_t i = 0; i < count; i++) {
+        const float weight = std::exp(logWeight[i] - maxLog);
+        logWeight[i] = weight;
+        sum += weight;
+        sumSquared += weight * weight;
+        estimateX += x[i] * weight;
+        estimateY += y[i] * weight;
+        estimateSin += sinTheta[i] * weight;
+        estimateCos += cosTheta[i] * weight;
+    }
+    // the estimate is the weighted average of the particles
+    estimate = Pose(estimateX / sum, estimateY / sum, std::atan2(estimateSin, estimateCos));
+    // keep the heading continuous with the heading of the particles, since it isn't wrapped by odometry
+    estimate.theta = theta[0] + angleError(estimate.theta, theta[0], true);
+
+    // only resample when the weights have collapsed onto a few particles, since resampling loses information
+    if (sum * sum / sumSquared >= count * RESAMPLE_THRESHOLD) {
+        // particles with a weight of 0 are clamped so they still have a finite log weight
+        for (size_t i = 0; i < count; i++) logWeight[i] = std::max(std::log(logWeight[i]), -80.0f);
+        return;
+    }
+    // low variance resampling
+    const float step = sum / count;
+    float target = uniform() * step;
+    float cumulative = logWeight[0];
+    size_t source = 0;
+    for (size_t i = 0; i < count; i++) {
+        while (cumulative < target && source + 1 < count) cumulative += logWeight[++source];
+        nextX[i] = x[source];
+        nextY[i] = y[source];
+        nextTheta[i] = theta[source];
+        target += step;
+    }
+    x.swap(nextX);
+    y.swap(nextY);
+    theta.swap(nextTheta);
+    std::fill(logWeight.begin(), logWeight.begin() + count, 0.0f);
+}
+
+lemlib::Pose lemlib::ParticleFilter::update(Pose prevPose, Pose pose) {
+    const uint64_t start = pros::micros();
+
+    // change in pose relative to the robot
+    const float avgHeading = prevPose.theta + (pose.theta - prevPose.theta) / 2;
+    const float dx = pose.x - prevPose.x;
+    const float dy = pose.y - prevPose.y;
+    const float forward = dx * std::sin(avgHeading) + dy * std::cos(avgHeading);
+    const float right = dx * std::cos(avgHeading) - dy * std::sin(avgHeading);
+    const float turn = pose.theta - prevPose.theta;
+    const float translationNoise = std::hypot(dx, dy) * TRANSLATION_NOISE;
+
+    // move the particles
+    for (size_t i = 0; i < count; i++) {
+        const float particleForward = forward + gaussian() * translationNoise;
+        const float particleRight = right + gaussian() * translationNoise;
+        const float particleTurn = turn + gaussian() * ROTATION_NOISE;
+        const float heading = theta[i] + particleTurn / 2;
+        const float s = std::sin(heading);
+        const float c = std::cos(heading);
+        x[i] += particleForward * s + particleRight * c;
+        y[i] += particleForward * c - particleRight * s;
+        theta[i] += particleTurn;
+        sinTheta[i] = std::sin(theta[i]);
+        cosTheta[i] = std::cos(theta[i]);
+    }
+
+    // weigh the particles using each distance sensor that can see a wall
+    for (const DistanceSensor& sensor : sensors) {
+        const int32_t reading = sensor.sensor->get();
+        if (reading == PROS_ERR || sensor.sensor->get_confidence() < MIN_CONFIDENCE) continue;
+        const float inches = reading / 25.4f;
+        if (inches > MAX_READING) continue;
+        weigh(sensor, inches);
+    }
+
+    resample();
+
+    // record how long the update took, and use fewer particles if it took too long
+    updateTime = pros::micros() - start;
+    maxUpdateTime = std::max(maxUpdateTime, updateTime);
+    if (timeBudget != 0 && updateTime > timeBudget) count = std::max(count * 3 / 4, MIN_PARTICLES);
+
+    return estimate;
+}
+
+lemlib::Pose lemlib::ParticleFilter::getEstimate() { return estimate; }
+
+void lemlib::ParticleFilter::setParticleCount(size_t particles) {
+    count = std::clamp(particles, MIN_PARTICLES, capacity);
+}
+
+size_t lemlib::ParticleFilter::getParticleCount() { return count; }
+
+void lemlib::ParticleFilter::setTimeBudget(uint32_t budget) { timeBudget = budget; }
+
+uint32_t lemlib::ParticleFilter::getUpdateTime() { return updateTime; }
+
+uint32_t lemlib::ParticleFilter::getMaxUpdateTime() { return maxUpdateTime; }
@@ -0,0 +1,128 @@
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include "pros/error.h"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/chassis.hpp"
+#include "lemlib/configStore.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/util.hpp"
+
+// a checkpoint is written once the robot has moved this far since the last one, in inches
+constexpr float WRITE_DISTANCE = 0.1;
+// or turned this far, in degrees
+constexpr float WRITE_ANGLE = 0.1;
+// the robot hasn't moved if the drive motors read within this distance of the checkpoint, in inches
+constexpr float MOVE_TOLERANCE = 0.25;
+// and the inertial sensor within this angle. It drifts a little while the program restarts, in degrees
+constexpr float TURN_TOLERANCE = 1;
+// the robot is still if the inertial sensor turns slower than this, in degrees per second
+constexpr float STILL_RATE = 2;
+
+/**
+ * @brief Write a checkpoint to a file, replacing it
+ */
+static bool writeCheckpoint(const std::string& path, lemlib::PoseCheckpoint checkpoint) {
+    if (!pros::usd::is_installed()) return false;
+    checkpoint.magic = lemlib::CHECKPOINT_MAGIC;
+    checkpoint.version = lemlib::CHECKPOINT_VERSION;
+    checkpoint.checksum =
+        lemlib::crc32(reinterpret_cast<const uint8_t*>(&checkpoint), offsetof(lemlib::PoseCheckpoint, checksum));
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+    const bool written = fwrite(&checkpoint, sizeof(checkpoint), 1, file) == 1;
+    fclose(file);
+    return written;
+}
+
+/**
+ * @brief Read a checkpoint from a file
+ *
+ * @return false there is no SD card or file, or the checkpoint is corrupt or from a different version of LemLib
+ */
+static bool readCheckpoint(const std::string& path, lemlib::PoseCheckpoint& checkpoint) {
+    if (!pros::usd::is_installed()) return false;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+    const bool read = fread(&checkpoint, sizeof(checkpoint), 1, file) == 1;
+    fclose(file);
+    return read && checkpoint.magic == lemlib::CHECKPOINT_MAGIC && checkpoint.version == lemlib::CHECKPOINT_VERSION &&
+           checkpoint.checksum == lemlib::crc32(reinterpret_cast<const uint8_t*>(&checkpoint),
+                                                offsetof(lemlib::PoseCheckpoint, checksum));
+}
+
+void lemlib::Chassis::enableCheckpoints(const std::string& path, uint32_t period) {
+    if (this->checkpointTask != nullptr) {
+        infoSink()->warn("Checkpoints are already enabled");
+        return;
+    }
+    this->checkpointTask = new pros::Task {[this, path, period] {
+        // the task reads the drive motors through its own wheels, so it doesn't share read statistics with odometry
+        TrackingWheel leftWheel(drivetrain.leftMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+        TrackingWheel rightWheel(drivetrain.rightMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+        PoseCheckpoint last;
+        bool written = false;
+        bool warned = false;
+        uint32_t now = pros::millis();
+        while (true) {
+            const Pose pose = this->odom.getPose(true);
+            PoseCheckpoint checkpoint;
+            checkpoint.x = pose.x;
+            checkpoint.y = pose.y;
+            checkpoint.theta = pose.theta;
+            if (this->imuState == ImuState::READY) checkpoint.imuRotation = this->sensors.imu->get_rotation();
+            checkpoint.left = leftWheel.getDistanceTraveled();
+            checkpoint.right = rightWheel.getDistanceTraveled();
+            const bool moved = std::hypot(checkpoint.x - last.x, checkpoint.y - last.y) > WRITE_DISTANCE ||
+                               std::fabs(radToDeg(checkpoint.theta - last.theta)) > WRITE_ANGLE ||
+                               std::fabs(checkpoint.imuRotation - last.imuRotation) > WRITE_ANGLE ||
+                               std::isnan(checkpoint.imuRotation) != std::isnan(last.imuRotation) ||
+                               std::fabs(checkpoint.left - last.left) > WRITE_DISTANCE ||
+                               std::fabs(checkpoint.right - last.right) > WRITE_DISTANCE;
+            if (!written || moved) {
+                written = writeCheckpoint(path, checkpoint);
+                if (written) {
+                    last = checkpoint;
+                } else if (!warned) {
+                    infoSink()->warn("Couldn't write the checkpoint to {}. Is there an SD card?", path);
+                    warned = true;
+                }
+            }
+            pros::Task::delay_until(&now, period);
+        }
+    }, TASK_PRIORITY_MIN + 1};
+}
+
+bool lemlib::Chassis::warmStart(const std::string& path) {
+    const auto coldStart = [this](const char* reason) {
+        infoSink()->info("Calibrating the chassis, {}", reason);
+        this->calibrate();
+        return false;
+    };
+    PoseCheckpoint checkpoint;
+    if (!readCheckpoint(path, checkpoint)) return coldStart("there is no checkpoint");
+    pros::Imu* imu = this->sensors.imu;
+    if (imu != nullptr) {
+        if (std::isnan(checkpoint.imuRotation)) return coldStart("the inertial sensor wasn't used at the checkpoint");
+        // an inertial sensor that lost power, or isn't plugged in, has no rotation
+        const double rotation = imu->is_calibrating() ? PROS_ERR_F : imu->get_rotation();
+        if (!std::isfinite(rotation)) return coldStart("the inertial sensor isn't calibrated");
+        if (std::fabs(rotation - checkpoint.imuRotation) > TURN_TOLERANCE ||
+            std::fabs(imu->get_gyro_rate().z) > STILL_RATE)
+            return coldStart("the robot turned since the checkpoint");
+    }
+    // the drive motors are read before odometry resets them
+    TrackingWheel leftWheel(drivetrain.leftMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    TrackingWheel rightWheel(drivetrain.rightMotors, drivetrain.wheelDiameter, 0, drivetrain.rpm);
+    if (std::fabs(leftWheel.getDistanceTraveled() - checkpoint.left) > MOVE_TOLERANCE ||
+        std::fabs(rightWheel.getDistanceTraveled() - checkpoint.right) > MOVE_TOLERANCE)
+        return coldStart("the robot moved since the checkpoint");
+    if (imu != nullptr) this->imuState = ImuState::READY;
+    this->startTracking(imu);
+    this->odom.setPose(Pose(checkpoint.x, checkpoint.y, checkpoint.theta), true);
+    pros::c::controller_rumble(pros::E_CONTROLLER_MASTER, ".");
+    infoSink()->info("Restored the pose x {} y {} theta {} from {}", checkpoint.x, checkpoint.y,
+                     radToDeg(checkpoint.theta), path);
+    return true;
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <cmath>
+#include "pros/misc.hpp"
+#include "lemlib/chassis/powerManager.hpp"
+
+// the voltage of full power, in millivolts
+constexpr float FULL_VOLTAGE = 12000;
+// how much the power recovers each update while under the current budget
+constexpr float RECOVERY_RATE = 1.1;
+
+/**
+ * @brief Get the total current drawn by a group of motors, in milliamps
+ */
+static float totalCurrent(pros::MotorGroup* motors) {
+    float total = 0;
+    for (const int32_t current : motors->get_current_draws()) total += current;
+    return total;
+}
+
+lemlib::PowerManager::PowerManager(PowerBudget budget)
+    : budget(budget) {}
+
+void lemlib::PowerManager::addLoad(pros::MotorGroup* motors) {
+    this->mutex.take();
+    this->loads.push_back(motors);
+    this->mutex.give();
+}
+
+float lemlib::PowerManager::getScale(pros::MotorGroup* left, pros::MotorGroup* right) {
+    const uint32_t now = pros::millis();
+    // if another task is updating the reading, use the last one instead of waiting
+    if ((!this->updated || now - this->lastUpdate >= this->budget.period) && this->mutex.take(0)) {
+        this->lastUpdate = now;
+        this->updated = true;
+        this->update(left, right);
+        this->mutex.give();
+    }
+    return this->reading.scale;
+}
+
+lemlib::PowerReading lemlib::PowerManager::getReading() { return this->reading; }
+
+void lemlib::PowerManager::update(pros::MotorGroup* left, pros::MotorGroup* right) {
+    PowerReading reading;
+    reading.battery = pros::battery::get_voltage();
+    reading.driveCurrent = totalCurrent(left) + totalCurrent(right);
+    for (pros::MotorGroup* load : this->loads) reading.loadCurrent += totalCurrent(load);
+
+    // the current of a motor drops with its voltage, so scaling the power by the fraction the drivetrain is over its
+    // share brings it back under. Under the budget, the power recovers gradually, so it doesn't oscillate
+    const float available = std::fmax(this->budget.current - reading.loadCurrent, 0);
+    if (reading.driveCurrent > available) this->currentScale *= available / reading.driveCurrent;
+    else this->currentScale *= RECOVERY_RATE;
+    this->currentScale = std::clamp(this->currentScale, this->budget.minScale, 1.0f);
+
+    // the motors can't be given more than the battery voltage. A battery that couldn't be read is ignored
+    float voltage = this->budget.voltage;
+    if (reading.battery > 0) voltage = std::fmin(voltage, reading.battery);
+    reading.scale = std::clamp(this->currentScale * voltage / FULL_VOLTAGE, this->budget.minScale, 1.0f);
+    this->reading = reading;
+}
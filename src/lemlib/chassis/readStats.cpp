@@ -0,0 +1,31 @@
+#include "lemlib/chassis/readStats.hpp"
+
+void lemlib::ReadMonitor::record(uint64_t start, uint64_t end, float value) {
+    const uint32_t duration = end - start;
+    this->reads++;
+    this->total += duration;
+    if (duration > this->max) this->max = duration;
+    // the first read has nothing to compare to
+    if (this->reads > 1 && value == this->lastValue) {
+        this->unchanged++;
+        return;
+    }
+    if (this->lastChange != 0 && start - this->lastChange <= MAX_UPDATE_GAP) {
+        this->intervalTotal += start - this->lastChange;
+        this->intervals++;
+    }
+    this->lastChange = start;
+    this->lastValue = value;
+}
+
+lemlib::ReadStats lemlib::ReadMonitor::getStats() const {
+    ReadStats stats;
+    stats.reads = this->reads;
+    stats.average = this->reads == 0 ? 0 : float(this->total) / this->reads;
+    stats.max = this->max;
+    stats.unchanged = this->unchanged;
+    stats.updateInterval = this->intervals == 0 ? 0 : float(this->intervalTotal) / this->intervals / 1000;
+    return stats;
+}
+
+void lemlib::ReadMonitor::reset() { *this = ReadMonitor(); }
@@ -0,0 +1,82 @@
+#include <cmath>
+#include "pros/error.h"
+#include "pros/rtos.hpp"
+#include "lemlib/chassis/relocalizer.hpp"
+
+// readings further than this, in inches, are too noisy to use. The sensor reads 9999 mm if it doesn't see anything
+constexpr float MAX_READING = 78;
+// readings with a lower confidence than this are ignored. Confidence is between 0 and 63
+constexpr int MIN_CONFIDENCE = 20;
+// millimeters in an inch
+constexpr float MM_PER_INCH = 25.4;
+
+lemlib::WallRelocalizer::WallRelocalizer(Odometry& odom, std::vector<DistanceSensor> sensors, FieldMap map,
+                                         RelocalizerSettings settings)
+    : odom(odom),
+      sensors(sensors),
+      map(map),
+      settings(settings) {}
+
+float lemlib::WallRelocalizer::measure(const DistanceSensor& sensor, float reading, Pose pose,
+                                       bool& correctsX) const {
+    const float s = std::sin(pose.theta);
+    const float c = std::cos(pose.theta);
+    // position of the sensor on the field, and the direction it faces
+    const float sensorX = pose.x + c * sensor.offset.x + s * sensor.offset.y;
+    const float sensorY = pose.y + c * sensor.offset.y - s * sensor.offset.x;
+    const float sinMount = std::sin(sensor.offset.theta);
+    const float cosMount = std::cos(sensor.offset.theta);
+    const float dirX = s * cosMount + c * sinMount;
+    const float dirY = c * cosMount - s * sinMount;
+    // distance to the walls the sensor faces. A sensor parallel to a wall never hits it
+    const float distX = std::fabs(dirX) < 1e-6 ? INFINITY : ((dirX > 0 ? map.maxX : map.minX) - sensorX) / dirX;
+    const float distY = std::fabs(dirY) < 1e-6 ? INFINITY : ((dirY > 0 ? map.maxY : map.minY) - sensorY) / dirY;
+    correctsX = distX < distY;
+    // near a corner the sensor could be seeing either wall
+    if (std::fabs(distX - distY) < this->settings.cornerMargin) return NAN;
+    // the sensor has to face the wall it hits nearly straight on
+    if (std::fabs(correctsX ? dirX : dirY) < std::cos(this->settings.maxIncidence)) return NAN;
+    // where the sensor would be if the reading is right, minus where odometry thinks it is
+    const float correction = correctsX ? (dirX > 0 ? map.maxX : map.minX) - dirX * reading - sensorX
+                                       : (dirY > 0 ? map.maxY : map.minY) - dirY * reading - sensorY;
+    if (std::fabs(correction) > this->settings.maxCorrection) return NAN;
+    return correction;
+}
+
+int lemlib::WallRelocalizer::update() {
+    const uint32_t now = pros::millis();
+    // the rest of the last correction would be applied twice
+    if (int32_t(now - this->settledTime) < 0) return 0;
+    // the readings were measured a little while ago, so compare them with where the robot was then. The drift of
+    // odometry changes slowly, so the correction it implies still holds now
+    const Pose pose = this->odom.getPoseAt(now - this->settings.latency, true);
+    float sumX = 0;
+    float sumY = 0;
+    float weightX = 0;
+    float weightY = 0;
+    int used = 0;
+    for (const DistanceSensor& sensor : this->sensors) {
+        const int32_t millimeters = sensor.sensor->get();
+        if (millimeters == PROS_ERR || sensor.sensor->get_confidence() < MIN_CONFIDENCE) continue;
+        const float reading = millimeters / MM_PER_INCH;
+        if (reading > MAX_READING) continue;
+        bool correctsX;
+        const float correction = this->measure(sensor, reading, pose, correctsX);
+        if (std::isnan(correction)) continue;
+        // more precise sensors count for more
+        const float weight = 1 / (sensor.stdDev * sensor.stdDev);
+        if (correctsX) {
+            sumX += weight * correction;
+            weightX += weight;
+        } else {
+            sumY += weight * correction;
+            weightY += weight;
+        }
+        used++;
+    }
+    if (used == 0) return 0;
+    this->odom.correctPosition(weightX > 0 ? sumX / weightX : 0, weightY > 0 ? sumY / weightY : 0,
+                               this->settings.blendTime);
+    this->settledTime = now + this->settings.blendTime + this->settings.latency;
+    return used;
+}
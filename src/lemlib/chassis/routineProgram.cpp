@@ -0,0 +1,317 @@
+#include "lemlib/binaryFile.hpp"
+#include "lemlib/chassis/routineProgram.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/path/bundle.hpp"
+#include "lemlib/path/pathCache.hpp"
+
+// written at the start of every program, "LMR" and the format version
+constexpr char HEADER[] = {'L', 'M', 'R', 1};
+// opcodes of the steps
+constexpr uint8_t MOVE_TO_POINT = 0x01;
+constexpr uint8_t MOVE_TO_POSE = 0x02;
+constexpr uint8_t TURN_TO_POINT = 0x03;
+constexpr uint8_t TURN_TO_HEADING = 0x04;
+constexpr uint8_t FOLLOW = 0x05;
+constexpr uint8_t SET_POSE = 0x06;
+constexpr uint8_t WAIT_DONE = 0x10;
+constexpr uint8_t WAIT_PROGRESS = 0x11;
+constexpr uint8_t DELAY = 0x12;
+constexpr uint8_t REQUIRE_TIME = 0x13;
+constexpr uint8_t ACTION = 0x20;
+constexpr uint8_t WAIT_FOR = 0x21;
+// flags of the steps
+constexpr uint8_t WAIT = 0x01;
+constexpr uint8_t BACKWARDS = 0x02;
+constexpr int DIRECTION_SHIFT = 2;
+constexpr uint8_t DIRECTION_MASK = 0x3;
+constexpr uint8_t TIME_OPTIMAL = 0x10;
+
+/**
+ * @brief Get the number of float32 numbers a step has, or -1 if the opcode isn't known
+ */
+static int argCount(uint8_t opcode) {
+    switch (opcode) {
+        case MOVE_TO_POINT: return 6;
+        case MOVE_TO_POSE: return 9;
+        case TURN_TO_POINT: return 6;
+        case TURN_TO_HEADING: return 5;
+        case FOLLOW: return 5;
+        case SET_POSE: return 3;
+        case WAIT_DONE: return 1;
+        case WAIT_PROGRESS: return 2;
+        case DELAY:
+        case REQUIRE_TIME: return 1;
+        case ACTION:
+        case WAIT_FOR: return 0;
+        default: return -1;
+    }
+}
+
+/**
+ * @brief Whether a step starts a motion
+ */
+static bool isMotion(uint8_t opcode) { return opcode >= MOVE_TO_POINT && opcode <= FOLLOW; }
+
+/**
+ * @brief Pack the flags of a step
+ */
+static uint8_t packFlags(bool wait, bool forwards = true,
+                         lemlib::AngularDirection direction = lemlib::AngularDirection::AUTO,
+                         bool timeOptimal = false) {
+    return (wait ? WAIT : 0) | (forwards ? 0 : BACKWARDS) | uint8_t(direction) << DIRECTION_SHIFT |
+           (timeOptimal ? TIME_OPTIMAL : 0);
+}
+
+namespace lemlib {
+RoutineProgram::RoutineProgram()
+    : data(HEADER, HEADER + sizeof(HEADER)) {}
+
+void RoutineProgram::add(uint8_t opcode, uint8_t flags, std::initializer_list<float> args) {
+    data.push_back(opcode);
+    data.push_back(flags);
+    for (float arg : args) put(data, arg);
+}
+
+RoutineProgram& RoutineProgram::moveToPoint(float x, float y, int timeout, MoveToPointParams params, bool wait) {
+    add(MOVE_TO_POINT, packFlags(wait, params.forwards),
+        {x, y, float(timeout), params.maxSpeed, params.minSpeed, params.earlyExitRange});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::moveToPose(float x, float y, float theta, int timeout, MoveToPoseParams params,
+                                           bool wait) {
+    add(MOVE_TO_POSE, packFlags(wait, params.forwards),
+        {x, y, theta, float(timeout), params.lead, params.horizontalDrift, params.maxSpeed, params.minSpeed,
+         params.earlyExitRange});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::turnToPoint(float x, float y, int timeout, TurnToPointParams params, bool wait) {
+    add(TURN_TO_POINT, packFlags(wait, params.forwards, params.direction, params.timeOptimal),
+        {x, y, float(timeout), float(params.maxSpeed), float(params.minSpeed), params.earlyExitRange});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::turnToHeading(float theta, int timeout, TurnToHeadingParams params, bool wait) {
+    add(TURN_TO_HEADING, packFlags(wait, true, params.direction, params.timeOptimal),
+        {theta, float(timeout), float(params.maxSpeed), float(params.minSpeed), params.earlyExitRange});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::follow(const std::string& file, float lookahead, int timeout, bool forwards,
+                                       FollowParams params, bool wait) {
+    if (file.size() > UINT8_MAX) {
+        infoSink()->error("Path file name {} is too long for a routine program! Skipping step", file);
+        return *this;
+    }
+    add(FOLLOW, packFlags(wait, forwards),
+        {lookahead, float(timeout), params.minSpeed, params.earlyExitRange, params.finishDistance});
+    data.push_back(file.size());
+    data.insert(data.end(), file.begin(), file.end());
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::setPose(float x, float y, float theta) {
+    add(SET_POSE, 0, {x, y, theta});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::action(std::string_view name) {
+    add(ACTION, 0, {});
+    put(data, pathNameHash(name));
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::waitUntilDone(int motion) {
+    add(WAIT_DONE, 0, {float(motion)});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::waitUntilProgress(int motion, float progress) {
+    add(WAIT_PROGRESS, 0, {float(motion), progress});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::delay(uint32_t time) {
+    add(DELAY, 0, {float(time)});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::requireTime(uint32_t time) {
+    add(REQUIRE_TIME, 0, {float(time)});
+    return *this;
+}
+
+RoutineProgram& RoutineProgram::waitFor(std::string_view name) {
+    add(WAIT_FOR, 0, {});
+    put(data, pathNameHash(name));
+    return *this;
+}
+
+void RoutineProgram::setAction(std::string_view name, std::function<void()> action) {
+    actions[pathNameHash(name)] = action;
+}
+
+void RoutineProgram::setCondition(std::string_view name, std::function<bool()> condition) {
+    conditions[pathNameHash(name)] = condition;
+}
+
+bool RoutineProgram::decode(const std::vector<uint8_t>& data, std::vector<Step>& steps) {
+    steps.clear();
+    if (data.size() < sizeof(HEADER) || std::memcmp(data.data(), HEADER, sizeof(HEADER)) != 0) return false;
+    size_t position = sizeof(HEADER);
+    while (position < data.size()) {
+        Step step;
+        if (!get(data, position, step.opcode) || !get(data, position, step.flags)) return false;
+        const int count = argCount(step.opcode);
+        if (count < 0) return false;
+        for (int i = 0; i < count; i++) {
+            if (!get(data, position, step.args[i])) return false;
+        }
+        if (step.opcode == ACTION || step.opcode == WAIT_FOR) {
+            if (!get(data, position, step.key)) return false;
+        } else if (step.opcode == FOLLOW) {
+            uint8_t length;
+            if (!get(data, position, length) || position + length > data.size()) return false;
+            step.file.assign(reinterpret_cast<const char*>(data.data() + position), length);
+            position += length;
+        }
+        steps.push_back(std::move(step));
+    }
+    return true;
+}
+
+bool RoutineProgram::prepare(Chassis& chassis, Routine& routine) const {
+    std::vector<Step> steps;
+    if (!decode(data, steps)) {
+        infoSink()->error("Routine program is corrupt!");
+        return false;
+    }
+    // everything is checked before any step is added, so a program that can't run doesn't leave half a routine
+    int motions = 0;
+    for (const Step& step : steps) {
+        if (isMotion(step.opcode)) motions++;
+        if (step.opcode == ACTION && actions.find(step.key) == actions.end()) {
+            infoSink()->error("Routine program calls an action that isn't registered!");
+            return false;
+        }
+        if (step.opcode == WAIT_FOR && conditions.find(step.key) == conditions.end()) {
+            infoSink()->error("Routine program waits for a condition that isn't registered!");
+            return false;
+        }
+        // a wait for a motion that never starts would wait forever. The index is checked as a float, since
+        // converting a float out of the range of an int is undefined
+        if (step.opcode == WAIT_DONE || step.opcode == WAIT_PROGRESS) {
+            const float index = step.args[0];
+            const bool started = index == -1 ? motions > 0 : index >= 0 && index < motions;
+            if (!started) {
+                infoSink()->error("Routine program waits for motion {}, which hasn't started by then!", index);
+                return false;
+            }
+        }
+        // parsed now, so following the path doesn't have to read the SD card
+        if (step.opcode == FOLLOW) {
+            const asset path = pathCache().file(step.file);
+            if (path.buf == nullptr || !chassis.preloadPath(path)) return false;
+        }
+    }
+
+    // the numbers are copied into each step, since the decoded steps are freed when this returns
+    Chassis* target = &chassis;
+    for (const Step& step : steps) {
+        const float* a = step.args;
+        const bool wait = step.flags & WAIT;
+        const bool forwards = !(step.flags & BACKWARDS);
+        const AngularDirection direction = AngularDirection(step.flags >> DIRECTION_SHIFT & DIRECTION_MASK);
+        const bool timeOptimal = step.flags & TIME_OPTIMAL;
+        std::function<MotionHandle()> motion;
+        switch (step.opcode) {
+            case MOVE_TO_POINT: {
+                const MoveToPointParams params {
+                    .forwards = forwards, .maxSpeed = a[3], .minSpeed = a[4], .earlyExitRange = a[5]};
+                const float x = a[0], y = a[1];
+                const int timeout = a[2];
+                motion = [=] { return target->moveToPoint(x, y, timeout, params); };
+                break;
+            }
+            case MOVE_TO_POSE: {
+                const MoveToPoseParams params {.forwards = forwards,
+                                               .horizontalDrift = a[5],
+                                               .lead = a[4],
+                                               .maxSpeed = a[6],
+                                               .minSpeed = a[7],
+                                               .earlyExitRange = a[8]};
+                const float x = a[0], y = a[1], theta = a[2];
+                const int timeout = a[3];
+                motion = [=] { return target->moveToPose(x, y, theta, timeout, params); };
+                break;
+            }
+            case TURN_TO_POINT: {
+                const TurnToPointParams params {.forwards = forwards,
+                                                .direction = direction,
+                                                .maxSpeed = int(a[3]),
+                                                .minSpeed = int(a[4]),
+                                                .earlyExitRange = a[5],
+                                                .timeOptimal = timeOptimal};
+                const float x = a[0], y = a[1];
+                const int timeout = a[2];
+                motion = [=] { return target->turnToPoint(x, y, timeout, params); };
+                break;
+            }
+            case TURN_TO_HEADING: {
+                const TurnToHeadingParams params {.direction = direction,
+                                                  .maxSpeed = int(a[2]),
+                                                  .minSpeed = int(a[3]),
+                                                  .earlyExitRange = a[4],
+                                                  .timeOptimal = timeOptimal};
+                const float theta = a[0];
+                const int timeout = a[1];
+                motion = [=] { return target->turnToHeading(theta, timeout, params); };
+                break;
+            }
+            case FOLLOW: {
+                const FollowParams params {.minSpeed = a[2], .earlyExitRange = a[3], .finishDistance = a[4]};
+                const std::string file = step.file;
+                const float lookahead = a[0];
+                const int timeout = a[1];
+                motion = [=] { return target->follow(file, lookahead, timeout, forwards, true, 0, params); };
+                break;
+            }
+            case SET_POSE: {
+                const Pose pose(a[0], a[1], a[2]);
+                routine.then([=] { target->setPose(pose); });
+                break;
+            }
+            case WAIT_DONE: routine.waitUntilDone(routine, int(a[0])); break;
+            case WAIT_PROGRESS: routine.waitUntilProgress(routine, int(a[0]), a[1]); break;
+            case DELAY: routine.delay(uint32_t(a[0])); break;
+            case REQUIRE_TIME: routine.requireTime(uint32_t(a[0])); break;
+            case ACTION: routine.then(actions.at(step.key)); break;
+            case WAIT_FOR: routine.waitFor(conditions.at(step.key)); break;
+        }
+        if (!motion) continue;
+        if (wait) routine.move(motion);
+        else routine.start(motion);
+    }
+    return true;
+}
+
+bool RoutineProgram::save(const std::string& path) const { return writeFile(path, data); }
+
+bool RoutineProgram::load(const std::string& path) {
+    std::vector<uint8_t> loaded = readFile(path);
+    if (loaded.empty()) {
+        infoSink()->error("Couldn't read {}!", path);
+        return false;
+    }
+    std::vector<Step> steps;
+    if (!decode(loaded, steps)) {
+        infoSink()->error("{} is not a routine program, or was made for a different version of LemLib!", path);
+        return false;
+    }
+    data = std::move(loaded);
+    return true;
+}
+
+const std::vector<uint8_t>& RoutineProgram::getData() const { return data; }
+} // namespace lemlib
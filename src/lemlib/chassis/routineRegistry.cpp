@@ -0,0 +1,142 @@
+#include "lemlib/chassis/routineRegistry.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/path/pathCache.hpp"
+
+// how often run checks whether the selected routine has been prepared, in milliseconds
+constexpr uint32_t READY_POLL = 5;
+
+namespace lemlib {
+RoutineRegistry::RoutineRegistry(Chassis& chassis)
+    : chassis(chassis) {}
+
+RoutineRegistry& RoutineRegistry::add(std::string name, std::function<void()> routine, RoutinePaths paths,
+                                      FieldTransform transform) {
+    Entry entry;
+    entry.name = std::move(name);
+    entry.routine = std::move(routine);
+    entry.paths = std::move(paths);
+    entry.transform = transform;
+    entries.push_back(std::move(entry));
+    return *this;
+}
+
+RoutineRegistry& RoutineRegistry::addProgram(std::string name, RoutineProgram& program, std::string file,
+                                             FieldTransform transform) {
+    Entry entry;
+    entry.name = std::move(name);
+    entry.program = &program;
+    entry.file = std::move(file);
+    entry.transform = transform;
+    entries.push_back(std::move(entry));
+    return *this;
+}
+
+bool RoutineRegistry::select(size_t index) {
+    if (index >= entries.size()) return false;
+    // the paths are loaded in the transform of the routine, so it is set before they are
+    chassis.setFieldTransform(entries[index].transform);
+    mutex.take();
+    selected = index;
+    // runs below the motion task, like the task that prefetches path files
+    if (task == nullptr) {
+        task = new pros::Task {[this] {
+            while (true) {
+                // sleep until a routine is selected
+                pros::Task::notify_take(true, TIMEOUT_MAX);
+                while (true) {
+                    mutex.take();
+                    const std::optional<size_t> target = selected;
+                    if (target == ready) {
+                        mutex.give();
+                        break;
+                    }
+                    mutex.give();
+                    prepare(entries[*target]);
+                    // a routine selected while this one was prepared is prepared next
+                    mutex.take();
+                    ready = target;
+                    mutex.give();
+                }
+            }
+        }, TASK_PRIORITY_DEFAULT - 1};
+    }
+    mutex.give();
+    task->notify();
+    return true;
+}
+
+bool RoutineRegistry::select(std::string_view name) {
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].name == name) return select(i);
+    }
+    infoSink()->warn("There is no routine named {}!", name);
+    return false;
+}
+
+bool RoutineRegistry::prepare(Entry& entry) {
+    const uint32_t start = pros::millis();
+    bool success = true;
+    if (entry.program != nullptr) {
+        // prepared into a new routine, so the one that was prepared before is never half replaced
+        auto routine = std::make_unique<Routine>();
+        success = entry.program->load(entry.file) && entry.program->prepare(chassis, *routine);
+        mutex.take();
+        entry.prepared = success ? std::move(routine) : nullptr;
+        mutex.give();
+    }
+    for (const asset& path : entry.paths.paths) success = chassis.preloadPath(path) && success;
+    for (const std::string& file : entry.paths.files) {
+        const asset path = pathCache().file(file);
+        success = path.buf != nullptr && chassis.preloadPath(path) && success;
+    }
+    for (const asset& path : entry.paths.trajectories) success = chassis.preloadTrajectory(path, true) && success;
+    for (const asset& path : entry.paths.reversedTrajectories) {
+        success = chassis.preloadTrajectory(path, false) && success;
+    }
+    if (success) infoSink()->info("Prepared routine {} in {} ms", entry.name, pros::millis() - start);
+    else infoSink()->warn("Prepared routine {}, but some of it couldn't be loaded", entry.name);
+    return success;
+}
+
+std::optional<size_t> RoutineRegistry::getSelected() const {
+    mutex.take();
+    const std::optional<size_t> index = selected;
+    mutex.give();
+    return index;
+}
+
+bool RoutineRegistry::isReady() const {
+    mutex.take();
+    const bool isReady = selected.has_value() && ready == selected;
+    mutex.give();
+    return isReady;
+}
+
+bool RoutineRegistry::run() {
+    if (!getSelected()) {
+        infoSink()->warn("No routine is selected! Skipping autonomous");
+        return false;
+    }
+    // usually prepared long before autonomous starts
+    while (!isReady()) pros::delay(READY_POLL);
+    const std::optional<size_t> index = getSelected();
+    Entry& entry = entries[*index];
+    if (entry.program == nullptr) {
+        entry.routine();
+        return true;
+    }
+    mutex.take();
+    Routine* routine = entry.prepared.get();
+    mutex.give();
+    if (routine == nullptr) {
+        infoSink()->error("Routine {} couldn't be prepared! Skipping autonomous", entry.name);
+        return false;
+    }
+    routine->run();
+    return true;
+}
+
+size_t RoutineRegistry::size() const { return entries.size(); }
+
+std::string RoutineRegistry::getName(size_t index) const { return index < entries.size() ? entries[index].name : ""; }
+} // namespace lemlib
@@ -0,0 +1,195 @@
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include "lemlib/chassis/sensorLog.hpp"
+#include "lemlib/binaryFile.hpp"
+
+// written at the start of every file, "LSL" and the format version
+constexpr char HEADER[] = {'L', 'S', 'L', 1};
+
+// the readings of a frame, in the order of their bits in the mask
+constexpr float lemlib::SensorFrame::*READINGS[] = {
+    &lemlib::SensorFrame::vertical1, &lemlib::SensorFrame::vertical2, &lemlib::SensorFrame::horizontal1,
+    &lemlib::SensorFrame::horizontal2, &lemlib::SensorFrame::imu};
+// the velocities of a frame, in the order of their bits in the mask
+constexpr float lemlib::SensorFrame::*VELOCITIES[] = {
+    &lemlib::SensorFrame::vertical1Velocity, &lemlib::SensorFrame::vertical2Velocity,
+    &lemlib::SensorFrame::horizontal1Velocity, &lemlib::SensorFrame::horizontal2Velocity,
+    &lemlib::SensorFrame::imuVelocity};
+// the times the readings were read, in the order of their bits in the mask
+constexpr uint64_t lemlib::SensorFrame::*TIMES[] = {
+    &lemlib::SensorFrame::vertical1Time, &lemlib::SensorFrame::vertical2Time, &lemlib::SensorFrame::horizontal1Time,
+    &lemlib::SensorFrame::horizontal2Time, &lemlib::SensorFrame::imuTime};
+// number of fields of each kind in a frame
+constexpr int FIELDS = 5;
+
+// largest record, a START with every field of the frame
+constexpr size_t MAX_RECORD = 1 + 3 * 8 + 8 + 4 + 8 + 2 + 3 * FIELDS * 4;
+
+/**
+ * @brief Write a value, little endian. The V5 is little endian, so the bytes are copied directly
+ */
+template <typename T> static uint8_t* put(uint8_t* out, T value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+/**
+ * @brief Write a frame, leaving out fields that have their default value
+ */
+static uint8_t* putFrame(uint8_t* out, const lemlib::SensorFrame& frame) {
+    out = put(out, frame.time);
+    uint8_t* maskOut = out;
+    out += sizeof(uint16_t);
+    uint16_t mask = 0;
+    for (int i = 0; i < FIELDS; i++) {
+        const float reading = frame.*READINGS[i];
+        // compare the bits, so -0 isn't mistaken for 0
+        uint32_t bits;
+        std::memcpy(&bits, &reading, sizeof(bits));
+        if (bits == 0) continue;
+        mask |= 1 << i;
+        out = put(out, reading);
+    }
+    for (int i = 0; i < FIELDS; i++) {
+        if (std::isnan(frame.*VELOCITIES[i])) continue;
+        mask |= 1 << (FIELDS + i);
+        out = put(out, frame.*VELOCITIES[i]);
+    }
+    for (int i = 0; i < FIELDS; i++) {
+        if (frame.*TIMES[i] == 0) continue;
+        mask |= 1 << (2 * FIELDS + i);
+        out = put(out, int32_t(frame.time - frame.*TIMES[i]));
+    }
+    put(maskOut, mask);
+    return out;
+}
+
+/**
+ * @brief Reads values from a buffer, without reading past its end
+ */
+class Cursor {
+    public:
+        Cursor(const std::vector<uint8_t>& data, size_t position)
+            : data(data),
+              position(position) {}
+
+        /**
+         * @brief Read a value, little endian
+         *
+         * @return false there aren't enough bytes left
+         */
+        template <typename T> bool get(T& value) {
+            if (data.size() - position < sizeof(value)) return false;
+            std::memcpy(&value, data.data() + position, sizeof(value));
+            position += sizeof(value);
+            return true;
+        }
+
+        /**
+         * @brief Read a frame written by putFrame
+         *
+         * @return false there aren't enough bytes left
+         */
+        bool getFrame(lemlib::SensorFrame& frame) {
+            frame = lemlib::SensorFrame {0, 0, 0, 0, 0, 0};
+            uint16_t mask;
+            if (!get(frame.time) || !get(mask)) return false;
+            for (int i = 0; i < FIELDS; i++) {
+                if (mask & (1 << i) && !get(frame.*READINGS[i])) return false;
+            }
+            for (int i = 0; i < FIELDS; i++) {
+                if (mask & (1 << (FIELDS + i)) && !get(frame.*VELOCITIES[i])) return false;
+            }
+            for (int i = 0; i < FIELDS; i++) {
+                int32_t age;
+                if (!(mask & (1 << (2 * FIELDS + i)))) continue;
+                if (!get(age)) return false;
+                frame.*TIMES[i] = frame.time - age;
+            }
+            return true;
+        }
+
+        const std::vector<uint8_t>& data;
+        size_t position;
+};
+
+/**
+ * @brief Write a record
+ *
+ * @return size_t the size of the record, in bytes. At most MAX_RECORD
+ */
+static size_t putRecord(uint8_t* buffer, const lemlib::SensorRecord& record) {
+    uint8_t* out = put(buffer, uint8_t(record.type));
+    switch (record.type) {
+        case lemlib::SensorRecordType::START:
+            out = put(put(put(out, record.x), record.y), record.theta);
+            out = put(put(out, record.prevUpdateTime), record.period);
+            out = putFrame(out, record.frame);
+            break;
+        case lemlib::SensorRecordType::FRAME: out = putFrame(out, record.frame); break;
+        case lemlib::SensorRecordType::POSE:
+            out = put(put(put(out, float(record.x)), float(record.y)), float(record.theta));
+    }
+    return out - buffer;
+}
+
+namespace lemlib {
+SensorLog::SensorLog(const std::string& name, size_t maxFileSize)
+    : writer(name, "lsl", maxFileSize, std::string(HEADER, sizeof(HEADER))) {}
+
+void SensorLog::record(const SensorRecord& record) {
+    uint8_t buffer[MAX_RECORD];
+    const size_t size = putRecord(buffer, record);
+    writer.write({std::string_view(reinterpret_cast<const char*>(buffer), size)});
+}
+
+uint32_t SensorLog::getDropped() const { return writer.getDropped(); }
+
+void SensorLog::append(const SensorRecord& record, std::vector<uint8_t>& log) {
+    if (log.empty()) log.assign(HEADER, HEADER + sizeof(HEADER));
+    uint8_t buffer[MAX_RECORD];
+    const size_t size = putRecord(buffer, record);
+    log.insert(log.end(), buffer, buffer + size);
+}
+
+SensorLogReader::SensorLogReader(const std::string& path)
+    : SensorLogReader(readFile(path)) {}
+
+SensorLogReader::SensorLogReader(std::vector<uint8_t> data)
+    : data(std::move(data)) {
+    valid = this->data.size() >= sizeof(HEADER) && std::memcmp(this->data.data(), HEADER, sizeof(HEADER)) == 0;
+    position = sizeof(HEADER);
+}
+
+bool SensorLogReader::isValid() const { return valid; }
+
+bool SensorLogReader::next(SensorRecord& record) {
+    if (!valid) return false;
+    Cursor cursor(data, position);
+    uint8_t type;
+    if (!cursor.get(type)) return false;
+    record = SensorRecord {SensorRecordType(type)};
+    bool complete;
+    switch (record.type) {
+        case SensorRecordType::START:
+            complete = cursor.get(record.x) && cursor.get(record.y) && cursor.get(record.theta) &&
+                       cursor.get(record.prevUpdateTime) && cursor.get(record.period) && cursor.getFrame(record.frame);
+            break;
+        case SensorRecordType::FRAME: complete = cursor.getFrame(record.frame); break;
+        case SensorRecordType::POSE: {
+            float x = 0, y = 0, theta = 0;
+            complete = cursor.get(x) && cursor.get(y) && cursor.get(theta);
+            record.x = x;
+            record.y = y;
+            record.theta = theta;
+            break;
+        }
+        // an unknown record can't be skipped, since its size is unknown
+        default: complete = false;
+    }
+    if (!complete) return false;
+    position = cursor.position;
+    return true;
+}
+} // namespace lemlib
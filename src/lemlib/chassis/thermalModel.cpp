@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+#include "pros/error.h"
+#include "lemlib/chassis/thermalModel.hpp"
+
+// the motors report their temperature in steps of this many °C
+constexpr float TEMPERATURE_STEP = 5;
+// how long the current is averaged over for the prediction, in seconds
+constexpr float CURRENT_AVERAGING = 1;
+
+lemlib::ThermalModel::ThermalModel(pros::MotorGroup* left, pros::MotorGroup* right, ThermalSettings settings)
+    : left(left),
+      right(right),
+      settings(settings),
+      motors(left->size() + right->size()) {}
+
+float lemlib::ThermalModel::getScale() {
+    const uint32_t now = pros::millis();
+    // if another task is updating the estimate, use the last one instead of waiting
+    if ((!this->updated || now - this->lastUpdate >= this->settings.period) && this->mutex.take(0)) {
+        this->update(now);
+        this->mutex.give();
+    }
+    return this->reading.scale;
+}
+
+lemlib::ThermalReading lemlib::ThermalModel::getReading() { return this->reading; }
+
+pros::Motor& lemlib::ThermalModel::getMotor(size_t index) {
+    const size_t leftCount = this->left->size();
+    return index < leftCount ? (*this->left)[index] : (*this->right)[index - leftCount];
+}
+
+void lemlib::ThermalModel::update(uint32_t now) {
+    const float dt = this->updated ? (now - this->lastUpdate) / 1000.0f : 0;
+    const bool readTemperature = !this->updated || now - this->lastTemperatureRead >= this->settings.temperaturePeriod;
+    if (readTemperature) this->lastTemperatureRead = now;
+    const bool first = !this->updated;
+    this->lastUpdate = now;
+    this->updated = true;
+
+    // the first temperatures are taken as the ambient temperature, since the motors start cool
+    if (first) {
+        float coolest = INFINITY;
+        for (size_t i = 0; i < this->motors.size(); i++) {
+            const double temperature = this->getMotor(i).get_temperature();
+            if (std::isfinite(temperature)) coolest = std::fmin(coolest, temperature);
+        }
+        if (std::isfinite(coolest)) this->ambient = coolest;
+        for (MotorState& state : this->motors) state.temperature = this->ambient;
+    }
+
+    ThermalReading reading;
+    reading.hottest = -INFINITY;
+    reading.predicted = -INFINITY;
+    const float averaging = std::fmin(dt / CURRENT_AVERAGING, 1);
+    for (size_t i = 0; i < this->motors.size(); i++) {
+        MotorState& state = this->motors[i];
+        pros::Motor& motor = this->getMotor(i);
+        // heat grows with the square of the current, and is lost in proportion to how much hotter than the air the
+        // motor is. A current that couldn't be read heats the motor like the last one did
+        const int32_t current = motor.get_current_draw();
+        if (current != PROS_ERR) {
+            const float amps = current / 1000.0f;
+            state.heatRate += (this->settings.heating * amps * amps - state.heatRate) * averaging;
+        }
+        const float cooling = (state.temperature - this->ambient) / this->settings.coolingTime;
+        state.temperature += (state.heatRate - cooling) * dt;
+        // the reported temperature is coarse, but it stops the estimate drifting away from the motor
+        if (readTemperature) {
+            const double measured = motor.get_temperature();
+            if (std::isfinite(measured)) {
+                state.temperature = std::clamp(state.temperature, float(measured) - TEMPERATURE_STEP / 2,
+                                               float(measured) + TEMPERATURE_STEP / 2);
+            }
+        }
+        // where the temperature is heading if the current stays the same. A cooling motor keeps its current
+        // temperature, since the firmware limits by the temperature the motor is at
+        const float predicted = std::fmax(state.temperature + (state.heatRate - cooling) * this->settings.lookahead,
+                                          state.temperature);
+        reading.hottest = std::fmax(reading.hottest, state.temperature);
+        reading.predicted = std::fmax(reading.predicted, predicted);
+    }
+    if (this->motors.empty()) reading.hottest = reading.predicted = this->ambient;
+
+    // the limits fall evenly from the start of derating to the end
+    const float range = std::fmax(this->settings.deratingEnd - this->settings.deratingStart, 1e-3f);
+    const float progress = std::clamp((reading.predicted - this->settings.deratingStart) / range, 0.0f, 1.0f);
+    reading.scale = 1 - (1 - std::clamp(this->settings.minScale, 0.0f, 1.0f)) * progress;
+    this->reading = reading;
+}
@@ -2,6 +2,7 @@
 #include "lemlib/chassis/trackingWheel.hpp"
 #include "lemlib/util.hpp"
 #include "pros/llemu.hpp"
+#include "pros/rtos.hpp"
 
 lemlib::TrackingWheel::TrackingWheel(pros::ADIEncoder* encoder, float wheelDiameter, float distance, float gearRatio) {
     this->encoder = encoder;
@@ -23,35 +24,79 @@ lemlib::TrackingWheel::TrackingWheel(pros::Motor_Group* motors, float wheelDiame
     this->diameter = wheelDiameter;
     this->distance = distance;
     this->rpm = rpm;
+    this->cacheMotorRatios();
+}
+
+void lemlib::TrackingWheel::cacheMotorRatios() {
+    // the gearsets don't change while the program is running, so they only need to be read once
+    const std::vector<pros::motor_gearset_e_t> gearsets = this->motors->get_gearing();
+    this->motorRatios.resize(gearsets.size());
+    for (size_t i = 0; i < this->motorRatios.size(); i++) {
+        float in;
+        switch (gearsets[i]) {
+            case pros::E_MOTOR_GEARSET_36: in = 100; break;
+            case pros::E_MOTOR_GEARSET_18: in = 200; break;
+            case pros::E_MOTOR_GEARSET_06: in = 600; break;
+            default: in = 200; break;
+        }
+        this->motorRatios[i] = (diameter * M_PI) * (rpm / in);
+    }
 }
 
 void lemlib::TrackingWheel::reset() {
     if (this->encoder != nullptr) this->encoder->reset();
     if (this->rotation != nullptr) this->rotation->reset_position();
-    if (this->motors != nullptr) this->motors->tare_position();
+    if (this->motors != nullptr) {
+        this->motors->tare_position();
+        // motors may have been plugged in since the tracking wheel was created
+        this->cacheMotorRatios();
+    }
+}
+
+void lemlib::TrackingWheel::setDataRate(uint32_t rate) {
+    if (this->rotation != nullptr) this->rotation->set_data_rate(rate);
 }
 
 float lemlib::TrackingWheel::getDistanceTraveled() {
+    const uint64_t start = pros::micros();
+    const float distance = this->readDistance();
+    this->readMonitor.record(start, pros::micros(), distance);
+    return distance;
+}
+
+float lemlib::TrackingWheel::readDistance() {
     if (this->encoder != nullptr) {
         return (float(this->encoder->get_value()) * this->diameter * M_PI / 360) / this->gearRatio;
     } else if (this->rotation != nullptr) {
         return (float(this->rotation->get_position()) * this->diameter * M_PI / 36000) / this->gearRatio;
     } else if (this->motors != nullptr) {
-        // get distance traveled by each motor
-        std::vector<pros::motor_gearset_e_t> gearsets = this->motors->get_gearing();
-        std::vector<double> positions = this->motors->get_positions();
-        std::vector<float> distances;
-        for (int i = 0; i < this->motors->size(); i++) {
-            float in;
-            switch (gearsets[i]) {
-                case pros::E_MOTOR_GEARSET_36: in = 100; break;
-                case pros::E_MOTOR_GEARSET_18: in = 200; break;
-                case pros::E_MOTOR_GEARSET_06: in = 600; break;
-                default: in = 200; break;
-            }
-            distances.push_back(positions[i] * (diameter * M_PI) * (rpm / in));
+        // average the distance traveled by each motor
+        // each motor is read directly so no vectors are allocated
+        if (this->motorRatios.empty()) return 0;
+        float sum = 0;
+        for (size_t i = 0; i < this->motorRatios.size(); i++) {
+            sum += float((*this->motors)[i].get_position()) * this->motorRatios[i];
+        }
+        return sum / this->motorRatios.size();
+    } else {
+        return 0;
+    }
+}
+
+float lemlib::TrackingWheel::getVelocity() {
+    if (this->encoder != nullptr) {
+        return NAN;
+    } else if (this->rotation != nullptr) {
+        // the rotation sensor measures velocity in centidegrees per second
+        return (float(this->rotation->get_velocity()) * this->diameter * M_PI / 36000) / this->gearRatio;
+    } else if (this->motors != nullptr) {
+        // average the velocity of each motor, which is measured in rpm
+        if (this->motorRatios.empty()) return 0;
+        float sum = 0;
+        for (size_t i = 0; i < this->motorRatios.size(); i++) {
+            sum += float((*this->motors)[i].get_actual_velocity()) * this->motorRatios[i] / 60;
         }
-        return lemlib::avg(distances);
+        return sum / this->motorRatios.size();
     } else {
         return 0;
     }
@@ -59,7 +104,21 @@ float lemlib::TrackingWheel::getDistanceTraveled() {
 
 float lemlib::TrackingWheel::getOffset() { return this->distance; }
 
+void lemlib::TrackingWheel::setOffset(float offset) { this->distance = offset; }
+
+float lemlib::TrackingWheel::getDiameter() { return this->diameter; }
+
+void lemlib::TrackingWheel::setDiameter(float diameter) {
+    this->diameter = diameter;
+    // the motor ratios include the diameter
+    if (this->motors != nullptr) this->cacheMotorRatios();
+}
+
 int lemlib::TrackingWheel::getType() {
     if (this->motors != nullptr) return 1;
     return 0;
 }
+
+lemlib::ReadStats lemlib::TrackingWheel::getReadStats() { return this->readMonitor.getStats(); }
+
+void lemlib::TrackingWheel::resetReadStats() { this->readMonitor.reset(); }
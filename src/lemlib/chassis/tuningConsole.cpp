@@ -0,0 +1,102 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include "lemlib/chassis/tuningConsole.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+
+// longest command that can be read, including the newline
+constexpr size_t MAX_LINE = 96;
+// longest name of a tuning value. Matches the width in the format string of run
+constexpr size_t MAX_NAME = 47;
+
+lemlib::TuningConsole::TuningConsole(Chassis& chassis, ConfigStore* config)
+    : chassis(chassis),
+      config(config) {}
+
+void lemlib::TuningConsole::start() {
+    if (this->task != nullptr) return;
+    // waiting for a line takes no time from the other tasks, so the lowest priority is enough
+    this->task = new pros::Task {[this] { this->readCommands(); }, TASK_PRIORITY_MIN + 1};
+}
+
+void lemlib::TuningConsole::readCommands() {
+    char line[MAX_LINE];
+    while (true) {
+        // blocks this task until a line arrives
+        if (std::fgets(line, sizeof(line), stdin) != nullptr) this->run(line);
+        else pros::delay(50);
+    }
+}
+
+bool lemlib::TuningConsole::run(const char* line) {
+    // stamped before the line is parsed, so a sync request is timed as close to its arrival as possible
+    const uint64_t receiveTime = pros::micros();
+    char command[16];
+    char name[MAX_NAME + 1];
+    float value;
+    const int fields = std::sscanf(line, "%15s %47s %f", command, name, &value);
+    if (fields < 1) return false;
+    if (std::strcmp(command, "telemetry") == 0 && fields >= 2) return this->setTelemetry(line);
+    if (std::strcmp(command, "sync") == 0) return this->sync(line, receiveTime);
+    if (std::strcmp(command, "set") == 0 && fields == 3) {
+        if (!this->chassis.setParameter(name, value)) {
+            std::printf("can't set %s\n", name);
+            return false;
+        }
+        std::printf("%s = %g\n", name, value);
+        return true;
+    }
+    if (std::strcmp(command, "get") == 0 && fields >= 2) {
+        const std::optional<float> current = this->chassis.getParameter(name);
+        if (!current) {
+            std::printf("no value named %s\n", name);
+            return false;
+        }
+        std::printf("%s = %g\n", name, *current);
+        return true;
+    }
+    if (std::strcmp(command, "save") == 0) {
+        const bool saved = this->config != nullptr && this->chassis.saveConfig(*this->config);
+        std::printf(saved ? "saved\n" : "couldn't save\n");
+        return saved;
+    }
+    std::printf("commands: set <name> <value>, get <name>, save, telemetry [channel] <on|off> [period], "
+                "sync <sequence> <host time>\n");
+    return false;
+}
+
+bool lemlib::TuningConsole::setTelemetry(const char* line) {
+    char first[16];
+    char second[4];
+    unsigned period = 0;
+    const int fields = std::sscanf(line, "%*s %15s %3s %u", first, second, &period);
+    // telemetry on, or telemetry off, switches all of binary telemetry
+    if (fields == 1 && (std::strcmp(first, "on") == 0 || std::strcmp(first, "off") == 0)) {
+        binaryTelemetry().setEnabled(std::strcmp(first, "on") == 0);
+        std::printf("telemetry %s\n", first);
+        return true;
+    }
+    if (fields < 2 || (std::strcmp(second, "on") != 0 && std::strcmp(second, "off") != 0)) {
+        std::printf("telemetry [odom|motion|motors|pid|path] <on|off> [period]\n");
+        return false;
+    }
+    if (!binaryTelemetry().setChannel(first, std::strcmp(second, "on") == 0, period)) {
+        std::printf("no telemetry channel named %s\n", first);
+        return false;
+    }
+    if (period > 0) std::printf("telemetry %s %s every %u ms\n", first, second, period);
+    else std::printf("telemetry %s %s\n", first, second);
+    return true;
+}
+
+bool lemlib::TuningConsole::sync(const char* line, uint64_t receiveTime) {
+    uint32_t sequence;
+    uint64_t hostTime;
+    if (std::sscanf(line, "%*s %" SCNu32 " %" SCNu64, &sequence, &hostTime) != 2) {
+        std::printf("sync <sequence> <host time>\n");
+        return false;
+    }
+    binaryTelemetry().sendClockSync(sequence, hostTime, receiveTime);
+    return true;
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/configStore.hpp"
+#include "lemlib/logger/logger.hpp"
+
+uint32_t lemlib::crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Find where an entry with a key is, or would be inserted
+ */
+static std::vector<lemlib::ConfigEntry>::const_iterator findEntry(const std::vector<lemlib::ConfigEntry>& entries,
+                                                                  uint32_t key) {
+    return std::lower_bound(entries.begin(), entries.end(), key,
+                            [](const lemlib::ConfigEntry& entry, uint32_t key) { return entry.key < key; });
+}
+
+lemlib::ConfigStore::ConfigStore(const std::string& path)
+    : path(path) {}
+
+bool lemlib::ConfigStore::load() {
+    const uint64_t start = pros::micros();
+    if (!pros::usd::is_installed()) return false;
+    FILE* file = fopen(this->path.c_str(), "rb");
+    if (file == nullptr) return false;
+    ConfigHeader header;
+    std::vector<ConfigEntry> entries;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && header.magic == CONFIG_MAGIC &&
+                 header.version == CONFIG_VERSION;
+    if (valid) {
+        entries.resize(header.count);
+        valid = fread(entries.data(), sizeof(ConfigEntry), header.count, file) == header.count;
+    }
+    fclose(file);
+    if (!valid) {
+        infoSink()->error("{} is not a config file, or was made for a different version of LemLib!", this->path);
+        return false;
+    }
+    if (crc32(reinterpret_cast<const uint8_t*>(entries.data()), entries.size() * sizeof(ConfigEntry)) !=
+        header.checksum) {
+        infoSink()->error("{} is corrupt! Using the values in the program", this->path);
+        return false;
+    }
+    // files written by another tool might not be sorted
+    std::sort(entries.begin(), entries.end(), [](const ConfigEntry& a, const ConfigEntry& b) { return a.key < b.key; });
+    this->entries = std::move(entries);
+    infoSink()->debug("Loaded {} config values from {} in {} us", this->entries.size(), this->path,
+                      pros::micros() - start);
+    return true;
+}
+
+bool lemlib::ConfigStore::save() const {
+    if (!pros::usd::is_installed()) return false;
+    // a write that is cut off leaves entries that don't match the checksum, so load rejects them
+    const ConfigHeader header {
+        CONFIG_MAGIC, CONFIG_VERSION, uint16_t(this->entries.size()),
+        crc32(reinterpret_cast<const uint8_t*>(this->entries.data()), this->entries.size() * sizeof(ConfigEntry))};
+    std::vector<uint8_t> data(sizeof(header) + this->entries.size() * sizeof(ConfigEntry));
+    std::memcpy(data.data(), &header, sizeof(header));
+    std::memcpy(data.data() + sizeof(header), this->entries.data(), this->entries.size() * sizeof(ConfigEntry));
+    FILE* file = fopen(this->path.c_str(), "wb");
+    if (file == nullptr) {
+        infoSink()->error("Couldn't write {}!", this->path);
+        return false;
+    }
+    const bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+    if (!written) infoSink()->error("Couldn't write {}!", this->path);
+    return written;
+}
+
+std::optional<float> lemlib::ConfigStore::get(std::string_view key) const {
+    const uint32_t hash = configKeyHash(key);
+    const auto entry = findEntry(this->entries, hash);
+    if (entry == this->entries.end() || entry->key != hash) return std::nullopt;
+    return entry->value;
+}
+
+float lemlib::ConfigStore::get(std::string_view key, float fallback) const { return this->get(key).value_or(fallback); }
+
+void lemlib::ConfigStore::set(std::string_view key, float value) {
+    const uint32_t hash = configKeyHash(key);
+    const auto entry = findEntry(this->entries, hash);
+    if (entry != this->entries.end() && entry->key == hash) {
+        this->entries[entry - this->entries.begin()].value = value;
+        return;
+    }
+    this->entries.insert(entry, {hash, value});
+}
+
+size_t lemlib::ConfigStore::size() const { return this->entries.size(); }
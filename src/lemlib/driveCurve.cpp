@@ -1,23 +1,12 @@
 #include "lemlib/util.hpp"
-#include <cmath>
 
 namespace lemlib {
-ExpoDriveCurve::ExpoDriveCurve(float deadband, float minOutput, float curve)
-    : deadband(deadband),
-      minOutput(minOutput),
-      curveGain(curve) {}
-
 float ExpoDriveCurve::curve(float input) {
-    // return 0 if input is within deadzone
-    if (fabs(input) <= deadband) return 0;
-    // g is the output of g(x) as defined in the Desmos graph
-    const float g = fabs(input) - deadband;
-    // g127 is the output of g(127) as defined in the Desmos graph
-    const float g127 = 127 - deadband;
-    // i is the output of i(x) as defined in the Desmos graph
-    const float i = pow(curveGain, g - 127) * g * sgn(input);
-    // i127 is the output of i(127) as defined in the Desmos graph
-    const float i127 = pow(curveGain, g127 - 127) * g127;
-    return (127.0 - minOutput) / (127) * i * 127 / i127 + minOutput * sgn(input);
+    // inputs from a joystick are whole numbers in the table. Anything else is calculated
+    if (input >= -JOYSTICK_RANGE && input <= JOYSTICK_RANGE) {
+        const int index = int(input);
+        if (index == input) return table[index + JOYSTICK_RANGE];
+    }
+    return compute(input);
 }
 } // namespace lemlib
\ No newline at end of file
@@ -9,16 +9,37 @@ ExitCondition::ExitCondition(const float range, const int time)
 
 bool ExitCondition::getExit() { return done; }
 
-bool ExitCondition::update(const float input) {
-    const int curTime = pros::millis();
-    if (std::fabs(input) > range) startTime = -1;
-    else if (startTime == -1) startTime = curTime;
-    else if (curTime >= startTime + time) done = true;
+bool ExitCondition::update(const float input) { return update(input, pros::micros()); }
+
+bool ExitCondition::update(const float input, const uint64_t now) {
+    if (std::fabs(input) > range) startTime = 0;
+    else if (startTime == 0) startTime = now;
+    else if (now >= startTime + uint64_t(time) * 1000) done = true;
     return done;
 }
 
+bool ExitCondition::update(const float input, const float velocity, const float predictedInput) {
+    return update(input, velocity, predictedInput, pros::micros());
+}
+
+bool ExitCondition::update(const float input, const float velocity, const float predictedInput,
+                           const uint64_t now) {
+    // the robot has stopped, or will stop, in range, so there is no need to wait out the timeout
+    if (maxVelocity > 0 && std::fabs(input) <= range && std::fabs(predictedInput) <= range &&
+        std::fabs(velocity) <= maxVelocity)
+        done = true;
+    return update(input, now);
+}
+
+void ExitCondition::setVelocityExit(const float maxVelocity) { this->maxVelocity = std::fabs(maxVelocity); }
+
+void ExitCondition::setThreshold(const float range, const int time) {
+    this->range = range;
+    this->time = time;
+}
+
 void ExitCondition::reset() {
-    startTime = -1;
+    startTime = 0;
     done = false;
 }
 } // namespace lemlib
\ No newline at end of file
@@ -0,0 +1,17 @@
+#include "lemlib/feedforward.hpp"
+#include "lemlib/util.hpp"
+
+lemlib::Feedforward::Feedforward(float kS, float kV, float kA)
+    : kS(kS),
+      kV(kV),
+      kA(kA) {}
+
+float lemlib::Feedforward::calculate(float velocity, float acceleration) const {
+    // static friction opposes the direction of motion, or the direction of acceleration when starting from rest
+    float direction = 0;
+    if (velocity != 0) direction = sgn(velocity);
+    else if (acceleration != 0) direction = sgn(acceleration);
+    return kS * direction + kV * velocity + kA * acceleration;
+}
+
+bool lemlib::Feedforward::isEnabled() const { return kV != 0; }
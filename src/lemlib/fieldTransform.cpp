@@ -0,0 +1,40 @@
+#include <cmath>
+#include "lemlib/fieldTransform.hpp"
+#include "lemlib/util.hpp"
+
+lemlib::FieldTransform::FieldTransform(bool mirrorX, bool mirrorY, float rotation)
+    : mirrorX(mirrorX),
+      mirrorY(mirrorY),
+      rotation(rotation) {}
+
+bool lemlib::FieldTransform::isIdentity() const { return !this->mirrorX && !this->mirrorY && this->rotation == 0; }
+
+bool lemlib::FieldTransform::flipsHandedness() const { return this->mirrorX != this->mirrorY; }
+
+lemlib::Pose lemlib::FieldTransform::apply(Pose pose) const {
+    const float x = this->mirrorX ? -pose.x : pose.x;
+    const float y = this->mirrorY ? -pose.y : pose.y;
+    // clockwise, like headings
+    const float s = std::sin(degToRad(this->rotation));
+    const float c = std::cos(degToRad(this->rotation));
+    return Pose(x * c + y * s, y * c - x * s, this->applyHeading(pose.theta));
+}
+
+float lemlib::FieldTransform::applyHeading(float theta) const {
+    // negating x points a heading the other way around the y axis, and negating y reflects it across the x axis
+    if (this->mirrorX) theta = -theta;
+    if (this->mirrorY) theta = 180 - theta;
+    return theta + this->rotation;
+}
+
+lemlib::Pose lemlib::FieldTransform::invert(Pose pose) const {
+    // undo the rotation, then the mirrors, which are their own inverses
+    const float s = std::sin(degToRad(this->rotation));
+    const float c = std::cos(degToRad(this->rotation));
+    const float x = pose.x * c - pose.y * s;
+    const float y = pose.y * c + pose.x * s;
+    float theta = pose.theta - this->rotation;
+    if (this->mirrorY) theta = 180 - theta;
+    if (this->mirrorX) theta = -theta;
+    return Pose(this->mirrorX ? -x : x, this->mirrorY ? -y : y, theta);
+}
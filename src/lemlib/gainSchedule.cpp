@@ -0,0 +1,45 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "lemlib/gainSchedule.hpp"
+
+/**
+ * @brief Interpolate between 2 sets of gains
+ *
+ * @param a the gains at t = 0
+ * @param b the gains at t = 1
+ * @param t how far from a to b
+ */
+static lemlib::Gains lerp(const lemlib::Gains& a, const lemlib::Gains& b, float t) {
+    return {a.kP + (b.kP - a.kP) * t, a.kI + (b.kI - a.kI) * t, a.kD + (b.kD - a.kD) * t};
+}
+
+lemlib::GainSchedule::GainSchedule(ScheduleKey key, std::initializer_list<GainPoint> points)
+    : key(key) {
+    if (points.size() == 0) return;
+    std::vector<GainPoint> sorted(points);
+    std::sort(sorted.begin(), sorted.end(), [](const GainPoint& a, const GainPoint& b) { return a.key < b.key; });
+    this->minKey = sorted.front().key;
+    this->step = (sorted.back().key - this->minKey) / (TABLE_SIZE - 1);
+    // resample the points into evenly spaced entries
+    size_t segment = 0;
+    for (size_t i = 0; i < TABLE_SIZE; i++) {
+        const float value = this->minKey + this->step * i;
+        while (segment + 2 < sorted.size() && sorted[segment + 1].key < value) segment++;
+        if (sorted.size() == 1 || sorted[segment + 1].key == sorted[segment].key) {
+            this->table[i] = sorted[segment].gains;
+            continue;
+        }
+        const float t = (value - sorted[segment].key) / (sorted[segment + 1].key - sorted[segment].key);
+        this->table[i] = lerp(sorted[segment].gains, sorted[segment + 1].gains, std::clamp(t, 0.0f, 1.0f));
+    }
+}
+
+lemlib::Gains lemlib::GainSchedule::lookup(float value) const {
+    if (this->step == 0) return this->table[0];
+    const float position = std::clamp((std::fabs(value) - this->minKey) / this->step, 0.0f, float(TABLE_SIZE - 1));
+    const size_t index = std::min(size_t(position), TABLE_SIZE - 2);
+    return lerp(this->table[index], this->table[index + 1], position - index);
+}
+
+lemlib::ScheduleKey lemlib::GainSchedule::getKey() const { return this->key; }
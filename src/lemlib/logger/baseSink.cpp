@@ -1,17 +1,219 @@
+#include <algorithm>
 #include "lemlib/logger/baseSink.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+#include "lemlib/taskConfig.hpp"
 
 namespace lemlib {
 BaseSink::BaseSink(std::initializer_list<std::shared_ptr<BaseSink>> sinks) { this->sinks = sinks; }
 
 void BaseSink::setLowestLevel(Level lowestLevel) {
     if (!sinks.empty()) {
-        for (std::shared_ptr<BaseSink> sink : sinks) { sink->setLowestLevel(lowestLevel); }
+        for (const std::shared_ptr<BaseSink>& sink : sinks) { sink->setLowestLevel(lowestLevel); }
         return;
     }
 
     this->lowestLevel = lowestLevel;
 }
 
+void BaseSink::setDeferred(bool deferred) {
+    if (!sinks.empty()) {
+        for (const std::shared_ptr<BaseSink>& sink : sinks) { sink->setDeferred(deferred); }
+        return;
+    }
+
+    // the queue and the task are made once and never freed, so turning deferring off can't lose queued messages
+    if (deferred && deferredTask == nullptr) {
+        deferredQueue = new BoundedQueue<DeferredMessage>(DEFERRED_QUEUE_DEPTH);
+        deferredTask = new pros::Task {[this] {
+            DeferredMessage message;
+            while (true) {
+                while (deferredQueue->pop(message)) {
+                    send(message.stamp, message.format != nullptr ? message.format(message)
+                                                                   : std::string(message.text, message.textSize));
+                }
+                const uint32_t lost = dropped.exchange(0);
+                if (lost > 0) {
+                    send(stampMessage(Level::WARN), fmt::format("{} deferred messages were dropped", lost));
+                }
+                pros::delay(10);
+            }
+        }, deferredPriority != 0 ? deferredPriority.load() : getTaskConfig().logger.priority,
+            getTaskConfig().logger.stackSize};
+    }
+    this->deferred = deferred;
+}
+
+void BaseSink::setDeferredPriority(uint32_t priority) {
+    if (!sinks.empty()) {
+        for (const std::shared_ptr<BaseSink>& sink : sinks) { sink->setDeferredPriority(priority); }
+        return;
+    }
+
+    deferredPriority = priority;
+    if (deferredTask != nullptr) deferredTask->set_priority(priority);
+}
+
+bool BaseSink::isDeferring() const {
+    if (!sinks.empty()) {
+        for (const std::shared_ptr<BaseSink>& sink : sinks) {
+            if (sink->isDeferring()) return true;
+        }
+        return false;
+    }
+
+    return deferred.load(std::memory_order_relaxed);
+}
+
+void BaseSink::logDeferred(const DeferredMessage& message, fmt::format_args args) {
+    const Level level = message.stamp.level;
+    if (sinks.empty()) {
+        if (level >= lowestLevel && !deferredQueue->push(message)) dropped++;
+        return;
+    }
+
+    // the parents that don't defer share one formatted copy, which is only made if something needs it
+    const fmt::string_view format(message.formatString, message.formatSize);
+    std::string text;
+    bool formatted = false;
+    BaseSink* tap = this->tap.load(std::memory_order_relaxed);
+    if (tap != nullptr && tap->isEnabled(level)) {
+        text = fmt::vformat(format, args);
+        formatted = true;
+        tap->send(message.stamp, text);
+    }
+    for (const std::shared_ptr<BaseSink>& sink : sinks) {
+        if (!sink->isEnabled(level)) continue;
+        if (sink->isDeferring()) {
+            sink->logDeferred(message, args);
+            continue;
+        }
+        if (!formatted) {
+            text = fmt::vformat(format, args);
+            formatted = true;
+        }
+        sink->send(message.stamp, text);
+    }
+}
+
+void BaseSink::setTap(BaseSink* tap) { this->tap = tap; }
+
+void BaseSink::setTokenized(bool tokenized) {
+    for (const std::shared_ptr<BaseSink>& sink : sinks) { sink->setTokenized(tokenized); }
+    // a combined sink sends one tokenized message for all of its parents, since they would all be the same frame
+    this->tokenized = tokenized;
+}
+
+static_assert(BinaryTelemetry::MAX_PAYLOAD == 58, "TOKEN_PAYLOAD_SIZE is the largest binary telemetry payload");
+
+bool BaseSink::putToken(uint8_t* payload, size_t& size, char type, const void* value, size_t bytes) {
+    if (size + 1 + bytes > TOKEN_PAYLOAD_SIZE) return false;
+    payload[size] = type;
+    std::memcpy(payload + size + 1, value, bytes);
+    size += 1 + bytes;
+    return true;
+}
+
+bool BaseSink::putTokenText(uint8_t* payload, size_t& size, std::string_view text) {
+    if (size + 2 + text.size() > TOKEN_PAYLOAD_SIZE) return false;
+    payload[size] = 's';
+    payload[size + 1] = text.size();
+    std::memcpy(payload + size + 2, text.data(), text.size());
+    size += 2 + text.size();
+    return true;
+}
+
+void BaseSink::sendToken(Level level, uint32_t token, uint8_t* payload, size_t size, fmt::string_view format,
+                         fmt::format_args args) {
+    Message message = stampMessage(level);
+    // the text is only formatted if something needs it
+    BaseSink* tap = this->tap.load(std::memory_order_relaxed);
+    if (tap != nullptr && tap->isEnabled(level)) {
+        message.message = fmt::vformat(format, args);
+        tap->send(message, message.message);
+    }
+    if (size == 0) {
+        if (message.message.empty()) message.message = fmt::vformat(format, args);
+        const size_t length = BinaryTelemetry::packMessage(message, payload);
+        binaryTelemetry().sendFrame(TelemetryType::MESSAGE, payload, length, message.time);
+        return;
+    }
+    payload[0] = uint8_t(level);
+    std::memcpy(payload + 1, &token, sizeof(token));
+    binaryTelemetry().sendFrame(TelemetryType::TOKEN, payload, size, message.time);
+}
+
+void BaseSink::vlog(Level level, fmt::string_view format, fmt::format_args args) {
+    if (level < MIN_LOG_LEVEL) return;
+    if (!sinks.empty() ? !isEnabled(level) : level < lowestLevel) return;
+    Message message = stampMessage(level);
+    message.message = fmt::vformat(format, args);
+    if (isDeferring()) logText(message);
+    else send(message, message.message);
+}
+
+void BaseSink::logText(const Message& stamp) {
+    if (sinks.empty()) {
+        if (stamp.level < lowestLevel) return;
+        // the text is copied into the message, since copying the string of the stamp could allocate
+        DeferredMessage message;
+        message.stamp = {{}, stamp.level, stamp.time, stamp.micros, stamp.sequence, stamp.task};
+        message.textSize = std::min(stamp.message.size(), DEFERRED_TEXT_SIZE);
+        std::memcpy(message.text, stamp.message.data(), message.textSize);
+        if (!deferredQueue->push(message)) dropped++;
+        return;
+    }
+
+    BaseSink* tap = this->tap.load(std::memory_order_relaxed);
+    if (tap != nullptr && tap->isEnabled(stamp.level)) tap->send(stamp, stamp.message);
+    for (const std::shared_ptr<BaseSink>& sink : sinks) {
+        if (!sink->isEnabled(stamp.level)) continue;
+        if (sink->isDeferring()) sink->logText(stamp);
+        else sink->send(stamp, stamp.message);
+    }
+}
+
+void BaseSink::send(const Message& stamp, const std::string& messageString) {
+    BaseSink* tap = this->tap.load(std::memory_order_relaxed);
+    if (tap != nullptr && tap->isEnabled(stamp.level)) tap->send(stamp, messageString);
+    if (!sinks.empty()) {
+        for (const std::shared_ptr<BaseSink>& sink : sinks) {
+            if (sink->isEnabled(stamp.level)) sink->send(stamp, messageString);
+        }
+        return;
+    }
+
+    Message message = stamp;
+
+    // get the arguments
+    fmt::dynamic_format_arg_store<fmt::format_context> formattingArgs = getExtraFormattingArgs(message);
+
+    formattingArgs.push_back(fmt::arg("time", message.time));
+    formattingArgs.push_back(fmt::arg("micros", message.micros));
+    formattingArgs.push_back(fmt::arg("sequence", message.sequence));
+    // the name is only looked up for formats that use it
+    if (logFormat.find("{task") != std::string::npos) {
+        formattingArgs.push_back(fmt::arg("task", pros::Task(message.task).get_name()));
+    }
+    formattingArgs.push_back(fmt::arg("level", message.level));
+    formattingArgs.push_back(fmt::arg("message", messageString));
+
+    std::string formattedString = fmt::vformat(logFormat, std::move(formattingArgs));
+    message.message = std::move(formattedString);
+    sendMessage(std::move(message));
+}
+
+bool BaseSink::isEnabled(Level level) const {
+    if (level < MIN_LOG_LEVEL) return false;
+    if (!sinks.empty()) {
+        for (const std::shared_ptr<BaseSink>& sink : sinks) {
+            if (sink->isEnabled(level)) return true;
+        }
+        return false;
+    }
+
+    return level >= lowestLevel;
+}
+
 void BaseSink::setFormat(const std::string& logFormat) { this->logFormat = logFormat; }
 
 fmt::dynamic_format_arg_store<fmt::format_context> BaseSink::getExtraFormattingArgs(const Message& messageInfo) {
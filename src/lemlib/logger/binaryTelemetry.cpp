@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <iterator>
+#include <cstring>
+#include <string_view>
+#include "pros/rtos.hpp"
+#include "lemlib/logger/binaryTelemetry.hpp"
+#include "lemlib/logger/stdout.hpp"
+
+// type, time, payload, and CRC, before COBS encoding
+constexpr size_t MAX_FRAME = 1 + 4 + lemlib::BinaryTelemetry::MAX_PAYLOAD + 2;
+// level, sequence number, and time in microseconds, before the text of a message
+constexpr size_t MESSAGE_HEADER = 1 + 4 + 8;
+
+/**
+ * @brief Calculate the CRC-16/CCITT-FALSE of some bytes
+ */
+static uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= uint16_t(data[i]) << 8;
+        for (int bit = 0; bit < 8; bit++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+    return crc;
+}
+
+/**
+ * @brief COBS encode some bytes, so they contain no zeros
+ *
+ * @param in the bytes
+ * @param size the number of bytes, less than 254
+ * @param out where the encoded bytes are written. Must hold size + 1 bytes
+ * @return size_t the number of encoded bytes
+ */
+static size_t cobsEncode(const uint8_t* in, size_t size, uint8_t* out) {
+    size_t code = 0;
+    size_t length = 1;
+    for (size_t i = 0; i < size; i++) {
+        if (in[i] == 0) {
+            out[code] = length - code;
+            code = length++;
+        } else {
+            out[length++] = in[i];
+        }
+    }
+    out[code] = length - code;
+    return length;
+}
+
+/**
+ * @brief Write a float, little endian. The V5 is little endian, so the bytes are copied directly
+ */
+static uint8_t* put(uint8_t* out, float value) {
+    std::memcpy(out, &value, sizeof(value));
+    return out + sizeof(value);
+}
+
+namespace lemlib {
+BinaryTelemetry::BinaryTelemetry(Buffer& buffer)
+    : buffer(buffer) {}
+
+// the names of the channels, in the order of TelemetryChannel
+static constexpr std::string_view CHANNEL_NAMES[] = {"odom", "motion", "motors", "pid", "path"};
+static_assert(std::size(CHANNEL_NAMES) == TELEMETRY_CHANNELS);
+
+void BinaryTelemetry::setEnabled(bool enabled) {
+    this->enabled = enabled;
+    updateChannels();
+}
+
+void BinaryTelemetry::setChannel(TelemetryChannel channel, bool enabled, uint32_t period) {
+    Channel& state = channels[size_t(channel)];
+    state.period = period;
+    state.enabled = enabled;
+    updateChannels();
+}
+
+bool BinaryTelemetry::setChannel(std::string_view name, bool enabled, uint32_t period) {
+    for (size_t i = 0; i < TELEMETRY_CHANNELS; i++) {
+        if (CHANNEL_NAMES[i] != name) continue;
+        setChannel(TelemetryChannel(i), enabled, period);
+        return true;
+    }
+    return false;
+}
+
+void BinaryTelemetry::updateChannels() {
+    for (Channel& channel : channels) channel.open = enabled && channel.enabled;
+}
+
+bool BinaryTelemetry::checkRate(TelemetryChannel channel) {
+    Channel& state = channels[size_t(channel)];
+    const uint32_t period = state.period.load(std::memory_order_relaxed);
+    if (period == 0) return true;
+    const uint32_t now = pros::millis();
+    const uint32_t last = state.last.load(std::memory_order_relaxed);
+    if (now != last && now - last < period) return false;
+    state.last.store(now, std::memory_order_relaxed);
+    return true;
+}
+
+bool BinaryTelemetry::isEnabled() const { return enabled; }
+
+void BinaryTelemetry::sendPose(float x, float y, float theta) {
+    if (!isDue(TelemetryChannel::ODOM)) return;
+    uint8_t payload[12];
+    put(put(put(payload, x), y), theta);
+    sendFrame(TelemetryType::POSE, payload, sizeof(payload));
+}
+
+void BinaryTelemetry::sendVelocity(float linear, float angular) {
+    if (!isDue(TelemetryChannel::ODOM)) return;
+    uint8_t payload[8];
+    put(put(payload, linear), angular);
+    sendFrame(TelemetryType::VELOCITY, payload, sizeof(payload));
+}
+
+void BinaryTelemetry::sendMotorOutput(float left, float right) {
+    if (!isDue(TelemetryChannel::MOTORS)) return;
+    uint8_t payload[8];
+    put(put(payload, left), right);
+    sendFrame(TelemetryType::MOTOR_OUTPUT, payload, sizeof(payload));
+}
+
+void BinaryTelemetry::sendPid(uint8_t controller, float error, float p, float i, float d) {
+    if (!isDue(TelemetryChannel::PID)) return;
+    uint8_t payload[17];
+    payload[0] = controller;
+    put(put(put(put(payload + 1, error), p), i), d);
+    sendFrame(TelemetryType::PID, payload, sizeof(payload));
+}
+
+void BinaryTelemetry::sendPath(float x, float y, float distance, float curvature, float velocity) {
+    if (!isDue(TelemetryChannel::PATH)) return;
+    uint8_t payload[20];
+    put(put(put(put(put(payload, x), y), distance), curvature), velocity);
+    sendFrame(TelemetryType::PATH, payload, sizeof(payload));
+}
+
+void BinaryTelemetry::sendClockSync(uint32_t sequence, uint64_t hostTime, uint64_t receiveTime) {
+    uint8_t payload[28];
+    std::memcpy(payload, &sequence, sizeof(sequence));
+    std::memcpy(payload + 4, &hostTime, sizeof(hostTime));
+    std::memcpy(payload + 12, &receiveTime, sizeof(receiveTime));
+    // stamped as late as possible, so the time the answer waits in the buffer counts as part of its trip
+    const uint64_t sendTime = pros::micros();
+    std::memcpy(payload + 20, &sendTime, sizeof(sendTime));
+    sendFrame(TelemetryType::CLOCK_SYNC, payload, sizeof(payload), sendTime / 1000);
+}
+
+void BinaryTelemetry::sendFrame(TelemetryType type, const uint8_t* payload, size_t size) {
+    sendFrame(type, payload, size, pros::millis());
+}
+
+void BinaryTelemetry::sendFrame(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time) {
+    uint8_t encoded[MAX_ENCODED];
+    const size_t length = encodeFrame(type, payload, size, time, encoded);
+    buffer.pushToBuffer(std::string_view(reinterpret_cast<const char*>(encoded), length));
+}
+
+size_t BinaryTelemetry::encodeFrame(TelemetryType type, const uint8_t* payload, size_t size, uint32_t time,
+                                    uint8_t* out) {
+    uint8_t frame[MAX_FRAME];
+    frame[0] = uint8_t(type);
+    std::memcpy(frame + 1, &time, sizeof(time));
+    std::memcpy(frame + 5, payload, size);
+    const uint16_t crc = crc16(frame, 5 + size);
+    std::memcpy(frame + 5 + size, &crc, sizeof(crc));
+    // one byte of COBS overhead, and the zero byte that ends the frame
+    const size_t length = cobsEncode(frame, 7 + size, out);
+    out[length] = 0;
+    return length + 1;
+}
+
+size_t BinaryTelemetry::packMessage(const Message& message, uint8_t* out) {
+    out[0] = uint8_t(message.level);
+    std::memcpy(out + 1, &message.sequence, sizeof(message.sequence));
+    std::memcpy(out + 5, &message.micros, sizeof(message.micros));
+    const size_t length = std::min(message.message.size(), MAX_PAYLOAD - MESSAGE_HEADER);
+    std::memcpy(out + MESSAGE_HEADER, message.message.data(), length);
+    return MESSAGE_HEADER + length;
+}
+
+uint32_t BinaryTelemetry::getDropped() { return buffer.getStats().dropped; }
+
+BinaryTelemetry& binaryTelemetry() {
+    static BinaryTelemetry binaryTelemetry(bufferedStdout());
+    return binaryTelemetry;
+}
+} // namespace lemlib
@@ -1,16 +1,23 @@
-#define FMT_HEADER_ONLY
+#include <algorithm>
+#include <cstring>
 #include "fmt/core.h"
 #include "lemlib/logger/buffer.hpp"
 #include "lemlib/logger/message.hpp"
+#include "lemlib/taskConfig.hpp"
+
+// bytes used to store the length of each string in the ring
+constexpr size_t LENGTH_SIZE = sizeof(uint16_t);
 
 namespace lemlib {
-Buffer::Buffer(std::function<void(const std::string&)> bufferFunc)
+Buffer::Buffer(std::function<void(const std::string&)> bufferFunc, size_t capacity, DropPolicy policy)
     : bufferFunc(bufferFunc),
-      task([=]() { taskLoop(); }) {}
+      ring(capacity),
+      policy(policy),
+      task([=]() { taskLoop(); }, getTaskConfig().logger.priority, getTaskConfig().logger.stackSize) {}
 
 bool Buffer::buffersEmpty() {
     mutex.take();
-    bool status = buffer.size() == 0;
+    bool status = used == 0 && !writing;
     mutex.give();
     return status;
 }
@@ -21,22 +28,100 @@ Buffer::~Buffer() {
     while (!buffersEmpty()) { pros::delay(10); }
 }
 
-void Buffer::pushToBuffer(const std::string& bufferData) {
+void Buffer::readRing(size_t offset, char* out, size_t size) const {
+    offset %= ring.size();
+    const size_t first = std::min(size, ring.size() - offset);
+    std::memcpy(out, ring.data() + offset, first);
+    std::memcpy(out + first, ring.data(), size - first);
+}
+
+size_t Buffer::frontLength() const {
+    uint16_t length;
+    readRing(head, reinterpret_cast<char*>(&length), LENGTH_SIZE);
+    return length;
+}
+
+void Buffer::popFront() {
+    const size_t size = LENGTH_SIZE + frontLength();
+    head = (head + size) % ring.size();
+    used -= size;
+}
+
+void Buffer::pushToBuffer(std::string_view bufferData) {
+    const size_t size = LENGTH_SIZE + bufferData.size();
     mutex.take();
-    buffer.push_back(bufferData);
+    // strings that could never fit are always dropped
+    if (size > ring.size() || bufferData.size() > UINT16_MAX) {
+        stats.dropped++;
+        mutex.give();
+        return;
+    }
+    if (used + size > ring.size()) {
+        if (policy == DropPolicy::DROP_NEWEST) {
+            stats.dropped++;
+            mutex.give();
+            return;
+        }
+        while (used + size > ring.size()) {
+            popFront();
+            stats.dropped++;
+        }
+    }
+    // write the length, then the characters, wrapping around the end of the ring
+    const uint16_t length = bufferData.size();
+    size_t tail = (head + used) % ring.size();
+    for (size_t i = 0; i < LENGTH_SIZE; i++) ring[(tail + i) % ring.size()] = reinterpret_cast<const char*>(&length)[i];
+    tail = (tail + LENGTH_SIZE) % ring.size();
+    const size_t first = std::min(bufferData.size(), ring.size() - tail);
+    std::memcpy(ring.data() + tail, bufferData.data(), first);
+    std::memcpy(ring.data(), bufferData.data() + first, bufferData.size() - first);
+    used += size;
+    stats.highWaterMark = std::max(stats.highWaterMark, used);
     mutex.give();
 }
 
 void Buffer::setRate(uint32_t rate) { this->rate = rate; }
 
+void Buffer::setByteBudget(size_t bytes) { this->byteBudget = bytes; }
+
+void Buffer::setDropPolicy(DropPolicy policy) {
+    mutex.take();
+    this->policy = policy;
+    mutex.give();
+}
+
+BufferStats Buffer::getStats() {
+    mutex.take();
+    const BufferStats out = stats;
+    mutex.give();
+    return out;
+}
+
 void Buffer::taskLoop() {
+    // a batch is never bigger than the ring, so this is the only allocation the task makes
+    batch.reserve(ring.size());
     while (true) {
         mutex.take();
-        if (buffer.size() > 0) {
-            bufferFunc(buffer.at(0));
-            buffer.pop_front();
+        // join everything that fits in the budget, so it is written at once
+        while (used > 0) {
+            const size_t length = frontLength();
+            if (!batch.empty() && byteBudget != 0 && batch.size() + length > byteBudget) break;
+            const size_t start = batch.size();
+            batch.resize(start + length);
+            readRing(head + LENGTH_SIZE, batch.data() + start, length);
+            popFront();
         }
+        writing = !batch.empty();
+        // the write can block for a long time, so it happens without the mutex and never stalls pushToBuffer
         mutex.give();
+        if (!batch.empty()) {
+            bufferFunc(batch);
+            mutex.take();
+            stats.bytesSent += batch.size();
+            writing = false;
+            mutex.give();
+            batch.clear();
+        }
         pros::delay(rate);
     }
 }
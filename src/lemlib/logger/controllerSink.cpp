@@ -0,0 +1,57 @@
+#include <cstring>
+#include "pros/error.h"
+#include "lemlib/logger/controllerSink.hpp"
+
+// the controller drops text sent sooner than this after the last text, in milliseconds
+constexpr uint32_t WRITE_PERIOD = 50;
+
+namespace lemlib {
+ControllerSink::ControllerSink(pros::controller_id_e_t controller)
+    : controller(controller),
+      task([this] { taskLoop(); }, TASK_PRIORITY_MIN + 1) {
+    // the screen may still have text from before the program started, so every line is sent once
+    for (size_t line = 0; line < LINES; line++) {
+        wanted[line].fill(' ');
+        wanted[line][COLUMNS] = '\0';
+        shown[line].fill('\0');
+    }
+    setFormat("{message}");
+}
+
+void ControllerSink::setText(uint8_t line, const char* text) {
+    if (line >= LINES) return;
+    const size_t length = strnlen(text, COLUMNS);
+    mutex.take();
+    std::memcpy(wanted[line].data(), text, length);
+    std::memset(wanted[line].data() + length, ' ', COLUMNS - length);
+    mutex.give();
+}
+
+void ControllerSink::sendMessage(const Message& message) { setText(LINES - 1, message.message.c_str()); }
+
+void ControllerSink::taskLoop() {
+    uint32_t now = pros::millis();
+    while (true) {
+        pros::Task::delay_until(&now, WRITE_PERIOD);
+        // find the next line that changed, starting after the one sent last so no line can starve the others
+        std::array<char, COLUMNS + 1> text;
+        size_t line = LINES;
+        mutex.take();
+        for (size_t i = 0; i < LINES; i++) {
+            const size_t candidate = (nextLine + i) % LINES;
+            if (wanted[candidate] == shown[candidate]) continue;
+            line = candidate;
+            text = wanted[candidate];
+            break;
+        }
+        mutex.give();
+        if (line == LINES) continue;
+        // sending can block for a few milliseconds, so it happens without the mutex
+        if (pros::c::controller_set_text(controller, line, 0, text.data()) == PROS_ERR) continue;
+        mutex.take();
+        shown[line] = text;
+        mutex.give();
+        nextLine = (line + 1) % LINES;
+    }
+}
+} // namespace lemlib
@@ -1,6 +1,20 @@
+#include <atomic>
 #include "lemlib/logger/message.hpp"
 
+// the sequence number of the next message
+static std::atomic<uint32_t> nextSequence = 0;
+
 namespace lemlib {
+Message stampMessage(Level level) {
+    Message message;
+    message.level = level;
+    message.micros = pros::c::micros();
+    message.time = message.micros / 1000;
+    message.sequence = nextSequence.fetch_add(1, std::memory_order_relaxed);
+    message.task = pros::c::task_get_current();
+    return message;
+}
+
 std::string format_as(Level level) {
     switch (level) {
         case Level::DEBUG: return "DEBUG";
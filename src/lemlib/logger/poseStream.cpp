@@ -0,0 +1,87 @@
+#include <algorithm>
+#include <cstring>
+#include "lemlib/logger/poseStream.hpp"
+
+// fixed point units in an inch or a degree
+constexpr float SCALE = 100;
+// value of the target fields when there is no target
+constexpr int32_t NO_TARGET = INT16_MIN;
+// a full turn, in fixed point units
+constexpr int32_t FULL_TURN = 360 * SCALE;
+
+/**
+ * @brief Round a value to fixed point, saturating at the range of an int16 other than NO_TARGET
+ */
+static int32_t toFixed(float value) {
+    return std::clamp(int32_t(std::lround(value * SCALE)), int32_t(INT16_MIN + 1), int32_t(INT16_MAX));
+}
+
+namespace lemlib {
+PoseStream::PoseStream(BinaryTelemetry& telemetry, PoseStreamSettings settings)
+    : telemetry(telemetry),
+      settings(settings) {}
+
+void PoseStream::setEnabled(bool enabled) { this->enabled = enabled; }
+
+bool PoseStream::isEnabled() const { return enabled; }
+
+void PoseStream::setTarget(float x, float y) {
+    targetX = x;
+    targetY = y;
+}
+
+void PoseStream::update(Pose pose, uint32_t time) {
+    if (!enabled) return;
+    const bool first = deltas == UINT32_MAX;
+    const uint32_t elapsed = time - lastTime;
+    if (!first && elapsed < settings.minPeriod) return;
+    const bool hasTarget = !std::isnan(targetX);
+    const Fields fields = {toFixed(pose.x), toFixed(pose.y), toFixed(std::remainder(pose.theta, 360.0f)),
+                           hasTarget ? toFixed(targetX) : NO_TARGET, hasTarget ? toFixed(targetY) : NO_TARGET};
+    Fields change;
+    for (size_t i = 0; i < fields.size(); i++) change[i] = fields[i] - last[i];
+    // the short way around, so crossing 180 degrees is a small change
+    if (change[2] >= FULL_TURN / 2) change[2] -= FULL_TURN;
+    if (change[2] < -FULL_TURN / 2) change[2] += FULL_TURN;
+    // only send poses that show something new, but send one now and then so the visualizer knows the robot is there
+    const float moved = std::hypot(float(change[0]), float(change[1])) / SCALE;
+    const float targetMoved = hasTarget ? std::hypot(float(change[3]), float(change[4])) / SCALE : 0;
+    const bool targetChanged = hasTarget != (last[3] != NO_TARGET);
+    if (!first && !targetChanged && moved < settings.minDistance && std::abs(change[2]) < settings.minAngle * SCALE &&
+        targetMoved < settings.minDistance && elapsed < settings.maxPeriod)
+        return;
+    lastTime = time;
+    // a lost frame would throw off every delta after it
+    const uint32_t droppedNow = telemetry.getDropped();
+    const bool lost = droppedNow != dropped;
+    dropped = droppedNow;
+    const bool fits = std::all_of(change.begin(), change.end(),
+                                  [](int32_t value) { return value >= INT8_MIN && value <= INT8_MAX; });
+    if (first || lost || targetChanged || !fits || deltas >= settings.keyframeInterval) {
+        sendKeyframe(fields);
+        return;
+    }
+    uint8_t payload[5];
+    for (size_t i = 0; i < change.size(); i++) payload[i] = uint8_t(int8_t(change[i]));
+    telemetry.sendFrame(TelemetryType::POSE_DELTA, payload, sizeof(payload));
+    // the receiver adds up the changes, so it has the rounded pose exactly
+    last = fields;
+    deltas++;
+}
+
+void PoseStream::sendKeyframe(const Fields& fields) {
+    uint8_t payload[10];
+    for (size_t i = 0; i < fields.size(); i++) {
+        const int16_t value = fields[i];
+        std::memcpy(payload + 2 * i, &value, sizeof(value));
+    }
+    telemetry.sendFrame(TelemetryType::POSE_KEYFRAME, payload, sizeof(payload));
+    last = fields;
+    deltas = 0;
+}
+
+PoseStream& poseStream() {
+    static PoseStream poseStream(binaryTelemetry());
+    return poseStream;
+}
+} // namespace lemlib
@@ -0,0 +1,12 @@
+#include "lemlib/logger/sdSink.hpp"
+
+namespace lemlib {
+SdSink::SdSink(const std::string& name, size_t maxFileSize)
+    : writer(name, "log", maxFileSize) {
+    setFormat("{time} {level}: {message}");
+}
+
+uint32_t SdSink::getDropped() const { return writer.getDropped(); }
+
+void SdSink::sendMessage(const Message& message) { writer.write({message.message, "\n"}); }
+} // namespace lemlib
@@ -0,0 +1,105 @@
+#include <cstring>
+#include "fmt/core.h"
+#include "pros/misc.hpp"
+#include "lemlib/logger/sdWriter.hpp"
+
+// longest data can wait in a block that isn't full, in milliseconds
+constexpr uint32_t FLUSH_PERIOD = 1000;
+
+namespace lemlib {
+SdWriter::SdWriter(const std::string& name, const std::string& extension, size_t maxFileSize,
+                   const std::string& header)
+    : name(name),
+      extension(extension),
+      header(header),
+      maxFileSize(maxFileSize),
+      task([this] { taskLoop(); }, TASK_PRIORITY_MIN + 1) {
+    monitor.attach(task);
+}
+
+uint32_t SdWriter::getDropped() const { return dropped; }
+
+bool SdWriter::write(std::initializer_list<std::string_view> parts) {
+    size_t size = 0;
+    for (const std::string_view part : parts) size += part.size();
+    if (size > BLOCK_SIZE) {
+        dropped++;
+        return false;
+    }
+    mutex.take();
+    if (used[current] + size > BLOCK_SIZE && !swapBlocks()) {
+        mutex.give();
+        dropped++;
+        return false;
+    }
+    char* out = blocks[current].data() + used[current];
+    for (const std::string_view part : parts) {
+        std::memcpy(out, part.data(), part.size());
+        out += part.size();
+    }
+    used[current] += size;
+    mutex.give();
+    return true;
+}
+
+bool SdWriter::swapBlocks() {
+    if (pending != -1) return false;
+    pending = current;
+    current = 1 - current;
+    used[current] = 0;
+    task.notify();
+    return true;
+}
+
+void SdWriter::openNextFile() {
+    if (file != nullptr) fclose(file);
+    file = nullptr;
+    fileSize = 0;
+    // skip files that are already on the card, so old files aren't overwritten
+    for (; fileIndex < 1000 && file == nullptr; fileIndex++) {
+        const std::string path = fmt::format("/usd/{}_{:03}.{}", name, fileIndex, extension);
+        FILE* existing = fopen(path.c_str(), "r");
+        if (existing != nullptr) {
+            fclose(existing);
+            continue;
+        }
+        file = fopen(path.c_str(), "w");
+        // the blocks are already the size of a good write, so stdio doesn't need to buffer them again
+        if (file != nullptr) setvbuf(file, nullptr, _IONBF, 0);
+    }
+    if (file != nullptr && !header.empty()) {
+        fwrite(header.data(), 1, header.size(), file);
+        fileSize += header.size();
+    }
+}
+
+void SdWriter::taskLoop() {
+    while (true) {
+        // wait for a full block, or write the current one if it has been a while
+        if (pros::Task::notify_take(true, FLUSH_PERIOD) == 0) {
+            mutex.take();
+            if (used[current] > 0) swapBlocks();
+            mutex.give();
+        }
+        mutex.take();
+        const int block = pending;
+        mutex.give();
+        if (block == -1) continue;
+
+        const uint64_t start = pros::micros();
+        if (pros::usd::is_installed()) {
+            if (file == nullptr || fileSize >= maxFileSize) openNextFile();
+            if (file != nullptr) {
+                fwrite(blocks[block].data(), 1, used[block], file);
+                fflush(file);
+                fileSize += used[block];
+            }
+        }
+        monitor.record(pros::micros() - start);
+        // the block can be filled again
+        mutex.take();
+        pending = -1;
+        mutex.give();
+    }
+}
+} // namespace lemlib
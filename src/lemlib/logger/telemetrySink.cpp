@@ -1,4 +1,3 @@
-#define FMT_HEADER_ONLY
 #include "fmt/format.h"
 #include "lemlib/logger/telemetrySink.hpp"
 #include "lemlib/logger/stdout.hpp"
@@ -0,0 +1,70 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/loopProfiler.hpp"
+#include "lemlib/logger/logger.hpp"
+
+namespace lemlib {
+TimingStats timingStats(uint32_t* samples, size_t count) {
+    TimingStats stats;
+    if (count == 0) return stats;
+    std::sort(samples, samples + count);
+    stats.p50 = samples[count / 2];
+    stats.p99 = samples[std::min<size_t>(std::ceil(count * 0.99), count) - 1];
+    stats.max = samples[count - 1];
+    return stats;
+}
+
+void LoopProfiler::Histogram::add(uint32_t time) {
+    buckets[std::min(time / BUCKET_WIDTH, BUCKETS - 1)]++;
+    max = std::max(max, time);
+}
+
+TimingStats LoopProfiler::Histogram::stats(uint32_t count) const {
+    TimingStats out;
+    out.max = max;
+    if (count == 0) return out;
+    // the first bucket where the running total passes each percentile
+    const uint32_t p50Count = (count + 1) / 2;
+    const uint32_t p99Count = count - count / 100;
+    uint32_t total = 0;
+    bool foundP50 = false;
+    for (uint32_t i = 0; i < BUCKETS; i++) {
+        total += buckets[i];
+        const uint32_t top = std::min((i + 1) * BUCKET_WIDTH, max);
+        if (!foundP50 && total >= p50Count) {
+            out.p50 = top;
+            foundP50 = true;
+        }
+        if (total >= p99Count) {
+            out.p99 = top;
+            break;
+        }
+    }
+    return out;
+}
+
+void LoopProfiler::record(uint32_t compute, uint32_t lateness, uint32_t period) {
+    this->compute.add(compute);
+    this->lateness.add(lateness);
+    this->iterations++;
+    if (compute > period) this->overruns++;
+}
+
+LoopStats LoopProfiler::getStats() const {
+    LoopStats stats;
+    stats.iterations = iterations;
+    stats.overruns = overruns;
+    stats.compute = compute.stats(iterations);
+    stats.lateness = lateness.stats(iterations);
+    return stats;
+}
+
+void LoopProfiler::reset() { *this = LoopProfiler(); }
+
+void LoopProfiler::report(std::string_view name) const {
+    const LoopStats stats = getStats();
+    telemetrySink()->info("{},{},{},{},{},{},{},{},{}", name, stats.iterations, stats.overruns, stats.compute.p50,
+                          stats.compute.p99, stats.compute.max, stats.lateness.p50, stats.lateness.p99,
+                          stats.lateness.max);
+}
+} // namespace lemlib
@@ -0,0 +1,97 @@
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include "lemlib/matchClock.hpp"
+
+// a competition state the brain never reports, so the first update starts a period
+constexpr uint8_t UNKNOWN_STATUS = 0xFF;
+
+/**
+ * @brief Pack a period, the competition state it started at, whether it was started by hand, and the time it started
+ * into 1 word
+ */
+static uint64_t pack(lemlib::MatchPeriod period, uint8_t status, uint32_t start, bool manual = false) {
+    return uint64_t(start) << 32 | uint64_t(manual) << 16 | uint64_t(status) << 8 | uint64_t(period);
+}
+
+static lemlib::MatchPeriod periodOf(uint64_t state) { return lemlib::MatchPeriod(state & 0xFF); }
+
+static uint8_t statusOf(uint64_t state) { return (state >> 8) & 0xFF; }
+
+static bool manualOf(uint64_t state) { return (state >> 16) & 1; }
+
+static uint32_t startOf(uint64_t state) { return state >> 32; }
+
+namespace lemlib {
+MatchClock::MatchClock(MatchTiming timing)
+    : autonomousLength(timing.autonomous),
+      driverLength(timing.driver),
+      state(pack(MatchPeriod::DISABLED, UNKNOWN_STATUS, pros::millis())) {}
+
+void MatchClock::setTiming(MatchTiming timing) {
+    autonomousLength = timing.autonomous;
+    driverLength = timing.driver;
+}
+
+void MatchClock::update() {
+    const uint8_t status = pros::competition::get_status();
+    uint64_t current = state.load();
+    if (statusOf(current) == status) return;
+    MatchPeriod period = MatchPeriod::DRIVER;
+    if (status & COMPETITION_DISABLED) period = MatchPeriod::DISABLED;
+    else if (status & COMPETITION_AUTONOMOUS) period = MatchPeriod::AUTONOMOUS;
+    // if another task saw the change first, its start time is kept
+    state.compare_exchange_strong(current, pack(period, status, pros::millis()));
+}
+
+void MatchClock::start(MatchPeriod period) {
+    // started at the current competition state, so the next change of it ends the period
+    state = pack(period, pros::competition::get_status(), pros::millis(), true);
+}
+
+bool MatchClock::isTimed() {
+    update();
+    const uint64_t current = state.load();
+    return manualOf(current) || (statusOf(current) & COMPETITION_CONNECTED);
+}
+
+MatchPeriod MatchClock::getPeriod() {
+    update();
+    return periodOf(state.load());
+}
+
+uint32_t MatchClock::getPeriodStart() {
+    update();
+    return startOf(state.load());
+}
+
+uint32_t MatchClock::getElapsed() {
+    update();
+    return pros::millis() - startOf(state.load());
+}
+
+uint32_t MatchClock::getRemaining() {
+    update();
+    const uint64_t current = state.load();
+    const uint32_t length = periodLength(periodOf(current));
+    const uint32_t elapsed = pros::millis() - startOf(current);
+    return elapsed < length ? length - elapsed : 0;
+}
+
+uint32_t MatchClock::getDeadline(uint32_t reserve) {
+    const uint32_t remaining = getRemaining();
+    return remaining > reserve + 1 ? remaining - reserve : 1;
+}
+
+uint32_t MatchClock::periodLength(MatchPeriod period) const {
+    switch (period) {
+        case MatchPeriod::AUTONOMOUS: return autonomousLength;
+        case MatchPeriod::DRIVER: return driverLength;
+        default: return 0;
+    }
+}
+
+MatchClock& matchClock() {
+    static MatchClock matchClock;
+    return matchClock;
+}
+} // namespace lemlib
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <cmath>
+#include "pros/error.h"
+#include "lemlib/mechanism.hpp"
+#include "lemlib/scheduler.hpp"
+#include "lemlib/taskConfig.hpp"
+#include "lemlib/util.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// the motors take at most 12 volts
+constexpr float MAX_VOLTAGE = 12;
+
+namespace lemlib {
+Mechanism::Mechanism(MechanismConfig config, ControllerSettings settings, Scheduler* scheduler, uint32_t period)
+    : config(config),
+      settings(settings),
+      period(std::max(period, uint32_t(1))),
+      scheduler(scheduler),
+      pid(settings.kP, settings.kI, settings.kD, settings.windupRange, true),
+      smallExit(settings.smallError, settings.smallErrorTimeout),
+      largeExit(settings.largeError, settings.largeErrorTimeout) {
+    pid.setTimeStep(this->period / TUNED_PERIOD);
+    if (settings.derivativeFilter > 0) pid.setDerivativeFilter(settings.derivativeFilter);
+    if (settings.antiWindup != AntiWindup::NONE) pid.setOutputLimit(127, settings.antiWindup);
+    smallExit.setVelocityExit(settings.exitVelocity);
+}
+
+void Mechanism::calibrate(float position) {
+    config.sensor->set_position(int32_t(std::round(position * config.ratio * 100)));
+    this->position = position;
+    if (task != nullptr || schedulerJob >= 0) return;
+    if (scheduler != nullptr) {
+        schedulerJob = scheduler->addJob(
+            "mechanism", period, [](void* mechanism, uint32_t) { static_cast<Mechanism*>(mechanism)->tick(); }, this);
+        if (schedulerJob >= 0) return;
+        infoSink()->warn("Scheduler has no room for the mechanism, so it is running on its own task");
+    }
+    const TaskSettings taskSettings = getTaskConfig().motion;
+    task = new pros::Task {[this] {
+        uint32_t prevTime = pros::millis();
+        while (true) {
+            tick();
+            pros::Task::delay_until(&prevTime, period);
+        }
+    }, taskSettings.priority, taskSettings.stackSize};
+    monitor.attach(*task, taskSettings.stackSize);
+}
+
+MotionHandle Mechanism::moveTo(float target, int timeout, MechanismMoveParams params, bool async) {
+    const uint32_t id = ++movesQueued;
+    // reset the record of the move. The id is written last, so handles to the old move stop using it first
+    MotionRecord& record = records[id % records.size()];
+    record.id = 0;
+    record.progress = 0;
+    record.startTime = 0;
+    record.reason = MotionEndReason::NOT_DONE;
+    for (MotionCallback& callback : record.callbacks) callback.state = MotionCallback::EMPTY;
+    record.id = id;
+    cancelRequested = false;
+    if (!commands.push({id, target, timeout, params})) {
+        infoSink()->warn("Mechanism queue is full, so move {} was dropped", id);
+        finishMove(id, MotionEndReason::CANCELLED);
+    }
+    if (task == nullptr && schedulerJob < 0) {
+        infoSink()->warn("Mechanism isn't calibrated, so move {} won't run until calibrate is called", id);
+    }
+    MotionHandle handle(this, id);
+    if (!async) handle.wait();
+    return handle;
+}
+
+void Mechanism::cancel() {
+    cancelRequested = true;
+    // moves queued before the cancel are dropped by the control loop
+    MechanismCommand command;
+    while (commands.pop(command)) finishMove(command.id, MotionEndReason::CANCELLED);
+}
+
+float Mechanism::getPosition() const { return position; }
+
+float Mechanism::getVelocity() const { return velocity; }
+
+bool Mechanism::hasSensorError() const { return sensorError; }
+
+void Mechanism::waitUntilDone() { waitForMotion(movesQueued, INFINITY); }
+
+MotionRecord* Mechanism::getMotionRecord(uint32_t id) {
+    if (id == 0) return nullptr;
+    MotionRecord& record = records[id % records.size()];
+    return record.id == id ? &record : nullptr;
+}
+
+void Mechanism::waitForMotion(uint32_t id, float dist) {
+    const auto done = [&] {
+        const MotionRecord* record = getMotionRecord(id);
+        return record == nullptr || record->reason != MotionEndReason::NOT_DONE || record->progress > dist;
+    };
+    if (done()) return;
+    // register this task so the control loop notifies it. If every slot is taken, this task polls instead
+    const pros::task_t current = pros::c::task_get_current();
+    std::atomic<pros::task_t>* slot = nullptr;
+    for (std::atomic<pros::task_t>& waiter : waiters) {
+        pros::task_t expected = nullptr;
+        if (waiter.compare_exchange_strong(expected, current)) {
+            slot = &waiter;
+            break;
+        }
+    }
+    // the timeout is a fallback, a notification normally arrives first
+    while (!done()) pros::Task::notify_take(true, period);
+    if (slot != nullptr) *slot = nullptr;
+}
+
+void Mechanism::startMove(const MechanismCommand& command, float position) {
+    if (running != 0) finishMove(running, MotionEndReason::CANCELLED);
+    running = command.id;
+    move = command;
+    startPosition = position;
+    startTime = pros::micros();
+    holdTarget = NAN;
+    const float maxVelocity = command.params.maxVelocity > 0 ? command.params.maxVelocity : settings.maxVelocity;
+    profiled = maxVelocity > 0 && settings.maxAcceleration > 0;
+    if (profiled) {
+        profile = MotionProfile(std::fabs(command.target - position), maxVelocity, settings.maxAcceleration,
+                                settings.maxJerk);
+    }
+    pid.reset();
+    smallExit.reset();
+    largeExit.reset();
+    MotionRecord* record = getMotionRecord(running);
+    if (record != nullptr) record->startTime = pros::millis();
+}
+
+void Mechanism::finishMove(uint32_t id, MotionEndReason reason) {
+    MotionRecord* record = getMotionRecord(id);
+    if (record == nullptr) return;
+    MotionEndReason expected = MotionEndReason::NOT_DONE;
+    if (!record->reason.compare_exchange_strong(expected, reason)) return;
+    fireCallbacks(*record, true);
+}
+
+void Mechanism::fireCallbacks(MotionRecord& record, bool ended) {
+    const uint32_t elapsed = record.startTime == 0 ? 0 : pros::millis() - record.startTime;
+    for (MotionCallback& callback : record.callbacks) {
+        if (callback.state != MotionCallback::READY) continue;
+        bool reached = ended && callback.trigger == MotionTrigger::END;
+        if (callback.trigger == MotionTrigger::PROGRESS) reached = record.progress > callback.threshold;
+        if (callback.trigger == MotionTrigger::TIME) reached = elapsed >= callback.threshold;
+        uint8_t state = MotionCallback::READY;
+        if (!reached || !callback.state.compare_exchange_strong(state, MotionCallback::FIRED)) continue;
+        // mechanisms have no callback task, so deferred callbacks run on the control loop too
+        callback.callback(callback.arg);
+    }
+}
+
+void Mechanism::drive(float power) {
+    const float voltage = std::clamp(power, -127.0f, 127.0f) * MAX_VOLTAGE * 1000 / 127;
+    config.motors->move_voltage(std::round(voltage));
+}
+
+float Mechanism::gravityPower(float position) const {
+    float volts = 0;
+    switch (config.gravity) {
+        case MechanismGravity::NONE: break;
+        case MechanismGravity::CONSTANT: volts = config.kG; break;
+        case MechanismGravity::COSINE: volts = config.kG * std::cos(degToRad(position)); break;
+    }
+    return volts * 127 / MAX_VOLTAGE;
+}
+
+void Mechanism::tick() {
+    const uint32_t start = pros::micros();
+    const int32_t rawPosition = config.sensor->get_position();
+    const int32_t rawVelocity = config.sensor->get_velocity();
+    // without the sensor the controller would drive blind, so the motors are stopped until it reads again. Moves keep
+    // running, so they still time out
+    sensorError = rawPosition == PROS_ERR || rawVelocity == PROS_ERR;
+    if (sensorError) drive(0);
+    const float current = sensorError ? position.load() : rawPosition / 100.0f / config.ratio;
+    const float speed = sensorError ? 0 : rawVelocity / 100.0f / config.ratio;
+    position = current;
+    velocity = speed;
+
+    // the last move queued replaces the others
+    MechanismCommand command;
+    bool started = false;
+    while (commands.pop(command)) {
+        startMove(command, current);
+        started = true;
+    }
+    if (cancelRequested.exchange(false) && !started) {
+        if (running != 0) finishMove(running, MotionEndReason::CANCELLED);
+        running = 0;
+        holdTarget = NAN;
+        drive(0);
+    }
+
+    // an exit condition ends the move before it drives again
+    MotionRecord* conditionRecord = running != 0 ? getMotionRecord(running) : nullptr;
+    if (conditionRecord != nullptr && exitConditionMet(*conditionRecord)) {
+        finishMove(running, MotionEndReason::CONDITION_MET);
+        // hold where the condition became true, rather than carrying on to the target
+        if (move.params.hold) holdTarget = current;
+        drive(move.params.hold ? gravityPower(current) : 0);
+        running = 0;
+    }
+
+    if (running != 0) {
+        const float direction = move.target >= startPosition ? 1 : -1;
+        const float elapsed = (pros::micros() - startTime) / 1000000.0f;
+        // follow the profile, then settle on the target
+        float setpoint = move.target;
+        float feedforward = 0;
+        if (profiled && elapsed < profile.getDuration()) {
+            const ProfileState state = profile.sample(elapsed);
+            setpoint = startPosition + direction * state.position;
+            feedforward = config.feedforward.calculate(direction * state.velocity, direction * state.acceleration) *
+                          127 / MAX_VOLTAGE;
+        }
+        const float error = move.target - current;
+        if (!sensorError) drive(pid.update(setpoint - current) + feedforward + gravityPower(current));
+
+        MotionRecord* record = getMotionRecord(running);
+        if (record != nullptr) {
+            record->progress = std::fabs(current - startPosition);
+            fireCallbacks(*record, false);
+        }
+        // the exit conditions only count once the profile has reached the target
+        const bool profileDone = !profiled || elapsed >= profile.getDuration();
+        const bool settled =
+            profileDone && !sensorError && (smallExit.update(error, speed, error) || largeExit.update(error));
+        const bool early =
+            move.params.earlyExitRange > 0 && !sensorError && std::fabs(error) < move.params.earlyExitRange;
+        const bool timedOut = elapsed * 1000 >= move.timeout;
+        if (settled || early || timedOut) {
+            finishMove(running, settled ? MotionEndReason::SETTLED
+                                        : (early ? MotionEndReason::EARLY_EXIT : MotionEndReason::TIMEOUT));
+            if (move.params.hold) holdTarget = move.target;
+            else drive(0);
+            running = 0;
+        }
+    } else if (!std::isnan(holdTarget) && !sensorError) {
+        drive(pid.update(holdTarget - current) + gravityPower(current));
+    }
+
+    // wake the tasks waiting for a move
+    for (std::atomic<pros::task_t>& waiter : waiters) {
+        const pros::task_t task = waiter.load();
+        if (task != nullptr) pros::c::task_notify(task);
+    }
+    monitor.record(pros::micros() - start);
+}
+} // namespace lemlib
@@ -0,0 +1,101 @@
+#include <cmath>
+#include "lemlib/motionProfile.hpp"
+
+/**
+ * @brief Find how long it takes to accelerate from rest to a velocity
+ *
+ * @param velocity the velocity
+ * @param acceleration the maximum acceleration
+ * @param jerk the maximum jerk, or 0 for no jerk limit
+ * @param jerkTime set to how long the acceleration ramps up for. 0 without a jerk limit
+ * @return float the time
+ */
+static float rampTime(float velocity, float acceleration, float jerk, float& jerkTime) {
+    if (jerk <= 0) {
+        jerkTime = 0;
+        return velocity / acceleration;
+    }
+    // the maximum acceleration is reached, so the acceleration is held for a while
+    if (velocity * jerk >= acceleration * acceleration) {
+        jerkTime = acceleration / jerk;
+        return velocity / acceleration + jerkTime;
+    }
+    // the velocity is reached before the maximum acceleration
+    jerkTime = std::sqrt(velocity / jerk);
+    return 2 * jerkTime;
+}
+
+/**
+ * @brief Find the distance traveled while accelerating from rest to a velocity
+ *
+ * The acceleration is symmetric, so the average velocity is half of the final velocity
+ */
+static float rampDistance(float velocity, float acceleration, float jerk) {
+    float jerkTime;
+    return velocity * rampTime(velocity, acceleration, jerk, jerkTime) / 2;
+}
+
+lemlib::MotionProfile::MotionProfile(float distance, float maxVelocity, float maxAcceleration, float maxJerk)
+    : distance(distance),
+      maxAcceleration(maxAcceleration),
+      maxJerk(maxJerk) {
+    const float length = std::fabs(distance);
+    if (length == 0 || maxVelocity <= 0 || maxAcceleration <= 0) return;
+    // if the distance is too short to reach the maximum velocity, find the velocity that can be reached
+    float velocity = maxVelocity;
+    if (2 * rampDistance(velocity, maxAcceleration, maxJerk) > length) {
+        float low = 0;
+        float high = maxVelocity;
+        for (int i = 0; i < 32; i++) {
+            velocity = (low + high) / 2;
+            if (2 * rampDistance(velocity, maxAcceleration, maxJerk) > length) high = velocity;
+            else low = velocity;
+        }
+        velocity = low;
+    }
+    this->addRamp(velocity, 1);
+    const float cruiseTime = (length - 2 * rampDistance(velocity, maxAcceleration, maxJerk)) / velocity;
+    if (cruiseTime > 0) {
+        this->segments[this->segmentCount++] = {cruiseTime, 0, 0};
+        this->duration += cruiseTime;
+    }
+    this->addRamp(velocity, -1);
+}
+
+void lemlib::MotionProfile::addRamp(float velocity, float sign) {
+    float jerkTime;
+    const float time = rampTime(velocity, this->maxAcceleration, this->maxJerk, jerkTime);
+    this->duration += time;
+    if (jerkTime == 0) {
+        this->segments[this->segmentCount++] = {time, 0, sign * this->maxAcceleration};
+        return;
+    }
+    const float peakAcceleration = this->maxJerk * jerkTime;
+    this->segments[this->segmentCount++] = {jerkTime, sign * this->maxJerk, 0};
+    if (time > 2 * jerkTime) this->segments[this->segmentCount++] = {time - 2 * jerkTime, 0, sign * peakAcceleration};
+    this->segments[this->segmentCount++] = {jerkTime, -sign * this->maxJerk, sign * peakAcceleration};
+}
+
+lemlib::ProfileState lemlib::MotionProfile::sample(float time) const {
+    if (time <= 0) return {};
+    if (time >= this->duration) return {this->distance, 0, 0};
+    // integrate each segment up to the time. Jerk is constant in a segment, so this is exact
+    float position = 0;
+    float velocity = 0;
+    float acceleration = 0;
+    for (size_t i = 0; i < this->segmentCount; i++) {
+        const Segment& segment = this->segments[i];
+        const float dt = std::fmin(time, segment.duration);
+        position += velocity * dt + segment.acceleration * dt * dt / 2 + segment.jerk * dt * dt * dt / 6;
+        velocity += segment.acceleration * dt + segment.jerk * dt * dt / 2;
+        acceleration = segment.acceleration + segment.jerk * dt;
+        time -= dt;
+        if (time <= 0) break;
+    }
+    const float sign = this->distance < 0 ? -1 : 1;
+    return {sign * position, sign * velocity, sign * acceleration};
+}
+
+float lemlib::MotionProfile::getDuration() const { return this->duration; }
+
+float lemlib::MotionProfile::getDistance() const { return this->distance; }
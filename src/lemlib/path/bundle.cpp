@@ -0,0 +1,36 @@
+#include <cstring>
+#include "lemlib/path/bundle.hpp"
+#include "lemlib/logger/logger.hpp"
+
+namespace lemlib {
+asset findPath(const asset& bundle, std::string_view name) {
+    if (bundle.size < sizeof(BundleHeader)) {
+        infoSink()->error("Asset is not a path bundle!");
+        return {nullptr, 0};
+    }
+    BundleHeader header;
+    std::memcpy(&header, bundle.buf, sizeof(header));
+    if (header.magic != BUNDLE_MAGIC || header.version != BUNDLE_VERSION || header.tableSize == 0 ||
+        bundle.size < sizeof(BundleHeader) + size_t(header.tableSize) * sizeof(BundleEntry)) {
+        infoSink()->error("Asset is not a path bundle, or was made for a different version of LemLib!");
+        return {nullptr, 0};
+    }
+    // open addressing with linear probing. An empty entry means the path isn't in the bundle
+    const uint32_t hash = pathNameHash(name);
+    const uint8_t* table = bundle.buf + sizeof(BundleHeader);
+    for (uint32_t probe = 0; probe < header.tableSize; probe++) {
+        const uint32_t slot = (hash + probe) & (header.tableSize - 1);
+        BundleEntry entry;
+        std::memcpy(&entry, table + slot * sizeof(BundleEntry), sizeof(entry));
+        if (entry.size == 0) break;
+        if (entry.hash != hash) continue;
+        if (size_t(entry.offset) + entry.size > bundle.size) {
+            infoSink()->error("Path bundle is truncated! Can't read path {}", name);
+            return {nullptr, 0};
+        }
+        return {bundle.buf + entry.offset, entry.size};
+    }
+    infoSink()->error("Path bundle doesn't have a path named {}", name);
+    return {nullptr, 0};
+}
+} // namespace lemlib
@@ -0,0 +1,235 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/path/generator.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/util.hpp"
+
+// fewest steps each spline is integrated with
+constexpr int MIN_SPLINE_STEPS = 16;
+// steps each spline is integrated with per point of the path, so the arc length is accurate
+constexpr int STEPS_PER_POINT = 4;
+// least distance between poses of a driver macro that are made into a path, in inches
+constexpr float MIN_MACRO_MOVE = 0.25;
+// most the heading can change between waypoints made from a driver macro before it is taken as a reversal, in degrees
+constexpr float MAX_MACRO_TURN = 150;
+
+namespace lemlib {
+PathArena::PathArena(size_t points)
+    : buffer(new float[points * POINT_FLOATS]),
+      capacity(points) {}
+
+PathArena::~PathArena() { delete[] buffer; }
+
+float* PathArena::allocate(size_t points) {
+    if (points > capacity - used) return nullptr;
+    float* memory = buffer + used * POINT_FLOATS;
+    used += points;
+    return memory;
+}
+
+void PathArena::release(size_t points) { used -= std::min(points, used); }
+
+void PathArena::reset() { used = 0; }
+
+size_t PathArena::remaining() const { return capacity - used; }
+
+/**
+ * @brief A position on a spline, and its first and second derivatives
+ */
+struct SplinePoint {
+        float x, y;
+        float dx, dy;
+        float ddx, ddy;
+};
+
+/**
+ * @brief A spline between 2 waypoints
+ */
+struct Spline {
+        float x0, y0, x1, y1;
+        // tangents at the start and end
+        float tx0, ty0, tx1, ty1;
+};
+
+/**
+ * @brief Build the spline between 2 waypoints. The tangents point along the heading of each waypoint
+ */
+static Spline makeSpline(const Waypoint& start, const Waypoint& end, float tangentScale) {
+    const float length = tangentScale * std::hypot(end.x - start.x, end.y - start.y);
+    const float theta0 = degToRad(start.theta);
+    const float theta1 = degToRad(end.theta);
+    return {start.x,
+            start.y,
+            end.x,
+            end.y,
+            length * std::sin(theta0),
+            length * std::cos(theta0),
+            length * std::sin(theta1),
+            length * std::cos(theta1)};
+}
+
+/**
+ * @brief Evaluate a spline
+ *
+ * @param spline the spline
+ * @param type the curve
+ * @param t how far along the spline, from 0 to 1
+ * @return SplinePoint the position and derivatives
+ */
+static SplinePoint evaluate(const Spline& spline, SplineType type, float t) {
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    // weights of the start point, start tangent, end point, and end tangent. Then their derivatives
+    float p0, m0, p1, m1, dp0, dm0, dp1, dm1, ddp0, ddm0, ddp1, ddm1;
+    if (type == SplineType::CUBIC_BEZIER) {
+        // a cubic Bézier curve with control points a third of the tangent from each end is a cubic Hermite spline
+        p0 = 2 * t3 - 3 * t2 + 1, m0 = t3 - 2 * t2 + t, p1 = -2 * t3 + 3 * t2, m1 = t3 - t2;
+        dp0 = 6 * t2 - 6 * t, dm0 = 3 * t2 - 4 * t + 1, dp1 = -6 * t2 + 6 * t, dm1 = 3 * t2 - 2 * t;
+        ddp0 = 12 * t - 6, ddm0 = 6 * t - 4, ddp1 = -12 * t + 6, ddm1 = 6 * t - 2;
+    } else {
+        // the second derivative at each end is 0
+        const float t4 = t3 * t;
+        const float t5 = t4 * t;
+        p0 = 1 - 10 * t3 + 15 * t4 - 6 * t5, m0 = t - 6 * t3 + 8 * t4 - 3 * t5;
+        p1 = 10 * t3 - 15 * t4 + 6 * t5, m1 = -4 * t3 + 7 * t4 - 3 * t5;
+        dp0 = -30 * t2 + 60 * t3 - 30 * t4, dm0 = 1 - 18 * t2 + 32 * t3 - 15 * t4;
+        dp1 = -dp0, dm1 = -12 * t2 + 28 * t3 - 15 * t4;
+        ddp0 = -60 * t + 180 * t2 - 120 * t3, ddm0 = -36 * t + 96 * t2 - 60 * t3;
+        ddp1 = -ddp0, ddm1 = -24 * t + 84 * t2 - 60 * t3;
+    }
+    return {p0 * spline.x0 + m0 * spline.tx0 + p1 * spline.x1 + m1 * spline.tx1,
+            p0 * spline.y0 + m0 * spline.ty0 + p1 * spline.y1 + m1 * spline.ty1,
+            dp0 * spline.x0 + dm0 * spline.tx0 + dp1 * spline.x1 + dm1 * spline.tx1,
+            dp0 * spline.y0 + dm0 * spline.ty0 + dp1 * spline.y1 + dm1 * spline.ty1,
+            ddp0 * spline.x0 + ddm0 * spline.tx0 + ddp1 * spline.x1 + ddm1 * spline.tx1,
+            ddp0 * spline.y0 + ddm0 * spline.ty0 + ddp1 * spline.y1 + ddm1 * spline.ty1};
+}
+
+/**
+ * @brief Get the number of steps a spline is integrated with
+ */
+static int splineSteps(const Spline& spline, float spacing) {
+    const float chord = std::hypot(spline.x1 - spline.x0, spline.y1 - spline.y0);
+    return std::max(MIN_SPLINE_STEPS, int(std::ceil(chord / spacing * STEPS_PER_POINT)));
+}
+
+Path generatePath(PathArena& arena, const std::vector<Waypoint>& waypoints, const PathConstraints& constraints) {
+    if (waypoints.size() < 2 || constraints.spacing <= 0) {
+        infoSink()->error("Can't generate a path with fewer than 2 waypoints or no spacing");
+        return Path();
+    }
+    const float spacing = constraints.spacing;
+
+    // first pass: find the length of the path, so the number of points is known
+    float length = 0;
+    for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+        const Spline spline = makeSpline(waypoints[i], waypoints[i + 1], constraints.tangentScale);
+        const int steps = splineSteps(spline, spacing);
+        SplinePoint last = evaluate(spline, constraints.type, 0);
+        for (int step = 1; step <= steps; step++) {
+            const SplinePoint point = evaluate(spline, constraints.type, float(step) / steps);
+            length += std::hypot(point.x - last.x, point.y - last.y);
+            last = point;
+        }
+    }
+    // a point every spacing inches, and one at the end
+    const size_t count = size_t(std::ceil(length / spacing)) + 1;
+    float* memory = arena.allocate(count);
+    if (memory == nullptr) {
+        infoSink()->error("Path arena is full! {} points are needed, but only {} are left", count, arena.remaining());
+        return Path();
+    }
+    float* x = memory;
+    float* y = memory + count;
+    float* velocity = memory + 2 * count;
+    float* index = memory + 3 * count;
+
+    // second pass: place the points, and limit the velocity of each by the curvature of the spline there
+    size_t placed = 0;
+    float traveled = 0;
+    for (size_t i = 0; i + 1 < waypoints.size() && placed + 1 < count; i++) {
+        const Spline spline = makeSpline(waypoints[i], waypoints[i + 1], constraints.tangentScale);
+        const int steps = splineSteps(spline, spacing);
+        SplinePoint last = evaluate(spline, constraints.type, 0);
+        for (int step = 1; step <= steps && placed + 1 < count; step++) {
+            const SplinePoint point = evaluate(spline, constraints.type, float(step) / steps);
+            const float stepLength = std::hypot(point.x - last.x, point.y - last.y);
+            // place every point that falls on this step
+            while (placed + 1 < count && placed * spacing <= traveled + stepLength) {
+                const float t = stepLength == 0 ? 0 : (placed * spacing - traveled) / stepLength;
+                x[placed] = last.x + (point.x - last.x) * t;
+                y[placed] = last.y + (point.y - last.y) * t;
+                const float speed = std::hypot(last.dx, last.dy);
+                const float curvature =
+                    speed == 0 ? 0 : std::fabs(last.dx * last.ddy - last.dy * last.ddx) / (speed * speed * speed);
+                float target = constraints.maxVelocity;
+                if (constraints.k > 0 && curvature > 0) target = std::fmin(target, constraints.k / curvature);
+                velocity[placed] = std::fmax(target, constraints.minVelocity);
+                placed++;
+            }
+            traveled += stepLength;
+            last = point;
+        }
+    }
+    // floating point error can leave the first pass a point longer than the second
+    while (placed + 1 < count) {
+        x[placed] = x[placed - 1];
+        y[placed] = y[placed - 1];
+        velocity[placed] = velocity[placed - 1];
+        placed++;
+    }
+    x[count - 1] = waypoints.back().x;
+    y[count - 1] = waypoints.back().y;
+    velocity[count - 1] = 0;
+
+    // limit how quickly the velocity changes, over the distances indexed for the path. The last point stays 0
+    Path path(x, y, velocity, count, index);
+    limitAcceleration(path, velocity, constraints.minVelocity, constraints.maxAcceleration);
+    velocity[count - 1] = 0;
+    return path;
+}
+
+Path macroToPath(PathArena& arena, const DriverMacro& macro, const MacroPathOptions& options) {
+    std::vector<MacroSample> samples;
+    std::vector<MacroPose> poses;
+    if (!macro.decode(samples, poses)) {
+        infoSink()->error("Driver macro is empty! Can't make a path from it");
+        return Path();
+    }
+    // poses where the robot was sitting still don't shape the route
+    std::vector<Pose> trace;
+    for (const MacroPose& pose : poses) {
+        if (trace.empty() || trace.back().distance(pose.pose) > MIN_MACRO_MOVE) trace.push_back(pose.pose);
+    }
+    if (trace.size() < 2) {
+        infoSink()->error("The robot didn't move in the driver macro! Can't make a path from it");
+        return Path();
+    }
+    // the simplified path keeps the points it doesn't remove exactly, so they are found in the trace in order, along
+    // with the heading the robot had there
+    const Path simplified = Path(trace).decimate(options.tolerance);
+    std::vector<Waypoint> waypoints;
+    size_t next = 0;
+    for (size_t i = 0; i < simplified.size(); i++) {
+        const Pose point = simplified.at(i);
+        while (next < trace.size() && (trace[next].x != point.x || trace[next].y != point.y)) next++;
+        if (next == trace.size()) break;
+        // the direction the robot was going, which is behind it if it was driving backwards
+        const Pose& before = trace[next == 0 ? 0 : next - 1];
+        const Pose& after = trace[std::min(next + 1, trace.size() - 1)];
+        const float travel = radToDeg(std::atan2(after.x - before.x, after.y - before.y));
+        const float heading = trace[next].theta;
+        const bool backwards = std::fabs(angleError(travel, heading, false)) > 90;
+        waypoints.push_back({point.x, point.y, backwards ? heading + 180 : heading});
+    }
+    for (size_t i = 1; i + 1 < waypoints.size(); i++) {
+        // a waypoint the route passes through in the opposite direction of the one before is a reversal
+        if (std::fabs(angleError(waypoints[i].theta, waypoints[i - 1].theta, false)) > MAX_MACRO_TURN) {
+            infoSink()->warn("The driver macro reverses near ({}, {}). Record each direction as its own macro",
+                             waypoints[i].x, waypoints[i].y);
+            break;
+        }
+    }
+    return generatePath(arena, waypoints, options.constraints);
+}
+} // namespace lemlib
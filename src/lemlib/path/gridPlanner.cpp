@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "pros/rtos.hpp"
+#include "lemlib/path/gridPlanner.hpp"
+#include "lemlib/logger/logger.hpp"
+#include "lemlib/util.hpp"
+
+// the cost level of a cell the center of the robot can't be in
+constexpr uint8_t BLOCKED = 3;
+// how much more a step into a cell of each cost level costs than a step into a free cell. Blocked cells are only
+// entered while leaving the obstacle the robot started in, so they cost the same as free ones
+constexpr float LEVEL_COST[] = {1, 1.5, 3, 1};
+// the position in the open list of a cell that isn't in it, and of a cell that has been expanded
+constexpr uint32_t NOT_OPEN = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t CLOSED = NOT_OPEN - 1;
+// the most times the curves of a path are tightened when they clip an obstacle
+constexpr int MAX_TIGHTENS = 4;
+
+namespace lemlib {
+GridPlanner::GridPlanner(GridPlannerSettings settings)
+    : settings(settings) {}
+
+void GridPlanner::addRectangle(float x1, float y1, float x2, float y2) {
+    obstacles.push_back({std::fmin(x1, x2), std::fmin(y1, y2), std::fmax(x1, x2), std::fmax(y1, y2), -1});
+}
+
+void GridPlanner::addCircle(float x, float y, float radius) { obstacles.push_back({x, y, x, y, std::fabs(radius)}); }
+
+void GridPlanner::clearObstacles() { obstacles.clear(); }
+
+void GridPlanner::build() {
+    settings.resolution = std::fmax(settings.resolution, 0.25f);
+    width = size_t(std::ceil(settings.fieldSize / settings.resolution));
+    const size_t cells = width * width;
+    grid.assign((cells + 3) / 4, 0);
+    const float half = settings.fieldSize / 2;
+    for (size_t cell = 0; cell < cells; cell++) {
+        const Pose center = cellCenter(cell);
+        // the distance from the center of the cell to the closest wall or obstacle
+        float distance = half - std::fmax(std::fabs(center.x), std::fabs(center.y));
+        for (const Obstacle& obstacle : obstacles) {
+            const float dx = std::fmax(std::fmax(obstacle.x1 - center.x, center.x - obstacle.x2), 0);
+            const float dy = std::fmax(std::fmax(obstacle.y1 - center.y, center.y - obstacle.y2), 0);
+            distance = std::fmin(distance, std::hypot(dx, dy) - std::fmax(obstacle.radius, 0));
+        }
+        uint8_t level = 0;
+        if (distance < settings.robotRadius) level = BLOCKED;
+        else if (distance < settings.robotRadius + settings.clearance / 2) level = 2;
+        else if (distance < settings.robotRadius + settings.clearance) level = 1;
+        grid[cell / 4] |= level << (cell % 4 * 2);
+    }
+    // every plan reuses this memory, so planning doesn't allocate
+    cost.assign(cells, 0);
+    parent.assign(cells, 0);
+    visited.assign(cells, 0);
+    heapPosition.assign(cells, NOT_OPEN);
+    heap.assign(cells, 0);
+    priority.assign(cells, 0);
+    // routes rarely wind across the field more than a few times
+    route.reserve(width * 4);
+    waypoints.reserve(width * 4);
+    searchId = 0;
+}
+
+bool GridPlanner::isFree(float x, float y) const { return !grid.empty() && levelAt(x, y) != BLOCKED; }
+
+GridPlanStats GridPlanner::getLastStats() const { return stats; }
+
+uint8_t GridPlanner::level(size_t cell) const { return (grid[cell / 4] >> (cell % 4 * 2)) & 3; }
+
+uint8_t GridPlanner::levelAt(float x, float y) const {
+    const int cell = cellAt(x, y);
+    return cell < 0 ? BLOCKED : level(cell);
+}
+
+int GridPlanner::cellAt(float x, float y) const {
+    const float half = settings.fieldSize / 2;
+    const int col = int(std::floor((x + half) / settings.resolution));
+    const int row = int(std::floor((y + half) / settings.resolution));
+    if (col < 0 || row < 0 || size_t(col) >= width || size_t(row) >= width) return -1;
+    return row * int(width) + col;
+}
+
+Pose GridPlanner::cellCenter(size_t cell) const {
+    const float half = settings.fieldSize / 2;
+    return Pose(-half + (cell % width + 0.5f) * settings.resolution,
+                -half + (cell / width + 0.5f) * settings.resolution);
+}
+
+void GridPlanner::siftUp(size_t position) {
+    const uint32_t cell = heap[position];
+    while (position > 0) {
+        const size_t above = (position - 1) / 2;
+        if (priority[heap[above]] <= priority[cell]) break;
+        heap[position] = heap[above];
+        heapPosition[heap[position]] = position;
+        position = above;
+    }
+    heap[position] = cell;
+    heapPosition[cell] = position;
+}
+
+void GridPlanner::siftDown(size_t position) {
+    const uint32_t cell = heap[position];
+    while (true) {
+        size_t below = position * 2 + 1;
+        if (below >= heapSize) break;
+        if (below + 1 < heapSize && priority[heap[below + 1]] < priority[heap[below]]) below++;
+        if (priority[cell] <= priority[heap[below]]) break;
+        heap[position] = heap[below];
+        heapPosition[heap[position]] = position;
+        position = below;
+    }
+    heap[position] = cell;
+    heapPosition[cell] = position;
+}
+
+bool GridPlanner::search(size_t start, size_t goal) {
+    // cells visited by an older search count as unvisited, until the id wraps around
+    if (++searchId == 0) {
+        std::fill(visited.begin(), visited.end(), 0);
+        searchId = 1;
+    }
+    const int goalCol = goal % width;
+    const int goalRow = goal / width;
+    // octile distance, the shortest path on an 8 connected grid with nothing in the way
+    const auto heuristic = [&](size_t cell) {
+        const int dx = std::abs(int(cell % width) - goalCol);
+        const int dy = std::abs(int(cell / width) - goalRow);
+        return (std::max(dx, dy) + (float(M_SQRT2) - 1) * std::min(dx, dy)) * settings.resolution;
+    };
+    const auto visit = [&](size_t cell) {
+        if (visited[cell] == searchId) return;
+        visited[cell] = searchId;
+        cost[cell] = INFINITY;
+        heapPosition[cell] = NOT_OPEN;
+    };
+
+    visit(start);
+    cost[start] = 0;
+    parent[start] = start;
+    priority[start] = heuristic(start);
+    heap[0] = start;
+    heapPosition[start] = 0;
+    heapSize = 1;
+    while (heapSize > 0) {
+        const uint32_t current = heap[0];
+        if (current == goal) return true;
+        // take the cell with the lowest cost plus heuristic off the open list
+        heapPosition[current] = CLOSED;
+        if (--heapSize > 0) {
+            heap[0] = heap[heapSize];
+            siftDown(0);
+        }
+        stats.expanded++;
+
+        const int col = current % width;
+        const int row = current / width;
+        const bool escaping = level(current) == BLOCKED;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) continue;
+                const int nextCol = col + dx;
+                const int nextRow = row + dy;
+                if (nextCol < 0 || nextRow < 0 || nextCol >= int(width) || nextRow >= int(width)) continue;
+                const size_t next = nextRow * width + nextCol;
+                // blocked cells can be left, but not entered
+                const uint8_t nextLevel = level(next);
+                if (nextLevel == BLOCKED && !escaping) continue;
+                // diagonal steps can't cut the corner of a blocked cell
+                if (dx != 0 && dy != 0 && !escaping &&
+                    (level(row * width + nextCol) == BLOCKED || level(nextRow * width + col) == BLOCKED))
+                    continue;
+                visit(next);
+                if (heapPosition[next] == CLOSED) continue;
+                const float step = (dx != 0 && dy != 0 ? float(M_SQRT2) : 1) * settings.resolution;
+                const float nextCost = cost[current] + step * LEVEL_COST[nextLevel];
+                if (nextCost >= cost[next]) continue;
+                cost[next] = nextCost;
+                parent[next] = current;
+                priority[next] = nextCost + heuristic(next);
+                if (heapPosition[next] == NOT_OPEN) {
+                    heap[heapSize] = next;
+                    siftUp(heapSize++);
+                } else {
+                    siftUp(heapPosition[next]);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+bool GridPlanner::lineOfSight(Pose from, Pose to, uint8_t maxLevel) const {
+    // check every half cell along the line
+    const float length = from.distance(to);
+    const int steps = std::max(int(std::ceil(length / (settings.resolution / 2))), 1);
+    for (int step = 0; step <= steps; step++) {
+        const Pose point = from.lerp(to, float(step) / steps);
+        if (levelAt(point.x, point.y) > maxLevel) return false;
+    }
+    return true;
+}
+
+Path GridPlanner::plan(PathArena& arena, Pose start, float x, float y, const PathConstraints& constraints) {
+    const uint32_t startTime = pros::micros();
+    stats = GridPlanStats();
+    if (grid.empty()) {
+        infoSink()->error("Grid planner isn't built! Call build before planning");
+        return Path();
+    }
+    const Pose target(x, y);
+    const int goalCell = cellAt(x, y);
+    const int startCell = cellAt(start.x, start.y);
+    if (goalCell < 0 || level(goalCell) == BLOCKED) {
+        infoSink()->warn("Can't plan to ({}, {}), it is blocked or off the field", x, y);
+        return Path();
+    }
+    if (startCell < 0) {
+        infoSink()->warn("Can't plan from ({}, {}), it is off the field", start.x, start.y);
+        return Path();
+    }
+    if (!search(startCell, goalCell)) {
+        infoSink()->warn("No path from ({}, {}) to ({}, {})", start.x, start.y, x, y);
+        stats.time = pros::micros() - startTime;
+        return Path();
+    }
+
+    // walk back from the goal to find the cells the search went through
+    route.clear();
+    for (uint32_t cell = goalCell; cell != uint32_t(startCell); cell = parent[cell]) route.push_back(cell);
+    route.push_back(startCell);
+    std::reverse(route.begin(), route.end());
+    const size_t last = route.size() - 1;
+    // the robot starts and ends where it was asked to, instead of on the center of a cell
+    const auto point = [&](size_t i) {
+        if (i == 0) return Pose(start.x, start.y);
+        return i == last ? target : cellCenter(route[i]);
+    };
+
+    // the robot leaves the grown obstacle it started in along the route, then cuts the corners of the rest of the
+    // route wherever it can see past them, without getting closer to obstacles than the route did
+    waypoints.clear();
+    waypoints.push_back({start.x, start.y, 0});
+    size_t anchor = 0;
+    while (anchor < last && level(route[anchor]) == BLOCKED) anchor++;
+    if (anchor > 0) waypoints.push_back({point(anchor).x, point(anchor).y, 0});
+    while (anchor < last) {
+        size_t furthest = anchor + 1;
+        uint8_t maxLevel = level(route[furthest]);
+        for (size_t next = anchor + 2; next <= last; next++) {
+            maxLevel = std::max(maxLevel, level(route[next]));
+            if (!lineOfSight(point(anchor), point(next), maxLevel)) break;
+            furthest = next;
+        }
+        waypoints.push_back({point(furthest).x, point(furthest).y, 0});
+        anchor = furthest;
+    }
+    if (waypoints.size() < 2) waypoints.push_back({x, y, 0});
+
+    // each waypoint points between the segments on either side of it, so the path turns through it smoothly
+    for (size_t i = 0; i < waypoints.size(); i++) {
+        const Waypoint& before = waypoints[i == 0 ? 0 : i - 1];
+        const Waypoint& after = waypoints[std::min(i + 1, waypoints.size() - 1)];
+        const Waypoint& current = waypoints[i];
+        float dx = 0;
+        float dy = 0;
+        for (const auto& [from, to] : {std::pair(&before, &current), std::pair(&current, &after)}) {
+            const float length = std::hypot(to->x - from->x, to->y - from->y);
+            if (length == 0) continue;
+            dx += (to->x - from->x) / length;
+            dy += (to->y - from->y) / length;
+        }
+        waypoints[i].theta = radToDeg(std::atan2(dx, dy));
+    }
+    stats.waypoints = waypoints.size();
+
+    // curves can bulge into an obstacle the straight lines avoided, so they are tightened until they don't
+    PathConstraints tightened = constraints;
+    for (int attempt = 0; attempt < MAX_TIGHTENS; attempt++) {
+        Path path = generatePath(arena, waypoints, tightened);
+        if (path.size() == 0) break;
+        bool clear = true;
+        bool leaving = true;
+        for (size_t i = 0; i < path.size() && clear; i++) {
+            const Pose pathPoint = path.at(i);
+            const bool blocked = levelAt(pathPoint.x, pathPoint.y) == BLOCKED;
+            if (!blocked) leaving = false;
+            clear = !blocked || leaving;
+        }
+        if (clear) {
+            stats.found = true;
+            stats.time = pros::micros() - startTime;
+            return path;
+        }
+        arena.release(path.size());
+        tightened.tangentScale /= 2;
+    }
+    infoSink()->warn("Planned path to ({}, {}) clips an obstacle, so it was dropped", x, y);
+    stats.time = pros::micros() - startTime;
+    return Path();
+}
+} // namespace lemlib
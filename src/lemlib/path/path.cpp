@@ -0,0 +1,544 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#ifdef __ARM_NEON
+#include <arm_neon.h>
+#endif
+#include "lemlib/path/path.hpp"
+#include "lemlib/path/generator.hpp"
+#include "lemlib/binaryFile.hpp"
+#include "lemlib/logger/logger.hpp"
+
+namespace lemlib {
+Path::Path(const std::vector<Pose>& points)
+    : storage(points.size() * 3),
+      count(points.size()) {
+    // x, y, and velocity arrays are stored back to back
+    for (size_t i = 0; i < count; i++) {
+        storage[i] = points[i].x;
+        storage[count + i] = points[i].y;
+        storage[2 * count + i] = points[i].theta;
+    }
+    xData = storage.data();
+    yData = storage.data() + count;
+    velocityData = storage.data() + 2 * count;
+    index();
+}
+
+Path::Path(const float* x, const float* y, const float* velocity, size_t size)
+    : xData(x),
+      yData(y),
+      velocityData(velocity),
+      count(size) {
+    index();
+}
+
+Path::Path(const float* x, const float* y, const float* velocity, size_t size, float* indexStorage)
+    : xData(x),
+      yData(y),
+      velocityData(velocity),
+      count(size) {
+    index(indexStorage);
+}
+
+Path::Path(const float* x, const float* y, const float* velocity, size_t size, const float* index, float spacing)
+    : spacing(spacing),
+      curvatures(index),
+      distances(index + size),
+      segmentLengths(index + 2 * size),
+      directionsX(index + 3 * size),
+      directionsY(index + 4 * size),
+      xData(x),
+      yData(y),
+      velocityData(velocity),
+      count(size) {}
+
+void Path::index(float* memory) {
+    if (memory == nullptr) {
+        indexStorage.resize(count * INDEX_FLOATS);
+        memory = indexStorage.data();
+    }
+    // each array of the index is stored back to back
+    float* curvatures = memory;
+    float* distances = memory + count;
+    float* segmentLengths = memory + 2 * count;
+    float* directionsX = memory + 3 * count;
+    float* directionsY = memory + 4 * count;
+    this->curvatures = curvatures;
+    this->distances = distances;
+    this->segmentLengths = segmentLengths;
+    this->directionsX = directionsX;
+    this->directionsY = directionsY;
+    float distance = 0;
+    for (size_t i = 0; i < count; i++) {
+        distances[i] = distance;
+        // the last point doesn't start a segment
+        if (i + 1 == count) {
+            segmentLengths[i] = 0;
+            directionsX[i] = 0;
+            directionsY[i] = 0;
+            break;
+        }
+        const float dx = xData[i + 1] - xData[i];
+        const float dy = yData[i + 1] - yData[i];
+        const float length = std::hypot(dx, dy);
+        segmentLengths[i] = length;
+        // prevent divide by 0 if 2 points are in the same place
+        directionsX[i] = length == 0 ? 0 : dx / length;
+        directionsY[i] = length == 0 ? 0 : dy / length;
+        distance += length;
+    }
+    // the curvature at each point is the curvature of the circle through it and its neighbours
+    for (size_t i = 0; i < count; i++) {
+        if (i == 0 || i + 1 == count) {
+            curvatures[i] = 0;
+            continue;
+        }
+        const float ax = xData[i] - xData[i - 1], ay = yData[i] - yData[i - 1];
+        const float bx = xData[i + 1] - xData[i], by = yData[i + 1] - yData[i];
+        const float product = segmentLengths[i - 1] * segmentLengths[i] *
+                              std::hypot(xData[i + 1] - xData[i - 1], yData[i + 1] - yData[i - 1]);
+        // prevent divide by 0 if 2 points are in the same place
+        curvatures[i] = product == 0 ? 0 : 2 * (ax * by - ay * bx) / product;
+    }
+}
+
+size_t Path::closest(Pose pose, size_t start, size_t end, float& closestDist) const {
+    // squared distances are compared, so only 1 square root is needed
+    size_t closestPoint = start;
+    float closestSquared = INFINITY;
+    size_t i = start;
+#ifdef __ARM_NEON
+    // compare 4 points at a time, keeping the closest point seen in each lane
+    if (end >= start + 4) {
+        const float32x4_t poseX = vdupq_n_f32(pose.x);
+        const float32x4_t poseY = vdupq_n_f32(pose.y);
+        const uint32_t firstIndices[4] = {uint32_t(start), uint32_t(start + 1), uint32_t(start + 2),
+                                          uint32_t(start + 3)};
+        uint32x4_t indices = vld1q_u32(firstIndices);
+        float32x4_t best = vdupq_n_f32(INFINITY);
+        uint32x4_t bestIndices = indices;
+        for (; i + 4 <= end; i += 4) {
+            const float32x4_t dx = vsubq_f32(vld1q_f32(xData + i), poseX);
+            const float32x4_t dy = vsubq_f32(vld1q_f32(yData + i), poseY);
+            const float32x4_t squared = vmlaq_f32(vmulq_f32(dx, dx), dy, dy);
+            const uint32x4_t closer = vcltq_f32(squared, best);
+            best = vbslq_f32(closer, squared, best);
+            bestIndices = vbslq_u32(closer, indices, bestIndices);
+            indices = vaddq_u32(indices, vdupq_n_u32(4));
+        }
+        // find the closest of the 4 lanes. Ties go to the earlier point, like the scalar search
+        float lanes[4];
+        uint32_t laneIndices[4];
+        vst1q_f32(lanes, best);
+        vst1q_u32(laneIndices, bestIndices);
+        closestPoint = laneIndices[0];
+        closestSquared = lanes[0];
+        for (int lane = 1; lane < 4; lane++) {
+            if (lanes[lane] < closestSquared || (lanes[lane] == closestSquared && laneIndices[lane] < closestPoint)) {
+                closestSquared = lanes[lane];
+                closestPoint = laneIndices[lane];
+            }
+        }
+    }
+#endif
+    // search the remaining points
+    for (; i < end; i++) {
+        const float dx = xData[i] - pose.x;
+        const float dy = yData[i] - pose.y;
+        const float squared = dx * dx + dy * dy;
+        if (squared < closestSquared) {
+            closestSquared = squared;
+            closestPoint = i;
+        }
+    }
+    closestDist = std::sqrt(closestSquared);
+    return closestPoint;
+}
+
+size_t Path::segmentAt(float distance) const {
+    if (count < 2) return 0;
+    if (spacing > 0) {
+        // chords are never longer than the spacing, so the guess is at or before the segment. Corners can shorten a
+        // few chords, so walk forward to it
+        size_t i = std::min(size_t(std::fmax(distance, 0.0f) / spacing), count - 2);
+        while (i + 2 < count && distances[i + 1] <= distance) i++;
+        while (i > 0 && distances[i] > distance) i--;
+        return i;
+    }
+    // find the first point further along the path than the distance
+    const size_t next = std::upper_bound(distances, distances + count, distance) - distances;
+    // the segment starts at the point before it, and the last point doesn't start a segment
+    return std::clamp<size_t>(next, 1, count - 1) - 1;
+}
+
+Pose Path::pointAt(float distance) const {
+    if (count == 0) return Pose(0, 0);
+    const size_t i = segmentAt(distance);
+    const float along = std::clamp(distance - distances[i], 0.0f, segmentLengths[i]);
+    return Pose(xData[i] + directionsX[i] * along, yData[i] + directionsY[i] * along, velocityData[i]);
+}
+
+float Path::project(Pose pose, size_t index) const {
+    float closestDist = INFINITY;
+    float projected = distances[index];
+    // check the segment before the point and the segment after it
+    for (size_t i = index == 0 ? 0 : index - 1; i <= index && i + 1 < count; i++) {
+        const float along =
+            std::clamp((pose.x - xData[i]) * directionsX[i] + (pose.y - yData[i]) * directionsY[i], 0.0f,
+                       segmentLengths[i]);
+        const float dist = std::hypot(pose.x - (xData[i] + directionsX[i] * along),
+                                      pose.y - (yData[i] + directionsY[i] * along));
+        if (dist < closestDist) {
+            closestDist = dist;
+            projected = distances[i] + along;
+        }
+    }
+    return projected;
+}
+
+void Path::planVelocity(const PathConstraints& constraints, float voltageScale) {
+    if (count == 0) return;
+    // paths that own their points are changed in place, other paths get their own copy of the velocities
+    float* velocities;
+    if (!storage.empty()) {
+        velocities = storage.data() + 2 * count;
+    } else {
+        plannedVelocities.resize(count);
+        velocities = plannedVelocities.data();
+    }
+    velocityData = velocities;
+
+    const float maxVelocity = constraints.maxVelocity * std::clamp(voltageScale, 0.0f, 1.0f);
+    const float minVelocity = std::fmin(constraints.minVelocity, maxVelocity);
+    for (size_t i = 0; i < count; i++) {
+        float velocity = maxVelocity;
+        const float curvature = std::fabs(curvatures[i]);
+        if (constraints.k > 0 && curvature > 0) velocity = std::fmin(velocity, constraints.k / curvature);
+        velocities[i] = std::fmax(velocity, minVelocity);
+    }
+    limitAcceleration(*this, velocities, minVelocity, constraints.maxAcceleration);
+    velocities[count - 1] = 0;
+}
+
+void limitAcceleration(const Path& path, float* velocities, float minVelocity, float maxAcceleration) {
+    if (maxAcceleration <= 0 || path.size() == 0) return;
+    // v^2 = v0^2 + 2 * a * d, from the minimum velocity at each end. The last point is left to the caller
+    float prev = minVelocity;
+    for (size_t i = 0; i + 1 < path.size(); i++) {
+        const float length = i == 0 ? 0 : path.segmentLength(i - 1);
+        velocities[i] = std::fmin(velocities[i], std::sqrt(prev * prev + 2 * maxAcceleration * length));
+        prev = velocities[i];
+    }
+    float next = minVelocity;
+    for (size_t i = path.size() - 1; i-- > 0;) {
+        velocities[i] = std::fmin(velocities[i], std::sqrt(next * next + 2 * maxAcceleration * path.segmentLength(i)));
+        next = velocities[i];
+    }
+}
+
+Path Path::resample(float spacing) const {
+    if (count < 2 || spacing <= 0) {
+        std::vector<Pose> points;
+        for (size_t i = 0; i < count; i++) points.push_back(at(i));
+        return Path(points);
+    }
+    std::vector<Pose> points;
+    points.reserve(size_t(length() / spacing) + 2);
+    size_t segment = 0;
+    // leave out a point that would be right next to the last point
+    for (float distance = 0; distance < length() - spacing * 0.25f; distance += spacing) {
+        while (segment + 2 < count && distances[segment + 1] <= distance) segment++;
+        const float t = segmentLengths[segment] == 0 ? 0 : (distance - distances[segment]) / segmentLengths[segment];
+        // lerp keeps the theta of the first point, so each point takes the velocity of the segment it is on
+        points.push_back(at(segment).lerp(at(segment + 1), std::clamp(t, 0.0f, 1.0f)));
+    }
+    points.push_back(at(count - 1));
+    Path path(points);
+    path.spacing = spacing;
+    return path;
+}
+
+Path Path::transformed(const FieldTransform& transform) const {
+    std::vector<Pose> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        const Pose moved = transform.apply(Pose(xData[i], yData[i]));
+        points.emplace_back(moved.x, moved.y, velocityData[i]);
+    }
+    Path path(points);
+    path.spacing = spacing;
+    return path;
+}
+
+/**
+ * @brief Find the distance from a point to a line segment
+ */
+static float segmentDistance(Pose point, Pose start, Pose end) {
+    const Pose line = end - start;
+    const float lengthSquared = line * line;
+    if (lengthSquared == 0) return point.distance(start);
+    const float t = std::clamp(((point - start) * line) / lengthSquared, 0.0f, 1.0f);
+    return point.distance(start + line * t);
+}
+
+Path Path::decimate(float tolerance) const {
+    std::vector<bool> keep(count, tolerance <= 0);
+    if (count > 0) keep.front() = keep.back() = true;
+    // iterative Douglas-Peucker, so long paths can't overflow the stack
+    std::vector<std::pair<size_t, size_t>> ranges;
+    if (count > 2 && tolerance > 0) ranges.push_back({0, count - 1});
+    while (!ranges.empty()) {
+        const auto [first, last] = ranges.back();
+        ranges.pop_back();
+        float furthest = 0;
+        size_t index = first;
+        for (size_t i = first + 1; i < last; i++) {
+            const float distance = segmentDistance(at(i), at(first), at(last));
+            if (distance > furthest) {
+                furthest = distance;
+                index = i;
+            }
+        }
+        if (furthest <= tolerance) continue;
+        keep[index] = true;
+        ranges.push_back({first, index});
+        ranges.push_back({index, last});
+    }
+    std::vector<Pose> points;
+    for (size_t i = 0; i < count; i++) {
+        if (keep[i]) points.push_back(at(i));
+    }
+    return Path(points);
+}
+
+bool isBinaryPath(const asset& path) {
+    if (path.size < sizeof(BinaryPathHeader)) return false;
+    uint32_t magic;
+    std::memcpy(&magic, path.buf, sizeof(magic));
+    return magic == BINARY_PATH_MAGIC;
+}
+
+Path readBinaryPath(const asset& path) {
+    if (!isBinaryPath(path)) {
+        infoSink()->error("Asset is not a binary path!");
+        return Path();
+    }
+    BinaryPathHeader header;
+    std::memcpy(&header, path.buf, sizeof(header));
+    // check that the path was generated for this version of LemLib
+    if (header.version != BINARY_PATH_VERSION) {
+        infoSink()->error("Unsupported binary path version {}, expected {}", header.version, BINARY_PATH_VERSION);
+        return Path();
+    }
+    // check that the asset is big enough to hold all the points
+    if (path.size < sizeof(BinaryPathHeader) + header.size * 3 * sizeof(float)) {
+        infoSink()->error("Binary path is truncated! Expected {} points", header.size);
+        return Path();
+    }
+    // floats can't be loaded from unaligned addresses by the FPU
+    if (reinterpret_cast<uintptr_t>(path.buf) % alignof(float) != 0) {
+        infoSink()->error("Binary path is not aligned! Was it built with asset.mk?");
+        return Path();
+    }
+    const float* data = reinterpret_cast<const float*>(path.buf + sizeof(BinaryPathHeader));
+    return Path(data, data + header.size, data + 2 * header.size, header.size);
+}
+
+bool writeBinaryPath(const Path& path, const std::string& filename) {
+    if (path.size() == 0) {
+        infoSink()->error("Can't write an empty path to {}!", filename);
+        return false;
+    }
+    const uint32_t size = path.size();
+    const BinaryPathHeader header {BINARY_PATH_MAGIC, BINARY_PATH_VERSION, 0, size, 0};
+    std::vector<uint8_t> data(sizeof(header) + size * 3 * sizeof(float));
+    std::memcpy(data.data(), &header, sizeof(header));
+    float* points = reinterpret_cast<float*>(data.data() + sizeof(header));
+    for (size_t i = 0; i < size; i++) {
+        points[i] = path.at(i).x;
+        points[size + i] = path.at(i).y;
+        points[2 * size + i] = path.velocity(i);
+    }
+    return writeFile(filename, data);
+}
+
+bool isCompressedPath(const asset& path) {
+    if (path.size < sizeof(CompressedPathHeader)) return false;
+    uint32_t magic;
+    std::memcpy(&magic, path.buf, sizeof(magic));
+    return magic == COMPRESSED_PATH_MAGIC;
+}
+
+Path readCompressedPath(const asset& path) {
+    if (!isCompressedPath(path)) {
+        infoSink()->error("Asset is not a compressed path!");
+        return Path();
+    }
+    CompressedPathHeader header;
+    std::memcpy(&header, path.buf, sizeof(header));
+    if (header.version != COMPRESSED_PATH_VERSION) {
+        infoSink()->error("Unsupported compressed path version {}, expected {}", header.version,
+                          COMPRESSED_PATH_VERSION);
+        return Path();
+    }
+    // the first point, then x deltas, y deltas, and velocities
+    const size_t size = header.size;
+    if (path.size < sizeof(CompressedPathHeader) + 2 * sizeof(int32_t) + size * (2 * sizeof(int16_t) + 1)) {
+        infoSink()->error("Compressed path is truncated! Expected {} points", size);
+        return Path();
+    }
+    // the asset may not be aligned, so every value is copied out instead of read in place
+    const uint8_t* data = path.buf + sizeof(CompressedPathHeader);
+    int32_t x;
+    int32_t y;
+    std::memcpy(&x, data, sizeof(x));
+    std::memcpy(&y, data + sizeof(x), sizeof(y));
+    const uint8_t* dx = data + 2 * sizeof(int32_t);
+    const uint8_t* dy = dx + size * sizeof(int16_t);
+    const uint8_t* velocity = dy + size * sizeof(int16_t);
+    std::vector<Pose> points;
+    points.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        int16_t deltaX;
+        int16_t deltaY;
+        std::memcpy(&deltaX, dx + i * sizeof(int16_t), sizeof(deltaX));
+        std::memcpy(&deltaY, dy + i * sizeof(int16_t), sizeof(deltaY));
+        x += deltaX;
+        y += deltaY;
+        points.emplace_back(x / 100.0f, y / 100.0f, velocity[i] * header.velocityScale);
+    }
+    return Path(points);
+}
+
+/**
+ * @brief Convert a string to hex
+ *
+ * @param input the string to convert
+ * @return std::string hexadecimal output
+ */
+static std::string stringToHex(std::string_view input) {
+    static const char hex_digits[] = "0123456789ABCDEF";
+
+    std::string output;
+    output.reserve(input.length() * 2);
+    for (unsigned char c : input) {
+        output.push_back(hex_digits[c >> 4]);
+        output.push_back(hex_digits[c & 15]);
+    }
+    return output;
+}
+
+/**
+ * @brief Parse a decimal number from the start of a string, and remove it from the string
+ *
+ * Path files only contain plain decimals like -12.345, so this is much simpler than std::stof, and works on a
+ * string_view that isn't null terminated
+ *
+ * @param input the string. The number is removed from the front of it
+ * @param value set to the number
+ * @return true a number was read
+ * @return false the string doesn't start with a number
+ */
+static bool parseNumber(std::string_view& input, float& value) {
+    size_t i = 0;
+    const bool negative = i < input.size() && input[i] == '-';
+    if (negative || (i < input.size() && input[i] == '+')) i++;
+    double number = 0;
+    double scale = 1;
+    bool digits = false;
+    for (; i < input.size() && input[i] >= '0' && input[i] <= '9'; i++, digits = true)
+        number = number * 10 + (input[i] - '0');
+    if (i < input.size() && input[i] == '.') {
+        for (i++; i < input.size() && input[i] >= '0' && input[i] <= '9'; i++, digits = true) {
+            scale /= 10;
+            number += (input[i] - '0') * scale;
+        }
+    }
+    if (!digits) return false;
+    // exponents, in case a path generator writes very small numbers
+    if (i < input.size() && (input[i] == 'e' || input[i] == 'E')) {
+        size_t j = i + 1;
+        const bool negativeExponent = j < input.size() && input[j] == '-';
+        if (negativeExponent || (j < input.size() && input[j] == '+')) j++;
+        int exponent = 0;
+        bool exponentDigits = false;
+        for (; j < input.size() && input[j] >= '0' && input[j] <= '9'; j++, exponentDigits = true)
+            exponent = std::min(exponent * 10 + (input[j] - '0'), 64);
+        if (exponentDigits) {
+            number *= std::pow(10.0, negativeExponent ? -exponent : exponent);
+            i = j;
+        }
+    }
+    value = negative ? -number : number;
+    input.remove_prefix(i);
+    return true;
+}
+
+/**
+ * @brief Remove spaces and tabs from the start of a string
+ */
+static void skipSpaces(std::string_view& input) {
+    while (!input.empty() && (input.front() == ' ' || input.front() == '\t')) input.remove_prefix(1);
+}
+
+/**
+ * @brief Parse a point from a line of a text path, in the form "x, y, velocity"
+ *
+ * @param line the line, without the newline
+ * @param point set to the point. The velocity is stored in theta
+ * @return true the line was a point
+ * @return false the line couldn't be read
+ */
+static bool parsePoint(std::string_view line, Pose& point) {
+    float values[3];
+    for (int i = 0; i < 3; i++) {
+        skipSpaces(line);
+        if (!parseNumber(line, values[i])) return false;
+        skipSpaces(line);
+        if (i < 2) {
+            if (line.empty() || line.front() != ',') return false;
+            line.remove_prefix(1);
+        }
+    }
+    // nothing but a carriage return can be left on the line
+    if (!line.empty() && line.front() == '\r') line.remove_prefix(1);
+    if (!line.empty()) return false;
+    point = Pose(values[0], values[1], values[2]);
+    return true;
+}
+
+Path loadPath(const asset& path) {
+    // binary paths don't need to be parsed
+    if (isBinaryPath(path)) return readBinaryPath(path);
+    if (isCompressedPath(path)) return readCompressedPath(path);
+
+    // the path is parsed in place, without copying it
+    std::string_view data(reinterpret_cast<const char*>(path.buf), path.size);
+    // every point is on its own line, so the line count is enough space for every point
+    std::vector<Pose> robotPath;
+    robotPath.reserve(std::count(data.begin(), data.end(), '\n') + 1);
+
+    // read the points until 'endData' is read
+    while (!data.empty()) {
+        const size_t newline = data.find('\n');
+        const std::string_view line = data.substr(0, newline);
+        data.remove_prefix(newline == std::string_view::npos ? data.size() : newline + 1);
+        if (line == "endData" || line == "endData\r") break;
+        Pose pathPoint(0, 0);
+        // check if the line was read correctly
+        if (!parsePoint(line, pathPoint)) {
+            infoSink()->error("Failed to read path file! Are you using the right format? Raw line: {}",
+                              stringToHex(line));
+            break;
+        }
+        robotPath.push_back(pathPoint); // save data
+    }
+    LEMLIB_DEBUG("read {} points from text path", robotPath.size());
+
+    return Path(robotPath);
+}
+} // namespace lemlib
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include "pros/misc.hpp"
+#include "lemlib/binaryFile.hpp"
+#include "lemlib/path/pathCache.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// battery voltage the maximum velocity of a path is planned for, in millivolts
+constexpr float NOMINAL_VOLTAGE = 12000;
+
+namespace lemlib {
+const Path& PathCache::get(const asset& path, const FieldTransform& transform) {
+    mutex.take();
+    auto it = paths.find(path.buf);
+    // nodes in a std::map are never moved, so the reference can be returned after the mutex is given back
+    if (it == paths.end()) {
+        Path loaded = loadPath(path);
+        // fewer, evenly spaced points make the searches done every iteration of follow cheaper
+        if (loadOptions.spacing > 0) loaded = loaded.resample(loadOptions.spacing);
+        if (loadOptions.tolerance > 0) loaded = loaded.decimate(loadOptions.tolerance);
+        it = paths.emplace(path.buf, std::move(loaded)).first;
+        plan(it->second);
+    }
+    const Path& loaded = it->second;
+    if (transform.isIdentity()) {
+        mutex.give();
+        return loaded;
+    }
+    // transform the loaded path, so it is only parsed and simplified once however many ways it is transformed
+    const TransformKey key {path.buf, transform.mirrorX, transform.mirrorY, transform.rotation};
+    auto moved = transformedPaths.find(key);
+    if (moved == transformedPaths.end()) {
+        moved = transformedPaths.emplace(key, loaded.transformed(transform)).first;
+        plan(moved->second);
+    }
+    const Path& out = moved->second;
+    mutex.give();
+    return out;
+}
+
+const Trajectory& PathCache::getTrajectory(const asset& path, bool forwards, const TrajectoryConstraints& constraints,
+                                           const FieldTransform& transform) {
+    // load the path first, since get takes the mutex too
+    const Path& points = get(path, transform);
+    mutex.take();
+    const TransformKey key {path.buf, transform.mirrorX, transform.mirrorY, transform.rotation};
+    auto it = trajectories.find({key, forwards});
+    if (it == trajectories.end()) {
+        std::vector<Pose> poses;
+        poses.reserve(points.size());
+        for (size_t i = 0; i < points.size(); i++) poses.push_back(points.at(i));
+        it = trajectories.emplace(std::make_pair(key, forwards), Trajectory(poses, forwards, constraints)).first;
+    }
+    const Trajectory& out = it->second;
+    mutex.give();
+    return out;
+}
+
+bool PathCache::preload(const asset& path, const FieldTransform& transform) {
+    return get(path, transform).size() != 0;
+}
+
+bool PathCache::contains(const asset& path) {
+    mutex.take();
+    const bool found = paths.find(path.buf) != paths.end();
+    mutex.give();
+    return found;
+}
+
+asset PathCache::file(const std::string& filename) {
+    fileMutex.take();
+    auto it = files.find(filename);
+    if (it == files.end()) {
+        std::vector<uint8_t> data = readFile(filename);
+        // a file that couldn't be read isn't kept, so it can be read again once the SD card is in
+        if (data.empty()) {
+            fileMutex.give();
+            infoSink()->error("Failed to read path file {}! Is the SD card in?", filename);
+            return {nullptr, 0};
+        }
+        // the buffer is never freed or moved, so the paths loaded from it can point into it
+        it = files.emplace(filename, std::move(data)).first;
+    }
+    const asset out {it->second.data(), it->second.size()};
+    fileMutex.give();
+    return out;
+}
+
+void PathCache::prefetch(const std::string& filename, const FieldTransform& transform) {
+    queueMutex.take();
+    prefetchQueue.emplace_back(filename, transform);
+    // runs below the motion task, like the task that loads the paths of queued motions
+    if (prefetchTask == nullptr) {
+        prefetchTask = new pros::Task {[this] {
+            while (true) {
+                // sleep until a file is queued
+                pros::Task::notify_take(true, TIMEOUT_MAX);
+                while (true) {
+                    queueMutex.take();
+                    if (prefetchQueue.empty()) {
+                        queueMutex.give();
+                        break;
+                    }
+                    const auto [name, pathTransform] = prefetchQueue.front();
+                    prefetchQueue.erase(prefetchQueue.begin());
+                    queueMutex.give();
+                    const asset path = file(name);
+                    if (path.size != 0 && !preload(path, pathTransform)) {
+                        infoSink()->error("Failed to load path file {}! Do you have the right format?", name);
+                    }
+                }
+            }
+        }, TASK_PRIORITY_DEFAULT - 1};
+    }
+    queueMutex.give();
+    prefetchTask->notify();
+}
+
+void PathCache::setVelocityConstraints(std::optional<PathConstraints> constraints) {
+    mutex.take();
+    this->constraints = constraints;
+    mutex.give();
+    replan();
+}
+
+void PathCache::setLoadOptions(PathLoadOptions options) {
+    mutex.take();
+    loadOptions = options;
+    mutex.give();
+}
+
+void PathCache::replan() {
+    mutex.take();
+    for (auto& [buf, path] : paths) plan(path);
+    for (auto& [key, path] : transformedPaths) plan(path);
+    mutex.give();
+}
+
+void PathCache::plan(Path& path) {
+    if (!constraints) return;
+    // a motor can't be given more than the battery voltage, so the top speed drops with it
+    const int32_t voltage = pros::battery::get_voltage();
+    const float scale = voltage > 0 ? std::min(voltage / NOMINAL_VOLTAGE, 1.0f) : 1;
+    path.planVelocity(*constraints, scale);
+}
+
+PathCache& pathCache() {
+    static PathCache pathCache;
+    return pathCache;
+}
+} // namespace lemlib
@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/path/pathView.hpp"
+#include "lemlib/logger/logger.hpp"
+
+namespace lemlib {
+PathView::PathView(const Path& path) {
+    if (path.size() == 0) return;
+    parts[0].path = &path;
+    parts[0].end = path.size();
+    partCount = 1;
+    join();
+}
+
+PathView PathView::reversed() const {
+    PathView view;
+    // the last part is driven first, from its end
+    for (size_t i = 0; i < partCount; i++) {
+        view.parts[i] = parts[partCount - 1 - i];
+        view.parts[i].reversed = !view.parts[i].reversed;
+    }
+    view.partCount = partCount;
+    view.join();
+    return view;
+}
+
+PathView PathView::subrange(size_t begin, size_t end) const {
+    PathView view;
+    end = std::min(end, count);
+    for (size_t i = 0; i < partCount && begin < end; i++) {
+        const Part& part = parts[i];
+        const size_t size = part.end - part.begin;
+        const size_t low = std::max(begin, part.first);
+        const size_t high = std::min(end, part.first + size);
+        if (low >= high) continue;
+        // trimming the start of a reversed part trims the end of its path
+        Part trimmed = part;
+        if (part.reversed) {
+            trimmed.begin = part.end - (high - part.first);
+            trimmed.end = part.end - (low - part.first);
+        } else {
+            trimmed.begin = part.begin + (low - part.first);
+            trimmed.end = part.begin + (high - part.first);
+        }
+        view.parts[view.partCount++] = trimmed;
+    }
+    view.join();
+    return view;
+}
+
+PathView PathView::then(const PathView& next) const {
+    if (partCount + next.partCount > MAX_PARTS) {
+        infoSink()->error("A path view can't have more than {} parts", MAX_PARTS);
+        return PathView();
+    }
+    PathView view = *this;
+    for (size_t i = 0; i < next.partCount; i++) view.parts[view.partCount++] = next.parts[i];
+    view.join();
+    return view;
+}
+
+PathView PathView::transformed(const FieldTransform& transform) const {
+    // the transform moves the axes to its columns, and the origin stays put
+    const Pose xAxis = transform.apply(Pose(1, 0));
+    const Pose yAxis = transform.apply(Pose(0, 1));
+    PathView view = *this;
+    for (size_t i = 0; i < partCount; i++) {
+        const Part& part = parts[i];
+        Part& moved = view.parts[i];
+        moved.xx = xAxis.x * part.xx + yAxis.x * part.yx;
+        moved.xy = xAxis.x * part.xy + yAxis.x * part.yy;
+        moved.yx = xAxis.y * part.xx + yAxis.y * part.yx;
+        moved.yy = xAxis.y * part.xy + yAxis.y * part.yy;
+    }
+    view.join();
+    return view;
+}
+
+Pose PathView::at(size_t index) const {
+    const Part& part = partOf(index);
+    Pose point = place(part, part.path->at(source(part, index - part.first)));
+    point.theta = velocity(index);
+    return point;
+}
+
+float PathView::velocity(size_t index) const {
+    if (index + 1 >= count) return 0;
+    const Part& part = partOf(index);
+    const size_t i = source(part, index - part.first);
+    // the end of a path inside the view would stop the robot, so it takes the velocity of the point before it
+    const float velocity = part.path->velocity(i);
+    return velocity == 0 && i > 0 ? part.path->velocity(i - 1) : velocity;
+}
+
+float PathView::curvature(size_t index) const {
+    if (index == 0 || index + 1 >= count) return 0;
+    const Part& part = partOf(index);
+    float curvature = part.path->curvature(source(part, index - part.first));
+    // driving a path backwards, or mirroring it, swaps which way it turns
+    if (part.reversed) curvature = -curvature;
+    if (part.xx * part.yy - part.xy * part.yx < 0) curvature = -curvature;
+    return curvature;
+}
+
+size_t PathView::closest(Pose pose, size_t start, size_t end, float& closestDist) const {
+    size_t closestPoint = start;
+    closestDist = INFINITY;
+    end = std::min(end, count);
+    for (size_t i = 0; i < partCount; i++) {
+        const Part& part = parts[i];
+        const size_t low = std::max(start, part.first);
+        const size_t high = std::min(end, part.first + (part.end - part.begin));
+        if (low >= high) continue;
+        // rotations and mirrors keep distances, so the pose is moved to the path instead of every point to the view.
+        // The inverse of the matrix is its transpose
+        const Pose local(part.xx * pose.x + part.yx * pose.y, part.xy * pose.x + part.yy * pose.y);
+        const size_t from = part.reversed ? part.end - (high - part.first) : part.begin + (low - part.first);
+        const size_t to = part.reversed ? part.end - (low - part.first) : part.begin + (high - part.first);
+        float dist;
+        const size_t point = part.path->closest(local, from, to, dist);
+        if (dist < closestDist) {
+            closestDist = dist;
+            closestPoint = part.first + (part.reversed ? part.end - 1 - point : point - part.begin);
+        }
+    }
+    return closestPoint;
+}
+
+float PathView::distance(size_t index) const {
+    const Part& part = partOf(index);
+    return part.offset + std::fabs(part.path->distance(source(part, index - part.first)) - part.start);
+}
+
+float PathView::segmentLength(size_t index) const {
+    if (index + 1 >= count) return 0;
+    const Part& part = partOf(index);
+    const size_t j = index - part.first;
+    if (j + 1 == part.end - part.begin) return part.gap;
+    const size_t i = source(part, j);
+    return part.reversed ? part.path->segmentLength(i - 1) : part.path->segmentLength(i);
+}
+
+size_t PathView::segmentAt(float distance) const {
+    if (count < 2) return 0;
+    size_t p = 0;
+    while (p + 1 < partCount && distance >= parts[p + 1].offset) p++;
+    const Part& part = parts[p];
+    const size_t size = part.end - part.begin;
+    const float along = distance - part.offset;
+    // past the end of the part, the point is on the segment joining it to the next part
+    size_t j = size - 1;
+    if (size >= 2 && along < part.length) {
+        // the path finds its own segment, which is clamped to the part
+        const float pathDistance = part.reversed ? part.start - along : part.start + along;
+        const size_t i = std::clamp(part.path->segmentAt(pathDistance), part.begin, part.end - 2);
+        // backwards, the segment from point i to i + 1 of the path starts at point i + 1
+        j = part.reversed ? part.end - 2 - i : i - part.begin;
+    }
+    return std::min(part.first + j, count - 2);
+}
+
+Pose PathView::pointAt(float distance) const {
+    if (count == 0) return Pose(0, 0);
+    if (count == 1) return at(0);
+    const size_t i = segmentAt(distance);
+    const float length = segmentLength(i);
+    const float along = std::clamp(distance - this->distance(i), 0.0f, length);
+    const Pose start = at(i);
+    Pose point = length == 0 ? start : start.lerp(at(i + 1), along / length);
+    point.theta = velocity(i);
+    return point;
+}
+
+float PathView::project(Pose pose, size_t index) const {
+    float closestDist = INFINITY;
+    float projected = distance(index);
+    // check the segment before the point and the segment after it
+    for (size_t i = index == 0 ? 0 : index - 1; i <= index && i + 1 < count; i++) {
+        const Pose start = at(i);
+        const Pose end = at(i + 1);
+        const float length = segmentLength(i);
+        // prevent divide by 0 if 2 points are in the same place
+        const float dx = length == 0 ? 0 : (end.x - start.x) / length;
+        const float dy = length == 0 ? 0 : (end.y - start.y) / length;
+        const float along = std::clamp((pose.x - start.x) * dx + (pose.y - start.y) * dy, 0.0f, length);
+        const float dist = std::hypot(pose.x - (start.x + dx * along), pose.y - (start.y + dy * along));
+        if (dist < closestDist) {
+            closestDist = dist;
+            projected = distance(i) + along;
+        }
+    }
+    return projected;
+}
+
+const PathView::Part& PathView::partOf(size_t index) const {
+    size_t p = partCount - 1;
+    while (p > 0 && parts[p].first > index) p--;
+    return parts[p];
+}
+
+size_t PathView::source(const Part& part, size_t index) {
+    return part.reversed ? part.end - 1 - index : part.begin + index;
+}
+
+Pose PathView::place(const Part& part, Pose point) {
+    return Pose(part.xx * point.x + part.xy * point.y, part.yx * point.x + part.yy * point.y, point.theta);
+}
+
+void PathView::join() {
+    count = 0;
+    float offset = 0;
+    for (size_t i = 0; i < partCount; i++) {
+        Part& part = parts[i];
+        const Path& path = *part.path;
+        // a straight segment joins the end of the last part to the start of this one
+        if (i > 0) {
+            Part& last = parts[i - 1];
+            const Pose end = place(last, last.path->at(source(last, last.end - last.begin - 1)));
+            last.gap = end.distance(place(part, path.at(source(part, 0))));
+            offset += last.gap;
+        }
+        part.first = count;
+        part.offset = offset;
+        const float first = path.distance(part.begin);
+        const float last = path.distance(part.end - 1);
+        part.start = part.reversed ? last : first;
+        part.length = last - first;
+        part.gap = 0;
+        count += part.end - part.begin;
+        offset += part.length;
+    }
+}
+} // namespace lemlib
@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/path/splinePath.hpp"
+#include "lemlib/util.hpp"
+
+// most Newton steps taken to find a point on the path
+constexpr int NEWTON_ITERATIONS = 8;
+// most the parameter can change in one Newton step, so it can't jump to a far away part of the path
+constexpr float MAX_NEWTON_STEP = 0.25;
+// Newton's method stops once a step is smaller than this
+constexpr float NEWTON_TOLERANCE = 1e-4;
+
+namespace lemlib {
+SplinePath::SplinePath(const std::vector<Waypoint>& waypoints, const PathConstraints& constraints)
+    : maxVelocity(constraints.maxVelocity),
+      minVelocity(constraints.minVelocity),
+      k(constraints.k) {
+    for (size_t i = 0; i + 1 < waypoints.size(); i++) {
+        const Waypoint& start = waypoints[i];
+        const Waypoint& end = waypoints[i + 1];
+        // tangents along the heading of each waypoint, scaled by the distance between them
+        const float length = constraints.tangentScale * std::hypot(end.x - start.x, end.y - start.y);
+        const float mx0 = length * std::sin(degToRad(start.theta));
+        const float my0 = length * std::cos(degToRad(start.theta));
+        const float mx1 = length * std::sin(degToRad(end.theta));
+        const float my1 = length * std::cos(degToRad(end.theta));
+        splines.push_back({start.x, mx0, 3 * (end.x - start.x) - 2 * mx0 - mx1, 2 * (start.x - end.x) + mx0 + mx1,
+                           start.y, my0, 3 * (end.y - start.y) - 2 * my0 - my1, 2 * (start.y - end.y) + my0 + my1});
+    }
+}
+
+const SplinePath::Spline& SplinePath::locate(float u, float& t) const {
+    u = std::clamp(u, 0.0f, float(splines.size()));
+    const size_t index = std::min(size_t(u), splines.size() - 1);
+    t = u - index;
+    return splines[index];
+}
+
+void SplinePath::evaluate(float u, Pose& point, Pose& first, Pose& second) const {
+    float t;
+    const Spline& s = locate(u, t);
+    point = Pose(s.ax + t * (s.bx + t * (s.cx + t * s.dx)), s.ay + t * (s.by + t * (s.cy + t * s.dy)));
+    first = Pose(s.bx + t * (2 * s.cx + 3 * t * s.dx), s.by + t * (2 * s.cy + 3 * t * s.dy));
+    second = Pose(2 * s.cx + 6 * t * s.dx, 2 * s.cy + 6 * t * s.dy);
+}
+
+Pose SplinePath::at(float u) const {
+    if (splines.empty()) return Pose(0, 0);
+    Pose point(0, 0), first(0, 0), second(0, 0);
+    evaluate(u, point, first, second);
+    return point;
+}
+
+float SplinePath::curvature(float u) const {
+    if (splines.empty()) return 0;
+    Pose point(0, 0), first(0, 0), second(0, 0);
+    evaluate(u, point, first, second);
+    const float speed = std::hypot(first.x, first.y);
+    if (speed == 0) return 0;
+    return (first.x * second.y - first.y * second.x) / (speed * speed * speed);
+}
+
+float SplinePath::velocity(float u) const {
+    if (splines.empty() || u >= splines.size()) return 0;
+    float velocity = maxVelocity;
+    const float curve = std::fabs(curvature(u));
+    if (k > 0 && curve > 0) velocity = std::fmin(velocity, k / curve);
+    return std::fmax(velocity, minVelocity);
+}
+
+float SplinePath::closest(Pose pose, float guess) const {
+    if (splines.empty()) return 0;
+    const float end = splines.size();
+    float u = std::clamp(guess, 0.0f, end);
+    // minimize the squared distance: the derivative, (P - pose) . P', is 0 at the closest point
+    for (int i = 0; i < NEWTON_ITERATIONS; i++) {
+        Pose point(0, 0), first(0, 0), second(0, 0);
+        evaluate(u, point, first, second);
+        const Pose offset = point - pose;
+        const float slope = offset * first;
+        const float curvature = first * first + offset * second;
+        // away from a minimum, step downhill along the path instead
+        const float step = curvature > 0 ? slope / curvature : sgn(slope) * MAX_NEWTON_STEP;
+        const float next = std::clamp(u - std::clamp(step, -MAX_NEWTON_STEP, MAX_NEWTON_STEP), 0.0f, end);
+        const bool converged = std::fabs(next - u) < NEWTON_TOLERANCE;
+        u = next;
+        if (converged) break;
+    }
+    return u;
+}
+
+float SplinePath::lookahead(Pose pose, float closest, float guess, float lookahead) const {
+    if (splines.empty()) return 0;
+    const float end = splines.size();
+    // the end of the path is within the lookahead circle
+    if (at(end).distance(pose) <= lookahead) return end;
+    float u = std::clamp(guess, closest, end);
+    // solve |P - pose|^2 = lookahead^2, never going back past the closest point
+    for (int i = 0; i < NEWTON_ITERATIONS; i++) {
+        Pose point(0, 0), first(0, 0), second(0, 0);
+        evaluate(u, point, first, second);
+        const Pose offset = point - pose;
+        const float error = offset * offset - lookahead * lookahead;
+        const float slope = 2 * (offset * first);
+        float step;
+        if (slope > 0) step = error / slope;
+        // moving along the path doesn't move away from the pose here, so step forwards until it does
+        else step = -MAX_NEWTON_STEP;
+        const float next = std::clamp(u - std::clamp(step, -MAX_NEWTON_STEP, MAX_NEWTON_STEP), closest, end);
+        const bool converged = std::fabs(next - u) < NEWTON_TOLERANCE;
+        u = next;
+        if (converged) break;
+    }
+    return u;
+}
+} // namespace lemlib
@@ -1,30 +1,104 @@
+#include <algorithm>
+#include <cmath>
 #include "pid.hpp"
 #include "util.hpp"
 
 namespace lemlib {
-PID::PID(float kP, float kI, float kD, float windupRange, bool signFlipReset)
+template <typename T> BasicPID<T>::BasicPID(T kP, T kI, T kD, T windupRange, bool signFlipReset)
     : kP(kP),
       kI(kI),
       kD(kD),
       windupRange(windupRange),
       signFlipReset(signFlipReset) {}
 
-float PID::update(const float error) {
+template <typename T> T BasicPID<T>::update(const T error) {
+    // calculate derivative
+    return update(error, error - prevError);
+}
+
+template <typename T> T BasicPID<T>::update(const T error, const T derivative) {
     // calculate integral
-    integral += error;
-    if (sgn(error) != sgn((prevError)) && signFlipReset) integral = 0;
-    if (fabs(error) > windupRange && windupRange != 0) integral = 0;
+    T integrated = error * timeStep;
+    integral += integrated;
+    if ((sgn(error) != sgn((prevError)) && signFlipReset) || (fabs(error) > windupRange && windupRange != 0)) {
+        integral = 0;
+        integrated = 0;
+    }
 
-    // calculate derivative
-    const float derivative = error - prevError;
     prevError = error;
 
+    // filter the derivative. The smoothing factor depends on the time step, so the filter is the same at any rate
+    T rate = derivative / timeStep;
+    if (derivativeFilter > 0) {
+        filteredDerivative += (rate - filteredDerivative) * timeStep / (derivativeFilter + timeStep);
+        rate = filteredDerivative;
+    }
+
     // calculate output
-    return error * kP + integral * kI + derivative * kD;
+    T gainP = kP;
+    T gainI = kI;
+    T gainD = kD;
+    if (schedule) {
+        const bool byError = schedule->getKey() == ScheduleKey::ERROR;
+        const Gains gains = schedule->lookup(float(byError ? error : derivative / timeStep));
+        gainP = gains.kP;
+        gainI = gains.kI;
+        gainD = gains.kD;
+    }
+    terms = {error * gainP, integral * gainI, rate * gainD, error};
+    T output = terms.p + terms.i + terms.d;
+    if (outputLimit <= 0 || fabs(output) <= outputLimit) return output;
+
+    // the output is limited, so stop the integral from winding up
+    const T limited = std::clamp(output, -outputLimit, outputLimit);
+    if (antiWindup == AntiWindup::CLAMP && sgn(error) == sgn(output)) {
+        // undo this update of the integral, since it would only push the output further past the limit
+        output -= integrated * gainI;
+        integral -= integrated;
+        terms.i = integral * gainI;
+    } else if (antiWindup == AntiWindup::BACK_CALCULATION && gainI != 0) {
+        integral += (limited - output) / gainI * backCalculationGain * timeStep;
+    }
+    return std::clamp(output, -outputLimit, outputLimit);
+}
+
+template <typename T> void BasicPID<T>::setDerivativeFilter(const T timeConstant) {
+    this->derivativeFilter = std::max(timeConstant, T(0));
+}
+
+template <typename T>
+void BasicPID<T>::setOutputLimit(const T limit, const AntiWindup antiWindup, const T backCalculationGain) {
+    this->outputLimit = fabs(limit);
+    this->antiWindup = antiWindup;
+    this->backCalculationGain = backCalculationGain;
+}
+
+template <typename T> void BasicPID<T>::setGainSchedule(std::optional<GainSchedule> schedule) {
+    this->schedule = schedule;
+}
+
+template <typename T> void BasicPID<T>::setTimeStep(const T timeStep) {
+    // a time step of 0 would make the derivative infinite
+    if (timeStep > 0) this->timeStep = timeStep;
 }
 
-void PID::reset() {
+template <typename T> void BasicPID<T>::setGains(const T kP, const T kI, const T kD) {
+    this->kP = kP;
+    this->kI = kI;
+    this->kD = kD;
+}
+
+template <typename T> void BasicPID<T>::reset() {
     integral = 0;
     prevError = 0;
+    filteredDerivative = 0;
+    terms = Terms();
 }
+
+template <typename T> const typename BasicPID<T>::Terms& BasicPID<T>::getTerms() const { return terms; }
+
+// compile each precision once, instead of in every file that uses it
+template class BasicPID<float>;
+template class BasicPID<double>;
+template class BasicPID<Fixed>;
 } // namespace lemlib
\ No newline at end of file
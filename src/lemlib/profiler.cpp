@@ -0,0 +1,65 @@
+#include <atomic>
+#include <chrono>
+#include "lemlib/profiler.hpp"
+#include "lemlib/logger/logger.hpp"
+
+// clock speed of the brain's CPU, in MHz
+constexpr uint32_t CPU_MHZ = 667;
+
+// the first site in the list. Sites are only ever added to the front
+static std::atomic<lemlib::ProfileSite*> sites = nullptr;
+
+#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+/**
+ * @brief Start the cycle counter of the performance monitor
+ *
+ * PROS runs tasks in a privileged mode, so the performance monitor can be set up directly
+ */
+static bool enableCycleCounter() {
+    uint32_t control;
+    asm volatile("mrc p15, 0, %0, c9, c12, 0" : "=r"(control));
+    // enable the counters, without dividing the cycle count by 64
+    asm volatile("mcr p15, 0, %0, c9, c12, 0" ::"r"((control | 1) & ~uint32_t(8)));
+    // enable the cycle counter
+    asm volatile("mcr p15, 0, %0, c9, c12, 1" ::"r"(1u << 31));
+    return true;
+}
+
+uint32_t lemlib::readCycles() {
+    static const bool enabled = enableCycleCounter();
+    (void)enabled;
+    uint32_t cycles;
+    asm volatile("mrc p15, 0, %0, c9, c13, 0" : "=r"(cycles));
+    return cycles;
+}
+#else
+uint32_t lemlib::readCycles() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+#endif
+
+lemlib::ProfileSite::ProfileSite(const char* name)
+    : name(name),
+      next(sites.load()) {
+    // push onto the front of the list. If another site was added in the meantime, next is updated to it
+    while (!sites.compare_exchange_weak(next, this));
+}
+
+void lemlib::dumpProfile() {
+    for (ProfileSite* site = sites.load(); site != nullptr; site = site->next) {
+        if (site->count == 0) continue;
+        const float average = float(site->total) / site->count;
+        infoSink()->info("profile {}: {} calls, {} cycles ({} us) average, {} cycles max", site->name, site->count,
+                         average, average / CPU_MHZ, site->max);
+    }
+}
+
+void lemlib::resetProfile() {
+    for (ProfileSite* site = sites.load(); site != nullptr; site = site->next) {
+        site->count = 0;
+        site->total = 0;
+        site->max = 0;
+    }
+}
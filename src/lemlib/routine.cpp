@@ -0,0 +1,155 @@
+#include <algorithm>
+#include "pros/rtos.hpp"
+#include "lemlib/routine.hpp"
+#include "lemlib/matchClock.hpp"
+
+// how often a routine that can't be woken by a callback is resumed, in milliseconds
+constexpr uint32_t POLL_PERIOD = 10;
+
+/**
+ * @brief Motion callback that wakes the task running a routine
+ *
+ * @param task the task
+ */
+static void wakeTask(void* task) { pros::c::task_notify(static_cast<pros::task_t>(task)); }
+
+lemlib::Routine& lemlib::Routine::then(std::function<void()> action) {
+    Step step {StepType::ACTION};
+    step.action = action;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::start(std::function<MotionHandle()> motion) {
+    Step step {StepType::START};
+    step.motion = motion;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::move(std::function<MotionHandle()> motion) {
+    return this->start(motion).waitUntilDone(*this);
+}
+
+lemlib::Routine& lemlib::Routine::waitUntilDone(const Routine& routine, int motion) {
+    Step step {StepType::WAIT_DONE};
+    step.routine = &routine;
+    step.index = motion;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::waitUntilProgress(const Routine& routine, int motion, float progress) {
+    Step step {StepType::WAIT_PROGRESS};
+    step.routine = &routine;
+    step.index = motion;
+    step.value = progress;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::delay(uint32_t time) {
+    Step step {StepType::DELAY};
+    step.value = time;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::waitFor(std::function<bool()> condition) {
+    Step step {StepType::CONDITION};
+    step.condition = condition;
+    this->steps.push_back(step);
+    return *this;
+}
+
+lemlib::Routine& lemlib::Routine::requireTime(uint32_t time) {
+    Step step {StepType::REQUIRE_TIME};
+    step.value = time;
+    this->steps.push_back(step);
+    return *this;
+}
+
+bool lemlib::Routine::isDone() const { return this->current >= this->steps.size(); }
+
+void lemlib::Routine::run() { runConcurrently({this}); }
+
+void lemlib::Routine::runConcurrently(std::initializer_list<Routine*> routines) {
+    void* task = pros::c::task_get_current();
+    for (Routine* routine : routines) routine->reset();
+    while (true) {
+        // resume every routine, and sleep until the first one has to be resumed again
+        uint32_t timeout = TIMEOUT_MAX;
+        bool done = true;
+        for (Routine* routine : routines) {
+            if (routine->isDone()) continue;
+            timeout = std::min(timeout, routine->resume(task));
+            done = done && routine->isDone();
+        }
+        if (done) return;
+        pros::Task::notify_take(true, timeout);
+    }
+}
+
+void lemlib::Routine::reset() {
+    this->motions.clear();
+    this->current = 0;
+    this->waiting = false;
+}
+
+bool lemlib::Routine::getMotion(int index, MotionHandle& motion) const {
+    if (index < 0) index += this->motions.size();
+    if (index < 0 || size_t(index) >= this->motions.size()) return false;
+    motion = this->motions[index];
+    return true;
+}
+
+uint32_t lemlib::Routine::resume(void* task) {
+    while (!this->isDone()) {
+        Step& step = this->steps[this->current];
+        if (!this->waiting) {
+            this->waiting = true;
+            this->registered = false;
+            this->notified = false;
+            this->waitStart = pros::millis();
+        }
+        switch (step.type) {
+            case StepType::ACTION: step.action(); break;
+            case StepType::START: this->motions.push_back(step.motion()); break;
+            case StepType::WAIT_DONE:
+            case StepType::WAIT_PROGRESS: {
+                MotionHandle motion;
+                if (!step.routine->getMotion(step.index, motion)) return POLL_PERIOD; // not started yet
+                const bool waitForEnd = step.type == StepType::WAIT_DONE;
+                if (motion.isDone() || (!waitForEnd && motion.progress() > step.value)) break;
+                // ask the motion to wake the task when the step is done
+                if (!this->registered) {
+                    this->registered = true;
+                    this->notified = motion.onDone(wakeTask, task);
+                    if (!waitForEnd) this->notified = motion.onProgress(step.value, wakeTask, task) && this->notified;
+                }
+                // poll if every callback slot was taken
+                return this->notified ? TIMEOUT_MAX : POLL_PERIOD;
+            }
+            case StepType::DELAY: {
+                const uint32_t elapsed = pros::millis() - this->waitStart;
+                if (elapsed < step.value) return step.value - elapsed;
+                break;
+            }
+            case StepType::CONDITION:
+                if (!step.condition()) return POLL_PERIOD;
+                break;
+            case StepType::REQUIRE_TIME:
+                // skip the rest of the steps. Outside of a match there is no time to run out of
+                if (matchClock().isTimed() && matchClock().getRemaining() < step.value) {
+                    this->current = this->steps.size();
+                    this->waiting = false;
+                    return TIMEOUT_MAX;
+                }
+                break;
+        }
+        // the step is done, so move on to the next one
+        this->current++;
+        this->waiting = false;
+    }
+    return TIMEOUT_MAX;
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include "lemlib/scheduler.hpp"
+
+namespace lemlib {
+Scheduler::Scheduler(uint32_t priority)
+    : task([this] { taskLoop(); }, priority) {
+    monitor.attach(task);
+}
+
+int Scheduler::addJob(const char* name, uint32_t period, Callback callback, void* arg) {
+    addMutex.take();
+    const size_t index = count.load();
+    if (index == MAX_JOBS) {
+        addMutex.give();
+        return -1;
+    }
+    Job& job = jobs[index];
+    job.name = name;
+    job.callback = callback;
+    job.arg = arg;
+    job.period = std::max(period, uint32_t(1));
+    count.store(index + 1, std::memory_order_release);
+    addMutex.give();
+    // wake the task, so it can schedule the job
+    task.notify();
+    return int(index);
+}
+
+void Scheduler::setPeriod(int job, uint32_t period) {
+    if (job < 0 || size_t(job) >= count.load()) return;
+    jobs[job].period = std::max(period, uint32_t(1));
+}
+
+JobStats Scheduler::getStats(int job) const {
+    if (job < 0 || size_t(job) >= count.load()) return {};
+    const Job& scheduled = jobs[job];
+    return {scheduled.name,      scheduled.period.load(), scheduled.runs,
+            scheduled.overruns, scheduled.maxBusy,      scheduled.maxLateness};
+}
+
+void Scheduler::taskLoop() {
+    const uint32_t epoch = pros::millis();
+    size_t seen = 0;
+    while (true) {
+        const size_t added = count.load(std::memory_order_acquire);
+        // release new jobs on a multiple of their period after the epoch, so their phase doesn't depend on when they
+        // were added
+        for (uint32_t now = pros::millis(); seen < added; seen++) {
+            Job& job = jobs[seen];
+            const uint32_t period = job.period;
+            job.next = epoch + (now - epoch + period - 1) / period * period;
+        }
+        const uint32_t start = pros::micros();
+        // the due jobs, shortest period first. Jobs with the same period run in the order they were added
+        std::array<size_t, MAX_JOBS> due;
+        size_t dueCount = 0;
+        const uint32_t now = pros::millis();
+        for (size_t i = 0; i < seen; i++) {
+            if (int32_t(now - jobs[i].next) < 0) continue;
+            size_t position = dueCount++;
+            for (; position > 0 && jobs[due[position - 1]].period > jobs[i].period; position--) {
+                due[position] = due[position - 1];
+            }
+            due[position] = i;
+        }
+        bool missed = false;
+        for (size_t i = 0; i < dueCount; i++) {
+            Job& job = jobs[due[i]];
+            const uint32_t jobStart = pros::micros();
+            job.callback(job.arg, job.next);
+            const uint32_t end = pros::micros();
+            const uint32_t lateness = std::max(int32_t(jobStart - job.next * 1000), int32_t(0));
+            job.runs++;
+            job.maxBusy = std::max(job.maxBusy, end - jobStart);
+            job.maxLateness = std::max(job.maxLateness, lateness);
+            // skip the releases the job ran past, so it stays in phase instead of running several times in a row
+            const uint32_t period = job.period;
+            job.next += period;
+            for (const uint32_t finished = pros::millis(); int32_t(finished - job.next) >= 0; job.next += period) {
+                job.overruns++;
+                missed = true;
+            }
+        }
+        if (dueCount > 0) monitor.record(pros::micros() - start, missed);
+        // sleep until the next job is due, or a job is added
+        uint32_t wait = TIMEOUT_MAX;
+        const uint32_t after = pros::millis();
+        for (size_t i = 0; i < seen; i++) {
+            wait = std::min(wait, uint32_t(std::max(int32_t(jobs[i].next - after), int32_t(0))));
+        }
+        if (wait > 0) pros::Task::notify_take(true, wait);
+    }
+}
+} // namespace lemlib
@@ -0,0 +1,106 @@
+#include <malloc.h>
+#include "lemlib/staticMemory.hpp"
+
+#ifdef LEMLIB_STATIC_MEMORY
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+#include "pros/rtos.h"
+
+// most tasks that can be in a hot path at once. LemLib only uses 2, the rest are for the user
+constexpr int HOT_PATH_SLOTS = 8;
+
+// the tasks that are in a hot path. A task only ever clears the slot it claimed
+static std::atomic<pros::task_t> hotPathTasks[HOT_PATH_SLOTS] = {};
+// number of tasks in a hot path, so allocations don't look for the current task while there are none
+static std::atomic<int> hotPathCount = 0;
+// heap allocations made in hot paths
+static std::atomic<uint32_t> hotPathAllocations = 0;
+// heap allocations made anywhere
+static std::atomic<uint32_t> allocations = 0;
+
+/**
+ * @brief Find the slot of a task, or nullptr if it isn't in a hot path
+ */
+static std::atomic<pros::task_t>* findSlot(pros::task_t task) {
+    for (std::atomic<pros::task_t>& slot : hotPathTasks) {
+        if (slot.load(std::memory_order_relaxed) == task) return &slot;
+    }
+    return nullptr;
+}
+
+void lemlib::beginHotPath() {
+    const pros::task_t current = pros::c::task_get_current();
+    if (findSlot(current) != nullptr) return;
+    for (std::atomic<pros::task_t>& slot : hotPathTasks) {
+        pros::task_t expected = nullptr;
+        if (slot.compare_exchange_strong(expected, current)) {
+            hotPathCount++;
+            return;
+        }
+    }
+    // every slot is taken, so the task isn't checked
+}
+
+void lemlib::endHotPath() {
+    std::atomic<pros::task_t>* slot = findSlot(pros::c::task_get_current());
+    if (slot == nullptr) return;
+    *slot = nullptr;
+    hotPathCount--;
+}
+
+bool lemlib::inHotPath() { return hotPathCount > 0 && findSlot(pros::c::task_get_current()) != nullptr; }
+
+uint32_t lemlib::getHotPathAllocations() { return hotPathAllocations; }
+
+/**
+ * @brief Allocate memory, and count it if the current task is in a hot path
+ *
+ * Nothing here may allocate or log, since logging allocates
+ */
+static void* allocate(std::size_t size) {
+    allocations++;
+    if (lemlib::inHotPath()) {
+        hotPathAllocations++;
+        assert(!"heap allocation in a LemLib hot path");
+    }
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+// replacing the global allocation functions is how every allocation, including the ones in the standard library, is
+// seen. The deallocation functions are replaced too so they match
+void* operator new(std::size_t size) {
+    void* pointer = allocate(size);
+    if (pointer == nullptr) throw std::bad_alloc();
+    return pointer;
+}
+
+void* operator new[](std::size_t size) { return operator new(size); }
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+#endif
+
+lemlib::HeapUsage lemlib::getHeapUsage() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    // glibc, which the simulator runs on, replaced mallinfo
+    const struct mallinfo2 info = mallinfo2();
+#else
+    const struct mallinfo info = mallinfo();
+#endif
+#ifdef LEMLIB_STATIC_MEMORY
+    return {size_t(info.uordblks), size_t(info.arena), allocations};
+#else
+    return {size_t(info.uordblks), size_t(info.arena), 0};
+#endif
+}
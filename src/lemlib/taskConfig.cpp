@@ -0,0 +1,26 @@
+#include <algorithm>
+#include "lemlib/taskConfig.hpp"
+
+/**
+ * @brief Get the configuration. Made on first use, since tasks can be made before main
+ */
+static lemlib::TaskConfig& taskConfig() {
+    static lemlib::TaskConfig config;
+    return config;
+}
+
+/**
+ * @brief Keep a priority in the range the RTOS accepts
+ */
+static lemlib::TaskSettings clampPriority(lemlib::TaskSettings settings) {
+    settings.priority = std::clamp(settings.priority, uint32_t(TASK_PRIORITY_MIN), uint32_t(TASK_PRIORITY_MAX));
+    return settings;
+}
+
+namespace lemlib {
+void setTaskConfig(const TaskConfig& config) {
+    taskConfig() = {clampPriority(config.tracking), clampPriority(config.motion), clampPriority(config.logger)};
+}
+
+const TaskConfig& getTaskConfig() { return taskConfig(); }
+} // namespace lemlib
@@ -0,0 +1,102 @@
+#include <algorithm>
+#include "lemlib/taskMonitor.hpp"
+#include "lemlib/logger/logger.hpp"
+
+#if defined(__arm__) && defined(__ARM_ARCH_7A__)
+// part of the FreeRTOS kernel PROS is built on, but not declared in the PROS headers
+extern "C" unsigned long uxTaskGetStackHighWaterMark(void* task);
+
+/**
+ * @brief Get the least free stack a task has ever had, in words
+ */
+static uint32_t stackHighWaterMark(pros::task_t task) { return uxTaskGetStackHighWaterMark(task); }
+#else
+static uint32_t stackHighWaterMark(pros::task_t) { return 0; }
+#endif
+
+/**
+ * @brief Get the list of monitors. Made on first use, since monitors can be constructed before main
+ */
+static std::vector<lemlib::TaskMonitor*>& monitors() {
+    static std::vector<lemlib::TaskMonitor*> list;
+    return list;
+}
+
+/**
+ * @brief Get the mutex that protects the list of monitors
+ */
+static pros::Mutex& monitorsMutex() {
+    static pros::Mutex mutex;
+    return mutex;
+}
+
+lemlib::TaskMonitor::TaskMonitor(const char* name)
+    : name(name) {
+    monitorsMutex().take();
+    monitors().push_back(this);
+    monitorsMutex().give();
+}
+
+lemlib::TaskMonitor::~TaskMonitor() {
+    monitorsMutex().take();
+    std::vector<TaskMonitor*>& list = monitors();
+    list.erase(std::remove(list.begin(), list.end(), this), list.end());
+    monitorsMutex().give();
+}
+
+void lemlib::TaskMonitor::attach(pros::Task& task, uint32_t stackSize) {
+    this->task = static_cast<pros::task_t>(task);
+    this->stackSize = stackSize;
+    this->reset();
+}
+
+void lemlib::TaskMonitor::record(uint32_t busy, bool missedDeadline) {
+    this->busy += busy;
+    this->iterations++;
+    if (missedDeadline) this->missedDeadlines++;
+}
+
+lemlib::TaskHealth lemlib::TaskMonitor::getHealth() const {
+    const uint64_t elapsed = pros::micros() - this->since;
+    pros::Task task(this->task);
+    return {this->name,
+            task.get_priority(),
+            this->stackSize,
+            stackHighWaterMark(this->task),
+            elapsed == 0 ? 0 : std::min(float(this->busy) / elapsed, 1.0f),
+            this->iterations,
+            this->missedDeadlines};
+}
+
+void lemlib::TaskMonitor::reset() {
+    this->since = pros::micros();
+    this->busy = 0;
+    this->iterations = 0;
+    this->missedDeadlines = 0;
+}
+
+bool lemlib::TaskMonitor::isAttached() const { return this->task != nullptr; }
+
+std::vector<lemlib::TaskHealth> lemlib::getTaskHealth() {
+    std::vector<TaskHealth> health;
+    monitorsMutex().take();
+    for (const TaskMonitor* monitor : monitors()) {
+        if (monitor->isAttached()) health.push_back(monitor->getHealth());
+    }
+    monitorsMutex().give();
+    return health;
+}
+
+void lemlib::reportTaskHealth() {
+    // the health is collected first, so the mutex isn't held while the sink formats the messages
+    for (const TaskHealth& health : getTaskHealth()) {
+        telemetrySink()->info("task,{},{},{},{},{:.1f},{},{}", health.name, health.priority, health.stackSize,
+                              health.stackFree, health.cpuShare * 100, health.iterations, health.missedDeadlines);
+    }
+}
+
+void lemlib::resetTaskHealth() {
+    monitorsMutex().take();
+    for (TaskMonitor* monitor : monitors()) monitor->reset();
+    monitorsMutex().give();
+}
@@ -4,63 +4,62 @@
 using namespace lemlib;
 
 Timer::Timer(uint32_t time)
-    : period(time) {
-    lastTime = pros::millis();
+    : period(uint64_t(time) * 1000) {
+    lastTime = pros::micros();
 }
 
-uint32_t Timer::getTimeSet() {
-    const uint32_t time = pros::millis(); // get time from RTOS
-    if (!paused) timeWaited += time - lastTime; // don't update if paused
-    lastTime = time; // update last time
-    return period;
+void Timer::update(uint64_t now) {
+    // a timestamp captured before the timer was reset doesn't move it backwards
+    if (!paused && now > lastTime) timeWaited += now - lastTime; // don't update if paused
+    if (now > lastTime) lastTime = now; // update last time
 }
 
-uint32_t Timer::getTimeLeft() {
-    const uint32_t time = pros::millis(); // get time from RTOS
-    if (!paused) timeWaited += time - lastTime; // don't update if paused
-    lastTime = time; // update last time
-    const int delta = period - timeWaited; // calculate how much time is left
-    return (delta > 0) ? delta : 0; // return 0 if timer is done
+uint32_t Timer::getTimeSet() { return period / 1000; }
+
+uint32_t Timer::getTimeLeft() { return getTimeLeft(pros::micros()); }
+
+uint32_t Timer::getTimeLeft(uint64_t now) { return getTimeLeftMicros(now) / 1000; }
+
+uint64_t Timer::getTimeLeftMicros(uint64_t now) {
+    update(now);
+    return (timeWaited < period) ? period - timeWaited : 0; // return 0 if timer is done
 }
 
-uint32_t Timer::getTimePassed() {
-    const uint32_t time = pros::millis(); // get time from RTOS
-    if (!paused) timeWaited += time - lastTime; // don't update if paused
-    lastTime = time; // update last time;
+uint32_t Timer::getTimePassed() { return getTimePassed(pros::micros()); }
+
+uint32_t Timer::getTimePassed(uint64_t now) { return getTimePassedMicros(now) / 1000; }
+
+uint64_t Timer::getTimePassedMicros(uint64_t now) {
+    update(now);
     return timeWaited;
 }
 
-bool Timer::isDone() {
-    const uint32_t time = pros::millis(); // get time from RTOS
-    if (!paused) timeWaited += time - lastTime; // don't update if paused
-    lastTime = time; // update last time
-    const int delta = period - timeWaited; // calculate how much time is left
-    return delta <= 0;
-}
+bool Timer::isDone() { return isDone(pros::micros()); }
 
-bool Timer::isPaused() {
-    const uint32_t time = pros::millis(); // get time from RTOS
-    if (!paused) timeWaited += time - lastTime; // don't update if paused
-    return paused;
+bool Timer::isDone(uint64_t now) {
+    update(now);
+    return timeWaited >= period;
 }
 
+bool Timer::isPaused() { return paused; }
+
 void Timer::set(uint32_t time) {
-    period = time; // set how long to wait
+    period = uint64_t(time) * 1000; // set how long to wait
     reset();
 }
 
 void Timer::reset() {
     timeWaited = 0;
-    lastTime = pros::millis();
+    lastTime = pros::micros();
 }
 
 void Timer::pause() {
-    if (!paused) lastTime = pros::millis();
+    if (!paused) update(pros::micros());
     paused = true;
 }
 
 void Timer::resume() {
-    if (paused) lastTime = pros::millis();
+    if (paused) lastTime = pros::micros();
     paused = false;
 }
 
@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <cmath>
+#include "lemlib/trajectory.hpp"
+#include "lemlib/util.hpp"
+
+// distance between the points of a boomerang trajectory, in inches
+constexpr float BOOMERANG_STEP = 0.5;
+// most points a boomerang trajectory can have, in case the curve never reaches the target
+constexpr int BOOMERANG_MAX_POINTS = 4096;
+
+/**
+ * @brief Find the signed curvature of the circle through 3 points
+ *
+ * @return float the curvature, positive when the points turn counterclockwise. 0 if the points are in a line
+ */
+static float curvature(const lemlib::Pose& a, const lemlib::Pose& b, const lemlib::Pose& c) {
+    const float cross = (b.x - a.x) * (c.y - b.y) - (b.y - a.y) * (c.x - b.x);
+    const float lengths = a.distance(b) * b.distance(c) * a.distance(c);
+    return lengths == 0 ? 0 : 2 * cross / lengths;
+}
+
+lemlib::Trajectory::Trajectory(const std::vector<Pose>& points, bool forwards,
+                               const TrajectoryConstraints& constraints) {
+    const size_t count = points.size();
+    this->states.resize(count);
+    if (count == 0) return;
+    for (size_t i = 0; i < count; i++) {
+        this->states[i].x = points[i].x;
+        this->states[i].y = points[i].y;
+    }
+    if (count == 1) return;
+
+    // curvature, and the fastest velocity the robot can take it at without slipping
+    std::vector<float> curvatures(count, 0);
+    std::vector<float> speeds(count, constraints.maxVelocity);
+    for (size_t i = 1; i + 1 < count; i++) {
+        curvatures[i] = curvature(points[i - 1], points[i], points[i + 1]);
+        if (curvatures[i] == 0 || constraints.horizontalDrift <= 0) continue;
+        // the same slip limit moveToPose uses, converted from motor power to inches per second
+        const float slip = std::sqrt(constraints.horizontalDrift / std::fabs(curvatures[i]) * 9.8);
+        speeds[i] = std::fmin(speeds[i], slip * constraints.topSpeed / 127);
+    }
+
+    // limit the velocity by the acceleration, starting and ending at rest
+    std::vector<float> lengths(count, 0);
+    for (size_t i = 0; i + 1 < count; i++) lengths[i] = points[i].distance(points[i + 1]);
+    speeds.front() = 0;
+    speeds.back() = 0;
+    for (size_t i = 1; i < count; i++) {
+        const float prev = speeds[i - 1];
+        speeds[i] = std::fmin(speeds[i], std::sqrt(prev * prev + 2 * constraints.maxAcceleration * lengths[i - 1]));
+    }
+    for (size_t i = count - 1; i-- > 0;) {
+        const float next = speeds[i + 1];
+        speeds[i] = std::fmin(speeds[i], std::sqrt(next * next + 2 * constraints.maxAcceleration * lengths[i]));
+    }
+
+    // the time to drive each segment, assuming the acceleration is constant along it
+    const float sign = forwards ? 1 : -1;
+    for (size_t i = 0; i < count; i++) {
+        TrajectoryState& state = this->states[i];
+        const size_t next = std::min(i + 1, count - 1);
+        const size_t prev = next - 1;
+        const float travel = std::atan2(points[next].y - points[prev].y, points[next].x - points[prev].x);
+        state.theta = forwards ? travel : travel + M_PI;
+        state.velocity = sign * speeds[i];
+        state.angularVelocity = speeds[i] * curvatures[i];
+        if (i + 1 < count && lengths[i] > 0) {
+            state.acceleration = sign * (speeds[i + 1] * speeds[i + 1] - speeds[i] * speeds[i]) / (2 * lengths[i]);
+            const float average = (speeds[i] + speeds[i + 1]) / 2;
+            this->states[i + 1].time = state.time + (average > 0 ? lengths[i] / average : 0);
+        } else if (i + 1 < count) {
+            this->states[i + 1].time = state.time;
+        }
+    }
+}
+
+lemlib::Trajectory lemlib::Trajectory::boomerang(Pose start, Pose target, float lead, bool forwards,
+                                                 const TrajectoryConstraints& constraints) {
+    // the direction the robot travels in when it reaches the target
+    const float heading = forwards ? target.theta : target.theta + M_PI;
+    const Pose direction(std::cos(heading), std::sin(heading));
+    // drive towards the carrot point, which slides towards the target as the robot gets closer
+    std::vector<Pose> points = {Pose(start.x, start.y)};
+    Pose position(start.x, start.y);
+    while (points.size() < BOOMERANG_MAX_POINTS) {
+        const float distance = position.distance(target);
+        if (distance <= BOOMERANG_STEP) break;
+        const Pose carrot = Pose(target.x, target.y) - direction * (lead * distance);
+        const Pose toCarrot = carrot - position;
+        const float length = std::hypot(toCarrot.x, toCarrot.y);
+        if (length == 0) break;
+        position = position + toCarrot * (BOOMERANG_STEP / length);
+        points.push_back(position);
+    }
+    points.push_back(Pose(target.x, target.y));
+    return Trajectory(points, forwards, constraints);
+}
+
+size_t lemlib::Trajectory::indexAt(float time) const {
+    if (this->states.empty()) return 0;
+    const auto it = std::upper_bound(this->states.begin(), this->states.end(), time,
+                                     [](float time, const TrajectoryState& state) { return time < state.time; });
+    return it == this->states.begin() ? 0 : it - this->states.begin() - 1;
+}
+
+lemlib::TrajectoryState lemlib::Trajectory::sample(float time) const {
+    if (this->states.empty()) return {};
+    if (time <= 0) return this->states.front();
+    if (time >= this->getDuration()) return this->states.back();
+    const size_t index = this->indexAt(time);
+    const TrajectoryState& a = this->states[index];
+    const TrajectoryState& b = this->states[index + 1];
+    const float span = b.time - a.time;
+    const float t = span > 0 ? (time - a.time) / span : 0;
+    TrajectoryState state = a;
+    state.time = time;
+    state.x = a.x + (b.x - a.x) * t;
+    state.y = a.y + (b.y - a.y) * t;
+    state.theta = a.theta + angleError(b.theta, a.theta) * t;
+    state.velocity = a.velocity + (b.velocity - a.velocity) * t;
+    state.angularVelocity = a.angularVelocity + (b.angularVelocity - a.angularVelocity) * t;
+    return state;
+}
+
+float lemlib::Trajectory::getDuration() const { return this->states.empty() ? 0 : this->states.back().time; }
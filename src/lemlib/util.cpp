@@ -1,5 +1,6 @@
 #include <vector>
 #include "lemlib/pose.hpp"
+#include "lemlib/profiler.hpp"
 #include "lemlib/util.hpp"
 
 float lemlib::slew(float target, float current, float maxChange) {
@@ -10,12 +11,8 @@ float lemlib::slew(float target, float current, float maxChange) {
     return current + change;
 }
 
-constexpr float lemlib::sanitizeAngle(float angle, bool radians) {
-    if (radians) return std::fmod(std::fmod(angle, 2 * M_PI) + 2 * M_PI, 2 * M_PI);
-    else return std::fmod(std::fmod(angle, 360) + 360, 360);
-}
-
 float lemlib::angleError(float target, float position, bool radians, AngularDirection direction) {
+    LEMLIB_PROFILE_SCOPE("angleError");
     // bound angles from 0 to 2pi or 0 to 360
     target = sanitizeAngle(target, radians);
     target = sanitizeAngle(target, radians);
@@ -31,7 +28,7 @@ float lemlib::angleError(float target, float position, bool radians, AngularDire
     }
 }
 
-float lemlib::avg(std::vector<float> values) {
+float lemlib::avg(const std::vector<float>& values) {
     float sum = 0;
     for (float value : values) { sum += value; }
     return sum / values.size();
@@ -42,14 +39,13 @@ float lemlib::ema(float current, float previous, float smooth) {
 }
 
 float lemlib::getCurvature(Pose pose, Pose other) {
-    // calculate whether the pose is on the left or right side of the circle
-    float side = lemlib::sgn(std::sin(pose.theta) * (other.x - pose.x) - std::cos(pose.theta) * (other.y - pose.y));
-    // calculate center point and radius
-    float a = -std::tan(pose.theta);
-    float c = std::tan(pose.theta) * pose.x - pose.y;
-    float x = std::fabs(a * other.x + other.y + c) / std::sqrt((a * a) + 1);
-    float d = std::hypot(other.x - pose.x, other.y - pose.y);
-
-    // return curvature
-    return side * ((2 * x) / (d * d));
+    LEMLIB_PROFILE_SCOPE("getCurvature");
+    const float dx = other.x - pose.x;
+    const float dy = other.y - pose.y;
+    const float distanceSquared = dx * dx + dy * dy;
+    if (distanceSquared == 0) return 0;
+    // rotate the offset into the frame of the first pose. The circle is tangent to its heading, so its curvature
+    // only depends on the sideways part of the offset. There is no tan, so every heading works
+    const float sideways = dy * std::cos(pose.theta) - dx * std::sin(pose.theta);
+    return -2 * sideways / distanceSquared;
 }
\ No newline at end of file
@@ -1,3 +1,5 @@
+// the on-brain microbenchmarks in microbench.cpp replace this program when built with MICROBENCH=1
+#ifndef LEMLIB_MICROBENCH
 #include "main.h"
 #include "lemlib/api.hpp"
 #include "lemlib/chassis/chassis.hpp"
@@ -184,3 +186,4 @@ void opcontrol() {
         pros::delay(10);
     }
 }
+#endif
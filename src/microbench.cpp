@@ -0,0 +1,110 @@
+// Microbenchmarks of the math the control loops run every iteration, timed on the brain with the cycle counter.
+// Built instead of main.cpp with "make clean && make MICROBENCH=1", then uploaded like any other program. The
+// results are printed to the terminal
+#ifdef LEMLIB_MICROBENCH
+#include <cmath>
+#include <cstdio>
+#include "main.h"
+#include "lemlib/api.hpp"
+
+// clock speed of the brain's CPU, in MHz
+constexpr float CPU_MHZ = 667;
+// number of calls timed for each function
+constexpr uint32_t ITERATIONS = 2000000;
+// calls timed at once. Short enough that the cycle counter can't wrap around during a batch
+constexpr uint32_t BATCH = 100000;
+
+/**
+ * @brief Stop the compiler from optimizing away a value
+ */
+template <typename T> static inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * @brief Time a function over ITERATIONS calls
+ *
+ * @param function called with the number of the call, so its inputs change and it can't be hoisted out of the loop
+ * @return float the average cycles per call
+ */
+template <typename Function> static float cyclesPerCall(Function function) {
+    uint64_t total = 0;
+    for (uint32_t done = 0; done < ITERATIONS; done += BATCH) {
+        const uint32_t start = lemlib::readCycles();
+        for (uint32_t i = done; i < done + BATCH; i++) function(i);
+        total += lemlib::readCycles() - start;
+        // let the tasks of the system run between batches, instead of in the middle of one
+        pros::delay(1);
+    }
+    return float(total) / ITERATIONS;
+}
+
+/**
+ * @brief Time a function and print its cycles per call, without the cost of the loop around it
+ */
+template <typename Function> static void run(const char* name, float overhead, Function function) {
+    const float cycles = cyclesPerCall(function) - overhead;
+    std::printf("%-24s %10.1f %10.3f\n", name, cycles, cycles / CPU_MHZ);
+}
+
+void initialize() {
+    // wait for the terminal to connect, so the results aren't missed
+    pros::delay(1000);
+    const float overhead = cyclesPerCall([](uint32_t i) { doNotOptimize(i * 0.001f); });
+    std::printf("%-24s %10s %10s\n", "function", "cycles", "us");
+
+    run("angleError", overhead, [](uint32_t i) { doNotOptimize(lemlib::angleError(i * 0.001f, 1.5f)); });
+    run("sanitizeAngle", overhead, [](uint32_t i) { doNotOptimize(lemlib::sanitizeAngle(i * 0.001f - 100)); });
+    run("getCurvature", overhead, [](uint32_t i) {
+        doNotOptimize(lemlib::getCurvature(lemlib::Pose(0, 0, i * 0.001f), lemlib::Pose(10, 20, 0)));
+    });
+    run("slew", overhead, [](uint32_t i) { doNotOptimize(lemlib::slew(i * 0.001f, 0.5f, 0.1f)); });
+    run("ema", overhead, [](uint32_t i) { doNotOptimize(lemlib::ema(i * 0.001f, 0.5f, 0.2f)); });
+    run("Pose::distance", overhead, [](uint32_t i) {
+        doNotOptimize(lemlib::Pose(i * 0.001f, 3).distance(lemlib::Pose(10, 20)));
+    });
+    run("Pose::angle", overhead, [](uint32_t i) {
+        doNotOptimize(lemlib::Pose(i * 0.001f, 3).angle(lemlib::Pose(10, 20)));
+    });
+    run("Pose::rotate", overhead, [](uint32_t i) {
+        doNotOptimize(lemlib::Pose(10, 20).rotate(i * 0.001f));
+    });
+    // the float approximations, to compare with the functions from <math.h> they replace
+    run("fastmath::angleError", overhead,
+        [](uint32_t i) { doNotOptimize(lemlib::fastmath::angleError(i * 0.001f, 1.5f)); });
+    run("fastmath::sin", overhead, [](uint32_t i) { doNotOptimize(lemlib::fastmath::sin(i * 0.001f)); });
+    run("std::sin (double)", overhead, [](uint32_t i) { doNotOptimize(std::sin(double(i * 0.001f))); });
+    run("fastmath::atan2", overhead,
+        [](uint32_t i) { doNotOptimize(lemlib::fastmath::atan2(i * 0.001f - 1000, 3)); });
+    run("std::atan2 (double)", overhead,
+        [](uint32_t i) { doNotOptimize(std::atan2(double(i * 0.001f - 1000), 3.0)); });
+    // the same math at each precision, to compare double and fixed point with float
+    lemlib::BasicPID<float> pidFloat(5, 0.01, 20, 3);
+    lemlib::BasicPID<double> pidDouble(5, 0.01, 20, 3);
+    lemlib::BasicPID<lemlib::Fixed> pidFixed(5, 0.01, 20, 3);
+    run("PID::update (float)", overhead, [&](uint32_t i) { doNotOptimize(pidFloat.update(float(i % 200) * 0.1f)); });
+    run("PID::update (double)", overhead,
+        [&](uint32_t i) { doNotOptimize(pidDouble.update(double(i % 200) * 0.1)); });
+    run("PID::update (Fixed)", overhead,
+        [&](uint32_t i) { doNotOptimize(pidFixed.update(lemlib::Fixed(int32_t(i % 200)) / 10)); });
+    run("Pose::distance (double)", overhead, [](uint32_t i) {
+        doNotOptimize(lemlib::BasicPose<double>(i * 0.001, 3).distance(lemlib::BasicPose<double>(10, 20)));
+    });
+    run("Pose::distance (Fixed)", overhead, [](uint32_t i) {
+        const lemlib::Fixed x = lemlib::Fixed::fromRaw(int32_t(i % 65536) * 64);
+        doNotOptimize(lemlib::BasicPose<lemlib::Fixed>(x, 3).distance(lemlib::BasicPose<lemlib::Fixed>(10, 20)));
+    });
+    lemlib::ExpoDriveCurve curve(3, 10, 1.019);
+    run("ExpoDriveCurve::curve", overhead, [&](uint32_t i) { doNotOptimize(curve.curve(float(i % 255) - 127)); });
+
+    std::printf("%u calls each, %.1f cycles of loop overhead removed\n", ITERATIONS, overhead);
+}
+
+void disabled() {}
+
+void competition_initialize() {}
+
+void autonomous() {}
+
+void opcontrol() {}
+#endif